@@ -310,8 +310,18 @@ function (swift_benchmark_compile_archopts)
         "-c"
         "-o" "${objcfile}")
 
+  # The link map records the address, size and object file of every symbol,
+  # which scripts/Benchmark_CodeSize turns into the code size of each test.
+  set(link_map_options)
+  set(link_map_outputs)
+  if(SWIFT_BENCHMARK_EMIT_MAP)
+    set(link_map "${benchmark-bin-dir}/Benchmark_${BENCH_COMPILE_ARCHOPTS_OPT}-${target}.map")
+    set(link_map_options "-Xlinker" "-map" "-Xlinker" "${link_map}")
+    set(link_map_outputs "${link_map}")
+  endif()
+
   add_custom_command(
-      OUTPUT "${OUTPUT_EXEC}"
+      OUTPUT "${OUTPUT_EXEC}" ${link_map_outputs}
       DEPENDS
         ${bench_library_objects} ${SWIFT_BENCH_OBJFILES}
         "${objcfile}"
@@ -336,6 +346,7 @@ function (swift_benchmark_compile_archopts)
         ${bench_library_objects}
         ${SWIFT_BENCH_OBJFILES}
         ${objcfile}
+        ${link_map_options}
         "-o" "${OUTPUT_EXEC}"
       COMMAND
         "codesign" "-f" "-s" "-" "${OUTPUT_EXEC}")
@@ -15,6 +15,8 @@
 
 import argparse
 import csv
+import math
+import random
 import sys
 
 TESTNAME = 1
@@ -24,6 +26,14 @@ MAX = 4
 MEAN = 5
 SD = 6
 MEDIAN = 7
+# The column of the allocation counts that --memory-stats adds. Its index
+# depends on which other optional columns are present.
+ALLOCS_TITLE = "ALLOCS"
+# The first of the columns of every sample that --print-samples adds.
+SAMPLES_TITLE = "SAMPLE_VALUES"
+# Tests with fewer samples than this are only compared by their minimum.
+MIN_SAMPLES_FOR_STATISTICS = 3
+BOOTSTRAP_RESAMPLES = 1000
 
 HTML = """
 <!DOCTYPE html>
@@ -60,6 +70,7 @@ HTML_ROW = """
 """
 
 MARKDOWN_ROW = "{0} | {1} | {2} | {3} | {4} \n"
+ALLOCS_ROW = "{0} | {1} | {2} \n"
 HEADER_SPLIT = "---"
 MARKDOWN_DETAIL = """
 <details {3}>
@@ -73,11 +84,16 @@ PAIN_DETAIL = """
 
 RATIO_MIN = None
 RATIO_MAX = None
+# The delta thresholds of the tests whose noise differs from the default.
+THRESHOLDS = {}
+# The tests whose samples don't differ significantly between the two runs.
+INSIGNIFICANT = set()
 
 
 def main():
     global RATIO_MIN
     global RATIO_MAX
+    global THRESHOLDS
 
     old_results = {}
     new_results = {}
@@ -110,6 +126,12 @@ def main():
                         help='Name of the old branch', default="OLD_MIN")
     parser.add_argument('--delta-threshold',
                         help='delta threshold', default="0.05")
+    parser.add_argument('--thresholds',
+                        help='CSV file of TEST,DELTA_THRESHOLD lines that '
+                             'override --delta-threshold for noisy tests')
+    parser.add_argument('--significance',
+                        help='For tests with samples, the p-value below '
+                             'which a change is reported', default="0.05")
 
     args = parser.parse_args()
 
@@ -124,6 +146,17 @@ def main():
 
     RATIO_MIN = 1 - float(args.delta_threshold)
     RATIO_MAX = 1 + float(args.delta_threshold)
+    if args.thresholds:
+        THRESHOLDS = read_thresholds(args.thresholds)
+    significance = float(args.significance)
+
+    old_data = list(old_data)
+    new_data = list(new_data)
+    old_allocs = read_allocs(old_data)
+    new_allocs = read_allocs(new_data)
+    old_samples = read_samples(old_data)
+    new_samples = read_samples(new_data)
+    rng = random.Random(0)
 
     for row in old_data:
         if (len(row) > 7 and row[MIN].isdigit()):
@@ -163,6 +196,18 @@ def main():
             else:
                     unknown_list[key] = ""
 
+            # With enough samples, test whether the runs differ instead of
+            # checking whether their ranges overlap.
+            old = reject_outliers(old_samples.get(key, []))
+            new = reject_outliers(new_samples.get(key, []))
+            if (len(old) >= MIN_SAMPLES_FOR_STATISTICS and
+                    len(new) >= MIN_SAMPLES_FOR_STATISTICS):
+                (low, high) = bootstrap_speedup_interval(old, new, rng)
+                unknown_list[key] = " [{0:.2f}x, {1:.2f}x]".format(low, high)
+                if mann_whitney_p_value(old, new) >= significance:
+                    INSIGNIFICANT.add(key)
+                    unknown_list[key] += "(?)"
+
     (complete_perf_list,
      increased_perf_list,
      decreased_perf_list,
@@ -235,6 +280,22 @@ def main():
                                                 len(normal_perf_list),
                                                 markdown_normal, "")
 
+    # Allocation counts are deterministic, so any change is reported.
+    allocs_changed = sorted(key for key in new_allocs
+                            if key in old_allocs and
+                            new_allocs[key] != old_allocs[key])
+    if allocs_changed:
+        markdown_allocs = "\n" + ALLOCS_ROW.format("TEST", old_branch,
+                                                   new_branch)
+        markdown_allocs += ALLOCS_ROW.format(HEADER_SPLIT, HEADER_SPLIT,
+                                             HEADER_SPLIT)
+        for key in allocs_changed:
+            markdown_allocs += ALLOCS_ROW.format(key, old_allocs[key],
+                                                 new_allocs[key])
+        markdown_data += MARKDOWN_DETAIL.format("Allocation Changes",
+                                                len(allocs_changed),
+                                                markdown_allocs, "open")
+
     if args.format:
         if args.format.lower() != "markdown":
             pain_data = PAIN_DETAIL.format("Regression", markdown_regression)
@@ -278,9 +339,9 @@ def convert_to_html(ratio_list, old_results, new_results, delta_list,
 
     html_rows = ""
     for key in complete_perf_list:
-        if ratio_list[key] < RATIO_MIN:
+        if key in decreased_perf_list:
             color = "red"
-        elif ratio_list[key] > RATIO_MAX:
+        elif key in increased_perf_list:
             color = "green"
         else:
             color = "black"
@@ -310,6 +371,134 @@ def convert_to_html(ratio_list, old_results, new_results, delta_list,
     return html_data
 
 
+def read_allocs(rows):
+    """
+    Return the smallest number of allocations per iteration of each test, if
+    the results were taken with --memory-stats.
+    """
+    allocs = {}
+    column = None
+    for row in rows:
+        if len(row) > 0 and row[0] == "#" and ALLOCS_TITLE in row:
+            column = row.index(ALLOCS_TITLE)
+        elif (column is not None and len(row) > column and
+              row[MIN].isdigit() and row[column].isdigit()):
+            value = int(row[column])
+            allocs[row[TESTNAME]] = min(value,
+                                        allocs.get(row[TESTNAME], value))
+    return allocs
+
+
+def read_samples(rows):
+    """
+    Return every sample of each test, if the results were taken with
+    --print-samples.
+    """
+    samples = {}
+    column = None
+    for row in rows:
+        if len(row) > 0 and row[0] == "#" and SAMPLES_TITLE in row:
+            column = row.index(SAMPLES_TITLE)
+        elif (column is not None and len(row) > column and
+              row[MIN].isdigit()):
+            samples.setdefault(row[TESTNAME], []).extend(
+                int(x) for x in row[column:] if x.isdigit())
+    return samples
+
+
+def read_thresholds(file_name):
+    """
+    Return the delta threshold of each test listed in a CSV file of
+    TEST,DELTA_THRESHOLD lines. Lines starting with # are ignored.
+    """
+    thresholds = {}
+    for row in csv.reader(open(file_name)):
+        if len(row) >= 2 and not row[0].startswith("#"):
+            thresholds[row[0].strip()] = float(row[1])
+    return thresholds
+
+
+def ratio_bounds(key):
+    """
+    Return the speedup ratios between which test `key` counts as unchanged.
+    """
+    if key in THRESHOLDS:
+        return (1 - THRESHOLDS[key], 1 + THRESHOLDS[key])
+    return (RATIO_MIN, RATIO_MAX)
+
+
+def median(values):
+    ordered = sorted(values)
+    middle = len(ordered) // 2
+    if len(ordered) % 2:
+        return ordered[middle]
+    return (ordered[middle - 1] + ordered[middle]) / 2.0
+
+
+def reject_outliers(samples):
+    """
+    Return the samples without the outliers beyond Tukey's fences, i.e. more
+    than 1.5 interquartile ranges outside the quartiles. These are usually
+    samples that were interrupted by another process.
+    """
+    if len(samples) < 4:
+        return samples
+    ordered = sorted(samples)
+    q1 = ordered[len(ordered) // 4]
+    q3 = ordered[(3 * len(ordered)) // 4]
+    iqr = q3 - q1
+    return [x for x in ordered if q1 - 1.5 * iqr <= x <= q3 + 1.5 * iqr]
+
+
+def mann_whitney_p_value(a, b):
+    """
+    Return the two-sided p-value of the Mann-Whitney U test of whether the
+    samples `a` and `b` come from the same distribution, using the normal
+    approximation with tie and continuity corrections.
+    """
+    combined = sorted([(x, 0) for x in a] + [(x, 1) for x in b])
+    n = len(combined)
+    rank_sum = 0.0
+    tie_term = 0.0
+    i = 0
+    while i < n:
+        j = i
+        while j < n and combined[j][0] == combined[i][0]:
+            j += 1
+        # Tied values share the average of their ranks, which are 1-based.
+        average_rank = (i + j + 1) / 2.0
+        rank_sum += average_rank * sum(1 for x in combined[i:j] if x[1] == 0)
+        ties = j - i
+        tie_term += ties ** 3 - ties
+        i = j
+    n1 = len(a)
+    n2 = len(b)
+    u = rank_sum - n1 * (n1 + 1) / 2.0
+    mean = n1 * n2 / 2.0
+    variance = n1 * n2 / 12.0 * ((n + 1) - tie_term / (n * (n - 1)))
+    if variance <= 0:
+        return 1.0
+    z = max(0.0, abs(u - mean) - 0.5) / math.sqrt(variance)
+    return math.erfc(z / math.sqrt(2))
+
+
+def bootstrap_speedup_interval(old, new, rng, confidence=0.95):
+    """
+    Return a bootstrap confidence interval of the speedup, i.e. the ratio of
+    the old median to the new median.
+    """
+    ratios = []
+    for _ in range(BOOTSTRAP_RESAMPLES):
+        old_median = median([rng.choice(old) for _ in old])
+        new_median = median([rng.choice(new) for _ in new])
+        ratios.append((old_median + 0.001) / (new_median + 0.001))
+    ratios.sort()
+    tail = (1 - confidence) / 2
+    low = ratios[int(tail * BOOTSTRAP_RESAMPLES)]
+    high = ratios[int((1 - tail) * BOOTSTRAP_RESAMPLES) - 1]
+    return (low, high)
+
+
 def write_to_file(file_name, data):
     """
     Write data to given file
@@ -329,9 +518,12 @@ def sort_ratio_list(ratio_list, changes_only=False):
     normal_perf_list = {}
 
     for key, v in sorted(ratio_list.items(), key=lambda x: x[1]):
-        if ratio_list[key] < RATIO_MIN:
+        (ratio_min, ratio_max) = ratio_bounds(key)
+        if key in INSIGNIFICANT:
+            normal_perf_list[key] = v
+        elif ratio_list[key] < ratio_min:
             decreased_perf_list.append(key)
-        elif ratio_list[key] > RATIO_MAX:
+        elif ratio_list[key] > ratio_max:
             increased_perf_list.append(key)
         else:
             normal_perf_list[key] = v
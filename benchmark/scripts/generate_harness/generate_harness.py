@@ -30,6 +30,9 @@ template_map = {
     'main.swift_template': os.path.join(perf_dir, 'utils/main.swift')
 }
 ignored_run_funcs = ["Ackermann", "Fibonacci"]
+# The multithreaded scalability tests are too noisy for pre-commit runs, so
+# they only run with --run-all.
+other_run_func_prefix = "Concurrent"
 
 template_loader = jinja2.FileSystemLoader(searchpath="/")
 template_env = jinja2.Environment(loader=template_loader, trim_blocks=True,
@@ -73,9 +76,15 @@ if __name__ == '__main__':
                     run_funcs = get_run_funcs(os.path.join(root, name))
                     ret_run_funcs.extend(run_funcs)
         return ret_run_funcs
+    all_run_funcs = find_run_funcs([single_source_dir, multi_source_dir])
     run_funcs = sorted(
-        [(x, x)
-         for x in find_run_funcs([single_source_dir, multi_source_dir])],
+        [(x, x) for x in all_run_funcs
+         if not x.startswith(other_run_func_prefix)],
+        key=lambda x: x[0]
+    )
+    other_run_funcs = sorted(
+        [(x, x) for x in all_run_funcs
+         if x.startswith(other_run_func_prefix)],
         key=lambda x: x[0]
     )
 
@@ -88,5 +97,6 @@ if __name__ == '__main__':
             template.render(tests=tests,
                             multisource_benches=multisource_benches,
                             imports=imports,
-                            run_funcs=run_funcs)
+                            run_funcs=run_funcs,
+                            other_run_funcs=other_run_funcs)
         )
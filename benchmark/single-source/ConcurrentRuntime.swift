@@ -0,0 +1,282 @@
+//===--- ConcurrentRuntime.swift ------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// These tests measure how the runtime's hot paths scale when several threads
+// use them at once. Every thread does the same amount of work, so with
+// perfect scaling the time per iteration doesn't change from one thread
+// count to the next; the ratio to the single-threaded time is the slowdown
+// caused by contention.
+import TestsUtils
+
+//===--- Atomic retain and release of a shared object ---------------------===//
+
+final class SharedObject {
+  var flag = true
+}
+
+let sharedObject = SharedObject()
+
+// Returning the argument makes the callee retain it.
+@inline(never)
+func passThrough(_ object: SharedObject) -> SharedObject {
+  return object
+}
+
+@inline(never)
+func runConcurrentRetain(_ N: Int, threads: Int) {
+  let object = sharedObject
+  runConcurrently(threads: threads) { _ in
+    var count = 0
+    for _ in 0..<(N * 100_000) {
+      if passThrough(object).flag {
+        count += 1
+      }
+    }
+    CheckResults(count == N * 100_000, "Incorrect results in ConcurrentRetain")
+  }
+}
+
+//===--- Generic metadata lookups -----------------------------------------===//
+
+struct MetadataBox<T> {
+  var value: T
+}
+
+class MetadataProbe {
+  func boxType() -> Any.Type { fatalError("abstract") }
+}
+
+// Each call looks up the metadata of MetadataBox<T> in the runtime's cache,
+// because the method isn't specialized for T.
+final class MetadataProbeImpl<T> : MetadataProbe {
+  override func boxType() -> Any.Type { return MetadataBox<T>.self }
+}
+
+let metadataProbes: [MetadataProbe] = [
+  MetadataProbeImpl<Int>(), MetadataProbeImpl<String>(),
+  MetadataProbeImpl<Double>(), MetadataProbeImpl<[Int]>(),
+]
+
+@inline(never)
+func runConcurrentGenericMetadata(_ N: Int, threads: Int) {
+  let probes = metadataProbes
+  runConcurrently(threads: threads) { _ in
+    var count = 0
+    for i in 0..<(N * 10_000) {
+      if probes[i & 3].boxType() != Int.self {
+        count += 1
+      }
+    }
+    CheckResults(count == N * 10_000,
+                 "Incorrect results in ConcurrentGenericMetadata")
+  }
+}
+
+//===--- Dynamic casts to a protocol --------------------------------------===//
+
+protocol CastProbe {}
+extension Int : CastProbe {}
+extension SharedObject : CastProbe {}
+
+// Half of the values conform, so both the positive and the negative entries
+// of the conformance cache are used.
+let castValues: [Any] = [1, "a", sharedObject, 2.0]
+
+@inline(never)
+func runConcurrentConformsToProtocol(_ N: Int, threads: Int) {
+  let values = castValues
+  runConcurrently(threads: threads) { _ in
+    var count = 0
+    for i in 0..<(N * 10_000) {
+      if values[i & 3] is CastProbe {
+        count += 1
+      }
+    }
+    CheckResults(count == N * 5_000,
+                 "Incorrect results in ConcurrentConformsToProtocol")
+  }
+}
+
+//===--- Type names -------------------------------------------------------===//
+
+let namedTypes: [Any.Type] = [
+  Int.self, SharedObject.self, MetadataBox<String>.self, [Double].self,
+]
+
+@inline(never)
+func runConcurrentTypeName(_ N: Int, threads: Int) {
+  let types = namedTypes
+  runConcurrently(threads: threads) { _ in
+    var count = 0
+    for i in 0..<(N * 1_000) {
+      if !_typeName(types[i & 3]).isEmpty {
+        count += 1
+      }
+    }
+    CheckResults(count == N * 1_000,
+                 "Incorrect results in ConcurrentTypeName")
+  }
+}
+
+//===--- Lazy global initialization ---------------------------------------===//
+
+@inline(never)
+func makeOnceTable() -> [Int] {
+  return Array(0..<16)
+}
+
+let onceTable = makeOnceTable()
+
+// Every access to the global goes through swift_once.
+@inline(never)
+func onceTableCount() -> Int {
+  return onceTable.count
+}
+
+@inline(never)
+func runConcurrentOnce(_ N: Int, threads: Int) {
+  runConcurrently(threads: threads) { _ in
+    var total = 0
+    for _ in 0..<(N * 100_000) {
+      total += onceTableCount()
+    }
+    CheckResults(total == N * 100_000 * 16,
+                 "Incorrect results in ConcurrentOnce")
+  }
+}
+
+//===--- Entry points -----------------------------------------------------===//
+
+@inline(never)
+public func run_ConcurrentRetain1(_ N: Int) {
+  runConcurrentRetain(N, threads: 1)
+}
+
+@inline(never)
+public func run_ConcurrentRetain2(_ N: Int) {
+  runConcurrentRetain(N, threads: 2)
+}
+
+@inline(never)
+public func run_ConcurrentRetain4(_ N: Int) {
+  runConcurrentRetain(N, threads: 4)
+}
+
+@inline(never)
+public func run_ConcurrentRetain8(_ N: Int) {
+  runConcurrentRetain(N, threads: 8)
+}
+
+@inline(never)
+public func run_ConcurrentRetain16(_ N: Int) {
+  runConcurrentRetain(N, threads: 16)
+}
+
+@inline(never)
+public func run_ConcurrentGenericMetadata1(_ N: Int) {
+  runConcurrentGenericMetadata(N, threads: 1)
+}
+
+@inline(never)
+public func run_ConcurrentGenericMetadata2(_ N: Int) {
+  runConcurrentGenericMetadata(N, threads: 2)
+}
+
+@inline(never)
+public func run_ConcurrentGenericMetadata4(_ N: Int) {
+  runConcurrentGenericMetadata(N, threads: 4)
+}
+
+@inline(never)
+public func run_ConcurrentGenericMetadata8(_ N: Int) {
+  runConcurrentGenericMetadata(N, threads: 8)
+}
+
+@inline(never)
+public func run_ConcurrentGenericMetadata16(_ N: Int) {
+  runConcurrentGenericMetadata(N, threads: 16)
+}
+
+@inline(never)
+public func run_ConcurrentConformsToProtocol1(_ N: Int) {
+  runConcurrentConformsToProtocol(N, threads: 1)
+}
+
+@inline(never)
+public func run_ConcurrentConformsToProtocol2(_ N: Int) {
+  runConcurrentConformsToProtocol(N, threads: 2)
+}
+
+@inline(never)
+public func run_ConcurrentConformsToProtocol4(_ N: Int) {
+  runConcurrentConformsToProtocol(N, threads: 4)
+}
+
+@inline(never)
+public func run_ConcurrentConformsToProtocol8(_ N: Int) {
+  runConcurrentConformsToProtocol(N, threads: 8)
+}
+
+@inline(never)
+public func run_ConcurrentConformsToProtocol16(_ N: Int) {
+  runConcurrentConformsToProtocol(N, threads: 16)
+}
+
+@inline(never)
+public func run_ConcurrentTypeName1(_ N: Int) {
+  runConcurrentTypeName(N, threads: 1)
+}
+
+@inline(never)
+public func run_ConcurrentTypeName2(_ N: Int) {
+  runConcurrentTypeName(N, threads: 2)
+}
+
+@inline(never)
+public func run_ConcurrentTypeName4(_ N: Int) {
+  runConcurrentTypeName(N, threads: 4)
+}
+
+@inline(never)
+public func run_ConcurrentTypeName8(_ N: Int) {
+  runConcurrentTypeName(N, threads: 8)
+}
+
+@inline(never)
+public func run_ConcurrentTypeName16(_ N: Int) {
+  runConcurrentTypeName(N, threads: 16)
+}
+
+@inline(never)
+public func run_ConcurrentOnce1(_ N: Int) {
+  runConcurrentOnce(N, threads: 1)
+}
+
+@inline(never)
+public func run_ConcurrentOnce2(_ N: Int) {
+  runConcurrentOnce(N, threads: 2)
+}
+
+@inline(never)
+public func run_ConcurrentOnce4(_ N: Int) {
+  runConcurrentOnce(N, threads: 4)
+}
+
+@inline(never)
+public func run_ConcurrentOnce8(_ N: Int) {
+  runConcurrentOnce(N, threads: 8)
+}
+
+@inline(never)
+public func run_ConcurrentOnce16(_ N: Int) {
+  runConcurrentOnce(N, threads: 16)
+}
@@ -0,0 +1,268 @@
+//===--- StringCorpus.swift -----------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// These tests run the String hot paths over corpora of a few megabytes that
+// look like real data: text mixing many scripts, an emoji-heavy chat log and
+// JSON documents. Each declares the size of its corpus, so running the
+// driver with --throughput reports megabytes per second.
+import TestsUtils
+import Foundation
+
+/// The size of each corpus, in UTF-8 bytes.
+let corpusSize = 2 << 20
+
+/// A corpus, and its lines, built once on first use.
+final class Corpus {
+  let text: String
+  let lines: [String]
+  let utf8Count: Int
+
+  init(repeating pieces: [String]) {
+    var text = ""
+    var size = 0
+    var i = 0
+    while size < corpusSize {
+      let piece = pieces[i % pieces.count]
+      text += piece
+      size += piece.utf8.count
+      i += 1
+    }
+    self.text = text
+    self.lines = text.components(separatedBy: "\n")
+    self.utf8Count = size
+  }
+}
+
+let mixedScriptCorpus = Corpus(repeating: [
+  "The quick brown fox jumps over the lazy dog, café crème brûlée.\n",
+  "Съешь же ещё этих мягких французских булок, да выпей чаю.\n",
+  "Ξεσκεπάζω τὴν ψυχοφθόρα βδελυγμία.\n",
+  "我能吞下玻璃而不伤身体。中文文本混合 English words。\n",
+  "いろはにほへと ちりぬるを わかよたれそ つねならむ。カタカナも。\n",
+  "صِف خَلقَ خَودِ كَمِثلِ الشَمسِ إِذ بَزَغَت\n",
+  "ऋषियों को सताने वाले दुष्ट राक्षसों के राजा रावण का सर्वनाश।\n",
+  "다람쥐 헌 쳇바퀴에 타고파. Zwölf Boxkämpfer jagen Viktor quer über den Sylter Deich.\n",
+  "e\u{301}le\u{300}ve, n\u{303}andu, A\u{30A}ngstro\u{308}m: combining marks.\n",
+])
+
+let emojiChatCorpus = Corpus(repeating: [
+  "[09:41] alice: good morning! ☀️☕️\n",
+  "[09:42] bob: 😂😂😂 did you see that?? 🔥🔥\n",
+  "[09:42] carol: 👍🏽👍🏿 agreed, 100% 💯\n",
+  "[09:43] dave: family trip 👨‍👩‍👧‍👦 to 🇯🇵🇫🇷🇧🇷 next month ✈️\n",
+  "[09:44] alice: 🙈🙉🙊 no way\n",
+  "[09:45] bob: ok see you at 12 🕛 🍕🍔🍟\n",
+  "[09:45] erin: 🏳️‍🌈 🧑🏻‍💻 👩🏾‍🔬 (ﾉ◕ヮ◕)ﾉ*:･ﾟ✧\n",
+])
+
+let jsonCorpus = Corpus(repeating: (0..<64).map { i in
+  "{\"id\": \(i * 7919), \"name\": \"user\(i)\", \"active\": " +
+  "\(i % 3 == 0), \"score\": \(Double(i) * 1.25), " +
+  "\"tags\": [\"a\", \"b\\\"c\", \"\\u00e9t\\u00e9\"], " +
+  "\"bio\": \"Line one\\nLine two, caf\u{e9} \u{1F600}\", " +
+  "\"address\": {\"city\": \"Z\u{fc}rich\", \"zip\": \"80\(i % 10)0\"}}\n"
+})
+
+@inline(never)
+func characterCount(_ corpus: Corpus, _ N: Int) {
+  setBytesPerIteration(corpus.utf8Count)
+  for _ in 1...N {
+    CheckResults(corpus.text.characters.count > 0,
+                 "Incorrect results in StringCorpusCharacterCount")
+  }
+}
+
+@inline(never)
+func utf8Sum(_ corpus: Corpus, _ N: Int) {
+  setBytesPerIteration(corpus.utf8Count)
+  for _ in 1...N {
+    var sum: UInt32 = 0
+    for unit in corpus.text.utf8 {
+      sum = sum &+ UInt32(unit)
+    }
+    CheckResults(sum != 0, "Incorrect results in StringCorpusUTF8")
+  }
+}
+
+@inline(never)
+func utf16Sum(_ corpus: Corpus, _ N: Int) {
+  setBytesPerIteration(corpus.utf8Count)
+  for _ in 1...N {
+    var sum: UInt32 = 0
+    for unit in corpus.text.utf16 {
+      sum = sum &+ UInt32(unit)
+    }
+    CheckResults(sum != 0, "Incorrect results in StringCorpusUTF16")
+  }
+}
+
+@inline(never)
+func hashLines(_ corpus: Corpus, _ N: Int) {
+  setBytesPerIteration(corpus.utf8Count)
+  for _ in 1...N {
+    var hash = 0
+    for line in corpus.lines {
+      hash = hash &+ line.hashValue
+    }
+    CheckResults(hash != 1, "Incorrect results in StringCorpusHash")
+  }
+}
+
+@inline(never)
+func compareLines(_ corpus: Corpus, _ N: Int) {
+  setBytesPerIteration(corpus.utf8Count)
+  let lines = corpus.lines
+  for _ in 1...N {
+    var ordered = 0
+    for i in 1..<lines.count {
+      if lines[i - 1] < lines[i] {
+        ordered += 1
+      }
+      if lines[i - 1] == lines[i] {
+        ordered -= 1
+      }
+    }
+    CheckResults(ordered != lines.count,
+                 "Incorrect results in StringCorpusCompare")
+  }
+}
+
+@inline(never)
+func splitLines(_ corpus: Corpus, _ N: Int) {
+  setBytesPerIteration(corpus.utf8Count)
+  for _ in 1...N {
+    let lines = corpus.text.components(separatedBy: "\n")
+    CheckResults(lines.count == corpus.lines.count,
+                 "Incorrect results in StringCorpusSplit")
+  }
+}
+
+// Copies the corpus into an NSString and reads it back through the bridged
+// String, transcoding it to UTF-8.
+@inline(never)
+func nsStringRoundTrip(_ corpus: Corpus, _ N: Int) {
+  setBytesPerIteration(corpus.utf8Count)
+  for _ in 1...N {
+    let bridged = NSString(string: corpus.text) as String
+    var count = 0
+    for _ in bridged.utf8 {
+      count += 1
+    }
+    CheckResults(count == corpus.utf8Count,
+                 "Incorrect results in StringCorpusNSStringRoundTrip")
+  }
+}
+
+@inline(never)
+public func run_StringCorpusCharacterCountMixed(_ N: Int) {
+  characterCount(mixedScriptCorpus, N)
+}
+
+@inline(never)
+public func run_StringCorpusCharacterCountEmoji(_ N: Int) {
+  characterCount(emojiChatCorpus, N)
+}
+
+@inline(never)
+public func run_StringCorpusCharacterCountJSON(_ N: Int) {
+  characterCount(jsonCorpus, N)
+}
+
+@inline(never)
+public func run_StringCorpusUTF8Mixed(_ N: Int) {
+  utf8Sum(mixedScriptCorpus, N)
+}
+
+@inline(never)
+public func run_StringCorpusUTF8Emoji(_ N: Int) {
+  utf8Sum(emojiChatCorpus, N)
+}
+
+@inline(never)
+public func run_StringCorpusUTF8JSON(_ N: Int) {
+  utf8Sum(jsonCorpus, N)
+}
+
+@inline(never)
+public func run_StringCorpusUTF16Mixed(_ N: Int) {
+  utf16Sum(mixedScriptCorpus, N)
+}
+
+@inline(never)
+public func run_StringCorpusUTF16Emoji(_ N: Int) {
+  utf16Sum(emojiChatCorpus, N)
+}
+
+@inline(never)
+public func run_StringCorpusUTF16JSON(_ N: Int) {
+  utf16Sum(jsonCorpus, N)
+}
+
+@inline(never)
+public func run_StringCorpusHashMixed(_ N: Int) {
+  hashLines(mixedScriptCorpus, N)
+}
+
+@inline(never)
+public func run_StringCorpusHashEmoji(_ N: Int) {
+  hashLines(emojiChatCorpus, N)
+}
+
+@inline(never)
+public func run_StringCorpusHashJSON(_ N: Int) {
+  hashLines(jsonCorpus, N)
+}
+
+@inline(never)
+public func run_StringCorpusCompareMixed(_ N: Int) {
+  compareLines(mixedScriptCorpus, N)
+}
+
+@inline(never)
+public func run_StringCorpusCompareEmoji(_ N: Int) {
+  compareLines(emojiChatCorpus, N)
+}
+
+@inline(never)
+public func run_StringCorpusCompareJSON(_ N: Int) {
+  compareLines(jsonCorpus, N)
+}
+
+@inline(never)
+public func run_StringCorpusSplitMixed(_ N: Int) {
+  splitLines(mixedScriptCorpus, N)
+}
+
+@inline(never)
+public func run_StringCorpusSplitEmoji(_ N: Int) {
+  splitLines(emojiChatCorpus, N)
+}
+
+@inline(never)
+public func run_StringCorpusSplitJSON(_ N: Int) {
+  splitLines(jsonCorpus, N)
+}
+
+@inline(never)
+public func run_StringCorpusNSStringRoundTripMixed(_ N: Int) {
+  nsStringRoundTrip(mixedScriptCorpus, N)
+}
+
+@inline(never)
+public func run_StringCorpusNSStringRoundTripEmoji(_ N: Int) {
+  nsStringRoundTrip(emojiChatCorpus, N)
+}
+
+@inline(never)
+public func run_StringCorpusNSStringRoundTripJSON(_ N: Int) {
+  nsStringRoundTrip(jsonCorpus, N)
+}
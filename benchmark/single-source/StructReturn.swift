@@ -0,0 +1,87 @@
+//===--- StructReturn.swift -----------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+// Calls non-inlined functions which return and take small math structs. With
+// the default limits, structs of more than three scalars are returned and
+// passed through memory. Build with -Xfrontend -max-direct-result-scalars and
+// -max-direct-parameter-scalars to measure the effect of passing them in
+// registers.
+import TestsUtils
+
+struct Vector3 {
+  var x, y, z: Double
+}
+
+struct Quaternion {
+  var w, x, y, z: Double
+}
+
+struct Segment {
+  var x0, y0, x1, y1: Double
+  var weight: Double
+}
+
+@inline(never)
+func cross(_ a: Vector3, _ b: Vector3) -> Vector3 {
+  return Vector3(x: a.y * b.z - a.z * b.y,
+                 y: a.z * b.x - a.x * b.z,
+                 z: a.x * b.y - a.y * b.x)
+}
+
+@inline(never)
+func multiply(_ a: Quaternion, _ b: Quaternion) -> Quaternion {
+  return Quaternion(w: a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z,
+                    x: a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+                    y: a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+                    z: a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w)
+}
+
+@inline(never)
+func scaled(_ s: Segment, by factor: Double) -> Segment {
+  return Segment(x0: s.x0 * factor, y0: s.y0 * factor,
+                 x1: s.x1 * factor, y1: s.y1 * factor,
+                 weight: s.weight + 1)
+}
+
+let iterations = 100_000
+
+@inline(never)
+public func run_StructReturnVector3(_ N: Int) {
+  var v = Vector3(x: 1, y: 0, z: 0)
+  let axis = Vector3(x: 0, y: 0, z: 1)
+  for _ in 1...N*iterations {
+    v = cross(axis, v)
+  }
+  CheckResults(v.x == 1 || v.x == -1 || v.y == 1 || v.y == -1,
+               "IncorrectResults in StructReturnVector3")
+}
+
+@inline(never)
+public func run_StructReturnQuaternion(_ N: Int) {
+  var q = Quaternion(w: 1, x: 0, y: 0, z: 0)
+  let i = Quaternion(w: 0, x: 1, y: 0, z: 0)
+  for _ in 1...N*iterations {
+    q = multiply(q, i)
+  }
+  CheckResults(abs(q.w) + abs(q.x) == 1,
+               "IncorrectResults in StructReturnQuaternion")
+}
+
+@inline(never)
+public func run_StructReturnFiveFields(_ N: Int) {
+  var s = Segment(x0: 1, y0: 2, x1: 3, y1: 4, weight: 0)
+  for i in 1...N*iterations {
+    s = scaled(s, by: i & 1 == 0 ? 2 : 0.5)
+  }
+  CheckResults(s.weight == Double(N*iterations),
+               "IncorrectResults in StructReturnFiveFields")
+}
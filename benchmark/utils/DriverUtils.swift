@@ -10,7 +10,39 @@
 //
 //===----------------------------------------------------------------------===//
 
+#if os(Linux)
+import Glibc
+#else
 import Darwin
+#endif
+
+/// The hardware events counted with `--perf-counters`, per iteration.
+struct PerfCounterValues {
+  var cycles: UInt64 = 0
+  var instructions: UInt64 = 0
+  var cacheMisses: UInt64 = 0
+  var branchMisses: UInt64 = 0
+  init() {}
+  init(_ counts: [UInt64]) {
+    cycles = counts[0]
+    instructions = counts[1]
+    cacheMisses = counts[2]
+    branchMisses = counts[3]
+  }
+}
+
+/// The memory use measured with `--memory-stats`. All but the peak RSS delta
+/// are per iteration.
+struct MemoryStatValues {
+  var allocs: UInt64 = 0
+  var allocatedBytes: UInt64 = 0
+  var retains: UInt64 = 0
+  var releases: UInt64 = 0
+  /// How much the peak resident set size of the process grew, in kilobytes,
+  /// while the test ran.
+  var peakRSSDeltaKB: UInt64 = 0
+  init() {}
+}
 
 struct BenchResults {
   var delim: String  = ","
@@ -20,8 +52,16 @@ struct BenchResults {
   var mean: UInt64 = 0
   var sd: UInt64 = 0
   var median: UInt64 = 0
+  var counters: PerfCounterValues? = nil
+  var memory: MemoryStatValues? = nil
+  /// The megabytes per second processed at the median time, for
+  /// `--throughput`; zero if the test doesn't declare how many bytes it
+  /// processes.
+  var throughput: UInt64? = nil
+  /// Every sample, for `--print-samples`.
+  var samples: [UInt64]? = nil
   init() {}
-  init(delim: String, sampleCount: UInt64, min: UInt64, max: UInt64, mean: UInt64, sd: UInt64, median: UInt64) {
+  init(delim: String, sampleCount: UInt64, min: UInt64, max: UInt64, mean: UInt64, sd: UInt64, median: UInt64, counters: PerfCounterValues? = nil, memory: MemoryStatValues? = nil, throughput: UInt64? = nil, samples: [UInt64]? = nil) {
     self.delim = delim
     self.sampleCount = sampleCount
     self.min = min
@@ -29,6 +69,10 @@ struct BenchResults {
     self.mean = mean
     self.sd = sd
     self.median = median
+    self.counters = counters
+    self.memory = memory
+    self.throughput = throughput
+    self.samples = samples
 
     // Sanity the bounds of our results
     precondition(self.min <= self.max, "min should always be <= max")
@@ -41,7 +85,22 @@ struct BenchResults {
 
 extension BenchResults : CustomStringConvertible {
   var description: String {
-     return "\(sampleCount)\(delim)\(min)\(delim)\(max)\(delim)\(mean)\(delim)\(sd)\(delim)\(median)"
+     var result = "\(sampleCount)\(delim)\(min)\(delim)\(max)\(delim)\(mean)\(delim)\(sd)\(delim)\(median)"
+     if let c = counters {
+       result += "\(delim)\(c.cycles)\(delim)\(c.instructions)\(delim)\(c.cacheMisses)\(delim)\(c.branchMisses)"
+     }
+     if let m = memory {
+       result += "\(delim)\(m.allocs)\(delim)\(m.allocatedBytes)\(delim)\(m.retains)\(delim)\(m.releases)\(delim)\(m.peakRSSDeltaKB)"
+     }
+     if let t = throughput {
+       result += "\(delim)\(t)"
+     }
+     if let s = samples {
+       for sample in s {
+         result += "\(delim)\(sample)"
+       }
+     }
+     return result
   }
 }
 
@@ -98,13 +157,31 @@ struct TestConfig {
   /// like leaks that require a PID to run on the test harness.
   var afterRunSleep: Int?
 
+  /// Should we count cycles, instructions, cache misses and branch misses
+  /// with the CPU's performance counters?
+  var perfCounters: Bool = false
+
+  /// Should we count allocations and reference counting operations, and
+  /// measure the growth of the peak RSS?
+  var memoryStats: Bool = false
+
+  /// Should we print every sample after the summary of each test, so that
+  /// compare_perf_tests.py can test whether two runs differ?
+  var printSamples: Bool = false
+
+  /// Should we report the throughput of the tests that declare how many
+  /// bytes they process?
+  var throughput: Bool = false
+
   /// The list of tests to run.
   var tests = [Test]()
 
   mutating func processArguments() -> TestAction {
     let validOptions = [
       "--iter-scale", "--num-samples", "--num-iters",
-      "--verbose", "--delim", "--run-all", "--list", "--sleep"
+      "--verbose", "--delim", "--run-all", "--list", "--sleep",
+      "--perf-counters", "--memory-stats", "--print-samples",
+      "--throughput"
     ]
     let maybeBenchArgs: Arguments? = parseArgs(validOptions)
     if maybeBenchArgs == nil {
@@ -156,6 +233,29 @@ struct TestConfig {
       afterRunSleep = v!
     }
 
+    if let _ = benchArgs.optionalArgsMap["--perf-counters"] {
+      if PerfCounters() == nil {
+        return .Fail("--perf-counters requires perf_event_open on Linux " +
+                     "(see /proc/sys/kernel/perf_event_paranoid)")
+      }
+      perfCounters = true
+    }
+
+    if let _ = benchArgs.optionalArgsMap["--memory-stats"] {
+      if RuntimeCounters() == nil {
+        return .Fail("--memory-stats requires the runtime's entry point hooks")
+      }
+      memoryStats = true
+    }
+
+    if let _ = benchArgs.optionalArgsMap["--print-samples"] {
+      printSamples = true
+    }
+
+    if let _ = benchArgs.optionalArgsMap["--throughput"] {
+      throughput = true
+    }
+
     filters = benchArgs.positionalArgs
 
     return .Run
@@ -217,6 +317,11 @@ func internalMedian(_ inputs: [UInt64]) -> UInt64 {
   return inputs.sorted()[inputs.count / 2]
 }
 
+// Defined in TestsUtils, which tests call to declare how many bytes each of
+// their iterations processes.
+@_silgen_name("_swift_benchmark_takeBytesPerIteration")
+func takeBytesPerIteration() -> Int
+
 #if SWIFT_RUNTIME_ENABLE_LEAK_CHECKER
 
 @_silgen_name("swift_leaks_startTrackingObjects")
@@ -226,28 +331,281 @@ func stopTrackingObjects(_: UnsafeMutableRawPointer) -> Int
 
 #endif
 
+/// Counts hardware events of the calling thread with perf_event_open(2).
+///
+/// Only user-space events are counted, which unprivileged processes may do as
+/// long as /proc/sys/kernel/perf_event_paranoid is at most 2. The counters
+/// count from the moment they are opened; `read()` them before and after the
+/// code to measure.
+final class PerfCounters {
+  // The generic hardware events of <linux/perf_event.h>, in the order of
+  // PerfCounterValues.
+  static let events: [UInt64] = [
+    0, // PERF_COUNT_HW_CPU_CYCLES
+    1, // PERF_COUNT_HW_INSTRUCTIONS
+    3, // PERF_COUNT_HW_CACHE_MISSES
+    5, // PERF_COUNT_HW_BRANCH_MISSES
+  ]
+
+  var fds = [Int32]()
+
+  /// Opens a counter for every event, or fails if the platform or the kernel
+  /// doesn't allow it.
+  init?() {
+    for event in PerfCounters.events {
+      let fd = PerfCounters.open(event)
+      if fd < 0 {
+        closeAll()
+        return nil
+      }
+      fds.append(fd)
+    }
+  }
+
+  deinit {
+    closeAll()
+  }
+
+  func closeAll() {
+    for fd in fds {
+      close(fd)
+    }
+    fds = []
+  }
+
+  /// Returns the current value of every counter.
+  func read() -> [UInt64] {
+    return fds.map { fd -> UInt64 in
+      var value: UInt64 = 0
+      let size = MemoryLayout<UInt64>.size
+#if os(Linux)
+      if Glibc.read(fd, &value, size) != size { return 0 }
+#endif
+      return value
+    }
+  }
+
+  /// Opens a counter of the hardware event `config`, returning its file
+  /// descriptor or -1.
+  static func open(_ config: UInt64) -> Int32 {
+#if os(Linux) && (arch(x86_64) || arch(arm64))
+#if arch(x86_64)
+    let sysPerfEventOpen = 298
+#else
+    let sysPerfEventOpen = 241
+#endif
+    // `syscall` is variadic, so Swift can't call it directly. Calling it
+    // through a non-variadic pointer works on these ABIs, which pass integer
+    // and pointer arguments the same way in both cases.
+    typealias SyscallFn = @convention(c)
+      (Int, UnsafeMutableRawPointer, Int32, Int32, Int32, UInt) -> Int
+    guard let sym = dlsym(dlopen(nil, RTLD_NOW), "syscall") else {
+      return -1
+    }
+    let syscall = unsafeBitCast(sym, to: SyscallFn.self)
+
+    // struct perf_event_attr in its original 64-byte layout
+    // (PERF_ATTR_SIZE_VER0), which every kernel accepts.
+    let size = 64
+    let attr = UnsafeMutableRawPointer.allocate(bytes: size, alignedTo: 8)
+    defer { attr.deallocate(bytes: size, alignedTo: 8) }
+    memset(attr, 0, size)
+    attr.storeBytes(of: 0, toByteOffset: 0, as: UInt32.self) // PERF_TYPE_HARDWARE
+    attr.storeBytes(of: UInt32(size), toByteOffset: 4, as: UInt32.self)
+    attr.storeBytes(of: config, toByteOffset: 8, as: UInt64.self)
+    // The exclude_kernel and exclude_hv bits of the flags.
+    attr.storeBytes(of: (1 << 5) | (1 << 6), toByteOffset: 40, as: UInt64.self)
+
+    // Count the calling thread on any CPU, not as part of a group.
+    let fd = syscall(sysPerfEventOpen, attr, 0, -1, -1, 0)
+    return Int32(truncatingBitPattern: fd)
+#else
+    return -1
+#endif
+  }
+}
+
 class SampleRunner {
+#if !os(Linux)
   var info = mach_timebase_info_data_t(numer: 0, denom: 0)
-  init() {
+#endif
+  let counters: PerfCounters?
+  let runtimeCounters: RuntimeCounters?
+
+  /// How much each hardware event counter advanced during the last `run`.
+  var counterDeltas = [UInt64]()
+
+  /// The runtime entry points called during the last `run`.
+  var runtimeDeltas = RuntimeCounts()
+
+  init(perfCounters: Bool, memoryStats: Bool) {
+#if !os(Linux)
     mach_timebase_info(&info)
+#endif
+    counters = perfCounters ? PerfCounters() : nil
+    runtimeCounters = memoryStats ? RuntimeCounters() : nil
+  }
+
+  /// Returns a monotonic time in ticks, which `nanoseconds` converts.
+  func ticks() -> UInt64 {
+#if os(Linux)
+    var ts = timespec()
+    clock_gettime(CLOCK_MONOTONIC, &ts)
+    return UInt64(ts.tv_sec) * 1_000_000_000 + UInt64(ts.tv_nsec)
+#else
+    return mach_absolute_time()
+#endif
+  }
+
+  func nanoseconds(_ ticks: UInt64) -> UInt64 {
+#if os(Linux)
+    return ticks
+#else
+    return ticks * UInt64(info.numer) / UInt64(info.denom)
+#endif
   }
+
   func run(_ name: String, fn: (Int) -> Void, num_iters: UInt) -> UInt64 {
     // Start the timer.
 #if SWIFT_RUNTIME_ENABLE_LEAK_CHECKER
     var str = name
     startTrackingObjects(UnsafeMutableRawPointer(str._core.startASCII))
 #endif
-    let start_ticks = mach_absolute_time()
+    let start_counts = counters?.read() ?? []
+    let start_runtime = runtimeCounters?.read() ?? RuntimeCounts()
+    let start_ticks = ticks()
     fn(Int(num_iters))
     // Stop the timer.
-    let end_ticks = mach_absolute_time()
+    let end_ticks = ticks()
+    // Read the runtime counts first; reading the perf counters allocates.
+    let end_runtime = runtimeCounters?.read() ?? RuntimeCounts()
+    let end_counts = counters?.read() ?? []
 #if SWIFT_RUNTIME_ENABLE_LEAK_CHECKER
     stopTrackingObjects(UnsafeMutableRawPointer(str._core.startASCII))
 #endif
 
+    counterDeltas = zip(start_counts, end_counts).map { $1 &- $0 }
+    runtimeDeltas.allocs = end_runtime.allocs &- start_runtime.allocs
+    runtimeDeltas.allocatedBytes =
+      end_runtime.allocatedBytes &- start_runtime.allocatedBytes
+    runtimeDeltas.retains = end_runtime.retains &- start_runtime.retains
+    runtimeDeltas.releases = end_runtime.releases &- start_runtime.releases
+
     // Compute the spent time and the scaling factor.
     let elapsed_ticks = end_ticks - start_ticks
-    return elapsed_ticks * UInt64(info.numer) / UInt64(info.denom)
+    return nanoseconds(elapsed_ticks)
+  }
+}
+
+//===--- Runtime counters -------------------------------------------------===//
+
+typealias AllocObjectFn = @convention(c)
+  (UnsafeRawPointer?, Int, Int) -> UnsafeMutableRawPointer?
+typealias RefCountFn = @convention(c) (UnsafeMutableRawPointer?) -> Void
+typealias RefCountNFn = @convention(c)
+  (UnsafeMutableRawPointer?, UInt32) -> Void
+
+/// The counts of the runtime entry points since the hooks were installed.
+struct RuntimeCounts {
+  var allocs: UInt64 = 0
+  var allocatedBytes: UInt64 = 0
+  var retains: UInt64 = 0
+  var releases: UInt64 = 0
+}
+
+// The hooks can't capture any context, so their state is global.
+var runtimeCounts = RuntimeCounts()
+var originalAllocObject: AllocObjectFn? = nil
+var originalRetain: RefCountFn? = nil
+var originalRetainN: RefCountNFn? = nil
+var originalRelease: RefCountFn? = nil
+var originalReleaseN: RefCountNFn? = nil
+
+/// Counts object allocations, retains and releases by replacing the function
+/// pointers through which the runtime calls its own implementations (see
+/// include/swift/Runtime/InstrumentsSupport.h).
+///
+/// The counts aren't updated atomically, so they are only exact for
+/// benchmarks that don't run Swift code on other threads.
+final class RuntimeCounters {
+  let allocObject: UnsafeMutablePointer<AllocObjectFn?>
+  let retain: UnsafeMutablePointer<RefCountFn?>
+  let retainN: UnsafeMutablePointer<RefCountNFn?>
+  let release: UnsafeMutablePointer<RefCountFn?>
+  let releaseN: UnsafeMutablePointer<RefCountNFn?>
+
+  /// Installs the hooks, or fails if the runtime doesn't export them.
+  init?() {
+    let handle = dlopen(nil, RTLD_NOW)
+    guard let allocObject = dlsym(handle, "_swift_allocObject"),
+          let retain = dlsym(handle, "_swift_retain"),
+          let retainN = dlsym(handle, "_swift_retain_n"),
+          let release = dlsym(handle, "_swift_release"),
+          let releaseN = dlsym(handle, "_swift_release_n") else {
+      return nil
+    }
+    self.allocObject = allocObject.assumingMemoryBound(to: AllocObjectFn?.self)
+    self.retain = retain.assumingMemoryBound(to: RefCountFn?.self)
+    self.retainN = retainN.assumingMemoryBound(to: RefCountNFn?.self)
+    self.release = release.assumingMemoryBound(to: RefCountFn?.self)
+    self.releaseN = releaseN.assumingMemoryBound(to: RefCountNFn?.self)
+
+    // Touch the counts so that the hooks never initialize them.
+    runtimeCounts = RuntimeCounts()
+    originalAllocObject = self.allocObject.pointee
+    originalRetain = self.retain.pointee
+    originalRetainN = self.retainN.pointee
+    originalRelease = self.release.pointee
+    originalReleaseN = self.releaseN.pointee
+
+    self.allocObject.pointee = { metadata, size, alignMask in
+      runtimeCounts.allocs = runtimeCounts.allocs &+ 1
+      runtimeCounts.allocatedBytes =
+        runtimeCounts.allocatedBytes &+ UInt64(size)
+      return originalAllocObject!(metadata, size, alignMask)
+    }
+    self.retain.pointee = { object in
+      runtimeCounts.retains = runtimeCounts.retains &+ 1
+      originalRetain!(object)
+    }
+    self.retainN.pointee = { object, n in
+      runtimeCounts.retains = runtimeCounts.retains &+ UInt64(n)
+      originalRetainN!(object, n)
+    }
+    self.release.pointee = { object in
+      runtimeCounts.releases = runtimeCounts.releases &+ 1
+      originalRelease!(object)
+    }
+    self.releaseN.pointee = { object, n in
+      runtimeCounts.releases = runtimeCounts.releases &+ UInt64(n)
+      originalReleaseN!(object, n)
+    }
+  }
+
+  deinit {
+    allocObject.pointee = originalAllocObject
+    retain.pointee = originalRetain
+    retainN.pointee = originalRetainN
+    release.pointee = originalRelease
+    releaseN.pointee = originalReleaseN
+  }
+
+  /// Returns the current counts. Reading them doesn't allocate, so it
+  /// doesn't disturb them.
+  func read() -> RuntimeCounts {
+    return runtimeCounts
+  }
+
+  /// Returns the peak resident set size of the process in kilobytes.
+  static func peakRSSKB() -> UInt64 {
+    var usage = rusage()
+    getrusage(RUSAGE_SELF, &usage)
+#if os(Linux)
+    return UInt64(usage.ru_maxrss)
+#else
+    // Darwin reports bytes.
+    return UInt64(usage.ru_maxrss) / 1024
+#endif
   }
 }
 
@@ -255,12 +613,24 @@ class SampleRunner {
 func runBench(_ name: String, _ fn: (Int) -> Void, _ c: TestConfig) -> BenchResults {
 
   var samples = [UInt64](repeating: 0, count: c.numSamples)
+  // The per-iteration counts of each hardware event, one entry per sample.
+  var eventSamples = [[UInt64]](repeating: [], count: PerfCounters.events.count)
+  // The per-iteration counts of allocations, allocated bytes, retains and
+  // releases, one entry per sample.
+  var allocSamples = [UInt64]()
+  var allocatedByteSamples = [UInt64]()
+  var retainSamples = [UInt64]()
+  var releaseSamples = [UInt64]()
 
   if c.verbose {
     print("Running \(name) for \(c.numSamples) samples.")
   }
 
-  let sampler = SampleRunner()
+  let sampler = SampleRunner(perfCounters: c.perfCounters,
+                             memoryStats: c.memoryStats)
+  // Forget what an earlier test declared.
+  _ = takeBytesPerIteration()
+  let startPeakRSS = RuntimeCounters.peakRSSKB()
   for s in 0..<c.numSamples {
     let time_per_sample: UInt64 = 1_000_000_000 * UInt64(c.iterationScale)
 
@@ -285,6 +655,16 @@ func runBench(_ name: String, _ fn: (Int) -> Void, _ c: TestConfig) -> BenchResu
     }
     // save result in microseconds or k-ticks
     samples[s] = elapsed_time / UInt64(scale) / 1000
+    for (i, delta) in sampler.counterDeltas.enumerated() {
+      eventSamples[i].append(delta / UInt64(scale))
+    }
+    if sampler.runtimeCounters != nil {
+      let deltas = sampler.runtimeDeltas
+      allocSamples.append(deltas.allocs / UInt64(scale))
+      allocatedByteSamples.append(deltas.allocatedBytes / UInt64(scale))
+      retainSamples.append(deltas.retains / UInt64(scale))
+      releaseSamples.append(deltas.releases / UInt64(scale))
+    }
     if c.verbose {
       print("    Sample \(s),\(samples[s])")
     }
@@ -292,10 +672,37 @@ func runBench(_ name: String, _ fn: (Int) -> Void, _ c: TestConfig) -> BenchResu
 
   let (mean, sd) = internalMeanSD(samples)
 
+  // Report the median count of each event, which like the median time is
+  // robust against the odd interrupted sample.
+  var counters: PerfCounterValues? = nil
+  if sampler.counters != nil {
+    counters = PerfCounterValues(eventSamples.map(internalMedian))
+  }
+  var memory: MemoryStatValues? = nil
+  if sampler.runtimeCounters != nil {
+    var m = MemoryStatValues()
+    m.allocs = internalMedian(allocSamples)
+    m.allocatedBytes = internalMedian(allocatedByteSamples)
+    m.retains = internalMedian(retainSamples)
+    m.releases = internalMedian(releaseSamples)
+    m.peakRSSDeltaKB = RuntimeCounters.peakRSSKB() - startPeakRSS
+    memory = m
+  }
+  var throughput: UInt64? = nil
+  if c.throughput {
+    // Bytes per microsecond are megabytes per second.
+    let bytes = UInt64(takeBytesPerIteration())
+    let median = internalMedian(samples)
+    throughput = median == 0 ? 0 : bytes / median
+  }
+
   // Return our benchmark results.
   return BenchResults(delim: c.delim, sampleCount: UInt64(samples.count),
                       min: samples.min()!, max: samples.max()!,
-                      mean: mean, sd: sd, median: internalMedian(samples))
+                      mean: mean, sd: sd, median: internalMedian(samples),
+                      counters: counters, memory: memory,
+                      throughput: throughput,
+                      samples: c.printSamples ? samples : nil)
 }
 
 func printRunInfo(_ c: TestConfig) {
@@ -304,6 +711,10 @@ func printRunInfo(_ c: TestConfig) {
     print("NumSamples: \(c.numSamples)")
     print("Verbose: \(c.verbose)")
     print("IterScale: \(c.iterationScale)")
+    print("PerfCounters: \(c.perfCounters)")
+    print("MemoryStats: \(c.memoryStats)")
+    print("PrintSamples: \(c.printSamples)")
+    print("Throughput: \(c.throughput)")
     if c.fixedNumIters != 0 {
       print("FixedIters: \(c.fixedNumIters)")
     }
@@ -322,9 +733,33 @@ func printRunInfo(_ c: TestConfig) {
 
 func runBenchmarks(_ c: TestConfig) {
   let units = "us"
-  print("#\(c.delim)TEST\(c.delim)SAMPLES\(c.delim)MIN(\(units))\(c.delim)MAX(\(units))\(c.delim)MEAN(\(units))\(c.delim)SD(\(units))\(c.delim)MEDIAN(\(units))")
+  var header = "#\(c.delim)TEST\(c.delim)SAMPLES\(c.delim)MIN(\(units))\(c.delim)MAX(\(units))\(c.delim)MEAN(\(units))\(c.delim)SD(\(units))\(c.delim)MEDIAN(\(units))"
+  if c.perfCounters {
+    header += "\(c.delim)CYCLES\(c.delim)INSTRUCTIONS\(c.delim)CACHE_MISSES\(c.delim)BRANCH_MISSES"
+  }
+  if c.memoryStats {
+    header += "\(c.delim)ALLOCS\(c.delim)ALLOC_BYTES\(c.delim)RETAINS\(c.delim)RELEASES\(c.delim)PEAK_RSS_DELTA(KB)"
+  }
+  if c.throughput {
+    header += "\(c.delim)THROUGHPUT(MB/s)"
+  }
+  if c.printSamples {
+    // The samples take this and all the following columns.
+    header += "\(c.delim)SAMPLE_VALUES"
+  }
+  print(header)
   var SumBenchResults = BenchResults()
   SumBenchResults.sampleCount = 0
+  if c.perfCounters {
+    SumBenchResults.counters = PerfCounterValues()
+  }
+  if c.memoryStats {
+    SumBenchResults.memory = MemoryStatValues()
+  }
+  if c.throughput {
+    // Throughputs don't add up; the column is only there to line up.
+    SumBenchResults.throughput = 0
+  }
 
   for t in c.tests {
     if !t.run {
@@ -341,6 +776,19 @@ func runBenchmarks(_ c: TestConfig) {
     SumBenchResults.max += results.max
     SumBenchResults.mean += results.mean
     SumBenchResults.sampleCount += 1
+    if let counters = results.counters {
+      SumBenchResults.counters!.cycles += counters.cycles
+      SumBenchResults.counters!.instructions += counters.instructions
+      SumBenchResults.counters!.cacheMisses += counters.cacheMisses
+      SumBenchResults.counters!.branchMisses += counters.branchMisses
+    }
+    if let memory = results.memory {
+      SumBenchResults.memory!.allocs += memory.allocs
+      SumBenchResults.memory!.allocatedBytes += memory.allocatedBytes
+      SumBenchResults.memory!.retains += memory.retains
+      SumBenchResults.memory!.releases += memory.releases
+      SumBenchResults.memory!.peakRSSDeltaKB += memory.peakRSSDeltaKB
+    }
     // Don't accumulate SD and Median, as simple sum isn't valid for them.
     // TODO: Compute SD and Median for total results as well.
     // SumBenchResults.sd += results.sd
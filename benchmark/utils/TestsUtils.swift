@@ -10,7 +10,11 @@
 //
 //===----------------------------------------------------------------------===//
 
+#if os(Linux)
+import Glibc
+#else
 import Darwin
+#endif
 
 // Linear function shift register.
 //
@@ -55,6 +59,22 @@ public func CheckResults(_ res: Bool, _ message: String = "") {
 
 public func False() -> Bool { return false }
 
+var bytesPerIteration = 0
+
+/// Declares that every iteration of the running test processes `bytes`
+/// bytes, so that the driver can report its throughput with `--throughput`.
+public func setBytesPerIteration(_ bytes: Int) {
+  bytesPerIteration = bytes
+}
+
+/// Returns and clears what the running test passed to
+/// `setBytesPerIteration`. Called by the driver.
+@_silgen_name("_swift_benchmark_takeBytesPerIteration")
+public func _takeBytesPerIteration() -> Int {
+  defer { bytesPerIteration = 0 }
+  return bytesPerIteration
+}
+
 /// This is a dummy protocol to test the speed of our protocol dispatch.
 public protocol SomeProtocol { func getValue() -> Int }
 struct MyStruct : SomeProtocol {
@@ -63,3 +83,47 @@ struct MyStruct : SomeProtocol {
 }
 public func someProtocolFactory() -> SomeProtocol { return MyStruct() }
 
+
+internal final class ThreadContext {
+  let body: (Int) -> ()
+  let thread: Int
+
+  init(_ body: @escaping (Int) -> (), _ thread: Int) {
+    self.body = body
+    self.thread = thread
+  }
+}
+
+internal func runThreadContext(
+  _ contextAsVoidPointer: UnsafeMutableRawPointer?
+) -> UnsafeMutableRawPointer! {
+  // The context is passed in +1; we're responsible for releasing it.
+  let context = Unmanaged<ThreadContext>
+    .fromOpaque(contextAsVoidPointer!)
+    .takeRetainedValue()
+  context.body(context.thread)
+  return nil
+}
+
+/// Runs `body` on `threads` threads at once, passing each its index, and
+/// waits for all of them to finish.
+public func runConcurrently(threads: Int, _ body: @escaping (Int) -> ()) {
+#if os(Linux)
+  var threadIDs = [pthread_t](repeating: pthread_t(), count: threads)
+#else
+  var threadIDs = [pthread_t?](repeating: nil, count: threads)
+#endif
+  for t in 0..<threads {
+    let context = Unmanaged.passRetained(ThreadContext(body, t)).toOpaque()
+    let result = pthread_create(&threadIDs[t], nil,
+      { runThreadContext($0) }, context)
+    CheckResults(result == 0, "pthread_create failed")
+  }
+  for t in 0..<threads {
+#if os(Linux)
+    pthread_join(threadIDs[t], nil)
+#else
+    pthread_join(threadIDs[t]!, nil)
+#endif
+  }
+}
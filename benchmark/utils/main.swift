@@ -38,6 +38,7 @@ import Calculator
 import CaptureProp
 import Chars
 import ClassArrayGetter
+import ConcurrentRuntime
 import DeadArray
 import DictTest
 import DictTest2
@@ -90,9 +91,11 @@ import StaticArray
 import StrComplexWalk
 import StrToInt
 import StringBuilder
+import StringCorpus
 import StringInterpolation
 import StringTests
 import StringWalk
+import StructReturn
 import SuperChars
 import TwoSum
 import TypeFlood
@@ -222,6 +225,27 @@ precommitTests = [
   "StrComplexWalk": run_StrComplexWalk,
   "StrToInt": run_StrToInt,
   "StringBuilder": run_StringBuilder,
+  "StringCorpusCharacterCountEmoji": run_StringCorpusCharacterCountEmoji,
+  "StringCorpusCharacterCountJSON": run_StringCorpusCharacterCountJSON,
+  "StringCorpusCharacterCountMixed": run_StringCorpusCharacterCountMixed,
+  "StringCorpusCompareEmoji": run_StringCorpusCompareEmoji,
+  "StringCorpusCompareJSON": run_StringCorpusCompareJSON,
+  "StringCorpusCompareMixed": run_StringCorpusCompareMixed,
+  "StringCorpusHashEmoji": run_StringCorpusHashEmoji,
+  "StringCorpusHashJSON": run_StringCorpusHashJSON,
+  "StringCorpusHashMixed": run_StringCorpusHashMixed,
+  "StringCorpusNSStringRoundTripEmoji": run_StringCorpusNSStringRoundTripEmoji,
+  "StringCorpusNSStringRoundTripJSON": run_StringCorpusNSStringRoundTripJSON,
+  "StringCorpusNSStringRoundTripMixed": run_StringCorpusNSStringRoundTripMixed,
+  "StringCorpusSplitEmoji": run_StringCorpusSplitEmoji,
+  "StringCorpusSplitJSON": run_StringCorpusSplitJSON,
+  "StringCorpusSplitMixed": run_StringCorpusSplitMixed,
+  "StringCorpusUTF16Emoji": run_StringCorpusUTF16Emoji,
+  "StringCorpusUTF16JSON": run_StringCorpusUTF16JSON,
+  "StringCorpusUTF16Mixed": run_StringCorpusUTF16Mixed,
+  "StringCorpusUTF8Emoji": run_StringCorpusUTF8Emoji,
+  "StringCorpusUTF8JSON": run_StringCorpusUTF8JSON,
+  "StringCorpusUTF8Mixed": run_StringCorpusUTF8Mixed,
   "StringEqualPointerComparison": run_StringEqualPointerComparison,
   "StringHasPrefix": run_StringHasPrefix,
   "StringHasPrefixUnicode": run_StringHasPrefixUnicode,
@@ -230,6 +254,9 @@ precommitTests = [
   "StringInterpolation": run_StringInterpolation,
   "StringWalk": run_StringWalk,
   "StringWithCString": run_StringWithCString,
+  "StructReturnFiveFields": run_StructReturnFiveFields,
+  "StructReturnQuaternion": run_StructReturnQuaternion,
+  "StructReturnVector3": run_StructReturnVector3,
   "SuperChars": run_SuperChars,
   "TwoSum": run_TwoSum,
   "TypeFlood": run_TypeFlood,
@@ -241,6 +268,31 @@ precommitTests = [
 otherTests = [
   "Ackermann": run_Ackermann,
   "Fibonacci": run_Fibonacci,
+  "ConcurrentConformsToProtocol1": run_ConcurrentConformsToProtocol1,
+  "ConcurrentConformsToProtocol16": run_ConcurrentConformsToProtocol16,
+  "ConcurrentConformsToProtocol2": run_ConcurrentConformsToProtocol2,
+  "ConcurrentConformsToProtocol4": run_ConcurrentConformsToProtocol4,
+  "ConcurrentConformsToProtocol8": run_ConcurrentConformsToProtocol8,
+  "ConcurrentGenericMetadata1": run_ConcurrentGenericMetadata1,
+  "ConcurrentGenericMetadata16": run_ConcurrentGenericMetadata16,
+  "ConcurrentGenericMetadata2": run_ConcurrentGenericMetadata2,
+  "ConcurrentGenericMetadata4": run_ConcurrentGenericMetadata4,
+  "ConcurrentGenericMetadata8": run_ConcurrentGenericMetadata8,
+  "ConcurrentOnce1": run_ConcurrentOnce1,
+  "ConcurrentOnce16": run_ConcurrentOnce16,
+  "ConcurrentOnce2": run_ConcurrentOnce2,
+  "ConcurrentOnce4": run_ConcurrentOnce4,
+  "ConcurrentOnce8": run_ConcurrentOnce8,
+  "ConcurrentRetain1": run_ConcurrentRetain1,
+  "ConcurrentRetain16": run_ConcurrentRetain16,
+  "ConcurrentRetain2": run_ConcurrentRetain2,
+  "ConcurrentRetain4": run_ConcurrentRetain4,
+  "ConcurrentRetain8": run_ConcurrentRetain8,
+  "ConcurrentTypeName1": run_ConcurrentTypeName1,
+  "ConcurrentTypeName16": run_ConcurrentTypeName16,
+  "ConcurrentTypeName2": run_ConcurrentTypeName2,
+  "ConcurrentTypeName4": run_ConcurrentTypeName4,
+  "ConcurrentTypeName8": run_ConcurrentTypeName8,
 ]
 
 
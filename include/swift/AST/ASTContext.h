@@ -156,6 +156,30 @@ public:
   ~ConstraintCheckerArenaRAII();
 };
 
+/// \brief Lets the current thread use an ASTContext that other threads are
+/// using as well, for the lifetime of this RAII object.
+///
+/// The thread allocates permanent AST nodes from an allocator of its own,
+/// whose memory the ASTContext takes over when this object is destroyed, and
+/// gets a constraint checker arena slot of its own. Concurrent access must
+/// have been enabled on the context; only the thread that enabled it may go
+/// on using the context without one of these objects.
+class ASTContextThreadRAII {
+  ASTContext &Self;
+  void *Data;
+
+public:
+  explicit ASTContextThreadRAII(ASTContext &self);
+
+  ASTContextThreadRAII(const ASTContextThreadRAII &) = delete;
+  ASTContextThreadRAII(ASTContextThreadRAII &&) = delete;
+
+  ASTContextThreadRAII &operator=(const ASTContextThreadRAII &) = delete;
+  ASTContextThreadRAII &operator=(ASTContextThreadRAII &&) = delete;
+
+  ~ASTContextThreadRAII();
+};
+
 /// \brief Describes either a nominal type declaration or an extension
 /// declaration.
 typedef llvm::PointerUnion<NominalTypeDecl *, ExtensionDecl *>
@@ -245,6 +269,17 @@ public:
   llvm::BumpPtrAllocator &
   getAllocator(AllocationArena arena = AllocationArena::Permanent) const;
 
+  /// \brief Allow threads other than the current one to use this context
+  /// through an \c ASTContextThreadRAII.
+  ///
+  /// From then on, the tables that unique types, conformances, generic
+  /// signatures, and identifiers are protected by a lock. This must be called
+  /// before any other thread uses the context.
+  void enableConcurrentAccess();
+
+  /// \brief Determine whether other threads may be using this context.
+  bool isConcurrentAccessEnabled() const;
+
   /// Allocate - Allocate memory from the ASTContext bump pointer.
   void *Allocate(unsigned long bytes, unsigned alignment,
                  AllocationArena arena = AllocationArena::Permanent) const {
@@ -699,6 +734,15 @@ public:
   Optional<ArrayRef<Substitution>>
   getSubstitutions(TypeBase *type, DeclContext *gpContext) const;
 
+  /// \brief Retrieve the uniqued, canonical form of the given substitutions.
+  ///
+  /// The replacement types of the result are canonical. Two substitution
+  /// lists are equal, as compared by \c Substitution::operator==, exactly
+  /// when their canonical forms have the same address, so the result can be
+  /// compared and hashed by pointer.
+  ArrayRef<Substitution>
+  getCanonicalSubstitutions(ArrayRef<Substitution> subs) const;
+
   /// Record a conformance loader and its context data for the given
   /// declaration.
   void recordConformanceLoader(Decl *decl, LazyMemberLoader *resolver,
@@ -775,6 +819,20 @@ public:
   ArchetypeBuilder *getOrCreateArchetypeBuilder(CanGenericSignature sig,
                                                 ModuleDecl *mod);
 
+  /// Retrieve or create the archetype builder shared by the members of a
+  /// generic context that have no generic parameters of their own, which
+  /// holds the (sugared) generic signature of that context.
+  ///
+  /// The builder is never finalized; a client that needs to finalize it,
+  /// e.g., to diagnose a nested type that doesn't exist, has to stop
+  /// sharing it with \c retireContextArchetypeBuilder() first.
+  ArchetypeBuilder *getOrCreateContextArchetypeBuilder(GenericSignature *sig,
+                                                       ModuleDecl *mod);
+
+  /// Stop sharing the archetype builder for the given generic context
+  /// signature and module. Its clients may still use it.
+  void retireContextArchetypeBuilder(GenericSignature *sig, ModuleDecl *mod);
+
   /// Retrieve the inherited name set for the given class.
   const InheritedNameSet *getAllPropertyNames(ClassDecl *classDecl,
                                               bool forInstance);
@@ -34,6 +34,7 @@ class CaseStmt;
 class CatchStmt;
 class ClosureExpr;
 class Decl;
+class DeclName;
 class DoCatchStmt;
 class Expr;
 class ForStmt;
@@ -149,6 +150,8 @@ enum class ASTScopeKind : uint8_t {
 /// -dump-scope-maps expanded
 /// \endcode
 class ASTScope {
+  struct LocalLookupCache;
+
   /// The kind of scope this represents.
   ASTScopeKind kind;
 
@@ -190,6 +193,10 @@ class ASTScope {
       ///
       /// This accommodates the expansion of source files.
       mutable unsigned nextElement;
+
+      /// The memoized results of \c skipScopesWithoutLocalBinding() for the
+      /// scopes of this source file, allocated on first use.
+      mutable LocalLookupCache *lookupCache;
     } sourceFile;
 
     /// A type declaration, for \c kind == ASTScopeKind::TypeDecl.
@@ -543,6 +550,19 @@ class ASTScope {
   /// Retrieve the source file in which this scope exists.
   SourceFile &getSourceFile() const;
 
+  /// Retrieve the local lookup cache of the source file, creating it if
+  /// needed.
+  LocalLookupCache &getLocalLookupCache() const;
+
+  /// Forget the memoized results of \c skipScopesWithoutLocalBinding(),
+  /// because the scopes or their bindings may have changed.
+  void invalidateLocalLookupCache() const;
+
+  /// Determine whether unqualified lookup of \p name has to stop at this
+  /// scope, either because it binds something that could be named \p name or
+  /// because lookup does more here than look at the local bindings.
+  bool stopsLocalLookup(DeclName name) const;
+
 public:
   /// Create the AST scope for a source file, which is the root of the scope
   /// tree.
@@ -625,6 +645,17 @@ public:
   /// client can perform such lookups using the result of \c getDeclContext().
   SmallVector<ValueDecl *, 4> getLocalBindings() const;
 
+  /// Find the innermost scope, starting with this one and walking outward,
+  /// in which unqualified lookup of \p name has anything to do.
+  ///
+  /// The scopes skipped over bind nothing named \p name and have no
+  /// declaration context, so unqualified lookup can resume at the result
+  /// without changing its outcome. This keeps lookup from walking the long
+  /// chains of scopes that the locals of large functions introduce on every
+  /// query: results are memoized for the whole source file, for each scope
+  /// visited along the way.
+  const ASTScope *skipScopesWithoutLocalBinding(DeclName name) const;
+
   /// Expand the entire scope map.
   ///
   /// Normally, the scope map will be expanded only as needed by its queries,
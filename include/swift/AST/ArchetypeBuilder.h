@@ -305,6 +305,10 @@ public:
   /// be made concrete.
   void finalize(SourceLoc loc, bool allowConcreteGenericParams=false);
 
+  /// Determine whether any of the nested types named so far could not be
+  /// resolved, which \c finalize() will diagnose.
+  bool hasUnresolvedNestedTypes() const;
+
   /// \brief Resolve the given type to the potential archetype it names.
   ///
   /// This routine will synthesize nested types as required to refer to a
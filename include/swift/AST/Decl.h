@@ -4674,6 +4674,15 @@ public:
     setBodyKind(BodyKind::Skipped);
   }
 
+  /// \brief Note that the body was parsed but will not be type-checked.
+  /// Function body cannot be attached after this call.
+  void setParsedBodySkipped() {
+    assert(getBodyKind() == BodyKind::Parsed);
+    SourceRange bodyRange = getBodySourceRange();
+    BodyRange = bodyRange;
+    setBodyKind(BodyKind::Skipped);
+  }
+
   /// \brief Note that parsing for the body was delayed.
   void setBodyDelayed(SourceRange bodyRange) {
     assert(getBodyKind() == BodyKind::None);
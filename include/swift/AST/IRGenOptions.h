@@ -158,9 +158,38 @@ public:
   /// measurements on a non-clean build directory.
   unsigned UseIncrementalLLVMCodeGen : 1;
 
+  /// If non-empty, a directory in which object files are stored by the hash
+  /// of the llvm IR they were generated from, so that incremental llvm code
+  /// generation can reuse them even if the output file was overwritten.
+  std::string LLVMObjectCachePath;
+
   /// Enable use of the swiftcall calling convention.
   unsigned UseSwiftCall : 1;
 
+  /// Emit copies and destroys of large aggregates as calls to a helper
+  /// function shared by all of their uses, instead of inline.
+  unsigned EnableCopyOutlining : 1;
+
+  /// Emit fully instantiated metadata for generic struct instantiations whose
+  /// generic arguments are known at compile time, instead of instantiating it
+  /// from the metadata pattern at runtime.
+  unsigned EnableGenericMetadataPrespecialization : 1;
+
+  /// Don't emit conformance, type metadata and field metadata records for
+  /// internal types whose values and metadata the runtime can't encounter in
+  /// a whole-module compilation, so that the linker can strip their metadata.
+  unsigned StripUnusedTypeRecords : 1;
+
+  /// Drop the SIL function bodies once the whole module is lowered to IR, so
+  /// that they don't stay alive through the LLVM passes. Only valid if
+  /// nothing looks at the SIL after IRGen.
+  unsigned FreeSILAfterIRGen : 1;
+
+  /// If non-zero, the maximum number of scalars returned directly, and
+  /// passed directly for a single parameter, instead of the target's default.
+  unsigned MaxScalarsForDirectResult;
+  unsigned MaxScalarsForDirectParameter;
+
   /// List of backend command-line options for -embed-bitcode.
   std::vector<uint8_t> CmdArgs;
 
@@ -177,7 +206,12 @@ public:
         PrintInlineTree(false), EmbedMode(IRGenEmbedMode::None),
         HasValueNamesSetting(false), ValueNames(false),
         EnableReflectionMetadata(true), EnableReflectionNames(true),
-        UseIncrementalLLVMCodeGen(true), UseSwiftCall(false), CmdArgs(),
+        UseIncrementalLLVMCodeGen(true), UseSwiftCall(false),
+        EnableCopyOutlining(false),
+        EnableGenericMetadataPrespecialization(false),
+        StripUnusedTypeRecords(false), FreeSILAfterIRGen(false),
+        MaxScalarsForDirectResult(0),
+        MaxScalarsForDirectParameter(0), CmdArgs(),
         SanitizeCoverage(llvm::SanitizerCoverageOptions()) {}
 
   /// Gets the name of the specified output filename.
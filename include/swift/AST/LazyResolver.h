@@ -17,8 +17,12 @@
 #ifndef SWIFT_AST_LAZYRESOLVER_H
 #define SWIFT_AST_LAZYRESOLVER_H
 
+#include "swift/AST/Identifier.h"
+#include "swift/AST/TypeAlignments.h"
 #include "swift/AST/TypeLoc.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/PointerEmbeddedInt.h"
+#include "llvm/ADT/TinyPtrVector.h"
 
 namespace swift {
 
@@ -204,8 +208,23 @@ public:
     llvm_unreachable("unimplemented");
   }
 
+  /// Returns the member decls of \p D with the base name \p N, without
+  /// loading its other members, or None if the loader can't find members by
+  /// name.
+  ///
+  /// The implementation should \em not add the members to D; they are added
+  /// when all of its members are loaded.
+  virtual Optional<TinyPtrVector<ValueDecl *>>
+  loadNamedMembers(Decl *D, Identifier N, uint64_t contextData) {
+    return None;
+  }
+
   /// Populates the given vector with all conformances for \p D.
   ///
+  /// These must be the resolved conformances of \p D, including the ones
+  /// implied by its explicit conformances; the conformance lookup table does
+  /// not derive them again.
+  ///
   /// The implementation should \em not call setConformances on \p D.
   virtual void
   loadAllConformances(const Decl *D, uint64_t contextData,
@@ -810,6 +810,17 @@ private:
   /// this source file so far.
   llvm::MD5 InterfaceHash;
 
+  /// A hash of the interface-contributing tokens of the top-level declaration
+  /// currently being parsed, if any.
+  Optional<llvm::MD5> CurrentDeclInterfaceHash;
+
+  /// The interface hash of each top-level declaration, covering only the
+  /// tokens of that declaration.
+  ///
+  /// These let dependency tracking tell which declarations an edit to this
+  /// file actually touched.
+  llvm::DenseMap<const Decl *, std::string> DeclInterfaceHashes;
+
   /// \brief The ID for the memory buffer containing this file's source.
   ///
   /// May be -1, to indicate no association with a buffer.
@@ -1043,6 +1054,44 @@ public:
     // Add null byte to separate tokens.
     uint8_t a[1] = {0};
     InterfaceHash.update(a);
+    if (CurrentDeclInterfaceHash) {
+      CurrentDeclInterfaceHash->update(token);
+      CurrentDeclInterfaceHash->update(a);
+    }
+  }
+
+  /// Starts hashing the interface tokens of a top-level declaration.
+  ///
+  /// Returns false if another declaration is already being hashed, in which
+  /// case the tokens are attributed to that one.
+  bool beginDeclInterfaceHash() {
+    if (CurrentDeclInterfaceHash)
+      return false;
+    CurrentDeclInterfaceHash.emplace();
+    return true;
+  }
+
+  /// Finishes the hash started by beginDeclInterfaceHash() and records it for
+  /// each of \p decls, which were all parsed from the same source.
+  void endDeclInterfaceHash(ArrayRef<Decl *> decls) {
+    assert(CurrentDeclInterfaceHash && "not hashing a declaration");
+    llvm::MD5::MD5Result result;
+    CurrentDeclInterfaceHash->final(result);
+    CurrentDeclInterfaceHash.reset();
+
+    llvm::SmallString<32> str;
+    llvm::MD5::stringifyResult(result, str);
+    for (const Decl *D : decls)
+      DeclInterfaceHashes[D] = str.str();
+  }
+
+  /// Returns the interface hash of the top-level declaration \p D, or an
+  /// empty string if none was recorded.
+  StringRef getDeclInterfaceHash(const Decl *D) const {
+    auto found = DeclInterfaceHashes.find(D);
+    if (found == DeclInterfaceHashes.end())
+      return StringRef();
+    return found->second;
   }
 
   const llvm::MD5 &getInterfaceHashState() { return InterfaceHash; }
@@ -55,12 +55,28 @@ public:
   /// Controls how to perform SIL linking.
   LinkingMode LinkMode = LinkNormal;
 
+  /// Don't copy the bodies of imported fragile functions into the module up
+  /// front. Instead, deserialize a body when an optimization wants to inline
+  /// or specialize that particular function.
+  bool LinkOnDemand = false;
+
   /// Remove all runtime assertions during optimizations.
   bool RemoveRuntimeAsserts = false;
 
   /// Controls whether the SIL ARC optimizations are run.
   bool EnableARCOptimizations = true;
 
+  /// Move code that always ends in a trap out of line, into cold functions.
+  bool EnableColdCodeOutlining = false;
+
+  /// Use non-atomic reference counting for objects which provably never
+  /// escape the thread that allocated them.
+  bool EnableNonAtomicRC = false;
+
+  /// Serialize the optimized bodies of generic and small public functions,
+  /// so that clients can inline and specialize them.
+  bool EnableCrossModuleOptimization = false;
+
   /// Should we run any SIL performance optimizations
   ///
   /// Useful when you want to enable -O LLVM opts but not -O SIL opts.
@@ -101,6 +117,10 @@ public:
   /// Emit a mapping of profile counters for use in coverage.
   bool EmitProfileCoverageMapping = false;
 
+  /// The path to an indexed profile (from llvm-profdata) whose execution
+  /// counts should guide optimization, or empty.
+  std::string UseProfile;
+
   /// Should we use a pass pipeline passed in via a json file? Null by default.
   llvm::StringRef ExternalPassPipelineFilename;
   
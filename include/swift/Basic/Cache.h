@@ -129,6 +129,16 @@ protected:
   /// Invokes \c remove on all keys.
   void removeAll();
 
+  /// Sets the total cost of the values the cache should keep.
+  ///
+  /// \param Limit The limit on the sum of the costs passed to
+  /// \c setAndRetain().
+  ///
+  /// Once the costs exceed the limit, the cache evicts the least recently
+  /// used values which aren't retained.  This is a hint on platforms which
+  /// evict based on the memory pressure of the system.
+  void setCostLimit(size_t Limit);
+
   /// Destroys cache.
   void destroy();
 };
@@ -192,6 +202,11 @@ public:
     removeAll();
   }
 
+  /// Sets the limit on the total cost of the values in the cache.
+  void setCostLimit(size_t Limit) {
+    CacheImpl::setCostLimit(Limit);
+  }
+
 private:
   static uintptr_t keyHash(void *Key, void *UserData) {
     return KeyInfoT::getHashValue(*static_cast<KeyT*>(Key));
@@ -208,6 +223,13 @@ private:
   }
 };
 
+/// Evicts the values of all caches which aren't currently retained.
+///
+/// On Darwin, libcache responds to the memory pressure of the system on its
+/// own, and this does nothing.  Elsewhere, clients should call this when they
+/// learn that memory is running low.
+void purgeCachesForMemoryPressure();
+
 template <typename T>
 struct CacheValueInfo<llvm::IntrusiveRefCntPtr<T>>{
   static void *enterCache(const llvm::IntrusiveRefCntPtr<T> &Val) {
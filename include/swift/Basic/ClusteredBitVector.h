@@ -467,6 +467,24 @@ public:
     return *this;
   }
 
+  /// Clear all the bits of this vector which are set in a bit-vector of
+  /// the same size.
+  ClusteredBitVector &subtract(const ClusteredBitVector &other) {
+    assert(size() == other.size());
+
+    // If either vector is all-clear, this is a no-op.
+    if (isInlineAndAllClear() || other.isInlineAndAllClear())
+      return *this;
+
+    // Otherwise, mask out the other vector's bits chunk by chunk.
+    auto chunks = getChunks();
+    auto oi = other.getChunksPtr();
+    for (auto i = chunks.begin(), e = chunks.end(); i != e; ++i, ++oi) {
+      *i &= ~*oi;
+    }
+    return *this;
+  }
+
   /// Set bit i.
   void setBit(size_t i) {
     assert(i < size());
@@ -506,6 +524,18 @@ public:
     }
   }
 
+  /// Clear all the bits in this vector, without changing its length.
+  void clearAll() {
+    if (isInlineAndAllClear()) return;
+    if (!hasOutOfLineData()) {
+      Data = 0;
+      return;
+    }
+    for (auto &chunk : getChunks()) {
+      chunk = 0;
+    }
+  }
+
   /// Set the length of this vector to zero, but do not release any capacity.
   void clear() {
     LengthInBits = 0;
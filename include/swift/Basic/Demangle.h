@@ -18,6 +18,7 @@
 #include <vector>
 #include <cassert>
 #include <cstdint>
+#include "llvm/ADT/IntrusiveRefCntPtr.h"
 #include "llvm/ADT/StringRef.h"
 #include "swift/Basic/Malloc.h"
 
@@ -69,7 +70,10 @@ struct DemangleOptions {
 };
 
 class Node;
-typedef std::shared_ptr<Node> NodePointer;
+
+/// Demangle trees are built and walked by a single thread, so nodes use a
+/// non-atomic intrusive reference count rather than std::shared_ptr.
+typedef llvm::IntrusiveRefCntPtr<Node> NodePointer;
 
 enum class FunctionSigSpecializationParamKind : unsigned {
   // Option Flags use bits 0-5. This give us 6 bits implying 64 entries to
@@ -135,7 +139,7 @@ enum class Directness {
   Direct, Indirect
 };
 
-class Node : public std::enable_shared_from_this<Node> {
+class Node : public llvm::RefCountedBase<Node> {
 public:
   enum class Kind : uint16_t {
 #define NODE(ID) ID,
@@ -157,9 +161,15 @@ private:
     IndexType IndexPayload;
   };
 
-  // FIXME: use allocator.
-  typedef std::vector<NodePointer> NodeVector;
-  NodeVector Children;
+  /// Most nodes have at most two children, which are stored inline.  Larger
+  /// child lists move to the heap.
+  enum : uint32_t { NumInlineChildren = 2 };
+  NodePointer *Children = InlineChildren;
+  uint32_t NumChildren = 0;
+  uint32_t ChildCapacity = NumInlineChildren;
+  NodePointer InlineChildren[NumInlineChildren];
+
+  void growChildren();
 
   Node(Kind k)
       : NodeKind(k), NodePayloadKind(PayloadKind::None) {
@@ -194,19 +204,25 @@ public:
     return IndexPayload;
   }
   
-  typedef NodeVector::iterator iterator;
-  typedef NodeVector::const_iterator const_iterator;
-  typedef NodeVector::size_type size_type;
-
-  bool hasChildren() const { return !Children.empty(); }
-  size_t getNumChildren() const { return Children.size(); }
-  iterator begin() { return Children.begin(); }
-  iterator end() { return Children.end(); }
-  const_iterator begin() const { return Children.begin(); }
-  const_iterator end() const { return Children.end(); }
-
-  NodePointer getFirstChild() const { return Children.front(); }
-  NodePointer getChild(size_t index) const { return Children[index]; }
+  typedef NodePointer *iterator;
+  typedef const NodePointer *const_iterator;
+  typedef size_t size_type;
+
+  bool hasChildren() const { return NumChildren != 0; }
+  size_t getNumChildren() const { return NumChildren; }
+  iterator begin() { return Children; }
+  iterator end() { return Children + NumChildren; }
+  const_iterator begin() const { return Children; }
+  const_iterator end() const { return Children + NumChildren; }
+
+  NodePointer getFirstChild() const {
+    assert(NumChildren != 0 && "node has no children");
+    return Children[0];
+  }
+  NodePointer getChild(size_t index) const {
+    assert(index < NumChildren && "child index out of range");
+    return Children[index];
+  }
 
   /// Add a new node as a child of this one.
   ///
@@ -214,7 +230,9 @@ public:
   /// \returns child
   NodePointer addChild(NodePointer child) {
     assert(child && "adding null child!");
-    Children.push_back(child);
+    if (NumChildren == ChildCapacity)
+      growChildren();
+    Children[NumChildren++] = child;
     return child;
   }
 
@@ -127,10 +127,20 @@ namespace swift {
     /// ID of the current process for the purposes of AST verification.
     unsigned ASTVerifierProcessId = 1U;
 
+    /// Number of worker processes which verify the declarations of a source
+    /// file, or the functions of a SIL module, in parallel.
+    ///
+    /// \sa swift::runShardsInWorkerProcesses
+    unsigned VerifierWorkerCount = 1U;
+
     /// \brief The upper bound, in bytes, of temporary data that can be
     /// allocated by the constraint solver.
     unsigned SolverMemoryThreshold = 33554432; /* 32 * 1024 * 1024 */
 
+    /// \brief The upper bound, in seconds, of the time the constraint solver
+    /// may spend on a single expression. Zero means no limit.
+    unsigned SolverExpressionTimeThreshold = 0;
+
     /// \brief Perform all dynamic allocations using malloc/free instead of
     /// optimized custom allocator, so that memory debugging tools can be used.
     bool UseMalloc = false;
@@ -153,6 +163,10 @@ namespace swift {
     /// Should we use \c ASTScope-based resolution for unqualified name lookup?
     bool EnableASTScopeLookup = false;
 
+    /// Should member lookup into imported types only load the members with
+    /// the name being looked up?
+    bool NamedLazyMemberLoading = false;
+
     /// Whether to use the import as member inference system
     ///
     /// When importing a global, try to infer whether we can import it as a
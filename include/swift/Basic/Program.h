@@ -13,6 +13,9 @@
 #ifndef SWIFT_BASIC_PROGRAM_H
 #define SWIFT_BASIC_PROGRAM_H
 
+#include "swift/Basic/LLVM.h"
+#include "llvm/ADT/STLExtras.h"
+
 namespace swift {
 
 /// \brief This function executes the program using the arguments provided,
@@ -33,6 +36,23 @@ namespace swift {
 int ExecuteInPlace(const char *Program, const char **args,
                    const char **env = nullptr);
 
+/// \brief Calls \p body for each shard in [0, numShards), each in a worker
+/// process forked from the current one, if supported.
+///
+/// The workers run concurrently on a copy-on-write snapshot of the current
+/// process, so \p body may use caches which are not thread-safe, but none of
+/// its side effects are visible to the caller. The only output of a worker is
+/// what it writes to stderr, which is buffered and replayed in shard order
+/// once all workers have finished. This is meant for read-only checks, such
+/// as the verifiers.
+///
+/// This must not be called while other threads are running. If workers can't
+/// be forked, the shards are run in the current process, one after another.
+///
+/// \returns false if a worker exited abnormally or with a nonzero status.
+bool runShardsInWorkerProcesses(unsigned numShards,
+                                llvm::function_ref<void(unsigned)> body);
+
 } // end namespace swift
 
 #endif // SWIFT_BASIC_PROGRAM_H
@@ -14,12 +14,15 @@
 #define SWIFT_BASIC_TIMER_H
 
 #include "swift/Basic/LLVM.h"
+#include "swift/Basic/Trace.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/Support/Timer.h"
 
 namespace swift {
   /// A convenience class for declaring a timer that's part of the Swift
   /// compilation timers group.
+  ///
+  /// Each SharedTimer is also a "phase" event of the -trace-output timeline.
   class SharedTimer {
     enum class State {
       Initial,
@@ -28,10 +31,11 @@ namespace swift {
     };
     static State CompilationTimersEnabled;
 
+    TraceScope Trace;
     Optional<llvm::NamedRegionTimer> Timer;
 
   public:
-    explicit SharedTimer(StringRef name) {
+    explicit SharedTimer(StringRef name) : Trace("phase", name) {
       if (CompilationTimersEnabled == State::Enabled)
         Timer.emplace(name, StringRef("Swift compilation"));
       else
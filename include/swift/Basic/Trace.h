@@ -0,0 +1,77 @@
+//===--- Trace.h - Timeline of a compilation --------------------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file declares TraceScope, which records the scoped events written by
+//  -trace-output in the Chrome trace event format.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_BASIC_TRACE_H
+#define SWIFT_BASIC_TRACE_H
+
+#include "swift/Basic/LLVM.h"
+#include "llvm/ADT/StringRef.h"
+#include <cstdint>
+#include <string>
+#include <utility>
+
+namespace swift {
+  /// Records the time spent in a scope as an event of the compilation
+  /// timeline. chrome://tracing shows the events of each thread nested by
+  /// their scopes.
+  ///
+  /// A TraceScope does nothing unless tracing has been enabled. The name of
+  /// the event can be passed as a callable returning a std::string, which is
+  /// only called if the event is recorded.
+  class TraceScope {
+    static bool TracingEnabled;
+
+    /// The category of the event, or null if it is not recorded.
+    const char *Category = nullptr;
+    std::string Name;
+    uint64_t StartTime = 0;
+
+    void begin(const char *category, std::string name);
+    void end();
+
+  public:
+    TraceScope(const char *category, StringRef name) {
+      if (TracingEnabled)
+        begin(category, name.str());
+    }
+
+    template <typename NameFn,
+              typename = decltype(std::string(std::declval<NameFn &>()()))>
+    TraceScope(const char *category, NameFn &&getName) {
+      if (TracingEnabled)
+        begin(category, getName());
+    }
+
+    ~TraceScope() {
+      if (Category)
+        end();
+    }
+
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+    static bool isTracingEnabled() { return TracingEnabled; }
+
+    /// Must be called before any other thread creates a TraceScope.
+    static void enableTracing();
+
+    /// Writes all the events recorded so far as a Chrome trace event file.
+    static void writeTrace(raw_ostream &OS);
+  };
+} // end namespace swift
+
+#endif // SWIFT_BASIC_TRACE_H
@@ -211,6 +211,13 @@ public:
   std::string getBridgingHeaderContents(StringRef headerPath, off_t &fileSize,
                                         time_t &fileModTime);
 
+  /// Precompiles the given bridging header into \p outputPCHPath.
+  ///
+  /// An existing PCH with the same contents is left untouched.
+  ///
+  /// \returns true if there was an error emitting the PCH.
+  bool emitBridgingPCH(StringRef headerPath, StringRef outputPCHPath);
+
   const clang::Module *getClangOwningModule(ClangNode Node) const;
   bool hasTypedef(const clang::Decl *typeDecl) const;
 
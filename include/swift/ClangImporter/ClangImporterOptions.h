@@ -24,6 +24,17 @@ public:
   /// The module cache path which the Clang importer should use.
   std::string ModuleCachePath;
 
+  /// If nonzero, the start of the current build in seconds since the epoch.
+  ///
+  /// Clang modules in the cache that have been validated since then are
+  /// trusted as-is, so only the first job of a build to import a module pays
+  /// for checking its headers.
+  uint64_t BuildSessionTimestamp = 0;
+
+  /// If set, the precompiled bridging header which Clang loads before anything
+  /// else, so that importing the bridging header doesn't parse it again.
+  std::string BridgingHeaderPCH;
+
   /// Extra arguments which should be passed to the Clang importer.
   std::vector<std::string> ExtraArgs;
 
@@ -48,9 +48,10 @@ public:
     REPLJob,
     LinkJob,
     GenerateDSYMJob,
+    GeneratePCHJob,
 
     JobFirst=CompileJob,
-    JobLast=GenerateDSYMJob
+    JobLast=GeneratePCHJob
   };
 
   static const char *getClassName(ActionClass AC);
@@ -268,6 +269,29 @@ public:
   }
 };
 
+/// Precompiles the bridging header, so that the compile jobs load it instead
+/// of parsing the header and everything it includes again.
+///
+/// A single action is an input of all the compile actions of a build, so the
+/// header is only precompiled once.
+class GeneratePCHJobAction : public JobAction {
+  virtual void anchor();
+  std::string PersistentPCHDir;
+
+public:
+  GeneratePCHJobAction(Action *Input, StringRef PersistentPCHDir)
+    : JobAction(Action::GeneratePCHJob, Input, types::TY_PCH),
+      PersistentPCHDir(PersistentPCHDir) {}
+
+  /// The directory the PCH is put into, under a name derived from the
+  /// contents of the header, so that later builds can reuse it.
+  StringRef getPersistentPCHDir() const { return PersistentPCHDir; }
+
+  static bool classof(const Action *A) {
+    return A->getKind() == Action::GeneratePCHJob;
+  }
+};
+
 class LinkJobAction : public JobAction {
   virtual void anchor();
   LinkKind Kind;
@@ -22,6 +22,7 @@
 #include "swift/Basic/ArrayRefView.h"
 #include "swift/Basic/LLVM.h"
 #include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/TimeValue.h"
 
@@ -55,6 +56,26 @@ enum class OutputLevel {
   Parseable,
 };
 
+/// What was measured about a job when it last ran.
+///
+/// These are recorded in the compilation record, keyed by the job's primary
+/// input, and used to schedule the next build.
+struct JobStatistics {
+  /// The ExitStatus of a job that was terminated by a signal.
+  static const int SignalledExitStatus = -2;
+
+  /// The job's wall-clock running time, in milliseconds.
+  uint64_t WallTimeMillis = 0;
+
+  /// The job's peak resident set size, in kilobytes, or 0 if unknown.
+  uint64_t PeakResidentSetSizeKB = 0;
+
+  /// The job's exit status, or SignalledExitStatus.
+  int ExitStatus = 0;
+};
+
+using JobStatisticsMap = llvm::StringMap<JobStatistics>;
+
 class Compilation {
 private:
   /// The DiagnosticEngine to which this Compilation should emit diagnostics.
@@ -106,6 +127,11 @@ private:
   /// If unknown, this will be some time in the past.
   llvm::sys::TimeValue LastBuildTime = llvm::sys::TimeValue::MinTime();
 
+  /// Statistics for each input's job from the last build, if known.
+  ///
+  /// Jobs on the longest chains of expected work are started first.
+  JobStatisticsMap PreviousJobStatistics;
+
   /// The number of commands which this compilation should attempt to run in
   /// parallel.
   unsigned NumberOfParallelCommands;
@@ -136,6 +162,14 @@ private:
   /// rebuilt.
   bool ShowIncrementalBuildDecisions = false;
 
+  /// When true, uses the per-declaration interface hashes in dependency files
+  /// to rebuild only the files that use declarations which changed.
+  bool EnableFineGrainedDependencies = false;
+
+  /// When true, parseable output lists the top-level inputs once, in an
+  /// "inputs" message, and the other messages refer to them by index.
+  bool CompactParseableOutput = false;
+
   static const Job *unwrap(const std::unique_ptr<const Job> &p) {
     return p.get();
   }
@@ -194,6 +228,14 @@ public:
     ShowIncrementalBuildDecisions = value;
   }
 
+  void setEnableFineGrainedDependencies(bool value = true) {
+    EnableFineGrainedDependencies = value;
+  }
+
+  void setCompactParseableOutput(bool value = true) {
+    CompactParseableOutput = value;
+  }
+
   void setCompilationRecordPath(StringRef path) {
     assert(CompilationRecordPath.empty() && "already set");
     CompilationRecordPath = path;
@@ -203,6 +245,10 @@ public:
     LastBuildTime = time;
   }
 
+  void setPreviousJobStatistics(JobStatisticsMap stats) {
+    PreviousJobStatistics = std::move(stats);
+  }
+
   /// Requests the path to a file containing all input source files. This can
   /// be shared across jobs.
   ///
@@ -129,6 +129,29 @@ private:
   /// \sa SourceFile::getInterfaceHash
   llvm::DenseMap<const void *, std::string> InterfaceHashes;
 
+  /// The interface hashes of the individual names each node provides, keyed
+  /// by dependency kind and name.
+  ///
+  /// Names without an entry are assumed to change whenever the node's
+  /// interface hash does.
+  llvm::DenseMap<const void *, llvm::StringMap<std::string>>
+    DeclInterfaceHashes;
+
+  /// For nodes whose interface changed when they were last reloaded, the keys
+  /// in DeclInterfaceHashes that were added, removed, or changed.
+  ///
+  /// This is consumed by the next markTransitive of the node.
+  llvm::DenseMap<const void *, llvm::StringSet<>> ChangedDeclInterfaces;
+
+  /// If true, markTransitive only follows the names a node provides whose
+  /// interface has changed, when that is known.
+  bool EnableFineGrainedDependencies = false;
+
+  /// Returns true if \p provided is known not to have changed the last time
+  /// \p node was reloaded.
+  bool isProvidedEntryUnchanged(const void *node,
+                                const ProvidesEntryTy &provided) const;
+
   LoadResult loadFromBuffer(const void *node, llvm::MemoryBuffer &buffer);
 
   // FIXME: We should be able to use llvm::mapped_iterator for this, but
@@ -183,6 +206,12 @@ protected:
   }
 
 public:
+  /// Only dirty the dependents of a reloaded node that use the names whose
+  /// per-declaration interface hashes changed.
+  void setEnableFineGrainedDependencies(bool value = true) {
+    EnableFineGrainedDependencies = value;
+  }
+
   llvm::iterator_range<StringSetIterator> getExternalDependencies() const {
     return llvm::make_range(StringSetIterator(ExternalDependencies.begin()),
                             StringSetIterator(ExternalDependencies.end()));
@@ -114,6 +114,10 @@ public:
   /// (If empty, this implies no SDK.)
   std::string SDKPath;
 
+  /// When nonzero, the time this build started, in seconds since the epoch.
+  /// Frontend jobs use it to validate each cached Clang module only once.
+  uint64_t BuildSessionTimestamp = 0;
+
   enum SanitizerKind SelectedSanitizer;
 };
 
@@ -20,6 +20,13 @@
 
 #include "swift/Basic/LLVM.h"
 #include "swift/Basic/TaskQueue.h"
+#include "llvm/ADT/DenseMap.h"
+
+namespace llvm {
+namespace opt {
+  class Arg;
+}
+}
 
 namespace swift {
 namespace driver {
@@ -30,8 +37,24 @@ namespace parseable_output {
 
 using swift::sys::ProcessId;
 
+/// Maps each top-level input of a compilation to its index in the "inputs"
+/// message of compact parseable output.
+using InputIndexMap = llvm::DenseMap<const llvm::opt::Arg *, unsigned>;
+
+/// \brief Emits an "inputs" message listing the top-level inputs of a
+/// compilation, and fills in \p Indices with their positions in it.
+///
+/// If \p FilelistPath is non-null, the inputs which are Swift sources are
+/// also available to the frontend in that filelist.
+void emitInputsMessage(raw_ostream &os, ArrayRef<const llvm::opt::Arg *> Inputs,
+                       const char *FilelistPath, InputIndexMap &Indices);
+
 /// \brief Emits a "began" message to the given stream.
-void emitBeganMessage(raw_ostream &os, const Job &Cmd, ProcessId Pid);
+///
+/// If \p Indices is non-null, top-level inputs are referred to by their index
+/// in an "input-indices" array instead of by path.
+void emitBeganMessage(raw_ostream &os, const Job &Cmd, ProcessId Pid,
+                      const InputIndexMap *Indices = nullptr);
 
 /// \brief Emits a "finished" message to the given stream.
 void emitFinishedMessage(raw_ostream &os, const Job &Cmd, ProcessId Pid,
@@ -42,7 +65,8 @@ void emitSignalledMessage(raw_ostream &os, const Job &Cmd, ProcessId Pid,
                           StringRef ErrorMsg, StringRef Output);
 
 /// \brief Emits a "skipped" message to the given stream.
-void emitSkippedMessage(raw_ostream &os, const Job &Cmd);
+void emitSkippedMessage(raw_ostream &os, const Job &Cmd,
+                        const InputIndexMap *Indices = nullptr);
 
 } // end namespace parseable_output
 } // end namespace driver
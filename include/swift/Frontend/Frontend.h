@@ -330,8 +330,17 @@ class CompilerInstance {
 
   SourceFile *PrimarySourceFile = nullptr;
 
+  /// The buffers and source files of any primary inputs after the first, in
+  /// the order of the -primary-file arguments.
+  std::vector<unsigned> AdditionalPrimaryBufferIDs;
+  std::vector<SourceFile *> AdditionalPrimarySourceFiles;
+  std::vector<ReferencedNameTracker *> AdditionalNameTrackers;
+
   void createSILModule(bool WholeModule = false);
   void setPrimarySourceFile(SourceFile *SF);
+  void notePrimarySourceFile(SourceFile *SF, unsigned BufferID);
+  bool isPrimaryBuffer(unsigned BufferID) const;
+  bool isPrimarySourceFile(const SourceFile *SF) const;
 
 public:
   SourceManager &getSourceMgr() { return SourceMgr; }
@@ -366,6 +375,15 @@ public:
     return NameTracker;
   }
 
+  /// Sets the trackers for the primary files after the first, one per file.
+  void setAdditionalReferencedNameTrackers(
+      MutableArrayRef<ReferencedNameTracker> trackers) {
+    assert(!PrimarySourceFile && "must be called before performSema()");
+    AdditionalNameTrackers.clear();
+    for (auto &tracker : trackers)
+      AdditionalNameTrackers.push_back(&tracker);
+  }
+
   /// Set the SIL module for this compilation instance.
   ///
   /// The CompilerInstance takes ownership of the given SILModule object.
@@ -403,6 +421,11 @@ public:
   /// \returns the primary SourceFile, or nullptr if there is no primary input
   SourceFile *getPrimarySourceFile() { return PrimarySourceFile; }
 
+  /// Gets the primary SourceFiles after the first when compiling a batch.
+  ArrayRef<SourceFile *> getAdditionalPrimarySourceFiles() const {
+    return AdditionalPrimarySourceFiles;
+  }
+
   /// \brief Returns true if there was an error during setup.
   bool setup(const CompilerInvocation &Invocation);
 
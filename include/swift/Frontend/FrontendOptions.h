@@ -74,6 +74,13 @@ public:
   /// be generated for the whole module.
   Optional<SelectedInput> PrimaryInput;
 
+  /// In batch mode, the inputs after PrimaryInput for which output should be
+  /// generated, in the order they were given.
+  ///
+  /// Each primary input gets its own entry in OutputFilenames, starting with
+  /// PrimaryInput's.
+  std::vector<SelectedInput> AdditionalPrimaryInputs;
+
   /// The kind of input on which the frontend should operate.
   InputFileKind InputKind = InputFileKind::IFK_Swift;
 
@@ -112,6 +119,10 @@ public:
   /// The path to which we should output a Swift reference dependencies file.
   std::string ReferenceDependenciesFilePath;
 
+  /// In batch mode, the reference dependencies files for the primary inputs
+  /// in AdditionalPrimaryInputs, in the same order.
+  std::vector<std::string> AdditionalReferenceDependenciesFilePaths;
+
   /// The path to which we should output fixits as source edits.
   std::string FixitsOutputPath;
 
@@ -148,6 +159,8 @@ public:
     /// Parse, type-check, and dump type refinement context hierarchy
     DumpTypeRefinementContexts,
 
+    EmitPCH, ///< Emit a precompiled Objective-C header
+
     EmitSILGen, ///< Emit raw SIL
     EmitSIL, ///< Emit canonical SIL
 
@@ -178,16 +191,35 @@ public:
   /// If set, dumps wall time taken to check each function body to llvm::errs().
   bool DebugTimeFunctionBodies = false;
 
+  /// If set, dumps the time and the solver statistics of type-checking each
+  /// expression to llvm::errs().
+  bool DebugTimeExpressionTypeChecking = false;
+
   /// If set, prints the time taken in each major compilation phase to 
   /// llvm::errs().
   ///
   /// \sa swift::SharedTimer
   bool DebugTimeCompilation = false;
 
+  /// If non-empty, a timeline of the compilation phases, the type-checking of
+  /// each declaration and the lowering of each function is written to this
+  /// file in the Chrome trace event format.
+  ///
+  /// \sa swift::TraceScope
+  std::string TraceOutputPath;
+
   /// Indicates whether function body parsing should be delayed
   /// until the end of all files.
   bool DelayedFunctionBodyParsing = false;
 
+  /// Indicates whether function bodies in non-primary files should be skipped
+  /// by matching braces, without building any AST for them.
+  bool SkipNonPrimaryFunctionBodies = false;
+
+  /// Indicates whether only the bodies of functions that clients can inline
+  /// should be type-checked, for jobs that only emit a module.
+  bool SkipNonInlinableFunctionBodies = false;
+
   /// Indicates whether or not an import statement can pick up a Swift source
   /// file (as opposed to a module file).
   bool EnableSourceImport = false;
@@ -264,6 +296,9 @@ public:
   /// Indicates whether the RequestedAction will immediately run code.
   bool actionIsImmediate() const;
 
+  /// Indicates whether more than one primary input was given.
+  bool isBatchMode() const { return !AdditionalPrimaryInputs.empty(); }
+
   void forAllOutputPaths(std::function<void(const std::string &)> fn) const;
   
   /// Gets the name of the specified output filename.
@@ -566,6 +566,7 @@ private:
   StringRef BriefDocComment;
   ArrayRef<StringRef> AssociatedUSRs;
   ArrayRef<std::pair<StringRef, StringRef>> DocWords;
+  ArrayRef<StringRef> ResultTypeUSRs;
   unsigned TypeDistance : 3;
 
 public:
@@ -641,14 +642,15 @@ public:
                        StringRef BriefDocComment,
                        ArrayRef<StringRef> AssociatedUSRs,
                        ArrayRef<std::pair<StringRef, StringRef>> DocWords,
-                       enum ExpectedTypeRelation TypeDistance)
+                       enum ExpectedTypeRelation TypeDistance,
+                       ArrayRef<StringRef> ResultTypeUSRs = {})
       : Kind(ResultKind::Declaration), KnownOperatorKind(0),
         SemanticContext(unsigned(SemanticContext)),
         NotRecommended(NotRecommended), NotRecReason(NotRecReason),
         NumBytesToErase(NumBytesToErase), CompletionString(CompletionString),
         ModuleName(ModuleName), BriefDocComment(BriefDocComment),
         AssociatedUSRs(AssociatedUSRs), DocWords(DocWords),
-        TypeDistance(TypeDistance) {
+        ResultTypeUSRs(ResultTypeUSRs), TypeDistance(TypeDistance) {
     assert(AssociatedDecl && "should have a decl");
     AssociatedKind = unsigned(getCodeCompletionDeclKind(AssociatedDecl));
     assert(CompletionString);
@@ -669,14 +671,16 @@ public:
                        StringRef BriefDocComment,
                        ArrayRef<StringRef> AssociatedUSRs,
                        ArrayRef<std::pair<StringRef, StringRef>> DocWords,
-                       CodeCompletionOperatorKind KnownOperatorKind)
+                       CodeCompletionOperatorKind KnownOperatorKind,
+                       ArrayRef<StringRef> ResultTypeUSRs = {})
       : Kind(ResultKind::Declaration),
         KnownOperatorKind(unsigned(KnownOperatorKind)),
         SemanticContext(unsigned(SemanticContext)),
         NotRecommended(NotRecommended), NotRecReason(NotRecReason),
         NumBytesToErase(NumBytesToErase), CompletionString(CompletionString),
         ModuleName(ModuleName), BriefDocComment(BriefDocComment),
-        AssociatedUSRs(AssociatedUSRs), DocWords(DocWords) {
+        AssociatedUSRs(AssociatedUSRs), DocWords(DocWords),
+        ResultTypeUSRs(ResultTypeUSRs) {
     AssociatedKind = static_cast<unsigned>(DeclKind);
     assert(CompletionString);
     TypeDistance = ExpectedTypeRelation::Unrelated;
@@ -757,6 +761,19 @@ public:
     return DocWords;
   }
 
+  /// The USRs of the types this declaration can be compared to the expected
+  /// type with, which are only computed for results cached across
+  /// completions. A cached result has no type relation of its own.
+  ArrayRef<StringRef> getResultTypeUSRs() const {
+    return ResultTypeUSRs;
+  }
+
+  /// Returns a copy of this result allocated in \p Allocator, with the given
+  /// relation to the expected type.
+  CodeCompletionResult *
+  withExpectedTypeRelation(llvm::BumpPtrAllocator &Allocator,
+                           ExpectedTypeRelation Relation) const;
+
   /// Print a debug representation of the code completion result to \p OS.
   void print(raw_ostream &OS) const;
   void dump() const;
@@ -784,6 +801,10 @@ struct CodeCompletionResultSink {
   /// clang::Module * or swift::ModuleDecl *.
   std::pair<void *, StringRef> LastModule;
 
+  /// Whether declaration results should record the USRs of their types, so
+  /// that they can be ranked against an expected type once they are cached.
+  bool IncludeResultTypeUSRs = false;
+
   CodeCompletionResultSink()
       : Allocator(std::make_shared<llvm::BumpPtrAllocator>()) {}
 };
@@ -800,6 +821,10 @@ public:
   CompletionKind CodeCompletionKind = CompletionKind::None;
   bool HasExpectedTypeRelation = false;
 
+  /// The USRs of the expected types which cached results can be identical
+  /// to.
+  std::vector<std::string> ExpectedTypeUSRs;
+
   CodeCompletionContext(CodeCompletionCache &Cache)
       : Cache(Cache) {}
 
@@ -878,9 +903,13 @@ void lookupCodeCompletionResultsFromModule(CodeCompletionResultSink &targetSink,
 
 /// Copy code completion results from \p sourceSink to \p targetSink, possibly
 /// restricting by \p onlyTypes.
+///
+/// The copied results whose types have one of \p expectedTypeUSRs are marked
+/// as identical to the expected type.
 void copyCodeCompletionResults(CodeCompletionResultSink &targetSink,
                                CodeCompletionResultSink &sourceSink,
-                               bool onlyTypes);
+                               bool onlyTypes,
+                               ArrayRef<std::string> expectedTypeUSRs = {});
 
 } // end namespace ide
 } // end namespace swift
@@ -53,16 +53,26 @@ public:
 
   struct Value : public llvm::ThreadSafeRefCountedBase<Value> {
     llvm::sys::TimeValue ModuleModificationTime;
+    uint64_t ModuleSize = 0;
     CodeCompletionResultSink Sink;
   };
   using ValueRefCntPtr = llvm::IntrusiveRefCntPtr<Value>;
 
+  /// \brief How many lookups were served from memory, from the chained
+  /// on-disk cache, or not at all, since the cache was created.
+  struct Statistics {
+    uint64_t Hits = 0;
+    uint64_t DiskHits = 0;
+    uint64_t Misses = 0;
+  };
+
   CodeCompletionCache(OnDiskCodeCompletionCache *nextCache = nullptr);
   ~CodeCompletionCache();
 
   static ValueRefCntPtr createValue();
   Optional<ValueRefCntPtr> get(const Key &K);
   void set(const Key &K, ValueRefCntPtr V) { setImpl(K, V, /*setChain*/ true); }
+  Statistics getStatistics() const;
 
 private:
   void setImpl(const Key &K, ValueRefCntPtr V, bool setChain);
@@ -210,6 +210,8 @@ class TypeConverter {
   llvm::DenseSet<const TypeRef *> RecursionCheck;
   llvm::DenseMap<std::pair<unsigned, unsigned>,
                  const ReferenceTypeInfo *> ReferenceCache;
+  llvm::DenseMap<std::pair<const TypeRef *, std::pair<unsigned, unsigned>>,
+                 const TypeInfo *> ClassInstanceCache;
 
   const TypeRef *RawPointerTR = nullptr;
   const TypeRef *NativeObjectTR = nullptr;
@@ -242,7 +244,7 @@ public:
   /// Returns layout information for an instance of the given
   /// class.
   ///
-  /// Not cached.
+  /// Cached by the type, start and alignment.
   const TypeInfo *getClassInstanceTypeInfo(const TypeRef *TR,
                                            unsigned start,
                                            unsigned align);
@@ -257,6 +259,10 @@ private:
   getReferenceTypeInfo(ReferenceKind Kind,
                        ReferenceCounting Refcounting);
 
+  const TypeInfo *computeClassInstanceTypeInfo(const TypeRef *TR,
+                                               unsigned start,
+                                               unsigned align);
+
   /// TypeRefs for special types for which we need to know the layout
   /// intrinsically in order to layout anything else.
   ///
@@ -289,13 +289,29 @@ public:
   /// Parsing reflection metadata
   ///
 
-  void addReflectionInfo(ReflectionInfo I) {
-    ReflectionInfos.push_back(I);
-  }
+  /// Add the reflection metadata of an image, and index its records.
+  void addReflectionInfo(ReflectionInfo I);
 
 private:
   std::vector<ReflectionInfo> ReflectionInfos;
 
+  /// The field descriptors of all images, by mangled type name. If several
+  /// images describe the same type, the first one wins.
+  std::unordered_map<std::string, const FieldDescriptor *> FieldDescriptors;
+
+  /// The associated type descriptors of all images, by mangled conforming
+  /// type name, in the order of the images.
+  std::unordered_map<std::string,
+                     std::vector<const AssociatedTypeDescriptor *>>
+    AssociatedTypeDescriptors;
+
+  /// The builtin type descriptors of all images, by mangled type name.
+  std::unordered_map<std::string, const BuiltinTypeDescriptor *>
+    BuiltinTypeDescriptors;
+
+  /// The capture descriptors of all images, by remote address.
+  std::unordered_map<uintptr_t, const CaptureDescriptor *> CaptureDescriptors;
+
 public:
   TypeConverter &getTypeConverter() { return TC; }
 
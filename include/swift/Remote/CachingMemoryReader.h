@@ -0,0 +1,193 @@
+//===--- CachingMemoryReader.h - Page cache for remote memory ---*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file declares a MemoryReader which caches the memory read through
+//  another reader in pages, so that many small reads turn into a few remote
+//  reads.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_REMOTE_CACHINGMEMORYREADER_H
+#define SWIFT_REMOTE_CACHINGMEMORYREADER_H
+
+#include "swift/Remote/MemoryReader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <unordered_map>
+
+namespace swift {
+namespace remote {
+
+/// An implementation of MemoryReader which reads whole pages through another
+/// reader and serves later reads of the same pages from memory.
+///
+/// The cache assumes that the memory of the remote process does not change.
+/// Clients must call invalidate() whenever the remote process may have run.
+class CachingMemoryReader final : public MemoryReader {
+  static const uint64_t PageSize = 4096;
+
+  /// The cache is dropped when it grows beyond this many pages.
+  static const size_t MaxCachedPages = 1024;
+
+  /// Prefetches of more than this many pages are ignored.
+  static const uint64_t MaxPrefetchPages = 16;
+
+  std::shared_ptr<MemoryReader> Underlying;
+
+  /// The pages read so far, by their address. A null page could not be read
+  /// as a whole, so reads of it go to the underlying reader.
+  std::unordered_map<uint64_t, std::unique_ptr<uint8_t[]>> Pages;
+
+  std::unordered_map<std::string, RemoteAddress> Symbols;
+
+  static uint64_t getPageAddress(uint64_t address) {
+    return address & ~(PageSize - 1);
+  }
+
+  /// Returns the page at the given page address, reading it if it isn't
+  /// cached yet, or null if it can't be read as a whole.
+  const uint8_t *getPage(uint64_t pageAddress) {
+    auto found = Pages.find(pageAddress);
+    if (found != Pages.end())
+      return found->second.get();
+
+    if (Pages.size() >= MaxCachedPages)
+      Pages.clear();
+
+    std::unique_ptr<uint8_t[]> page(new uint8_t[PageSize]);
+    if (!Underlying->readBytes(RemoteAddress(pageAddress), page.get(),
+                               PageSize))
+      page.reset();
+    return (Pages[pageAddress] = std::move(page)).get();
+  }
+
+  /// Reads the uncached pages [first, first + count) with one remote read.
+  void readPages(uint64_t first, uint64_t count) {
+    std::unique_ptr<uint8_t[]> buffer(new uint8_t[count * PageSize]);
+    if (!Underlying->readBytes(RemoteAddress(first), buffer.get(),
+                               count * PageSize))
+      return;
+
+    if (Pages.size() + count > MaxCachedPages)
+      Pages.clear();
+
+    for (uint64_t i = 0; i < count; ++i) {
+      std::unique_ptr<uint8_t[]> page(new uint8_t[PageSize]);
+      std::memcpy(page.get(), buffer.get() + i * PageSize, PageSize);
+      Pages[first + i * PageSize] = std::move(page);
+    }
+  }
+
+public:
+  explicit CachingMemoryReader(std::shared_ptr<MemoryReader> underlying)
+    : Underlying(std::move(underlying)) {}
+
+  /// Forget all cached memory.
+  void invalidate() {
+    Pages.clear();
+  }
+
+  uint8_t getPointerSize() override {
+    return Underlying->getPointerSize();
+  }
+
+  uint8_t getSizeSize() override {
+    return Underlying->getSizeSize();
+  }
+
+  RemoteAddress getSymbolAddress(const std::string &name) override {
+    auto found = Symbols.find(name);
+    if (found != Symbols.end())
+      return found->second;
+
+    auto address = Underlying->getSymbolAddress(name);
+    Symbols.insert({name, address});
+    return address;
+  }
+
+  void prefetchBytes(RemoteAddress address, uint64_t size) override {
+    if (size == 0)
+      return;
+
+    uint64_t first = getPageAddress(address.getAddressData());
+    uint64_t end = getPageAddress(address.getAddressData() + size - 1)
+                     + PageSize;
+    if (end <= first || (end - first) / PageSize > MaxPrefetchPages)
+      return;
+
+    // Read each run of uncached pages with a single remote read.
+    uint64_t runStart = end;
+    for (uint64_t page = first; page != end; page += PageSize) {
+      bool cached = Pages.count(page);
+      if (!cached && runStart == end)
+        runStart = page;
+      if (cached && runStart != end) {
+        readPages(runStart, (page - runStart) / PageSize);
+        runStart = end;
+      }
+    }
+    if (runStart != end)
+      readPages(runStart, (end - runStart) / PageSize);
+  }
+
+  bool readBytes(RemoteAddress address, uint8_t *dest, uint64_t size) override {
+    // Large reads are unlikely to be repeated.
+    if (size > PageSize)
+      return Underlying->readBytes(address, dest, size);
+
+    uint64_t current = address.getAddressData();
+    while (size > 0) {
+      uint64_t pageAddress = getPageAddress(current);
+      uint64_t offset = current - pageAddress;
+      uint64_t chunk = std::min(size, PageSize - offset);
+
+      if (auto page = getPage(pageAddress))
+        std::memcpy(dest, page + offset, chunk);
+      else if (!Underlying->readBytes(RemoteAddress(current), dest, chunk))
+        return false;
+
+      current += chunk;
+      dest += chunk;
+      size -= chunk;
+    }
+    return true;
+  }
+
+  bool readString(RemoteAddress address, std::string &dest) override {
+    std::string result;
+    uint64_t current = address.getAddressData();
+    while (true) {
+      uint64_t pageAddress = getPageAddress(current);
+      auto page = getPage(pageAddress);
+      if (!page)
+        return Underlying->readString(address, dest);
+
+      auto begin = page + (current - pageAddress);
+      auto pageEnd = page + PageSize;
+      auto nul = std::find(begin, pageEnd, 0);
+      result.append(begin, nul);
+      if (nul != pageEnd)
+        break;
+      current = pageAddress + PageSize;
+    }
+
+    dest = std::move(result);
+    return true;
+  }
+};
+
+} // end namespace remote
+} // end namespace swift
+
+#endif // SWIFT_REMOTE_CACHINGMEMORYREADER_H
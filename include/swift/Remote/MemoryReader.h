@@ -47,6 +47,13 @@ public:
   virtual bool readBytes(RemoteAddress address, uint8_t *dest,
                          uint64_t size) = 0;
 
+  /// Hints that 'size' bytes from the given address in the remote process
+  /// are about to be read, possibly in several pieces.
+  ///
+  /// A reader for which each read is expensive may fetch the whole range
+  /// with a single read, so that the following reads are cheap.
+  virtual void prefetchBytes(RemoteAddress address, uint64_t size) {}
+
   /// Attempts to read a C string from the given address in the remote
   /// process.
   ///
@@ -950,6 +950,11 @@ protected:
     if (cached != MetadataCache.end())
       return MetadataRef(address, cached->second.get());
 
+    // Most records are read right after their kind, and class metadata is
+    // the largest fixed-size one.
+    Reader->prefetchBytes(RemoteAddress(address),
+                          sizeof(TargetClassMetadata<Runtime>));
+
     StoredPointer KindValue = 0;
     if (!Reader->readInteger(RemoteAddress(address), &KindValue))
       return nullptr;
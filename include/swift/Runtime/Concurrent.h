@@ -15,7 +15,9 @@
 #include <atomic>
 #include <functional>
 #include <stdint.h>
+#include "llvm/ADT/Hashing.h"
 #include "llvm/Support/Allocator.h"
+#include "swift/Runtime/Mutex.h"
 
 #if defined(__FreeBSD__)
 #include <stdio.h>
@@ -144,40 +146,60 @@ template <class EntryTy, class Allocator>
 class ConcurrentMapBase<EntryTy, false, Allocator> : protected Allocator {
 protected:
   struct Node {
-    std::atomic<Node*> Left;
-    std::atomic<Node*> Right;
     EntryTy Payload;
 
     template <class... Args>
     Node(Args &&... args)
-      : Left(nullptr), Right(nullptr), Payload(std::forward<Args>(args)...) {}
+      : Payload(std::forward<Args>(args)...) {}
 
     Node(const Node &) = delete;
     Node &operator=(const Node &) = delete;
+  };
 
-  #ifndef NDEBUG
-    void dump() const {
-      auto L = Left.load(std::memory_order_acquire);
-      auto R = Right.load(std::memory_order_acquire);
-      printf("\"%p\" [ label = \" {<f0> %08lx | {<f1> | <f2>}}\" "
-             "style=\"rounded\" shape=\"record\"];\n",
-             this, (long) Payload.getKeyValueForDump());
-
-      if (L) {
-        L->dump();
-        printf("\"%p\":f1 -> \"%p\":f0;\n", this, L);
-      }
-      if (R) {
-        R->dump();
-        printf("\"%p\":f2 -> \"%p\":f0;\n", this, R);
-      }
+  /// A slot in the open-addressing index.  The hash is stored next to the
+  /// node pointer so that a probe sequence can usually be resolved without
+  /// touching the nodes themselves.
+  struct Slot {
+    std::atomic<size_t> Hash;
+    std::atomic<Node*> Entry;
+  };
+
+  /// The header of an index table.  The slots are tail-allocated.
+  ///
+  /// Tables are never freed while the map is alive: a reader may still be
+  /// probing a table after a writer has replaced it with a larger one.  The
+  /// replaced tables are chained through Previous so that the map's
+  /// destructor can release them.
+  struct Table {
+    size_t Capacity;
+    Table *Previous;
+
+    Slot *getSlots() {
+      return reinterpret_cast<Slot *>(this + 1);
+    }
+
+    static size_t getAllocationSize(size_t capacity) {
+      return sizeof(Table) + capacity * sizeof(Slot);
     }
-  #endif
   };
 
-  std::atomic<Node*> Root;
+  /// The initial number of slots in the index.  Must be a power of two.
+  enum : size_t { InitialCapacity = 8 };
+
+  /// The current index table, or null if nothing has been inserted yet.
+  std::atomic<Table*> Index;
 
-  constexpr ConcurrentMapBase() : Root(nullptr) {}
+  /// The number of nodes in the current index.  Only accessed by writers,
+  /// under WriterLock.
+  size_t Count;
+
+  /// Serializes insertions.  Lookups never take this lock.
+  StaticMutex WriterLock;
+
+#if SWIFT_MUTEX_SUPPORTS_CONSTEXPR
+  constexpr
+#endif
+  ConcurrentMapBase() : Index(nullptr), Count(0) {}
 
   // Implicitly trivial destructor.
   ~ConcurrentMapBase() = default;
@@ -192,6 +214,22 @@ protected:
     // Deallocate the node.
     this->Deallocate(node, allocSize);
   }
+
+  Table *allocateTable(size_t capacity) {
+    void *memory = this->Allocate(Table::getAllocationSize(capacity),
+                                  alignof(Table));
+    auto table = ::new (memory) Table{capacity, nullptr};
+    auto slots = table->getSlots();
+    for (size_t i = 0; i != capacity; ++i) {
+      ::new (&slots[i].Hash) std::atomic<size_t>(0);
+      ::new (&slots[i].Entry) std::atomic<Node*>(nullptr);
+    }
+    return table;
+  }
+
+  void destroyTable(Table *table) {
+    this->Deallocate(table, Table::getAllocationSize(table->Capacity));
+  }
 };
 
 /// The partial specialization of ConcurrentMapBase which provides a
@@ -202,32 +240,53 @@ class ConcurrentMapBase<EntryTy, true, Allocator>
 protected:
   using super = ConcurrentMapBase<EntryTy, false, Allocator>;
   using Node = typename super::Node;
+  using Table = typename super::Table;
 
-  constexpr ConcurrentMapBase() {}
+#if SWIFT_MUTEX_SUPPORTS_CONSTEXPR
+  constexpr
+#endif
+  ConcurrentMapBase() {}
 
   ~ConcurrentMapBase() {
-    destroyTree(this->Root);
-  }
-
-private:
-  void destroyTree(const std::atomic<Node*> &edge) {
-    // This can be a relaxed load because destruction is not allowed to race
+    // These can be relaxed loads because destruction is not allowed to race
     // with other operations.
-    auto node = edge.load(std::memory_order_relaxed);
-    if (!node) return;
-
-    // Destroy the node's children.
-    destroyTree(node->Left);
-    destroyTree(node->Right);
+    auto table = this->Index.load(std::memory_order_relaxed);
+    if (!table) return;
+
+    // Every node is reachable from the current table.
+    auto slots = table->getSlots();
+    for (size_t i = 0; i != table->Capacity; ++i) {
+      if (auto node = slots[i].Entry.load(std::memory_order_relaxed))
+        this->destroyNode(node);
+    }
 
-    // Destroy the node itself.
-    this->destroyNode(node);
+    // Destroy the current table and all of the tables it replaced.
+    while (table) {
+      auto previous = table->Previous;
+      this->destroyTable(table);
+      table = previous;
+    }
   }
 };
 
-/// A concurrent map that is implemented using a binary tree. It supports
-/// concurrent insertions but does not support removals or rebalancing of
-/// the tree.
+/// Compute the hash of a ConcurrentMap key.  Keys are hashed with
+/// llvm::hash_value, which covers integers, pointers and StringRef; other
+/// key types provide a hash_value overload that is found by argument-
+/// dependent lookup.
+template <class KeyTy>
+static inline size_t hashConcurrentMapKey(const KeyTy &key) {
+  using llvm::hash_value;
+  return size_t(hash_value(key));
+}
+
+/// A concurrent map that is implemented using an open-addressing hash
+/// table.  It supports concurrent insertions but does not support removals.
+///
+/// Lookups are lock-free: they probe the current index table without
+/// synchronizing with writers.  Insertions are serialized by a lock, which
+/// is only taken when the lookup fast path misses.  When the index fills
+/// up, the writer publishes a table of twice the size; earlier tables stay
+/// valid (but frozen) for any reader that is still probing them.
 ///
 /// The entry type must provide the following operations:
 ///
@@ -250,6 +309,9 @@ private:
 ///   /// ignores this argument.
 ///   size_t getExtraAllocationSize() const;
 ///
+/// In addition, KeyTy must be hashable with hashConcurrentMapKey, and keys
+/// that compare equal must hash equally.
+///
 /// If ProvideDestructor is false, the destructor will be trivial.  This
 /// can be appropriate when the object is declared at global scope.
 template <class EntryTy, bool ProvideDestructor = true,
@@ -259,18 +321,28 @@ class ConcurrentMap
   using super = ConcurrentMapBase<EntryTy, ProvideDestructor, Allocator>;
 
   using Node = typename super::Node;
+  using Slot = typename super::Slot;
+  using Table = typename super::Table;
 
   /// Inherited from base class:
-  ///   std::atomic<Node*> Root;
-  using super::Root;
-
-  /// This member stores the address of the last node that was found by the
-  /// search procedure. We cache the last search to accelerate code that
-  /// searches the same value in a loop.
+  ///   std::atomic<Table*> Index;
+  ///   size_t Count;
+  ///   StaticMutex WriterLock;
+  using super::Index;
+  using super::Count;
+  using super::WriterLock;
+
+  /// This member stores the address of the last node that was found or
+  /// created by getOrInsert. We cache the last search to accelerate code that
+  /// searches the same value in a loop. find() only reads it: lookups from
+  /// many threads would otherwise keep writing this shared cache line.
   std::atomic<Node*> LastSearch;
 
 public:
-  constexpr ConcurrentMap() : LastSearch(nullptr) {}
+#if SWIFT_MUTEX_SUPPORTS_CONSTEXPR
+  constexpr
+#endif
+  ConcurrentMap() : LastSearch(nullptr) {}
 
   ConcurrentMap(const ConcurrentMap &) = delete;
   ConcurrentMap &operator=(const ConcurrentMap &) = delete;
@@ -286,15 +358,20 @@ public:
 
 #ifndef NDEBUG
   void dump() const {
-    auto R = Root.load(std::memory_order_acquire);
-    printf("digraph g {\n"
-           "graph [ rankdir = \"TB\"];\n"
-           "node  [ fontsize = \"16\" ];\n"
-           "edge  [ ];\n");
-    if (R) {
-      R->dump();
+    auto table = Index.load(std::memory_order_acquire);
+    if (!table) {
+      printf("<empty>\n");
+      return;
+    }
+    auto slots = table->getSlots();
+    for (size_t i = 0; i != table->Capacity; ++i) {
+      auto node = slots[i].Entry.load(std::memory_order_acquire);
+      if (!node) continue;
+      size_t hash = slots[i].Hash.load(std::memory_order_relaxed);
+      printf("[%zu] hash %016zx (home %zu): %08lx\n", i, hash,
+             hash & (table->Capacity - 1),
+             (long) node->Payload.getKeyIntValueForDump());
     }
-    printf("\n}\n");
   }
 #endif
 
@@ -309,19 +386,12 @@ public:
         return &last->Payload;
     }
 
-    // Search the tree, starting from the root.
-    Node *node = Root.load(std::memory_order_acquire);
-    while (node) {
-      int comparisonResult = node->Payload.compareWithKey(key);
-      if (comparisonResult == 0) {
-        LastSearch.store(node, std::memory_order_release);
-        return &node->Payload;
-      } else if (comparisonResult < 0) {
-        node = node->Left.load(std::memory_order_acquire);
-      } else {
-        node = node->Right.load(std::memory_order_acquire);
-      }
-    }
+    Table *table = Index.load(std::memory_order_acquire);
+    if (!table)
+      return nullptr;
+
+    if (Node *node = probe(table, key, hashConcurrentMapKey(key)).first)
+      return &node->Payload;
 
     return nullptr;
   }
@@ -335,66 +405,115 @@ public:
     // Check if we are looking for the same key that we looked for the
     // last time we called this function.
     if (Node *last = LastSearch.load(std::memory_order_acquire)) {
-      if (last && last->Payload.compareWithKey(key) == 0)
+      if (last->Payload.compareWithKey(key) == 0)
         return { &last->Payload, false };
     }
 
-    // The node we allocated.
-    Node *newNode = nullptr;
+    size_t hash = hashConcurrentMapKey(key);
 
-    // Start from the root.
-    auto edge = &Root;
+    // Try the lock-free path first.
+    if (Table *table = Index.load(std::memory_order_acquire)) {
+      if (Node *node = probe(table, key, hash).first) {
+        LastSearch.store(node, std::memory_order_release);
+        return { &node->Payload, false };
+      }
+    }
 
-    while (true) {
-      // Load the edge.
-      Node *node = edge->load(std::memory_order_acquire);
+    // We have to insert.  Writers are serialized, so the table we see
+    // under the lock is current and cannot change until we unlock.
+    StaticScopedLock guard(WriterLock);
 
-      // If there's a node there, it's either a match or we're going to
-      // one of its children.
-      if (node) {
-      searchFromNode:
+    Table *table = Index.load(std::memory_order_relaxed);
+    if (!table) {
+      table = this->allocateTable(super::InitialCapacity);
+      Index.store(table, std::memory_order_release);
+    }
 
-        // Compare our key against the node's key.
-        int comparisonResult = node->Payload.compareWithKey(key);
+    // Another thread may have inserted the key since we last looked.
+    auto result = probe(table, key, hash);
+    if (Node *node = result.first) {
+      LastSearch.store(node, std::memory_order_release);
+      return { &node->Payload, false };
+    }
+    Slot *slot = result.second;
 
-        // If it's equal, we can use this node.
-        if (comparisonResult == 0) {
-          // Destroy the node we allocated before if we're carrying one around.
-          if (newNode) this->destroyNode(newNode);
+    // Keep the load factor at or below 3/4 so that probe sequences stay
+    // short.
+    if ((Count + 1) * 4 > table->Capacity * 3) {
+      table = grow(table);
+      slot = findEmptySlot(table, hash);
+    }
 
-          // Cache and report that we found an existing node.
-          LastSearch.store(node, std::memory_order_release);
-          return { &node->Payload, false };
-        }
+    // Create a new node.
+    size_t allocSize =
+      sizeof(Node) + EntryTy::getExtraAllocationSize(key, args...);
+    void *memory = this->Allocate(allocSize, alignof(Node));
+    Node *newNode = ::new (memory) Node(key, std::forward<ArgTys>(args)...);
 
-        // Otherwise, select the appropriate child edge and descend.
-        edge = (comparisonResult < 0 ? &node->Left : &node->Right);
-        continue;
-      }
+    // Publish it.  The release store of the entry pointer makes both the
+    // hash and the node's contents visible to readers that observe it.
+    slot->Hash.store(hash, std::memory_order_relaxed);
+    slot->Entry.store(newNode, std::memory_order_release);
+    ++Count;
 
-      // Create a new node.
-      if (!newNode) {
-        size_t allocSize =
-          sizeof(Node) + EntryTy::getExtraAllocationSize(key, args...);
-        void *memory = this->Allocate(allocSize, alignof(Node));
-        newNode = ::new (memory) Node(key, std::forward<ArgTys>(args)...);
-      }
+    LastSearch.store(newNode, std::memory_order_release);
+    return { &newNode->Payload, true };
+  }
 
-      // Try to set the edge to the new node.
-      if (std::atomic_compare_exchange_strong_explicit(edge, &node, newNode,
-                                                  std::memory_order_acq_rel,
-                                                  std::memory_order_acquire)) {
-        // If that succeeded, cache and report that we created a new node.
-        LastSearch.store(newNode, std::memory_order_release);
-        return { &newNode->Payload, true };
-      }
+private:
+  /// Probe \p table for \p key.
+  ///
+  /// \returns the matching node, or null and the empty slot that ended the
+  ///   probe sequence.  The slot is only meaningful to a writer holding
+  ///   WriterLock, and may be null if the table is full.
+  template <class KeyTy>
+  static std::pair<Node*, Slot*> probe(Table *table, const KeyTy &key,
+                                       size_t hash) {
+    size_t mask = table->Capacity - 1;
+    Slot *slots = table->getSlots();
+    for (size_t i = hash & mask, n = 0; n != table->Capacity;
+         i = (i + 1) & mask, ++n) {
+      Node *node = slots[i].Entry.load(std::memory_order_acquire);
+      if (!node)
+        return { nullptr, &slots[i] };
+      if (slots[i].Hash.load(std::memory_order_relaxed) == hash &&
+          node->Payload.compareWithKey(key) == 0)
+        return { node, nullptr };
+    }
+    return { nullptr, nullptr };
+  }
+
+  /// Find the first empty slot in \p hash's probe sequence.  Only used by
+  /// writers, on a table that is known to have room.
+  static Slot *findEmptySlot(Table *table, size_t hash) {
+    size_t mask = table->Capacity - 1;
+    Slot *slots = table->getSlots();
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+      if (!slots[i].Entry.load(std::memory_order_relaxed))
+        return &slots[i];
+    }
+  }
 
-      // Otherwise, we lost the race because some other thread initialized
-      // the edge before us.  node will be set to the current value;
-      // repeat the search from there.
-      assert(node && "spurious failure from compare_exchange_strong?");
-      goto searchFromNode;
+  /// Replace \p oldTable with a table of twice the capacity containing the
+  /// same nodes, and publish it.  Must be called with WriterLock held.
+  Table *grow(Table *oldTable) {
+    Table *newTable = this->allocateTable(oldTable->Capacity * 2);
+    newTable->Previous = oldTable;
+
+    Slot *oldSlots = oldTable->getSlots();
+    for (size_t i = 0; i != oldTable->Capacity; ++i) {
+      Node *node = oldSlots[i].Entry.load(std::memory_order_relaxed);
+      if (!node) continue;
+      size_t hash = oldSlots[i].Hash.load(std::memory_order_relaxed);
+      Slot *slot = findEmptySlot(newTable, hash);
+      slot->Hash.store(hash, std::memory_order_relaxed);
+      slot->Entry.store(node, std::memory_order_relaxed);
     }
+
+    // Readers that pick up the new table must see its fully-populated
+    // slots.
+    Index.store(newTable, std::memory_order_release);
+    return newTable;
   }
 };
 
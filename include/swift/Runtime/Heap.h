@@ -18,5 +18,43 @@
 #define SWIFT_RUNTIME_HEAP_H
 
 #include <llvm/Support/Compiler.h>
+#include <stddef.h>
+#include "swift/Runtime/Config.h"
+
+/// Whether swift_slowAlloc serves small, malloc-aligned requests from the
+/// runtime's own size-class allocator.  On Darwin the Objective-C runtime
+/// and the system's memory tools expect Swift objects to be malloc blocks,
+/// so there we always use malloc.  The allocator reserves a large range of
+/// address space, so it is also limited to 64-bit targets.
+/// AddressSanitizer needs to see every allocation, so it disables this too.
+#if !defined(SWIFT_RUNTIME_SIZE_CLASS_ALLOCATOR) && defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define SWIFT_RUNTIME_SIZE_CLASS_ALLOCATOR 0
+#endif
+#endif
+#ifndef SWIFT_RUNTIME_SIZE_CLASS_ALLOCATOR
+#if !SWIFT_OBJC_INTEROP && defined(__LP64__) && !defined(_WIN32)
+#define SWIFT_RUNTIME_SIZE_CLASS_ALLOCATOR 1
+#else
+#define SWIFT_RUNTIME_SIZE_CLASS_ALLOCATOR 0
+#endif
+#endif
+
+namespace swift {
+
+/// If \p ptr was returned by swift_slowAlloc from the size-class allocator,
+/// return the number of bytes usable at it.  Otherwise return 0; the block
+/// came from malloc and malloc_size(3) or its equivalent applies.
+size_t _swift_slowAllocUsableSize(const void *ptr);
+
+/// Resize the block at \p ptr, which was returned by swift_slowAlloc with
+/// \p alignMask, to \p newSize bytes, keeping its contents.  The block may
+/// be extended in place.
+///
+/// \returns the address of the resized block, or null if the block can't be
+///   resized this way; then \p ptr is still valid and unchanged.
+void *_swift_slowRealloc(void *ptr, size_t newSize, size_t alignMask);
+
+} // end namespace swift
 
 #endif /* SWIFT_RUNTIME_HEAP_H */
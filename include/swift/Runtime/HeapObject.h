@@ -73,6 +73,25 @@ HeapObject *(*SWIFT_CC(RegisterPreservingCC) _swift_allocObject)(
                                               size_t requiredSize,
                                               size_t requiredAlignmentMask);
 
+/// Resize a uniquely referenced heap object, which may extend it in place.
+///
+/// This is only done if nothing but the single strong reference can know
+/// the object's address: it must not have unowned or weak references, and
+/// it must have been allocated by swift_allocObject.  The contents of the
+/// object are copied bitwise, so the part of the object past its header
+/// should be trivial.
+///
+/// \param object - the object, which has exactly one strong reference
+/// \param newSize - the new size of the object, including the header
+/// \param alignMask - the alignment mask the object was allocated with
+/// \return the address of the resized object, which has taken over the
+///   strong reference, or null if the object can't be resized this way;
+///   then the object is unchanged.
+SWIFT_RUNTIME_EXPORT
+extern "C"
+HeapObject *swift_tryReallocObject(HeapObject *object, size_t newSize,
+                                   size_t alignMask);
+
 /// Initializes the object header of a stack allocated object.
 ///
 /// \param metadata - the object's metadata which is stored in the header
@@ -635,6 +654,10 @@ static inline void swift_unownedTakeAssign(UnownedReference *dest,
 /*****************************************************************************/
 
 /// A weak reference value object.  This is ABI.
+///
+/// A native weak reference points to a runtime-private side table entry for
+/// the object rather than to the object itself, so it does not keep the
+/// object's memory allocated after the object is deinitialized.
 struct WeakReference {
   uintptr_t Value;
 };
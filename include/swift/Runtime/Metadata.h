@@ -125,6 +125,10 @@ using ConstTargetFarRelativeDirectPointer
   = typename Runtime::template FarRelativeDirectPointer<const Pointee<Runtime>,
                                                         Nullable>;
 
+template <typename Runtime, typename Pointee, bool Nullable = true>
+using TargetFarRelativeDirectPointer
+  = typename Runtime::template FarRelativeDirectPointer<Pointee, Nullable>;
+
 template <typename Runtime, typename Pointee, bool Nullable = true>
 using TargetRelativeDirectPointer
   = typename Runtime::template RelativeDirectPointer<Pointee, Nullable>;
@@ -643,6 +647,42 @@ extern "C" OpaqueValue *swift_copyPOD(OpaqueValue *dest,
                                       OpaqueValue *src,
                                       const Metadata *self);
 
+/// Perform the 'initializeArrayWithCopy' operation of a type.
+///
+/// POD types are copied with memcpy and single references with a loop of
+/// retains; other types call the value witness.
+SWIFT_RUNTIME_EXPORT
+extern "C" OpaqueValue *swift_arrayInitWithCopy(OpaqueValue *dest,
+                                                OpaqueValue *src,
+                                                size_t count,
+                                                const Metadata *self);
+
+/// Perform the 'initializeArrayWithTakeFrontToBack' operation of a type.
+///
+/// Bitwise-takable types are moved with memmove; other types call the value
+/// witness.
+SWIFT_RUNTIME_EXPORT
+extern "C" OpaqueValue *
+swift_arrayInitWithTakeFrontToBack(OpaqueValue *dest, OpaqueValue *src,
+                                   size_t count, const Metadata *self);
+
+/// Perform the 'initializeArrayWithTakeBackToFront' operation of a type.
+///
+/// Bitwise-takable types are moved with memmove; other types call the value
+/// witness.
+SWIFT_RUNTIME_EXPORT
+extern "C" OpaqueValue *
+swift_arrayInitWithTakeBackToFront(OpaqueValue *dest, OpaqueValue *src,
+                                   size_t count, const Metadata *self);
+
+/// Perform the 'destroyArray' operation of a type.
+///
+/// POD types need no work and single references are destroyed with a loop
+/// of releases; other types call the value witness.
+SWIFT_RUNTIME_EXPORT
+extern "C" void swift_arrayDestroy(OpaqueValue *begin, size_t count,
+                                   const Metadata *self);
+
 #define FOR_ALL_FUNCTION_VALUE_WITNESSES(MACRO) \
   MACRO(destroyBuffer) \
   MACRO(initializeBufferWithCopyOfBuffer) \
@@ -2499,10 +2539,17 @@ using ExistentialMetatypeMetadata
 /// to be pointer-aligned.
 template <typename Runtime>
 struct TargetGenericMetadata {
+  using CreateFunctionType =
+    TargetMetadata<Runtime> *(TargetGenericMetadata<Runtime> *pattern,
+                              const void *arguments);
+
   /// The fill function. Receives a pointer to the instantiated metadata and
   /// the argument pointer passed to swift_getGenericMetadata.
-  TargetMetadata<Runtime> *(*CreateFunction)
-  (TargetGenericMetadata<Runtime> *pattern, const void *arguments);
+  ///
+  /// This is a pointer-sized relative pointer, so that it doesn't have to be
+  /// rebased when the image is loaded.
+  TargetFarRelativeDirectPointer<Runtime, CreateFunctionType,
+                                 /*Nullable*/ false> CreateFunction;
   
   /// The size of the template in bytes.
   uint32_t MetadataSize;
@@ -2887,6 +2934,37 @@ public:
 using ProtocolConformanceRecord
   = TargetProtocolConformanceRecord<InProcess>;
 
+/// An entry in the protocol conformance index of an object file.
+///
+/// The compiler emits an object file's conformance records grouped by
+/// protocol, and describes each group with one of these entries, so that the
+/// runtime can index an image by protocol without visiting every record.
+template <typename Runtime>
+struct TargetProtocolConformanceIndexEntry {
+private:
+  /// The first conformance record of the group.
+  RelativeDirectPointer<const TargetProtocolConformanceRecord<Runtime>>
+    FirstRecord;
+
+  /// The number of records in the group.
+  uint32_t NumRecords;
+
+public:
+  const TargetProtocolConformanceRecord<Runtime> *begin() const {
+    return FirstRecord;
+  }
+
+  const TargetProtocolConformanceRecord<Runtime> *end() const {
+    return begin() + NumRecords;
+  }
+
+  uint32_t size() const {
+    return NumRecords;
+  }
+};
+using ProtocolConformanceIndexEntry
+  = TargetProtocolConformanceIndexEntry<InProcess>;
+
 /// \brief Fetch a uniqued metadata object for a generic nominal type.
 ///
 /// The basic algorithm for fetching a metadata object is:
@@ -2910,6 +2988,20 @@ swift_getGenericMetadata(GenericMetadata *pattern,
                          const void *arguments)
     SWIFT_CC(RegisterPreservingCC);
 
+/// \brief Fetch a uniqued metadata object for a generic nominal type,
+/// offering metadata that was instantiated by the compiler.
+///
+/// If no metadata has been created for the given arguments yet, the
+/// candidate becomes the canonical metadata for them and is returned.
+/// Otherwise the existing metadata is returned, and the candidate must not
+/// be used.  The candidate must have the layout that the pattern would
+/// produce, and it must remain valid for the lifetime of the process.
+SWIFT_RUNTIME_EXPORT
+extern "C" const Metadata *
+swift_getPrespecializedGenericMetadata(GenericMetadata *pattern,
+                                       const void *arguments,
+                                       const Metadata *candidate);
+
 // Callback to allocate a generic class metadata object.
 SWIFT_RUNTIME_EXPORT
 extern "C" ClassMetadata *
@@ -3452,6 +3544,28 @@ extern "C"
 const WitnessTable *swift_conformsToProtocol(const Metadata *type,
                                             const ProtocolDescriptor *protocol);
 
+/// \brief Check whether a type conforms to all of the given native Swift
+/// protocols, as for a cast to a protocol composition.
+///
+/// If so, fills in \p conformances with the witness table for each protocol
+/// and returns true. Successful lookups are cached for the type and the
+/// protocols, so that repeated checks of the same composition are a single
+/// cache probe rather than one conformance lookup per protocol.
+///
+/// \param type The metadata for the type for which to do the conformance
+///             check.
+/// \param protocols The protocol descriptors of the composition. All of
+///                  them must require witness tables.
+/// \param numProtocols The number of protocols in \p protocols.
+/// \param conformances A buffer of \p numProtocols witness table pointers
+///                     to fill in. Its contents are unspecified on failure.
+SWIFT_RUNTIME_EXPORT
+extern "C"
+bool swift_conformsToProtocols(const Metadata *type,
+                               const ProtocolDescriptor * const *protocols,
+                               size_t numProtocols,
+                               const WitnessTable **conformances);
+
 /// Register a block of protocol conformance records for dynamic lookup.
 SWIFT_RUNTIME_EXPORT
 extern "C"
@@ -3464,6 +3578,37 @@ extern "C"
 void swift_registerTypeMetadataRecords(const TypeMetadataRecord *begin,
                                        const TypeMetadataRecord *end);
 
+/// Statistics about the memory the runtime has set aside for metadata.
+struct MetadataAllocationStatistics {
+  /// The number of slabs reserved for small metadata allocations.
+  size_t NumSlabs;
+
+  /// The total size of those slabs, in bytes.
+  size_t SlabBytes;
+
+  /// The number of bytes handed out from slabs, including the padding
+  /// needed to satisfy alignment.  The difference from SlabBytes is the
+  /// unused space in the current slab plus the tails left behind in
+  /// earlier ones.
+  size_t SlabBytesUsed;
+
+  /// The number of allocations that were too large for a slab and were
+  /// given pages of their own.
+  size_t NumLargeAllocations;
+
+  /// The total size of those allocations, in bytes.
+  size_t LargeAllocationBytes;
+};
+
+/// Fill in \p stats with a snapshot of the metadata allocator's usage.
+///
+/// The counters are read without synchronizing with concurrent
+/// allocations, so they may be slightly inconsistent with each other.
+SWIFT_RUNTIME_EXPORT
+extern "C"
+void swift_getMetadataAllocationStatistics(
+                                        MetadataAllocationStatistics *stats);
+
 /// Return the type name for a given type metadata.
 std::string nameForMetadata(const Metadata *type,
                             bool qualified = true);
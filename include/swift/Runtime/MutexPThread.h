@@ -24,7 +24,30 @@ namespace swift {
 
 typedef pthread_cond_t ConditionHandle;
 typedef pthread_mutex_t MutexHandle;
-typedef pthread_rwlock_t ReadWriteLockHandle;
+
+/// The state of a ReadWriteLock.
+///
+/// Readers don't share one count, which would bounce its cache line between
+/// all the cores taking the read lock. Each thread counts itself in one of
+/// several reader indicators, picked by its thread id, so that readers on
+/// different cores mostly update different cache lines. A writer raises the
+/// writer flag, which keeps new readers out, and waits until the indicators
+/// drain. Waiting threads park on the condition, under the mutex.
+struct ReadWriteLockHandle {
+  enum : unsigned { NumReaderIndicators = 16, CacheLineSize = 64 };
+
+  /// A counter padded to a cache line of its own.
+  struct Indicator {
+    unsigned Value;
+    char Padding[CacheLineSize - sizeof(unsigned)];
+  };
+
+  /// Non-zero while a writer holds the lock or waits for the readers.
+  Indicator Writer;
+  Indicator Readers[NumReaderIndicators];
+  pthread_mutex_t Mutex;
+  pthread_cond_t Changed;
+};
 
 #if defined(__CYGWIN__) || defined(__ANDROID__)
 // At the moment CYGWIN pthreads implementation doesn't support the use of
@@ -103,7 +126,7 @@ struct ReadWriteLockPlatformHelper {
 #endif
       ReadWriteLockHandle
       staticInit() {
-    return PTHREAD_RWLOCK_INITIALIZER;
+    return {{}, {}, PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER};
   };
 
   static void init(ReadWriteLockHandle &rwlock);
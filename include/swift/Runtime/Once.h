@@ -18,7 +18,7 @@
 #define SWIFT_RUNTIME_ONCE_H
 
 #include "swift/Runtime/HeapObject.h"
-#include <mutex>
+#include <stdint.h>
 
 namespace swift {
 
@@ -34,8 +34,10 @@ typedef long swift_once_t;
 typedef uintptr_t swift_once_t;
 #else
 
-// On other platforms swift_once_t is std::once_flag
-typedef std::once_flag swift_once_t;
+// On other platforms swift_once_t is a word which is 0 before
+// initialization, 1 while it runs and ~0 once it is done, like
+// dispatch_once_t. The compiler checks for the "done" value inline.
+typedef uintptr_t swift_once_t;
 
 #endif
 
@@ -0,0 +1,82 @@
+//===--- SamplingProfiler.h - Swift runtime sampling profiler ---*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// An opt-in profiler that finds the call sites causing the most allocation
+// and reference counting traffic.
+//
+// If the SWIFT_RUNTIME_SAMPLE_PERIOD environment variable is set to a
+// number N when the process first allocates an object, the runtime installs
+// itself into the _swift_allocObject, _swift_retain(_n) and
+// _swift_release(_n) hooks and records the backtrace of every Nth call of
+// each. Samples are aggregated by backtrace in a fixed-size lock-free table.
+//
+// The profile is written in the pprof format, with the sample types
+// alloc_objects, alloc_space, retains and releases scaled by N, to the path
+// in SWIFT_RUNTIME_SAMPLE_OUTPUT (default: swift-runtime-<pid>.pb) when the
+// process exits, and to that path with a ".<n>" suffix after the process
+// receives SIGUSR2.
+//
+// While the profiler is off, the hooks are untouched, and allocating an
+// object costs one more relaxed load and branch.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_RUNTIME_SAMPLINGPROFILER_H
+#define SWIFT_RUNTIME_SAMPLINGPROFILER_H
+
+#include "swift/Runtime/Config.h"
+#include "llvm/Support/Compiler.h"
+#include <atomic>
+#include <stdint.h>
+
+namespace swift {
+
+/// Write the samples recorded so far to \p path as a pprof profile.
+///
+/// \returns false if the profiler is not running or the file could not be
+///   written.
+SWIFT_RUNTIME_EXPORT
+extern "C"
+bool swift_runtime_writeSamplingProfile(const char *path);
+
+enum class SamplingProfilerState : uint8_t {
+  Unknown,
+  Disabled,
+  Enabled
+};
+
+/// Whether the profiler is running. Unknown until the environment has been
+/// checked.
+LLVM_LIBRARY_VISIBILITY
+extern std::atomic<SamplingProfilerState> _swift_samplingProfilerState;
+
+/// Check the environment, and start the profiler if it asks for it.
+LLVM_LIBRARY_VISIBILITY
+void _swift_initSamplingProfiler();
+
+/// Start the profiler, sampling every \p period-th call of each hooked
+/// entry point, unless it has already been started or disabled.
+///
+/// \returns true if the profiler is running.
+LLVM_LIBRARY_VISIBILITY
+bool _swift_startSamplingProfiler(uint32_t period);
+
+static inline void checkSamplingProfiler() {
+  if (LLVM_UNLIKELY(_swift_samplingProfilerState.load(
+                        std::memory_order_relaxed) ==
+                    SamplingProfilerState::Unknown))
+    _swift_initSamplingProfiler();
+}
+
+} // end namespace swift
+
+#endif
@@ -0,0 +1,128 @@
+//===--- Statistics.h - Swift runtime statistics ----------------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Counters for the expensive paths of the runtime: metadata instantiation,
+// conformance lookup, dynamic casts and weak references.
+//
+// Statistics are only collected if the SWIFT_RUNTIME_STATS environment
+// variable is set to a value other than "0" when the process first hits one
+// of the counted paths. In that case they are also written to stderr when
+// the process exits. Otherwise counting costs a load and a branch.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_RUNTIME_STATISTICS_H
+#define SWIFT_RUNTIME_STATISTICS_H
+
+#include "swift/Runtime/Config.h"
+#include "llvm/Support/Compiler.h"
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace swift {
+
+/// The value of one runtime statistic, as reported by
+/// swift_runtime_getStatistics.
+struct RuntimeStatisticValue {
+  /// A short phrase describing what is counted.
+  const char *Description;
+
+  /// The number of times the counted operation happened.
+  uint64_t Count;
+
+  /// The total time spent in the counted operation, in nanoseconds, or 0 if
+  /// the operation is not timed.
+  uint64_t Nanoseconds;
+};
+
+/// Copy the current values of up to \p capacity runtime statistics into
+/// \p values, summed over all threads.
+///
+/// \returns the number of statistics the runtime collects, which may be
+///   larger than \p capacity.
+SWIFT_RUNTIME_EXPORT
+extern "C"
+size_t swift_runtime_getStatistics(RuntimeStatisticValue *values,
+                                   size_t capacity);
+
+enum class RuntimeStatistic : unsigned {
+#define RUNTIME_STATISTIC(Id, Description) Id,
+#include "swift/Runtime/RuntimeStatistics.def"
+};
+
+enum class RuntimeStatisticsState : uint8_t {
+  Unknown,
+  Disabled,
+  Enabled
+};
+
+/// Whether statistics are collected. Unknown until the environment has been
+/// checked.
+LLVM_LIBRARY_VISIBILITY
+extern std::atomic<RuntimeStatisticsState> _swift_runtimeStatisticsState;
+
+/// Check the environment and set _swift_runtimeStatisticsState.
+/// \returns true if statistics are collected.
+LLVM_LIBRARY_VISIBILITY
+bool _swift_initRuntimeStatistics();
+
+/// Add to the current thread's counters for \p statistic.
+LLVM_LIBRARY_VISIBILITY
+void _swift_recordRuntimeStatistic(RuntimeStatistic statistic, uint64_t count,
+                                   uint64_t nanoseconds);
+
+/// A monotonic clock reading in nanoseconds.
+LLVM_LIBRARY_VISIBILITY
+uint64_t _swift_getRuntimeStatisticsTime();
+
+static inline bool areRuntimeStatisticsEnabled() {
+  auto state = _swift_runtimeStatisticsState.load(std::memory_order_relaxed);
+  if (LLVM_LIKELY(state == RuntimeStatisticsState::Disabled))
+    return false;
+  if (state == RuntimeStatisticsState::Enabled)
+    return true;
+  return _swift_initRuntimeStatistics();
+}
+
+/// Count \p count occurrences of an untimed operation.
+static inline void countRuntimeStatistic(RuntimeStatistic statistic,
+                                         uint64_t count = 1) {
+  if (areRuntimeStatisticsEnabled())
+    _swift_recordRuntimeStatistic(statistic, count, 0);
+}
+
+/// Counts one occurrence of a timed operation, and the time until the
+/// timer goes out of scope.
+class RuntimeStatisticTimer {
+  RuntimeStatistic Statistic;
+  bool Enabled;
+  uint64_t Start;
+
+public:
+  explicit RuntimeStatisticTimer(RuntimeStatistic statistic)
+    : Statistic(statistic), Enabled(areRuntimeStatisticsEnabled()),
+      Start(Enabled ? _swift_getRuntimeStatisticsTime() : 0) {}
+
+  RuntimeStatisticTimer(const RuntimeStatisticTimer &) = delete;
+  RuntimeStatisticTimer &operator=(const RuntimeStatisticTimer &) = delete;
+
+  ~RuntimeStatisticTimer() {
+    if (Enabled)
+      _swift_recordRuntimeStatistic(Statistic, 1,
+                                    _swift_getRuntimeStatisticsTime() - Start);
+  }
+};
+
+} // end namespace swift
+
+#endif // SWIFT_RUNTIME_STATISTICS_H
@@ -45,6 +45,10 @@ private:
   /// The ordered set of instructions in the SILBasicBlock.
   InstListType InstList;
 
+  /// How many times this block ran in the profile passed to -profile-use,
+  /// if a profiled region starts here.
+  Optional<uint64_t> ExecutionCount;
+
   friend struct llvm::ilist_sentinel_traits<SILBasicBlock>;
   friend struct llvm::ilist_traits<SILBasicBlock>;
   SILBasicBlock() : Parent(0) {}
@@ -73,6 +77,14 @@ public:
   /// Returns true if this BB is the entry BB of its parent.
   bool isEntry() const;
 
+  /// Returns the profiled execution count of this block, if it has one.
+  ///
+  /// Blocks created after SILGen have no count of their own; use
+  /// getProfileCount in SILOptimizer/Utils/Local.h to find the count of the
+  /// region a block belongs to.
+  Optional<uint64_t> getExecutionCount() const { return ExecutionCount; }
+  void setExecutionCount(uint64_t Count) { ExecutionCount = Count; }
+
   //===--------------------------------------------------------------------===//
   // SILInstruction List Inspection and Manipulation
   //===--------------------------------------------------------------------===//
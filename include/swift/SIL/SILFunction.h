@@ -598,6 +598,14 @@ public:
   SILBasicBlock &front() { return *begin(); }
   const SILBasicBlock &front() const { return *begin(); }
 
+  /// Returns how many times this function was entered in the profile passed
+  /// to -profile-use, or None if the function has no profile data.
+  Optional<uint64_t> getEntryCount() const {
+    if (empty())
+      return None;
+    return front().getExecutionCount();
+  }
+
   SILBasicBlock *createBasicBlock();
 
   /// Splice the body of \p F into this function at end.
@@ -65,9 +65,14 @@ class SILInstruction : public ValueBase,public llvm::ilist_node<SILInstruction>{
   /// ilist_traits<SILInstruction>.
   SILBasicBlock *ParentBB;
 
-  /// This instruction's containing lexical scope and source location
-  /// used for debug info and diagnostics.
-  SILDebugLocation Location;
+  /// This instruction's containing lexical scope, used for debug info.
+  const SILDebugScope *DebugScope;
+
+  /// This instruction's source location, used for debug info and
+  /// diagnostics. The kind and flags of the location are kept in
+  /// ValueBase::SubclassData, which saves the padding a SILLocation would
+  /// need on its own.
+  SILLocation::UnderlyingLocation Location;
 
   friend struct llvm::ilist_sentinel_traits<SILInstruction>;
   SILInstruction() = delete;
@@ -86,7 +91,9 @@ class SILInstruction : public ValueBase,public llvm::ilist_node<SILInstruction>{
 protected:
   SILInstruction(ValueKind Kind, SILDebugLocation DebugLoc,
                  SILType Ty = SILType())
-      : ValueBase(Kind, Ty), ParentBB(0), Location(DebugLoc) {}
+      : ValueBase(Kind, Ty), ParentBB(0) {
+    setDebugLocation(DebugLoc);
+  }
 
 public:
   /// Instructions should be allocated using a dedicated instruction allocation
@@ -129,14 +136,23 @@ public:
   SILModule &getModule() const;
 
   /// This instruction's source location (AST node).
-  SILLocation getLoc() const;
-  const SILDebugScope *getDebugScope() const;
-  SILDebugLocation getDebugLocation() const { return Location; }
+  SILLocation getLoc() const {
+    return SILLocation::fromRaw(Location, SubclassData);
+  }
+  const SILDebugScope *getDebugScope() const { return DebugScope; }
+  SILDebugLocation getDebugLocation() const {
+    return SILDebugLocation(getLoc(), DebugScope);
+  }
 
   /// Sets the debug location.
   /// Note: Usually it should not be needed to use this function as the location
   /// is already set in when creating an instruction.
-  void setDebugLocation(SILDebugLocation Loc) { Location = Loc; }
+  void setDebugLocation(SILDebugLocation DebugLoc) {
+    SILLocation NewLoc = DebugLoc.getLocation();
+    DebugScope = DebugLoc.getScope();
+    Location = NewLoc.Loc;
+    SubclassData = NewLoc.KindData;
+  }
 
   /// removeFromParent - This method unlinks 'self' from the containing basic
   /// block, but does not delete it.
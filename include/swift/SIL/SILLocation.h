@@ -219,6 +219,15 @@ private:
   friend class MandatoryInlinedLocation;
   friend class InlinedLocation;
   friend class CleanupLocation;
+  friend class SILInstruction;
+
+  /// Rebuild a location from its storage, as taken apart by SILInstruction.
+  static SILLocation fromRaw(UnderlyingLocation L, unsigned KindData) {
+    SILLocation Result;
+    Result.Loc = L;
+    Result.KindData = KindData;
+    return Result;
+  }
 
   void setLocationKind(LocationKind K) { KindData |= (K & LocationKindMask); }
   void setStorageKind(StorageKind K) { KindData |= (K & StorageKindMask); }
@@ -38,6 +38,7 @@
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/PointerIntPair.h"
 #include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/ilist.h"
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/raw_ostream.h"
@@ -50,6 +51,7 @@ namespace swift {
   class SILUndef;
   class SourceFile;
   class SerializedSILLoader;
+  class Substitution;
 
   namespace Lowering {
     class SILGenModule;
@@ -168,6 +170,13 @@ private:
   /// This is the set of undef values we've created, for uniquing purposes.
   llvm::DenseMap<SILType, SILUndef *> UndefValues;
 
+  /// This is a cache of the mangled names of generic specializations, keyed
+  /// by the name of the generic function, and by its canonical substitution
+  /// list and fragility.
+  llvm::StringMap<llvm::DenseMap<std::pair<const Substitution *, unsigned>,
+                                 std::string>>
+    GenericSpecializationNames;
+
   /// The stage of processing this module is at.
   SILStage Stage;
 
@@ -189,6 +198,10 @@ private:
   /// The options passed into this SILModule.
   SILOptions &Options;
 
+  /// The largest execution count of any block in the profile passed to
+  /// -profile-use, or 0 if there is no profile.
+  uint64_t MaxProfileCount = 0;
+
   /// A list of clients that need to be notified when an instruction
   /// invalidation message is sent.
   llvm::SetVector<DeleteNotificationHandler*> NotificationHandlers;
@@ -294,6 +307,15 @@ public:
 
   SILOptions &getOptions() const { return Options; }
 
+  /// Returns the largest execution count in this module's profile data, or 0
+  /// if no profile was used.
+  uint64_t getMaxProfileCount() const { return MaxProfileCount; }
+
+  /// Record that some block in this module ran \p Count times.
+  void noteProfileCount(uint64_t Count) {
+    MaxProfileCount = std::max(MaxProfileCount, Count);
+  }
+
   using iterator = FunctionListType::iterator;
   using const_iterator = FunctionListType::const_iterator;
   FunctionListType &getFunctionList() { return functions; }
@@ -414,6 +436,16 @@ public:
   /// \return null if this module has no such function
   SILFunction *lookUpFunction(SILDeclRef fnRef);
 
+  /// Return the mangled name of the specialization of \p genericFunc for
+  /// \p subs.
+  ///
+  /// The name is only mangled the first time a function is specialized for
+  /// a list of substitutions; later requests for equal substitutions find it
+  /// by the address of their canonical list.
+  std::string getGenericSpecializationName(SILFunction *genericFunc,
+                                           ArrayRef<Substitution> subs,
+                                           IsFragile_t fragile);
+
   /// Attempt to link the SILFunction. Returns true if linking succeeded, false
   /// otherwise.
   ///
@@ -553,6 +585,13 @@ public:
   /// invariants.
   void verify() const;
 
+  /// \brief Run the SIL verifier on the functions for which \p ShouldVerify
+  /// returns true, and on all globals, vtables and witness tables.
+  ///
+  /// This is meant for verifying the module after a transformation which is
+  /// known to have changed only these functions.
+  void verify(llvm::function_ref<bool(const SILFunction &)> ShouldVerify) const;
+
   /// Pretty-print the module.
   void dump(bool Verbose = false) const;
   
@@ -591,6 +630,10 @@ public:
   /// Allocate memory using the module's internal allocator.
   void *allocate(unsigned Size, unsigned Align) const;
 
+  /// Returns the number of bytes allocated so far with the module's internal
+  /// allocator.
+  size_t getAllocatedBytes() const { return BPA.getBytesAllocated(); }
+
   /// Allocate memory for an instruction using the module's internal allocator.
   void *allocateInst(unsigned Size, unsigned Align) const;
 
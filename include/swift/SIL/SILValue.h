@@ -55,6 +55,13 @@ class alignas(8) ValueBase : public SILAllocated<ValueBase> {
 
   const ValueKind Kind;
 
+protected:
+  /// Storage for subclasses that would otherwise be padding after the kind.
+  ///
+  /// SILInstruction keeps the kind and flags of its location here.
+  unsigned SubclassData = 0;
+
+private:
   ValueBase(const ValueBase &) = delete;
   ValueBase &operator=(const ValueBase &) = delete;
 
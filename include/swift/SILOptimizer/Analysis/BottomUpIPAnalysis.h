@@ -260,6 +260,10 @@ protected:
         while (Idx < Scheduled.size()) {
           FunctionInfo *FInfo = Scheduled[Idx++];
           for (const auto &E : FInfo->Callers) {
+            // Skip stale entries of callers which were invalidated after this
+            // function (see invalidateKeepingCallers()).
+            if (!E.isValid())
+              continue;
             if (E.Caller->isVisited() && !E.Caller->isScheduled()) {
               E.Caller->numUnscheduledCallees--;
               tryToSchedule(E.Caller);
@@ -301,7 +305,40 @@ protected:
   void invalidateIncludingAllCallers(FunctionInfo *FInfo) {
     llvm::SmallVector<FunctionInfo *, 8> WorkList;
     WorkList.push_back(FInfo);
+    invalidateWorkList(WorkList);
+  }
+
+  /// Invalidates all analysis data which depend on \p FInfo, i.e. the
+  /// callers. \p FInfo itself is only invalidated if it is part of a cycle in
+  /// the call-graph.
+  template<typename FunctionInfo>
+  void invalidateAllCallers(FunctionInfo *FInfo) {
+    llvm::SmallVector<FunctionInfo *, 8> WorkList;
+    for (const auto &E : FInfo->Callers) {
+      if (E.isValid() && E.Caller->isValid())
+        WorkList.push_back(E.Caller);
+    }
+    invalidateWorkList(WorkList);
+  }
 
+  /// Invalidates only \p FInfo, but keeps the analysis data of its callers and
+  /// the list of callers.
+  /// This allows to update the callers lazily: if the recomputed data of
+  /// \p FInfo turns out to be the same as before, the callers are still
+  /// valid. Otherwise invalidateAllCallers() must be called after the
+  /// recomputation.
+  template<typename FunctionInfo>
+  void invalidateKeepingCallers(FunctionInfo *FInfo) {
+    FInfo->removeInvalidCallers();
+    FInfo->clear();
+    FInfo->UpdateID = 0;
+  }
+
+private:
+  /// Invalidates all functions in \p WorkList and, transitively, their
+  /// callers.
+  template<typename FunctionInfo>
+  void invalidateWorkList(llvm::SmallVectorImpl<FunctionInfo *> &WorkList) {
     while (!WorkList.empty()) {
       FunctionInfo *FInfo = WorkList.pop_back_val();
       for (const auto &E : FInfo->Callers) {
@@ -0,0 +1,126 @@
+//===--- LSLocationAnalysis.h - Memory locations of a function --*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+///
+/// This analysis enumerates the LSLocations accessed by the loads and stores
+/// of a function, and numbers them, so that redundant load elimination and
+/// dead store elimination can lay their bit vectors on top of the same
+/// enumeration instead of each computing its own.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef SWIFT_SILOPTIMIZER_ANALYSIS_LSLOCATIONANALYSIS_H
+#define SWIFT_SILOPTIMIZER_ANALYSIS_LSLOCATIONANALYSIS_H
+
+#include "swift/SILOptimizer/Analysis/Analysis.h"
+#include "swift/SILOptimizer/Utils/LoadStoreOptUtils.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include <vector>
+
+namespace swift {
+
+class SILFunction;
+class TypeExpansionAnalysis;
+
+/// The locations accessed by the loads and stores of one function.
+class LSLocationFunctionInfo {
+  /// Keeps all the locations of the function. The index of a location is the
+  /// bit that represents it in the bit vectors of the dataflows.
+  std::vector<LSLocation> LocationVault;
+
+  /// Contains a map between LSLocation to their index in the LocationVault.
+  LSLocationIndexMap LocToBitIndex;
+
+  /// Keeps a map between the accessed SILValue and the location.
+  LSLocationBaseMap BaseToLocIndex;
+
+  /// Keeps the indices of the locations of each base, so that the locations
+  /// of one base can be found without scanning the LocationVault.
+  llvm::DenseMap<SILValue, llvm::SmallVector<unsigned, 4>> BaseToBits;
+
+  /// The number of loads and stores in the function.
+  unsigned LoadCount = 0;
+  unsigned StoreCount = 0;
+
+public:
+  LSLocationFunctionInfo(SILFunction *F, TypeExpansionAnalysis *TE);
+
+  LSLocationFunctionInfo(const LSLocationFunctionInfo &) = delete;
+  LSLocationFunctionInfo &
+  operator=(const LSLocationFunctionInfo &) = delete;
+
+  /// Returns all the locations of the function.
+  std::vector<LSLocation> &getLocations() { return LocationVault; }
+
+  /// Returns the number of locations of the function.
+  unsigned getNumLocations() const { return LocationVault.size(); }
+
+  /// Returns the location with the given bit.
+  LSLocation &getLocation(unsigned Bit) { return LocationVault[Bit]; }
+
+  /// Returns the bit of the given location, which must have been enumerated.
+  unsigned getLocationBit(const LSLocation &L) const {
+    auto Iter = LocToBitIndex.find(L);
+    assert(Iter != LocToBitIndex.end() && "Location should have been enum'ed");
+    return Iter->second;
+  }
+
+  /// Returns the map from the accessed SILValues to their locations.
+  LSLocationBaseMap &getBaseMap() { return BaseToLocIndex; }
+
+  /// Returns the bits of all locations with the given base.
+  ArrayRef<unsigned> getLocationBitsWithBase(SILValue Base) const {
+    auto Iter = BaseToBits.find(Base);
+    if (Iter == BaseToBits.end())
+      return {};
+    return Iter->second;
+  }
+
+  unsigned getLoadCount() const { return LoadCount; }
+  unsigned getStoreCount() const { return StoreCount; }
+};
+
+/// Caches the LSLocationFunctionInfo of each function until its instructions
+/// change.
+class LSLocationAnalysis
+    : public FunctionAnalysisBase<LSLocationFunctionInfo> {
+  /// The type expansion analysis the locations are expanded with.
+  TypeExpansionAnalysis *TE;
+
+public:
+  LSLocationAnalysis(SILModule *)
+      : FunctionAnalysisBase<LSLocationFunctionInfo>(AnalysisKind::LSLocation),
+        TE(nullptr) {}
+
+  LSLocationAnalysis(const LSLocationAnalysis &) = delete;
+  LSLocationAnalysis &operator=(const LSLocationAnalysis &) = delete;
+
+  static bool classof(const SILAnalysis *S) {
+    return S->getKind() == AnalysisKind::LSLocation;
+  }
+
+  virtual void initialize(SILPassManager *PM) override;
+
+protected:
+  virtual LSLocationFunctionInfo *newFunctionAnalysis(SILFunction *F) override {
+    return new LSLocationFunctionInfo(F, TE);
+  }
+
+  virtual bool shouldInvalidate(SILAnalysis::InvalidationKind K) override {
+    return K & InvalidationKind::Instructions;
+  }
+};
+
+} // end namespace swift
+
+#endif
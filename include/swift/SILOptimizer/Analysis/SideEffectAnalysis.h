@@ -24,6 +24,7 @@
 namespace swift {
 
 class BasicCalleeAnalysis;
+class ClassHierarchyAnalysis;
 
 
 /// An enum to represent the kind of scan we perform when we calculate
@@ -127,6 +128,13 @@ public:
       Changed |= updateFlag(Releases, RHS.Releases);
       return Changed;
     }
+
+    bool operator==(const Effects &RHS) const {
+      return Reads == RHS.Reads && Writes == RHS.Writes &&
+             Retains == RHS.Retains && Releases == RHS.Releases;
+    }
+
+    bool operator!=(const Effects &RHS) const { return !(*this == RHS); }
   };
 
   friend raw_ostream &operator<<(raw_ostream &os,
@@ -185,6 +193,12 @@ public:
     /// parameter, the LocalEffects or, if the value cannot be associated to one
     /// of them, the GlobalEffects.
     Effects *getEffectsOn(SILValue Addr);
+
+    /// Returns the effects for releasing the reference \p V. In addition to
+    /// getEffectsOn, a reference which is loaded from an object passed as a
+    /// parameter is associated to that parameter, because it is reachable
+    /// from it.
+    Effects *getEffectsOnReleased(SILValue V);
     
     FunctionEffects(unsigned numParams) : ParamEffects(numParams) { }
 
@@ -249,6 +263,15 @@ public:
     /// effects.
     ArrayRef<Effects> getParameterEffects() const { return ParamEffects; }
     
+    /// Returns true if the effects which are visible to callers are the same
+    /// as in \p RHS. The LocalEffects are not compared.
+    bool isSameAs(const FunctionEffects &RHS) const {
+      return GlobalEffects == RHS.GlobalEffects &&
+             ParamEffects == RHS.ParamEffects &&
+             AllocsObjects == RHS.AllocsObjects && Traps == RHS.Traps &&
+             ReadsRC == RHS.ReadsRC;
+    }
+
     /// Merge effects from \p RHS.
     bool mergeFrom(const FunctionEffects &RHS);
 
@@ -291,10 +314,18 @@ private:
     /// Back-link to the function.
     SILFunction *F;
 
+    /// The side-effects before the function was invalidated. Only used if
+    /// IsDirty is true.
+    FunctionEffects PrevFE;
+
     /// Used during recomputation to indicate if the side-effects of a caller
     /// must be updated.
     bool NeedUpdateCallers = false;
 
+    /// True if the function is invalidated, but its callers are not (yet).
+    /// The function is in the DirtyFunctions list.
+    bool IsDirty = false;
+
     FunctionInfo(SILFunction *F) :
       FE(F->empty() ? 0 : F->getArguments().size()), F(F) { }
 
@@ -318,10 +349,18 @@ private:
   
   /// The allocator for the map values in Function2Info.
   llvm::SpecificBumpPtrAllocator<FunctionInfo> Allocator;
+
+  /// Functions which are invalidated while their callers are still valid.
+  /// Those are recomputed before the next query. Only if their side-effects
+  /// changed, the callers are invalidated, too.
+  llvm::SmallVector<FunctionInfo *, 16> DirtyFunctions;
   
   /// Callee analysis, used for determining the callees at call sites.
   BasicCalleeAnalysis *BCA;
 
+  /// Used for determining the destructors which a release may call.
+  ClassHierarchyAnalysis *CHA;
+
   /// Get the side-effects of a function, which has an @effects attribute.
   /// Returns true if \a F has an @effects attribute which could be handled.
   static bool getDefinedEffects(FunctionEffects &Effects, SILFunction *F);
@@ -337,6 +376,17 @@ private:
                        FunctionOrder &BottomUpOrder,
                        int RecursionDepth);
 
+  /// Collect the deallocating destructors which may be called when a value of
+  /// type \p Ty is released. Returns false if they are not all known.
+  bool getDeallocators(SILType Ty, SILModule &M,
+                       llvm::SmallSetVector<SILFunction *, 4> &Deallocators,
+                       int Depth);
+
+  /// Analyze the destructors which may be called by the release \p I, like
+  /// the callees of an apply. Returns false if they are not all known.
+  bool analyzeDeallocators(FunctionInfo *FInfo, SILInstruction *I,
+                           FunctionOrder &BottomUpOrder, int RecursionDepth);
+
   /// Analyze the side-effects of a single SIL instruction \p I.
   /// Visited callees are added to \p BottomUpOrder until \p RecursionDepth
   /// reaches MaxRecursionDepth.
@@ -358,6 +408,10 @@ private:
   /// all called functions, up to a recursion depth of MaxRecursionDepth.
   void recompute(FunctionInfo *Initial);
 
+  /// Recomputes the side-effect information for all DirtyFunctions and
+  /// invalidates the callers of those functions whose side-effects changed.
+  void updateDirtyFunctions();
+
 public:
   SideEffectAnalysis()
       : BottomUpIPAnalysis(AnalysisKind::SideEffect) {}
@@ -370,6 +424,8 @@ public:
   
   /// Get the side-effects of a function.
   const FunctionEffects &getEffects(SILFunction *F) {
+    if (!DirtyFunctions.empty())
+      updateDirtyFunctions();
     FunctionInfo *FInfo = getFunctionInfo(F);
     if (!FInfo->isValid())
       recompute(FInfo);
@@ -382,8 +438,14 @@ public:
   /// No invalidation is needed. See comment for SideEffectAnalysis.
   virtual void invalidate(InvalidationKind K) override;
   
-  /// No invalidation is needed. See comment for SideEffectAnalysis.
+  /// Invalidates the function \p F. The callers are only invalidated if the
+  /// side-effects of \p F turn out to be changed.
   virtual void invalidate(SILFunction *F, InvalidationKind K)  override;
+
+  /// Invalidates the function \p F, which is going to be deleted, and all its
+  /// callers.
+  virtual void invalidateForDeadFunction(SILFunction *F,
+                                         InvalidationKind K) override;
 };
 
 } // end namespace swift
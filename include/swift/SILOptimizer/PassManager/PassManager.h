@@ -15,6 +15,7 @@
 #include "llvm/Support/Casting.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/ErrorHandling.h"
 #include <vector>
@@ -85,6 +86,18 @@ class SILPassManager {
   /// Set to true when a pass invalidates an analysis.
   bool CurrentPassHasInvalidated = false;
 
+  /// Set to true when a pass invalidates the analyses of the whole module.
+  bool CurrentPassHasInvalidatedModule = false;
+
+  /// The functions which the current pass invalidated or created. After a
+  /// module pass only these functions are verified, unless the pass has
+  /// invalidated the whole module.
+  llvm::SmallPtrSet<SILFunction *, 16> CurrentPassInvalidatedFunctions;
+
+  /// The number of analysis invalidations of the current pass. Only used for
+  /// the pass profile.
+  unsigned NumCurrentPassInvalidations = 0;
+
   /// True if we need to stop running passes and restart again on the
   /// same function.
   bool RestartPipeline = false;
@@ -132,6 +145,8 @@ public:
         AP->invalidate(K);
 
     CurrentPassHasInvalidated = true;
+    CurrentPassHasInvalidatedModule = true;
+    ++NumCurrentPassInvalidations;
 
     // Assume that all functions have changed. Clear all masks of all functions.
     CompletedPassesMap.clear();
@@ -150,6 +165,7 @@ public:
   void notifyAnalysisOfFunction(SILFunction *F) {
     for (auto AP : Analysis)
       AP->notifyAnalysisOfFunction(F);
+    CurrentPassInvalidatedFunctions.insert(F);
   }
 
   /// \brief Broadcast the invalidation of the function to all analysis.
@@ -161,6 +177,8 @@ public:
         AP->invalidate(F, K);
     
     CurrentPassHasInvalidated = true;
+    CurrentPassInvalidatedFunctions.insert(F);
+    ++NumCurrentPassInvalidations;
     // Any change let all passes run again.
     CompletedPassesMap[F].reset();
   }
@@ -176,6 +194,8 @@ public:
         AP->invalidateForDeadFunction(F, K);
     
     CurrentPassHasInvalidated = true;
+    CurrentPassInvalidatedFunctions.erase(F);
+    ++NumCurrentPassInvalidations;
     // Any change let all passes run again.
     CompletedPassesMap[F].reset();
   }
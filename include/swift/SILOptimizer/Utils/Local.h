@@ -160,6 +160,17 @@ bool mayBindDynamicSelf(SILFunction *F);
 /// \brief Move an ApplyInst's FuncRef so that it dominates the call site.
 void placeFuncRef(ApplyInst *AI, DominanceInfo *DT);
 
+/// \brief Return the profiled execution count of \p BB.
+///
+/// This is \p BB's own count if it has one, or else the count of its closest
+/// dominator that does, which is the region \p BB belongs to. Returns None if
+/// the function has no profile data.
+Optional<uint64_t> getProfileCount(SILBasicBlock *BB, DominanceInfo *DT);
+
+/// \brief Return true if \p Count is large compared to the hottest count in
+/// the module's profile.
+bool isHotProfileCount(SILModule &M, uint64_t Count);
+
 /// \brief Add an argument, \p val, to the branch-edge that is pointing into
 /// block \p Dest. Return a new instruction and do not erase the old
 /// instruction.
@@ -183,9 +194,12 @@ SILInstruction *tryToConcatenateStrings(ApplyInst *AI, SILBuilder &B);
 
 
 /// Tries to perform jump-threading on all checked_cast_br instruction in
-/// function \p Fn.
+/// function \p Fn. The instructions of the blocks it duplicates are
+/// subtracted from \p ThreadingBudget, and no block is duplicated that does
+/// not fit into it.
 bool tryCheckedCastBrJumpThreading(SILFunction *Fn, DominanceInfo *DT,
-                          SmallVectorImpl<SILBasicBlock *> &BlocksForWorklist);
+                          SmallVectorImpl<SILBasicBlock *> &BlocksForWorklist,
+                          unsigned &ThreadingBudget);
 
 void recalcDomTreeForCCBOpt(DominanceInfo *DT, SILFunction &F);
 
@@ -14,6 +14,13 @@
 //  iterative type checking by tracking the set of outstanding
 //  type-checking requests and servicing them as needed.
 //
+//  A type checker owns one IterativeTypeChecker for its lifetime, so
+//  every request is evaluated at most once: once a request has been
+//  found to be satisfied, that is remembered and later queries for it
+//  don't look at the AST again. Requests are only evaluated when a
+//  client asks for them, so a primary-file compile only evaluates the
+//  requests that file depends on.
+//
 //===----------------------------------------------------------------------===//
 
 #ifndef SWIFT_SEMA_ITERATIVE_TYPE_CHECKER_H
@@ -22,6 +29,7 @@
 #include "swift/Sema/TypeCheckRequest.h"
 #include "swift/AST/DiagnosticEngine.h"
 #include "swift/Basic/LLVM.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/STLExtras.h"
 
@@ -43,6 +51,22 @@ class IterativeTypeChecker {
   /// A stack of the currently-active requests.
   SmallVector<TypeCheckRequest, 4> ActiveRequests;
 
+  /// The index in \c ActiveRequests of the first request of the
+  /// outermost call to \c satisfy() that is still running.
+  ///
+  /// A client of the iterative type checker can call back into it
+  /// through the non-iterative type checker while evaluating a
+  /// request. Only the requests made since that call are searched
+  /// for cycles, because the non-iterative type checker breaks the
+  /// recursion through itself on its own.
+  unsigned FirstRequestOfSatisfy = 0;
+
+  /// The requests that are known to be satisfied.
+  ///
+  /// Requests only ever go from unsatisfied to satisfied, so this is
+  /// never invalidated.
+  llvm::DenseSet<TypeCheckRequest> SatisfiedRequests;
+
   // Declare the is<request kind>Satisfied predicates,
   // enumerateDependenciesOf<request kind> functions, and
   // satisfy<request kind> functions.
@@ -73,9 +97,20 @@ class IterativeTypeChecker {
   /// Determine whether the given request has already been satisfied.
   bool isSatisfied(TypeCheckRequest request);
 
+  /// Determine whether the given kind of request is evaluated by the
+  /// non-iterative type checker, which can return without satisfying
+  /// it when it is already working on the same declaration.
+  static bool isDelegatedToTypeChecker(TypeCheckRequest::Kind kind);
+
+  /// Satisfy the given request as a dependency of the active requests.
+  void satisfyDependency(TypeCheckRequest request);
+
 public:
   IterativeTypeChecker(TypeChecker &tc) : TC(tc) { }
 
+  IterativeTypeChecker(const IterativeTypeChecker &) = delete;
+  IterativeTypeChecker &operator=(const IterativeTypeChecker &) = delete;
+
   ASTContext &getASTContext() const;
 
   DiagnosticEngine &getDiags() const;
@@ -21,6 +21,8 @@
 #include "swift/AST/Identifier.h"
 #include "swift/AST/Type.h"
 #include "swift/Basic/SourceLoc.h"
+#include "llvm/ADT/DenseMapInfo.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/PointerUnion.h"
 #include "llvm/ADT/STLExtras.h"
 #include <cassert>
@@ -32,9 +34,11 @@ class ClassDecl;
 class DeclContext;
 class EnumDecl;
 class ExtensionDecl;
+class NormalProtocolConformance;
 class ProtocolDecl;
 class TypeDecl;
 class TypeRepr;
+class ValueDecl;
 
 /// Describes the information needed to perform name lookup into a
 /// declaration context.
@@ -146,6 +150,12 @@ public:
     case PayloadKind::TypeDeclResolution:
       Payload.TypeDeclResolution = T.Payload.TypeDeclResolution;
       break;
+    case PayloadKind::Value:
+      Payload.Value = T.Payload.Value;
+      break;
+    case PayloadKind::Conformance:
+      Payload.Conformance = T.Payload.Conformance;
+      break;
     }
     return *this;
   }
@@ -173,6 +183,7 @@ public:
   Decl *getAnchor() const;
 
   friend bool operator==(const TypeCheckRequest &x, const TypeCheckRequest &y);
+  friend llvm::hash_code hash_value(const TypeCheckRequest &request);
 };
 
 /// A callback used to check whether a particular dependency of this
@@ -195,6 +206,32 @@ inline bool operator!=(const TypeCheckRequest &x, const TypeCheckRequest &y) {
   return !(x == y);
 }
 
+llvm::hash_code hash_value(const TypeCheckRequest &request);
+
+}
+
+namespace llvm {
+template<> struct DenseMapInfo<swift::TypeCheckRequest> {
+  // The sentinels are superclass requests for pointers that can't be
+  // declarations.
+  static swift::TypeCheckRequest getEmptyKey() {
+    return swift::requestTypeCheckSuperclass(
+             static_cast<swift::ClassDecl *>(
+               DenseMapInfo<void *>::getEmptyKey()));
+  }
+  static swift::TypeCheckRequest getTombstoneKey() {
+    return swift::requestTypeCheckSuperclass(
+             static_cast<swift::ClassDecl *>(
+               DenseMapInfo<void *>::getTombstoneKey()));
+  }
+  static unsigned getHashValue(const swift::TypeCheckRequest &request) {
+    return hash_value(request);
+  }
+  static bool isEqual(const swift::TypeCheckRequest &lhs,
+                      const swift::TypeCheckRequest &rhs) {
+    return lhs == rhs;
+  }
+};
 }
 
 #endif /* SWIFT_SEMA_TYPE_CHECK_REQUEST_H */
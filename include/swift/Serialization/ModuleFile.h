@@ -330,6 +330,9 @@ private:
     /// Whether or not ImportDecls is valid.
     unsigned ComputedImportDecls : 1;
 
+    /// Whether the module documentation file has been read.
+    unsigned ReadModuleDoc : 1;
+
     /// Whether this module file can be used, and what's wrong if not.
     unsigned Status : 4;
 
@@ -422,6 +425,23 @@ private:
   /// Returns false if there was an error.
   bool readCommentBlock(llvm::BitstreamCursor &cursor);
 
+  /// Reads the top-level blocks of the module documentation file.
+  ///
+  /// Returns false if there was an error.
+  bool readModuleDocBlocks();
+
+  /// Reads the comment and group name tables from the module documentation
+  /// file, if there is one.
+  void readModuleDoc();
+
+  /// Reads the module documentation file on the first request for a comment
+  /// or a group name, so that compiles which never ask for them don't pay for
+  /// it.
+  void readModuleDocIfNeeded() const {
+    if (!Bits.ReadModuleDoc)
+      const_cast<ModuleFile *>(this)->readModuleDoc();
+  }
+
   /// Recursively reads a pattern from \c DeclTypeCursor.
   ///
   /// If the record at the cursor is not a pattern, returns null.
@@ -24,6 +24,7 @@
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/StringRef.h"
 
+#include <functional>
 #include <memory>
 
 namespace llvm {
@@ -154,7 +155,15 @@ namespace swift {
 
     /// Indicates that the type checker is checking code that will be
     /// immediately executed.
-    ForImmediateMode = 1 << 2
+    ForImmediateMode = 1 << 2,
+
+    /// If set, dumps the time and the solver statistics of type-checking
+    /// each expression to llvm::errs().
+    DebugTimeExpressions = 1 << 3,
+
+    /// If set, only the bodies of @_transparent and @inline(__always)
+    /// functions are type-checked.
+    SkipNonInlinableFunctionBodies = 1 << 4
   };
 
   /// Once parsing and name-binding are complete, this walks the AST to resolve
@@ -245,15 +254,24 @@ namespace swift {
   void serialize(ModuleOrSourceFile DC, const SerializationOptions &options,
                  const SILModule *M = nullptr);
 
+  /// Serializes only the documentation for a module or single source file,
+  /// to the file named by \p options.DocOutputPath.
+  void serializeDoc(ModuleOrSourceFile DC, const SerializationOptions &options);
+
   /// Get the CPU and subtarget feature options to use when emitting code.
   std::tuple<llvm::TargetOptions, std::string, std::vector<std::string>>
   getIRTargetOptions(IRGenOptions &Opts, ASTContext &Ctx);
 
   /// Turn the given Swift module into either LLVM IR or native code
   /// and return the generated LLVM IR module.
+  ///
+  /// \p AfterIRGen, if provided, is called once IR generation is complete and
+  /// the AST and SIL will no longer be touched. With multiple threads it runs
+  /// on the calling thread while the others are already running LLVM.
   std::unique_ptr<llvm::Module>
   performIRGeneration(IRGenOptions &Opts, ModuleDecl *M, SILModule *SILMod,
-                      StringRef ModuleName, llvm::LLVMContext &LLVMContext);
+                      StringRef ModuleName, llvm::LLVMContext &LLVMContext,
+                      std::function<void()> AfterIRGen = nullptr);
 
   /// Turn the given Swift module into either LLVM IR or native code
   /// and return the generated LLVM IR module.
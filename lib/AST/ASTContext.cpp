@@ -33,12 +33,14 @@
 #include "swift/Basic/Fallthrough.h"
 #include "swift/Basic/SourceManager.h"
 #include "swift/Basic/StringExtras.h"
+#include "swift/Basic/Trace.h"
 #include "swift/Parse/Lexer.h" // bad dependency
 #include "clang/AST/Attr.h"
 #include "clang/AST/DeclObjC.h"
 #include "clang/Lex/HeaderSearch.h"
 #include "clang/Lex/Preprocessor.h"
 #include "llvm/Support/Allocator.h"
+#include "llvm/Support/Mutex.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringSwitch.h"
@@ -85,6 +87,10 @@ struct ASTContext::Implementation {
 
   llvm::BumpPtrAllocator Allocator; // used in later initializations
 
+  /// The allocator for identifiers, which are uniqued under the uniquing lock
+  /// by every thread, rather than allocated from the thread's own arena.
+  llvm::BumpPtrAllocator IdentifierAllocator;
+
   /// The set of cleanups to be called when the ASTContext is destroyed.
   std::vector<std::function<void(void)>> Cleanups;
 
@@ -219,6 +225,14 @@ struct ASTContext::Implementation {
   llvm::DenseMap<std::pair<GenericSignature *, ModuleDecl *>,
                  std::unique_ptr<ArchetypeBuilder>> ArchetypeBuilders;
 
+  /// \brief Archetype builders shared by the members of generic contexts.
+  llvm::DenseMap<std::pair<GenericSignature *, ModuleDecl *>,
+                 std::unique_ptr<ArchetypeBuilder>> ContextArchetypeBuilders;
+
+  /// \brief Archetype builders that are no longer shared, but may still be
+  /// in use.
+  std::vector<std::unique_ptr<ArchetypeBuilder>> RetiredArchetypeBuilders;
+
   /// The set of property names that show up in the defining module of a
   /// class.
   llvm::DenseMap<std::pair<const ClassDecl *, char>,
@@ -298,6 +312,19 @@ struct ASTContext::Implementation {
   llvm::FoldingSet<BuiltinVectorType> BuiltinVectorTypes;
   llvm::FoldingSet<GenericSignature> GenericSignatures;
   llvm::FoldingSet<DeclName::CompoundDeclName> CompoundNames;
+
+  /// A substitution list uniqued by getCanonicalSubstitutions().
+  struct CanonicalSubstitutionList : llvm::FoldingSetNode {
+    ArrayRef<Substitution> Subs;
+
+    explicit CanonicalSubstitutionList(ArrayRef<Substitution> subs)
+      : Subs(subs) {}
+
+    void Profile(llvm::FoldingSetNodeID &id) { Profile(id, Subs); }
+    static void Profile(llvm::FoldingSetNodeID &id,
+                        ArrayRef<Substitution> subs);
+  };
+  llvm::FoldingSet<CanonicalSubstitutionList> CanonicalSubstitutionLists;
   llvm::DenseMap<UUID, ArchetypeType *> OpenedExistentialArchetypes;
 
   /// List of Objective-C member conflicts we have found during type checking.
@@ -343,21 +370,100 @@ struct ASTContext::Implementation {
   /// \brief The current constraint solver arena, if any.
   std::unique_ptr<ConstraintSolverArena> CurrentConstraintSolverArena;
 
+  /// Whether threads other than the one that enabled it may be using this
+  /// context.
+  bool ConcurrentAccess = false;
+
+  /// Protects the uniquing tables once concurrent access has been enabled.
+  llvm::sys::SmartMutex<true> UniquingMutex;
+
+  /// The arenas of a thread that shares this context with others.
+  struct ThreadArenas {
+    /// The context these arenas belong to.
+    Implementation *Owner;
+
+    /// The allocator for permanent nodes created by this thread.
+    std::unique_ptr<llvm::BumpPtrAllocator> Allocator;
+
+    /// The current constraint solver arena of this thread, if any.
+    std::unique_ptr<ConstraintSolverArena> CurrentConstraintSolverArena;
+
+    /// The arenas of this thread for another context.
+    ThreadArenas *Previous;
+  };
+
+  /// The allocators of the threads that have stopped sharing this context,
+  /// which still own some of its nodes.
+  std::vector<std::unique_ptr<llvm::BumpPtrAllocator>> RetiredThreadAllocators;
+
+  /// Retrieve the arenas of the current thread for this context, or null if
+  /// it uses the ones of the context itself.
+  ThreadArenas *getThreadArenas();
+
+  /// Retrieve the current constraint solver arena of the current thread.
+  std::unique_ptr<ConstraintSolverArena> &getCurrentConstraintSolverArena() {
+    if (auto thread = getThreadArenas())
+      return thread->CurrentConstraintSolverArena;
+    return CurrentConstraintSolverArena;
+  }
+
   Arena &getArena(AllocationArena arena) {
     switch (arena) {
     case AllocationArena::Permanent:
       return Permanent;
 
     case AllocationArena::ConstraintSolver:
-      assert(CurrentConstraintSolverArena && "No constraint solver active?");
-      return *CurrentConstraintSolverArena;
+      assert(getCurrentConstraintSolverArena() &&
+             "No constraint solver active?");
+      return *getCurrentConstraintSolverArena();
     }
     llvm_unreachable("bad AllocationArena");
   }
 };
 
+/// The arenas of the current thread for the contexts it shares with other
+/// threads, innermost first.
+static LLVM_THREAD_LOCAL ASTContext::Implementation::ThreadArenas *
+  CurrentThreadArenas = nullptr;
+
+ASTContext::Implementation::ThreadArenas *
+ASTContext::Implementation::getThreadArenas() {
+  if (!ConcurrentAccess)
+    return nullptr;
+
+  for (auto thread = CurrentThreadArenas; thread; thread = thread->Previous) {
+    if (thread->Owner == this)
+      return thread;
+  }
+  return nullptr;
+}
+
+namespace {
+  /// Holds the uniquing lock of an ASTContext while other threads may be
+  /// using it.
+  class UniquingLock {
+    llvm::sys::SmartMutex<true> *Mutex = nullptr;
+
+  public:
+    explicit UniquingLock(const ASTContext &ctx) {
+      if (ctx.Impl.ConcurrentAccess) {
+        Mutex = &ctx.Impl.UniquingMutex;
+        Mutex->lock();
+      }
+    }
+
+    UniquingLock(const UniquingLock &) = delete;
+    UniquingLock &operator=(const UniquingLock &) = delete;
+
+    ~UniquingLock() {
+      if (Mutex)
+        Mutex->unlock();
+    }
+  };
+}
+
 ASTContext::Implementation::Implementation()
- : IdentifierTable(Allocator) {}
+ : IdentifierTable(IdentifierAllocator) {}
 ASTContext::Implementation::~Implementation() {
   for (auto &cleanup : Cleanups)
     cleanup();
@@ -366,19 +472,48 @@ ASTContext::Implementation::~Implementation() {
 ConstraintCheckerArenaRAII::
 ConstraintCheckerArenaRAII(ASTContext &self, llvm::BumpPtrAllocator &allocator,
                            GetTypeVariableMemberCallback getTypeMember)
-  : Self(self), Data(self.Impl.CurrentConstraintSolverArena.release())
+  : Self(self), Data(self.Impl.getCurrentConstraintSolverArena().release())
 {
-  Self.Impl.CurrentConstraintSolverArena.reset(
+  Self.Impl.getCurrentConstraintSolverArena().reset(
     new ASTContext::Implementation::ConstraintSolverArena(
           allocator,
           std::move(getTypeMember)));
 }
 
 ConstraintCheckerArenaRAII::~ConstraintCheckerArenaRAII() {
-  Self.Impl.CurrentConstraintSolverArena.reset(
+  Self.Impl.getCurrentConstraintSolverArena().reset(
     (ASTContext::Implementation::ConstraintSolverArena *)Data);
 }
 
+ASTContextThreadRAII::ASTContextThreadRAII(ASTContext &self)
+  : Self(self), Data(nullptr)
+{
+  assert(self.isConcurrentAccessEnabled() &&
+         "Concurrent access to the ASTContext is not enabled");
+
+  auto thread = new ASTContext::Implementation::ThreadArenas();
+  thread->Owner = &self.Impl;
+  thread->Allocator.reset(new llvm::BumpPtrAllocator());
+  thread->Previous = CurrentThreadArenas;
+  CurrentThreadArenas = thread;
+  Data = thread;
+}
+
+ASTContextThreadRAII::~ASTContextThreadRAII() {
+  auto thread = (ASTContext::Implementation::ThreadArenas *)Data;
+  assert(CurrentThreadArenas == thread && "Arenas destroyed out of order");
+  assert(!thread->CurrentConstraintSolverArena &&
+         "Constraint solver still active");
+  CurrentThreadArenas = thread->Previous;
+
+  // The nodes this thread allocated live as long as the context.
+  {
+    llvm::sys::SmartScopedLock<true> lock(Self.Impl.UniquingMutex);
+    Self.Impl.RetiredThreadAllocators.push_back(std::move(thread->Allocator));
+  }
+  delete thread;
+}
+
 static Module *createBuiltinModule(ASTContext &ctx) {
   auto M = Module::create(ctx.getIdentifier("Builtin"), ctx);
   M->addFile(*new (ctx) BuiltinUnit(*M));
@@ -443,15 +578,25 @@ ASTContext::~ASTContext() {
 llvm::BumpPtrAllocator &ASTContext::getAllocator(AllocationArena arena) const {
   switch (arena) {
   case AllocationArena::Permanent:
+    if (auto thread = Impl.getThreadArenas())
+      return *thread->Allocator;
     return Impl.Allocator;
 
   case AllocationArena::ConstraintSolver:
-    assert(Impl.CurrentConstraintSolverArena.get() != nullptr);
-    return Impl.CurrentConstraintSolverArena->Allocator;
+    assert(Impl.getCurrentConstraintSolverArena().get() != nullptr);
+    return Impl.getCurrentConstraintSolverArena()->Allocator;
   }
   llvm_unreachable("bad AllocationArena");
 }
 
+void ASTContext::enableConcurrentAccess() {
+  Impl.ConcurrentAccess = true;
+}
+
+bool ASTContext::isConcurrentAccessEnabled() const {
+  return Impl.ConcurrentAccess;
+}
+
 LazyResolver *ASTContext::getLazyResolver() const {
   return Impl.Resolver;
 }
@@ -477,6 +622,7 @@ Identifier ASTContext::getIdentifier(StringRef Str) const {
   // Make sure null pointers stay null.
   if (Str.data() == nullptr) return Identifier(0);
 
+  UniquingLock lock(*this);
   auto I = Impl.IdentifierTable.insert(std::make_pair(Str, char())).first;
   return Identifier(I->getKeyData());
 }
@@ -1112,6 +1258,7 @@ ASTContext::createTrivialSubstitutions(BoundGenericType *BGT,
 Optional<ArrayRef<Substitution>>
 ASTContext::getSubstitutions(TypeBase *type,
                              DeclContext *gpContext) const {
+  UniquingLock lock(*this);
   assert(gpContext && "Missing generic parameter context");
   auto arena = getArena(type->getRecursiveProperties());
   assert(type->isCanonical() && "Requesting non-canonical substitutions");
@@ -1130,9 +1277,53 @@ ASTContext::getSubstitutions(TypeBase *type,
   return None;
 }
 
+void ASTContext::Implementation::CanonicalSubstitutionList::Profile(
+       llvm::FoldingSetNodeID &id,
+       ArrayRef<Substitution> subs) {
+  id.AddInteger(subs.size());
+  for (auto &sub : subs) {
+    id.AddPointer(sub.getReplacement()->getCanonicalType().getPointer());
+    id.AddInteger(sub.getConformances().size());
+    for (auto conformance : sub.getConformances())
+      id.AddPointer(conformance.getOpaqueValue());
+  }
+}
+
+ArrayRef<Substitution>
+ASTContext::getCanonicalSubstitutions(ArrayRef<Substitution> subs) const {
+  if (subs.empty())
+    return subs;
+
+  UniquingLock lock(*this);
+  llvm::FoldingSetNodeID id;
+  Implementation::CanonicalSubstitutionList::Profile(id, subs);
+
+  void *insertPos = nullptr;
+  if (auto known = Impl.CanonicalSubstitutionLists.FindNodeOrInsertPos(
+                     id, insertPos))
+    return known->Subs;
+
+  SmallVector<Substitution, 4> canonicalSubs;
+  canonicalSubs.reserve(subs.size());
+  for (auto &sub : subs) {
+    assert(!sub.getReplacement()->hasTypeVariable() &&
+           "Cannot unique substitutions involving type variables");
+    canonicalSubs.push_back(
+      Substitution(sub.getReplacement()->getCanonicalType(),
+                   AllocateCopy(sub.getConformances())));
+  }
+
+  using ListNode = Implementation::CanonicalSubstitutionList;
+  void *mem = Allocate(sizeof(ListNode), alignof(ListNode));
+  auto list = new (mem) ListNode(AllocateCopy(canonicalSubs));
+  Impl.CanonicalSubstitutionLists.InsertNode(list, insertPos);
+  return list->Subs;
+}
+
 void ASTContext::setSubstitutions(TypeBase* type,
                                   DeclContext *gpContext,
                                   ArrayRef<Substitution> Subs) const {
+  UniquingLock lock(*this);
   auto arena = getArena(type->getRecursiveProperties());
   auto &boundGenericSubstitutions
     = Impl.getArena(arena).BoundGenericSubstitutions;
@@ -1144,7 +1335,7 @@ void ASTContext::setSubstitutions(TypeBase* type,
 
 Type ASTContext::getTypeVariableMemberType(TypeVariableType *baseTypeVar,
                                            AssociatedTypeDecl *assocType) {
-  auto &arena = *Impl.CurrentConstraintSolverArena;
+  auto &arena = *Impl.getCurrentConstraintSolverArena();
   return arena.GetTypeMember(baseTypeVar, assocType);
 }
 
@@ -1249,6 +1440,8 @@ void ASTContext::getVisibleTopLevelClangModules(
 ArchetypeBuilder *ASTContext::getOrCreateArchetypeBuilder(
                     CanGenericSignature sig,
                     ModuleDecl *mod) {
+  UniquingLock lock(*this);
+
   // Check whether we already have an archetype builder for this
   // signature and module.
   auto known = Impl.ArchetypeBuilders.find({sig, mod});
@@ -1266,6 +1459,44 @@ ArchetypeBuilder *ASTContext::getOrCreateArchetypeBuilder(
   return builder;
 }
 
+ArchetypeBuilder *ASTContext::getOrCreateContextArchetypeBuilder(
+                    GenericSignature *sig,
+                    ModuleDecl *mod) {
+  UniquingLock lock(*this);
+
+  // Check whether we already have an archetype builder for this
+  // signature and module that hasn't picked up any bogus nested types.
+  auto known = Impl.ContextArchetypeBuilders.find({sig, mod});
+  if (known != Impl.ContextArchetypeBuilders.end()) {
+    if (!known->second->hasUnresolvedNestedTypes())
+      return known->second.get();
+
+    retireContextArchetypeBuilder(sig, mod);
+  }
+
+  // Create a new archetype builder with the given signature, the same way the
+  // type checker populates a fresh builder with the signature of an outer
+  // context.
+  auto builder = new ArchetypeBuilder(*mod, Diags);
+  builder->addGenericSignature(sig, nullptr);
+
+  // Store this archetype builder.
+  Impl.ContextArchetypeBuilders[{sig, mod}]
+    = std::unique_ptr<ArchetypeBuilder>(builder);
+  return builder;
+}
+
+void ASTContext::retireContextArchetypeBuilder(GenericSignature *sig,
+                                               ModuleDecl *mod) {
+  UniquingLock lock(*this);
+  auto known = Impl.ContextArchetypeBuilders.find({sig, mod});
+  if (known == Impl.ContextArchetypeBuilders.end())
+    return;
+
+  Impl.RetiredArchetypeBuilders.push_back(std::move(known->second));
+  Impl.ContextArchetypeBuilders.erase(known);
+}
+
 Module *
 ASTContext::getModule(ArrayRef<std::pair<Identifier, SourceLoc>> ModulePath) {
   assert(!ModulePath.empty());
@@ -1273,6 +1504,16 @@ ASTContext::getModule(ArrayRef<std::pair<Identifier, SourceLoc>> ModulePath) {
   if (auto *M = getLoadedModule(ModulePath))
     return M;
 
+  TraceScope trace("import", [&] {
+    std::string name;
+    for (auto &component : ModulePath) {
+      if (!name.empty())
+        name += '.';
+      name += component.first.str();
+    }
+    return name;
+  });
+
   auto moduleID = ModulePath[0];
   for (auto &importer : Impl.ModuleLoaders) {
     if (Module *M = importer->loadModule(moduleID.second, ModulePath)) {
@@ -1373,6 +1614,7 @@ ASTContext::getConformance(Type conformingType,
                            SourceLoc loc,
                            DeclContext *dc,
                            ProtocolConformanceState state) {
+  UniquingLock lock(*this);
   llvm::FoldingSetNodeID id;
   NormalProtocolConformance::Profile(id, protocol, dc);
 
@@ -1396,6 +1638,7 @@ SpecializedProtocolConformance *
 ASTContext::getSpecializedConformance(Type type,
                                       ProtocolConformance *generic,
                                       ArrayRef<Substitution> substitutions) {
+  UniquingLock lock(*this);
   llvm::FoldingSetNodeID id;
   SpecializedProtocolConformance::Profile(id, type, generic);
 
@@ -1419,6 +1662,7 @@ ASTContext::getSpecializedConformance(Type type,
 
 InheritedProtocolConformance *
 ASTContext::getInheritedConformance(Type type, ProtocolConformance *inherited) {
+  UniquingLock lock(*this);
   llvm::FoldingSetNodeID id;
   InheritedProtocolConformance::Profile(id, type, inherited);
 
@@ -1478,6 +1722,7 @@ size_t ASTContext::getTotalMemory() const {
     // RemappedTypes ?
     sizeof(Impl) +
     Impl.Allocator.getTotalMemory() +
+    Impl.IdentifierAllocator.getTotalMemory() +
     Impl.Cleanups.capacity() +
     llvm::capacity_in_bytes(Impl.ModuleLoaders) +
     llvm::capacity_in_bytes(Impl.RawComments) +
@@ -1505,8 +1750,8 @@ size_t ASTContext::getTotalMemory() const {
 size_t ASTContext::getSolverMemory() const {
   size_t Size = 0;
   
-  if (Impl.CurrentConstraintSolverArena) {
-    Size += Impl.CurrentConstraintSolverArena->getTotalMemory();
+  if (Impl.getCurrentConstraintSolverArena()) {
+    Size += Impl.getCurrentConstraintSolverArena()->getTotalMemory();
   }
   
   return Size;
@@ -2384,6 +2629,7 @@ Type ErrorType::get(Type originalType) {
   auto arena = getArena(properties);
 
   auto &ctx = originalType->getASTContext();
+  UniquingLock lock(ctx);
   auto &entry = ctx.Impl.getArena(arena).ErrorTypesWithOriginal[originalType];
   if (entry) return entry;
 
@@ -2394,6 +2640,7 @@ Type ErrorType::get(Type originalType) {
 
 BuiltinIntegerType *BuiltinIntegerType::get(BuiltinIntegerWidth BitWidth,
                                             const ASTContext &C) {
+  UniquingLock lock(C);
   BuiltinIntegerType *&Result = C.Impl.IntegerTypes[BitWidth];
   if (Result == 0)
     Result = new (C, AllocationArena::Permanent) BuiltinIntegerType(BitWidth,C);
@@ -2403,6 +2650,7 @@ BuiltinIntegerType *BuiltinIntegerType::get(BuiltinIntegerWidth BitWidth,
 BuiltinVectorType *BuiltinVectorType::get(const ASTContext &context,
                                           Type elementType,
                                           unsigned numElements) {
+  UniquingLock lock(context);
   llvm::FoldingSetNodeID id;
   BuiltinVectorType::Profile(id, elementType, numElements);
 
@@ -2421,6 +2669,7 @@ BuiltinVectorType *BuiltinVectorType::get(const ASTContext &context,
 
 ParenType *ParenType::get(const ASTContext &C, Type underlying,
                           ParameterTypeFlags flags) {
+  UniquingLock lock(C);
   auto properties = underlying->getRecursiveProperties();
   auto arena = getArena(properties);
   ParenType *&Result =
@@ -2447,6 +2696,7 @@ void TupleType::Profile(llvm::FoldingSetNodeID &ID,
 
 /// getTupleType - Return the uniqued tuple type with the specified elements.
 Type TupleType::get(ArrayRef<TupleTypeElt> Fields, const ASTContext &C) {
+  UniquingLock lock(C);
   if (Fields.size() == 1 && !Fields[0].isVararg() && !Fields[0].hasName())
     return ParenType::get(C, Fields[0].getType(),
                           Fields[0].getParameterFlags());
@@ -2497,6 +2747,7 @@ void UnboundGenericType::Profile(llvm::FoldingSetNodeID &ID,
 
 UnboundGenericType *UnboundGenericType::
 get(GenericTypeDecl *TheDecl, Type Parent, const ASTContext &C) {
+  UniquingLock lock(C);
   llvm::FoldingSetNodeID ID;
   UnboundGenericType::Profile(ID, TheDecl, Parent);
   void *InsertPos = 0;
@@ -2543,6 +2794,7 @@ BoundGenericType *BoundGenericType::get(NominalTypeDecl *TheDecl,
                                         Type Parent,
                                         ArrayRef<Type> GenericArgs) {
   ASTContext &C = TheDecl->getDeclContext()->getASTContext();
+  UniquingLock lock(C);
   llvm::FoldingSetNodeID ID;
   RecursiveTypeProperties properties;
   BoundGenericType::Profile(ID, TheDecl, Parent, GenericArgs, properties);
@@ -2608,6 +2860,7 @@ EnumType::EnumType(EnumDecl *TheDecl, Type Parent, const ASTContext &C,
   : NominalType(TypeKind::Enum, &C, TheDecl, Parent, properties) { }
 
 EnumType *EnumType::get(EnumDecl *D, Type Parent, const ASTContext &C) {
+  UniquingLock lock(C);
   llvm::FoldingSetNodeID id;
   EnumType::Profile(id, D, Parent);
 
@@ -2635,6 +2888,7 @@ StructType::StructType(StructDecl *TheDecl, Type Parent, const ASTContext &C,
   : NominalType(TypeKind::Struct, &C, TheDecl, Parent, properties) { }
 
 StructType *StructType::get(StructDecl *D, Type Parent, const ASTContext &C) {
+  UniquingLock lock(C);
   llvm::FoldingSetNodeID id;
   StructType::Profile(id, D, Parent);
 
@@ -2662,6 +2916,7 @@ ClassType::ClassType(ClassDecl *TheDecl, Type Parent, const ASTContext &C,
   : NominalType(TypeKind::Class, &C, TheDecl, Parent, properties) { }
 
 ClassType *ClassType::get(ClassDecl *D, Type Parent, const ASTContext &C) {
+  UniquingLock lock(C);
   llvm::FoldingSetNodeID id;
   ClassType::Profile(id, D, Parent);
 
@@ -2686,6 +2941,7 @@ void ClassType::Profile(llvm::FoldingSetNodeID &ID, ClassDecl *D, Type Parent) {
 
 ProtocolCompositionType *
 ProtocolCompositionType::build(const ASTContext &C, ArrayRef<Type> Protocols) {
+  UniquingLock lock(C);
   // Check to see if we've already seen this protocol composition before.
   void *InsertPos = 0;
   llvm::FoldingSetNodeID ID;
@@ -2711,6 +2967,7 @@ ProtocolCompositionType::build(const ASTContext &C, ArrayRef<Type> Protocols) {
 
 ReferenceStorageType *ReferenceStorageType::get(Type T, Ownership ownership,
                                                 const ASTContext &C) {
+  UniquingLock lock(C);
   assert(ownership != Ownership::Strong &&
          "ReferenceStorageType is unnecessary for strong ownership");
   assert(!T->hasTypeVariable()); // not meaningful in type-checker
@@ -2756,6 +3013,7 @@ AnyMetatypeType::AnyMetatypeType(TypeKind kind, const ASTContext *C,
 
 MetatypeType *MetatypeType::get(Type T, Optional<MetatypeRepresentation> Repr,
                                 const ASTContext &Ctx) {
+  UniquingLock lock(Ctx);
   auto properties = T->getRecursiveProperties();
   auto arena = getArena(properties);
 
@@ -2782,6 +3040,7 @@ MetatypeType::MetatypeType(Type T, const ASTContext *C,
 ExistentialMetatypeType *
 ExistentialMetatypeType::get(Type T, Optional<MetatypeRepresentation> repr,
                              const ASTContext &ctx) {
+  UniquingLock lock(ctx);
   auto properties = T->getRecursiveProperties();
   auto arena = getArena(properties);
 
@@ -2814,6 +3073,7 @@ ExistentialMetatypeType::ExistentialMetatypeType(Type T,
 
 ModuleType *ModuleType::get(Module *M) {
   ASTContext &C = M->getASTContext();
+  UniquingLock lock(C);
 
   ModuleType *&Entry = C.Impl.ModuleTypes[M];
   if (Entry) return Entry;
@@ -2822,6 +3082,7 @@ ModuleType *ModuleType::get(Module *M) {
 }
 
 DynamicSelfType *DynamicSelfType::get(Type selfType, const ASTContext &ctx) {
+  UniquingLock lock(ctx);
   auto properties = selfType->getRecursiveProperties();
   assert(properties.isMaterializable() && "non-materializable dynamic self?");
   auto arena = getArena(properties);
@@ -2895,6 +3156,7 @@ FunctionType *FunctionType::get(Type Input, Type Result,
   uint16_t attrKey = Info.getFuncAttrKey();
 
   const ASTContext &C = Input->getASTContext();
+  UniquingLock lock(C);
 
   FunctionType *&Entry
     = C.Impl.getArena(arena).FunctionTypes[{Input, {Result, attrKey} }];
@@ -2969,6 +3231,7 @@ GenericFunctionType::get(GenericSignature *sig,
   GenericFunctionType::Profile(id, sig, input, output, info);
 
   const ASTContext &ctx = input->getASTContext();
+  UniquingLock lock(ctx);
 
   // Do we already have this generic function type?
   void *insertPos;
@@ -3018,6 +3281,7 @@ GenericFunctionType::GenericFunctionType(
 
 GenericTypeParamType *GenericTypeParamType::get(unsigned depth, unsigned index,
                                                 const ASTContext &ctx) {
+  UniquingLock lock(ctx);
   auto known = ctx.Impl.GenericParamTypes.find({ depth, index });
   if (known != ctx.Impl.GenericParamTypes.end())
     return known->second;
@@ -3138,6 +3402,7 @@ SILFunctionType::SILFunctionType(GenericSignature *genericSig,
 
 CanSILBlockStorageType SILBlockStorageType::get(CanType captureType) {
   ASTContext &ctx = captureType->getASTContext();
+  UniquingLock lock(ctx);
   auto found = ctx.Impl.SILBlockStorageTypes.find(captureType);
   if (found != ctx.Impl.SILBlockStorageTypes.end())
     return CanSILBlockStorageType(found->second);
@@ -3152,6 +3417,7 @@ CanSILBlockStorageType SILBlockStorageType::get(CanType captureType) {
 
 CanSILBoxType SILBoxType::get(CanType boxType) {
   ASTContext &ctx = boxType->getASTContext();
+  UniquingLock lock(ctx);
   auto found = ctx.Impl.SILBoxTypes.find(boxType);
   if (found != ctx.Impl.SILBoxTypes.end())
     return CanSILBoxType(found->second);
@@ -3170,6 +3436,7 @@ CanSILFunctionType SILFunctionType::get(GenericSignature *genericSig,
                                     ArrayRef<SILResultInfo> allResults,
                                     Optional<SILResultInfo> errorResult,
                                     const ASTContext &ctx) {
+  UniquingLock lock(ctx);
   llvm::FoldingSetNodeID id;
   SILFunctionType::Profile(id, genericSig, ext, callee,
                            params, allResults, errorResult);
@@ -3234,6 +3501,7 @@ ArraySliceType *ArraySliceType::get(Type base) {
   auto arena = getArena(properties);
 
   const ASTContext &C = base->getASTContext();
+  UniquingLock lock(C);
 
   ArraySliceType *&entry = C.Impl.getArena(arena).ArraySliceTypes[base];
   if (entry) return entry;
@@ -3247,6 +3515,7 @@ DictionaryType *DictionaryType::get(Type keyType, Type valueType) {
   auto arena = getArena(properties);
 
   const ASTContext &C = keyType->getASTContext();
+  UniquingLock lock(C);
 
   DictionaryType *&entry
     = C.Impl.getArena(arena).DictionaryTypes[{keyType, valueType}];
@@ -3272,6 +3541,7 @@ OptionalType *OptionalType::get(Type base) {
   auto arena = getArena(properties);
 
   const ASTContext &C = base->getASTContext();
+  UniquingLock lock(C);
 
   OptionalType *&entry = C.Impl.getArena(arena).OptionalTypes[base];
   if (entry) return entry;
@@ -3284,6 +3554,7 @@ ImplicitlyUnwrappedOptionalType *ImplicitlyUnwrappedOptionalType::get(Type base)
   auto arena = getArena(properties);
 
   const ASTContext &C = base->getASTContext();
+  UniquingLock lock(C);
 
   auto *&entry = C.Impl.getArena(arena).ImplicitlyUnwrappedOptionalTypes[base];
   if (entry) return entry;
@@ -3292,6 +3563,7 @@ ImplicitlyUnwrappedOptionalType *ImplicitlyUnwrappedOptionalType::get(Type base)
 }
 
 ProtocolType *ProtocolType::get(ProtocolDecl *D, const ASTContext &C) {
+  UniquingLock lock(C);
   // Protocol types can never be nested inside other types, but we should
   // model this anyway to fix some compiler crashes when computing
   // substitutions on invalid code.
@@ -3336,6 +3608,7 @@ LValueType *LValueType::get(Type objectTy) {
   auto arena = getArena(properties);
 
   auto &C = objectTy->getASTContext();
+  UniquingLock lock(C);
   auto &entry = C.Impl.getArena(arena).LValueTypes[objectTy];
   if (entry)
     return entry;
@@ -3356,6 +3629,7 @@ InOutType *InOutType::get(Type objectTy) {
   auto arena = getArena(properties);
 
   auto &C = objectTy->getASTContext();
+  UniquingLock lock(C);
   auto &entry = C.Impl.getArena(arena).InOutTypes[objectTy];
   if (entry)
     return entry;
@@ -3368,6 +3642,7 @@ InOutType *InOutType::get(Type objectTy) {
 /// Return a uniqued substituted type.
 SubstitutedType *SubstitutedType::get(Type Original, Type Replacement,
                                       const ASTContext &C) {
+  UniquingLock lock(C);
   auto properties = Replacement->getRecursiveProperties();
   auto arena = getArena(properties);
 
@@ -3387,6 +3662,7 @@ DependentMemberType *DependentMemberType::get(Type base, Identifier name) {
 
   llvm::PointerUnion<Identifier, AssociatedTypeDecl *> stored(name);
   const ASTContext &ctx = base->getASTContext();
+  UniquingLock lock(ctx);
   auto *&known = ctx.Impl.getArena(arena).DependentMemberTypes[
                                             {base, stored.getOpaqueValue()}];
   if (!known) {
@@ -3405,6 +3681,7 @@ DependentMemberType *DependentMemberType::get(Type base,
 
   llvm::PointerUnion<Identifier, AssociatedTypeDecl *> stored(assocType);
   const ASTContext &ctx = base->getASTContext();
+  UniquingLock lock(ctx);
   auto *&known = ctx.Impl.getArena(arena).DependentMemberTypes[
                                             {base, stored.getOpaqueValue()}];
   if (!known) {
@@ -3418,6 +3695,7 @@ DependentMemberType *DependentMemberType::get(Type base,
 CanArchetypeType ArchetypeType::getOpened(Type existential,
                                         Optional<UUID> knownID) {
   auto &ctx = existential->getASTContext();
+  UniquingLock lock(ctx);
   auto &openedExistentialArchetypes = ctx.Impl.OpenedExistentialArchetypes;
   // If we know the ID already...
   if (knownID) {
@@ -3538,6 +3816,7 @@ GenericSignature *GenericSignature::get(ArrayRef<GenericTypeParamType *> params,
   GenericSignature::Profile(ID, params, requirements);
 
   auto &ctx = getASTContext(params, requirements);
+  UniquingLock lock(ctx);
   void *insertPos;
   if (auto *sig = ctx.Impl.GenericSignatures.FindNodeOrInsertPos(ID,
                                                                  insertPos)) {
@@ -3582,6 +3861,7 @@ void DeclName::initialize(ASTContext &C, Identifier baseName,
   llvm::FoldingSetNodeID id;
   CompoundDeclName::Profile(id, baseName, argumentNames);
 
+  UniquingLock lock(C);
   void *insert = nullptr;
   if (CompoundDeclName *compoundName
         = C.Impl.CompoundNames.FindNodeOrInsertPos(id, insert)) {
@@ -3882,6 +4162,7 @@ Type ASTContext::getBridgedToObjC(const DeclContext *dc, Type type,
 
 std::pair<ArchetypeBuilder *, ArchetypeBuilder::PotentialArchetype *>
 ASTContext::getLazyArchetype(const ArchetypeType *archetype) {
+  UniquingLock lock(*this);
   auto known = Impl.LazyArchetypes.find(archetype);
   assert(known != Impl.LazyArchetypes.end());
   return known->second;
@@ -3891,11 +4172,13 @@ void ASTContext::registerLazyArchetype(
        const ArchetypeType *archetype,
        ArchetypeBuilder &builder,
        ArchetypeBuilder::PotentialArchetype *potentialArchetype) {
+  UniquingLock lock(*this);
   assert(Impl.LazyArchetypes.count(archetype) == 0);
   Impl.LazyArchetypes[archetype] = { &builder, potentialArchetype };
 }
 
 void ASTContext::unregisterLazyArchetype(const ArchetypeType *archetype) {
+  UniquingLock lock(*this);
   auto known = Impl.LazyArchetypes.find(archetype);
   assert(known != Impl.LazyArchetypes.end());
   Impl.LazyArchetypes.erase(known);
@@ -25,9 +25,17 @@
 #include "swift/AST/Stmt.h"
 #include "swift/Basic/Fallthrough.h"
 #include "swift/Basic/STLExtras.h"
+#include "llvm/ADT/DenseMap.h"
 #include <algorithm>
 using namespace swift;
 
+/// Maps a scope and a name to the result of
+/// \c skipScopesWithoutLocalBinding() for them.
+struct ASTScope::LocalLookupCache {
+  llvm::DenseMap<std::pair<const ASTScope *, DeclName>, const ASTScope *>
+    results;
+};
+
 const ASTScope *ASTScope::getActiveContinuation() const {
   switch (continuation.getInt()) {
   case ContinuationKind::Historical:
@@ -311,6 +319,7 @@ void ASTScope::expand() const {
 
         // Note the next element to be consumed.
         sourceFile.nextElement = i + 1;
+        invalidateLocalLookupCache();
 
         // Create a child node for this declaration.
         if (ASTScope *child = createIfNeeded(this, decl))
@@ -687,6 +696,7 @@ ASTScope *ASTScope::createRoot(SourceFile *sourceFile) {
   ASTScope *scope = new (ctx) ASTScope(sourceFile, 0);
   scope->sourceFile.file = sourceFile;
   scope->sourceFile.nextElement = 0;
+  scope->sourceFile.lookupCache = nullptr;
 
   return scope;
 }
@@ -1311,6 +1321,7 @@ void ASTScope::enumerateContinuationScopes(
                               continuationDecls.size())) {
         // Note the next element to be consumed.
         continuation->sourceFile.nextElement = i + 1;
+        invalidateLocalLookupCache();
 
         Decl *decl = continuation->sourceFile.file->Decls[i];
 
@@ -1398,6 +1409,22 @@ SourceFile &ASTScope::getSourceFile() const {
   return *getSourceFileScope()->sourceFile.file;
 }
 
+ASTScope::LocalLookupCache &ASTScope::getLocalLookupCache() const {
+  auto sourceFileScope = getSourceFileScope();
+  auto &cache = sourceFileScope->sourceFile.lookupCache;
+  if (!cache) {
+    cache = new LocalLookupCache;
+    getASTContext().addCleanup([cache] { delete cache; });
+  }
+
+  return *cache;
+}
+
+void ASTScope::invalidateLocalLookupCache() const {
+  if (auto cache = getSourceFileScope()->sourceFile.lookupCache)
+    cache->results.clear();
+}
+
 SourceRange ASTScope::getSourceRangeImpl() const {
   switch (kind) {
   case ASTScopeKind::Preexpanded:
@@ -1903,6 +1930,48 @@ SmallVector<ValueDecl *, 4> ASTScope::getLocalBindings() const {
   return result;
 }
 
+bool ASTScope::stopsLocalLookup(DeclName name) const {
+  // Unqualified lookup looks for 'self' in function bodies and into the
+  // declaration contexts.
+  if (getKind() == ASTScopeKind::AbstractFunctionBody || getDeclContext())
+    return true;
+
+  for (auto local : getLocalBindings()) {
+    if (local->getFullName().matchesRef(name))
+      return true;
+  }
+
+  return false;
+}
+
+const ASTScope *ASTScope::skipScopesWithoutLocalBinding(DeclName name) const {
+  auto &results = getLocalLookupCache().results;
+
+  // Walk outward until we find a scope where lookup stops, or one whose
+  // result we already know.
+  SmallVector<const ASTScope *, 8> skipped;
+  const ASTScope *result = this;
+  while (result) {
+    auto known = results.find({result, name});
+    if (known != results.end()) {
+      result = known->second;
+      break;
+    }
+
+    if (result->stopsLocalLookup(name))
+      break;
+
+    skipped.push_back(result);
+    result = result->getParent();
+  }
+
+  // Remember the result for every scope we walked over.
+  for (auto scope : skipped)
+    results[{scope, name}] = result;
+
+  return result;
+}
+
 void ASTScope::expandAll() const {
   if (!isExpanded())
     expand();
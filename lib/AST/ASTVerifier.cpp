@@ -23,10 +23,13 @@
 #include "swift/AST/GenericEnvironment.h"
 #include "swift/AST/Mangle.h"
 #include "swift/AST/PrettyStackTrace.h"
+#include "swift/Basic/Program.h"
 #include "swift/Basic/SourceManager.h"
 #include "llvm/ADT/SmallBitVector.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/SaveAndRestore.h"
+#include <algorithm>
 #include <functional>
 using namespace swift;
 
@@ -2759,8 +2762,41 @@ struct ASTNodeBase {};
   };
 }
 
+#if !(defined(NDEBUG) || defined(SWIFT_DISABLE_AST_VERIFIER))
+/// Source files with fewer declarations per worker are verified in-process.
+static const size_t MinDeclsPerVerifierWorker = 32;
+#endif
+
 void swift::verify(SourceFile &SF) {
 #if !(defined(NDEBUG) || defined(SWIFT_DISABLE_AST_VERIFIER))
+  // Top-level declarations are verified independently of each other, so they
+  // can be split between worker processes. Top-level code is not, because the
+  // closure discriminators are checked across all of it.
+  ArrayRef<Decl *> decls = SF.Decls;
+  unsigned numWorkers = std::min<size_t>(
+      SF.getASTContext().LangOpts.VerifierWorkerCount,
+      decls.size() / MinDeclsPerVerifierWorker);
+  if (numWorkers > 1 &&
+      std::none_of(decls.begin(), decls.end(),
+                   [](Decl *D) { return isa<TopLevelCodeDecl>(D); })) {
+    bool verified = runShardsInWorkerProcesses(numWorkers, [&](unsigned i) {
+      size_t begin = decls.size() * i / numWorkers;
+      size_t end = decls.size() * (i + 1) / numWorkers;
+      Verifier verifier(SF, &SF);
+      llvm::SaveAndRestore<ASTWalker::ParentTy> SAR(verifier.Parent,
+                                                    SF.getParentModule());
+      for (Decl *D : decls.slice(begin, end - begin)) {
+        PrettyStackTraceDecl debugStack("walking into decl", D);
+        D->walk(verifier);
+      }
+    });
+    if (!verified) {
+      llvm::errs() << "AST verification failed in a worker process\n";
+      abort();
+    }
+    return;
+  }
+
   Verifier verifier(SF, &SF);
   SF.walk(verifier);
 #endif
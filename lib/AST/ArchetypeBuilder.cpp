@@ -1720,6 +1720,10 @@ static Identifier typoCorrectNestedType(
   return bestMatches.front();
 }
 
+bool ArchetypeBuilder::hasUnresolvedNestedTypes() const {
+  return Impl->NumUnresolvedNestedTypes > 0;
+}
+
 void
 ArchetypeBuilder::finalize(SourceLoc loc, bool allowConcreteGenericParams) {
   SmallPtrSet<PotentialArchetype *, 4> visited;
@@ -274,6 +274,8 @@ void ConformanceLookupTable::updateLookupTable(NominalTypeDecl *nominal,
     // Record all of the explicit conformances.
     forEachInStage(stage, nominal, resolver,
                    [&](NominalTypeDecl *nominal) {
+                     if (LoadedContexts.count(nominal))
+                       return;
                      if (resolver)
                        resolver->resolveInheritanceClause(nominal);
 
@@ -282,6 +284,8 @@ void ConformanceLookupTable::updateLookupTable(NominalTypeDecl *nominal,
                                   resolver);
                    },
                    [&](ExtensionDecl *ext) {
+                     if (LoadedContexts.count(ext))
+                       return;
                      if (resolver)
                        resolver->resolveInheritanceClause(ext);
 
@@ -345,13 +349,16 @@ void ConformanceLookupTable::updateLookupTable(NominalTypeDecl *nominal,
     // before expanding.
     updateLookupTable(nominal, ConformanceStage::Inherited, resolver);
 
-    // Expand inherited conformances.
+    // Expand inherited conformances. Those of serialized contexts were
+    // expanded when their module was built.
     forEachInStage(stage, nominal, resolver,
                    [&](NominalTypeDecl *nominal) {
-                     expandImpliedConformances(nominal, nominal, resolver);
+                     if (!LoadedContexts.count(nominal))
+                       expandImpliedConformances(nominal, nominal, resolver);
                    },
                    [&](ExtensionDecl *ext) {
-                     expandImpliedConformances(nominal, ext, resolver);
+                     if (!LoadedContexts.count(ext))
+                       expandImpliedConformances(nominal, ext, resolver);
                    });
     break;
 
@@ -406,6 +413,8 @@ void ConformanceLookupTable::loadAllConformances(
   if (dc->getParentSourceFile())
     return;
 
+  LoadedContexts.insert(dc);
+
   // Add entries for each loaded conformance.
   for (auto conformance : conformances) {
     registerProtocolConformance(conformance);
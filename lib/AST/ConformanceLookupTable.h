@@ -27,6 +27,7 @@
 #include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/PointerUnion.h"
 #include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include <unordered_map>
 
 namespace swift {
@@ -326,6 +327,15 @@ class ConformanceLookupTable {
   /// Indicates whether we are visiting the superclass.
   bool VisitingSuperclass = false;
 
+  /// The declaration contexts whose conformances were loaded from a
+  /// serialized module.
+  ///
+  /// A module records the resolved conformances of each context, including
+  /// the implied ones, so the explicit conformances of these contexts need
+  /// not be recorded from their inheritance clauses, nor their implied
+  /// conformances expanded, again.
+  llvm::SmallPtrSet<DeclContext *, 4> LoadedContexts;
+
   /// Add a protocol.
   bool addProtocol(NominalTypeDecl *nominal,
                    ProtocolDecl *protocol, SourceLoc loc,
@@ -26,6 +26,7 @@
 #include "swift/Basic/SourceManager.h"
 #include "swift/Basic/STLExtras.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/TinyPtrVector.h"
 
 using namespace swift;
@@ -486,6 +487,11 @@ UnqualifiedLookup::UnqualifiedLookup(DeclName Name, DeclContext *DC,
     bool withinDefaultArgument = false;
     for (auto currentScope = lookupScope; currentScope;
          currentScope = currentScope->getParent()) {
+      // Skip the scopes that cannot affect the result of this lookup.
+      currentScope = currentScope->skipScopesWithoutLocalBinding(Name);
+      if (!currentScope)
+        break;
+
       // Perform local lookup within this scope.
       auto localBindings = currentScope->getLocalBindings();
       for (auto local : localBindings) {
@@ -992,6 +998,10 @@ class swift::MemberLookupTable {
   /// Lookup table mapping names to the set of declarations with that name.
   LookupTable Lookup;
 
+  /// The base names whose members have been loaded from the lazily-loaded
+  /// contexts included in the table, when members are loaded by name.
+  llvm::DenseSet<Identifier> LoadedNames;
+
 public:
   /// Create a new member lookup table.
   explicit MemberLookupTable(ASTContext &ctx);
@@ -1002,6 +1012,14 @@ public:
   /// Update a lookup table with members from newly-added extensions.
   void updateLookupTable(NominalTypeDecl *nominal);
 
+  /// Update a lookup table with the members added so far to newly-added
+  /// extensions, without loading their lazily-loaded members.
+  void updateLookupTableWithoutLoading(NominalTypeDecl *nominal);
+
+  /// Load the members with the given base name from the lazily-loaded
+  /// contexts included in the table, and add them to it.
+  void loadNamedMembers(NominalTypeDecl *nominal, Identifier name);
+
   /// \brief Add the given member to the lookup table.
   void addMember(Decl *members);
 
@@ -1133,7 +1151,9 @@ void MemberLookupTable::updateLookupTable(NominalTypeDecl *nominal) {
   if (LastExtensionIncluded == nominal->LastExtension)
     return;
 
-  // Add members from each of the extensions that we have not yet visited.
+  // Add members from each of the extensions that we have not yet visited,
+  // loading them as needed. The extensions we have visited never need to be
+  // looked at again.
   for (auto next = LastExtensionIncluded
                      ? LastExtensionIncluded->NextExtension.getPointer()
                      : nominal->FirstExtension;
@@ -1143,6 +1163,58 @@ void MemberLookupTable::updateLookupTable(NominalTypeDecl *nominal) {
   }
 }
 
+void MemberLookupTable::updateLookupTableWithoutLoading(
+    NominalTypeDecl *nominal) {
+  if (LastExtensionIncluded == nominal->LastExtension)
+    return;
+
+  // No names have been loaded from the new extensions yet.
+  LoadedNames.clear();
+
+  // Members which are loaded later are added to the table as they are added
+  // to their extension.
+  for (auto next = LastExtensionIncluded
+                     ? LastExtensionIncluded->NextExtension.getPointer()
+                     : nominal->FirstExtension;
+       next;
+       (LastExtensionIncluded = next,next = next->NextExtension.getPointer())) {
+    addMembers(next->getCurrentMembersWithoutLoading());
+  }
+}
+
+void MemberLookupTable::loadNamedMembers(NominalTypeDecl *nominal,
+                                         Identifier name) {
+  if (!LoadedNames.insert(name).second)
+    return;
+
+  auto loadFrom = [&](Decl *container, IterableDeclContext *IDC) {
+    if (!IDC->isLazy())
+      return;
+
+    auto members = IDC->getLoader()->loadNamedMembers(
+        container, name, IDC->getLoaderContextData());
+    if (!members) {
+      // The loader can't find members by name. Load all of them, which adds
+      // them to the table.
+      (void)IDC->getMembers();
+      return;
+    }
+
+    for (auto member : *members)
+      addMember(member);
+  };
+
+  loadFrom(nominal, nominal);
+  if (!LastExtensionIncluded)
+    return;
+  for (auto ext = nominal->FirstExtension; ext;
+       ext = ext->NextExtension.getPointer()) {
+    loadFrom(ext, ext);
+    if (ext == LastExtensionIncluded)
+      break;
+  }
+}
+
 void MemberLookupTable::destroy() {
   this->~MemberLookupTable();
 }
@@ -1159,15 +1231,11 @@ void ExtensionDecl::addedMember(Decl *member) {
     if (getExtendedType()->hasError())
       return;
 
+    // If this extension hasn't been included in the lookup table yet, the
+    // member will be skipped as a duplicate when it is.
     auto nominal = getExtendedType()->getAnyNominal();
-    if (nominal->LookupTable.getPointer()) {
-      // Make sure we have the complete list of extensions.
-      // FIXME: This is completely unnecessary. We want to determine whether
-      // our own extension has already been included in the lookup table.
-      (void)nominal->getExtensions();
-
+    if (nominal->LookupTable.getPointer())
       nominal->LookupTable.getPointer()->addMember(member);
-    }
   }
 }
 
@@ -1178,6 +1246,10 @@ void NominalTypeDecl::prepareLookupTable(bool ignoreNewExtensions) {
     LookupTable.setPointer(new (ctx) MemberLookupTable(ctx));
   }
 
+  // When members are loaded by name, lazily-loaded members are added to the
+  // table as they are loaded.
+  bool loadByName = getASTContext().LangOpts.NamedLazyMemberLoading;
+
   // If we haven't walked the member list yet to update the lookup
   // table, do so now.
   if (!LookupTable.getInt()) {
@@ -1185,12 +1257,16 @@ void NominalTypeDecl::prepareLookupTable(bool ignoreNewExtensions) {
     LookupTable.setInt(true);
 
     // Add the members of the nominal declaration to the table.
-    LookupTable.getPointer()->addMembers(getMembers());
+    LookupTable.getPointer()->addMembers(
+        loadByName ? getCurrentMembersWithoutLoading() : getMembers());
   }
 
   if (!ignoreNewExtensions) {
     // Update the lookup table to introduce members from extensions.
-    LookupTable.getPointer()->updateLookupTable(this);
+    if (loadByName)
+      LookupTable.getPointer()->updateLookupTableWithoutLoading(this);
+    else
+      LookupTable.getPointer()->updateLookupTable(this);
   }
 }
 
@@ -1205,17 +1281,17 @@ void NominalTypeDecl::makeMemberVisible(ValueDecl *member) {
 
 ArrayRef<ValueDecl *> NominalTypeDecl::lookupDirect(DeclName name,
                                                     bool ignoreNewExtensions) {
-  // Make sure we have the complete list of members (in this nominal and in all
-  // extensions).
-  if (!ignoreNewExtensions) {
-    for (auto E : getExtensions())
-      (void)E->getMembers();
-  }
-
-  (void)getMembers();
+  // Make sure we have the complete list of extensions. Only the members of the
+  // extensions that the lookup table hasn't seen yet need to be loaded; the
+  // table picks up members added to the others as they are added.
+  if (!ignoreNewExtensions)
+    (void)getExtensions();
 
   prepareLookupTable(ignoreNewExtensions);
 
+  if (getASTContext().LangOpts.NamedLazyMemberLoading)
+    LookupTable.getPointer()->loadNamedMembers(this, name.getBaseName());
+
   // Look for the declarations with this name.
   auto known = LookupTable.getPointer()->find(name);
   if (known == LookupTable.getPointer()->end())
@@ -14,12 +14,25 @@
 #include "Darwin/Cache-Mac.cpp"
 #else
 
-//  This file implements a default caching implementation that never evicts
-//  its entries.
+//  This file implements a default caching implementation for the platforms
+//  without libcache.  The entries are split into shards by their key hash,
+//  each with its own lock and its own LRU list.  Once the total cost of the
+//  cache exceeds its limit, the least recently used values which aren't
+//  retained are evicted.
 
 #include "swift/Basic/Cache.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/Mutex.h"
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <list>
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
 
 using namespace swift::sys;
 using llvm::StringRef;
@@ -32,14 +45,6 @@ struct DefaultCacheKey {
   //DefaultCacheKey() = default;
   DefaultCacheKey(void *Key, CacheImpl::CallBacks *CBs) : Key(Key), CBs(CBs) {}
 };
-
-struct DefaultCache {
-  llvm::sys::Mutex Mux;
-  CacheImpl::CallBacks CBs;
-  llvm::DenseMap<DefaultCacheKey, void *> Entries;
-
-  explicit DefaultCache(CacheImpl::CallBacks CBs) : CBs(std::move(CBs)) { }
-};
 } // end anonymous namespace
 
 namespace llvm {
@@ -51,7 +56,7 @@ template<> struct DenseMapInfo<DefaultCacheKey> {
     return { DenseMapInfo<void*>::getTombstoneKey(), nullptr };
   }
   static unsigned getHashValue(const DefaultCacheKey &Val) {
-    uintptr_t Hash = Val.CBs->keyHashCB(Val.Key, nullptr);
+    uintptr_t Hash = Val.CBs->keyHashCB(Val.Key, Val.CBs->UserData);
     return DenseMapInfo<uintptr_t>::getHashValue(Hash);
   }
   static bool isEqual(const DefaultCacheKey &LHS, const DefaultCacheKey &RHS) {
@@ -62,81 +67,320 @@ template<> struct DenseMapInfo<DefaultCacheKey> {
         RHS.Key == DenseMapInfo<void*>::getEmptyKey() ||
         RHS.Key == DenseMapInfo<void*>::getTombstoneKey())
       return false;
-    return LHS.CBs->keyIsEqualCB(LHS.Key, RHS.Key, nullptr);
+    return LHS.CBs->keyIsEqualCB(LHS.Key, RHS.Key, LHS.CBs->UserData);
   }
 };
 }
 
+namespace {
+struct CacheEntry {
+  void *Key;
+  void *Value;
+  size_t Cost;
+};
+
+typedef std::list<CacheEntry>::iterator EntryIterator;
+
+/// The entries of the keys which hash into one shard of the cache.
+struct CacheShard {
+  llvm::sys::Mutex Mux;
+
+  /// The entries, the most recently used first.
+  std::list<CacheEntry> LRU;
+  llvm::DenseMap<DefaultCacheKey, EntryIterator> Entries;
+};
+
+/// The number of times a value is retained by clients.  A retained value
+/// stays alive after its entries are removed, until it is released.
+struct ValueRecord {
+  unsigned RetainCount = 0;
+
+  /// The number of removed entries whose references to the value still need
+  /// to be destroyed.
+  unsigned PendingDestroys = 0;
+};
+
+/// The retain counts of the values whose addresses hash into one shard.
+///
+/// The lock of a value shard may be taken while holding the lock of a cache
+/// shard, but not the other way around.
+struct ValueShard {
+  llvm::sys::Mutex Mux;
+  llvm::DenseMap<void *, ValueRecord> Records;
+};
+
+typedef llvm::SmallVector<void *, 4> ValueList;
+
+struct DefaultCache {
+  enum { NumShards = 8 };
+
+  CacheImpl::CallBacks CBs;
+  CacheShard Shards[NumShards];
+  ValueShard ValueShards[NumShards];
+
+  std::atomic<size_t> TotalCost{0};
+  std::atomic<size_t> CostLimit;
+
+  DefaultCache(CacheImpl::CallBacks CBs, size_t Limit)
+    : CBs(std::move(CBs)), CostLimit(Limit) { }
+
+  unsigned getShardIndex(const void *Key) {
+    uintptr_t Hash = CBs.keyHashCB(const_cast<void*>(Key), CBs.UserData);
+    return llvm::hash_value(Hash) % NumShards;
+  }
+
+  ValueShard &getValueShard(void *Value) {
+    return ValueShards[llvm::hash_value(Value) % NumShards];
+  }
+
+  void retainValue(void *Value);
+  void releaseValue(void *Value);
+  bool isRetained(void *Value);
+
+  /// Removes an entry of a locked shard.  Values which have to be destroyed
+  /// are added to \p ToDestroy, to be destroyed once the shard is unlocked.
+  void removeEntry(CacheShard &Shard, EntryIterator Entry,
+                   ValueList &ToDestroy);
+
+  /// Evicts the least recently used entries of a locked shard whose values
+  /// aren't retained, until the cache is within its cost limit.  If \p All is
+  /// true, evicts all entries whose values aren't retained.
+  void evict(CacheShard &Shard, bool All, ValueList &ToDestroy);
+
+  /// Evicts entries until the cache is within its cost limit, starting with
+  /// the shard at \p FirstShard.
+  void evictToCostLimit(unsigned FirstShard);
+
+  /// Evicts all entries whose values aren't retained.
+  void purge();
+
+  void destroyValues(const ValueList &Values) {
+    for (void *Value : Values)
+      CBs.valueDestroyCB(Value, CBs.UserData);
+  }
+};
+
+/// All the live caches, for purging them under memory pressure.
+struct CacheRegistry {
+  llvm::sys::Mutex Mux;
+  llvm::SmallPtrSet<DefaultCache *, 8> Caches;
+};
+} // end anonymous namespace
+
+static CacheRegistry &getCacheRegistry() {
+  static CacheRegistry Registry;
+  return Registry;
+}
+
+/// The costs are typically memory sizes, so by default a cache may keep a
+/// quarter of the physical memory.
+static size_t getDefaultCostLimit() {
+#if defined(_SC_PHYS_PAGES) && defined(_SC_PAGESIZE)
+  long Pages = sysconf(_SC_PHYS_PAGES);
+  long PageSize = sysconf(_SC_PAGESIZE);
+  if (Pages > 0 && PageSize > 0) {
+    uint64_t Limit = uint64_t(Pages) / 4 * uint64_t(PageSize);
+    return std::min<uint64_t>(Limit, std::numeric_limits<size_t>::max());
+  }
+#endif
+  return std::numeric_limits<size_t>::max();
+}
+
+void DefaultCache::retainValue(void *Value) {
+  ValueShard &VShard = getValueShard(Value);
+  llvm::sys::ScopedLock L(VShard.Mux);
+  ++VShard.Records[Value].RetainCount;
+}
+
+void DefaultCache::releaseValue(void *Value) {
+  unsigned NumDestroys;
+  {
+    ValueShard &VShard = getValueShard(Value);
+    llvm::sys::ScopedLock L(VShard.Mux);
+    auto Record = VShard.Records.find(Value);
+    assert(Record != VShard.Records.end() && Record->second.RetainCount &&
+           "releasing a value which isn't retained");
+    if (--Record->second.RetainCount)
+      return;
+    NumDestroys = Record->second.PendingDestroys;
+    VShard.Records.erase(Record);
+  }
+
+  for (unsigned i = 0; i != NumDestroys; ++i)
+    CBs.valueDestroyCB(Value, CBs.UserData);
+}
+
+bool DefaultCache::isRetained(void *Value) {
+  ValueShard &VShard = getValueShard(Value);
+  llvm::sys::ScopedLock L(VShard.Mux);
+  return VShard.Records.count(Value);
+}
+
+void DefaultCache::removeEntry(CacheShard &Shard, EntryIterator Entry,
+                               ValueList &ToDestroy) {
+  Shard.Entries.erase(DefaultCacheKey(Entry->Key, &CBs));
+  CBs.keyDestroyCB(Entry->Key, CBs.UserData);
+  TotalCost -= Entry->Cost;
+
+  // If the value is retained, the last release destroys it.
+  bool DestroyNow = true;
+  {
+    ValueShard &VShard = getValueShard(Entry->Value);
+    llvm::sys::ScopedLock L(VShard.Mux);
+    auto Record = VShard.Records.find(Entry->Value);
+    if (Record != VShard.Records.end()) {
+      ++Record->second.PendingDestroys;
+      DestroyNow = false;
+    }
+  }
+  if (DestroyNow)
+    ToDestroy.push_back(Entry->Value);
+
+  Shard.LRU.erase(Entry);
+}
+
+void DefaultCache::evict(CacheShard &Shard, bool All, ValueList &ToDestroy) {
+  auto I = Shard.LRU.end();
+  while (I != Shard.LRU.begin()) {
+    if (!All && TotalCost <= CostLimit)
+      return;
+    auto Victim = std::prev(I);
+    if (isRetained(Victim->Value)) {
+      I = Victim;
+      continue;
+    }
+    removeEntry(Shard, Victim, ToDestroy);
+  }
+}
+
+void DefaultCache::evictToCostLimit(unsigned FirstShard) {
+  for (unsigned i = 0; i != NumShards && TotalCost > CostLimit; ++i) {
+    CacheShard &Shard = Shards[(FirstShard + i) % NumShards];
+    ValueList ToDestroy;
+    {
+      llvm::sys::ScopedLock L(Shard.Mux);
+      evict(Shard, /*All=*/false, ToDestroy);
+    }
+    destroyValues(ToDestroy);
+  }
+}
+
+void DefaultCache::purge() {
+  for (CacheShard &Shard : Shards) {
+    ValueList ToDestroy;
+    {
+      llvm::sys::ScopedLock L(Shard.Mux);
+      evict(Shard, /*All=*/true, ToDestroy);
+    }
+    destroyValues(ToDestroy);
+  }
+}
+
 CacheImpl::ImplTy CacheImpl::create(StringRef Name, const CallBacks &CBs) {
-  return new DefaultCache(CBs);
+  auto *DCache = new DefaultCache(CBs, getDefaultCostLimit());
+  CacheRegistry &Registry = getCacheRegistry();
+  llvm::sys::ScopedLock L(Registry.Mux);
+  Registry.Caches.insert(DCache);
+  return DCache;
 }
 
 void CacheImpl::setAndRetain(void *Key, void *Value, size_t Cost) {
   DefaultCache &DCache = *static_cast<DefaultCache*>(Impl);
-  llvm::sys::ScopedLock L(DCache.Mux);
+  unsigned ShardIndex = DCache.getShardIndex(Key);
+  CacheShard &Shard = DCache.Shards[ShardIndex];
+  ValueList ToDestroy;
+  {
+    llvm::sys::ScopedLock L(Shard.Mux);
 
-  DefaultCacheKey CKey(Key, &DCache.CBs);
-  auto Entry = DCache.Entries.find(CKey);
-  if (Entry != DCache.Entries.end()) {
-    DCache.CBs.keyDestroyCB(Entry->first.Key, nullptr);
-    DCache.CBs.valueDestroyCB(Entry->second, nullptr);
-    DCache.Entries.erase(Entry);
-  }
+    DefaultCacheKey CKey(Key, &DCache.CBs);
+    auto Entry = Shard.Entries.find(CKey);
+    if (Entry != Shard.Entries.end())
+      DCache.removeEntry(Shard, Entry->second, ToDestroy);
 
-  DCache.Entries[CKey] = Value;
+    DCache.retainValue(Value);
+    Shard.LRU.push_front({Key, Value, Cost});
+    Shard.Entries[CKey] = Shard.LRU.begin();
+    DCache.TotalCost += Cost;
+  }
+  DCache.destroyValues(ToDestroy);
 
-  // FIXME: Not thread-safe! It should avoid deleting the value until
-  // 'releaseValue is called on it.
+  if (DCache.TotalCost > DCache.CostLimit)
+    DCache.evictToCostLimit(ShardIndex);
 }
 
 bool CacheImpl::getAndRetain(const void *Key, void **Value_out) {
   DefaultCache &DCache = *static_cast<DefaultCache*>(Impl);
-  llvm::sys::ScopedLock L(DCache.Mux);
+  CacheShard &Shard = DCache.Shards[DCache.getShardIndex(Key)];
+  llvm::sys::ScopedLock L(Shard.Mux);
 
   DefaultCacheKey CKey(const_cast<void*>(Key), &DCache.CBs);
-  auto Entry = DCache.Entries.find(CKey);
-  if (Entry != DCache.Entries.end()) {
-    // FIXME: Not thread-safe! It should avoid deleting the value until
-    // 'releaseValue is called on it.
-    *Value_out = Entry->second;
-    return true;
-  }
-  return false;
+  auto Entry = Shard.Entries.find(CKey);
+  if (Entry == Shard.Entries.end())
+    return false;
+
+  Shard.LRU.splice(Shard.LRU.begin(), Shard.LRU, Entry->second);
+  DCache.retainValue(Entry->second->Value);
+  *Value_out = Entry->second->Value;
+  return true;
 }
 
 void CacheImpl::releaseValue(void *Value) {
-  // FIXME: Implementation.
+  static_cast<DefaultCache*>(Impl)->releaseValue(Value);
 }
 
 bool CacheImpl::remove(const void *Key) {
   DefaultCache &DCache = *static_cast<DefaultCache*>(Impl);
-  llvm::sys::ScopedLock L(DCache.Mux);
+  CacheShard &Shard = DCache.Shards[DCache.getShardIndex(Key)];
+  ValueList ToDestroy;
+  {
+    llvm::sys::ScopedLock L(Shard.Mux);
 
-  DefaultCacheKey CKey(const_cast<void*>(Key), &DCache.CBs);
-  auto Entry = DCache.Entries.find(CKey);
-  if (Entry != DCache.Entries.end()) {
-    DCache.CBs.keyDestroyCB(Entry->first.Key, nullptr);
-    DCache.CBs.valueDestroyCB(Entry->second, nullptr);
-    DCache.Entries.erase(Entry);
-    return true;
+    DefaultCacheKey CKey(const_cast<void*>(Key), &DCache.CBs);
+    auto Entry = Shard.Entries.find(CKey);
+    if (Entry == Shard.Entries.end())
+      return false;
+    DCache.removeEntry(Shard, Entry->second, ToDestroy);
   }
-  return false;
+  DCache.destroyValues(ToDestroy);
+  return true;
 }
 
 void CacheImpl::removeAll() {
   DefaultCache &DCache = *static_cast<DefaultCache*>(Impl);
-  llvm::sys::ScopedLock L(DCache.Mux);
-
-  for (auto Entry : DCache.Entries) {
-    DCache.CBs.keyDestroyCB(Entry.first.Key, nullptr);
-    DCache.CBs.valueDestroyCB(Entry.second, nullptr);
+  for (CacheShard &Shard : DCache.Shards) {
+    ValueList ToDestroy;
+    {
+      llvm::sys::ScopedLock L(Shard.Mux);
+      while (!Shard.LRU.empty())
+        DCache.removeEntry(Shard, Shard.LRU.begin(), ToDestroy);
+    }
+    DCache.destroyValues(ToDestroy);
   }
-  DCache.Entries.clear();
+}
+
+void CacheImpl::setCostLimit(size_t Limit) {
+  DefaultCache &DCache = *static_cast<DefaultCache*>(Impl);
+  DCache.CostLimit = Limit;
+  if (DCache.TotalCost > Limit)
+    DCache.evictToCostLimit(0);
 }
 
 void CacheImpl::destroy() {
+  auto *DCache = static_cast<DefaultCache*>(Impl);
+  {
+    CacheRegistry &Registry = getCacheRegistry();
+    llvm::sys::ScopedLock L(Registry.Mux);
+    Registry.Caches.erase(DCache);
+  }
   removeAll();
-  delete static_cast<DefaultCache*>(Impl);
+  delete DCache;
+}
+
+void swift::sys::purgeCachesForMemoryPressure() {
+  CacheRegistry &Registry = getCacheRegistry();
+  llvm::sys::ScopedLock L(Registry.Mux);
+  for (DefaultCache *DCache : Registry.Caches)
+    DCache->purge();
 }
 
 #endif // finish default implementation
@@ -88,6 +88,9 @@ static DemanglerPrinter &operator<<(DemanglerPrinter &printer,
 }
 
 Node::~Node() {
+  if (Children != InlineChildren)
+    delete[] Children;
+
   switch (NodePayloadKind) {
   case PayloadKind::None: return;
   case PayloadKind::Index: return;
@@ -96,6 +99,17 @@ Node::~Node() {
   unreachable("bad payload kind");
 }
 
+void Node::growChildren() {
+  uint32_t NewCapacity = ChildCapacity * 2;
+  NodePointer *NewChildren = new NodePointer[NewCapacity];
+  for (uint32_t i = 0; i != NumChildren; ++i)
+    NewChildren[i] = std::move(Children[i]);
+  if (Children != InlineChildren)
+    delete[] Children;
+  Children = NewChildren;
+  ChildCapacity = NewCapacity;
+}
+
 namespace {
   struct FindPtr {
     FindPtr(Node *v) : Target(v) {}
@@ -14,11 +14,18 @@
 
 #include "llvm/Config/config.h"
 #include "llvm/Support/Program.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cstdio>
+#include <vector>
 
 #if LLVM_ON_UNIX
 #if HAVE_UNISTD_H
 #include <unistd.h>
 #endif
+#include <cerrno>
+#include <sys/types.h>
+#include <sys/wait.h>
 #endif
 
 int swift::ExecuteInPlace(const char *Program, const char **args,
@@ -39,3 +46,64 @@ int swift::ExecuteInPlace(const char *Program, const char **args,
   return result;
 #endif
 }
+
+bool swift::runShardsInWorkerProcesses(
+    unsigned numShards, llvm::function_ref<void(unsigned)> body) {
+#if LLVM_ON_UNIX && !defined(__CYGWIN__)
+  if (numShards > 1) {
+    // Don't let the workers inherit output which is still buffered.
+    llvm::outs().flush();
+    llvm::errs().flush();
+    fflush(nullptr);
+
+    struct Worker {
+      pid_t Pid = -1;
+      FILE *Output = nullptr;
+    };
+    std::vector<Worker> workers(numShards);
+    for (unsigned shard = 0; shard != numShards; ++shard) {
+      Worker &worker = workers[shard];
+      worker.Output = tmpfile();
+      if (worker.Output)
+        worker.Pid = fork();
+
+      if (worker.Pid == 0) {
+        dup2(fileno(worker.Output), STDERR_FILENO);
+        body(shard);
+        llvm::errs().flush();
+        _exit(0);
+      }
+
+      if (worker.Pid < 0) {
+        if (worker.Output)
+          fclose(worker.Output);
+        worker.Output = nullptr;
+        body(shard);
+      }
+    }
+
+    bool succeeded = true;
+    for (Worker &worker : workers) {
+      if (worker.Pid < 0)
+        continue;
+
+      int status = 0;
+      while (waitpid(worker.Pid, &status, 0) < 0 && errno == EINTR) {}
+      if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        succeeded = false;
+
+      rewind(worker.Output);
+      char buffer[4096];
+      size_t size;
+      while ((size = fread(buffer, 1, sizeof(buffer), worker.Output)) > 0)
+        llvm::errs().write(buffer, size);
+      fclose(worker.Output);
+    }
+    return succeeded;
+  }
+#endif
+
+  for (unsigned shard = 0; shard != numShards; ++shard)
+    body(shard);
+  return true;
+}
@@ -0,0 +1,123 @@
+//===--- Trace.cpp - Timeline of a compilation ----------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Basic/Trace.h"
+#include "llvm/Support/Compiler.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/Mutex.h"
+#include "llvm/Support/raw_ostream.h"
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+using namespace swift;
+
+bool TraceScope::TracingEnabled = false;
+
+namespace {
+
+/// A complete ("X") event of the Chrome trace event format.
+struct TraceEvent {
+  const char *Category;
+  std::string Name;
+  unsigned Thread;
+  uint64_t StartTime;
+  uint64_t Duration;
+};
+
+struct TraceLog {
+  llvm::sys::Mutex Lock;
+  std::vector<TraceEvent> Events;
+  std::chrono::steady_clock::time_point Origin =
+    std::chrono::steady_clock::now();
+  std::atomic<unsigned> NextThread{0};
+};
+
+} // end anonymous namespace
+
+static TraceLog &getTraceLog() {
+  static TraceLog Log;
+  return Log;
+}
+
+/// Returns the microseconds since tracing was enabled.
+static uint64_t getCurrentTime() {
+  auto Elapsed = std::chrono::steady_clock::now() - getTraceLog().Origin;
+  return std::chrono::duration_cast<std::chrono::microseconds>(Elapsed)
+    .count();
+}
+
+/// Returns a small number identifying the current thread in the trace.
+static unsigned getCurrentThread() {
+  static LLVM_THREAD_LOCAL unsigned Thread = 0;
+  if (!Thread)
+    Thread = ++getTraceLog().NextThread;
+  return Thread;
+}
+
+void TraceScope::enableTracing() {
+  // Start the clock, and make the calling thread the first one in the trace.
+  getTraceLog();
+  getCurrentThread();
+  TracingEnabled = true;
+}
+
+void TraceScope::begin(const char *category, std::string name) {
+  Category = category;
+  Name = std::move(name);
+  StartTime = getCurrentTime();
+}
+
+void TraceScope::end() {
+  uint64_t EndTime = getCurrentTime();
+  unsigned Thread = getCurrentThread();
+  TraceLog &Log = getTraceLog();
+  llvm::sys::ScopedLock Locked(Log.Lock);
+  Log.Events.push_back({Category, std::move(Name), Thread, StartTime,
+                        EndTime - StartTime});
+}
+
+static void writeEscaped(raw_ostream &OS, StringRef S) {
+  for (char C : S) {
+    switch (C) {
+    case '"': OS << "\\\""; break;
+    case '\\': OS << "\\\\"; break;
+    case '\n': OS << "\\n"; break;
+    case '\t': OS << "\\t"; break;
+    default:
+      if (static_cast<unsigned char>(C) < 0x20)
+        OS << llvm::format("\\u%04x", static_cast<unsigned>(C));
+      else
+        OS << C;
+      break;
+    }
+  }
+}
+
+void TraceScope::writeTrace(raw_ostream &OS) {
+  TraceLog &Log = getTraceLog();
+  llvm::sys::ScopedLock Locked(Log.Lock);
+
+  OS << "{\"traceEvents\":[\n";
+  for (unsigned i = 0, e = Log.Events.size(); i != e; ++i) {
+    const TraceEvent &Event = Log.Events[i];
+    OS << "{\"name\":\"";
+    writeEscaped(OS, Event.Name);
+    OS << "\",\"cat\":\"" << Event.Category << "\",\"ph\":\"X\""
+       << ",\"ts\":" << Event.StartTime << ",\"dur\":" << Event.Duration
+       << ",\"pid\":1,\"tid\":" << Event.Thread << "}";
+    if (i + 1 != e)
+      OS << ',';
+    OS << '\n';
+  }
+  OS << "],\"displayTimeUnit\":\"ms\"}\n";
+}
@@ -57,6 +57,7 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/CrashRecoveryContext.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
 #include <algorithm>
 #include <memory>
@@ -482,6 +483,16 @@ getNormalInvocationArguments(std::vector<std::string> &invocationArgStrs,
 
     invocationArgStrs.push_back("-fapinotes-cache-path=");
     invocationArgStrs.back().append(moduleCachePath);
+
+    // The lookup tables built for each Clang module are stored in the cached
+    // module itself, so once a module has been validated in this build, other
+    // jobs can load it without checking its inputs again.
+    if (importerOpts.BuildSessionTimestamp) {
+      invocationArgStrs.push_back("-fbuild-session-timestamp=" +
+                                  llvm::utostr(
+                                    importerOpts.BuildSessionTimestamp));
+      invocationArgStrs.push_back("-fmodules-validate-once-per-build-session");
+    }
   }
 
   if (importerOpts.DetailedPreprocessingRecord) {
@@ -494,6 +505,12 @@ getNormalInvocationArguments(std::vector<std::string> &invocationArgStrs,
       "-Xclang", "-fmodule-format=obj",
     });
   }
+
+  // The bridging header was precompiled by an earlier job of this build.
+  if (!importerOpts.BridgingHeaderPCH.empty()) {
+    invocationArgStrs.push_back("-include-pch");
+    invocationArgStrs.push_back(importerOpts.BridgingHeaderPCH);
+  }
 }
 
 static void
@@ -709,6 +726,13 @@ ClangImporter::create(ASTContext &ctx,
   if (!canBegin)
     return nullptr; // there was an error related to the compiler arguments.
 
+  // The precompiled bridging header is loaded by BeginSourceFile, before the
+  // ASTReaderCallbacks below can record it.
+  if (!importerOpts.BridgingHeaderPCH.empty()) {
+    importer->addDependency(importerOpts.BridgingHeaderPCH);
+    importer->Impl.BridgingHeaderIsPCH = true;
+  }
+
   clang::Preprocessor &clangPP = instance.getPreprocessor();
   clangPP.enableIncrementalProcessing();
 
@@ -730,9 +754,29 @@ ClangImporter::create(ASTContext &ctx,
   clangPP.EnterMainSourceFile();
   importer->Impl.Parser->Initialize();
 
+  // Loading the precompiled bridging header made its imports visible without
+  // going through HeaderImportCallbacks. Remember them, so that they can be
+  // exported once the bridging header is imported.
+  if (importer->Impl.BridgingHeaderIsPCH) {
+    auto &moduleMap = clangPP.getHeaderSearchInfo().getModuleMap();
+    SmallVector<const clang::Module *, 16> worklist;
+    for (auto I = moduleMap.module_begin(), E = moduleMap.module_end();
+         I != E; ++I)
+      worklist.push_back(I->second);
+    while (!worklist.empty()) {
+      const clang::Module *M = worklist.pop_back_val();
+      if (ClangImporter::isModuleImported(M)) {
+        importer->Impl.BridgingPCHImports.push_back(M);
+        continue;
+      }
+      worklist.append(M->submodule_begin(), M->submodule_end());
+    }
+  }
+
   importer->Impl.nameImporter.reset(new NameImporter(
       importer->Impl.SwiftContext, importer->Impl.platformAvailability,
-      importer->Impl.getClangSema(), importer->Impl.InferImportAsMember));
+      importer->Impl.getClangSema(), importer->Impl.InferImportAsMember,
+      &importer->Impl.getLookupTables()));
 
   // Prefer frameworks over plain headers.
   // We add search paths here instead of when building the initial invocation
@@ -1059,6 +1103,17 @@ bool ClangImporter::importBridgingHeader(StringRef header, Module *adapter,
     return true;
   }
 
+  // The imports of a precompiled bridging header were loaded with it. Its
+  // declarations are too, so the #import below does not parse them again.
+  if (Impl.BridgingHeaderIsPCH) {
+    for (auto *M : Impl.BridgingPCHImports) {
+      Module *nativeImported =
+        Impl.finishLoadingClangModule(*this, M, /*adapter=*/true);
+      Impl.ImportedHeaderExports.push_back({ /*filter=*/{}, nativeImported });
+    }
+    Impl.BridgingPCHImports.clear();
+  }
+
   llvm::SmallString<128> importLine{"#import \""};
   importLine += header;
   importLine += "\"\n";
@@ -1119,6 +1174,68 @@ std::string ClangImporter::getBridgingHeaderContents(StringRef headerPath,
   return result;
 }
 
+bool ClangImporter::emitBridgingPCH(StringRef headerPath,
+                                    StringRef outputPCHPath) {
+  // Write to a temporary file first, so that jobs reading the PCH never see
+  // a partial one.
+  llvm::SmallString<128> tmpPath;
+  if (llvm::sys::fs::createUniqueFile(outputPCHPath + "-%%%%%%%%", tmpPath)) {
+    Impl.SwiftContext.Diags.diagnose({}, diag::bridging_header_pch_error,
+                                     outputPCHPath, headerPath);
+    return true;
+  }
+
+  llvm::IntrusiveRefCntPtr<clang::CompilerInvocation> invocation{
+    new clang::CompilerInvocation(*Impl.Invocation)
+  };
+  invocation->getFrontendOpts().DisableFree = false;
+  invocation->getFrontendOpts().Inputs.clear();
+  invocation->getFrontendOpts().Inputs.push_back(
+      clang::FrontendInputFile(headerPath, clang::IK_ObjC));
+  invocation->getFrontendOpts().OutputFile = tmpPath.str();
+
+  invocation->getPreprocessorOpts().resetNonModularOptions();
+
+  clang::CompilerInstance emitInstance(
+    Impl.Instance->getPCHContainerOperations());
+  emitInstance.setInvocation(&*invocation);
+  emitInstance.createDiagnostics(&Impl.Instance->getDiagnosticClient(),
+                                 /*ShouldOwnClient=*/false);
+
+  clang::FileManager &fileManager = Impl.Instance->getFileManager();
+  emitInstance.setFileManager(&fileManager);
+  emitInstance.createSourceManager(fileManager);
+  emitInstance.setTarget(&Impl.Instance->getTarget());
+
+  clang::GeneratePCHAction action;
+  emitInstance.ExecuteAction(action);
+  if (emitInstance.getDiagnostics().hasErrorOccurred()) {
+    llvm::sys::fs::remove(tmpPath);
+    Impl.SwiftContext.Diags.diagnose({}, diag::bridging_header_pch_error,
+                                     outputPCHPath, headerPath);
+    return true;
+  }
+
+  // Keep an identical PCH, so that the jobs depending on it aren't rerun.
+  {
+    auto newPCH = llvm::MemoryBuffer::getFile(tmpPath);
+    auto oldPCH = llvm::MemoryBuffer::getFile(outputPCHPath);
+    if (newPCH && oldPCH &&
+        newPCH.get()->getBuffer() == oldPCH.get()->getBuffer()) {
+      llvm::sys::fs::remove(tmpPath);
+      return false;
+    }
+  }
+
+  if (llvm::sys::fs::rename(tmpPath, outputPCHPath)) {
+    llvm::sys::fs::remove(tmpPath);
+    Impl.SwiftContext.Diags.diagnose({}, diag::bridging_header_pch_error,
+                                     outputPCHPath, headerPath);
+    return true;
+  }
+  return false;
+}
+
 void ClangImporter::collectSubModuleNames(
     ArrayRef<std::pair<Identifier, SourceLoc>> path,
     std::vector<std::string> &names) {
@@ -2638,9 +2755,16 @@ void ClangImporter::getMangledName(raw_ostream &os,
 
 SwiftLookupTable *ClangImporter::Implementation::findLookupTable(
                     const clang::Module *clangModule) {
-  // If the Clang module is null, use the bridging header lookup table.
-  if (!clangModule)
+  // If the Clang module is null, use the bridging header lookup table. A
+  // precompiled bridging header brings its own table.
+  if (!clangModule) {
+    if (BridgingHeaderIsPCH) {
+      auto known = LookupTables.find("");
+      if (known != LookupTables.end())
+        return known->second.get();
+    }
     return &BridgingHeaderLookupTable;
+  }
 
   // Submodules share lookup tables with their parents.
   if (clangModule->isSubModule())
@@ -3481,10 +3481,14 @@ namespace {
 
     /// Import members of the given Objective-C container and add them to the
     /// list of corresponding Swift members.
+    ///
+    /// If \p name is not empty, only the members with that base name are
+    /// imported.
     void importObjCMembers(const clang::ObjCContainerDecl *decl,
                            DeclContext *swiftContext,
                            llvm::SmallPtrSet<Decl *, 4> &knownMembers,
-                           SmallVectorImpl<Decl *> &members);
+                           SmallVectorImpl<Decl *> &members,
+                           Identifier name = Identifier());
 
     /// \brief Import the members of all of the protocols to which the given
     /// Objective-C class, category, or extension explicitly conforms into
@@ -3497,11 +3501,15 @@ namespace {
     /// it may still be necessary when the protocol's instance methods become
     /// class methods on a root class (e.g. NSObject-the-protocol's instance
     /// methods become class methods on NSObject).
+    ///
+    /// If \p name is not empty, only the members with that base name are
+    /// imported.
     void importMirroredProtocolMembers(const clang::ObjCContainerDecl *decl,
                                        DeclContext *dc,
                                        ArrayRef<ProtocolDecl *> protocols,
                                        SmallVectorImpl<Decl *> &members,
-                                       ASTContext &Ctx);
+                                       ASTContext &Ctx,
+                                       Identifier name = Identifier());
 
     /// \brief Import constructors from our superclasses (and their
     /// categories/extensions), effectively "inheriting" constructors.
@@ -5934,12 +5942,23 @@ Optional<GenericParamList *> SwiftDeclConverter::importObjCGenericParams(
 void SwiftDeclConverter::importObjCMembers(
     const clang::ObjCContainerDecl *decl, DeclContext *swiftContext,
     llvm::SmallPtrSet<Decl *, 4> &knownMembers,
-    SmallVectorImpl<Decl *> &members) {
+    SmallVectorImpl<Decl *> &members, Identifier name) {
   for (auto m = decl->decls_begin(), mEnd = decl->decls_end(); m != mEnd; ++m) {
     auto nd = dyn_cast<clang::NamedDecl>(*m);
     if (!nd || nd != nd->getCanonicalDecl())
       continue;
 
+    // Naming the member is much cheaper than importing it.
+    if (!name.empty()) {
+      importer::ImportNameOptions options;
+      if (useSwift2Name)
+        options |= importer::ImportNameFlags::Swift2Name;
+      auto importedName = Impl.importFullName(nd, options);
+      if (!importedName ||
+          importedName.Imported.getBaseName() != name)
+        continue;
+    }
+
     auto member = Impl.importDecl(nd, useSwift2Name);
     if (!member)
       continue;
@@ -5965,7 +5984,7 @@ void SwiftDeclConverter::importObjCMembers(
 void SwiftDeclConverter::importMirroredProtocolMembers(
     const clang::ObjCContainerDecl *decl, DeclContext *dc,
     ArrayRef<ProtocolDecl *> protocols, SmallVectorImpl<Decl *> &members,
-    ASTContext &Ctx) {
+    ASTContext &Ctx, Identifier name) {
   assert(dc);
   const clang::ObjCInterfaceDecl *interfaceDecl = nullptr;
   const ClangModuleUnit *declModule;
@@ -6003,6 +6022,12 @@ void SwiftDeclConverter::importMirroredProtocolMembers(
       if (member->getAttrs().isUnavailableInCurrentSwift())
         continue;
 
+      if (!name.empty()) {
+        auto value = dyn_cast<ValueDecl>(member);
+        if (!value || value->getName() != name)
+          continue;
+      }
+
       if (auto prop = dyn_cast<VarDecl>(member)) {
         auto objcProp =
             dyn_cast_or_null<clang::ObjCPropertyDecl>(prop->getClangDecl());
@@ -7287,6 +7312,60 @@ ClangImporter::Implementation::loadAllMembers(Decl *D, uint64_t extra) {
 
 }
 
+Optional<TinyPtrVector<ValueDecl *>>
+ClangImporter::Implementation::loadNamedMembers(Decl *D, Identifier N,
+                                                uint64_t extra) {
+  assert(D);
+
+  // Only the members of classes and categories are imported by name. The
+  // initializers and subscripts of a class are synthesized from several Clang
+  // declarations, so they are imported with all of the other members.
+  auto objcContainer =
+    dyn_cast_or_null<clang::ObjCContainerDecl>(D->getClangDecl());
+  if (!objcContainer || isa<clang::ObjCProtocolDecl>(objcContainer))
+    return None;
+  if (N == SwiftContext.Id_init || N == SwiftContext.Id_subscript)
+    return None;
+
+  clang::PrettyStackTraceDecl trace(objcContainer, clang::SourceLocation(),
+                                    Instance->getSourceManager(),
+                                    "loading named members for");
+
+  SwiftDeclConverter converter(*this, /*useSwift2Name=*/false);
+  SwiftDeclConverter swift2Converter(*this, /*useSwift2Name=*/true);
+
+  DeclContext *DC;
+  if (auto nominal = dyn_cast<NominalTypeDecl>(D))
+    DC = nominal;
+  else
+    DC = cast<ExtensionDecl>(D);
+
+  ImportingEntityRAII Importing(*this);
+
+  SmallVector<Decl *, 4> members;
+  llvm::SmallPtrSet<Decl *, 4> knownMembers;
+  converter.importObjCMembers(objcContainer, DC, knownMembers, members, N);
+  swift2Converter.importObjCMembers(objcContainer, DC, knownMembers, members,
+                                    N);
+
+  // The protocols are left for loadAllMembers to take.
+  if (auto clangClass = dyn_cast<clang::ObjCInterfaceDecl>(objcContainer))
+    objcContainer = clangClass->getDefinition();
+  converter.importMirroredProtocolMembers(objcContainer, DC,
+                                          getImportedProtocols(D), members,
+                                          SwiftContext, N);
+
+  // The members are added to the lookup table by the caller; they are only
+  // added to the context itself once all of its members are loaded.
+  TinyPtrVector<ValueDecl *> result;
+  for (auto member : members) {
+    if (auto value = dyn_cast<ValueDecl>(member))
+      if (value->getName() == N)
+        result.push_back(value);
+  }
+  return result;
+}
+
 void ClangImporter::Implementation::loadAllConformances(
        const Decl *D, uint64_t contextData,
        SmallVectorImpl<ProtocolConformance *> &Conformances) {
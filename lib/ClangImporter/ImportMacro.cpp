@@ -16,6 +16,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "ImporterImpl.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallString.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/Expr.h"
@@ -57,9 +58,8 @@ ClangModuleUnit *ClangImporter::Implementation::getClangModuleForMacro(
 
 template <typename T = clang::Expr>
 static const T *
-parseNumericLiteral(ClangImporter::Implementation &impl,
-                    const clang::Token &tok) {
-  auto result = impl.getClangSema().ActOnNumericConstant(tok);
+parseNumericLiteral(clang::Sema &sema, const clang::Token &tok) {
+  auto result = sema.ActOnNumericConstant(tok);
   if (result.isUsable())
     return dyn_cast<T>(result.get());
   return nullptr;
@@ -71,29 +71,101 @@ static bool isInSystemModule(DeclContext *D) {
   return false;
 }
 
-static ValueDecl *
-createMacroConstant(ClangImporter::Implementation &Impl,
-                    const clang::MacroInfo *macro,
-                    Identifier name,
-                    DeclContext *dc,
-                    Type type,
-                    const clang::APValue &value,
-                    ConstantConvertKind convertKind,
-                    bool isStatic,
-                    ClangNode ClangN) {
-  Impl.ImportedMacroConstants[macro] = {value, type};
-  return Impl.createConstant(name, dc, type, value, convertKind, isStatic,
-                             ClangN);
+static bool isStringToken(const clang::Token &tok) {
+  return tok.is(clang::tok::string_literal) ||
+         tok.is(clang::tok::utf8_string_literal);
+}
+
+static bool isBinaryOperator(const clang::Token &tok) {
+  return tok.is(clang::tok::amp) ||
+         tok.is(clang::tok::pipe) ||
+         tok.is(clang::tok::ampamp) ||
+         tok.is(clang::tok::pipepipe);
+}
+
+static bool isSignToken(const clang::Token &tok) {
+  return tok.is(clang::tok::plus) || tok.is(clang::tok::minus) ||
+         tok.is(clang::tok::tilde);
+}
+
+static Optional<clang::QualType> builtinTypeForToken(const clang::Token &tok,
+    const clang::ASTContext &context) {
+  switch (tok.getKind()) {
+  case clang::tok::kw_short:
+    return clang::QualType(context.ShortTy);
+  case clang::tok::kw_long:
+    return clang::QualType(context.LongTy);
+  case clang::tok::kw___int64:
+    return clang::QualType(context.LongLongTy);
+  case clang::tok::kw___int128:
+    return clang::QualType(context.Int128Ty);
+  case clang::tok::kw_signed:
+    return clang::QualType(context.IntTy);
+  case clang::tok::kw_unsigned:
+    return clang::QualType(context.UnsignedIntTy);
+  case clang::tok::kw_void:
+    return clang::QualType(context.VoidTy);
+  case clang::tok::kw_char:
+    return clang::QualType(context.CharTy);
+  case clang::tok::kw_int:
+    return clang::QualType(context.IntTy);
+  case clang::tok::kw_float:
+    return clang::QualType(context.FloatTy);
+  case clang::tok::kw_double:
+    return clang::QualType(context.DoubleTy);
+  case clang::tok::kw_wchar_t:
+    return clang::QualType(context.WCharTy);
+  case clang::tok::kw_bool:
+    return clang::QualType(context.BoolTy);
+  case clang::tok::kw_char16_t:
+    return clang::QualType(context.Char16Ty);
+  case clang::tok::kw_char32_t:
+    return clang::QualType(context.Char32Ty);
+  default:
+    return llvm::None;
+  }
 }
 
-static ValueDecl *importNumericLiteral(ClangImporter::Implementation &Impl,
-                                       DeclContext *DC,
-                                       const clang::MacroInfo *MI,
-                                       Identifier name,
-                                       const clang::Token *signTok,
-                                       const clang::Token &tok,
-                                       const clang::MacroInfo *ClangN,
-                                       const clang::QualType *castType) {
+namespace {
+/// Evaluates the expansions of macros to the constants they are imported as,
+/// using only the Clang AST.
+class MacroConstantEvaluator {
+  clang::Sema &sema;
+
+  /// The macros being evaluated, so that macros which expand to each other
+  /// are rejected.
+  llvm::SmallPtrSet<const clang::MacroInfo *, 4> active;
+
+public:
+  explicit MacroConstantEvaluator(clang::Sema &sema) : sema(sema) {}
+
+  Optional<MacroConstant> evaluate(const clang::MacroInfo *macro) {
+    if (!active.insert(macro).second)
+      return None;
+    auto result = evaluateTokens(macro);
+    active.erase(macro);
+    return result;
+  }
+
+private:
+  Optional<MacroConstant> evaluateTokens(const clang::MacroInfo *macro);
+
+  Optional<MacroConstant>
+  evaluateNumericLiteral(const clang::Token *signTok, const clang::Token &tok,
+                         Optional<clang::QualType> castType);
+
+  Optional<MacroConstant> evaluateStringLiteral(const clang::Token &tok);
+
+  Optional<MacroConstant> evaluateBinaryOperator(const clang::Token &first,
+                                                 const clang::Token &op,
+                                                 const clang::Token &second);
+};
+}
+
+Optional<MacroConstant>
+MacroConstantEvaluator::evaluateNumericLiteral(
+    const clang::Token *signTok, const clang::Token &tok,
+    Optional<clang::QualType> castType) {
   assert(tok.getKind() == clang::tok::numeric_constant &&
          "not a numeric token");
   {
@@ -104,29 +176,16 @@ static ValueDecl *importNumericLiteral(ClangImporter::Implementation &Impl,
     llvm::SmallString<32> SpellingBuffer;
     bool Invalid = false;
     StringRef TokSpelling =
-        Impl.getClangPreprocessor().getSpelling(tok, SpellingBuffer, &Invalid);
+        sema.getPreprocessor().getSpelling(tok, SpellingBuffer, &Invalid);
     if (Invalid)
-      return nullptr;
+      return None;
     if (TokSpelling.find('_') != StringRef::npos)
-      return nullptr;
+      return None;
   }
 
-  if (const clang::Expr *parsed = parseNumericLiteral<>(Impl, tok)) {
+  if (const clang::Expr *parsed = parseNumericLiteral<>(sema, tok)) {
     auto clangTy = parsed->getType();
-    auto literalType = Impl.importType(clangTy, ImportTypeKind::Value,
-                                       isInSystemModule(DC),
-                                       /*isFullyBridgeable*/false);
-    if (!literalType)
-      return nullptr;
-
-    Type constantType;
-    if (castType) {
-      constantType = Impl.importType(*castType, ImportTypeKind::Value,
-                                     isInSystemModule(DC),
-                                     /*isFullyBridgeable*/false);
-    } else {
-      constantType = literalType;
-    }
+    auto constantType = castType ? *castType : clangTy;
 
     if (auto *integer = dyn_cast<clang::IntegerLiteral>(parsed)) {
       // Determine the value.
@@ -143,16 +202,13 @@ static ValueDecl *importNumericLiteral(ClangImporter::Implementation &Impl,
         }
       }
 
-      return createMacroConstant(Impl, MI, name, DC, constantType,
-                                 clang::APValue(value),
-                                 ConstantConvertKind::Coerce,
-                                 /*static*/ false, ClangN);
+      return MacroConstant::getNumber(clang::APValue(value), constantType);
     }
 
     if (auto *floating = dyn_cast<clang::FloatingLiteral>(parsed)) {
       // ~ doesn't make sense with floating-point literals.
       if (signTok && signTok->is(clang::tok::tilde))
-        return nullptr;
+        return None;
 
       llvm::APFloat value = floating->getValue();
 
@@ -161,151 +217,105 @@ static ValueDecl *importNumericLiteral(ClangImporter::Implementation &Impl,
         value.changeSign();
       }
 
-      return createMacroConstant(Impl, MI, name, DC, constantType,
-                                 clang::APValue(value),
-                                 ConstantConvertKind::Coerce,
-                                 /*static*/ false, ClangN);
+      return MacroConstant::getNumber(clang::APValue(value), constantType);
     }
     // TODO: Other numeric literals (complex, imaginary, etc.)
   }
-  return nullptr;
-}
-
-static bool isStringToken(const clang::Token &tok) {
-  return tok.is(clang::tok::string_literal) ||
-         tok.is(clang::tok::utf8_string_literal);
-}
-
-static bool isBinaryOperator(const clang::Token &tok) {
-  return tok.is(clang::tok::amp) ||
-         tok.is(clang::tok::pipe) ||
-         tok.is(clang::tok::ampamp) ||
-         tok.is(clang::tok::pipepipe);
+  return None;
 }
 
-// Describes the kind of string literal we're importing.
-enum class MappedStringLiteralKind {
-  CString,  // "string"
-  NSString, // @"string"
-  CFString  // CFSTR("string")
-};
-
-static ValueDecl *importStringLiteral(ClangImporter::Implementation &Impl,
-                                      DeclContext *DC,
-                                      const clang::MacroInfo *MI,
-                                      Identifier name,
-                                      const clang::Token &tok,
-                                      MappedStringLiteralKind kind,
-                                      const clang::MacroInfo *ClangN) {
-  DeclContext *dc = Impl.getClangModuleForMacro(MI);
-  if (!dc)
-    return nullptr;
-
+Optional<MacroConstant>
+MacroConstantEvaluator::evaluateStringLiteral(const clang::Token &tok) {
   assert(isStringToken(tok));
 
-  clang::ActionResult<clang::Expr*> result =
-    Impl.getClangSema().ActOnStringLiteral(tok);
+  clang::ActionResult<clang::Expr*> result = sema.ActOnStringLiteral(tok);
   if (!result.isUsable())
-    return nullptr;
+    return None;
 
   auto parsed = dyn_cast<clang::StringLiteral>(result.get());
   if (!parsed)
-    return nullptr;
-
-  Type importTy = Impl.getNamedSwiftType(Impl.getStdlibModule(), "String");
-  if (!importTy)
-    return nullptr;
+    return None;
 
-  return Impl.createConstant(name, dc, importTy, parsed->getString(),
-                             ConstantConvertKind::Coerce, /*static*/ false,
-                             ClangN);
+  return MacroConstant::getString(parsed->getString());
 }
 
-static ValueDecl *importLiteral(ClangImporter::Implementation &Impl,
-                                DeclContext *DC,
-                                const clang::MacroInfo *MI,
-                                Identifier name,
-                                const clang::Token &tok,
-                                const clang::MacroInfo *ClangN,
-                                const clang::QualType *castType = nullptr) {
-  switch (tok.getKind()) {
-  case clang::tok::numeric_constant:
-    return importNumericLiteral(Impl, DC, MI, name, /*signTok*/nullptr, tok,
-                                ClangN, castType);
-
-  case clang::tok::string_literal:
-  case clang::tok::utf8_string_literal:
-    return importStringLiteral(Impl, DC, MI, name, tok,
-                               MappedStringLiteralKind::CString, ClangN);
-
-  // TODO: char literals.
-  default:
-    return nullptr;
+Optional<MacroConstant>
+MacroConstantEvaluator::evaluateBinaryOperator(const clang::Token &first,
+                                               const clang::Token &op,
+                                               const clang::Token &second) {
+  auto firstID = first.getIdentifierInfo();
+  auto secondID = second.getIdentifierInfo();
+  if (!firstID->hasMacroDefinition() || !secondID->hasMacroDefinition())
+    return None;
+
+  auto &clangPP = sema.getPreprocessor();
+  auto firstMacroInfo = clangPP.getMacroInfo(firstID);
+  auto secondMacroInfo = clangPP.getMacroInfo(secondID);
+  if (!firstMacroInfo || !secondMacroInfo)
+    return None;
+
+  auto firstConstant = evaluate(firstMacroInfo);
+  if (!firstConstant || !firstConstant->isNumber())
+    return None;
+  auto secondConstant = evaluate(secondMacroInfo);
+  if (!secondConstant || !secondConstant->isNumber())
+    return None;
+
+  auto firstValue = firstConstant->Value;
+  auto secondValue = secondConstant->Value;
+  if (!firstValue.isInt() || !secondValue.isInt()) {
+    return None;
   }
-}
-
-static ValueDecl *importNil(ClangImporter::Implementation &Impl,
-                            DeclContext *DC, Identifier name,
-                            const clang::MacroInfo *clangN) {
-  // We use a dummy type since we don't have a convenient type for 'nil'.  Any
-  // use of this will be an error anyway.
-  auto type = TupleType::getEmpty(Impl.SwiftContext);
-  return Impl.createUnavailableDecl(name, DC, type,
-                                    "use 'nil' instead of this imported macro",
-                                    /*static=*/false, clangN);
-}
 
-static bool isSignToken(const clang::Token &tok) {
-  return tok.is(clang::tok::plus) || tok.is(clang::tok::minus) ||
-         tok.is(clang::tok::tilde);
-}
-
-static Optional<clang::QualType> builtinTypeForToken(const clang::Token &tok,
-    const clang::ASTContext &context) {
-  switch (tok.getKind()) {
-  case clang::tok::kw_short:
-    return clang::QualType(context.ShortTy);
-  case clang::tok::kw_long:
-    return clang::QualType(context.LongTy);
-  case clang::tok::kw___int64:
-    return clang::QualType(context.LongLongTy);
-  case clang::tok::kw___int128:
-    return clang::QualType(context.Int128Ty);
-  case clang::tok::kw_signed:
-    return clang::QualType(context.IntTy);
-  case clang::tok::kw_unsigned:
-    return clang::QualType(context.UnsignedIntTy);
-  case clang::tok::kw_void:
-    return clang::QualType(context.VoidTy);
-  case clang::tok::kw_char:
-    return clang::QualType(context.CharTy);
-  case clang::tok::kw_int:
-    return clang::QualType(context.IntTy);
-  case clang::tok::kw_float:
-    return clang::QualType(context.FloatTy);
-  case clang::tok::kw_double:
-    return clang::QualType(context.DoubleTy);
-  case clang::tok::kw_wchar_t:
-    return clang::QualType(context.WCharTy);
-  case clang::tok::kw_bool:
-    return clang::QualType(context.BoolTy);
-  case clang::tok::kw_char16_t:
-    return clang::QualType(context.Char16Ty);
-  case clang::tok::kw_char32_t:
-    return clang::QualType(context.Char32Ty);
-  default:
-    return llvm::None;
+  auto firstInteger = firstValue.getInt();
+  auto secondInteger = secondValue.getInt();
+  auto firstBitWidth = firstInteger.getBitWidth();
+  auto secondBitWidth = secondInteger.getBitWidth();
+  auto type = firstConstant->Type;
+
+  clang::APValue value;
+  if (op.is(clang::tok::pipe)) {
+    if (firstBitWidth < secondBitWidth) {
+      firstInteger = firstInteger.extend(secondBitWidth);
+      type = secondConstant->Type;
+    } else if (secondBitWidth < firstBitWidth) {
+      secondInteger = secondInteger.extend(firstBitWidth);
+      type = firstConstant->Type;
+    }
+    firstInteger.setIsUnsigned(true);
+    secondInteger.setIsUnsigned(true);
+    value = clang::APValue(firstInteger | secondInteger);
+  } else if (op.is(clang::tok::amp)) {
+    if (firstBitWidth < secondBitWidth) {
+      firstInteger = firstInteger.extend(secondBitWidth);
+      type = secondConstant->Type;
+    } else if (secondBitWidth < firstBitWidth) {
+      secondInteger = secondInteger.extend(firstBitWidth);
+      type = firstConstant->Type;
+    }
+    firstInteger.setIsUnsigned(true);
+    secondInteger.setIsUnsigned(true);
+    value = clang::APValue(firstInteger & secondInteger);
+  } else if (op.is(clang::tok::pipepipe)) {
+    auto firstBool = firstInteger.getBoolValue();
+    auto secondBool = firstInteger.getBoolValue();
+    auto result = firstBool || secondBool;
+    value = clang::APValue(result ?
+                           llvm::APSInt::get(1) : llvm::APSInt::get(0));
+  } else if (op.is(clang::tok::ampamp)) {
+    auto firstBool = firstInteger.getBoolValue();
+    auto secondBool = firstInteger.getBoolValue();
+    auto result = firstBool && secondBool;
+    value = clang::APValue(result ?
+                           llvm::APSInt::get(1) : llvm::APSInt::get(0));
+  } else {
+    return None;
   }
+  return MacroConstant::getNumber(value, type);
 }
 
-static ValueDecl *importMacro(ClangImporter::Implementation &impl,
-                              DeclContext *DC,
-                              Identifier name,
-                              const clang::MacroInfo *macro,
-                              const clang::MacroInfo *ClangN,
-                              clang::QualType *castType = nullptr) {
-  if (name.empty()) return nullptr;
-
+Optional<MacroConstant>
+MacroConstantEvaluator::evaluateTokens(const clang::MacroInfo *macro) {
   auto numTokens = macro->getNumTokens();
   auto tokenI = macro->tokens_begin(), tokenE = macro->tokens_end();
 
@@ -320,44 +330,31 @@ static ValueDecl *importMacro(ClangImporter::Implementation &impl,
 
   // Handle tokens starting with a type cast
   bool castTypeIsId = false;
-  clang::QualType castClangType;
+  Optional<clang::QualType> castType;
   if (numTokens > 3 &&
       tokenI[0].is(clang::tok::l_paren) &&
       (tokenI[1].is(clang::tok::identifier) ||
-        impl.getClangSema().isSimpleTypeSpecifier(tokenI[1].getKind())) &&
+        sema.isSimpleTypeSpecifier(tokenI[1].getKind())) &&
       tokenI[2].is(clang::tok::r_paren)) {
-    if (castType) {
-      // this is a nested cast
-      return nullptr;
-    }
-
     if (tokenI[1].is(clang::tok::identifier)) {
       auto identifierInfo = tokenI[1].getIdentifierInfo();
       if (identifierInfo->isStr("id")) {
         castTypeIsId = true;
       }
       auto identifierName = identifierInfo->getName();
-      auto &identifier = impl.getClangASTContext().Idents.get(identifierName);
-      auto parsedType = impl.getClangSema().getTypeName(identifier,
-                                                        clang::SourceLocation(),
-                                                        /*scope*/nullptr);
-      if (parsedType) {
-        castClangType = parsedType.get();
-        castType = &castClangType;
-      } else {
-        return nullptr;
-      }
-      if (!castClangType->isBuiltinType() && !castTypeIsId) {
-        return nullptr;
+      auto &identifier = sema.getASTContext().Idents.get(identifierName);
+      auto parsedType = sema.getTypeName(identifier, clang::SourceLocation(),
+                                         /*scope*/nullptr);
+      if (!parsedType)
+        return None;
+      castType = parsedType.get();
+      if (!(*castType)->isBuiltinType() && !castTypeIsId) {
+        return None;
       }
     } else {
-      auto builtinType = builtinTypeForToken(tokenI[1],
-                                             impl.getClangASTContext());
-      if (builtinType) {
-        castType = &builtinType.getValue();
-      } else {
-        return nullptr;
-      }
+      castType = builtinTypeForToken(tokenI[1], sema.getASTContext());
+      if (!castType)
+        return None;
     }
     tokenI += 3;
     numTokens -= 3;
@@ -373,14 +370,25 @@ static ValueDecl *importMacro(ClangImporter::Implementation &impl,
 
     if (castTypeIsId && tok.is(clang::tok::numeric_constant)) {
       auto *integerLiteral =
-        parseNumericLiteral<clang::IntegerLiteral>(impl, tok);
+        parseNumericLiteral<clang::IntegerLiteral>(sema, tok);
       if (integerLiteral && integerLiteral->getValue() == 0)
-        return importNil(impl, DC, name, ClangN);
+        return MacroConstant::getNil();
     }
 
     // If it's a literal token, we might be able to translate the literal.
-    if (tok.isLiteral()) {
-      return importLiteral(impl, DC, macro, name, tok, ClangN, castType);
+    switch (tok.getKind()) {
+    case clang::tok::numeric_constant:
+      return evaluateNumericLiteral(/*signTok*/nullptr, tok, castType);
+
+    case clang::tok::string_literal:
+    case clang::tok::utf8_string_literal:
+      return evaluateStringLiteral(tok);
+
+    // TODO: char literals.
+    default:
+      if (tok.isLiteral())
+        return None;
+      break;
     }
 
     if (tok.is(clang::tok::identifier)) {
@@ -394,16 +402,15 @@ static ValueDecl *importMacro(ClangImporter::Implementation &impl,
 #include "MacroTable.def"
           .Default(false);
         if (isNilMacro)
-          return importNil(impl, DC, name, ClangN);
+          return MacroConstant::getNil();
 
-        auto macroID = impl.getClangPreprocessor().getMacroInfo(clangID);
-        if (macroID && macroID != macro)
-          return importMacro(impl, DC, name, macroID, ClangN);
+        if (auto macroID = sema.getPreprocessor().getMacroInfo(clangID))
+          return evaluate(macroID);
       }
 
       // FIXME: If the identifier refers to a declaration, alias it?
     }
-    return nullptr;
+    return None;
   }
   case 2: {
     // Check for a two-token expansion of the form +<number> or -<number>.
@@ -416,13 +423,11 @@ static ValueDecl *importMacro(ClangImporter::Implementation &impl,
     clang::Token const &second = tokenI[1];
 
     if (isSignToken(first) && second.is(clang::tok::numeric_constant))
-      return importNumericLiteral(impl, DC, macro, name, &first, second, ClangN,
-                                  castType);
+      return evaluateNumericLiteral(&first, second, castType);
 
     // We also allow @"string".
     if (first.is(clang::tok::at) && isStringToken(second))
-      return importStringLiteral(impl, DC, macro, name, second,
-                                 MappedStringLiteralKind::NSString, ClangN);
+      return evaluateStringLiteral(second);
 
     break;
   }
@@ -433,110 +438,21 @@ static ValueDecl *importMacro(ClangImporter::Implementation &impl,
     if (tokenI[0].is(clang::tok::numeric_constant) &&
         tokenI[1].is(clang::tok::lessless) &&
         tokenI[2].is(clang::tok::numeric_constant)) {
-      auto *base = parseNumericLiteral<clang::IntegerLiteral>(impl, tokenI[0]);
-      auto *shift = parseNumericLiteral<clang::IntegerLiteral>(impl, tokenI[2]);
+      auto *base = parseNumericLiteral<clang::IntegerLiteral>(sema, tokenI[0]);
+      auto *shift = parseNumericLiteral<clang::IntegerLiteral>(sema, tokenI[2]);
       if (!base || !shift)
-        return nullptr;
+        return None;
 
       auto clangTy = base->getType();
-      auto type = impl.importType(clangTy, ImportTypeKind::Value,
-                                  isInSystemModule(DC),
-                                  /*isFullyBridgeable*/false);
-      if (!type)
-        return nullptr;
-
       llvm::APSInt value{ base->getValue() << shift->getValue(),
                           clangTy->isUnsignedIntegerType() };
-      return createMacroConstant(impl, macro, name, DC, type,
-                                 clang::APValue(value),
-                                 ConstantConvertKind::Coerce, /*static=*/false,
-                                 ClangN);
+      return MacroConstant::getNumber(clang::APValue(value), clangTy);
     // Check for an expression of the form (FLAG1 | FLAG2), (FLAG1 & FLAG2),
     // (FLAG1 || FLAG2), or (FLAG1 || FLAG2)
     } else if (tokenI[0].is(clang::tok::identifier) &&
                isBinaryOperator(tokenI[1]) &&
                tokenI[2].is(clang::tok::identifier)) {
-      auto firstID = tokenI[0].getIdentifierInfo();
-      auto secondID = tokenI[2].getIdentifierInfo();
-
-      if (firstID->hasMacroDefinition() && secondID->hasMacroDefinition()) {
-        auto firstMacroInfo = impl.getClangPreprocessor().getMacroInfo(firstID);
-        auto secondMacroInfo = impl.getClangPreprocessor().getMacroInfo(
-                                                                      secondID);
-        auto firstIdentifier = importMacroName(firstID, firstMacroInfo,
-                                               impl.getClangASTContext(),
-                                               impl.SwiftContext);
-        auto secondIdentifier = importMacroName(secondID, secondMacroInfo,
-                                               impl.getClangASTContext(),
-                                               impl.SwiftContext);
-        impl.importMacro(firstIdentifier, firstMacroInfo);
-        impl.importMacro(secondIdentifier, secondMacroInfo);
-        auto firstIterator = impl.ImportedMacroConstants.find(firstMacroInfo);
-        if (firstIterator == impl.ImportedMacroConstants.end()) {
-          return nullptr;
-        }
-        auto secondIterator = impl.ImportedMacroConstants.find(secondMacroInfo);
-        if (secondIterator == impl.ImportedMacroConstants.end()) {
-          return nullptr;
-        }
-
-        auto firstConstant = firstIterator->second;
-        auto secondConstant = secondIterator->second;
-        auto firstValue = firstConstant.first;
-        auto secondValue = secondConstant.first;
-        if (!firstValue.isInt() || !secondValue.isInt()) {
-          return nullptr;
-        }
-
-        auto firstInteger = firstValue.getInt();
-        auto secondInteger = secondValue.getInt();
-        auto firstBitWidth = firstInteger.getBitWidth();
-        auto secondBitWidth = secondInteger.getBitWidth();
-        auto type = firstConstant.second;
-
-        clang::APValue value;
-        if (tokenI[1].is(clang::tok::pipe)) {
-          if (firstBitWidth < secondBitWidth) {
-            firstInteger = firstInteger.extend(secondBitWidth);
-            type = secondConstant.second;
-          } else if (secondBitWidth < firstBitWidth) {
-            secondInteger = secondInteger.extend(firstBitWidth);
-            type = firstConstant.second;
-          }
-          firstInteger.setIsUnsigned(true);
-          secondInteger.setIsUnsigned(true);
-          value = clang::APValue(firstInteger | secondInteger);
-        } else if (tokenI[1].is(clang::tok::amp)) {
-          if (firstBitWidth < secondBitWidth) {
-            firstInteger = firstInteger.extend(secondBitWidth);
-            type = secondConstant.second;
-          } else if (secondBitWidth < firstBitWidth) {
-            secondInteger = secondInteger.extend(firstBitWidth);
-            type = firstConstant.second;
-          }
-          firstInteger.setIsUnsigned(true);
-          secondInteger.setIsUnsigned(true);
-          value = clang::APValue(firstInteger & secondInteger);
-        } else if (tokenI[1].is(clang::tok::pipepipe)) {
-          auto firstBool = firstInteger.getBoolValue();
-          auto secondBool = firstInteger.getBoolValue();
-          auto result = firstBool || secondBool;
-          value = clang::APValue(result ?
-                                 llvm::APSInt::get(1) : llvm::APSInt::get(0));
-        } else if (tokenI[1].is(clang::tok::ampamp)) {
-          auto firstBool = firstInteger.getBoolValue();
-          auto secondBool = firstInteger.getBoolValue();
-          auto result = firstBool && secondBool;
-          value = clang::APValue(result ?
-                                 llvm::APSInt::get(1) : llvm::APSInt::get(0));
-        } else {
-          return nullptr;
-        }
-        return createMacroConstant(impl, macro, name, DC, type,
-                                   value,
-                                   ConstantConvertKind::Coerce,
-                                   /*static=*/false, ClangN);
-      }
+      return evaluateBinaryOperator(tokenI[0], tokenI[1], tokenI[2]);
     }
     break;
   }
@@ -547,8 +463,7 @@ static ValueDecl *importMacro(ClangImporter::Implementation &impl,
         tokenI[1].is(clang::tok::l_paren) &&
         isStringToken(tokenI[2]) &&
         tokenI[3].is(clang::tok::r_paren)) {
-      return importStringLiteral(impl, DC, macro, name, tokenI[2],
-                                 MappedStringLiteralKind::CFString, ClangN);
+      return evaluateStringLiteral(tokenI[2]);
     }
     break;
   }
@@ -561,17 +476,91 @@ static ValueDecl *importMacro(ClangImporter::Implementation &impl,
         tokenI[3].is(clang::tok::r_paren) &&
         tokenI[4].is(clang::tok::numeric_constant)) {
       auto *integerLiteral =
-        parseNumericLiteral<clang::IntegerLiteral>(impl, tokenI[4]);
+        parseNumericLiteral<clang::IntegerLiteral>(sema, tokenI[4]);
       if (!integerLiteral || integerLiteral->getValue() != 0)
         break;
-      return importNil(impl, DC, name, ClangN);
+      return MacroConstant::getNil();
     }
     break;
   default:
     break;
   }
 
-  return nullptr;
+  return None;
+}
+
+Optional<MacroConstant>
+importer::evaluateMacroConstant(clang::Sema &sema,
+                                const clang::MacroInfo *macro) {
+  return MacroConstantEvaluator(sema).evaluate(macro);
+}
+
+Optional<MacroConstant>
+ClangImporter::Implementation::getMacroConstant(const clang::MacroInfo *macro) {
+  auto known = ImportedMacroConstants.find(macro);
+  if (known != ImportedMacroConstants.end())
+    return known->second;
+
+  // The macros of a module were evaluated when the module was built.
+  Optional<MacroConstant> constant;
+  auto table = findLookupTable(getClangSubmoduleForMacro(macro)
+                                 .getValueOr(nullptr));
+  if (!table || !table->lookupMacroConstant(macro, getClangASTContext(),
+                                            constant))
+    constant = evaluateMacroConstant(getClangSema(), macro);
+
+  ImportedMacroConstants[macro] = constant;
+  return constant;
+}
+
+static ValueDecl *importNil(ClangImporter::Implementation &Impl,
+                            DeclContext *DC, Identifier name,
+                            const clang::MacroInfo *clangN) {
+  // We use a dummy type since we don't have a convenient type for 'nil'.  Any
+  // use of this will be an error anyway.
+  auto type = TupleType::getEmpty(Impl.SwiftContext);
+  return Impl.createUnavailableDecl(name, DC, type,
+                                    "use 'nil' instead of this imported macro",
+                                    /*static=*/false, clangN);
+}
+
+static ValueDecl *importMacro(ClangImporter::Implementation &impl,
+                              DeclContext *DC,
+                              Identifier name,
+                              const clang::MacroInfo *macro) {
+  if (name.empty()) return nullptr;
+
+  auto constant = impl.getMacroConstant(macro);
+  if (!constant)
+    return nullptr;
+
+  switch (constant->getKind()) {
+  case MacroConstant::Kind::Number: {
+    auto type = impl.importType(constant->Type, ImportTypeKind::Value,
+                                isInSystemModule(DC),
+                                /*isFullyBridgeable*/false);
+    if (!type)
+      return nullptr;
+
+    return impl.createConstant(name, DC, type, constant->Value,
+                               ConstantConvertKind::Coerce, /*static*/ false,
+                               macro);
+  }
+
+  case MacroConstant::Kind::String: {
+    Type importTy = impl.getNamedSwiftType(impl.getStdlibModule(), "String");
+    if (!importTy)
+      return nullptr;
+
+    return impl.createConstant(name, DC, importTy,
+                               impl.SwiftContext.AllocateCopy(constant->String),
+                               ConstantConvertKind::Coerce, /*static*/ false,
+                               macro);
+  }
+
+  case MacroConstant::Kind::Nil:
+    return importNil(impl, DC, name, macro);
+  }
 }
 
 ValueDecl *ClangImporter::Implementation::importMacro(Identifier name,
@@ -608,7 +597,7 @@ ValueDecl *ClangImporter::Implementation::importMacro(Identifier name,
   if (!DC)
     return nullptr;
 
-  auto valueDecl = ::importMacro(*this, DC, name, macro, macro);
+  auto valueDecl = ::importMacro(*this, DC, name, macro);
   ImportedMacros[name].push_back({macro, valueDecl});
   return valueDecl;
 }
@@ -44,6 +44,8 @@
 #define DEBUG_TYPE "Import Name"
 STATISTIC(ImportNameNumCacheHits, "# of times the import name cache was hit");
 STATISTIC(ImportNameNumCacheMisses, "# of times the import name cache was missed");
+STATISTIC(ImportNameNumPersistedHits,
+          "# of names found in the lookup tables of modules");
 
 using namespace swift;
 using namespace importer;
@@ -1636,12 +1638,36 @@ Identifier importer::importMacroName(
 ImportedName NameImporter::importName(const clang::NamedDecl *decl,
                                       ImportNameOptions options) {
   CacheKeyType key(decl, options.toRaw());
-  if (importNameCache.count(key)) {
+  auto known = importNameCache.find(key);
+  if (known != importNameCache.end()) {
     ++ImportNameNumCacheHits;
-    return importNameCache[key];
+    return known->second;
   }
   ++ImportNameNumCacheMisses;
-  auto res = importNameImpl(decl, options);
+
+  ImportedName res;
+  if (lookupPersistedName(decl, options, res))
+    ++ImportNameNumPersistedHits;
+  else
+    res = importNameImpl(decl, options);
   importNameCache[key] = res;
   return res;
 }
+
+bool NameImporter::lookupPersistedName(const clang::NamedDecl *decl,
+                                       ImportNameOptions options,
+                                       ImportedName &result) {
+  if (!lookupTables || !decl->isFromASTFile())
+    return false;
+
+  // The names are stored with the lookup table of the top-level module.
+  auto module = decl->getImportedOwningModule();
+  if (!module)
+    return false;
+  auto known = lookupTables->find(module->getTopLevelModule()->Name);
+  if (known == lookupTables->end())
+    return false;
+
+  return known->second->lookupImportedName(decl, options.toRaw(), swiftCtx,
+                                           result);
+}
@@ -24,6 +24,7 @@
 #include "swift/AST/Decl.h"
 #include "swift/AST/ForeignErrorConvention.h"
 #include "clang/Sema/Sema.h"
+#include "llvm/ADT/StringMap.h"
 
 // TODO: remove when we drop import name options
 #include "clang/AST/Decl.h"
@@ -176,17 +177,32 @@ class NameImporter {
   /// Cache for repeated calls
   llvm::DenseMap<CacheKeyType, ImportedName> importNameCache;
 
+  /// The lookup tables of the loaded modules, which hold the names imported
+  /// for their declarations when the modules were built. May be null.
+  const llvm::StringMap<std::unique_ptr<SwiftLookupTable>> *lookupTables;
+
 public:
   NameImporter(ASTContext &ctx, const PlatformAvailability &avail,
-               clang::Sema &cSema, bool inferIAM)
+               clang::Sema &cSema, bool inferIAM,
+               const llvm::StringMap<std::unique_ptr<SwiftLookupTable>>
+                 *tables = nullptr)
       : swiftCtx(ctx), availability(avail), clangSema(cSema),
         enumInfos(swiftCtx, clangSema.getPreprocessor()),
-        inferImportAsMember(inferIAM) {}
+        inferImportAsMember(inferIAM), lookupTables(tables) {}
 
   /// Determine the Swift name for a clang decl
   ImportedName importName(const clang::NamedDecl *decl,
                           ImportNameOptions options);
 
+  /// Invoke \p fn on each of the names imported so far.
+  void forEachImportedName(
+      llvm::function_ref<void(const clang::NamedDecl *, ImportNameOptions,
+                              const ImportedName &)> fn) const {
+    for (const auto &entry : importNameCache)
+      fn(entry.first.getPointer(), ImportNameOptions(entry.first.getInt()),
+         entry.second);
+  }
+
   ASTContext &getContext() { return swiftCtx; }
   const LangOptions &getLangOpts() const { return swiftCtx.LangOpts; }
 
@@ -246,6 +262,11 @@ private:
 
   ImportedName importNameImpl(const clang::NamedDecl *,
                               ImportNameOptions options);
+
+  /// Look for the name that was imported for a declaration from a module
+  /// when the module was built.
+  bool lookupPersistedName(const clang::NamedDecl *decl,
+                           ImportNameOptions options, ImportedName &result);
 };
 
 }
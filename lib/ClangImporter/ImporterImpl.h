@@ -29,6 +29,7 @@
 #include "swift/AST/Type.h"
 #include "swift/AST/ForeignErrorConvention.h"
 #include "swift/Basic/StringExtras.h"
+#include "clang/AST/APValue.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/DeclVisitor.h"
 #include "clang/Basic/IdentifierTable.h"
@@ -251,6 +252,61 @@ private:
   PlatformAvailability(const PlatformAvailability&) = delete;
   PlatformAvailability &operator=(const PlatformAvailability &) = delete;
 };
+
+/// The constant that the expansion of a macro evaluates to, when it has one
+/// of the forms that are imported into Swift.
+class MacroConstant {
+public:
+  enum class Kind : uint8_t {
+    /// An integer or floating-point number.
+    Number,
+    /// A string, imported as a Swift String.
+    String,
+    /// A null pointer, imported as an unavailable declaration.
+    Nil,
+  };
+
+private:
+  Kind TheKind;
+
+public:
+  /// The value of a number.
+  clang::APValue Value;
+
+  /// The Clang type of a number.
+  clang::QualType Type;
+
+  /// The contents of a string.
+  std::string String;
+
+  explicit MacroConstant(Kind kind) : TheKind(kind) {}
+
+  static MacroConstant getNumber(clang::APValue value, clang::QualType type) {
+    MacroConstant result(Kind::Number);
+    result.Value = std::move(value);
+    result.Type = type;
+    return result;
+  }
+
+  static MacroConstant getString(StringRef string) {
+    MacroConstant result(Kind::String);
+    result.String = string;
+    return result;
+  }
+
+  static MacroConstant getNil() { return MacroConstant(Kind::Nil); }
+
+  Kind getKind() const { return TheKind; }
+
+  bool isNumber() const { return TheKind == Kind::Number; }
+};
+
+/// Evaluate the expansion of the given macro to the constant it is imported
+/// as, using only the Clang AST.
+///
+/// \returns None if the macro is not imported as a constant.
+Optional<MacroConstant> evaluateMacroConstant(clang::Sema &sema,
+                                              const clang::MacroInfo *macro);
 }
 
 using LookupTableMap = llvm::StringMap<std::unique_ptr<SwiftLookupTable>>;
@@ -281,6 +337,14 @@ private:
   /// The Swift lookup table for the bridging header.
   SwiftLookupTable BridgingHeaderLookupTable;
 
+  /// Whether the bridging header was loaded from a precompiled header, in
+  /// which case its Swift lookup table is read from the PCH.
+  bool BridgingHeaderIsPCH = false;
+
+  /// The modules imported by the precompiled bridging header, which have to
+  /// be exported by the bridging header module once it is imported.
+  SmallVector<const clang::Module *, 4> BridgingPCHImports;
+
   /// The Swift lookup tables, per module.
   ///
   /// Annoyingly, we list this table early so that it gets torn down after
@@ -367,7 +431,8 @@ public:
     ImportedMacros;
 
   // Mapping from macro to value for macros that expand to constant values.
-  llvm::DenseMap<const clang::MacroInfo *, std::pair<clang::APValue, Type>>
+  // None means the macro was evaluated, but isn't imported as a constant.
+  llvm::DenseMap<const clang::MacroInfo *, Optional<importer::MacroConstant>>
     ImportedMacroConstants;
 
   /// Keeps track of active selector-based lookups, so that we don't infinitely
@@ -664,6 +729,11 @@ public:
   /// translated into Swift.
   ValueDecl *importMacro(Identifier name, clang::MacroInfo *macro);
 
+  /// Retrieve the constant that the given macro evaluates to, either from
+  /// the lookup table of its module or by evaluating it.
+  Optional<importer::MacroConstant>
+  getMacroConstant(const clang::MacroInfo *macro);
+
   /// Map a Clang identifier name to its imported Swift equivalent.
   StringRef getSwiftNameFromClangName(StringRef name);
 
@@ -1080,9 +1150,21 @@ public:
     return result;
   }
 
+  /// Retrieve the protocols to which the given declaration conforms, which
+  /// are still to be taken by loadAllMembers.
+  ArrayRef<ProtocolDecl *> getImportedProtocols(const Decl *decl) {
+    auto known = ImportedProtocols.find(decl);
+    if (known == ImportedProtocols.end())
+      return {};
+    return known->second;
+  }
+
   virtual void
   loadAllMembers(Decl *D, uint64_t unused) override;
 
+  Optional<TinyPtrVector<ValueDecl *>>
+  loadNamedMembers(Decl *D, Identifier N, uint64_t unused) override;
+
   void
   loadAllConformances(
     const Decl *D, uint64_t contextData,
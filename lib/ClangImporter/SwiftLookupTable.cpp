@@ -148,17 +148,23 @@ class SwiftLookupTableReader : public clang::ModuleFileExtensionReader {
   void *SerializedTable;
   ArrayRef<clang::serialization::DeclID> Categories;
   void *GlobalsAsMembersTable;
+  void *ImportedNamesTable;
+  void *MacroConstantsTable;
 
   SwiftLookupTableReader(clang::ModuleFileExtension *extension,
                          clang::ASTReader &reader,
                          clang::serialization::ModuleFile &moduleFile,
                          std::function<void()> onRemove, void *serializedTable,
                          ArrayRef<clang::serialization::DeclID> categories,
-                         void *globalsAsMembersTable)
+                         void *globalsAsMembersTable,
+                         void *importedNamesTable,
+                         void *macroConstantsTable)
       : ModuleFileExtensionReader(extension), Reader(reader),
         ModuleFile(moduleFile), OnRemove(onRemove),
         SerializedTable(serializedTable), Categories(categories),
-        GlobalsAsMembersTable(globalsAsMembersTable) {}
+        GlobalsAsMembersTable(globalsAsMembersTable),
+        ImportedNamesTable(importedNamesTable),
+        MacroConstantsTable(macroConstantsTable) {}
 
 public:
   /// Create a new lookup table reader for the given AST reader and stream
@@ -200,6 +206,19 @@ public:
   /// \returns true if we found anything, false otherwise.
   bool lookupGlobalsAsMembers(SwiftLookupTable::StoredContext context,
                               SmallVectorImpl<uintptr_t> &entries);
+
+  /// Retrieve the serialized name imported for the declaration with the
+  /// given ID, using the given raw ImportNameOptions.
+  ///
+  /// \returns true if we found anything, false otherwise.
+  bool lookupImportedName(clang::serialization::DeclID declID, uint8_t options,
+                          StringRef &data);
+
+  /// Retrieve the serialized constant of the macro with the given ID.
+  ///
+  /// \returns true if we found anything, false otherwise.
+  bool lookupMacroConstant(clang::serialization::MacroID macroID,
+                           StringRef &data);
 };
 }
 
@@ -888,7 +907,15 @@ namespace {
 
     /// Record that contains the mapping from contexts to the list of
     /// globals that will be injected as members into those contexts.
-    GLOBALS_AS_MEMBERS_RECORD_ID
+    GLOBALS_AS_MEMBERS_RECORD_ID,
+
+    /// Record that contains the mapping from declarations to the names that
+    /// were imported for them.
+    IMPORTED_NAMES_RECORD_ID,
+
+    /// Record that contains the mapping from macros to the constants they
+    /// were evaluated to.
+    MACRO_CONSTANTS_RECORD_ID
   };
 
   using BaseNameToEntitiesTableRecordLayout
@@ -900,6 +927,80 @@ namespace {
   using GlobalsAsMembersTableRecordLayout
     = BCRecordLayout<GLOBALS_AS_MEMBERS_RECORD_ID, BCVBR<16>, BCBlob>;
 
+  using ImportedNamesTableRecordLayout
+    = BCRecordLayout<IMPORTED_NAMES_RECORD_ID, BCVBR<16>, BCBlob>;
+
+  using MacroConstantsTableRecordLayout
+    = BCRecordLayout<MACRO_CONSTANTS_RECORD_ID, BCVBR<16>, BCBlob>;
+
+  /// The kinds of serialized macro constants; the first is for macros that
+  /// are not imported as constants.
+  enum class SerializedMacroConstantKind : uint8_t {
+    None,
+    Number,
+    String,
+    Nil,
+  };
+
+  /// The builtin types of the serialized macro constants, by index.
+  clang::CanQualType clang::ASTContext::* const MacroConstantBuiltinTypes[] = {
+    &clang::ASTContext::BoolTy,
+    &clang::ASTContext::CharTy,
+    &clang::ASTContext::WCharTy,
+    &clang::ASTContext::Char16Ty,
+    &clang::ASTContext::Char32Ty,
+    &clang::ASTContext::ShortTy,
+    &clang::ASTContext::IntTy,
+    &clang::ASTContext::LongTy,
+    &clang::ASTContext::LongLongTy,
+    &clang::ASTContext::Int128Ty,
+    &clang::ASTContext::UnsignedShortTy,
+    &clang::ASTContext::UnsignedIntTy,
+    &clang::ASTContext::UnsignedLongTy,
+    &clang::ASTContext::UnsignedLongLongTy,
+    &clang::ASTContext::UnsignedInt128Ty,
+    &clang::ASTContext::FloatTy,
+    &clang::ASTContext::DoubleTy,
+    &clang::ASTContext::LongDoubleTy,
+    &clang::ASTContext::VoidTy,
+  };
+
+  /// The floating-point semantics of the serialized macro constants, by
+  /// index.
+  const llvm::fltSemantics * const MacroConstantFloatSemantics[] = {
+    &llvm::APFloat::IEEEhalf,
+    &llvm::APFloat::IEEEsingle,
+    &llvm::APFloat::IEEEdouble,
+    &llvm::APFloat::IEEEquad,
+    &llvm::APFloat::x87DoubleExtended,
+    &llvm::APFloat::PPCDoubleDouble,
+  };
+
+  /// The key of an imported name: the declaration ID and the raw
+  /// ImportNameOptions.
+  using ImportedNameKey = std::pair<clang::serialization::DeclID, uint8_t>;
+
+  static uint32_t hashImportedNameKey(ImportedNameKey key) {
+    return (key.first << importer::NumImportNameFlags) | key.second;
+  }
+
+  /// The kinds of effective contexts of the serialized imported names.
+  enum class ImportedContextKind : uint8_t {
+    None,
+    DeclContext,
+    TypedefContext,
+  };
+
+  /// Flags of the serialized imported names.
+  enum ImportedNameFlags : uint8_t {
+    NameHasCustomName = 0x01,
+    NameDroppedVariadic = 0x02,
+    NameImportAsMember = 0x04,
+    NameIsCompoundName = 0x08,
+    NameHasSelfIndex = 0x10,
+    NameHasErrorInfo = 0x20,
+  };
+
   /// Trait used to write the on-disk hash table for the base name -> entities
   /// mapping.
   class BaseNameToEntitiesTableWriterInfo {
@@ -1063,6 +1164,391 @@ namespace {
       }
     }
   };
+
+  /// Trait used to write the on-disk hash table for the names imported for
+  /// the declarations of the module.
+  class ImportedNamesTableWriterInfo {
+  public:
+    using key_type = ImportedNameKey;
+    using key_type_ref = key_type;
+    using data_type = StringRef;
+    using data_type_ref = data_type;
+    using hash_value_type = uint32_t;
+    using offset_type = unsigned;
+
+    hash_value_type ComputeHash(key_type_ref key) {
+      return hashImportedNameKey(key);
+    }
+
+    std::pair<unsigned, unsigned> EmitKeyDataLength(raw_ostream &out,
+                                                    key_type_ref key,
+                                                    data_type_ref data) {
+      uint32_t keyLength = sizeof(clang::serialization::DeclID) + 1;
+      uint32_t dataLength = data.size();
+
+      endian::Writer<little> writer(out);
+      writer.write<uint16_t>(keyLength);
+      writer.write<uint16_t>(dataLength);
+      return { keyLength, dataLength };
+    }
+
+    void EmitKey(raw_ostream &out, key_type_ref key, unsigned len) {
+      endian::Writer<little> writer(out);
+      writer.write<uint32_t>(key.first);
+      writer.write<uint8_t>(key.second);
+    }
+
+    void EmitData(raw_ostream &out, key_type_ref key, data_type_ref data,
+                  unsigned len) {
+      out << data;
+    }
+  };
+
+  /// Trait used to write the on-disk hash table for the constants of the
+  /// macros of the module.
+  class MacroConstantsTableWriterInfo {
+  public:
+    using key_type = clang::serialization::MacroID;
+    using key_type_ref = key_type;
+    using data_type = StringRef;
+    using data_type_ref = data_type;
+    using hash_value_type = uint32_t;
+    using offset_type = unsigned;
+
+    hash_value_type ComputeHash(key_type_ref key) {
+      return key;
+    }
+
+    std::pair<unsigned, unsigned> EmitKeyDataLength(raw_ostream &out,
+                                                    key_type_ref key,
+                                                    data_type_ref data) {
+      uint32_t keyLength = sizeof(clang::serialization::MacroID);
+      uint32_t dataLength = data.size();
+
+      endian::Writer<little> writer(out);
+      writer.write<uint16_t>(keyLength);
+      writer.write<uint16_t>(dataLength);
+      return { keyLength, dataLength };
+    }
+
+    void EmitKey(raw_ostream &out, key_type_ref key, unsigned len) {
+      endian::Writer<little>(out).write<uint32_t>(key);
+    }
+
+    void EmitData(raw_ostream &out, key_type_ref key, data_type_ref data,
+                  unsigned len) {
+      out << data;
+    }
+  };
+}
+
+/// Serialize an imported name.
+///
+/// \returns false if the name cannot be serialized, because its effective
+/// context is known only by name.
+static bool writeImportedName(clang::ASTWriter &astWriter,
+                              const importer::ImportedName &name,
+                              raw_ostream &out) {
+  endian::Writer<little> writer(out);
+
+  // The effective context.
+  auto context = name.EffectiveContext;
+  if (context.getKind() == EffectiveClangContext::UnresolvedContext)
+    return false;
+
+  // The base name.
+  StringRef baseName;
+  if (!name.Imported.getBaseName().empty())
+    baseName = name.Imported.getBaseName().str();
+  writer.write<uint16_t>(baseName.size());
+  out << baseName;
+
+  // The flags and the kinds.
+  uint8_t flags = 0;
+  if (name.HasCustomName)
+    flags |= NameHasCustomName;
+  if (name.DroppedVariadic)
+    flags |= NameDroppedVariadic;
+  if (name.ImportAsMember)
+    flags |= NameImportAsMember;
+  if (name.Imported && !name.Imported.isSimpleName())
+    flags |= NameIsCompoundName;
+  if (name.SelfIndex)
+    flags |= NameHasSelfIndex;
+  if (name.ErrorInfo)
+    flags |= NameHasErrorInfo;
+  writer.write<uint8_t>(flags);
+  writer.write<uint8_t>(static_cast<uint8_t>(name.AccessorKind));
+  writer.write<uint8_t>(static_cast<uint8_t>(name.InitKind));
+
+  // The argument names.
+  if (flags & NameIsCompoundName) {
+    auto argNames = name.Imported.getArgumentNames();
+    writer.write<uint16_t>(argNames.size());
+    for (auto argName : argNames) {
+      StringRef str = argName.empty() ? StringRef() : argName.str();
+      writer.write<uint16_t>(str.size());
+      out << str;
+    }
+  }
+
+  if (name.SelfIndex)
+    writer.write<uint16_t>(*name.SelfIndex);
+
+  if (name.ErrorInfo) {
+    writer.write<uint8_t>(static_cast<uint8_t>(name.ErrorInfo->Kind));
+    writer.write<uint8_t>(static_cast<uint8_t>(name.ErrorInfo->IsOwned));
+    writer.write<uint16_t>(name.ErrorInfo->ParamIndex);
+    writer.write<uint8_t>(name.ErrorInfo->ReplaceParamWithVoid);
+  }
+
+  if (!context) {
+    writer.write<uint8_t>(static_cast<uint8_t>(ImportedContextKind::None));
+  } else if (context.getKind() == EffectiveClangContext::DeclContext) {
+    writer.write<uint8_t>(
+      static_cast<uint8_t>(ImportedContextKind::DeclContext));
+    writer.write<uint32_t>(
+      astWriter.getDeclID(cast<clang::Decl>(context.getAsDeclContext())));
+  } else {
+    writer.write<uint8_t>(
+      static_cast<uint8_t>(ImportedContextKind::TypedefContext));
+    writer.write<uint32_t>(astWriter.getDeclID(context.getTypedefName()));
+  }
+  return true;
+}
+
+/// Deserialize an imported name written by writeImportedName.
+static bool readImportedName(StringRef blob, ASTContext &ctx,
+                             clang::ASTReader &astReader,
+                             clang::serialization::ModuleFile &moduleFile,
+                             importer::ImportedName &result) {
+  auto data = reinterpret_cast<const uint8_t *>(blob.data());
+  auto readString = [&]() -> StringRef {
+    uint16_t length = endian::readNext<uint16_t, little, unaligned>(data);
+    StringRef str(reinterpret_cast<const char *>(data), length);
+    data += length;
+    return str;
+  };
+  auto readIdentifier = [&]() -> Identifier {
+    StringRef str = readString();
+    return str.empty() ? Identifier() : ctx.getIdentifier(str);
+  };
+
+  importer::ImportedName name;
+  Identifier baseName = readIdentifier();
+  uint8_t flags = endian::readNext<uint8_t, little, unaligned>(data);
+  name.HasCustomName = flags & NameHasCustomName;
+  name.DroppedVariadic = flags & NameDroppedVariadic;
+  name.ImportAsMember = flags & NameImportAsMember;
+  name.AccessorKind = static_cast<importer::ImportedAccessorKind>(
+    endian::readNext<uint8_t, little, unaligned>(data));
+  name.InitKind = static_cast<CtorInitializerKind>(
+    endian::readNext<uint8_t, little, unaligned>(data));
+
+  if (flags & NameIsCompoundName) {
+    unsigned numArgs = endian::readNext<uint16_t, little, unaligned>(data);
+    SmallVector<Identifier, 4> argNames;
+    while (numArgs--)
+      argNames.push_back(readIdentifier());
+    name.Imported = DeclName(ctx, baseName, argNames);
+  } else if (!baseName.empty()) {
+    name.Imported = DeclName(baseName);
+  }
+
+  if (flags & NameHasSelfIndex)
+    name.SelfIndex = endian::readNext<uint16_t, little, unaligned>(data);
+
+  if (flags & NameHasErrorInfo) {
+    importer::ImportedErrorInfo errorInfo;
+    errorInfo.Kind = static_cast<ForeignErrorConvention::Kind>(
+      endian::readNext<uint8_t, little, unaligned>(data));
+    errorInfo.IsOwned = static_cast<ForeignErrorConvention::IsOwned_t>(
+      endian::readNext<uint8_t, little, unaligned>(data));
+    errorInfo.ParamIndex = endian::readNext<uint16_t, little, unaligned>(data);
+    errorInfo.ReplaceParamWithVoid =
+      endian::readNext<uint8_t, little, unaligned>(data);
+    name.ErrorInfo = errorInfo;
+  }
+
+  auto contextKind = static_cast<ImportedContextKind>(
+    endian::readNext<uint8_t, little, unaligned>(data));
+  if (contextKind != ImportedContextKind::None) {
+    auto contextID = endian::readNext<uint32_t, little, unaligned>(data);
+    auto contextDecl = astReader.GetLocalDecl(moduleFile, contextID);
+    if (!contextDecl)
+      return false;
+
+    if (contextKind == ImportedContextKind::DeclContext) {
+      auto dc = dyn_cast<clang::DeclContext>(contextDecl);
+      if (!dc)
+        return false;
+      name.EffectiveContext = dc;
+    } else {
+      auto typedefName = dyn_cast<clang::TypedefNameDecl>(contextDecl);
+      if (!typedefName)
+        return false;
+      name.EffectiveContext = typedefName;
+    }
+  }
+
+  result = name;
+  return true;
+}
+
+/// Serialize the bits of an integer.
+static void writeAPInt(const llvm::APInt &value, raw_ostream &out) {
+  endian::Writer<little> writer(out);
+  writer.write<uint32_t>(value.getBitWidth());
+  writer.write<uint16_t>(value.getNumWords());
+  for (unsigned i = 0, e = value.getNumWords(); i != e; ++i)
+    writer.write<uint64_t>(value.getRawData()[i]);
+}
+
+/// Deserialize the bits of an integer written by writeAPInt.
+static llvm::APInt readAPInt(const uint8_t *&data) {
+  auto bitWidth = endian::readNext<uint32_t, little, unaligned>(data);
+  unsigned numWords = endian::readNext<uint16_t, little, unaligned>(data);
+  SmallVector<uint64_t, 2> words;
+  while (numWords--)
+    words.push_back(endian::readNext<uint64_t, little, unaligned>(data));
+  return llvm::APInt(bitWidth, words);
+}
+
+/// Serialize the constant that a macro evaluates to.
+///
+/// \returns false if the constant cannot be serialized, because of its type.
+static bool writeMacroConstant(clang::ASTWriter &astWriter,
+                               clang::ASTContext &clangCtx,
+                               const Optional<MacroConstant> &constant,
+                               raw_ostream &out) {
+  endian::Writer<little> writer(out);
+
+  if (!constant) {
+    writer.write<uint8_t>(
+      static_cast<uint8_t>(SerializedMacroConstantKind::None));
+    return true;
+  }
+
+  switch (constant->getKind()) {
+  case MacroConstant::Kind::Number: {
+    writer.write<uint8_t>(
+      static_cast<uint8_t>(SerializedMacroConstantKind::Number));
+
+    // The type, which is either a builtin type or a typedef.
+    auto type = constant->Type;
+    if (auto typedefType = dyn_cast<clang::TypedefType>(type.getTypePtr())) {
+      writer.write<uint8_t>(0xFF);
+      writer.write<uint32_t>(astWriter.getDeclID(typedefType->getDecl()));
+    } else {
+      auto builtinTypes = llvm::makeArrayRef(MacroConstantBuiltinTypes);
+      auto known = std::find_if(builtinTypes.begin(), builtinTypes.end(),
+                        [&](clang::CanQualType clang::ASTContext::*member) {
+        return clang::QualType(clangCtx.*member) == type;
+      });
+      if (known == builtinTypes.end())
+        return false;
+      writer.write<uint8_t>(known - builtinTypes.begin());
+    }
+
+    // The value.
+    const auto &value = constant->Value;
+    if (value.isInt()) {
+      writer.write<uint8_t>(0);
+      writer.write<uint8_t>(value.getInt().isUnsigned());
+      writeAPInt(value.getInt(), out);
+      return true;
+    }
+
+    if (value.isFloat()) {
+      auto semantics = llvm::makeArrayRef(MacroConstantFloatSemantics);
+      auto known = std::find(semantics.begin(), semantics.end(),
+                             &value.getFloat().getSemantics());
+      if (known == semantics.end())
+        return false;
+      writer.write<uint8_t>(1);
+      writer.write<uint8_t>(known - semantics.begin());
+      writeAPInt(value.getFloat().bitcastToAPInt(), out);
+      return true;
+    }
+
+    return false;
+  }
+
+  case MacroConstant::Kind::String:
+    writer.write<uint8_t>(
+      static_cast<uint8_t>(SerializedMacroConstantKind::String));
+    writer.write<uint32_t>(constant->String.size());
+    out << constant->String;
+    return true;
+
+  case MacroConstant::Kind::Nil:
+    writer.write<uint8_t>(
+      static_cast<uint8_t>(SerializedMacroConstantKind::Nil));
+    return true;
+  }
+}
+
+/// Deserialize the constant of a macro written by writeMacroConstant.
+static bool readMacroConstant(StringRef blob, clang::ASTContext &clangCtx,
+                              clang::ASTReader &astReader,
+                              clang::serialization::ModuleFile &moduleFile,
+                              Optional<MacroConstant> &result) {
+  auto data = reinterpret_cast<const uint8_t *>(blob.data());
+  auto kind = static_cast<SerializedMacroConstantKind>(
+    endian::readNext<uint8_t, little, unaligned>(data));
+
+  switch (kind) {
+  case SerializedMacroConstantKind::None:
+    result = None;
+    return true;
+
+  case SerializedMacroConstantKind::Number: {
+    clang::QualType type;
+    auto typeIndex = endian::readNext<uint8_t, little, unaligned>(data);
+    if (typeIndex == 0xFF) {
+      auto declID = endian::readNext<uint32_t, little, unaligned>(data);
+      auto typedefDecl = dyn_cast_or_null<clang::TypedefNameDecl>(
+                           astReader.GetLocalDecl(moduleFile, declID));
+      if (!typedefDecl)
+        return false;
+      type = clangCtx.getTypedefType(typedefDecl);
+    } else {
+      if (typeIndex >= llvm::array_lengthof(MacroConstantBuiltinTypes))
+        return false;
+      type = clangCtx.*MacroConstantBuiltinTypes[typeIndex];
+    }
+
+    clang::APValue value;
+    auto valueKind = endian::readNext<uint8_t, little, unaligned>(data);
+    if (valueKind == 0) {
+      bool isUnsigned = endian::readNext<uint8_t, little, unaligned>(data);
+      value = clang::APValue(llvm::APSInt(readAPInt(data), isUnsigned));
+    } else {
+      auto semanticsIndex = endian::readNext<uint8_t, little, unaligned>(data);
+      if (semanticsIndex >= llvm::array_lengthof(MacroConstantFloatSemantics))
+        return false;
+      value = clang::APValue(
+        llvm::APFloat(*MacroConstantFloatSemantics[semanticsIndex],
+                      readAPInt(data)));
+    }
+
+    result = MacroConstant::getNumber(std::move(value), type);
+    return true;
+  }
+
+  case SerializedMacroConstantKind::String: {
+    auto length = endian::readNext<uint32_t, little, unaligned>(data);
+    result = MacroConstant::getString(
+               StringRef(reinterpret_cast<const char *>(data), length));
+    return true;
+  }
+
+  case SerializedMacroConstantKind::Nil:
+    result = MacroConstant::getNil();
+    return true;
+  }
+
+  return false;
 }
 
 void SwiftLookupTableWriter::writeExtensionContents(
@@ -1144,6 +1630,102 @@ void SwiftLookupTableWriter::writeExtensionContents(
     GlobalsAsMembersTableRecordLayout layout(stream);
     layout.emit(ScratchRecord, tableOffset, hashTableBlob);
   }
+
+  // Write the names imported for the declarations of this module, so that
+  // clients of the module don't have to import them again.
+  {
+    SmallVector<std::pair<ImportedNameKey, std::string>, 64> names;
+    nameImporter.forEachImportedName(
+        [&](const clang::NamedDecl *decl, importer::ImportNameOptions options,
+            const importer::ImportedName &name) {
+      // Only the declarations of this module that are visible to clients.
+      if (decl->isFromASTFile() || decl->getParentFunctionOrMethod())
+        return;
+
+      std::string data;
+      llvm::raw_string_ostream out(data);
+      if (!writeImportedName(Writer, name, out))
+        return;
+      out.flush();
+
+      names.push_back({{Writer.getDeclID(decl), options.toRaw()},
+                       std::move(data)});
+    });
+    std::sort(names.begin(), names.end(),
+              [](const std::pair<ImportedNameKey, std::string> &lhs,
+                 const std::pair<ImportedNameKey, std::string> &rhs) {
+      return lhs.first < rhs.first;
+    });
+
+    if (!names.empty()) {
+      llvm::SmallString<4096> hashTableBlob;
+      uint32_t tableOffset;
+      {
+        llvm::OnDiskChainedHashTableGenerator<ImportedNamesTableWriterInfo>
+          generator;
+        ImportedNamesTableWriterInfo info;
+        for (auto &entry : names)
+          generator.insert(entry.first, entry.second, info);
+
+        llvm::raw_svector_ostream blobStream(hashTableBlob);
+        // Make sure that no bucket is at offset 0
+        endian::Writer<little>(blobStream).write<uint32_t>(0);
+        tableOffset = generator.Emit(blobStream, info);
+      }
+
+      ImportedNamesTableRecordLayout layout(stream);
+      layout.emit(ScratchRecord, tableOffset, hashTableBlob);
+    }
+  }
+
+  // Write the constants that the macros of this module evaluate to, so that
+  // clients of the module don't have to evaluate them again.
+  {
+    SmallVector<std::pair<clang::serialization::MacroID, std::string>, 64>
+      constants;
+    llvm::SmallPtrSet<clang::MacroInfo *, 64> visited;
+    for (auto baseName : baseNames) {
+      for (auto &fullEntry : table.LookupTable[baseName]) {
+        for (auto stored : fullEntry.DeclsOrMacros) {
+          if (!SwiftLookupTable::isMacroEntry(stored))
+            continue;
+
+          auto macro = table.mapStoredMacro(stored);
+          if (!macro || macro->isFromASTFile() || !visited.insert(macro).second)
+            continue;
+
+          std::string data;
+          llvm::raw_string_ostream out(data);
+          if (!writeMacroConstant(Writer, sema.Context,
+                                  evaluateMacroConstant(sema, macro), out))
+            continue;
+          out.flush();
+
+          constants.push_back({Writer.getMacroID(macro), std::move(data)});
+        }
+      }
+    }
+
+    if (!constants.empty()) {
+      llvm::SmallString<4096> hashTableBlob;
+      uint32_t tableOffset;
+      {
+        llvm::OnDiskChainedHashTableGenerator<MacroConstantsTableWriterInfo>
+          generator;
+        MacroConstantsTableWriterInfo info;
+        for (auto &entry : constants)
+          generator.insert(entry.first, entry.second, info);
+
+        llvm::raw_svector_ostream blobStream(hashTableBlob);
+        // Make sure that no bucket is at offset 0
+        endian::Writer<little>(blobStream).write<uint32_t>(0);
+        tableOffset = generator.Emit(blobStream, info);
+      }
+
+      MacroConstantsTableRecordLayout layout(stream);
+      layout.emit(ScratchRecord, tableOffset, hashTableBlob);
+    }
+  }
 }
 
 namespace {
@@ -1275,6 +1857,92 @@ namespace {
       return result;
     }
   };
+
+  /// Used to deserialize the on-disk imported names table.
+  class ImportedNamesTableReaderInfo {
+  public:
+    using internal_key_type = ImportedNameKey;
+    using external_key_type = internal_key_type;
+    using data_type = StringRef;
+    using hash_value_type = uint32_t;
+    using offset_type = unsigned;
+
+    internal_key_type GetInternalKey(external_key_type key) {
+      return key;
+    }
+
+    external_key_type GetExternalKey(internal_key_type key) {
+      return key;
+    }
+
+    hash_value_type ComputeHash(internal_key_type key) {
+      return hashImportedNameKey(key);
+    }
+
+    static bool EqualKey(internal_key_type lhs, internal_key_type rhs) {
+      return lhs == rhs;
+    }
+
+    static std::pair<unsigned, unsigned>
+    ReadKeyDataLength(const uint8_t *&data) {
+      unsigned keyLength = endian::readNext<uint16_t, little, unaligned>(data);
+      unsigned dataLength = endian::readNext<uint16_t, little, unaligned>(data);
+      return { keyLength, dataLength };
+    }
+
+    static internal_key_type ReadKey(const uint8_t *data, unsigned length) {
+      auto declID = endian::readNext<uint32_t, little, unaligned>(data);
+      auto options = endian::readNext<uint8_t, little, unaligned>(data);
+      return { declID, options };
+    }
+
+    static data_type ReadData(internal_key_type key, const uint8_t *data,
+                              unsigned length) {
+      return StringRef(reinterpret_cast<const char *>(data), length);
+    }
+  };
+
+  /// Used to deserialize the on-disk macro constants table.
+  class MacroConstantsTableReaderInfo {
+  public:
+    using internal_key_type = clang::serialization::MacroID;
+    using external_key_type = internal_key_type;
+    using data_type = StringRef;
+    using hash_value_type = uint32_t;
+    using offset_type = unsigned;
+
+    internal_key_type GetInternalKey(external_key_type key) {
+      return key;
+    }
+
+    external_key_type GetExternalKey(internal_key_type key) {
+      return key;
+    }
+
+    hash_value_type ComputeHash(internal_key_type key) {
+      return key;
+    }
+
+    static bool EqualKey(internal_key_type lhs, internal_key_type rhs) {
+      return lhs == rhs;
+    }
+
+    static std::pair<unsigned, unsigned>
+    ReadKeyDataLength(const uint8_t *&data) {
+      unsigned keyLength = endian::readNext<uint16_t, little, unaligned>(data);
+      unsigned dataLength = endian::readNext<uint16_t, little, unaligned>(data);
+      return { keyLength, dataLength };
+    }
+
+    static internal_key_type ReadKey(const uint8_t *data, unsigned length) {
+      return endian::readNext<uint32_t, little, unaligned>(data);
+    }
+
+    static data_type ReadData(internal_key_type key, const uint8_t *data,
+                              unsigned length) {
+      return StringRef(reinterpret_cast<const char *>(data), length);
+    }
+  };
 }
 
 namespace swift {
@@ -1283,6 +1951,12 @@ namespace swift {
 
   using SerializedGlobalsAsMembersTable =
     llvm::OnDiskIterableChainedHashTable<GlobalsAsMembersTableReaderInfo>;
+
+  using SerializedImportedNamesTable =
+    llvm::OnDiskIterableChainedHashTable<ImportedNamesTableReaderInfo>;
+
+  using SerializedMacroConstantsTable =
+    llvm::OnDiskIterableChainedHashTable<MacroConstantsTableReaderInfo>;
 }
 
 clang::NamedDecl *SwiftLookupTable::mapStoredDecl(uintptr_t &entry) {
@@ -1322,6 +1996,10 @@ clang::MacroInfo *SwiftLookupTable::mapStoredMacro(uintptr_t &entry) {
                     Reader->getModuleFile(),
                     macroID)));
 
+  // Remember the ID, which keys the constant of the macro.
+  if (macro)
+    MacroIDs[macro] = macroID;
+
   // Update the entry now that we've resolved the macro.
   entry = encodeEntry(macro);
   return macro;
@@ -1338,6 +2016,8 @@ SwiftLookupTableReader::~SwiftLookupTableReader() {
   OnRemove();
   delete static_cast<SerializedBaseNameToEntitiesTable *>(SerializedTable);
   delete static_cast<SerializedGlobalsAsMembersTable *>(GlobalsAsMembersTable);
+  delete static_cast<SerializedImportedNamesTable *>(ImportedNamesTable);
+  delete static_cast<SerializedMacroConstantsTable *>(MacroConstantsTable);
 }
 
 std::unique_ptr<SwiftLookupTableReader>
@@ -1353,6 +2033,8 @@ SwiftLookupTableReader::create(clang::ModuleFileExtension *extension,
   auto next = cursor.advance();
   std::unique_ptr<SerializedBaseNameToEntitiesTable> serializedTable;
   std::unique_ptr<SerializedGlobalsAsMembersTable> globalsAsMembersTable;
+  std::unique_ptr<SerializedImportedNamesTable> importedNamesTable;
+  std::unique_ptr<SerializedMacroConstantsTable> macroConstantsTable;
   ArrayRef<clang::serialization::DeclID> categories;
   while (next.Kind != llvm::BitstreamEntry::EndBlock) {
     if (next.Kind == llvm::BitstreamEntry::Error)
@@ -1416,6 +2098,38 @@ SwiftLookupTableReader::create(clang::ModuleFileExtension *extension,
       break;
     }
 
+    case IMPORTED_NAMES_RECORD_ID: {
+      // Already saw imported names table.
+      if (importedNamesTable)
+        return nullptr;
+
+      uint32_t tableOffset;
+      ImportedNamesTableRecordLayout::readRecord(scratch, tableOffset);
+      auto base = reinterpret_cast<const uint8_t *>(blobData.data());
+
+      importedNamesTable.reset(
+        SerializedImportedNamesTable::Create(base + tableOffset,
+                                             base + sizeof(uint32_t),
+                                             base));
+      break;
+    }
+
+    case MACRO_CONSTANTS_RECORD_ID: {
+      // Already saw macro constants table.
+      if (macroConstantsTable)
+        return nullptr;
+
+      uint32_t tableOffset;
+      MacroConstantsTableRecordLayout::readRecord(scratch, tableOffset);
+      auto base = reinterpret_cast<const uint8_t *>(blobData.data());
+
+      macroConstantsTable.reset(
+        SerializedMacroConstantsTable::Create(base + tableOffset,
+                                              base + sizeof(uint32_t),
+                                              base));
+      break;
+    }
+
     default:
       // Unknown record, possibly for use by a future version of the
       // module format.
@@ -1431,7 +2145,9 @@ SwiftLookupTableReader::create(clang::ModuleFileExtension *extension,
   return std::unique_ptr<SwiftLookupTableReader>(
            new SwiftLookupTableReader(extension, reader, moduleFile, onRemove,
                                       serializedTable.release(), categories,
-                                      globalsAsMembersTable.release()));
+                                      globalsAsMembersTable.release(),
+                                      importedNamesTable.release(),
+                                      macroConstantsTable.release()));
 
 }
 
@@ -1488,6 +2204,65 @@ bool SwiftLookupTableReader::lookupGlobalsAsMembers(
   return true;
 }
 
+bool SwiftLookupTableReader::lookupImportedName(
+       clang::serialization::DeclID declID, uint8_t options, StringRef &data) {
+  auto table = static_cast<SerializedImportedNamesTable*>(ImportedNamesTable);
+  if (!table) return false;
+
+  auto known = table->find({declID, options});
+  if (known == table->end()) return false;
+
+  data = *known;
+  return true;
+}
+
+bool SwiftLookupTable::lookupImportedName(const clang::NamedDecl *decl,
+                                          uint8_t options, ASTContext &ctx,
+                                          importer::ImportedName &result) {
+  if (!Reader) return false;
+
+  // Find the ID of the declaration within this module file.
+  auto &astReader = Reader->getASTReader();
+  auto declID = astReader.mapGlobalIDToModuleFileGlobalID(
+                  Reader->getModuleFile(), decl->getGlobalID());
+  if (!declID) return false;
+
+  StringRef data;
+  if (!Reader->lookupImportedName(declID, options, data)) return false;
+
+  return readImportedName(data, ctx, astReader, Reader->getModuleFile(),
+                          result);
+}
+
+bool SwiftLookupTableReader::lookupMacroConstant(
+       clang::serialization::MacroID macroID, StringRef &data) {
+  auto table =
+    static_cast<SerializedMacroConstantsTable*>(MacroConstantsTable);
+  if (!table) return false;
+
+  auto known = table->find(macroID);
+  if (known == table->end()) return false;
+
+  data = *known;
+  return true;
+}
+
+bool SwiftLookupTable::lookupMacroConstant(
+       const clang::MacroInfo *macro, clang::ASTContext &clangCtx,
+       Optional<MacroConstant> &result) {
+  if (!Reader) return false;
+
+  // Only the macros that were found through this table have known IDs.
+  auto known = MacroIDs.find(macro);
+  if (known == MacroIDs.end()) return false;
+
+  StringRef data;
+  if (!Reader->lookupMacroConstant(known->second, data)) return false;
+
+  return readMacroConstant(data, clangCtx, Reader->getASTReader(),
+                           Reader->getModuleFile(), result);
+}
+
 clang::ModuleFileExtensionMetadata
 SwiftNameLookupExtension::getExtensionMetadata() const {
   clang::ModuleFileExtensionMetadata metadata;
@@ -1501,10 +2276,14 @@ SwiftNameLookupExtension::getExtensionMetadata() const {
 
 llvm::hash_code
 SwiftNameLookupExtension::hashExtension(llvm::hash_code code) const {
+  // The imported names depend on the version of the compiler that imported
+  // them.
   return llvm::hash_combine(code, StringRef("swift.lookup"),
                             SWIFT_LOOKUP_TABLE_VERSION_MAJOR,
                             SWIFT_LOOKUP_TABLE_VERSION_MINOR,
-                            inferImportAsMember);
+                            inferImportAsMember,
+                            version::getSwiftFullVersion(
+                              swiftCtx.LangOpts.EffectiveLanguageVersion));
 }
 
 void SwiftLookupTableWriter::populateTable(SwiftLookupTable &table,
@@ -1549,12 +2328,16 @@ SwiftNameLookupExtension::createExtensionReader(
   assert(metadata.MajorVersion == SWIFT_LOOKUP_TABLE_VERSION_MAJOR);
   assert(metadata.MinorVersion == SWIFT_LOOKUP_TABLE_VERSION_MINOR);
 
+  // A precompiled header has no module name; its table is the one of the
+  // precompiled bridging header.
+  std::string moduleName =
+    mod.Kind == clang::serialization::MK_PCH ? "" : mod.ModuleName;
+
   // Check whether we already have an entry in the set of lookup tables.
-  auto &entry = lookupTables[mod.ModuleName];
+  auto &entry = lookupTables[moduleName];
   if (entry) return nullptr;
 
   // Local function used to remove this entry when the reader goes away.
-  std::string moduleName = mod.ModuleName;
   auto onRemove = [this, moduleName]() {
     lookupTables.erase(moduleName);
   };
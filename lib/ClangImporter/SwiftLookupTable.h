@@ -44,6 +44,11 @@ class TypedefNameDecl;
 
 namespace swift {
 
+namespace importer {
+struct ImportedName;
+class MacroConstant;
+}
+
 /// The context into which a Clang declaration will be imported.
 ///
 /// When the context into which a declaration will be imported matches
@@ -146,7 +151,7 @@ const uint16_t SWIFT_LOOKUP_TABLE_VERSION_MAJOR = 1;
 /// Lookup table minor version number.
 ///
 /// When the format changes IN ANY WAY, this number should be incremented.
-const uint16_t SWIFT_LOOKUP_TABLE_VERSION_MINOR = 14; // Swift 2 names
+const uint16_t SWIFT_LOOKUP_TABLE_VERSION_MINOR = 16; // macro constants
 
 /// A lookup table that maps Swift names to the set of Clang
 /// declarations with that particular name.
@@ -266,6 +271,10 @@ public:
 private:
   /// A table mapping from the base name of Swift entities to all of
   /// the C entities that have that name, in all contexts.
+  ///
+  /// When the table comes from a module file, this only caches the base
+  /// names that have been looked up so far, including ones with no entries.
+  /// Everything else is left in the on-disk table until it is asked for.
   llvm::DenseMap<StringRef, SmallVector<FullTableEntry, 2>> LookupTable;
 
   /// The list of Objective-C categories and extensions.
@@ -281,6 +290,11 @@ private:
   /// The reader responsible for lazily loading the contents of this table.
   SwiftLookupTableReader *Reader;
 
+  /// The serialization IDs of the macros that have been resolved, which key
+  /// their serialized constants.
+  llvm::DenseMap<const clang::MacroInfo *, clang::serialization::MacroID>
+    MacroIDs;
+
   /// Entries whose effective contexts could not be resolved, and
   /// therefore will need to be added later.
   SmallVector<std::tuple<DeclName, SingleEntry, EffectiveClangContext>, 4>
@@ -391,6 +405,26 @@ public:
   /// imported as members.
   SmallVector<SingleEntry, 4> allGlobalsAsMembers();
 
+  /// Retrieve the name that was imported for the given declaration when
+  /// this table was written.
+  ///
+  /// \param options The raw ImportNameOptions the name was imported with.
+  ///
+  /// \returns true if the name was found, false otherwise.
+  bool lookupImportedName(const clang::NamedDecl *decl, uint8_t options,
+                          ASTContext &ctx, importer::ImportedName &result);
+
+  /// Retrieve the constant that the given macro was evaluated to when this
+  /// table was written.
+  ///
+  /// \param result Set to the constant, or None if the macro was found not
+  /// to be a constant.
+  ///
+  /// \returns true if the macro was evaluated, false otherwise.
+  bool lookupMacroConstant(const clang::MacroInfo *macro,
+                           clang::ASTContext &clangCtx,
+                           Optional<importer::MacroConstant> &result);
+
   /// Deserialize all entries.
   void deserializeAll();
 
@@ -38,6 +38,9 @@
 
 #include "CompilationRecord.h"
 
+#include <chrono>
+#include <queue>
+
 using namespace swift;
 using namespace swift::sys;
 using namespace swift::driver;
@@ -88,6 +91,42 @@ namespace {
     ///
     /// Only intended for source files.
     llvm::SmallDenseMap<const Job *, bool, 16> UnfinishedCommands;
+
+    /// A job whose inputs have all finished, waiting for a free slot.
+    struct ReadyCommand {
+      uint64_t Priority;
+      /// Breaks ties in favor of the job that became ready first.
+      unsigned Order;
+      const Job *Cmd;
+
+      bool operator<(const ReadyCommand &other) const {
+        if (Priority != other.Priority)
+          return Priority < other.Priority;
+        return Order > other.Order;
+      }
+    };
+
+    /// Jobs that are ready to run but haven't been handed to the TaskQueue,
+    /// highest priority first.
+    ///
+    /// Jobs are only handed over when the TaskQueue can start them right away,
+    /// so that a job which becomes ready later can still run ahead of them.
+    std::priority_queue<ReadyCommand> ReadyCommands;
+    unsigned NumReadyCommandsSeen = 0;
+
+    /// The number of jobs handed to the TaskQueue that haven't finished.
+    unsigned NumCommandsInFlight = 0;
+
+    /// How much expected work is waiting on each job.
+    llvm::DenseMap<const Job *, uint64_t> Priorities;
+
+    /// When each running job started.
+    llvm::DenseMap<const Job *, std::chrono::steady_clock::time_point>
+        StartTimes;
+
+    /// Statistics for the jobs that ran in this build, keyed like
+    /// Compilation::PreviousJobStatistics.
+    JobStatisticsMap MeasuredJobStatistics;
   };
 }
 
@@ -99,6 +138,98 @@ Job *Compilation::addJob(std::unique_ptr<Job> J) {
   return result;
 }
 
+/// \returns the input under which the compilation record keeps statistics
+/// for \p Cmd, or an empty string if it doesn't keep any.
+///
+/// Only compile jobs with a single primary input are tracked.
+static StringRef getJobStatisticsKey(const Job *Cmd) {
+  const auto *compileAction = dyn_cast<CompileJobAction>(&Cmd->getSource());
+  if (!compileAction)
+    return StringRef();
+
+  const InputAction *inputFile = nullptr;
+  for (const Action *input : compileAction->getInputs()) {
+    // The bridging PCH is an input of every compile job, not a primary one.
+    if (isa<GeneratePCHJobAction>(input))
+      continue;
+    if (inputFile || !isa<InputAction>(input))
+      return StringRef();
+    inputFile = cast<InputAction>(input);
+  }
+  if (!inputFile)
+    return StringRef();
+  return inputFile->getInputArg().getValue();
+}
+
+static uint64_t
+computeJobPriority(const Job *Cmd,
+                   const llvm::DenseMap<const Job *, uint64_t> &Costs,
+                   const llvm::DenseMap<const Job *,
+                                        SmallVector<const Job *, 4>> &Users,
+                   llvm::DenseMap<const Job *, uint64_t> &Priorities) {
+  auto known = Priorities.find(Cmd);
+  if (known != Priorities.end())
+    return known->second;
+
+  uint64_t longestUserChain = 0;
+  auto users = Users.find(Cmd);
+  if (users != Users.end()) {
+    for (const Job *User : users->second) {
+      longestUserChain = std::max(longestUserChain,
+                                  computeJobPriority(User, Costs, Users,
+                                                     Priorities));
+    }
+  }
+
+  uint64_t priority = Costs.lookup(Cmd) + longestUserChain;
+  Priorities[Cmd] = priority;
+  return priority;
+}
+
+/// Estimates how much work is waiting on each job in \p Jobs: its own
+/// expected running time plus that of the longest chain of jobs that use its
+/// output.  Starting the jobs with the most work behind them first keeps a
+/// single long job from running alone at the end of the build.
+///
+/// Expected running times come from the previous build.  Jobs that it didn't
+/// measure are assumed to take as long as an average measured job.  Without
+/// any measurements, every job gets the same priority, so jobs run in the
+/// order in which they become ready.
+static void
+computeJobPriorities(ArrayRef<const Job *> Jobs,
+                     const JobStatisticsMap &PreviousStats,
+                     llvm::DenseMap<const Job *, uint64_t> &Priorities) {
+  if (PreviousStats.empty())
+    return;
+
+  uint64_t totalKnownTime = 0;
+  unsigned numKnown = 0;
+  for (const Job *Cmd : Jobs) {
+    auto stats = PreviousStats.find(getJobStatisticsKey(Cmd));
+    if (stats != PreviousStats.end()) {
+      totalKnownTime += stats->second.WallTimeMillis;
+      ++numKnown;
+    }
+  }
+  uint64_t defaultTime = numKnown ? totalKnownTime / numKnown : 0;
+
+  llvm::DenseMap<const Job *, uint64_t> Costs;
+  llvm::DenseMap<const Job *, SmallVector<const Job *, 4>> Users;
+  for (const Job *Cmd : Jobs) {
+    StringRef key = getJobStatisticsKey(Cmd);
+    if (!key.empty()) {
+      auto stats = PreviousStats.find(key);
+      Costs[Cmd] = (stats != PreviousStats.end()) ?
+          stats->second.WallTimeMillis : defaultTime;
+    }
+    for (const Job *Input : Cmd->getInputs())
+      Users[Input].push_back(Cmd);
+  }
+
+  for (const Job *Cmd : Jobs)
+    computeJobPriority(Cmd, Costs, Users, Priorities);
+}
+
 static const Job *findUnfinishedJob(ArrayRef<const Job *> JL,
                                     const CommandSet &FinishedCommands) {
   for (const Job *Cmd : JL) {
@@ -115,7 +246,9 @@ static void populateInputInfoMap(InputInfoMap &inputs,
                                  const PerformJobsState &endState) {
   for (auto &entry : endState.UnfinishedCommands) {
     for (auto *action : entry.first->getSource().getInputs()) {
-      auto inputFile = cast<InputAction>(action);
+      auto inputFile = dyn_cast<InputAction>(action);
+      if (!inputFile)
+        continue;
 
       CompileJobAction::InputInfo info;
       info.previousModTime = entry.first->getInputModTime();
@@ -132,7 +265,9 @@ static void populateInputInfoMap(InputInfoMap &inputs,
       continue;
 
     for (auto *action : compileAction->getInputs()) {
-      auto inputFile = cast<InputAction>(action);
+      auto inputFile = dyn_cast<InputAction>(action);
+      if (!inputFile)
+        continue;
 
       CompileJobAction::InputInfo info;
       info.previousModTime = entry->getInputModTime();
@@ -179,7 +314,9 @@ static void checkForOutOfDateInputs(DiagnosticEngine &diags,
 
 static void writeCompilationRecord(StringRef path, StringRef argsHash,
                                    llvm::sys::TimeValue buildTime,
-                                   const InputInfoMap &inputs) {
+                                   const InputInfoMap &inputs,
+                                   const JobStatisticsMap &previousJobStats,
+                                   const JobStatisticsMap &jobStats) {
   std::error_code error;
   llvm::raw_fd_ostream out(path, error, llvm::sys::fs::F_None);
   if (out.has_error()) {
@@ -219,6 +356,32 @@ static void writeCompilationRecord(StringRef path, StringRef argsHash,
     writeTimeValue(out, entry.second.previousModTime);
     out << "\n";
   }
+
+  // Keep the statistics of inputs that didn't need to be rebuilt this time.
+  bool wroteStatisticsKey = false;
+  for (auto &entry : inputs) {
+    StringRef inputName = entry.first->getValue();
+    auto stats = jobStats.find(inputName);
+    if (stats == jobStats.end()) {
+      stats = previousJobStats.find(inputName);
+      if (stats == previousJobStats.end())
+        continue;
+    }
+
+    if (!wroteStatisticsKey) {
+      out << compilation_record::getName(TopLevelKey::JobStatistics) << ":\n";
+      wroteStatisticsKey = true;
+    }
+
+    using compilation_record::JobStatisticKey;
+    out << "  \"" << llvm::yaml::escape(inputName) << "\": { "
+        << compilation_record::getName(JobStatisticKey::WallTime) << ": "
+        << stats->second.WallTimeMillis << ", "
+        << compilation_record::getName(JobStatisticKey::PeakMemory) << ": "
+        << stats->second.PeakResidentSetSizeKB << ", "
+        << compilation_record::getName(JobStatisticKey::ExitStatus) << ": "
+        << stats->second.ExitStatus << " }\n";
+  }
 }
 
 static bool writeFilelistIfNecessary(const Job *job, DiagnosticEngine &diags) {
@@ -268,8 +431,17 @@ int Compilation::performJobsImpl() {
 
   PerformJobsState State;
 
+  {
+    SmallVector<const Job *, 32> AllJobs(getJobs().begin(), getJobs().end());
+    computeJobPriorities(AllJobs, PreviousJobStatistics, State.Priorities);
+  }
+
+  unsigned MaxCommandsInFlight = std::max(1U, NumberOfParallelCommands);
+
   using DependencyGraph = DependencyGraph<const Job *>;
   DependencyGraph DepGraph;
+  if (EnableFineGrainedDependencies)
+    DepGraph.setEnableFineGrainedDependencies();
   SmallPtrSet<const Job *, 16> DeferredCommands;
   SmallVector<const Job *, 16> InitialOutOfDateCommands;
 
@@ -278,6 +450,20 @@ int Compilation::performJobsImpl() {
   if (ShowIncrementalBuildDecisions)
     IncrementalTracer = &ActualIncrementalTracer;
 
+  // With compact parseable output, list the inputs once up front, so that the
+  // messages for each job don't have to repeat their paths.
+  parseable_output::InputIndexMap ParseableInputIndices;
+  const parseable_output::InputIndexMap *InputIndices = nullptr;
+  if (Level == OutputLevel::Parseable && CompactParseableOutput) {
+    SmallVector<const Arg *, 32> InputArgs;
+    for (const InputPair &Input : getInputFiles())
+      InputArgs.push_back(Input.second);
+    parseable_output::emitInputsMessage(llvm::errs(), InputArgs,
+                                        AllSourceFilesPath,
+                                        ParseableInputIndices);
+    InputIndices = &ParseableInputIndices;
+  }
+
   auto noteBuilding = [&] (const Job *cmd, StringRef reason) {
     if (!ShowIncrementalBuildDecisions)
       return;
@@ -313,8 +499,21 @@ int Compilation::performJobsImpl() {
     assert(Cmd->getExtraEnvironment().empty() &&
            "not implemented for compilations with multiple jobs");
     State.ScheduledCommands.insert(Cmd);
-    TQ->addTask(Cmd->getExecutable(), Cmd->getArguments(), llvm::None,
-                (void *)Cmd);
+    State.ReadyCommands.push({State.Priorities.lookup(Cmd),
+                              State.NumReadyCommandsSeen++, Cmd});
+  };
+
+  // Hand the highest-priority ready jobs to the TaskQueue, as many as it can
+  // start right away.
+  auto startReadyCommands = [&] {
+    while (!State.ReadyCommands.empty() &&
+           State.NumCommandsInFlight < MaxCommandsInFlight) {
+      const Job *Cmd = State.ReadyCommands.top().Cmd;
+      State.ReadyCommands.pop();
+      ++State.NumCommandsInFlight;
+      TQ->addTask(Cmd->getExecutable(), Cmd->getArguments(), llvm::None,
+                  (void *)Cmd);
+    }
   };
 
   // When a task finishes, we need to reevaluate the other commands that
@@ -426,6 +625,8 @@ int Compilation::performJobsImpl() {
     }
   }
 
+  startReadyCommands();
+
   int Result = EXIT_SUCCESS;
   llvm::TimerGroup DriverTimerGroup("Driver Time Compilation");
   llvm::SmallDenseMap<const Job *, std::unique_ptr<llvm::Timer>, 16>
@@ -437,6 +638,7 @@ int Compilation::performJobsImpl() {
   auto taskBegan = [&] (ProcessId Pid, void *Context) {
     // TODO: properly handle task began.
     const Job *BeganCmd = (const Job *)Context;
+    State.StartTimes[BeganCmd] = std::chrono::steady_clock::now();
 
     if (ShowDriverTimeCompilation) {
       llvm::SmallString<128> TimerName;
@@ -468,7 +670,24 @@ int Compilation::performJobsImpl() {
     if (Level == OutputLevel::Verbose)
       BeganCmd->printCommandLine(llvm::errs());
     else if (Level == OutputLevel::Parseable)
-      parseable_output::emitBeganMessage(llvm::errs(), *BeganCmd, Pid);
+      parseable_output::emitBeganMessage(llvm::errs(), *BeganCmd, Pid,
+                                         InputIndices);
+  };
+
+  // Remember how long a job took, how much memory it used, and how it
+  // exited, for the compilation record.
+  auto recordJobStatistics = [&] (const Job *Cmd, int ExitStatus,
+                                  const TaskResourceUsage &Usage) {
+    StringRef StatisticsKey = getJobStatisticsKey(Cmd);
+    if (StatisticsKey.empty())
+      return;
+
+    auto Elapsed = std::chrono::steady_clock::now() - State.StartTimes[Cmd];
+    JobStatistics &Stats = State.MeasuredJobStatistics[StatisticsKey];
+    Stats.WallTimeMillis =
+      std::chrono::duration_cast<std::chrono::milliseconds>(Elapsed).count();
+    Stats.PeakResidentSetSizeKB = Usage.PeakResidentSetSizeKB;
+    Stats.ExitStatus = ExitStatus;
   };
 
   // Set up a callback which will be called immediately after a task has
@@ -477,13 +696,17 @@ int Compilation::performJobsImpl() {
   // it should also schedule any additional commands which we now know need
   // to run.
   auto taskFinished = [&] (ProcessId Pid, int ReturnCode, StringRef Output,
+                           const TaskResourceUsage &Usage,
                            void *Context) -> TaskFinishedResponse {
     const Job *FinishedCmd = (const Job *)Context;
+    --State.NumCommandsInFlight;
 
     if (ShowDriverTimeCompilation) {
       DriverTimers[FinishedCmd]->stopTimer();
     }
 
+    recordJobStatistics(FinishedCmd, ReturnCode, Usage);
+
     if (Level == OutputLevel::Parseable) {
       // Parseable output was requested.
       parseable_output::emitFinishedMessage(llvm::errs(), *FinishedCmd, Pid,
@@ -589,9 +812,10 @@ int Compilation::performJobsImpl() {
                        ReturnCode);
       }
 
-      return ContinueBuildingAfterErrors ?
-          TaskFinishedResponse::ContinueExecution :
-          TaskFinishedResponse::StopExecution;
+      if (!ContinueBuildingAfterErrors)
+        return TaskFinishedResponse::StopExecution;
+      startReadyCommands();
+      return TaskFinishedResponse::ContinueExecution;
     }
 
     // When a task finishes, we need to reevaluate the other commands that
@@ -604,17 +828,23 @@ int Compilation::performJobsImpl() {
       scheduleCommandIfNecessaryAndPossible(Cmd);
     }
 
+    startReadyCommands();
     return TaskFinishedResponse::ContinueExecution;
   };
 
   auto taskSignalled = [&] (ProcessId Pid, StringRef ErrorMsg, StringRef Output,
+                            const TaskResourceUsage &Usage,
                             void *Context) -> TaskFinishedResponse {
     const Job *SignalledCmd = (const Job *)Context;
+    --State.NumCommandsInFlight;
 
     if (ShowDriverTimeCompilation) {
       DriverTimers[SignalledCmd]->stopTimer();
     }
 
+    recordJobStatistics(SignalledCmd, JobStatistics::SignalledExitStatus,
+                        Usage);
+
     if (Level == OutputLevel::Parseable) {
       // Parseable output was requested.
       parseable_output::emitSignalledMessage(llvm::errs(), *SignalledCmd, Pid,
@@ -648,7 +878,7 @@ int Compilation::performJobsImpl() {
       if (Level == OutputLevel::Parseable) {
         // Provide output indicating this command was skipped if parseable output
         // was requested.
-        parseable_output::emitSkippedMessage(llvm::errs(), *Cmd);
+        parseable_output::emitSkippedMessage(llvm::errs(), *Cmd, InputIndices);
       }
 
       State.ScheduledCommands.insert(Cmd);
@@ -656,6 +886,7 @@ int Compilation::performJobsImpl() {
     }
 
     // ...which may allow us to go on and do later tasks.
+    startReadyCommands();
   } while (Result == 0 && TQ->hasRemainingTasks());
 
   if (Result == 0) {
@@ -688,7 +919,8 @@ int Compilation::performJobsImpl() {
     populateInputInfoMap(InputInfo, State);
     checkForOutOfDateInputs(Diags, InputInfo);
     writeCompilationRecord(CompilationRecordPath, ArgsHash, BuildStartTime,
-                           InputInfo);
+                           InputInfo, PreviousJobStatistics,
+                           State.MeasuredJobStatistics);
   }
 
   if (Result == 0)
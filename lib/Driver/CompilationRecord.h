@@ -34,6 +34,9 @@ enum class TopLevelKey {
   /// The key for the list of inputs to the compilation that produced the
   /// compilation record.
   Inputs,
+  /// The key for the measurements of each input's job, from the most recent
+  /// build in which it ran.
+  JobStatistics,
 };
 
 /// \returns A string representation of the given key.
@@ -43,6 +46,27 @@ inline static StringRef getName(TopLevelKey Key) {
   case TopLevelKey::Options: return "options";
   case TopLevelKey::BuildTime: return "build_time";
   case TopLevelKey::Inputs: return "inputs";
+  case TopLevelKey::JobStatistics: return "job_statistics";
+  }
+}
+
+/// Each entry in the job statistics map is itself a map with these keys.
+/// Unknown keys are ignored, so that new measurements can be added.
+enum class JobStatisticKey {
+  /// The job's wall-clock running time, in milliseconds.
+  WallTime,
+  /// The job's peak resident set size, in kilobytes, or 0 if unknown.
+  PeakMemory,
+  /// The job's exit status, or -2 if it was terminated by a signal.
+  ExitStatus,
+};
+
+/// \returns A string representation of the given key.
+inline static StringRef getName(JobStatisticKey Key) {
+  switch (Key) {
+  case JobStatisticKey::WallTime: return "wall_time_ms";
+  case JobStatisticKey::PeakMemory: return "peak_rss_kb";
+  case JobStatisticKey::ExitStatus: return "exit_status";
   }
 }
 
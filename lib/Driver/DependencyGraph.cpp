@@ -48,12 +48,24 @@ using LoadResult = DependencyGraphImpl::LoadResult;
 using DependencyKind = DependencyGraphImpl::DependencyKind;
 using DependencyCallbackTy = LoadResult(StringRef, DependencyKind, bool);
 using InterfaceHashCallbackTy = LoadResult(StringRef);
+using DeclInterfaceHashCallbackTy = LoadResult(StringRef, DependencyKind,
+                                               StringRef);
+
+/// Builds the key used for \p name in DependencyGraphImpl's per-declaration
+/// interface hash tables.
+static void appendDeclInterfaceHashKey(SmallVectorImpl<char> &key,
+                                       DependencyKind kind, StringRef name) {
+  key.push_back(static_cast<char>(kind));
+  key.append(name.begin(), name.end());
+}
 
 static LoadResult
 parseDependencyFile(llvm::MemoryBuffer &buffer,
                     llvm::function_ref<DependencyCallbackTy> providesCallback,
                     llvm::function_ref<DependencyCallbackTy> dependsCallback,
-                    llvm::function_ref<InterfaceHashCallbackTy> interfaceHashCallback) {
+                    llvm::function_ref<InterfaceHashCallbackTy> interfaceHashCallback,
+                    llvm::function_ref<DeclInterfaceHashCallbackTy>
+                      declInterfaceHashCallback) {
   namespace yaml = llvm::yaml;
 
   // FIXME: Switch to a format other than YAML.
@@ -105,6 +117,44 @@ parseDependencyFile(llvm::MemoryBuffer &buffer,
       StringRef valueString = value->getValue(scratch);
       UPDATE_RESULT(interfaceHashCallback(valueString));
 
+    } else if (keyString == "interface-hash-top-level" ||
+               keyString == "interface-hash-nominal") {
+      // These come in the form ["name", "hash"], where the name is a
+      // top-level name or a mangled nominal type name respectively.
+      DependencyKind kind = keyString == "interface-hash-top-level"
+                              ? DependencyKind::TopLevelName
+                              : DependencyKind::NominalType;
+
+      auto *entries = dyn_cast<yaml::SequenceNode>(i->getValue());
+      if (!entries)
+        return LoadResult::HadError;
+
+      for (yaml::Node &rawEntry : *entries) {
+        auto *entry = dyn_cast<yaml::SequenceNode>(&rawEntry);
+        if (!entry)
+          return LoadResult::HadError;
+
+        auto iter = entry->begin();
+        auto *name = dyn_cast<yaml::ScalarNode>(&*iter);
+        if (!name)
+          return LoadResult::HadError;
+        ++iter;
+
+        auto *hash = dyn_cast<yaml::ScalarNode>(&*iter);
+        if (!hash)
+          return LoadResult::HadError;
+        ++iter;
+
+        // FIXME: LLVM's YAML support doesn't implement == correctly for end
+        // iterators.
+        assert(!(iter != entry->end()));
+
+        SmallString<64> nameScratch;
+        UPDATE_RESULT(declInterfaceHashCallback(name->getValue(nameScratch),
+                                                kind,
+                                                hash->getValue(scratch)));
+      }
+
     } else {
       enum class DependencyDirection : bool {
         Depends,
@@ -285,8 +335,79 @@ LoadResult DependencyGraphImpl::loadFromBuffer(const void *node,
     return LoadResult::UpToDate;
   };
 
-  return parseDependencyFile(buffer, providesCallback, dependsCallback,
-                             interfaceHashCallback);
+  llvm::StringMap<std::string> declHashes;
+  auto declInterfaceHashCallback =
+      [&declHashes](StringRef name, DependencyKind kind,
+                    StringRef hash) -> LoadResult {
+    SmallString<64> key;
+    appendDeclInterfaceHashKey(key, kind, name);
+    declHashes[key] = hash.str();
+    return LoadResult::UpToDate;
+  };
+
+  LoadResult result = parseDependencyFile(buffer, providesCallback,
+                                          dependsCallback,
+                                          interfaceHashCallback,
+                                          declInterfaceHashCallback);
+  if (result == LoadResult::HadError)
+    return result;
+
+  // If the interface changed, work out which of the hashed names it changed.
+  // This is only possible if both the old and new files had hashes.
+  auto &oldDeclHashes = DeclInterfaceHashes[node];
+  ChangedDeclInterfaces.erase(node);
+  if (result == LoadResult::AffectsDownstream && !oldDeclHashes.empty() &&
+      !declHashes.empty()) {
+    auto &changed = ChangedDeclInterfaces[node];
+    for (auto &entry : declHashes) {
+      auto old = oldDeclHashes.find(entry.getKey());
+      if (old == oldDeclHashes.end() || old->getValue() != entry.getValue())
+        changed.insert(entry.getKey());
+    }
+    for (auto &entry : oldDeclHashes)
+      if (!declHashes.count(entry.getKey()))
+        changed.insert(entry.getKey());
+  }
+  oldDeclHashes = std::move(declHashes);
+
+  return result;
+}
+
+bool DependencyGraphImpl::isProvidedEntryUnchanged(
+    const void *node, const ProvidesEntryTy &provided) const {
+  auto changed = ChangedDeclInterfaces.find(node);
+  if (changed == ChangedDeclInterfaces.end())
+    return false;
+  auto hashes = DeclInterfaceHashes.find(node);
+  if (hashes == DeclInterfaceHashes.end())
+    return false;
+
+  auto isUnchanged = [&](DependencyKind kind, StringRef name) -> bool {
+    SmallString<64> key;
+    appendDeclInterfaceHashKey(key, kind, name);
+    return hashes->second.count(key) && !changed->second.count(key);
+  };
+
+  // Every kind of edge with this name has to be covered by a hash. Members
+  // are covered by the hash of the type they belong to.
+  DependencyMaskTy remaining = provided.kindMask;
+  if (remaining.contains(DependencyKind::TopLevelName)) {
+    if (!isUnchanged(DependencyKind::TopLevelName, provided.name))
+      return false;
+    remaining -= DependencyKind::TopLevelName;
+  }
+  if (remaining.contains(DependencyKind::NominalType)) {
+    if (!isUnchanged(DependencyKind::NominalType, provided.name))
+      return false;
+    remaining -= DependencyKind::NominalType;
+  }
+  if (remaining.contains(DependencyKind::NominalTypeMember)) {
+    StringRef baseName = StringRef(provided.name).split('\0').first;
+    if (!isUnchanged(DependencyKind::NominalType, baseName))
+      return false;
+    remaining -= DependencyKind::NominalTypeMember;
+  }
+  return !remaining;
 }
 
 void DependencyGraphImpl::markExternal(SmallVectorImpl<const void *> &visited,
@@ -321,6 +442,14 @@ DependencyGraphImpl::markTransitive(SmallVectorImpl<const void *> &visited,
   SmallVector<WorklistEntry, 16> worklist;
   SmallPtrSet<const void *, 16> visitedSet;
 
+  // If we know which of the starting node's declarations changed when it was
+  // last reloaded, only follow those. Nodes further downstream haven't been
+  // rebuilt yet, so all of their names have to be followed. The same goes
+  // for a starting node that was already marked, since it was taken to be
+  // changing completely.
+  bool onlyChangedDecls = EnableFineGrainedDependencies && !isMarked(node) &&
+                          ChangedDeclInterfaces.count(node);
+
   auto addDependentsToWorklist = [&](const void *next,
                                      ArrayRef<MarkTracerImpl::Entry> reason) {
     auto allProvided = Provides.find(next);
@@ -328,6 +457,11 @@ DependencyGraphImpl::markTransitive(SmallVectorImpl<const void *> &visited,
       return;
 
     for (const auto &provided : allProvided->second) {
+      if (onlyChangedDecls && next == node &&
+          isProvidedEntryUnchanged(next, provided)) {
+        continue;
+      }
+
       auto allDependents = Dependencies.find(provided.name);
       if (allDependents == Dependencies.end())
         continue;
@@ -375,6 +509,7 @@ DependencyGraphImpl::markTransitive(SmallVectorImpl<const void *> &visited,
   // Always mark through the starting node, even if it's already marked.
   markIntransitive(node);
   addDependentsToWorklist(node, {});
+  ChangedDeclInterfaces.erase(node);
 
   while (!worklist.empty()) {
     auto next = worklist.pop_back_val();
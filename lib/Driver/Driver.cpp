@@ -189,6 +189,39 @@ static void computeArgsHash(SmallString<32> &out, const DerivedArgList &args) {
   llvm::MD5::stringifyResult(hashBuf, out);
 }
 
+/// Computes the hash which names the PCH of the bridging header \p header.
+///
+/// The hash covers the contents of the header, the compiler, and the options
+/// which affect how Clang is set up, so that compilations which can't share a
+/// PCH put theirs in different files. Changes to the headers it includes are
+/// picked up by building the PCH again in every build.
+static void computeBridgingPCHHash(SmallString<32> &out, StringRef header,
+                                   const OutputInfo &OI,
+                                   const DerivedArgList &args) {
+  llvm::MD5 hash;
+  if (auto buffer = llvm::MemoryBuffer::getFile(header))
+    hash.update(buffer.get()->getBuffer());
+  hash.update(version::getSwiftFullVersion());
+  hash.update(OI.SDKPath);
+
+  for (const Arg *arg : args.filtered(options::OPT_target,
+                                      options::OPT_target_cpu,
+                                      options::OPT_I, options::OPT_F,
+                                      options::OPT_Xcc,
+                                      options::OPT_Xfrontend,
+                                      options::OPT_module_cache_path,
+                                      options::OPT_resource_dir,
+                                      options::OPT_swift_version)) {
+    hash.update(arg->getOption().getID());
+    for (const char *value : const_cast<Arg *>(arg)->getValues())
+      hash.update(value);
+  }
+
+  llvm::MD5::MD5Result hashBuf;
+  hash.final(hashBuf);
+  llvm::MD5::stringifyResult(hashBuf, out);
+}
+
 class Driver::InputInfoMap
     : public llvm::SmallDenseMap<const Arg *, CompileJobAction::InputInfo, 16> {
 };
@@ -196,7 +229,8 @@ using InputInfoMap = Driver::InputInfoMap;
 
 static bool populateOutOfDateMap(InputInfoMap &map, StringRef argsHashStr,
                                  const InputFileList &inputs,
-                                 StringRef buildRecordPath) {
+                                 StringRef buildRecordPath,
+                                 JobStatisticsMap &jobStats) {
   // Treat a missing file as "no previous build".
   auto buffer = llvm::MemoryBuffer::getFile(buildRecordPath);
   if (!buffer)
@@ -322,6 +356,51 @@ static bool populateOutOfDateMap(InputInfoMap &map, StringRef argsHashStr,
         auto inputName = key->getValue(scratch);
         previousInputs[inputName] = { *previousBuildState, timeValue };
       }
+
+    } else if (keyStr ==
+                 compilation_record::getName(TopLevelKey::JobStatistics)) {
+      auto *statsMap = dyn_cast<yaml::MappingNode>(i->getValue());
+      if (!statsMap)
+        return true;
+
+      // FIXME: LLVM's YAML support does incremental parsing in such a way that
+      // for-range loops break.
+      for (auto i = statsMap->begin(), e = statsMap->end(); i != e; ++i) {
+        auto *key = dyn_cast<yaml::ScalarNode>(i->getKey());
+        if (!key)
+          return true;
+
+        auto *value = dyn_cast<yaml::MappingNode>(i->getValue());
+        if (!value)
+          return true;
+
+        std::string inputName = key->getValue(scratch);
+        JobStatistics stats;
+        for (auto j = value->begin(), je = value->end(); j != je; ++j) {
+          auto *statKey = dyn_cast<yaml::ScalarNode>(j->getKey());
+          auto *statValue = dyn_cast<yaml::ScalarNode>(j->getValue());
+          if (!statKey || !statValue)
+            return true;
+
+          using compilation_record::JobStatisticKey;
+          using compilation_record::getName;
+          StringRef statName = statKey->getValue(scratch);
+          bool malformed = false;
+          if (statName == getName(JobStatisticKey::WallTime)) {
+            malformed = statValue->getValue(scratch)
+                          .getAsInteger(10, stats.WallTimeMillis);
+          } else if (statName == getName(JobStatisticKey::PeakMemory)) {
+            malformed = statValue->getValue(scratch)
+                          .getAsInteger(10, stats.PeakResidentSetSizeKB);
+          } else if (statName == getName(JobStatisticKey::ExitStatus)) {
+            malformed = statValue->getValue(scratch)
+                          .getAsInteger(10, stats.ExitStatus);
+          }
+          if (malformed)
+            return true;
+        }
+        jobStats[inputName] = stats;
+      }
     }
   }
 
@@ -366,6 +445,8 @@ std::unique_ptr<Compilation> Driver::buildCompilation(
     ArgList->hasArg(options::OPT_driver_skip_execution);
   bool ShowIncrementalBuildDecisions =
     ArgList->hasArg(options::OPT_driver_show_incremental);
+  bool EnableFineGrainedDependencies =
+    ArgList->hasArg(options::OPT_enable_fine_grained_dependencies);
 
   bool Incremental = ArgList->hasArg(options::OPT_incremental) &&
     !ArgList->hasArg(options::OPT_whole_module_optimization) &&
@@ -410,6 +491,10 @@ std::unique_ptr<Compilation> Driver::buildCompilation(
   OutputInfo OI;
   buildOutputInfo(*TC, *TranslatedArgList, Inputs, OI);
 
+  // Every frontend job in a standard compile imports the same Clang modules.
+  if (OI.CompilerMode == OutputInfo::Mode::StandardCompile)
+    OI.BuildSessionTimestamp = StartTime.toEpochTime();
+
   if (Diags.hadAnyError())
     return nullptr;
 
@@ -437,6 +522,7 @@ std::unique_ptr<Compilation> Driver::buildCompilation(
   computeArgsHash(ArgsHash, *TranslatedArgList);
 
   InputInfoMap outOfDateMap;
+  JobStatisticsMap previousJobStats;
   bool rebuildEverything = true;
   if (Incremental) {
     if (!OFM) {
@@ -460,7 +546,7 @@ std::unique_ptr<Compilation> Driver::buildCompilation(
 
       } else {
         if (populateOutOfDateMap(outOfDateMap, ArgsHash, Inputs,
-                                 buildRecordPath)) {
+                                 buildRecordPath, previousJobStats)) {
           // FIXME: Distinguish errors from "file removed", which is benign.
         } else {
           rebuildEverything = false;
@@ -492,12 +578,18 @@ std::unique_ptr<Compilation> Driver::buildCompilation(
   }
 
   OutputLevel Level = OutputLevel::Normal;
-  if (const Arg *A = ArgList->getLastArg(options::OPT_v,
-                                         options::OPT_parseable_output)) {
+  bool CompactParseableOutput = false;
+  if (const Arg *A =
+          ArgList->getLastArg(options::OPT_v, options::OPT_parseable_output,
+                              options::OPT_compact_parseable_output)) {
     if (A->getOption().matches(options::OPT_v))
       Level = OutputLevel::Verbose;
     else if (A->getOption().matches(options::OPT_parseable_output))
       Level = OutputLevel::Parseable;
+    else if (A->getOption().matches(options::OPT_compact_parseable_output)) {
+      Level = OutputLevel::Parseable;
+      CompactParseableOutput = true;
+    }
     else
       llvm_unreachable("Unknown OutputLevel argument!");
   }
@@ -526,6 +618,12 @@ std::unique_ptr<Compilation> Driver::buildCompilation(
   if (ShowIncrementalBuildDecisions)
     C->setShowsIncrementalBuildDecisions();
 
+  if (EnableFineGrainedDependencies)
+    C->setEnableFineGrainedDependencies();
+
+  if (CompactParseableOutput)
+    C->setCompactParseableOutput();
+
   // This has to happen after building jobs, because otherwise we won't even
   // emit .swiftdeps files for the next build.
   if (rebuildEverything)
@@ -541,6 +639,10 @@ std::unique_ptr<Compilation> Driver::buildCompilation(
     }
   }
 
+  // Timings are useful for scheduling even if the rest of the record is out
+  // of date.
+  C->setPreviousJobStatistics(std::move(previousJobStats));
+
   if (Diags.hadAnyError())
     return nullptr;
 
@@ -1083,6 +1185,7 @@ void Driver::buildOutputInfo(const ToolChain &TC, const DerivedArgList &Args,
                         [&OI](sys::ProcessId PID,
                               int returnCode,
                               StringRef output,
+                              const sys::TaskResourceUsage &usage,
                               void *unused) -> sys::TaskFinishedResponse {
             if (returnCode == 0) {
               output = output.rtrim();
@@ -1141,6 +1244,23 @@ void Driver::buildActions(const ToolChain &TC,
   ActionList AllModuleInputs;
   ActionList AllLinkerInputs;
 
+  // With a persistent PCH directory, the bridging header is precompiled once,
+  // and each compile action loads the PCH instead of parsing the header.
+  JobAction *PCH = nullptr;
+  if (const Arg *PCHDir = Args.getLastArg(options::OPT_pch_output_dir)) {
+    const Arg *A = Args.getLastArg(options::OPT_import_objc_header);
+    if (A && (OI.CompilerMode == OutputInfo::Mode::StandardCompile ||
+              OI.CompilerMode == OutputInfo::Mode::SingleCompile)) {
+      StringRef Value = A->getValue();
+      if (TC.lookupTypeForExtension(llvm::sys::path::extension(Value)) ==
+            types::TY_ObjCHeader) {
+        PCH = new GeneratePCHJobAction(new InputAction(*A,
+                                                       types::TY_ObjCHeader),
+                                       PCHDir->getValue());
+      }
+    }
+  }
+
   switch (OI.CompilerMode) {
   case OutputInfo::Mode::StandardCompile:
   case OutputInfo::Mode::UpdateCode: {
@@ -1166,6 +1286,8 @@ void Driver::buildActions(const ToolChain &TC,
           Current.reset(new CompileJobAction(Current.release(),
                                              types::TY_LLVM_BC,
                                              previousBuildState));
+          if (PCH)
+            cast<JobAction>(Current.get())->addInput(PCH);
           AllModuleInputs.push_back(Current.get());
           Current.reset(new BackendJobAction(Current.release(),
                                              OI.CompilerOutputType, 0));
@@ -1173,6 +1295,8 @@ void Driver::buildActions(const ToolChain &TC,
           Current.reset(new CompileJobAction(Current.release(),
                                              OI.CompilerOutputType,
                                              previousBuildState));
+          if (PCH)
+            cast<JobAction>(Current.get())->addInput(PCH);
           AllModuleInputs.push_back(Current.get());
         }
         AllLinkerInputs.push_back(Current.release());
@@ -1205,6 +1329,7 @@ void Driver::buildActions(const ToolChain &TC,
       case types::TY_SerializedDiagnostics:
       case types::TY_ObjCHeader:
       case types::TY_ClangModuleFile:
+      case types::TY_PCH:
       case types::TY_SwiftDeps:
       case types::TY_Remapping:
         // We could in theory handle assembly or LLVM input, but let's not.
@@ -1256,6 +1381,8 @@ void Driver::buildActions(const ToolChain &TC,
           }
           InputIndex++;
         }
+        if (PCH)
+          CA->addInput(PCH);
         Action *CAReleased = CA.release();
         if (!OI.isMultiThreading()) {
           // No multi-threading: the compilation only produces a single output
@@ -1276,6 +1403,8 @@ void Driver::buildActions(const ToolChain &TC,
 
       CA->addInput(new InputAction(*InputArg, InputType));
     }
+    if (PCH)
+      CA->addInput(PCH);
     AllModuleInputs.push_back(CA.get());
     AllLinkerInputs.push_back(CA.release());
     break;
@@ -1438,7 +1567,11 @@ void Driver::buildJobs(const ActionList &Actions, const OutputInfo &OI,
         // outputs which are produced before the llvm passes (e.g. emit-sil).
         if (OI.isMultiThreading() && isa<CompileJobAction>(A) &&
             types::isAfterLLVM(A->getType())) {
-          NumOutputs += cast<CompileJobAction>(A)->size();
+          auto *CA = cast<CompileJobAction>(A);
+          NumOutputs += std::count_if(CA->begin(), CA->end(),
+                                      [](const Action *Input) {
+                                        return isa<InputAction>(Input);
+                                      });
         } else {
           ++NumOutputs;
         }
@@ -1505,6 +1638,18 @@ static StringRef getOutputFilename(Compilation &C,
     }
   }
 
+  // The bridging PCH is never treated as top-level either. It is shared by
+  // builds with the same header and options.
+  if (auto *PCHAct = dyn_cast<GeneratePCHJobAction>(JA)) {
+    SmallString<32> Hash;
+    computeBridgingPCHHash(Hash, BaseInput, OI, Args);
+    Buffer = PCHAct->getPersistentPCHDir();
+    llvm::sys::path::append(Buffer, llvm::sys::path::stem(BaseInput) + "-" +
+                                    Hash + "." +
+                                    types::getTypeTempSuffix(JA->getType()));
+    return Buffer.str();
+  }
+
   // dSYM actions are never treated as top-level.
   if (isa<GenerateDSYMJobAction>(JA)) {
     Buffer = InputJobs.front()->getOutput().getPrimaryOutputFilename();
@@ -1729,8 +1874,11 @@ Job *Driver::buildJobsForAction(Compilation &C, const JobAction *JA,
       OutputFunc(IA->getInputArg().getValue());
 
     }
-    // Add an output file for each input job.
+    // Add an output file for each input job. The bridging PCH is only loaded
+    // by the compilation, it doesn't produce an output of its own.
     for (const Job *job : InputJobs) {
+      if (isa<GeneratePCHJobAction>(job->getSource()))
+        continue;
       OutputFunc(job->getOutput().getBaseInput(0));
     }
   } else {
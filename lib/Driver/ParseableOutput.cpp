@@ -97,20 +97,51 @@ public:
       Message(Kind, Cmd.getSource().getClassName()) {}
 };
 
+class InputsMessage : public Message {
+  SmallVector<CommandInput, 16> Inputs;
+  std::string Filelist;
+public:
+  InputsMessage(ArrayRef<const llvm::opt::Arg *> InputArgs,
+                const char *FilelistPath)
+      : Message("inputs", "compilation") {
+    for (const llvm::opt::Arg *InputArg : InputArgs)
+      Inputs.push_back(CommandInput(InputArg->getValue()));
+    if (FilelistPath)
+      Filelist = FilelistPath;
+  }
+
+  virtual void provideMapping(swift::json::Output &out) {
+    Message::provideMapping(out);
+    out.mapRequired("inputs", Inputs);
+    out.mapOptional("filelist", Filelist, std::string());
+  }
+};
+
 class DetailedCommandBasedMessage : public CommandBasedMessage {
   std::string CommandLine;
+  SmallVector<unsigned, 4> InputIndices;
   SmallVector<CommandInput, 4> Inputs;
   SmallVector<OutputPair, 8> Outputs;
 public:
-  DetailedCommandBasedMessage(StringRef Kind, const Job &Cmd) :
+  DetailedCommandBasedMessage(StringRef Kind, const Job &Cmd,
+                              const InputIndexMap *Indices) :
       CommandBasedMessage(Kind, Cmd) {
     llvm::raw_string_ostream wrapper(CommandLine);
     Cmd.printCommandLine(wrapper, "");
     wrapper.flush();
 
     for (const Action *A : Cmd.getSource().getInputs()) {
-      if (const InputAction *IA = dyn_cast<InputAction>(A))
-        Inputs.push_back(CommandInput(IA->getInputArg().getValue()));
+      const InputAction *IA = dyn_cast<InputAction>(A);
+      if (!IA)
+        continue;
+      if (Indices) {
+        auto Found = Indices->find(&IA->getInputArg());
+        if (Found != Indices->end()) {
+          InputIndices.push_back(Found->second);
+          continue;
+        }
+      }
+      Inputs.push_back(CommandInput(IA->getInputArg().getValue()));
     }
 
     for (const Job *J : Cmd.getInputs()) {
@@ -143,6 +174,7 @@ public:
   virtual void provideMapping(swift::json::Output &out) {
     Message::provideMapping(out);
     out.mapRequired("command", CommandLine);
+    out.mapOptional("input-indices", InputIndices);
     out.mapOptional("inputs", Inputs);
     out.mapOptional("outputs", Outputs);
   }
@@ -163,8 +195,8 @@ public:
 class BeganMessage : public DetailedCommandBasedMessage {
   ProcessId Pid;
 public:
-  BeganMessage(const Job &Cmd, ProcessId Pid) :
-      DetailedCommandBasedMessage("began", Cmd), Pid(Pid) {}
+  BeganMessage(const Job &Cmd, ProcessId Pid, const InputIndexMap *Indices) :
+      DetailedCommandBasedMessage("began", Cmd, Indices), Pid(Pid) {}
 
   virtual void provideMapping(swift::json::Output &out) {
     DetailedCommandBasedMessage::provideMapping(out);
@@ -215,8 +247,8 @@ public:
 
 class SkippedMessage : public DetailedCommandBasedMessage {
 public:
-  SkippedMessage(const Job &Cmd) :
-      DetailedCommandBasedMessage("skipped", Cmd) {}
+  SkippedMessage(const Job &Cmd, const InputIndexMap *Indices) :
+      DetailedCommandBasedMessage("skipped", Cmd, Indices) {}
 };
 
 }
@@ -244,9 +276,19 @@ static void emitMessage(raw_ostream &os, Message &msg) {
   os << JSONString << '\n';
 }
 
+void parseable_output::emitInputsMessage(
+    raw_ostream &os, ArrayRef<const llvm::opt::Arg *> Inputs,
+    const char *FilelistPath, InputIndexMap &Indices) {
+  for (unsigned i = 0, e = Inputs.size(); i != e; ++i)
+    Indices.insert({Inputs[i], i});
+  InputsMessage msg(Inputs, FilelistPath);
+  emitMessage(os, msg);
+}
+
 void parseable_output::emitBeganMessage(raw_ostream &os,
-                                        const Job &Cmd, ProcessId Pid) {
-  BeganMessage msg(Cmd, Pid);
+                                        const Job &Cmd, ProcessId Pid,
+                                        const InputIndexMap *Indices) {
+  BeganMessage msg(Cmd, Pid, Indices);
   emitMessage(os, msg);
 }
 
@@ -265,7 +307,8 @@ void parseable_output::emitSignalledMessage(raw_ostream &os,
   emitMessage(os, msg);
 }
 
-void parseable_output::emitSkippedMessage(raw_ostream &os, const Job &Cmd) {
-  SkippedMessage msg(Cmd);
+void parseable_output::emitSkippedMessage(raw_ostream &os, const Job &Cmd,
+                                          const InputIndexMap *Indices) {
+  SkippedMessage msg(Cmd, Indices);
   emitMessage(os, msg);
 }
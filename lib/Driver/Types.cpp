@@ -85,6 +85,7 @@ bool types::isTextual(ID Id) {
   case types::TY_LLVM_BC:
   case types::TY_SerializedDiagnostics:
   case types::TY_ClangModuleFile:
+  case types::TY_PCH:
   case types::TY_SwiftDeps:
   case types::TY_Nothing:
   case types::TY_Remapping:
@@ -115,6 +116,7 @@ bool types::isAfterLLVM(ID Id) {
   case types::TY_SwiftModuleDocFile:
   case types::TY_SerializedDiagnostics:
   case types::TY_ClangModuleFile:
+  case types::TY_PCH:
   case types::TY_SwiftDeps:
   case types::TY_Nothing:
   case types::TY_Remapping:
@@ -145,6 +147,7 @@ bool types::isPartOfSwiftCompilation(ID Id) {
   case types::TY_SwiftModuleDocFile:
   case types::TY_SerializedDiagnostics:
   case types::TY_ClangModuleFile:
+  case types::TY_PCH:
   case types::TY_SwiftDeps:
   case types::TY_Nothing:
   case types::TY_Remapping:
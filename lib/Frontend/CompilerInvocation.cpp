@@ -167,13 +167,21 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
   Opts.EmitSortedSIL |= Args.hasArg(OPT_emit_sorted_sil);
 
   Opts.DelayedFunctionBodyParsing |= Args.hasArg(OPT_delayed_function_body_parsing);
+  Opts.SkipNonPrimaryFunctionBodies |=
+    Args.hasArg(OPT_skip_non_primary_function_bodies);
+  Opts.SkipNonInlinableFunctionBodies |=
+    Args.hasArg(OPT_experimental_skip_non_inlinable_function_bodies);
   Opts.EnableTesting |= Args.hasArg(OPT_enable_testing);
   Opts.EnableResilience |= Args.hasArg(OPT_enable_resilience);
 
   Opts.PrintStats |= Args.hasArg(OPT_print_stats);
   Opts.PrintClangStats |= Args.hasArg(OPT_print_clang_stats);
   Opts.DebugTimeFunctionBodies |= Args.hasArg(OPT_debug_time_function_bodies);
+  Opts.DebugTimeExpressionTypeChecking |=
+    Args.hasArg(OPT_debug_time_expression_type_checking);
   Opts.DebugTimeCompilation |= Args.hasArg(OPT_debug_time_compilation);
+  if (const Arg *A = Args.getLastArg(OPT_trace_output))
+    Opts.TraceOutputPath = A->getValue();
 
   if (const Arg *A = Args.getLastArg(OPT_warn_long_function_bodies)) {
     unsigned attempt;
@@ -202,13 +210,30 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
   }
 
   if (const Arg *A = Args.getLastArg(OPT_filelist)) {
-    const Arg *primaryFileArg = Args.getLastArg(OPT_primary_file);
+    SmallVector<const Arg *, 4> primaryFileArgs(
+      Args.filtered_begin(OPT_primary_file), Args.filtered_end());
+    const Arg *primaryFileArg =
+      primaryFileArgs.empty() ? nullptr : primaryFileArgs.front();
     unsigned primaryFileIndex = 0;
     if (readFileList(Diags, Opts.InputFilenames, A,
                      primaryFileArg, &primaryFileIndex)) {
       if (primaryFileArg)
         Opts.PrimaryInput = SelectedInput(primaryFileIndex);
       assert(!Args.hasArg(OPT_INPUT) && "mixing -filelist with inputs");
+
+      // Any further primary files make this a batch.
+      for (unsigned i = 1, e = primaryFileArgs.size(); i < e; ++i) {
+        StringRef batchFile = primaryFileArgs[i]->getValue();
+        auto found = std::find(Opts.InputFilenames.begin(),
+                               Opts.InputFilenames.end(), batchFile);
+        if (found == Opts.InputFilenames.end()) {
+          Diags.diagnose(SourceLoc(), diag::error_primary_file_not_found,
+                         batchFile, A->getValue());
+          return true;
+        }
+        Opts.AdditionalPrimaryInputs.push_back(
+          SelectedInput(found - Opts.InputFilenames.begin()));
+      }
     }
   } else {
     for (const Arg *A : make_range(Args.filtered_begin(OPT_INPUT,
@@ -217,7 +242,11 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
       if (A->getOption().matches(OPT_INPUT)) {
         Opts.InputFilenames.push_back(A->getValue());
       } else if (A->getOption().matches(OPT_primary_file)) {
-        Opts.PrimaryInput = SelectedInput(Opts.InputFilenames.size());
+        SelectedInput input(Opts.InputFilenames.size());
+        if (Opts.PrimaryInput)
+          Opts.AdditionalPrimaryInputs.push_back(input);
+        else
+          Opts.PrimaryInput = input;
         Opts.InputFilenames.push_back(A->getValue());
       } else {
         llvm_unreachable("Unknown input-related argument!");
@@ -287,6 +316,8 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
       Action = FrontendOptions::DumpTypeRefinementContexts;
     } else if (Opt.matches(OPT_dump_interface_hash)) {
       Action = FrontendOptions::DumpInterfaceHash;
+    } else if (Opt.matches(OPT_emit_pch)) {
+      Action = FrontendOptions::EmitPCH;
     } else if (Opt.matches(OPT_print_ast)) {
       Action = FrontendOptions::PrintAST;
     } else if (Opt.matches(OPT_repl) ||
@@ -487,6 +518,10 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
       Suffix = SERIALIZED_MODULE_EXTENSION;
       break;
 
+    case FrontendOptions::EmitPCH:
+      Suffix = PCH_EXTENSION;
+      break;
+
     case FrontendOptions::Immediate:
     case FrontendOptions::REPL:
       // These modes have no frontend-generated output.
@@ -655,6 +690,7 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     case FrontendOptions::PrintAST:
     case FrontendOptions::DumpScopeMaps:
     case FrontendOptions::DumpTypeRefinementContexts:
+    case FrontendOptions::EmitPCH:
     case FrontendOptions::Immediate:
     case FrontendOptions::REPL:
       Diags.diagnose(SourceLoc(), diag::error_mode_cannot_emit_dependencies);
@@ -673,6 +709,35 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     }
   }
 
+  if (Opts.SkipNonInlinableFunctionBodies) {
+    switch (Opts.RequestedAction) {
+    case FrontendOptions::NoneAction:
+    case FrontendOptions::Parse:
+    case FrontendOptions::DumpParse:
+    case FrontendOptions::DumpInterfaceHash:
+    case FrontendOptions::DumpAST:
+    case FrontendOptions::PrintAST:
+    case FrontendOptions::DumpScopeMaps:
+    case FrontendOptions::DumpTypeRefinementContexts:
+    case FrontendOptions::EmitModuleOnly:
+    case FrontendOptions::EmitPCH:
+      break;
+    case FrontendOptions::EmitSILGen:
+    case FrontendOptions::EmitSIL:
+    case FrontendOptions::EmitSIBGen:
+    case FrontendOptions::EmitSIB:
+    case FrontendOptions::EmitIR:
+    case FrontendOptions::EmitBC:
+    case FrontendOptions::EmitAssembly:
+    case FrontendOptions::EmitObject:
+    case FrontendOptions::Immediate:
+    case FrontendOptions::REPL:
+      Diags.diagnose(SourceLoc(),
+                     diag::error_mode_cannot_skip_function_bodies);
+      return true;
+    }
+  }
+
   if (!Opts.ObjCHeaderOutputPath.empty()) {
     switch (Opts.RequestedAction) {
     case FrontendOptions::NoneAction:
@@ -682,6 +747,7 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     case FrontendOptions::PrintAST:
     case FrontendOptions::DumpScopeMaps:
     case FrontendOptions::DumpTypeRefinementContexts:
+    case FrontendOptions::EmitPCH:
     case FrontendOptions::Immediate:
     case FrontendOptions::REPL:
       Diags.diagnose(SourceLoc(), diag::error_mode_cannot_emit_header);
@@ -711,6 +777,7 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     case FrontendOptions::PrintAST:
     case FrontendOptions::DumpScopeMaps:
     case FrontendOptions::DumpTypeRefinementContexts:
+    case FrontendOptions::EmitPCH:
     case FrontendOptions::EmitSILGen:
     case FrontendOptions::Immediate:
     case FrontendOptions::REPL:
@@ -731,6 +798,80 @@ static bool ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     }
   }
 
+  if (Opts.isBatchMode()) {
+    switch (Opts.RequestedAction) {
+    case FrontendOptions::NoneAction:
+    case FrontendOptions::DumpParse:
+    case FrontendOptions::DumpInterfaceHash:
+    case FrontendOptions::DumpAST:
+    case FrontendOptions::PrintAST:
+    case FrontendOptions::DumpScopeMaps:
+    case FrontendOptions::DumpTypeRefinementContexts:
+    case FrontendOptions::EmitModuleOnly:
+    case FrontendOptions::EmitSIBGen:
+    case FrontendOptions::EmitSIB:
+    case FrontendOptions::EmitPCH:
+    case FrontendOptions::Immediate:
+    case FrontendOptions::REPL:
+      Diags.diagnose(SourceLoc(), diag::error_batch_mode_unsupported_action);
+      return true;
+    case FrontendOptions::Parse:
+    case FrontendOptions::EmitSILGen:
+    case FrontendOptions::EmitSIL:
+    case FrontendOptions::EmitIR:
+    case FrontendOptions::EmitBC:
+    case FrontendOptions::EmitAssembly:
+    case FrontendOptions::EmitObject:
+      break;
+    }
+
+    if (Opts.InputKind != InputFileKind::IFK_Swift &&
+        Opts.InputKind != InputFileKind::IFK_Swift_Library) {
+      Diags.diagnose(SourceLoc(), diag::error_batch_mode_unsupported_action);
+      return true;
+    }
+
+    // Only the main output and the reference dependencies can be split up by
+    // primary file so far.
+    const std::pair<const std::string *, StringRef> unsupportedOutputs[] = {
+      { &Opts.DependenciesFilePath, "-emit-dependencies" },
+      { &Opts.SerializedDiagnosticsPath, "-serialize-diagnostics" },
+      { &Opts.ObjCHeaderOutputPath, "-emit-objc-header" },
+      { &Opts.ModuleOutputPath, "-emit-module" },
+      { &Opts.ModuleDocOutputPath, "-emit-module-doc" },
+      { &Opts.FixitsOutputPath, "-emit-fixits-path" },
+    };
+    for (auto &output : unsupportedOutputs) {
+      if (!output.first->empty()) {
+        Diags.diagnose(SourceLoc(), diag::error_batch_mode_unsupported_output,
+                       output.second);
+        return true;
+      }
+    }
+
+    unsigned numPrimaries = Opts.AdditionalPrimaryInputs.size() + 1;
+    if (Opts.RequestedAction != FrontendOptions::Parse &&
+        Opts.OutputFilenames.size() != numPrimaries) {
+      Diags.diagnose(SourceLoc(), diag::error_batch_mode_output_count, "-o",
+                     numPrimaries, Opts.OutputFilenames.size());
+      return true;
+    }
+
+    if (!Opts.ReferenceDependenciesFilePath.empty()) {
+      std::vector<std::string> paths =
+        Args.getAllArgValues(OPT_emit_reference_dependencies_path);
+      if (paths.size() != numPrimaries) {
+        Diags.diagnose(SourceLoc(), diag::error_batch_mode_output_count,
+                       "-emit-reference-dependencies-path", numPrimaries,
+                       paths.size());
+        return true;
+      }
+      Opts.ReferenceDependenciesFilePath = paths.front();
+      Opts.AdditionalReferenceDependenciesFilePaths.assign(paths.begin() + 1,
+                                                           paths.end());
+    }
+  }
+
   if (const Arg *A = Args.getLastArg(OPT_module_link_name)) {
     Opts.ModuleLinkName = A->getValue();
   }
@@ -811,6 +952,8 @@ static bool ParseLangArgs(LangOptions &Opts, ArgList &Args,
   }
   
   Opts.EnableASTScopeLookup |= Args.hasArg(OPT_enable_astscope_lookup);
+  Opts.NamedLazyMemberLoading |=
+    Args.hasArg(OPT_enable_named_lazy_member_loading);
   Opts.DebugConstraintSolver |= Args.hasArg(OPT_debug_constraints);
   Opts.IterativeTypeChecker |= Args.hasArg(OPT_iterative_type_checker);
   Opts.DebugGenericSignatures |= Args.hasArg(OPT_debug_generic_signatures);
@@ -850,6 +993,17 @@ static bool ParseLangArgs(LangOptions &Opts, ArgList &Args,
     Opts.DebugForbidTypecheckPrefix = A->getValue();
   }
 
+  if (const Arg *A = Args.getLastArg(OPT_verifier_workers)) {
+    unsigned workers;
+    if (StringRef(A->getValue()).getAsInteger(10, workers) || workers == 0) {
+      Diags.diagnose(SourceLoc(), diag::error_invalid_arg_value,
+                     A->getAsString(Args), A->getValue());
+      return true;
+    }
+
+    Opts.VerifierWorkerCount = workers;
+  }
+
   if (const Arg *A = Args.getLastArg(OPT_solver_memory_threshold)) {
     unsigned threshold;
     if (StringRef(A->getValue()).getAsInteger(10, threshold)) {
@@ -860,6 +1014,18 @@ static bool ParseLangArgs(LangOptions &Opts, ArgList &Args,
     
     Opts.SolverMemoryThreshold = threshold;
   }
+
+  if (const Arg *A =
+        Args.getLastArg(OPT_solver_expression_time_threshold_EQ)) {
+    unsigned threshold;
+    if (StringRef(A->getValue()).getAsInteger(10, threshold)) {
+      Diags.diagnose(SourceLoc(), diag::error_invalid_arg_value,
+                     A->getAsString(Args), A->getValue());
+      return true;
+    }
+
+    Opts.SolverExpressionTimeThreshold = threshold;
+  }
   
   for (const Arg *A : make_range(Args.filtered_begin(OPT_D),
                                  Args.filtered_end())) {
@@ -913,6 +1079,14 @@ static bool ParseClangImporterArgs(ClangImporterOptions &Opts,
     Opts.ModuleCachePath = A->getValue();
   }
 
+  if (const Arg *A = Args.getLastArg(OPT_clang_build_session_timestamp)) {
+    if (StringRef(A->getValue()).getAsInteger(10, Opts.BuildSessionTimestamp)) {
+      Diags.diagnose(SourceLoc(), diag::error_invalid_arg_value,
+                     A->getAsString(Args), A->getValue());
+      return true;
+    }
+  }
+
   if (const Arg *A = Args.getLastArg(OPT_target_cpu))
     Opts.TargetCPU = A->getValue();
 
@@ -938,6 +1112,9 @@ static bool ParseClangImporterArgs(ClangImporterOptions &Opts,
 
   Opts.DisableSwiftBridgeAttr |= Args.hasArg(OPT_disable_swift_bridge_attr);
 
+  if (const Arg *A = Args.getLastArg(OPT_bridging_header_pch))
+    Opts.BridgingHeaderPCH = A->getValue();
+
   return false;
 }
 
@@ -1063,6 +1240,7 @@ static bool ParseSILArgs(SILOptions &Opts, ArgList &Args,
     else
       llvm_unreachable("Unknown SIL linking option!");
   }
+  Opts.LinkOnDemand |= Args.hasArg(OPT_sil_link_on_demand);
 
   // Parse the optimization level.
   if (const Arg *A = Args.getLastArg(OPT_O_Group)) {
@@ -1118,6 +1296,10 @@ static bool ParseSILArgs(SILOptions &Opts, ArgList &Args,
   Opts.RemoveRuntimeAsserts |= Args.hasArg(OPT_remove_runtime_asserts);
 
   Opts.EnableARCOptimizations |= !Args.hasArg(OPT_disable_arc_opts);
+  Opts.EnableColdCodeOutlining |= Args.hasArg(OPT_enable_cold_code_outlining);
+  Opts.EnableNonAtomicRC |= Args.hasArg(OPT_enable_nonatomic_rc);
+  Opts.EnableCrossModuleOptimization |=
+    Args.hasArg(OPT_enable_cross_module_optimization);
   Opts.DisableSILPerfOptimizations |= Args.hasArg(OPT_disable_sil_perf_optzns);
   Opts.VerifyAll |= Args.hasArg(OPT_sil_verify_all);
   Opts.DebugSerialization |= Args.hasArg(OPT_sil_debug_serialization);
@@ -1128,6 +1310,8 @@ static bool ParseSILArgs(SILOptions &Opts, ArgList &Args,
 
   Opts.GenerateProfile |= Args.hasArg(OPT_profile_generate);
   Opts.EmitProfileCoverageMapping |= Args.hasArg(OPT_profile_coverage_mapping);
+  if (const Arg *A = Args.getLastArg(OPT_profile_use_EQ))
+    Opts.UseProfile = A->getValue();
   Opts.EnableGuaranteedClosureContexts |=
     Args.hasArg(OPT_enable_guaranteed_closure_contexts);
 
@@ -1282,10 +1466,15 @@ static bool ParseIRGenArgs(IRGenOptions &Opts, ArgList &Args,
   Opts.PrintInlineTree |= Args.hasArg(OPT_print_llvm_inline_tree);
 
   Opts.UseSwiftCall = Args.hasArg(OPT_enable_swiftcall);
+  Opts.EnableCopyOutlining |= Args.hasArg(OPT_enable_copy_outlining);
+  Opts.EnableGenericMetadataPrespecialization |=
+    Args.hasArg(OPT_enable_generic_metadata_prespecialization);
 
   // This is set to true by default.
   Opts.UseIncrementalLLVMCodeGen &=
     !Args.hasArg(OPT_disable_incremental_llvm_codegeneration);
+  if (const Arg *A = Args.getLastArg(OPT_llvm_object_cache_path))
+    Opts.LLVMObjectCachePath = A->getValue();
 
   if (Args.hasArg(OPT_embed_bitcode))
     Opts.EmbedMode = IRGenEmbedMode::EmbedBitcode;
@@ -1334,6 +1523,29 @@ static bool ParseIRGenArgs(IRGenOptions &Opts, ArgList &Args,
     Opts.EnableReflectionNames = false;
   }
 
+  if (Args.hasArg(OPT_strip_unused_type_records))
+    Opts.StripUnusedTypeRecords = true;
+
+  if (const Arg *A = Args.getLastArg(OPT_max_direct_result_scalars)) {
+    unsigned max;
+    if (StringRef(A->getValue()).getAsInteger(10, max) || max == 0) {
+      Diags.diagnose(SourceLoc(), diag::error_invalid_arg_value,
+                     A->getAsString(Args), A->getValue());
+      return true;
+    }
+    Opts.MaxScalarsForDirectResult = max;
+  }
+
+  if (const Arg *A = Args.getLastArg(OPT_max_direct_parameter_scalars)) {
+    unsigned max;
+    if (StringRef(A->getValue()).getAsInteger(10, max) || max == 0) {
+      Diags.diagnose(SourceLoc(), diag::error_invalid_arg_value,
+                     A->getAsString(Args), A->getValue());
+      return true;
+    }
+    Opts.MaxScalarsForDirectParameter = max;
+  }
+
   for (const auto &Lib : Args.getAllArgValues(options::OPT_autolink_library))
     Opts.LinkLibraries.push_back(LinkLibrary(Lib, LibraryKind::Library));
 
@@ -52,6 +52,44 @@ void CompilerInstance::setPrimarySourceFile(SourceFile *SF) {
   PrimarySourceFile->setReferencedNameTracker(NameTracker);
 }
 
+bool CompilerInstance::isPrimaryBuffer(unsigned BufferID) const {
+  if (PrimaryBufferID == NO_SUCH_BUFFER || BufferID == PrimaryBufferID)
+    return true;
+  return std::find(AdditionalPrimaryBufferIDs.begin(),
+                   AdditionalPrimaryBufferIDs.end(),
+                   BufferID) != AdditionalPrimaryBufferIDs.end();
+}
+
+bool CompilerInstance::isPrimarySourceFile(const SourceFile *SF) const {
+  if (PrimaryBufferID == NO_SUCH_BUFFER || SF == PrimarySourceFile)
+    return true;
+  return std::find(AdditionalPrimarySourceFiles.begin(),
+                   AdditionalPrimarySourceFiles.end(),
+                   SF) != AdditionalPrimarySourceFiles.end();
+}
+
+void CompilerInstance::notePrimarySourceFile(SourceFile *SF,
+                                             unsigned BufferID) {
+  if (BufferID == PrimaryBufferID) {
+    setPrimarySourceFile(SF);
+    return;
+  }
+
+  auto found = std::find(AdditionalPrimaryBufferIDs.begin(),
+                         AdditionalPrimaryBufferIDs.end(), BufferID);
+  if (found == AdditionalPrimaryBufferIDs.end())
+    return;
+
+  // Keep the files in the same order as their buffers, which is the order of
+  // the -primary-file arguments.
+  unsigned index = found - AdditionalPrimaryBufferIDs.begin();
+  if (AdditionalPrimarySourceFiles.size() <= index)
+    AdditionalPrimarySourceFiles.resize(index + 1);
+  AdditionalPrimarySourceFiles[index] = SF;
+  if (index < AdditionalNameTrackers.size())
+    SF->setReferencedNameTracker(AdditionalNameTrackers[index]);
+}
+
 bool CompilerInstance::setup(const CompilerInvocation &Invok) {
   Invocation = Invok;
 
@@ -132,6 +170,19 @@ bool CompilerInstance::setup(const CompilerInvocation &Invok) {
 
   const Optional<SelectedInput> &PrimaryInput =
     Invocation.getFrontendOptions().PrimaryInput;
+  ArrayRef<SelectedInput> AdditionalPrimaryInputs =
+    Invocation.getFrontendOptions().AdditionalPrimaryInputs;
+  AdditionalPrimaryBufferIDs.assign(AdditionalPrimaryInputs.size(),
+                                    NO_SUCH_BUFFER);
+
+  auto recordAdditionalPrimary = [&](bool isBuffer, unsigned index,
+                                     unsigned BufferID) {
+    for (unsigned i = 0, e = AdditionalPrimaryInputs.size(); i != e; ++i) {
+      const SelectedInput &input = AdditionalPrimaryInputs[i];
+      if (input.isBuffer() == isBuffer && input.Index == index)
+        AdditionalPrimaryBufferIDs[i] = BufferID;
+    }
+  };
 
   // Add the memory buffers first, these will be associated with a filename
   // and they can replace the contents of an input filename.
@@ -152,6 +203,7 @@ bool CompilerInstance::setup(const CompilerInvocation &Invok) {
 
       if (PrimaryInput && PrimaryInput->isBuffer() && PrimaryInput->Index == i)
         PrimaryBufferID = BufferID;
+      recordAdditionalPrimary(/*isBuffer*/true, i, BufferID);
     }
   }
 
@@ -169,6 +221,8 @@ bool CompilerInstance::setup(const CompilerInvocation &Invok) {
       if (PrimaryInput && PrimaryInput->isFilename() &&
           PrimaryInput->Index == i)
         PrimaryBufferID = ExistingBufferID.getValue();
+      recordAdditionalPrimary(/*isBuffer*/false, i,
+                              ExistingBufferID.getValue());
 
       continue; // replaced by a memory buffer.
     }
@@ -211,6 +265,7 @@ bool CompilerInstance::setup(const CompilerInvocation &Invok) {
 
     if (PrimaryInput && PrimaryInput->isFilename() && PrimaryInput->Index == i)
       PrimaryBufferID = BufferID;
+    recordAdditionalPrimary(/*isBuffer*/false, i, BufferID);
   }
 
   // Set the primary file to the code-completion point if one exists.
@@ -383,6 +438,16 @@ void CompilerInstance::performSema() {
     DelayedCB.reset(new AlwaysDelayedCallbacks);
   }
 
+  // Only the declarations of non-primary files are needed, so their function
+  // bodies can optionally be skipped without being parsed.
+  AlwaysSkippedCallbacks SkipBodiesCB;
+  auto getParsingCallbacks = [&](bool IsPrimary) -> DelayedParsingCallbacks * {
+    if (!DelayedCB && !IsPrimary &&
+        Invocation.getFrontendOptions().SkipNonPrimaryFunctionBodies)
+      return &SkipBodiesCB;
+    return DelayedCB.get();
+  };
+
   PersistentParserState PersistentState;
 
   // Make sure the main file is the first file in the module. This may only be
@@ -401,8 +466,7 @@ void CompilerInstance::performSema() {
     MainModule->addFile(*MainFile);
     addAdditionalInitialImports(MainFile);
 
-    if (MainBufferID == PrimaryBufferID)
-      setPrimarySourceFile(MainFile);
+    notePrimarySourceFile(MainFile, MainBufferID);
   }
 
   bool hadLoadError = false;
@@ -427,13 +491,11 @@ void CompilerInstance::performSema() {
     MainModule->addFile(*NextInput);
     addAdditionalInitialImports(NextInput);
 
-    if (BufferID == PrimaryBufferID)
-      setPrimarySourceFile(NextInput);
+    notePrimarySourceFile(NextInput, BufferID);
 
     auto &Diags = NextInput->getASTContext().Diags;
     auto DidSuppressWarnings = Diags.getSuppressWarnings();
-    auto IsPrimary
-      = PrimaryBufferID == NO_SUCH_BUFFER || BufferID == PrimaryBufferID;
+    auto IsPrimary = isPrimaryBuffer(BufferID);
     Diags.setSuppressWarnings(DidSuppressWarnings || !IsPrimary);
 
     bool Done;
@@ -441,7 +503,7 @@ void CompilerInstance::performSema() {
       // Parser may stop at some erroneous constructions like #else, #endif
       // or '}' in some cases, continue parsing until we are done
       parseIntoSourceFile(*NextInput, BufferID, &Done, nullptr,
-                          &PersistentState, DelayedCB.get());
+                          &PersistentState, getParsingCallbacks(IsPrimary));
     } while (!Done);
 
     Diags.setSuppressWarnings(DidSuppressWarnings);
@@ -468,14 +530,20 @@ void CompilerInstance::performSema() {
   if (options.DebugTimeFunctionBodies) {
     TypeCheckOptions |= TypeCheckingFlags::DebugTimeFunctionBodies;
   }
+  if (options.DebugTimeExpressionTypeChecking) {
+    TypeCheckOptions |= TypeCheckingFlags::DebugTimeExpressions;
+  }
   if (options.actionIsImmediate()) {
     TypeCheckOptions |= TypeCheckingFlags::ForImmediateMode;
   }
+  // With -sil-serialize-all, every body ends up in the module.
+  if (options.SkipNonInlinableFunctionBodies && !options.SILSerializeAll) {
+    TypeCheckOptions |= TypeCheckingFlags::SkipNonInlinableFunctionBodies;
+  }
 
   // Parse the main file last.
   if (MainBufferID != NO_SUCH_BUFFER) {
-    bool mainIsPrimary =
-      (PrimaryBufferID == NO_SUCH_BUFFER || MainBufferID == PrimaryBufferID);
+    bool mainIsPrimary = isPrimaryBuffer(MainBufferID);
 
     SourceFile &MainFile =
       MainModule->getMainSourceFile(Invocation.getSourceFileKind());
@@ -494,7 +562,9 @@ void CompilerInstance::performSema() {
       // with 'sil' definitions.
       parseIntoSourceFile(MainFile, MainFile.getBufferID().getValue(), &Done,
                           TheSILModule ? &SILContext : nullptr,
-                          &PersistentState, DelayedCB.get());
+                          &PersistentState,
+                          getParsingCallbacks(mainIsPrimary ||
+                                              Kind == InputFileKind::IFK_SIL));
       if (mainIsPrimary) {
         performTypeChecking(MainFile, PersistentState.getTopLevelContext(),
                             TypeCheckOptions, CurTUElem,
@@ -515,7 +585,7 @@ void CompilerInstance::performSema() {
   // Type-check each top-level input besides the main source file.
   for (auto File : MainModule->getFiles())
     if (auto SF = dyn_cast<SourceFile>(File))
-      if (PrimaryBufferID == NO_SUCH_BUFFER || SF == PrimarySourceFile)
+      if (isPrimarySourceFile(SF))
         performTypeChecking(*SF, PersistentState.getTopLevelContext(),
                             TypeCheckOptions, /*curElem*/0,
                             options.WarnLongFunctionBodies);
@@ -539,7 +609,7 @@ void CompilerInstance::performSema() {
 
   for (auto File : MainModule->getFiles())
     if (auto SF = dyn_cast<SourceFile>(File))
-      if (PrimaryBufferID == NO_SUCH_BUFFER || SF == PrimarySourceFile)
+      if (isPrimarySourceFile(SF))
         finishTypeChecking(*SF);
 }
 
@@ -37,6 +37,8 @@
 #include "swift/Basic/LLVMContext.h"
 #include "swift/Basic/SourceManager.h"
 #include "swift/Basic/Timer.h"
+#include "swift/Basic/Trace.h"
+#include "swift/ClangImporter/ClangImporter.h"
 #include "swift/Frontend/DiagnosticVerifier.h"
 #include "swift/Frontend/Frontend.h"
 #include "swift/Frontend/PrintingDiagnosticConsumer.h"
@@ -199,11 +201,135 @@ static std::string mangleTypeAsContext(const NominalTypeDecl *type) {
   return mangler.finalize();
 }
 
+namespace {
+/// Accumulates the interface hashes of the declarations that provide one
+/// name in a dependencies file.
+struct ProvidedNameHash {
+  std::string DeclHashes;
+  bool IsComplete = true;
+
+  void add(StringRef declHash) {
+    if (declHash.empty())
+      IsComplete = false;
+    DeclHashes += declHash;
+  }
+};
+} // end anonymous namespace
+
+/// Emits the interface hashes of the individual names \p SF provides, so the
+/// driver can tell which of them an edit changed.
+///
+/// Each hash also covers the file's imports, which affect how all of its
+/// declarations are interpreted. A name is left out if any declaration
+/// providing it wasn't hashed; the driver then assumes it changes whenever
+/// the file's interface hash does.
+static void
+emitDeclInterfaceHashes(raw_ostream &out, const SourceFile *SF,
+                        ArrayRef<const FuncDecl *> memberOperatorDecls) {
+  ProvidedNameHash imports;
+  llvm::MapVector<Identifier, ProvidedNameHash> topLevelNames;
+  llvm::MapVector<const NominalTypeDecl *, ProvidedNameHash> nominals;
+
+  auto isPrivate = [](const ValueDecl *VD) -> bool {
+    return VD->hasAccessibility() &&
+           VD->getFormalAccess() <= Accessibility::FilePrivate;
+  };
+
+  for (const Decl *D : SF->Decls) {
+    StringRef hash = SF->getDeclInterfaceHash(D);
+    switch (D->getKind()) {
+    case DeclKind::Import:
+      imports.add(hash);
+      break;
+
+    case DeclKind::Extension: {
+      auto *NTD = cast<ExtensionDecl>(D)->getExtendedType()->getAnyNominal();
+      if (NTD && !isPrivate(NTD))
+        nominals[NTD].add(hash);
+      break;
+    }
+
+    case DeclKind::InfixOperator:
+    case DeclKind::PrefixOperator:
+    case DeclKind::PostfixOperator:
+      topLevelNames[cast<OperatorDecl>(D)->getName()].add(hash);
+      break;
+
+    case DeclKind::PrecedenceGroup:
+      topLevelNames[cast<PrecedenceGroupDecl>(D)->getName()].add(hash);
+      break;
+
+    case DeclKind::Enum:
+    case DeclKind::Struct:
+    case DeclKind::Class:
+    case DeclKind::Protocol: {
+      auto *NTD = cast<NominalTypeDecl>(D);
+      if (!NTD->hasName() || isPrivate(NTD))
+        break;
+      topLevelNames[NTD->getName()].add(hash);
+      nominals[NTD].add(hash);
+      break;
+    }
+
+    case DeclKind::TypeAlias:
+    case DeclKind::Var:
+    case DeclKind::Func: {
+      auto *VD = cast<ValueDecl>(D);
+      if (!VD->hasName() || isPrivate(VD))
+        break;
+      topLevelNames[VD->getName()].add(hash);
+      break;
+    }
+
+    default:
+      // Nothing else provides names to other files.
+      break;
+    }
+  }
+
+  // Operator functions declared inside types are provided at the top level,
+  // but aren't hashed on their own.
+  for (auto *operatorFunction : memberOperatorDecls)
+    topLevelNames[operatorFunction->getName()].IsComplete = false;
+
+  if (!imports.IsComplete)
+    return;
+
+  auto printHash = [&](const ProvidedNameHash &entry) {
+    llvm::MD5 hash;
+    hash.update(imports.DeclHashes);
+    hash.update(entry.DeclHashes);
+    llvm::MD5::MD5Result result;
+    hash.final(result);
+    llvm::SmallString<32> str;
+    llvm::MD5::stringifyResult(result, str);
+    out << "\"" << str << "\"";
+  };
+
+  out << "interface-hash-top-level:\n";
+  for (auto &entry : topLevelNames) {
+    if (!entry.second.IsComplete)
+      continue;
+    out << "- [\"" << llvm::yaml::escape(entry.first.str()) << "\", ";
+    printHash(entry.second);
+    out << "]\n";
+  }
+
+  out << "interface-hash-nominal:\n";
+  for (auto &entry : nominals) {
+    if (!entry.second.IsComplete)
+      continue;
+    out << "- [\"" << mangleTypeAsContext(entry.first) << "\", ";
+    printHash(entry.second);
+    out << "]\n";
+  }
+}
+
 /// Emits a Swift-style dependencies file.
 static bool emitReferenceDependencies(DiagnosticEngine &diags,
                                       SourceFile *SF,
                                       DependencyTracker &depTracker,
-                                      const FrontendOptions &opts) {
+                                      StringRef outputPath) {
   if (!SF) {
     diags.diagnose(SourceLoc(),
                    diag::emit_reference_dependencies_without_primary_file);
@@ -211,12 +337,11 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
   }
 
   std::error_code EC;
-  llvm::raw_fd_ostream out(opts.ReferenceDependenciesFilePath, EC,
-                           llvm::sys::fs::F_None);
+  llvm::raw_fd_ostream out(outputPath, EC, llvm::sys::fs::F_None);
 
   if (out.has_error() || EC) {
-    diags.diagnose(SourceLoc(), diag::error_opening_output,
-                   opts.ReferenceDependenciesFilePath, EC.message());
+    diags.diagnose(SourceLoc(), diag::error_opening_output, outputPath,
+                   EC.message());
     out.clear_error();
     return true;
   }
@@ -474,6 +599,8 @@ static bool emitReferenceDependencies(DiagnosticEngine &diags,
   SF->getInterfaceHash(interfaceHash);
   out << "interface-hash: \"" << interfaceHash << "\"\n";
 
+  emitDeclInterfaceHashes(out, SF, memberOperatorDecls);
+
   return false;
 }
 
@@ -696,6 +823,240 @@ static void debugFailWithCrash() {
   LLVM_BUILTIN_TRAP;
 }
 
+/// Runs the SIL passes on \p SM and then performs the requested action for
+/// \p PrimarySourceFile, or for the whole module if it is null, writing the
+/// result to \p OutputFilename.
+///
+/// \returns true on error
+static bool performCompileStepsPostSILGen(CompilerInstance &Instance,
+                                          CompilerInvocation &Invocation,
+                                          std::unique_ptr<SILModule> SM,
+                                          SourceFile *PrimarySourceFile,
+                                          StringRef OutputFilename,
+                                          IRGenOptions &IRGenOpts,
+                                          bool moduleIsPublic,
+                                          int &ReturnValue,
+                                          FrontendObserver *observer) {
+  const FrontendOptions &opts = Invocation.getFrontendOptions();
+  FrontendOptions::ActionType Action = opts.RequestedAction;
+  ASTContext &Context = Instance.getASTContext();
+
+  if (observer) {
+    observer->performedSILGeneration(*SM);
+  }
+
+  // We've been told to emit SIL after SILGen, so write it now.
+  if (Action == FrontendOptions::EmitSILGen) {
+    // If we are asked to link all, link all.
+    if (Invocation.getSILOptions().LinkMode == SILOptions::LinkAll)
+      performSILLinking(SM.get(), true);
+    return writeSIL(*SM, Instance.getMainModule(), opts.EmitVerboseSIL,
+                    OutputFilename, opts.EmitSortedSIL);
+  }
+
+  if (Action == FrontendOptions::EmitSIBGen) {
+    // If we are asked to link all, link all.
+    if (Invocation.getSILOptions().LinkMode == SILOptions::LinkAll)
+      performSILLinking(SM.get(), true);
+
+    auto DC = PrimarySourceFile ? ModuleOrSourceFile(PrimarySourceFile) :
+                                  Instance.getMainModule();
+    if (!opts.ModuleOutputPath.empty()) {
+      SerializationOptions serializationOpts;
+      serializationOpts.OutputPath = opts.ModuleOutputPath.c_str();
+      serializationOpts.SerializeAllSIL = true;
+      serializationOpts.IsSIB = true;
+
+      serialize(DC, serializationOpts, SM.get());
+    }
+    return false;
+  }
+
+  // Perform "stable" optimizations that are invariant across compiler versions.
+  if (!Invocation.getDiagnosticOptions().SkipDiagnosticPasses) {
+    if (runSILDiagnosticPasses(*SM))
+      return true;
+
+    if (observer) {
+      observer->performedSILDiagnostics(*SM);
+    }
+  }
+
+  // Now if we are asked to link all, link all.
+  if (Invocation.getSILOptions().LinkMode == SILOptions::LinkAll)
+    performSILLinking(SM.get(), true);
+
+  {
+    SharedTimer timer("SIL verification (pre-optimization)");
+    SM->verify();
+  }
+
+  // Perform SIL optimization passes if optimizations haven't been disabled.
+  // These may change across compiler versions.
+  {
+    SharedTimer timer("SIL optimization");
+    if (Invocation.getSILOptions().Optimization >
+        SILOptions::SILOptMode::None) {
+      StringRef CustomPipelinePath =
+        Invocation.getSILOptions().ExternalPassPipelineFilename;
+      if (!CustomPipelinePath.empty()) {
+        runSILOptimizationPassesWithFileSpecification(*SM, CustomPipelinePath);
+      } else {
+        runSILOptimizationPasses(*SM);
+      }
+    } else {
+      runSILPassesForOnone(*SM);
+    }
+  }
+
+  if (observer) {
+    observer->performedSILOptimization(*SM);
+  }
+
+  {
+    SharedTimer timer("SIL verification (post-optimization)");
+    SM->verify();
+  }
+
+  // Gather instruction counts if we are asked to do so.
+  if (SM->getOptions().PrintInstCounts) {
+    performSILInstCount(&*SM);
+  }
+
+  // Get the main source file's private discriminator and attach it to
+  // the compile unit's flags.
+  if (PrimarySourceFile) {
+    Identifier PD = PrimarySourceFile->getPrivateDiscriminator();
+    if (!PD.empty())
+      IRGenOpts.DWARFDebugFlags += (" -private-discriminator "+PD.str()).str();
+  }
+
+  if (!opts.ObjCHeaderOutputPath.empty()) {
+    (void)printAsObjC(opts.ObjCHeaderOutputPath, Instance.getMainModule(),
+                      opts.ImplicitObjCHeaderPath, moduleIsPublic);
+  }
+
+  if (Action == FrontendOptions::EmitSIB) {
+    auto DC = PrimarySourceFile ? ModuleOrSourceFile(PrimarySourceFile) :
+                                  Instance.getMainModule();
+    if (!opts.ModuleOutputPath.empty()) {
+      SerializationOptions serializationOpts;
+      serializationOpts.OutputPath = opts.ModuleOutputPath.c_str();
+      serializationOpts.SerializeAllSIL = true;
+      serializationOpts.IsSIB = true;
+
+      serialize(DC, serializationOpts, SM.get());
+    }
+    return false;
+  }
+
+  // The module documentation only depends on the AST. When IRGen hands LLVM
+  // off to other threads, write it while they run rather than up front.
+  std::function<void()> serializeDocAfterIRGen;
+
+  if (!opts.ModuleOutputPath.empty() || !opts.ModuleDocOutputPath.empty()) {
+    auto DC = PrimarySourceFile ? ModuleOrSourceFile(PrimarySourceFile) :
+                                  Instance.getMainModule();
+    if (!opts.ModuleOutputPath.empty()) {
+      SerializationOptions serializationOpts;
+      serializationOpts.OutputPath = opts.ModuleOutputPath.c_str();
+      serializationOpts.DocOutputPath = opts.ModuleDocOutputPath.c_str();
+      serializationOpts.GroupInfoPath = opts.GroupInfoPath.c_str();
+      serializationOpts.SerializeAllSIL = opts.SILSerializeAll;
+      if (opts.SerializeBridgingHeader)
+        serializationOpts.ImportedHeader = opts.ImplicitObjCHeaderPath;
+      serializationOpts.ModuleLinkName = opts.ModuleLinkName;
+      serializationOpts.ExtraClangOptions =
+          Invocation.getClangImporterOptions().ExtraArgs;
+      if (!IRGenOpts.ForceLoadSymbolName.empty())
+        serializationOpts.AutolinkForceLoad = true;
+
+      // Options contain information about the developer's computer,
+      // so only serialize them if the module isn't going to be shipped to
+      // the public.
+      serializationOpts.SerializeOptionsForDebugging =
+          !moduleIsPublic || opts.AlwaysSerializeDebuggingOptions;
+
+      bool deferDoc = !PrimarySourceFile &&
+                      !opts.ModuleDocOutputPath.empty() &&
+                      Invocation.getSILOptions().NumThreads != 0 &&
+                      Action != FrontendOptions::EmitModuleOnly &&
+                      Action != FrontendOptions::EmitSIL;
+      if (deferDoc) {
+        serializeDocAfterIRGen = [DC, &opts] {
+          SerializationOptions docOpts;
+          docOpts.DocOutputPath = opts.ModuleDocOutputPath.c_str();
+          docOpts.GroupInfoPath = opts.GroupInfoPath.c_str();
+          serializeDoc(DC, docOpts);
+        };
+        serializationOpts.DocOutputPath = nullptr;
+      }
+
+      serialize(DC, serializationOpts, SM.get());
+    }
+
+    if (Action == FrontendOptions::EmitModuleOnly)
+      return false;
+  }
+
+  assert(Action >= FrontendOptions::EmitSIL &&
+         "All actions not requiring SILPasses must have been handled!");
+
+  // We've been told to write canonical SIL, so write it now.
+  if (Action == FrontendOptions::EmitSIL) {
+    return writeSIL(*SM, Instance.getMainModule(), opts.EmitVerboseSIL,
+                    OutputFilename, opts.EmitSortedSIL);
+  }
+
+  assert(Action >= FrontendOptions::Immediate &&
+         "All actions not requiring IRGen must have been handled!");
+  assert(Action != FrontendOptions::REPL &&
+         "REPL mode must be handled immediately after Instance.performSema()");
+
+  // Check if we had any errors; if we did, don't proceed to IRGen.
+  if (Context.hadError())
+    return true;
+
+  // Cleanup instructions/builtin calls not suitable for IRGen.
+  performSILCleanup(SM.get());
+
+  // TODO: remove once the frontend understands what action it should perform
+  IRGenOpts.OutputKind = getOutputKind(Action);
+  if (Action == FrontendOptions::Immediate) {
+    assert(!PrimarySourceFile && "-i doesn't work in -primary-file mode");
+    IRGenOpts.UseJIT = true;
+    IRGenOpts.DebugInfoKind = IRGenDebugInfoKind::Normal;
+    const ProcessCmdLine &CmdLine = ProcessCmdLine(opts.ImmediateArgv.begin(),
+                                                   opts.ImmediateArgv.end());
+    Instance.setSILModule(std::move(SM));
+
+    if (observer) {
+      observer->aboutToRunImmediately(Instance);
+    }
+
+    ReturnValue =
+      RunImmediately(Instance, CmdLine, IRGenOpts, Invocation.getSILOptions());
+    return false;
+  }
+
+  // Nothing looks at the SIL after IRGen, so don't keep it alive through the
+  // LLVM passes.
+  IRGenOpts.FreeSILAfterIRGen = true;
+
+  // FIXME: We shouldn't need to use the global context here, but
+  // something is persisting across calls to performIRGeneration.
+  auto &LLVMContext = getGlobalLLVMContext();
+  if (PrimarySourceFile) {
+    performIRGeneration(IRGenOpts, *PrimarySourceFile, SM.get(),
+                        OutputFilename, LLVMContext);
+  } else {
+    performIRGeneration(IRGenOpts, Instance.getMainModule(), SM.get(),
+                        OutputFilename, LLVMContext, serializeDocAfterIRGen);
+  }
+
+  return false;
+}
+
 /// Performs the compile requested by the user.
 /// \returns true on error
 static bool performCompile(CompilerInstance &Instance,
@@ -746,10 +1107,22 @@ static bool performCompile(CompilerInstance &Instance,
     return performLLVM(IRGenOpts, Instance.getASTContext(), Module.get());
   }
 
+  // The input of -emit-pch is the bridging header, not a Swift file.
+  if (Action == FrontendOptions::EmitPCH) {
+    auto clangImporter = static_cast<ClangImporter *>(
+      Instance.getASTContext().getClangModuleLoader());
+    return clangImporter->emitBridgingPCH(Invocation.getInputFilenames()[0],
+                                          opts.getSingleOutputFilename());
+  }
+
   ReferencedNameTracker nameTracker;
   bool shouldTrackReferences = !opts.ReferenceDependenciesFilePath.empty();
-  if (shouldTrackReferences)
+  std::vector<ReferencedNameTracker> batchNameTrackers(
+    shouldTrackReferences ? opts.AdditionalPrimaryInputs.size() : 0);
+  if (shouldTrackReferences) {
     Instance.setReferencedNameTracker(&nameTracker);
+    Instance.setAdditionalReferencedNameTrackers(batchNameTrackers);
+  }
 
   if (Action == FrontendOptions::DumpParse ||
       Action == FrontendOptions::DumpInterfaceHash)
@@ -854,9 +1227,18 @@ static bool performCompile(CompilerInstance &Instance,
     (void)emitMakeDependencies(Context.Diags, *Instance.getDependencyTracker(),
                                opts);
 
-  if (shouldTrackReferences)
+  if (shouldTrackReferences) {
     emitReferenceDependencies(Context.Diags, Instance.getPrimarySourceFile(),
-                              *Instance.getDependencyTracker(), opts);
+                              *Instance.getDependencyTracker(),
+                              opts.ReferenceDependenciesFilePath);
+    auto batchPrimaries = Instance.getAdditionalPrimarySourceFiles();
+    auto &batchPaths = opts.AdditionalReferenceDependenciesFilePaths;
+    for (unsigned i = 0, e = batchPrimaries.size(); i != e; ++i) {
+      emitReferenceDependencies(Context.Diags, batchPrimaries[i],
+                                *Instance.getDependencyTracker(),
+                                batchPaths[i]);
+    }
+  }
 
   if (Context.hadError())
     return true;
@@ -879,6 +1261,33 @@ static bool performCompile(CompilerInstance &Instance,
   assert(Action >= FrontendOptions::EmitSILGen &&
          "All actions not requiring SILGen must have been handled!");
 
+  // In batch mode, each primary file gets its own SIL module and output.
+  // Only the parsed and type-checked AST is shared between them.
+  if (opts.isBatchMode()) {
+    SmallVector<SourceFile *, 8> primaries;
+    primaries.push_back(PrimarySourceFile);
+    auto batchPrimaries = Instance.getAdditionalPrimarySourceFiles();
+    primaries.append(batchPrimaries.begin(), batchPrimaries.end());
+    assert(primaries.size() == opts.OutputFilenames.size() &&
+           "need one output per primary file");
+
+    bool hadError = false;
+    for (unsigned i = 0, e = primaries.size(); i != e; ++i) {
+      std::unique_ptr<SILModule> SM =
+        performSILGeneration(*primaries[i], Invocation.getSILOptions(), None,
+                             opts.SILSerializeAll);
+      // Each output gets its own debug flags.
+      IRGenOptions primaryIRGenOpts = IRGenOpts;
+      hadError |= performCompileStepsPostSILGen(Instance, Invocation,
+                                                std::move(SM), primaries[i],
+                                                opts.OutputFilenames[i],
+                                                primaryIRGenOpts,
+                                                moduleIsPublic, ReturnValue,
+                                                observer);
+    }
+    return hadError;
+  }
+
   std::unique_ptr<SILModule> SM = Instance.takeSILModule();
   if (!SM) {
     if (opts.PrimaryInput.hasValue() && opts.PrimaryInput.getValue().isFilename()) {
@@ -896,197 +1305,11 @@ static bool performCompile(CompilerInstance &Instance,
     }
   }
 
-  if (observer) {
-    observer->performedSILGeneration(*SM);
-  }
-
-  // We've been told to emit SIL after SILGen, so write it now.
-  if (Action == FrontendOptions::EmitSILGen) {
-    // If we are asked to link all, link all.
-    if (Invocation.getSILOptions().LinkMode == SILOptions::LinkAll)
-      performSILLinking(SM.get(), true);
-    return writeSIL(*SM, Instance.getMainModule(), opts.EmitVerboseSIL,
-                    opts.getSingleOutputFilename(), opts.EmitSortedSIL);
-  }
-
-  if (Action == FrontendOptions::EmitSIBGen) {
-    // If we are asked to link all, link all.
-    if (Invocation.getSILOptions().LinkMode == SILOptions::LinkAll)
-      performSILLinking(SM.get(), true);
-
-    auto DC = PrimarySourceFile ? ModuleOrSourceFile(PrimarySourceFile) :
-                                  Instance.getMainModule();
-    if (!opts.ModuleOutputPath.empty()) {
-      SerializationOptions serializationOpts;
-      serializationOpts.OutputPath = opts.ModuleOutputPath.c_str();
-      serializationOpts.SerializeAllSIL = true;
-      serializationOpts.IsSIB = true;
-
-      serialize(DC, serializationOpts, SM.get());
-    }
-    return false;
-  }
-
-  // Perform "stable" optimizations that are invariant across compiler versions.
-  if (!Invocation.getDiagnosticOptions().SkipDiagnosticPasses) {
-    if (runSILDiagnosticPasses(*SM))
-      return true;
-
-    if (observer) {
-      observer->performedSILDiagnostics(*SM);
-    }
-  }
-
-  // Now if we are asked to link all, link all.
-  if (Invocation.getSILOptions().LinkMode == SILOptions::LinkAll)
-    performSILLinking(SM.get(), true);
-
-  {
-    SharedTimer timer("SIL verification (pre-optimization)");
-    SM->verify();
-  }
-
-  // Perform SIL optimization passes if optimizations haven't been disabled.
-  // These may change across compiler versions.
-  {
-    SharedTimer timer("SIL optimization");
-    if (Invocation.getSILOptions().Optimization >
-        SILOptions::SILOptMode::None) {
-      StringRef CustomPipelinePath =
-        Invocation.getSILOptions().ExternalPassPipelineFilename;
-      if (!CustomPipelinePath.empty()) {
-        runSILOptimizationPassesWithFileSpecification(*SM, CustomPipelinePath);
-      } else {
-        runSILOptimizationPasses(*SM);
-      }
-    } else {
-      runSILPassesForOnone(*SM);
-    }
-  }
-
-  if (observer) {
-    observer->performedSILOptimization(*SM);
-  }
-
-  {
-    SharedTimer timer("SIL verification (post-optimization)");
-    SM->verify();
-  }
-
-  // Gather instruction counts if we are asked to do so.
-  if (SM->getOptions().PrintInstCounts) {
-    performSILInstCount(&*SM);
-  }
-
-  // Get the main source file's private discriminator and attach it to
-  // the compile unit's flags.
-  if (PrimarySourceFile) {
-    Identifier PD = PrimarySourceFile->getPrivateDiscriminator();
-    if (!PD.empty())
-      IRGenOpts.DWARFDebugFlags += (" -private-discriminator "+PD.str()).str();
-  }
-
-  if (!opts.ObjCHeaderOutputPath.empty()) {
-    (void)printAsObjC(opts.ObjCHeaderOutputPath, Instance.getMainModule(),
-                      opts.ImplicitObjCHeaderPath, moduleIsPublic);
-  }
-
-  if (Action == FrontendOptions::EmitSIB) {
-    auto DC = PrimarySourceFile ? ModuleOrSourceFile(PrimarySourceFile) :
-                                  Instance.getMainModule();
-    if (!opts.ModuleOutputPath.empty()) {
-      SerializationOptions serializationOpts;
-      serializationOpts.OutputPath = opts.ModuleOutputPath.c_str();
-      serializationOpts.SerializeAllSIL = true;
-      serializationOpts.IsSIB = true;
-
-      serialize(DC, serializationOpts, SM.get());
-    }
-    return false;
-  }
-
-  if (!opts.ModuleOutputPath.empty() || !opts.ModuleDocOutputPath.empty()) {
-    auto DC = PrimarySourceFile ? ModuleOrSourceFile(PrimarySourceFile) :
-                                  Instance.getMainModule();
-    if (!opts.ModuleOutputPath.empty()) {
-      SerializationOptions serializationOpts;
-      serializationOpts.OutputPath = opts.ModuleOutputPath.c_str();
-      serializationOpts.DocOutputPath = opts.ModuleDocOutputPath.c_str();
-      serializationOpts.GroupInfoPath = opts.GroupInfoPath.c_str();
-      serializationOpts.SerializeAllSIL = opts.SILSerializeAll;
-      if (opts.SerializeBridgingHeader)
-        serializationOpts.ImportedHeader = opts.ImplicitObjCHeaderPath;
-      serializationOpts.ModuleLinkName = opts.ModuleLinkName;
-      serializationOpts.ExtraClangOptions =
-          Invocation.getClangImporterOptions().ExtraArgs;
-      if (!IRGenOpts.ForceLoadSymbolName.empty())
-        serializationOpts.AutolinkForceLoad = true;
-
-      // Options contain information about the developer's computer,
-      // so only serialize them if the module isn't going to be shipped to
-      // the public.
-      serializationOpts.SerializeOptionsForDebugging =
-          !moduleIsPublic || opts.AlwaysSerializeDebuggingOptions;
-
-      serialize(DC, serializationOpts, SM.get());
-    }
-
-    if (Action == FrontendOptions::EmitModuleOnly)
-      return false;
-  }
-
-  assert(Action >= FrontendOptions::EmitSIL &&
-         "All actions not requiring SILPasses must have been handled!");
-
-  // We've been told to write canonical SIL, so write it now.
-  if (Action == FrontendOptions::EmitSIL) {
-    return writeSIL(*SM, Instance.getMainModule(), opts.EmitVerboseSIL,
-                    opts.getSingleOutputFilename(), opts.EmitSortedSIL);
-  }
-
-  assert(Action >= FrontendOptions::Immediate &&
-         "All actions not requiring IRGen must have been handled!");
-  assert(Action != FrontendOptions::REPL &&
-         "REPL mode must be handled immediately after Instance.performSema()");
-
-  // Check if we had any errors; if we did, don't proceed to IRGen.
-  if (Context.hadError())
-    return true;
-
-  // Cleanup instructions/builtin calls not suitable for IRGen.
-  performSILCleanup(SM.get());
-
-  // TODO: remove once the frontend understands what action it should perform
-  IRGenOpts.OutputKind = getOutputKind(Action);
-  if (Action == FrontendOptions::Immediate) {
-    assert(!PrimarySourceFile && "-i doesn't work in -primary-file mode");
-    IRGenOpts.UseJIT = true;
-    IRGenOpts.DebugInfoKind = IRGenDebugInfoKind::Normal;
-    const ProcessCmdLine &CmdLine = ProcessCmdLine(opts.ImmediateArgv.begin(),
-                                                   opts.ImmediateArgv.end());
-    Instance.setSILModule(std::move(SM));
-
-    if (observer) {
-      observer->aboutToRunImmediately(Instance);
-    }
-
-    ReturnValue =
-      RunImmediately(Instance, CmdLine, IRGenOpts, Invocation.getSILOptions());
-    return false;
-  }
-
-  // FIXME: We shouldn't need to use the global context here, but
-  // something is persisting across calls to performIRGeneration.
-  auto &LLVMContext = getGlobalLLVMContext();
-  if (PrimarySourceFile) {
-    performIRGeneration(IRGenOpts, *PrimarySourceFile, SM.get(),
-                        opts.getSingleOutputFilename(), LLVMContext);
-  } else {
-    performIRGeneration(IRGenOpts, Instance.getMainModule(), SM.get(),
-                        opts.getSingleOutputFilename(), LLVMContext);
-  }
-
-  return false;
+  return performCompileStepsPostSILGen(Instance, Invocation, std::move(SM),
+                                       PrimarySourceFile,
+                                       opts.getSingleOutputFilename(),
+                                       IRGenOpts, moduleIsPublic, ReturnValue,
+                                       observer);
 }
 
 /// Returns true if an error occurred.
@@ -1270,6 +1493,9 @@ int swift::performFrontend(ArrayRef<const char *> Args,
   if (Invocation.getFrontendOptions().DebugTimeCompilation)
     SharedTimer::enableCompilationTimers();
 
+  if (!Invocation.getFrontendOptions().TraceOutputPath.empty())
+    TraceScope::enableTracing();
+
   if (Invocation.getFrontendOptions().PrintStats) {
     llvm::EnableStatistics();
   }
@@ -1299,6 +1525,20 @@ int swift::performFrontend(ArrayRef<const char *> Args,
     performCompile(Instance, Invocation, Args, ReturnValue, observer) ||
     Instance.getASTContext().hadError();
 
+  if (TraceScope::isTracingEnabled()) {
+    const std::string &TracePath =
+      Invocation.getFrontendOptions().TraceOutputPath;
+    std::error_code EC;
+    llvm::raw_fd_ostream OS(TracePath, EC, llvm::sys::fs::F_None);
+    if (EC) {
+      Instance.getDiags().diagnose(SourceLoc(), diag::error_opening_output,
+                                   TracePath, EC.message());
+      HadError = true;
+    } else {
+      TraceScope::writeTrace(OS);
+    }
+  }
+
   if (!HadError && !Invocation.getFrontendOptions().DumpAPIPath.empty()) {
     HadError = dumpAPI(Instance.getMainModule(),
                        Invocation.getFrontendOptions().DumpAPIPath);
@@ -925,34 +925,47 @@ static CodeCompletionResult::ExpectedTypeRelation calculateTypeRelation(
   return CodeCompletionResult::ExpectedTypeRelation::Unrelated;
 }
 
-static CodeCompletionResult::ExpectedTypeRelation
-calculateTypeRelationForDecl(const Decl *D, Type ExpectedType,
-                             bool IsImplicitlyCurriedInstanceMethod,
-                             bool UseFuncResultType = true) {
-  auto VD = dyn_cast<ValueDecl>(D);
-  auto DC = D->getDeclContext();
-  if (!VD)
-    return CodeCompletionResult::ExpectedTypeRelation::Unrelated;
-
+/// Collects the types of \p VD which are compared to the expected type.
+static void getTypesForTypeRelation(const ValueDecl *VD,
+                                    bool IsImplicitlyCurriedInstanceMethod,
+                                    bool UseFuncResultType,
+                                    SmallVectorImpl<Type> &Types) {
   if (auto FD = dyn_cast<AbstractFunctionDecl>(VD)) {
     auto funcType = FD->getType()->getAs<AnyFunctionType>();
-    if (DC->isTypeContext() && funcType && funcType->is<AnyFunctionType>() &&
-        !IsImplicitlyCurriedInstanceMethod)
+    if (FD->getDeclContext()->isTypeContext() && funcType &&
+        funcType->is<AnyFunctionType>() && !IsImplicitlyCurriedInstanceMethod)
       funcType = funcType->getResult()->getAs<AnyFunctionType>();
     if (funcType) {
-      auto relation = calculateTypeRelation(funcType, ExpectedType, DC);
+      Types.push_back(funcType);
       if (UseFuncResultType)
-        relation =
-            std::max(relation, calculateTypeRelation(funcType->getResult(),
-                                                     ExpectedType, DC));
-      return relation;
+        Types.push_back(funcType->getResult());
+      return;
     }
   }
   if (auto NTD = dyn_cast<NominalTypeDecl>(VD)) {
-    return std::max(calculateTypeRelation(NTD->getType(), ExpectedType, DC),
-                    calculateTypeRelation(NTD->getDeclaredType(), ExpectedType, DC));
+    Types.push_back(NTD->getType());
+    Types.push_back(NTD->getDeclaredType());
+    return;
   }
-  return calculateTypeRelation(VD->getType(), ExpectedType, DC);
+  Types.push_back(VD->getType());
+}
+
+static CodeCompletionResult::ExpectedTypeRelation
+calculateTypeRelationForDecl(const Decl *D, Type ExpectedType,
+                             bool IsImplicitlyCurriedInstanceMethod,
+                             bool UseFuncResultType = true) {
+  auto VD = dyn_cast<ValueDecl>(D);
+  auto DC = D->getDeclContext();
+  if (!VD)
+    return CodeCompletionResult::ExpectedTypeRelation::Unrelated;
+
+  SmallVector<Type, 2> Types;
+  getTypesForTypeRelation(VD, IsImplicitlyCurriedInstanceMethod,
+                          UseFuncResultType, Types);
+  auto Result = CodeCompletionResult::ExpectedTypeRelation::Unrelated;
+  for (auto Ty : Types)
+    Result = std::max(Result, calculateTypeRelation(Ty, ExpectedType, DC));
+  return Result;
 }
 
 static CodeCompletionResult::ExpectedTypeRelation
@@ -968,6 +981,55 @@ calculateMaxTypeRelationForDecl(
   return Result;
 }
 
+/// Returns true if \p Ty means the same in any context, so that it can be
+/// compared by USR outside of the AST it comes from.
+static bool isContextFreeType(Type Ty) {
+  return Ty && !Ty->hasError() && !Ty->hasTypeVariable() &&
+         !Ty->hasUnresolvedType() && !Ty->hasArchetype() &&
+         !Ty->hasTypeParameter();
+}
+
+/// Returns the USR of \p Ty, or an empty string if it has none.
+static std::string getContextFreeTypeUSR(Type Ty) {
+  llvm::SmallString<64> SS;
+  if (isContextFreeType(Ty)) {
+    llvm::raw_svector_ostream OS(SS);
+    if (printTypeUSR(Ty, OS))
+      SS.clear();
+  }
+  return SS.str();
+}
+
+/// Precomputes the USRs of the types of \p D which are compared to the
+/// expected type, for results that are cached without a type relation.
+static ArrayRef<StringRef> copyResultTypeUSRs(llvm::BumpPtrAllocator &Allocator,
+                                              const Decl *D) {
+  auto VD = dyn_cast<ValueDecl>(D);
+  if (!VD || !VD->hasType())
+    return ArrayRef<StringRef>();
+
+  SmallVector<Type, 2> Types;
+  getTypesForTypeRelation(VD, /*IsImplicitlyCurriedInstanceMethod=*/false,
+                          /*UseFuncResultType=*/true, Types);
+  SmallVector<StringRef, 2> USRs;
+  for (auto Ty : Types) {
+    auto USR = getContextFreeTypeUSR(Ty);
+    if (!USR.empty())
+      USRs.push_back(copyString(Allocator, USR));
+  }
+
+  if (!USRs.empty())
+    return copyStringArray(Allocator, USRs);
+  return ArrayRef<StringRef>();
+}
+
+CodeCompletionResult *CodeCompletionResult::withExpectedTypeRelation(
+    llvm::BumpPtrAllocator &Allocator, ExpectedTypeRelation Relation) const {
+  auto *Result = new (Allocator) CodeCompletionResult(*this);
+  Result->TypeDistance = Relation;
+  return Result;
+}
+
 CodeCompletionOperatorKind
 CodeCompletionResult::getCodeCompletionOperatorKind(StringRef name) {
   using CCOK = CodeCompletionOperatorKind;
@@ -1087,7 +1149,10 @@ CodeCompletionResult *CodeCompletionResultBuilder::takeResult() {
         /*NotRecommended=*/IsNotRecommended, NotRecReason,
         copyString(*Sink.Allocator, BriefComment),
         copyAssociatedUSRs(*Sink.Allocator, AssociatedDecl),
-        copyStringPairArray(*Sink.Allocator, CommentWords), typeRelation);
+        copyStringPairArray(*Sink.Allocator, CommentWords), typeRelation,
+        Sink.IncludeResultTypeUSRs
+            ? copyResultTypeUSRs(*Sink.Allocator, AssociatedDecl)
+            : ArrayRef<StringRef>());
   }
 
   case CodeCompletionResult::ResultKind::Keyword:
@@ -1725,6 +1790,7 @@ public:
   }
 
   bool hasExpectedTypes() const { return !ExpectedTypes.empty(); }
+  ArrayRef<Type> getExpectedTypes() const { return ExpectedTypes; }
 
   bool needDot() const {
     return NeedLeadingDot;
@@ -5362,6 +5428,16 @@ void CodeCompletionCallbacksImpl::doneParsing() {
 
   CompletionContext.HasExpectedTypeRelation = Lookup.hasExpectedTypes();
 
+  // Cached results are ranked by comparing the USRs of their types.
+  CompletionContext.ExpectedTypeUSRs.clear();
+  if (!RequestedModules.empty()) {
+    for (auto T : Lookup.getExpectedTypes()) {
+      auto USR = getContextFreeTypeUSR(T);
+      if (!USR.empty())
+        CompletionContext.ExpectedTypeUSRs.push_back(std::move(USR));
+    }
+  }
+
   deliverCompletionResults();
 }
 
@@ -5432,13 +5508,15 @@ void swift::ide::lookupCodeCompletionResultsFromModule(
     CodeCompletionResultSink &targetSink, const Module *module,
     ArrayRef<std::string> accessPath, bool needLeadingDot,
     const DeclContext *currDeclContext) {
+  targetSink.IncludeResultTypeUSRs = true;
   CompletionLookup Lookup(targetSink, module->getASTContext(), currDeclContext);
   Lookup.getVisibleDeclsOfModule(module, accessPath, needLeadingDot);
 }
 
-void swift::ide::copyCodeCompletionResults(CodeCompletionResultSink &targetSink,
-                                           CodeCompletionResultSink &sourceSink,
-                                           bool onlyTypes) {
+void swift::ide::copyCodeCompletionResults(
+    CodeCompletionResultSink &targetSink, CodeCompletionResultSink &sourceSink,
+    bool onlyTypes, ArrayRef<std::string> expectedTypeUSRs) {
+  size_t firstCopied = targetSink.Results.size();
 
   // We will be adding foreign results (from another sink) into TargetSink.
   // TargetSink should have an owning pointer to the allocator that keeps the
@@ -5484,6 +5562,24 @@ void swift::ide::copyCodeCompletionResults(CodeCompletionResultSink &targetSink,
                               sourceSink.Results.begin(),
                               sourceSink.Results.end());
   }
+
+  if (expectedTypeUSRs.empty())
+    return;
+
+  // The cached results are shared with other completions, so the ones with
+  // a type relation are replaced by copies.
+  for (size_t i = firstCopied, e = targetSink.Results.size(); i != e; ++i) {
+    CodeCompletionResult *R = targetSink.Results[i];
+    auto USRs = R->getResultTypeUSRs();
+    bool isIdentical = std::any_of(USRs.begin(), USRs.end(),
+                                   [&](StringRef USR) -> bool {
+      return std::find(expectedTypeUSRs.begin(), expectedTypeUSRs.end(),
+                       USR) != expectedTypeUSRs.end();
+    });
+    if (isIdentical)
+      targetSink.Results[i] = R->withExpectedTypeRelation(
+          *targetSink.Allocator, CodeCompletionResult::Identical);
+  }
 }
 
 void SimpleCachingCodeCompletionConsumer::handleResultsAndModules(
@@ -5504,7 +5600,8 @@ void SimpleCachingCodeCompletionConsumer::handleResultsAndModules(
       context.Cache.set(R.Key, *V);
     }
     assert(V.hasValue());
-    copyCodeCompletionResults(context.getResultSink(), (*V)->Sink, R.OnlyTypes);
+    copyCodeCompletionResults(context.getResultSink(), (*V)->Sink, R.OnlyTypes,
+                              context.ExpectedTypeUSRs);
   }
 
   handleResults(context.takeResults());
@@ -6,6 +6,7 @@
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include <atomic>
 
 using namespace swift;
 using namespace ide;
@@ -17,6 +18,9 @@ namespace swift {
       using Value = CodeCompletionCache::Value;
       using ValueRefCntPtr = CodeCompletionCache::ValueRefCntPtr;
       sys::Cache<Key, ValueRefCntPtr> TheCache{"swift.libIDE.CodeCompletionCache"};
+      std::atomic<uint64_t> Hits{0};
+      std::atomic<uint64_t> DiskHits{0};
+      std::atomic<uint64_t> Misses{0};
     };
   } // end namespace ide
 } // end namespace swift
@@ -46,18 +50,33 @@ CodeCompletionCache::get(const Key &K) {
     llvm::sys::fs::file_status ModuleStatus;
     if (llvm::sys::fs::status(K.ModuleFilename, ModuleStatus) ||
         V.getValue()->ModuleModificationTime !=
-        ModuleStatus.getLastModificationTime()) {
+        ModuleStatus.getLastModificationTime() ||
+        V.getValue()->ModuleSize != ModuleStatus.getSize()) {
       // Cache is stale.
       V = None;
       TheCache.remove(K);
     }
   } else if (nextCache && (V = nextCache->get(K))) {
     // Hit the chained cache. Update our own cache to match.
+    ++Impl->DiskHits;
     setImpl(K, *V, /*setChain*/ false);
+    return V;
   }
+  if (V)
+    ++Impl->Hits;
+  else
+    ++Impl->Misses;
   return V;
 }
 
+CodeCompletionCache::Statistics CodeCompletionCache::getStatistics() const {
+  Statistics Stats;
+  Stats.Hits = Impl->Hits;
+  Stats.DiskHits = Impl->DiskHits;
+  Stats.Misses = Impl->Misses;
+  return Stats;
+}
+
 void CodeCompletionCache::setImpl(const Key &K, ValueRefCntPtr V,
                                   bool setChain) {
   {
@@ -69,6 +88,7 @@ void CodeCompletionCache::setImpl(const Key &K, ValueRefCntPtr V,
       return;
     } else {
       V->ModuleModificationTime = ModuleStatus.getLastModificationTime();
+      V->ModuleSize = ModuleStatus.getSize();
     }
   }
   Impl->TheCache.set(K, V);
@@ -88,13 +108,7 @@ CodeCompletionCache::~CodeCompletionCache() {}
 ///
 /// This should be incremented any time we commit a change to the format of the
 /// cached results. This isn't expected to change very often.
-static constexpr uint32_t onDiskCompletionCacheVersion = 1;
-
-static StringRef copyString(llvm::BumpPtrAllocator &Allocator, StringRef Str) {
-  char *Mem = Allocator.Allocate<char>(Str.size());
-  std::copy(Str.begin(), Str.end(), Mem);
-  return StringRef(Mem, Str.size());
-}
+static constexpr uint32_t onDiskCompletionCacheVersion = 3;
 
 static ArrayRef<StringRef> copyStringArray(llvm::BumpPtrAllocator &Allocator,
                                            ArrayRef<StringRef> Arr) {
@@ -112,9 +126,32 @@ static ArrayRef<std::pair<StringRef, StringRef>> copyStringPairArray(
   return llvm::makeArrayRef(Buff, Arr.size());
 }
 
+namespace {
+/// An allocator that also owns the file that cached results were read from,
+/// so the results can refer to strings in the file without copying them.
+struct MappedFileAllocator {
+  llvm::BumpPtrAllocator Allocator;
+  std::unique_ptr<llvm::MemoryBuffer> Buffer;
+};
+} // end anonymous namespace
+
+/// Maps the cached results in \p filename into memory.
+///
+/// The file doesn't need a null terminator, so it can always be mapped rather
+/// than read.
+static llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>>
+mapCachedModule(StringRef filename) {
+  return llvm::MemoryBuffer::getFile(filename, /*FileSize=*/-1,
+                                     /*RequiresNullTerminator=*/false);
+}
+
 /// Deserializes CodeCompletionResults from \p in and stores them in \p V.
+///
+/// Strings are not copied out of \p in; instead \p V's allocator takes
+/// ownership of it, which keeps it alive for as long as any of the results,
+/// including results that are later imported into another sink.
 /// \see writeCacheModule.
-static bool readCachedModule(llvm::MemoryBuffer *in,
+static bool readCachedModule(std::unique_ptr<llvm::MemoryBuffer> in,
                              const CodeCompletionCache::Key &K,
                              CodeCompletionCache::Value &V,
                              bool allowOutOfDate = false) {
@@ -136,17 +173,26 @@ static bool readCachedModule(llvm::MemoryBuffer *in,
 
     auto mtime = llvm::support::endian::read64le(cursor);
     cursor += sizeof(mtime);
+    auto moduleSize = llvm::support::endian::read64le(cursor);
+    cursor += sizeof(moduleSize);
 
-    // Check the module file's last modification time.
+    // Check the module file's last modification time and size.
     if (!allowOutOfDate) {
       llvm::sys::fs::file_status status;
       if (llvm::sys::fs::status(K.ModuleFilename, status) ||
-          status.getLastModificationTime().toEpochTime() != mtime) {
+          status.getLastModificationTime().toEpochTime() != mtime ||
+          status.getSize() != moduleSize) {
         return false; // Out of date, or doesn't exist.
       }
     }
   }
 
+  // The results are valid; hand the file over to the sink's allocator.
+  auto owner = std::make_shared<MappedFileAllocator>();
+  owner->Buffer = std::move(in);
+  V.Sink.Allocator =
+      CodeCompletionResultSink::AllocatorPtr(owner, &owner->Allocator);
+
   // DEBUG INFO
   cursor += read32le(cursor); // Skip the whole debug section.
 
@@ -167,7 +213,7 @@ static bool readCachedModule(llvm::MemoryBuffer *in,
 
     const char *p = strings + index;
     auto size = read32le(p);
-    return copyString(*V.Sink.Allocator, StringRef(p, size));
+    return StringRef(p, size);
   };
 
   // CHUNKS
@@ -211,6 +257,8 @@ static bool readCachedModule(llvm::MemoryBuffer *in,
     auto assocUSRsIndex = read32le(cursor);
     auto declKeywordCount = read32le(cursor);
     auto declKeywordIndex = read32le(cursor);
+    auto resultTypeUSRCount = read32le(cursor);
+    auto resultTypeUSRsIndex = read32le(cursor);
 
     CodeCompletionString *string = getCompletionString(chunkIndex);
     auto moduleName = getString(moduleIndex);
@@ -231,13 +279,21 @@ static bool readCachedModule(llvm::MemoryBuffer *in,
       declKeywords.push_back(std::make_pair(first, second));
     }
 
+    SmallVector<StringRef, 2> resultTypeUSRs;
+    for (unsigned i = 0; i < resultTypeUSRCount; ++i) {
+      auto usr = getString(resultTypeUSRsIndex);
+      resultTypeUSRs.push_back(usr);
+      resultTypeUSRsIndex += usr.size() + IntLength;
+    }
+
     CodeCompletionResult *result = nullptr;
     if (kind == CodeCompletionResult::Declaration) {
       result = new (*V.Sink.Allocator) CodeCompletionResult(
           context, numBytesToErase, string, declKind, moduleName,
           notRecommended, CodeCompletionResult::NotRecommendedReason::NoReason,
           briefDocComment, copyStringArray(*V.Sink.Allocator, assocUSRs),
-          copyStringPairArray(*V.Sink.Allocator, declKeywords), opKind);
+          copyStringPairArray(*V.Sink.Allocator, declKeywords), opKind,
+          copyStringArray(*V.Sink.Allocator, resultTypeUSRs));
     } else {
       result = new (*V.Sink.Allocator)
           CodeCompletionResult(kind, context, numBytesToErase, string,
@@ -257,6 +313,7 @@ static bool readCachedModule(llvm::MemoryBuffer *in,
 ///   HEADER
 ///     * version, which **must be bumped** if we change the format!
 ///     * mtime for the module file
+///     * size of the module file
 ///
 ///   KEY
 ///     * the original CodeCompletionCache::Key, used for debugging the cache.
@@ -282,6 +339,7 @@ static void writeCachedModule(llvm::raw_ostream &out,
   // Metadata required for reading the completions.
   LE.write(onDiskCompletionCacheVersion);           // Version
   LE.write(V.ModuleModificationTime.toEpochTime()); // Mtime for module file
+  LE.write(V.ModuleSize);                           // Size of module file
 
   // KEY
   // We don't need the stored key to load the results, but it is useful if we
@@ -379,6 +437,15 @@ static void writeCachedModule(llvm::raw_ostream &out,
           addString(AllKeywords[i].second);
         }
       }
+      LE.write(static_cast<uint32_t>(R->getResultTypeUSRs().size()));
+      if (R->getResultTypeUSRs().empty()) {
+        LE.write(static_cast<uint32_t>(~0u));
+      } else {
+        LE.write(addString(R->getResultTypeUSRs()[0]));
+        for (unsigned i = 1; i < R->getResultTypeUSRs().size(); ++i) {
+          addString(R->getResultTypeUSRs()[i]); // ignore result
+        }
+      }
     }
   }
   LE.write(static_cast<uint32_t>(results.tell()));
@@ -426,13 +493,13 @@ static std::string getName(StringRef cacheDirectory,
 Optional<CodeCompletionCache::ValueRefCntPtr>
 OnDiskCodeCompletionCache::get(const Key &K) {
   // Try to find the cached file.
-  auto bufferOrErr = llvm::MemoryBuffer::getFile(getName(cacheDirectory, K));
+  auto bufferOrErr = mapCachedModule(getName(cacheDirectory, K));
   if (!bufferOrErr)
     return None;
 
   // Read the cached results, failing if they are out of date.
   auto V = CodeCompletionCache::createValue();
-  if (!readCachedModule(bufferOrErr.get().get(), K, *V))
+  if (!readCachedModule(std::move(bufferOrErr.get()), K, *V))
     return None;
 
   return V;
@@ -468,7 +535,7 @@ std::error_code OnDiskCodeCompletionCache::set(const Key &K, ValueRefCntPtr V) {
 Optional<CodeCompletionCache::ValueRefCntPtr>
 OnDiskCodeCompletionCache::getFromFile(StringRef filename) {
   // Try to find the cached file.
-  auto bufferOrErr = llvm::MemoryBuffer::getFile(filename);
+  auto bufferOrErr = mapCachedModule(filename);
   if (!bufferOrErr)
     return None;
 
@@ -477,7 +544,7 @@ OnDiskCodeCompletionCache::getFromFile(StringRef filename) {
 
   // Read the cached results.
   auto V = CodeCompletionCache::createValue();
-  if (!readCachedModule(bufferOrErr.get().get(), K, *V,
+  if (!readCachedModule(std::move(bufferOrErr.get()), K, *V,
                         /*allowOutOfDate*/ true))
     return None;
 
@@ -74,14 +74,22 @@ protected:
 
   llvm::Constant *getRelativeAddressFromNextField(ConstantReference referent,
                                             llvm::IntegerType *addressTy) {
+    return getRelativeAddressFromField(referent, addressTy, getNextOffset());
+  }
+
+  /// Compute a relative address from the field at the given offset in the
+  /// local being built, e.g. for a field reserved with reserveFields.
+  llvm::Constant *getRelativeAddressFromField(ConstantReference referent,
+                                              llvm::IntegerType *addressTy,
+                                              Size offset) {
     assert(relativeAddressBase && "no relative address base set");
     
-    // Determine the address of the next field in the initializer.
+    // Determine the address of the field in the initializer.
     llvm::Constant *fieldAddr =
       llvm::ConstantExpr::getPtrToInt(relativeAddressBase, IGM.IntPtrTy);
     fieldAddr = llvm::ConstantExpr::getAdd(fieldAddr,
                           llvm::ConstantInt::get(IGM.SizeTy,
-                                                 getNextOffset().getValue()));
+                                                 offset.getValue()));
     llvm::Constant *referentValue =
       llvm::ConstantExpr::getPtrToInt(referent.getValue(), IGM.IntPtrTy);
 
@@ -47,9 +47,8 @@ bool ExplosionSchema::requiresIndirectResult(IRGenModule &IGM) const {
 }
 
 bool ExplosionSchema::requiresIndirectParameter(IRGenModule &IGM) const {
-  // For now, use the same condition as requiresIndirectSchema. We may want
-  // to diverge at some point.
-  return requiresIndirectResult(IGM);
+  return containsAggregate() ||
+         size() > IGM.TargetInfo.MaxScalarsForDirectParameter;
 }
 
 llvm::Type *ExplosionSchema::getScalarResultType(IRGenModule &IGM) const {
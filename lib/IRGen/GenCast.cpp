@@ -356,17 +356,54 @@ static llvm::Function *emitExistentialScalarCastFn(IRGenModule &IGM,
     IGF.Builder.emitBlock(contBB);
   }
 
-  // Look up each protocol conformance we want.
-  for (unsigned i = 0; i < numProtocols; ++i) {
-    auto proto = args.claimNext();
-    auto witness = IGF.Builder.CreateCall(conformsToProtocol, {ref, proto});
-    auto isNull = IGF.Builder.CreateICmpEQ(witness,
-                     llvm::ConstantPointerNull::get(IGM.WitnessTablePtrTy));
+  if (numProtocols > 1) {
+    // Look up all of the conformances of a composition with one runtime
+    // call, which caches them together.
+    Address protoBuf = IGF.createAlloca(
+                           llvm::ArrayType::get(IGM.ProtocolDescriptorPtrTy,
+                                                numProtocols),
+                           IGM.getPointerAlignment(), "protocols");
+    protoBuf = IGF.Builder.CreateBitCast(protoBuf,
+                                  IGM.ProtocolDescriptorPtrTy->getPointerTo());
+    Address witnessBuf = IGF.createAlloca(
+                           llvm::ArrayType::get(IGM.WitnessTablePtrTy,
+                                                numProtocols),
+                           IGM.getPointerAlignment(), "conformances");
+    witnessBuf = IGF.Builder.CreateBitCast(witnessBuf,
+                                        IGM.WitnessTablePtrTy->getPointerTo());
+
+    for (unsigned i = 0; i < numProtocols; ++i) {
+      Address slot = IGF.Builder.CreateConstArrayGEP(protoBuf, i,
+                                                     IGM.getPointerSize());
+      IGF.Builder.CreateStore(args.claimNext(), slot);
+    }
+
+    auto conforms = IGF.Builder.CreateCall(IGM.getConformsToProtocolsFn(),
+                                           {ref, protoBuf.getAddress(),
+                                            IGM.getSize(Size(numProtocols)),
+                                            witnessBuf.getAddress()});
     auto contBB = IGF.createBasicBlock("cont");
-    IGF.Builder.CreateCondBr(isNull, failBB, contBB);
-    
+    IGF.Builder.CreateCondBr(conforms, contBB, failBB);
+
     IGF.Builder.emitBlock(contBB);
-    rets.add(witness);
+    for (unsigned i = 0; i < numProtocols; ++i) {
+      Address slot = IGF.Builder.CreateConstArrayGEP(witnessBuf, i,
+                                                     IGM.getPointerSize());
+      rets.add(IGF.Builder.CreateLoad(slot));
+    }
+  } else {
+    // Look up each protocol conformance we want.
+    for (unsigned i = 0; i < numProtocols; ++i) {
+      auto proto = args.claimNext();
+      auto witness = IGF.Builder.CreateCall(conformsToProtocol, {ref, proto});
+      auto isNull = IGF.Builder.CreateICmpEQ(witness,
+                       llvm::ConstantPointerNull::get(IGM.WitnessTablePtrTy));
+      auto contBB = IGF.createBasicBlock("cont");
+      IGF.Builder.CreateCondBr(isNull, failBB, contBB);
+
+      IGF.Builder.emitBlock(contBB);
+      rets.add(witness);
+    }
   }
   
   // If we succeeded, return the witnesses.
@@ -514,8 +514,8 @@ irgen::getPhysicalClassMemberAccessStrategy(IRGenModule &IGM,
   }
 
   case FieldAccess::NonConstantDirect: {
-    std::string symbol =
-      LinkEntity::forFieldOffset(field, /*indirect*/ false).mangleAsString();
+    std::string symbol = IGM.IRGen.getMangledName(
+        LinkEntity::forFieldOffset(field, /*indirect*/ false)).str();
     return MemberAccessStrategy::getDirectGlobal(std::move(symbol),
                                  MemberAccessStrategy::OffsetKind::Bytes_Word);
   }
@@ -527,8 +527,8 @@ irgen::getPhysicalClassMemberAccessStrategy(IRGenModule &IGM,
   }
 
   case FieldAccess::NonConstantIndirect: {
-    std::string symbol =
-      LinkEntity::forFieldOffset(field, /*indirect*/ true).mangleAsString();
+    std::string symbol = IGM.IRGen.getMangledName(
+        LinkEntity::forFieldOffset(field, /*indirect*/ true)).str();
     return MemberAccessStrategy::getIndirectGlobal(std::move(symbol),
                                  MemberAccessStrategy::OffsetKind::Bytes_Word,
                                  MemberAccessStrategy::OffsetKind::Bytes_Word);
@@ -703,6 +703,9 @@ void IRGenModule::addObjCClass(llvm::Constant *classPtr, bool nonlazy) {
 /// runtime records will be emitted in this translation unit.
 void IRGenModule::addProtocolConformanceRecord(
                                        NormalProtocolConformance *conformance) {
+  auto *decl = conformance->getType()->getAnyNominal();
+  if (decl && !IRGen.needsTypeRecords(decl))
+    return;
   ProtocolConformances.push_back(conformance);
 }
 
@@ -737,11 +740,114 @@ void IRGenModule::addRuntimeResolvableType(CanType type) {
   // conformance table as the runtime will search both tables when resolving a
   // type by name.
   if (auto nom = type->getAnyNominal()) {
-    if (!hasExplicitProtocolConformance(nom))
+    if (!hasExplicitProtocolConformance(nom) && IRGen.needsTypeRecords(nom))
       RuntimeResolvableTypes.push_back(type);
   }
 }
 
+/// Collect the nominal types whose values or metadata are handed to the
+/// runtime or to generic code by the SIL of the module. This includes the
+/// types which are reachable through the fields, payloads, superclasses and
+/// associated types of such a type, because reflection and generic code can
+/// get to them.
+void IRGenerator::computeDynamicallyUsedTypes() {
+  SmallVector<Type, 32> worklist;
+  auto addType = [&](Type type) {
+    if (type)
+      worklist.push_back(type);
+  };
+  auto addSubstitutions = [&](ArrayRef<Substitution> subs) {
+    for (auto &sub : subs)
+      addType(sub.getReplacement());
+  };
+
+  for (auto &fn : SIL) {
+    for (auto &block : fn) {
+      for (auto &inst : block) {
+        if (auto apply = ApplySite::isa(&inst)) {
+          addSubstitutions(apply.getSubstitutions());
+        } else if (auto *init = dyn_cast<InitExistentialAddrInst>(&inst)) {
+          addType(init->getFormalConcreteType());
+        } else if (auto *init = dyn_cast<InitExistentialRefInst>(&inst)) {
+          addType(init->getFormalConcreteType());
+        } else if (auto *init = dyn_cast<InitExistentialMetatypeInst>(&inst)) {
+          addType(init->getOperand()->getType().getSwiftRValueType());
+        } else if (auto *box = dyn_cast<AllocExistentialBoxInst>(&inst)) {
+          addType(box->getFormalConcreteType());
+        } else if (auto *cast = dyn_cast<CheckedCastAddrBranchInst>(&inst)) {
+          addType(cast->getSourceType());
+          addType(cast->getTargetType());
+        } else if (auto *cast =
+                     dyn_cast<UnconditionalCheckedCastAddrInst>(&inst)) {
+          addType(cast->getSourceType());
+          addType(cast->getTargetType());
+        } else if (auto *cast = dyn_cast<CheckedCastBranchInst>(&inst)) {
+          addType(cast->getOperand()->getType().getSwiftRValueType());
+          addType(cast->getCastType().getSwiftRValueType());
+        } else if (isa<UnconditionalCheckedCastInst>(&inst) ||
+                   isa<MetatypeInst>(&inst) ||
+                   isa<AllocRefInst>(&inst) ||
+                   isa<AllocRefDynamicInst>(&inst)) {
+          addType(inst.getType().getSwiftRValueType());
+          for (auto &op : inst.getAllOperands())
+            addType(op.get()->getType().getSwiftRValueType());
+        } else if (auto *metatype = dyn_cast<ValueMetatypeInst>(&inst)) {
+          addType(metatype->getOperand()->getType().getSwiftRValueType());
+        } else if (auto *block = dyn_cast<InitBlockStorageHeaderInst>(&inst)) {
+          addSubstitutions(block->getSubstitutions());
+        }
+      }
+    }
+  }
+
+  while (!worklist.empty()) {
+    Type type = worklist.pop_back_val();
+    type.visit([&](Type sub) {
+      auto *decl = sub->getAnyNominal();
+      if (!decl || !DynamicallyUsedTypes.insert(decl).second)
+        return;
+
+      if (auto *theClass = dyn_cast<ClassDecl>(decl))
+        addType(theClass->getSuperclass());
+      if (auto *theEnum = dyn_cast<EnumDecl>(decl)) {
+        for (auto *elt : theEnum->getAllElements())
+          if (elt->hasArgumentType())
+            addType(elt->getArgumentType());
+      } else {
+        for (auto *field : decl->getStoredProperties())
+          addType(field->getType());
+      }
+      for (auto *conformance : decl->getAllConformances()) {
+        conformance->forEachTypeWitness(nullptr,
+            [&](AssociatedTypeDecl *, const Substitution &witness,
+                TypeDecl *) -> bool {
+          addType(witness.getReplacement());
+          return false;
+        });
+      }
+    });
+  }
+}
+
+bool IRGenerator::needsTypeRecords(const NominalTypeDecl *decl) {
+  // Without the whole module other files can use any type dynamically, and
+  // the testing mode makes internal types visible to other modules.
+  if (!Opts.StripUnusedTypeRecords || !SIL.isWholeModule() ||
+      SIL.getSwiftModule()->isTestingEnabled())
+    return true;
+
+  // Other modules and the Objective-C runtime can always find these.
+  if (decl->getEffectiveAccess() >= Accessibility::Public ||
+      isa<ProtocolDecl>(decl) || decl->hasClangNode() || decl->isObjC())
+    return true;
+
+  if (!ComputedDynamicallyUsedTypes) {
+    computeDynamicallyUsedTypes();
+    ComputedDynamicallyUsedTypes = true;
+  }
+  return DynamicallyUsedTypes.count(decl);
+}
+
 void IRGenModule::emitGlobalLists() {
   if (ObjCInterop) {
     assert(TargetInfo.OutputObjectFormat == llvm::Triple::MachO);
@@ -789,11 +895,18 @@ void IRGenModule::emitGlobalLists() {
 
 void IRGenerator::emitGlobalTopLevel() {
   // Generate order numbers for the functions in the SIL module that
-  // correspond to definitions in the LLVM module.
+  // correspond to definitions in the LLVM module. Cold functions go after
+  // all the others so that they don't dilute the hot code.
   unsigned nextOrderNumber = 0;
   for (auto &silFn : PrimaryIGM->getSILModule().getFunctions()) {
     // Don't bother adding external declarations to the function order.
     if (!silFn.isDefinition()) continue;
+    if (silFn.hasSemanticsAttr("optimize.cold")) continue;
+    FunctionOrder.insert(std::make_pair(&silFn, nextOrderNumber++));
+  }
+  for (auto &silFn : PrimaryIGM->getSILModule().getFunctions()) {
+    if (!silFn.isDefinition()) continue;
+    if (!silFn.hasSemanticsAttr("optimize.cold")) continue;
     FunctionOrder.insert(std::make_pair(&silFn, nextOrderNumber++));
   }
 
@@ -1386,11 +1499,25 @@ static void updateLinkageForDefinition(IRGenModule &IGM,
     IGM.addUsedGlobal(global);
 }
 
+StringRef IRGenerator::getMangledName(const LinkEntity &entity) {
+  auto found = MangledNames.find(entity);
+  if (found != MangledNames.end())
+    return found->second;
+
+  MangleBuffer.clear();
+  entity.mangle(MangleBuffer);
+  char *Data = MangledNameStorage.Allocate<char>(MangleBuffer.size());
+  std::copy(MangleBuffer.begin(), MangleBuffer.end(), Data);
+  StringRef Copy(Data, MangleBuffer.size());
+  MangledNames.insert({entity, Copy});
+  return Copy;
+}
+
 LinkInfo LinkInfo::get(IRGenModule &IGM, const LinkEntity &entity,
                        ForDefinition_t isDefinition) {
   LinkInfo result;
 
-  entity.mangle(result.Name);
+  result.Name = IGM.IRGen.getMangledName(entity);
 
   std::tie(result.Linkage, result.Visibility, result.DLLStorageClass) =
       getIRLinkage(IGM, entity.getLinkage(IGM, isDefinition),
@@ -1767,6 +1894,10 @@ llvm::Function *IRGenModule::getAddrOfSILFunction(SILFunction *f,
     attrs = attrs.addAttribute(fnType->getContext(),
                 llvm::AttributeSet::FunctionIndex, llvm::Attribute::NoInline);
   }
+  if (f->hasSemanticsAttr("optimize.cold")) {
+    attrs = attrs.addAttribute(fnType->getContext(),
+                llvm::AttributeSet::FunctionIndex, llvm::Attribute::Cold);
+  }
   if (isReadOnlyFunction(f)) {
     attrs = attrs.addAttribute(fnType->getContext(),
                 llvm::AttributeSet::FunctionIndex, llvm::Attribute::ReadOnly);
@@ -1998,9 +2129,8 @@ IRGenModule::getAddrOfLLVMVariableOrGOTEquivalent(LinkEntity entity,
   auto global = cast<llvm::GlobalValue>(entry);
   // Use it as the initializer for an anonymous constant. LLVM can treat this as
   // equivalent to the global's GOT entry.
-  llvm::SmallString<64> name;
-  entity.mangle(name);
-  auto gotEquivalent = createGOTEquivalent(*this, global, name);
+  auto gotEquivalent =
+      createGOTEquivalent(*this, global, IRGen.getMangledName(entity));
   gotEntry = gotEquivalent;
   return {gotEquivalent, ConstantReference::Indirect};
 }
@@ -2151,6 +2281,19 @@ llvm::Constant *IRGenModule::emitProtocolConformances() {
   if (ProtocolConformances.empty())
     return nullptr;
 
+  // Group the records by protocol, keeping protocols in the order in which
+  // they first appear, so that the conformance index can describe each
+  // protocol's records with a single entry.
+  llvm::DenseMap<ProtocolDecl *, unsigned> protocolOrder;
+  for (auto *conformance : ProtocolConformances)
+    protocolOrder.insert({conformance->getProtocol(), protocolOrder.size()});
+  std::stable_sort(ProtocolConformances.begin(), ProtocolConformances.end(),
+                   [&](NormalProtocolConformance *lhs,
+                       NormalProtocolConformance *rhs) {
+    return protocolOrder[lhs->getProtocol()]
+             < protocolOrder[rhs->getProtocol()];
+  });
+
   // Define the global variable for the conformance list.
   // We have to do this before defining the initializer since the entries will
   // contain offsets relative to themselves.
@@ -2221,9 +2364,73 @@ llvm::Constant *IRGenModule::emitProtocolConformances() {
   var->setSection(sectionName);
   var->setAlignment(getPointerAlignment().getValue());
   addUsedGlobal(var);
+
+  emitProtocolConformanceIndex(var);
   return var;
 }
 
+/// Emit the index of the protocol conformance list, with one entry for each
+/// run of records that share a protocol.  The runtime uses it to index a
+/// whole image by protocol without visiting every record.
+void IRGenModule::emitProtocolConformanceIndex(llvm::GlobalVariable *records) {
+  std::string sectionName;
+  switch (TargetInfo.OutputObjectFormat) {
+  case llvm::Triple::MachO:
+    sectionName = "__TEXT, __swift2_protidx, regular, no_dead_strip";
+    break;
+  case llvm::Triple::ELF:
+    sectionName = ".swift2_protocol_conformance_index";
+    break;
+  case llvm::Triple::COFF:
+    sectionName = ".sw2prti";
+    break;
+  default:
+    llvm_unreachable("Don't know how to emit a protocol conformance index "
+                     "for the selected object format.");
+  }
+
+  // Find the runs.  emitProtocolConformances has already grouped the
+  // records by protocol.
+  SmallVector<std::pair<unsigned, unsigned>, 8> runs;
+  for (unsigned i = 0, e = ProtocolConformances.size(); i != e; ++i) {
+    if (i == 0 || ProtocolConformances[i]->getProtocol()
+                    != ProtocolConformances[i - 1]->getProtocol())
+      runs.push_back({i, 0});
+    ++runs.back().second;
+  }
+
+  auto arrayTy = llvm::ArrayType::get(ProtocolConformanceIndexEntryTy,
+                                      runs.size());
+  auto var = new llvm::GlobalVariable(Module, arrayTy,
+                                      /*isConstant*/ true,
+                                      llvm::GlobalValue::PrivateLinkage,
+                                      /*initializer*/ nullptr,
+                                      "\x01l_protocol_conformance_index");
+
+  SmallVector<llvm::Constant*, 8> elts;
+  for (auto &run : runs) {
+    llvm::Constant *firstIndices[] = {
+      llvm::ConstantInt::get(Int32Ty, 0),
+      llvm::ConstantInt::get(Int32Ty, run.first),
+    };
+    auto firstRecord = llvm::ConstantExpr::getInBoundsGetElementPtr(
+                                 /*Ty=*/nullptr, records, firstIndices);
+
+    unsigned arrayIdx = elts.size();
+    llvm::Constant *entryFields[] = {
+      emitDirectRelativeReference(firstRecord, var, { arrayIdx, 0 }),
+      llvm::ConstantInt::get(Int32Ty, run.second),
+    };
+    elts.push_back(llvm::ConstantStruct::get(ProtocolConformanceIndexEntryTy,
+                                             entryFields));
+  }
+
+  var->setInitializer(llvm::ConstantArray::get(arrayTy, elts));
+  var->setSection(sectionName);
+  var->setAlignment(getPointerAlignment().getValue());
+  addUsedGlobal(var);
+}
+
 /// Emit type metadata for types that might not have explicit protocol conformances.
 llvm::Constant *IRGenModule::emitTypeMetadataRecords() {
   std::string sectionName;
@@ -2664,14 +2871,14 @@ ConstantReference IRGenModule::getAddrOfTypeMetadata(CanType concreteType,
   return addr;
 }
 
-/// Return the address of a nominal type descriptor.  Right now, this
-/// must always be for purposes of defining it.
+/// Return the address of a nominal type descriptor.  If no definition type
+/// is given, this just declares the descriptor, which must then be defined
+/// elsewhere in the module.
 llvm::Constant *IRGenModule::getAddrOfNominalTypeDescriptor(NominalTypeDecl *D,
                                                   llvm::Type *definitionType) {
-  assert(definitionType && "not defining nominal type descriptor?");
   auto entity = LinkEntity::forNominalTypeDescriptor(D);
   return getAddrOfLLVMVariable(entity, getPointerAlignment(),
-                               definitionType, definitionType,
+                               definitionType, NominalTypeDescriptorTy,
                                DebugTypeInfo());
 }
 
@@ -2998,7 +3205,8 @@ llvm::Constant *IRGenModule::getAddrOfGlobalUTF16String(StringRef utf8) {
 
 /// Mangle the name of a type.
 StringRef IRGenModule::mangleType(CanType type, SmallVectorImpl<char> &buffer) {
-  LinkEntity::forTypeMangling(type).mangle(buffer);
+  StringRef name = IRGen.getMangledName(LinkEntity::forTypeMangling(type));
+  buffer.append(name.begin(), name.end());
   return StringRef(buffer.data(), buffer.size());
 }
 
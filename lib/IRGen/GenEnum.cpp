@@ -117,6 +117,7 @@
 #include "LoadableTypeInfo.h"
 #include "NonFixedTypeInfo.h"
 #include "ResilientTypeInfo.h"
+#include "ExtraInhabitants.h"
 #include "GenMeta.h"
 #include "GenProto.h"
 #include "GenType.h"
@@ -1681,9 +1682,113 @@ namespace {
       auto opaqueAddr = IGF.Builder.CreateBitCast(enumAddr.getAddress(),
                                                   IGF.IGM.OpaquePtrTy);
 
-      return IGF.Builder.CreateCall(
-                 IGF.IGM.getGetEnumCaseSinglePayloadFn(),
-                 {opaqueAddr, payloadMetadata, numEmptyCases});
+      if (!mayHaveNativeObjectPayload(IGF, T))
+        return IGF.Builder.CreateCall(
+                   IGF.IGM.getGetEnumCaseSinglePayloadFn(),
+                   {opaqueAddr, payloadMetadata, numEmptyCases});
+
+      auto otherBB = emitNativeObjectPayloadCheck(IGF, payloadMetadata);
+      auto contBB = IGF.createBasicBlock("payload-tag");
+      auto nativeTag = getHeapObjectExtraInhabitantIndex(IGF,
+                           Address(opaqueAddr, IGF.IGM.getPointerAlignment()));
+      auto nativeBB = IGF.Builder.GetInsertBlock();
+      IGF.Builder.CreateBr(contBB);
+
+      IGF.Builder.emitBlock(otherBB);
+      auto otherTag = IGF.Builder.CreateCall(
+                          IGF.IGM.getGetEnumCaseSinglePayloadFn(),
+                          {opaqueAddr, payloadMetadata, numEmptyCases});
+      IGF.Builder.CreateBr(contBB);
+
+      IGF.Builder.emitBlock(contBB);
+      auto tag = IGF.Builder.CreatePHI(IGF.IGM.Int32Ty, 2);
+      tag->addIncoming(nativeTag, nativeBB);
+      tag->addIncoming(otherTag, otherBB);
+      return tag;
+    }
+
+    /// Is the payload a type parameter, which may be bound to a class type,
+    /// and do all the empty cases fit into the extra inhabitants of a heap
+    /// object reference? Then the tag can be handled inline when the payload
+    /// turns out to be a native Swift reference at runtime.
+    bool mayHaveNativeObjectPayload(IRGenFunction &IGF, SILType T) const {
+      if (ElementsWithNoPayload.size()
+            > getHeapObjectExtraInhabitantCount(IGF.IGM))
+        return false;
+      auto payloadTy = T.getEnumElementType(getPayloadElement(),
+                                            IGF.IGM.getSILModule());
+      return payloadTy.is<ArchetypeType>();
+    }
+
+    /// Branch on whether the payload metadata has the value witness table of
+    /// Builtin.NativeObject, which all native Swift classes share. Leaves the
+    /// builder in the block for native references and returns the block for
+    /// all other payloads.
+    llvm::BasicBlock *emitNativeObjectPayloadCheck(IRGenFunction &IGF,
+                                      llvm::Value *payloadMetadata) const {
+      auto vwtable = IGF.emitValueWitnessTableRefForMetadata(payloadMetadata);
+      auto nativeObjectTy = IGF.IGM.Context.TheNativeObjectType;
+      auto nativeObjectVWTable = llvm::ConstantExpr::getBitCast(
+          IGF.IGM.getAddrOfValueWitnessTable(nativeObjectTy),
+          vwtable->getType());
+      auto isNativeObject = IGF.Builder.CreateICmpEQ(vwtable,
+                                                     nativeObjectVWTable);
+
+      auto nativeBB = IGF.createBasicBlock("native-payload");
+      auto otherBB = IGF.createBasicBlock("other-payload");
+      IGF.Builder.CreateCondBr(isNativeObject, nativeBB, otherBB);
+      IGF.Builder.emitBlock(nativeBB);
+      return otherBB;
+    }
+
+    /// Emit a call into the runtime to store a tag index in the range
+    /// [-1..ElementsWithNoPayload-1]. If the payload may be a native Swift
+    /// reference, the tag of a reference is stored inline instead.
+    void emitStoreEnumTagSinglePayload(IRGenFunction &IGF,
+                                       SILType T,
+                                       Address enumAddr,
+                                       llvm::Value *payloadMetadata,
+                                       llvm::Value *tag) const {
+      llvm::Value *numEmptyCases = llvm::ConstantInt::get(IGF.IGM.Int32Ty,
+                                                ElementsWithNoPayload.size());
+
+      llvm::Value *opaqueAddr
+        = IGF.Builder.CreateBitCast(enumAddr.getAddress(),
+                                    IGF.IGM.OpaquePtrTy);
+
+      if (!mayHaveNativeObjectPayload(IGF, T)) {
+        IGF.Builder.CreateCall(IGF.IGM.getStoreEnumTagSinglePayloadFn(),
+                               {opaqueAddr, payloadMetadata, tag,
+                                numEmptyCases});
+        return;
+      }
+
+      auto otherBB = emitNativeObjectPayloadCheck(IGF, payloadMetadata);
+      auto contBB = IGF.createBasicBlock("tag-stored");
+
+      // A reference payload has no extra tag bits to clear, so there is
+      // nothing to store for the payload case.
+      auto constantTag = dyn_cast<llvm::ConstantInt>(tag);
+      if (!constantTag || !constantTag->isMinusOne()) {
+        if (!constantTag) {
+          auto storeBB = IGF.createBasicBlock("store-extra-inhabitant");
+          auto isPayload = IGF.Builder.CreateICmpSLT(tag,
+                               llvm::ConstantInt::get(IGF.IGM.Int32Ty, 0));
+          IGF.Builder.CreateCondBr(isPayload, contBB, storeBB);
+          IGF.Builder.emitBlock(storeBB);
+        }
+        storeHeapObjectExtraInhabitant(IGF, tag,
+                           Address(opaqueAddr, IGF.IGM.getPointerAlignment()));
+      }
+      IGF.Builder.CreateBr(contBB);
+
+      IGF.Builder.emitBlock(otherBB);
+      IGF.Builder.CreateCall(IGF.IGM.getStoreEnumTagSinglePayloadFn(),
+                             {opaqueAddr, payloadMetadata, tag,
+                              numEmptyCases});
+      IGF.Builder.CreateBr(contBB);
+
+      IGF.Builder.emitBlock(contBB);
     }
 
     /// The payload for a single-payload enum is always placed in front and
@@ -2507,14 +2612,9 @@ namespace {
       }
 
       // Ask the runtime to store the tag.
-      llvm::Value *opaqueAddr = IGF.Builder.CreateBitCast(dest.getAddress(),
-                                                          IGF.IGM.OpaquePtrTy);
       llvm::Value *metadata = emitPayloadMetadataForLayout(IGF, T);
-      IGF.Builder.CreateCall(IGF.IGM.getStoreEnumTagSinglePayloadFn(),
-                             {opaqueAddr, metadata,
-                              llvm::ConstantInt::getSigned(IGF.IGM.Int32Ty, -1),
-                              llvm::ConstantInt::get(IGF.IGM.Int32Ty,
-                                                 ElementsWithNoPayload.size())});
+      emitStoreEnumTagSinglePayload(IGF, T, dest, metadata,
+                             llvm::ConstantInt::getSigned(IGF.IGM.Int32Ty, -1));
     }
 
     /// Emit a reassignment sequence from an enum at one address to another.
@@ -2733,15 +2833,7 @@ namespace {
           caseIndex = llvm::ConstantInt::get(IGF.IGM.Int32Ty, caseIndexVal);
         }
 
-        llvm::Value *numEmptyCases = llvm::ConstantInt::get(IGF.IGM.Int32Ty,
-                                                  ElementsWithNoPayload.size());
-
-        llvm::Value *opaqueAddr
-          = IGF.Builder.CreateBitCast(enumAddr.getAddress(),
-                                      IGF.IGM.OpaquePtrTy);
-
-        IGF.Builder.CreateCall(IGF.IGM.getStoreEnumTagSinglePayloadFn(),
-                               {opaqueAddr, payload, caseIndex, numEmptyCases});
+        emitStoreEnumTagSinglePayload(IGF, T, enumAddr, payload, caseIndex);
 
         return;
       }
@@ -2774,15 +2866,7 @@ namespace {
                       Address enumAddr,
                       llvm::Value *tag) const override {
       llvm::Value *payload = emitPayloadMetadataForLayout(IGF, T);
-      llvm::Value *numEmptyCases = llvm::ConstantInt::get(IGF.IGM.Int32Ty,
-                                                ElementsWithNoPayload.size());
-
-      llvm::Value *opaqueAddr
-        = IGF.Builder.CreateBitCast(enumAddr.getAddress(),
-                                    IGF.IGM.OpaquePtrTy);
-
-      IGF.Builder.CreateCall(IGF.IGM.getStoreEnumTagSinglePayloadFn(),
-                             {opaqueAddr, payload, tag, numEmptyCases});
+      emitStoreEnumTagSinglePayload(IGF, T, enumAddr, payload, tag);
     }
 
     void initializeMetadata(IRGenFunction &IGF,
@@ -4241,6 +4325,17 @@ namespace {
     void assignWithCopy(IRGenFunction &IGF, Address dest, Address src,
                         SILType T)
     const override {
+      // The switch over all the payloads is worth outlining.
+      if (CopyDestroyKind != POD &&
+          tryEmitOutlinedOperation(IGF, *TI, T,
+                                   OutlinedOperation::AssignWithCopy,
+                                   dest, src,
+                                   [&](IRGenFunction &IGF, Address dest,
+                                       Address src) {
+            emitIndirectAssign(IGF, dest, src, T, IsNotTake);
+          }))
+        return;
+
       emitIndirectAssign(IGF, dest, src, T, IsNotTake);
     }
 
@@ -4253,6 +4348,16 @@ namespace {
     void initializeWithCopy(IRGenFunction &IGF, Address dest, Address src,
                             SILType T)
     const override {
+      if (CopyDestroyKind != POD &&
+          tryEmitOutlinedOperation(IGF, *TI, T,
+                                   OutlinedOperation::InitializeWithCopy,
+                                   dest, src,
+                                   [&](IRGenFunction &IGF, Address dest,
+                                       Address src) {
+            emitIndirectInitialize(IGF, dest, src, T, IsNotTake);
+          }))
+        return;
+
       emitIndirectInitialize(IGF, dest, src, T, IsNotTake);
     }
 
@@ -4263,6 +4368,20 @@ namespace {
     }
 
     void destroy(IRGenFunction &IGF, Address addr, SILType T) const override {
+      if (CopyDestroyKind != POD &&
+          tryEmitOutlinedOperation(IGF, *TI, T, OutlinedOperation::Destroy,
+                                   addr, Address(),
+                                   [&](IRGenFunction &IGF, Address addr,
+                                       Address) {
+            emitDestroy(IGF, addr, T);
+          }))
+        return;
+
+      emitDestroy(IGF, addr, T);
+    }
+
+  private:
+    void emitDestroy(IRGenFunction &IGF, Address addr, SILType T) const {
       switch (CopyDestroyKind) {
       case POD:
         return;
@@ -4297,7 +4416,6 @@ namespace {
       }
     }
 
-  private:
     void storePayloadTag(IRGenFunction &IGF, Address enumAddr,
                          unsigned index, SILType T) const {
       // If the tag has spare bits, we need to mask them into the
@@ -31,6 +31,7 @@
 #include "Explosion.h"
 #include "FixedTypeInfo.h"
 #include "GenClass.h"
+#include "GenEnum.h"
 #include "GenHeap.h"
 #include "GenMeta.h"
 #include "GenOpaque.h"
@@ -1720,6 +1721,123 @@ OwnedAddress irgen::emitBoxedExistentialContainerAllocation(IRGenFunction &IGF,
   return OwnedAddress(srcTI.getAddressForPointer(addr), box);
 }
 
+/// The reference counts of a statically allocated error box. They must match
+/// StrongRefCount(Immortal) and WeakRefCount(Initialized) in RefCount.h.
+enum : uint32_t {
+  StaticErrorBoxStrongRefCount = 0xFFFFFFFC,
+  StaticErrorBoxWeakRefCount = 2,
+};
+
+/// Returns the storage of the enum case \p theCase as a constant, or null if
+/// the enum has a layout in which the case isn't just a discriminator.
+static llvm::Constant *getConstantCaseValue(IRGenModule &IGM, CanType type,
+                                            EnumElementDecl *theCase) {
+  auto &TI = IGM.getTypeInfoForUnlowered(type);
+  auto &strategy = getEnumImplStrategy(IGM, type);
+  if (!isa<FixedTypeInfo>(TI) || !strategy.getElementsWithPayload().empty())
+    return nullptr;
+
+  auto storageTy = dyn_cast<llvm::StructType>(TI.getStorageType());
+  if (!storageTy)
+    return nullptr;
+  if (TI.isKnownEmpty(ResilienceExpansion::Maximal))
+    return llvm::Constant::getNullValue(storageTy);
+
+  int64_t index = strategy.getDiscriminatorIndex(theCase);
+  if (index < 0 || storageTy->getNumElements() != 1)
+    return nullptr;
+  auto discriminatorTy =
+    dyn_cast<llvm::IntegerType>(storageTy->getElementType(0));
+  if (!discriminatorTy)
+    return nullptr;
+  return llvm::ConstantStruct::get(storageTy,
+                          llvm::ConstantInt::get(discriminatorTy, index));
+}
+
+/// Get or create a statically allocated error box holding the case
+/// \p theCase of an enum without payloads.
+///
+/// The box has the layout of a box allocated by swift_allocError and is
+/// immortal, so retaining and releasing it doesn't write to memory and it is
+/// never freed. Returns null if the case can't be boxed statically.
+llvm::Constant *
+IRGenModule::getAddrOfStaticErrorBox(CanType type,
+                                     ProtocolConformanceRef conformance,
+                                     EnumElementDecl *theCase) {
+  auto found = StaticErrorBoxes.find(theCase);
+  if (found != StaticErrorBoxes.end())
+    return found->second;
+
+  // With ObjC interop, error boxes are NSError subclass instances, which are
+  // laid out by the runtime.
+  llvm::Constant *box = nullptr;
+  if (!ObjCInterop) {
+    auto metadata = tryEmitConstantTypeMetadataRef(*this, type,
+                                                SymbolReferenceKind::Absolute);
+    auto witness = tryEmitConstantWitnessTableRef(*this, type, conformance);
+    auto value = getConstantCaseValue(*this, type, theCase);
+    if (metadata && !metadata.isIndirect() && witness && value) {
+      llvm::Constant *header[] = {
+        getErrorBoxMetadata(),
+        llvm::ConstantInt::get(Int32Ty, StaticErrorBoxStrongRefCount),
+        llvm::ConstantInt::get(Int32Ty, StaticErrorBoxWeakRefCount)
+      };
+      llvm::Constant *fields[] = {
+        llvm::ConstantStruct::get(RefCountedStructTy, header),
+        llvm::ConstantExpr::getBitCast(metadata.getDirectValue(),
+                                       TypeMetadataPtrTy),
+        llvm::ConstantExpr::getBitCast(witness, WitnessTablePtrTy),
+        value
+      };
+      auto init = llvm::ConstantStruct::getAnon(LLVMContext, fields);
+
+      // The value is not constant for LLVM: the runtime doesn't write to
+      // immortal objects, but it may be handed to code which isn't known.
+      auto var = new llvm::GlobalVariable(Module, init->getType(),
+                                          /*constant*/ false,
+                                          llvm::GlobalValue::PrivateLinkage,
+                                          init, "_swift_static_error_box");
+      var->setAlignment(getPointerAlignment().getValue());
+      box = var;
+    }
+  }
+
+  StaticErrorBoxes.insert({theCase, box});
+  return box;
+}
+
+/// Use a statically allocated boxed existential container holding the case
+/// \p theCase of an enum without payloads, instead of allocating one.
+Optional<OwnedAddress>
+irgen::emitStaticBoxedExistentialContainer(IRGenFunction &IGF,
+                                           SILType destType,
+                                           CanType formalSrcType,
+                                  ArrayRef<ProtocolConformanceRef> conformances,
+                                           EnumElementDecl *theCase) {
+  // TODO: Non-Error boxed existentials.
+  assert(_isError(destType));
+  assert(conformances.size() == 1);
+
+  auto var = IGF.IGM.getAddrOfStaticErrorBox(formalSrcType, conformances[0],
+                                             theCase);
+  if (!var)
+    return None;
+
+  auto archetype = ArchetypeType::getOpened(destType.getSwiftRValueType());
+  auto &srcTI = IGF.getTypeInfoForUnlowered(AbstractionPattern(archetype),
+                                            formalSrcType);
+  auto box = llvm::ConstantExpr::getBitCast(var, IGF.IGM.ErrorPtrTy);
+  llvm::Constant *indices[] = {
+    llvm::ConstantInt::get(IGF.IGM.Int32Ty, 0),
+    llvm::ConstantInt::get(IGF.IGM.Int32Ty, 3)
+  };
+  llvm::Constant *addr = llvm::ConstantExpr::getInBoundsGetElementPtr(
+      cast<llvm::GlobalVariable>(var)->getValueType(), var, indices);
+  addr = llvm::ConstantExpr::getBitCast(addr,
+                                        srcTI.getStorageType()->getPointerTo());
+  return OwnedAddress(srcTI.getAddressForPointer(addr), box);
+}
+
 /// Deallocate a boxed existential container with uninitialized space to hold a
 /// value of a given type.
 void irgen::emitBoxedExistentialContainerDeallocation(IRGenFunction &IGF,
@@ -26,6 +26,7 @@ namespace llvm {
 }
 
 namespace swift {
+  class EnumElementDecl;
   class ProtocolConformanceRef;
   class SILType;
 
@@ -69,6 +70,15 @@ namespace irgen {
                                   SILType destType,
                                   CanType formalSrcType,
                                  ArrayRef<ProtocolConformanceRef> conformances);
+
+  /// Use a statically allocated boxed existential container holding a case
+  /// of an enum without payloads, if the case can be boxed statically.
+  Optional<OwnedAddress> emitStaticBoxedExistentialContainer(
+                                  IRGenFunction &IGF,
+                                  SILType destType,
+                                  CanType formalSrcType,
+                                  ArrayRef<ProtocolConformanceRef> conformances,
+                                  EnumElementDecl *theCase);
   
   /// "Deinitialize" an existential container whose contained value is allocated
   /// but uninitialized, by deallocating the buffer owned by the container if any.
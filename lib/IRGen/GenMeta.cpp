@@ -41,6 +41,7 @@
 #include "FixedTypeInfo.h"
 #include "GenClass.h"
 #include "GenPoly.h"
+#include "GenProto.h"
 #include "GenValueWitness.h"
 #include "GenArchetype.h"
 #include "GenStruct.h"
@@ -124,9 +125,8 @@ static Address createPointerSizedGEP(IRGenFunction &IGF,
 static llvm::Constant *getMangledTypeName(IRGenModule &IGM, CanType type,
                                       bool willBeRelativelyAddressed = false) {
   auto name = LinkEntity::forTypeMangling(type);
-  llvm::SmallString<32> mangling;
-  name.mangle(mangling);
-  return IGM.getAddrOfGlobalString(mangling, willBeRelativelyAddressed);
+  return IGM.getAddrOfGlobalString(IGM.IRGen.getMangledName(name),
+                                   willBeRelativelyAddressed);
 }
 
 llvm::Value *irgen::emitObjCMetadataRefForMetadata(IRGenFunction &IGF,
@@ -1302,6 +1302,9 @@ emitInPlaceTypeMetadataAccessFunctionBody(IRGenFunction &IGF,
   return relocatedMetadata;
 }
 
+static llvm::Value *emitPrespecializedGenericMetadataRef(IRGenFunction &IGF,
+                                                       CanType type);
+
 /// Emit the body of a metadata accessor function for the given type.
 ///
 /// This function is appropriate for ordinary situations where the
@@ -1322,6 +1325,10 @@ static llvm::Value *emitTypeMetadataAccessFunctionBody(IRGenFunction &IGF,
   if (typeDecl->isGenericContext() &&
       !(isa<ClassDecl>(typeDecl) && typeDecl->hasClangNode())) {
     // This is a metadata accessor for a fully substituted generic type.
+    if (IGF.IGM.IRGen.Opts.EnableGenericMetadataPrespecialization) {
+      if (auto metadata = emitPrespecializedGenericMetadataRef(IGF, type))
+        return metadata;
+    }
     return emitDirectTypeMetadataRef(IGF, type);
   }
 
@@ -3055,8 +3062,13 @@ namespace {
       auto headerFields =
         this->claimReservation(header, TemplateHeaderFieldCount);
 
-      //   Metadata *(*CreateFunction)(GenericMetadata *, const void*);
-      headerFields[Field++] = emitCreateFunction();
+      //   FarRelativeDirectPointer<
+      //     Metadata *(GenericMetadata *, const void*)> CreateFunction;
+      // The header is at the start of the pattern.
+      headerFields[Field++] =
+        this->getRelativeAddressFromField({emitCreateFunction(),
+                                           ConstantReference::Direct},
+                                          IGM.FarRelativeAddressTy, Size(0));
       
       //   uint32_t MetadataSize;
       // We compute this assuming that every entry in the metadata table
@@ -4962,6 +4974,202 @@ namespace {
   };
 }
 
+namespace {
+  /// A builder for the fully instantiated metadata of a generic struct
+  /// whose generic arguments are all known at compile time.
+  ///
+  /// The result has the same layout as the metadata that
+  /// swift_getGenericMetadata would instantiate from the struct's pattern.
+  /// It only refers to the pattern's nominal type descriptor and value
+  /// witness table, which are defined along with the pattern.
+  class PrespecializedStructMetadataBuilder :
+    public StructMetadataBuilderBase<PrespecializedStructMetadataBuilder> {
+
+    using super =
+      StructMetadataBuilderBase<PrespecializedStructMetadataBuilder>;
+
+    CanType SpecializedType;
+
+    /// The key arguments of the instantiation, in the order expected by
+    /// swift_getGenericMetadata.
+    SmallVector<llvm::Constant *, 4> Arguments;
+
+  public:
+    PrespecializedStructMetadataBuilder(IRGenModule &IGM, CanType type,
+                                    llvm::GlobalVariable *relativeAddressBase)
+      : super(IGM, type->getStructOrBoundGenericStruct(),
+              relativeAddressBase),
+        SpecializedType(type) {}
+
+    ArrayRef<llvm::Constant *> getArguments() const { return Arguments; }
+
+    void layout() {
+      super::layout();
+
+      // Reserve the slot for the field type vector, like the pattern does.
+      addWord(
+         llvm::ConstantPointerNull::get(IGM.TypeMetadataPtrTy->getPointerTo()));
+    }
+
+    void addValueWitnessTable() {
+      CanType unboundType
+        = Target->getDeclaredTypeOfContext()->getCanonicalType();
+      assert(!hasDependentValueWitnessTable(IGM, unboundType));
+      addWord(IGM.getAddrOfValueWitnessTable(unboundType));
+    }
+
+    void addNominalTypeDescriptor() {
+      // The descriptor is emitted along with the pattern.
+      addFarRelativeAddress(
+                     IGM.getAddrOfNominalTypeDescriptor(Target, nullptr));
+    }
+
+    void flagUnfilledParent() {
+      llvm_unreachable("parent metadata of prespecialized type not constant");
+    }
+
+    void flagUnfilledFieldOffset() {
+      llvm_unreachable("prespecialized type has dependent layout");
+    }
+
+    void addGenericFields(NominalTypeDecl *typeDecl, Type type) {
+      // Lay out the arguments of the specialized type instead of the
+      // archetypes of the declaration.
+      super::addGenericFields(typeDecl, SpecializedType);
+    }
+
+    void addGenericArgument(CanType type) {
+      auto metadata =
+        tryEmitConstantTypeMetadataRef(IGM, type,
+                                       SymbolReferenceKind::Absolute)
+          .getDirectValue();
+      assert(metadata && "generic argument metadata not constant");
+      Arguments.push_back(metadata);
+      addWord(metadata);
+    }
+
+    void addGenericWitnessTable(CanType type, ProtocolConformanceRef conf) {
+      auto table = tryEmitConstantWitnessTableRef(IGM, type, conf);
+      assert(table && "generic argument witness table not constant");
+      Arguments.push_back(table);
+      addWord(table);
+    }
+  };
+}
+
+/// Returns true if the metadata of the given generic struct instantiation
+/// can be emitted at compile time.
+///
+/// This requires the layout of the struct not to depend on its generic
+/// arguments, and all arguments to be compile-time constants. The pattern
+/// must be defined in this module, so that its descriptor and value witness
+/// table are available.
+static bool canPrespecializeGenericStructMetadata(IRGenModule &IGM,
+                                                  CanType type) {
+  auto structDecl = type->getStructOrBoundGenericStruct();
+  if (!structDecl || !isa<BoundGenericStructType>(type))
+    return false;
+  if (structDecl->getModuleContext() != IGM.getSwiftModule() ||
+      structDecl->hasClangNode())
+    return false;
+
+  GenericTypeRequirements requirements(IGM, structDecl);
+  if (requirements.hasParentType())
+    return false;
+
+  if (Type parentType =
+        structDecl->getDeclContext()->getDeclaredTypeInContext()) {
+    if (!isTypeMetadataAccessTrivial(IGM, parentType->getCanonicalType()))
+      return false;
+  }
+
+  CanType unboundType
+    = structDecl->getDeclaredTypeOfContext()->getCanonicalType();
+  if (hasDependentValueWitnessTable(IGM, unboundType))
+    return false;
+
+  bool allConstant = true;
+  auto subs = type->gatherAllSubstitutions(IGM.getSwiftModule(), nullptr);
+  requirements.enumerateFulfillments(IGM, subs,
+                                [&](unsigned reqtIndex, CanType argType,
+                                    Optional<ProtocolConformanceRef> conf) {
+    if (conf) {
+      if (!tryEmitConstantWitnessTableRef(IGM, argType, *conf))
+        allConstant = false;
+    } else if (!isTypeMetadataAccessTrivial(IGM, argType)) {
+      allConstant = false;
+    }
+  });
+  return allConstant;
+}
+
+/// Emit the metadata of a generic struct instantiation as a constant and
+/// register it with the runtime's metadata cache for the struct's pattern.
+///
+/// Returns null if the instantiation can't be prespecialized; the caller
+/// then has to instantiate the metadata at runtime.
+static llvm::Value *emitPrespecializedGenericMetadataRef(IRGenFunction &IGF,
+                                                       CanType type) {
+  IRGenModule &IGM = IGF.IGM;
+  if (!canPrespecializeGenericStructMetadata(IGM, type))
+    return nullptr;
+
+  auto structDecl = type->getStructOrBoundGenericStruct();
+  auto tempBase = createTemporaryRelativeAddressBase(IGM);
+  PrespecializedStructMetadataBuilder builder(IGM, type, tempBase.get());
+  builder.layout();
+
+  // The metadata is not constant: the runtime caches the field type vector
+  // in it.
+  auto init = builder.getInit();
+  auto var = new llvm::GlobalVariable(IGM.Module, init->getType(),
+                                   /*constant*/ false,
+                                   llvm::GlobalValue::PrivateLinkage, init,
+                                   Twine("prespecialized_metadata_")
+                                     + structDecl->getName().str());
+  var->setAlignment(IGM.getPointerAlignment().getValue());
+  replaceTemporaryRelativeAddressBase(IGM, std::move(tempBase), var);
+
+  llvm::Constant *indices[] = {
+    llvm::ConstantInt::get(IGM.Int32Ty, 0),
+    llvm::ConstantInt::get(IGM.Int32Ty, MetadataAdjustmentIndex::ValueType)
+  };
+  llvm::Constant *metadata =
+    llvm::ConstantExpr::getInBoundsGetElementPtr(/*Ty=*/nullptr, var, indices);
+  metadata = llvm::ConstantExpr::getBitCast(metadata, IGM.TypeMetadataPtrTy);
+
+  // The key arguments for the cache lookup.
+  SmallVector<llvm::Constant *, 4> arguments;
+  for (auto argument : builder.getArguments())
+    arguments.push_back(llvm::ConstantExpr::getBitCast(argument,
+                                                       IGM.Int8PtrTy));
+  auto argumentsInit = llvm::ConstantArray::get(
+      llvm::ArrayType::get(IGM.Int8PtrTy, arguments.size()), arguments);
+  auto argumentsVar = new llvm::GlobalVariable(IGM.Module,
+                                   argumentsInit->getType(),
+                                   /*constant*/ true,
+                                   llvm::GlobalValue::PrivateLinkage,
+                                   argumentsInit,
+                                   Twine("prespecialized_arguments_")
+                                     + structDecl->getName().str());
+  argumentsVar->setAlignment(IGM.getPointerAlignment().getValue());
+
+  CanType declaredType = structDecl->getDeclaredType()->getCanonicalType();
+  llvm::Value *pattern = IGM.getAddrOfTypeMetadata(declaredType, true);
+
+  // The runtime returns our metadata, unless the same instantiation was
+  // already created by someone else.
+  auto result = IGF.Builder.CreateCall(
+      IGM.getGetPrespecializedGenericMetadataFn(),
+      {pattern,
+       llvm::ConstantExpr::getBitCast(argumentsVar, IGM.Int8PtrTy),
+       metadata});
+  result->setDoesNotThrow();
+  result->addAttribute(llvm::AttributeSet::FunctionIndex,
+                       llvm::Attribute::ReadOnly);
+  return result;
+}
+
 /// Emit the type metadata or metadata template for a struct.
 void irgen::emitStructMetadata(IRGenModule &IGM, StructDecl *structDecl) {
   // Set up a dummy global to stand in for the metadata object while we produce
@@ -5542,6 +5750,7 @@ SpecialProtocol irgen::getSpecialProtocolID(ProtocolDecl *P) {
   case KnownProtocolKind::ObjectiveCBridgeable:
   case KnownProtocolKind::DestructorSafeContainer:
   case KnownProtocolKind::SwiftNewtypeWrapper:
+  case KnownProtocolKind::ExpressibleByBufferedStringInterpolation:
   case KnownProtocolKind::ExpressibleByArrayLiteral:
   case KnownProtocolKind::ExpressibleByBooleanLiteral:
   case KnownProtocolKind::ExpressibleByDictionaryLiteral:
@@ -5608,7 +5817,7 @@ namespace {
       
       auto name = LinkEntity::forTypeMangling(
         Protocol->getDeclaredType()->getCanonicalType());
-      name.mangle(mangling);
+      mangling += IGM.IRGen.getMangledName(name);
       auto global = IGM.getAddrOfGlobalString(mangling);
       addWord(global);
     }
@@ -528,11 +528,8 @@ void irgen::emitInitializeArrayWithCopyCall(IRGenFunction &IGF,
                                             Address srcObject,
                                             llvm::Value *count) {
   auto metadata = IGF.emitTypeMetadataRefForLayout(T);
-  llvm::Value *copyFn = IGF.emitValueWitnessForLayout(T,
-                                         ValueWitness::InitializeArrayWithCopy);
-
   llvm::CallInst *call =
-    IGF.Builder.CreateCall(copyFn,
+    IGF.Builder.CreateCall(IGF.IGM.getArrayInitWithCopyFn(),
       {destObject.getAddress(), srcObject.getAddress(), count, metadata});
   call->setCallingConv(IGF.IGM.DefaultCC);
   call->setDoesNotThrow();
@@ -560,10 +557,8 @@ void irgen::emitInitializeArrayWithTakeFrontToBackCall(IRGenFunction &IGF,
                                             Address srcObject,
                                             llvm::Value *count) {
   auto metadata = IGF.emitTypeMetadataRefForLayout(T);
-  llvm::Value *copyFn = IGF.emitValueWitnessForLayout(T,
-                             ValueWitness::InitializeArrayWithTakeFrontToBack);
   llvm::CallInst *call =
-    IGF.Builder.CreateCall(copyFn,
+    IGF.Builder.CreateCall(IGF.IGM.getArrayInitWithTakeFrontToBackFn(),
       {destObject.getAddress(), srcObject.getAddress(), count, metadata});
   call->setCallingConv(IGF.IGM.DefaultCC);
   call->setDoesNotThrow();
@@ -576,10 +571,8 @@ void irgen::emitInitializeArrayWithTakeBackToFrontCall(IRGenFunction &IGF,
                                             Address srcObject,
                                             llvm::Value *count) {
   auto metadata = IGF.emitTypeMetadataRefForLayout(T);
-  llvm::Value *copyFn = IGF.emitValueWitnessForLayout(T,
-                             ValueWitness::InitializeArrayWithTakeBackToFront);
   llvm::CallInst *call =
-    IGF.Builder.CreateCall(copyFn,
+    IGF.Builder.CreateCall(IGF.IGM.getArrayInitWithTakeBackToFrontFn(),
       {destObject.getAddress(), srcObject.getAddress(), count, metadata});
   call->setCallingConv(IGF.IGM.DefaultCC);
   call->setDoesNotThrow();
@@ -646,10 +639,9 @@ void irgen::emitDestroyArrayCall(IRGenFunction &IGF,
                                  Address object,
                                  llvm::Value *count) {
   auto metadata = IGF.emitTypeMetadataRefForLayout(T);
-  llvm::Value *fn = IGF.emitValueWitnessForLayout(T,
-                                   ValueWitness::DestroyArray);
   llvm::CallInst *call =
-    IGF.Builder.CreateCall(fn, {object.getAddress(), count, metadata});
+    IGF.Builder.CreateCall(IGF.IGM.getArrayDestroyFn(),
+                           {object.getAddress(), count, metadata});
   call->setCallingConv(IGF.IGM.DefaultCC);
   setHelperAttributes(call);
 }
@@ -2324,6 +2324,23 @@ llvm::Value *irgen::emitWitnessTableRef(IRGenFunction &IGF,
   return conformanceI.getTable(IGF, srcType, srcMetadataCache);
 }
 
+llvm::Constant *
+irgen::tryEmitConstantWitnessTableRef(IRGenModule &IGM, CanType srcType,
+                                      ProtocolConformanceRef conformance) {
+  // Abstract conformances are only known at runtime.
+  if (conformance.isAbstract())
+    return nullptr;
+
+  auto proto = conformance.getRequirement();
+  auto concreteConformance = conformance.getConcrete();
+  if (concreteConformance->getProtocol() != proto) {
+    concreteConformance = concreteConformance->getInheritedConformance(proto);
+  }
+  auto &protoI = IGM.getProtocolInfo(proto);
+  auto &conformanceI = protoI.getConformance(IGM, proto, concreteConformance);
+  return conformanceI.tryGetConstantTable(IGM, srcType);
+}
+
 /// Emit the witness table references required for the given type
 /// substitution.
 void irgen::emitWitnessTableRefs(IRGenFunction &IGF,
@@ -157,6 +157,12 @@ namespace irgen {
                                    CanType srcType,
                                    ProtocolConformanceRef conformance);
 
+  /// Try to emit a witness table reference as a compile-time constant.
+  /// Returns null if the witness table needs to be instantiated at runtime.
+  llvm::Constant *tryEmitConstantWitnessTableRef(IRGenModule &IGM,
+                                                CanType srcType,
+                                           ProtocolConformanceRef conformance);
+
   /// An entry in a list of known protocols.
   class ProtocolEntry {
     ProtocolDecl *Protocol;
@@ -22,6 +22,7 @@
 #include "IRGenModule.h"
 #include "Explosion.h"
 #include "GenEnum.h"
+#include "GenType.h"
 #include "LoadableTypeInfo.h"
 #include "TypeInfo.h"
 #include "StructLayout.h"
@@ -135,8 +136,19 @@ public:
     }
   }
 
-  void assignWithCopy(IRGenFunction &IGF, Address dest,
-                      Address src, SILType T) const override {
+private:
+  /// Copying or destroying more than one non-POD field in place is worth
+  /// outlining.
+  bool isWorthOutlining() const {
+    unsigned numNonPODFields = 0;
+    for (auto &field : getFields())
+      if (!field.isPOD())
+        ++numNonPODFields;
+    return numNonPODFields > 1;
+  }
+
+  void emitFieldsAssignWithCopy(IRGenFunction &IGF, Address dest,
+                                Address src, SILType T) const {
     auto offsets = asImpl().getNonFixedOffsets(IGF, T);
     for (auto &field : getFields()) {
       if (field.isEmpty()) continue;
@@ -148,6 +160,44 @@ public:
     }
   }
 
+  void emitFieldsInitializeWithCopy(IRGenFunction &IGF, Address dest,
+                                    Address src, SILType T) const {
+    auto offsets = asImpl().getNonFixedOffsets(IGF, T);
+    for (auto &field : getFields()) {
+      if (field.isEmpty()) continue;
+
+      Address destField = field.projectAddress(IGF, dest, offsets);
+      Address srcField = field.projectAddress(IGF, src, offsets);
+      field.getTypeInfo().initializeWithCopy(IGF, destField, srcField,
+                                             field.getType(IGF.IGM, T));
+    }
+  }
+
+  void emitFieldsDestroy(IRGenFunction &IGF, Address addr, SILType T) const {
+    auto offsets = asImpl().getNonFixedOffsets(IGF, T);
+    for (auto &field : getFields()) {
+      if (field.isPOD()) continue;
+
+      field.getTypeInfo().destroy(IGF, field.projectAddress(IGF, addr, offsets),
+                                  field.getType(IGF.IGM, T));
+    }
+  }
+
+public:
+  void assignWithCopy(IRGenFunction &IGF, Address dest,
+                      Address src, SILType T) const override {
+    if (isWorthOutlining() &&
+        tryEmitOutlinedOperation(IGF, *this, T,
+                                 OutlinedOperation::AssignWithCopy, dest, src,
+                                 [&](IRGenFunction &IGF, Address dest,
+                                     Address src) {
+          emitFieldsAssignWithCopy(IGF, dest, src, T);
+        }))
+      return;
+
+    emitFieldsAssignWithCopy(IGF, dest, src, T);
+  }
+
   void assignWithTake(IRGenFunction &IGF, Address dest,
                       Address src, SILType T) const override {
     auto offsets = asImpl().getNonFixedOffsets(IGF, T);
@@ -171,15 +221,17 @@ public:
                LoadableTypeInfo::initializeWithCopy(IGF, dest, src, T);
     }
 
-    auto offsets = asImpl().getNonFixedOffsets(IGF, T);
-    for (auto &field : getFields()) {
-      if (field.isEmpty()) continue;
+    if (isWorthOutlining() &&
+        tryEmitOutlinedOperation(IGF, *this, T,
+                                 OutlinedOperation::InitializeWithCopy,
+                                 dest, src,
+                                 [&](IRGenFunction &IGF, Address dest,
+                                     Address src) {
+          emitFieldsInitializeWithCopy(IGF, dest, src, T);
+        }))
+      return;
 
-      Address destField = field.projectAddress(IGF, dest, offsets);
-      Address srcField = field.projectAddress(IGF, src, offsets);
-      field.getTypeInfo().initializeWithCopy(IGF, destField, srcField,
-                                             field.getType(IGF.IGM, T));
-    }
+    emitFieldsInitializeWithCopy(IGF, dest, src, T);
   }
   
   void initializeWithTake(IRGenFunction &IGF,
@@ -205,13 +257,16 @@ public:
   }
 
   void destroy(IRGenFunction &IGF, Address addr, SILType T) const override {
-    auto offsets = asImpl().getNonFixedOffsets(IGF, T);
-    for (auto &field : getFields()) {
-      if (field.isPOD()) continue;
+    if (isWorthOutlining() &&
+        tryEmitOutlinedOperation(IGF, *this, T, OutlinedOperation::Destroy,
+                                 addr, Address(),
+                                 [&](IRGenFunction &IGF, Address addr,
+                                     Address) {
+          emitFieldsDestroy(IGF, addr, T);
+        }))
+      return;
 
-      field.getTypeInfo().destroy(IGF, field.projectAddress(IGF, addr, offsets),
-                                  field.getType(IGF.IGM, T));
-    }
+    emitFieldsDestroy(IGF, addr, T);
   }
 };
 
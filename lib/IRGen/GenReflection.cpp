@@ -942,7 +942,7 @@ void IRGenerator::emitBuiltinReflectionMetadata() {
 }
 
 void IRGenModule::emitFieldMetadataRecord(const NominalTypeDecl *Decl) {
-  if (!IRGen.Opts.EnableReflectionMetadata)
+  if (!IRGen.Opts.EnableReflectionMetadata || !IRGen.needsTypeRecords(Decl))
     return;
 
   FieldTypeMetadataBuilder builder(*this, Decl);
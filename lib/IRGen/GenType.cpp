@@ -1644,9 +1644,9 @@ llvm::StructType *IRGenModule::createNominalType(CanType type) {
     type = type.getNominalOrBoundGenericNominal()->getDeclaredType()
                                                  ->getCanonicalType();
 
-  llvm::SmallString<32> typeName;
-  LinkEntity::forTypeMangling(type).mangle(typeName);
-  return llvm::StructType::create(getLLVMContext(), typeName.str());
+  StringRef typeName =
+      IRGen.getMangledName(LinkEntity::forTypeMangling(type));
+  return llvm::StructType::create(getLLVMContext(), typeName);
 }
 
 /// createNominalType - Create a new nominal LLVM type for the given
@@ -1666,7 +1666,8 @@ IRGenModule::createNominalType(ProtocolCompositionType *type) {
   } else {
     for (unsigned i = 0, e = protocols.size(); i != e; ++i) {
       if (i) typeName.push_back('&');
-      LinkEntity::forNonFunction(protocols[i]).mangle(typeName);
+      typeName +=
+          IRGen.getMangledName(LinkEntity::forNonFunction(protocols[i]));
     }
   }
   return llvm::StructType::create(getLLVMContext(), typeName.str());
@@ -1888,3 +1889,67 @@ SILType irgen::getSingletonAggregateFieldType(IRGenModule &IGM, SILType t,
 
   return SILType();
 }
+
+bool irgen::tryEmitOutlinedOperation(IRGenFunction &IGF, const TypeInfo &TI,
+                                     SILType T, OutlinedOperation op,
+                                     Address dest, Address src,
+                                     llvm::function_ref<void(IRGenFunction &,
+                                                             Address,
+                                                             Address)>
+                                       emitInline) {
+  auto &IGM = IGF.IGM;
+  if (!IGM.IRGen.Opts.EnableCopyOutlining)
+    return false;
+
+  // The helper is shared by all uses of the type in the linkage unit, so its
+  // layout must be known statically. Generic types would also need their
+  // metadata to be passed along.
+  if (!TI.isFixedSize() || T.hasArchetype())
+    return false;
+
+  StringRef opName;
+  switch (op) {
+  case OutlinedOperation::AssignWithCopy:
+    opName = "assignWithCopy";
+    break;
+  case OutlinedOperation::InitializeWithCopy:
+    opName = "initializeWithCopy";
+    break;
+  case OutlinedOperation::Destroy:
+    opName = "destroy";
+    break;
+  }
+
+  llvm::SmallString<64> fnName;
+  fnName += "__swift_outlined_";
+  fnName += opName;
+  fnName += "_";
+  IGM.mangleType(T.getSwiftRValueType(), fnName);
+
+  auto ptrTy = TI.getStorageType()->getPointerTo();
+  SmallVector<llvm::Type *, 2> argTys;
+  argTys.push_back(ptrTy);
+  if (op != OutlinedOperation::Destroy)
+    argTys.push_back(ptrTy);
+
+  auto alignment = TI.getBestKnownAlignment();
+  auto fn = IGM.getOrCreateHelperFunction(fnName, IGM.VoidTy, argTys,
+                                          [&](IRGenFunction &IGF) {
+    auto it = IGF.CurFn->arg_begin();
+    Address destArg(&*(it++), alignment);
+    Address srcArg;
+    if (op != OutlinedOperation::Destroy)
+      srcArg = Address(&*(it++), alignment);
+    emitInline(IGF, destArg, srcArg);
+    IGF.Builder.CreateRetVoid();
+  });
+
+  SmallVector<llvm::Value *, 2> args;
+  args.push_back(IGF.Builder.CreateBitCast(dest.getAddress(), ptrTy));
+  if (op != OutlinedOperation::Destroy)
+    args.push_back(IGF.Builder.CreateBitCast(src.getAddress(), ptrTy));
+  auto call = IGF.Builder.CreateCall(fn, args);
+  call->setCallingConv(IGM.DefaultCC);
+  call->setDoesNotThrow();
+  return true;
+}
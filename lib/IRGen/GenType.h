@@ -49,7 +49,9 @@ namespace swift {
   enum IsTake_t : bool;
   
 namespace irgen {
+  class Address;
   class Alignment;
+  class IRGenFunction;
   class ProtocolInfo;
   class Size;
   class FixedTypeInfo;
@@ -244,6 +246,29 @@ SILType getSingletonAggregateFieldType(IRGenModule &IGM,
                                        SILType t,
                                        ResilienceExpansion expansion);
 
+/// A value operation which can be outlined into a helper function that is
+/// shared by all of its uses for a type.
+enum class OutlinedOperation {
+  AssignWithCopy,
+  InitializeWithCopy,
+  Destroy,
+};
+
+/// If copy outlining is enabled and \p T has a fixed, non-generic layout,
+/// emit a call to the shared helper function performing \p op on \p dest
+/// (and \p src, unless \p op is Destroy) and return true.
+///
+/// \p emitInline emits the operation itself and is used for the body of the
+/// helper. Callers should only ask for outlining if the inline code is big
+/// enough to make a call worthwhile.
+bool tryEmitOutlinedOperation(IRGenFunction &IGF, const TypeInfo &TI,
+                              SILType T, OutlinedOperation op,
+                              Address dest, Address src,
+                              llvm::function_ref<void(IRGenFunction &IGF,
+                                                      Address dest,
+                                                      Address src)>
+                                emitInline);
+
 } // end namespace irgen
 } // end namespace swift
 
@@ -49,6 +49,9 @@
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Mutex.h"
 #include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Process.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/Analysis/AliasAnalysis.h"
 #include "llvm/Target/TargetMachine.h"
@@ -57,8 +60,11 @@
 #include "llvm/Transforms/IPO.h"
 #include "llvm/Transforms/IPO/PassManagerBuilder.h"
 #include "llvm/Transforms/ObjCARC.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+#include "llvm/Transforms/Utils/SplitModule.h"
 #include "llvm/Object/ObjectFile.h"
 #include "IRGenModule.h"
+#include "Linking.h"
 
 #include <thread>
 
@@ -66,6 +72,13 @@ using namespace swift;
 using namespace irgen;
 using namespace llvm;
 
+STATISTIC(NumSILFunctionBodiesFreed,
+          "Number of SIL function bodies freed after IRGen");
+STATISTIC(NumSILInstructionsFreed,
+          "Number of SIL instructions freed after IRGen");
+STATISTIC(NumSILBytesFreed,
+          "Number of malloc'ed bytes freed with the SIL function bodies");
+
 namespace {
 // We need this to access IRGenOptions from extension functions
 class PassManagerBuilderWrapper : public PassManagerBuilder {
@@ -94,6 +107,12 @@ static void addSwiftMergeFunctionsPass(const PassManagerBuilder &Builder,
     PM.add(createSwiftMergeFunctionsPass());
 }
 
+static void addSwiftProfileCounterPromotionPass(
+    const PassManagerBuilder &Builder, PassManagerBase &PM) {
+  if (Builder.OptLevel > 0)
+    PM.add(createSwiftProfileCounterPromotionPass());
+}
+
 static void addAddressSanitizerPasses(const PassManagerBuilder &Builder,
                                       legacy::PassManagerBase &PM) {
   PM.add(createAddressSanitizerFunctionPass());
@@ -190,6 +209,12 @@ void swift::performLLVMOptimizations(IRGenOptions &Opts, llvm::Module *Module,
   PMBuilder.addExtension(PassManagerBuilder::EP_OptimizerLast,
                          addSwiftMergeFunctionsPass);
 
+  // The profile counters are lowered before the module passes run, so the
+  // updates in loops can be promoted right after the loop optimizations.
+  if (Opts.GenerateProfile)
+    PMBuilder.addExtension(PassManagerBuilder::EP_LoopOptimizerEnd,
+                           addSwiftProfileCounterPromotionPass);
+
   // Configure the function passes.
   legacy::FunctionPassManager FunctionPasses(Module);
   FunctionPasses.add(createTargetTransformInfoWrapperPass(
@@ -248,6 +273,92 @@ void swift::performLLVMOptimizations(IRGenOptions &Opts, llvm::Module *Module,
   ModulePasses.run(*Module);
 }
 
+/// Create a target machine with the same configuration as \p TM, for use by
+/// another thread.
+static std::unique_ptr<llvm::TargetMachine>
+cloneTargetMachine(const llvm::TargetMachine &TM) {
+  return std::unique_ptr<llvm::TargetMachine>(
+      TM.getTarget().createTargetMachine(TM.getTargetTriple().str(),
+                                         TM.getTargetCPU(),
+                                         TM.getTargetFeatureString(),
+                                         TM.Options, TM.getRelocationModel(),
+                                         TM.getCodeModel(),
+                                         TM.getOptLevel()));
+}
+
+/// Run the LLVM optimizations on \p Module with \p NumThreads threads.
+///
+/// A copy of the module is split into one partition per thread, keeping local
+/// symbols in the same partition as all of their uses. Each partition is
+/// optimized in its own LLVMContext, like in parallel LTO, and the optimized
+/// partitions are linked back together in the context of \p Module.
+///
+/// Optimizations can't cross partition boundaries, so functions are not
+/// inlined into callers of another partition.
+///
+/// \returns the optimized module, or null if it couldn't be reassembled, in
+/// which case \p Module is left unchanged.
+static std::unique_ptr<llvm::Module>
+performSplitLLVMOptimizations(IRGenOptions &Opts, llvm::Module *Module,
+                              llvm::TargetMachine *TargetMachine,
+                              unsigned NumThreads) {
+  // Partitions are passed between contexts as bitcode.
+  std::vector<SmallString<0>> Partitions;
+  SplitModule(CloneModule(Module), NumThreads,
+              [&](std::unique_ptr<llvm::Module> Part) {
+                Partitions.emplace_back();
+                raw_svector_ostream OS(Partitions.back());
+                WriteBitcodeToFile(Part.get(), OS);
+              }, /*PreserveLocals=*/true);
+
+  std::vector<std::unique_ptr<llvm::TargetMachine>> TargetMachines;
+  for (unsigned I = 0, E = Partitions.size(); I != E; ++I) {
+    TargetMachines.push_back(cloneTargetMachine(*TargetMachine));
+    if (!TargetMachines.back())
+      return nullptr;
+  }
+
+  // A partition which fails to round-trip is cleared.
+  auto optimizePartition = [&](unsigned Idx) {
+    LLVMContext Context;
+    MemoryBufferRef Buffer(Partitions[Idx], Module->getModuleIdentifier());
+    auto Part = parseBitcodeFile(Buffer, Context);
+    if (!Part) {
+      Partitions[Idx].clear();
+      return;
+    }
+    performLLVMOptimizations(Opts, Part->get(), TargetMachines[Idx].get());
+
+    SmallString<0> Optimized;
+    raw_svector_ostream OS(Optimized);
+    WriteBitcodeToFile(Part->get(), OS);
+    Partitions[Idx] = std::move(Optimized);
+  };
+
+  std::vector<std::thread> Threads;
+  for (unsigned I = 1, E = Partitions.size(); I != E; ++I)
+    Threads.push_back(std::thread(optimizePartition, I));
+  optimizePartition(0);
+  for (std::thread &Thread : Threads)
+    Thread.join();
+
+  // Link the optimized partitions back together.
+  std::unique_ptr<llvm::Module> Result;
+  for (unsigned I = 0, E = Partitions.size(); I != E; ++I) {
+    if (Partitions[I].empty())
+      return nullptr;
+    MemoryBufferRef Buffer(Partitions[I], Module->getModuleIdentifier());
+    auto Part = parseBitcodeFile(Buffer, Module->getContext());
+    if (!Part)
+      return nullptr;
+    if (!Result)
+      Result = std::move(*Part);
+    else if (Linker::linkModules(*Result, std::move(*Part)))
+      return nullptr;
+  }
+  return Result;
+}
+
 namespace {
 /// An output stream which calculates the MD5 hash of the streamed data.
 class MD5Stream : public llvm::raw_ostream {
@@ -277,7 +388,8 @@ public:
 static void getHashOfModule(MD5::MD5Result &Result, IRGenOptions &Opts,
                             llvm::Module *Module,
                             llvm::TargetMachine *TargetMachine,
-                            version::Version const& effectiveLanguageVersion) {
+                            version::Version const& effectiveLanguageVersion,
+                            int NumThreads) {
   // Calculate the hash of the whole llvm module.
   MD5Stream HashStream;
   llvm::WriteBitcodeToFile(Module, HashStream);
@@ -290,9 +402,45 @@ static void getHashOfModule(MD5::MD5Result &Result, IRGenOptions &Opts,
   // reflected in the llvm module itself.
   HashStream << Opts.getLLVMCodeGenOptionsHash();
 
+  // Optimizing the module in partitions produces different code.
+  HashStream << (NumThreads > 1);
+
   HashStream.final(Result);
 }
 
+/// Returns the path under which an object file generated from llvm IR with the
+/// hash \p Hash is stored in the object cache \p CachePath.
+static void getCachedObjectPath(StringRef CachePath,
+                                MD5::MD5Result &Hash,
+                                SmallVectorImpl<char> &Path) {
+  SmallString<32> HashStr;
+  MD5::stringifyResult(Hash, HashStr);
+  Path.assign(CachePath.begin(), CachePath.end());
+  llvm::sys::path::append(Path, HashStr + ".o");
+}
+
+/// Copies the object file \p OutputFilename into the object cache, as
+/// \p CachedObjectPath.
+///
+/// The cache may be shared by concurrent compilations, so the file is copied
+/// under a unique name and then renamed. Failing to update the cache is not
+/// an error.
+static void addToObjectCache(StringRef OutputFilename,
+                             StringRef CachedObjectPath) {
+  if (llvm::sys::fs::create_directories(
+          llvm::sys::path::parent_path(CachedObjectPath)))
+    return;
+
+  SmallString<128> TmpPath;
+  if (llvm::sys::fs::createUniqueFile(CachedObjectPath + "-%%%%%%%%.tmp",
+                                      TmpPath))
+    return;
+
+  if (llvm::sys::fs::copy_file(OutputFilename, TmpPath) ||
+      llvm::sys::fs::rename(TmpPath, CachedObjectPath))
+    llvm::sys::fs::remove(TmpPath);
+}
+
 /// Returns false if the hash of the current module \p HashData matches the
 /// hash which is stored in an existing output object file.
 static bool needsRecompile(StringRef OutputFilename, ArrayRef<uint8_t> HashData,
@@ -351,13 +499,15 @@ static bool performLLVM(IRGenOptions &Opts, DiagnosticEngine &Diags,
                         llvm::Module *Module,
                         llvm::TargetMachine *TargetMachine,
                         version::Version const& effectiveLanguageVersion,
-                        StringRef OutputFilename) {
+                        StringRef OutputFilename,
+                        int NumThreads = 0) {
+  SmallString<128> CachedObjectPath;
   if (Opts.UseIncrementalLLVMCodeGen && HashGlobal) {
     // Check if we can skip the llvm part of the compilation if we have an
     // existing object file which was generated from the same llvm IR.
     MD5::MD5Result Result;
     getHashOfModule(Result, Opts, Module, TargetMachine,
-                    effectiveLanguageVersion);
+                    effectiveLanguageVersion, NumThreads);
 
     DEBUG(
       if (DiagMutex) DiagMutex->lock();
@@ -375,6 +525,16 @@ static bool performLLVM(IRGenOptions &Opts, DiagnosticEngine &Diags,
       return false;
     }
 
+    // Or if the object cache has an object file which was generated from the
+    // same llvm IR, even if the output file was overwritten in between.
+    if (Opts.OutputKind == IRGenOutputKind::ObjectFile &&
+        !Opts.PrintInlineTree && !Opts.LLVMObjectCachePath.empty() &&
+        !OutputFilename.empty()) {
+      getCachedObjectPath(Opts.LLVMObjectCachePath, Result, CachedObjectPath);
+      if (!llvm::sys::fs::copy_file(CachedObjectPath, OutputFilename))
+        return false;
+    }
+
     // Store the hash in the global variable so that it is written into the
     // object file.
     auto *HashConstant = ConstantDataArray::get(Module->getContext(), HashData);
@@ -409,7 +569,17 @@ static bool performLLVM(IRGenOptions &Opts, DiagnosticEngine &Diags,
     RawOS.reset(new raw_svector_ostream(Buffer));
   }
 
-  performLLVMOptimizations(Opts, Module, TargetMachine);
+  // With multiple threads, optimize partitions of the module in parallel.
+  // Outside of whole-module compilation there's just one module per frontend
+  // job, so this is the only way to put the threads to use.
+  std::unique_ptr<llvm::Module> OptimizedModule;
+  if (NumThreads > 1 && Opts.Optimize && !Opts.DisableLLVMOptzns)
+    OptimizedModule = performSplitLLVMOptimizations(Opts, Module,
+                                                    TargetMachine, NumThreads);
+  if (OptimizedModule)
+    Module = OptimizedModule.get();
+  else
+    performLLVMOptimizations(Opts, Module, TargetMachine);
 
   legacy::PassManager EmitPasses;
 
@@ -458,6 +628,12 @@ static bool performLLVM(IRGenOptions &Opts, DiagnosticEngine &Diags,
     SharedTimer timer("LLVM output");
     EmitPasses.run(*Module);
   }
+
+  if (!CachedObjectPath.empty()) {
+    // Close the output file before copying it into the cache.
+    RawOS.reset();
+    addToObjectCache(OutputFilename, CachedObjectPath);
+  }
   return false;
 }
 
@@ -588,6 +764,27 @@ static void embedBitcode(llvm::Module *M, const IRGenOptions &Opts)
   NewUsed->setSection("llvm.metadata");
 }
 
+/// Frees the SIL function bodies once all of them have been lowered to IR.
+static void freeSILFunctionBodies(const IRGenOptions &Opts,
+                                  SILModule &SILMod) {
+  if (!Opts.FreeSILAfterIRGen)
+    return;
+
+  SharedTimer timer("Free SIL");
+  size_t MallocUsageBefore = sys::Process::GetMallocUsage();
+  for (SILFunction &F : SILMod) {
+    if (!F.isDefinition())
+      continue;
+    for (auto &BB : F)
+      NumSILInstructionsFreed += std::distance(BB.begin(), BB.end());
+    F.convertToDeclaration();
+    ++NumSILFunctionBodiesFreed;
+  }
+  size_t MallocUsageAfter = sys::Process::GetMallocUsage();
+  if (MallocUsageAfter < MallocUsageBefore)
+    NumSILBytesFreed += MallocUsageBefore - MallocUsageAfter;
+}
+
 static void initLLVMModule(const IRGenModule &IGM) {
   auto *Module = IGM.getModule();
   assert(Module && "Expected llvm:Module for IR generation!");
@@ -694,12 +891,14 @@ static std::unique_ptr<llvm::Module> performIRGeneration(IRGenOptions &Opts,
   // Bail out if there are any errors.
   if (Ctx.hadError()) return nullptr;
 
+  freeSILFunctionBodies(Opts, *SILMod);
+
   embedBitcode(IGM.getModule(), Opts);
 
   if (performLLVM(Opts, IGM.Context.Diags, nullptr, IGM.ModuleHash,
                   IGM.getModule(), IGM.TargetMachine.get(),
                   IGM.Context.LangOpts.EffectiveLanguageVersion,
-                  IGM.OutputFilename))
+                  IGM.OutputFilename, SILMod->getOptions().NumThreads))
     return nullptr;
   return std::unique_ptr<llvm::Module>(IGM.releaseModule());
 }
@@ -730,10 +929,11 @@ static void ThreadEntryPoint(IRGenerator *irgen,
 
 /// Generates LLVM IR, runs the LLVM passes and produces the output files.
 /// All this is done in multiple threads.
-static void performParallelIRGeneration(IRGenOptions &Opts,
-                                        swift::Module *M,
-                                        SILModule *SILMod,
-                                        StringRef ModuleName, int numThreads) {
+static void
+performParallelIRGeneration(IRGenOptions &Opts, swift::Module *M,
+                            SILModule *SILMod, StringRef ModuleName,
+                            int numThreads,
+                            const std::function<void()> &AfterIRGen) {
 
   IRGenerator irgen(Opts, *SILMod);
 
@@ -904,6 +1104,8 @@ static void performParallelIRGeneration(IRGenOptions &Opts,
   // Bail out if there are any errors.
   if (Ctx.hadError()) return;
 
+  freeSILFunctionBodies(Opts, *SILMod);
+
   std::vector<std::thread> Threads;
   llvm::sys::Mutex DiagMutex;
 
@@ -913,6 +1115,14 @@ static void performParallelIRGeneration(IRGenOptions &Opts,
                                   ThreadIdx));
   }
 
+  // The LLVM threads no longer look at the AST or SIL, so the caller's work
+  // can overlap with them. It may diagnose, hence the lock; the LLVM threads
+  // only take it to report errors.
+  if (AfterIRGen) {
+    llvm::sys::ScopedLock Lock(DiagMutex);
+    AfterIRGen();
+  }
+
   ThreadEntryPoint(&irgen, &DiagMutex, 0);
 
   // Wait for all threads.
@@ -924,15 +1134,21 @@ static void performParallelIRGeneration(IRGenOptions &Opts,
 
 std::unique_ptr<llvm::Module> swift::
 performIRGeneration(IRGenOptions &Opts, swift::Module *M, SILModule *SILMod,
-                    StringRef ModuleName, llvm::LLVMContext &LLVMContext) {
+                    StringRef ModuleName, llvm::LLVMContext &LLVMContext,
+                    std::function<void()> AfterIRGen) {
   int numThreads = SILMod->getOptions().NumThreads;
   if (numThreads != 0) {
-    ::performParallelIRGeneration(Opts, M, SILMod, ModuleName, numThreads);
+    ::performParallelIRGeneration(Opts, M, SILMod, ModuleName, numThreads,
+                                  AfterIRGen);
     // TODO: Parallel LLVM compilation cannot be used if a (single) module is
     // needed as return value.
     return nullptr;
   }
-  return ::performIRGeneration(Opts, M, SILMod, ModuleName, LLVMContext);
+  auto Result = ::performIRGeneration(Opts, M, SILMod, ModuleName,
+                                      LLVMContext);
+  if (AfterIRGen)
+    AfterIRGen();
+  return Result;
 }
 
 std::unique_ptr<llvm::Module> swift::
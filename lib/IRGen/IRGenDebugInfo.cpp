@@ -1033,9 +1033,25 @@ StringRef IRGenDebugInfo::getMangledName(DebugTypeInfo DbgTy) {
   if (MetadataTypeDecl && DbgTy.getDecl() == MetadataTypeDecl)
     return BumpAllocatedString(DbgTy.getDecl()->getName().str());
 
+  // The name only depends on the type and its context, so it is shared
+  // between the debug info of all IRGenModules. IR is generated for one
+  // IRGenModule at a time, so this doesn't need a lock.
+  auto *Ty = DbgTy.getType();
+  auto *DC = DbgTy.getDeclContext();
+  StringRef Name = IGM.IRGen.lookupDebugTypeName(Ty, DC);
+  if (!Name.empty())
+    return Name;
+
   Mangle::Mangler M(/* DWARF */ true);
-  M.mangleTypeForDebugger(DbgTy.getType(), DbgTy.getDeclContext());
-  return BumpAllocatedString(M.finalize());
+  M.mangleTypeForDebugger(Ty, DC);
+  return IGM.IRGen.addDebugTypeName(Ty, DC, M.finalize());
+}
+
+bool IRGenDebugInfo::isDefinedInOtherModule(NominalTypeDecl *Decl) {
+  // Clang types are only described by the Clang module they come from.
+  if (Decl->hasClangNode())
+    return false;
+  return Decl->getModuleContext() != IGM.getSwiftModule();
 }
 
 llvm::DIDerivedType *
@@ -1453,7 +1469,10 @@ llvm::DIType *IRGenDebugInfo::createType(DebugTypeInfo DbgTy,
     auto *Decl = StructTy->getDecl();
     auto L = getDebugLoc(SM, Decl);
     auto *File = getOrCreateFile(L.Filename);
-    if (Opts.DebugInfoKind > IRGenDebugInfoKind::ASTTypes)
+    // Types of other Swift modules are found by the debugger through their
+    // mangled name, so their members needn't be repeated in every object.
+    if (Opts.DebugInfoKind > IRGenDebugInfoKind::ASTTypes &&
+        !isDefinedInOtherModule(Decl))
       return createStructType(DbgTy, Decl, StructTy, Scope, File, L.Line,
                               SizeInBits, AlignInBits, Flags,
                               nullptr, // DerivedFrom
@@ -1644,7 +1663,8 @@ llvm::DIType *IRGenDebugInfo::createType(DebugTypeInfo DbgTy,
     auto *Decl = EnumTy->getDecl();
     auto L = getDebugLoc(SM, Decl);
     auto *File = getOrCreateFile(L.Filename);
-    if (Opts.DebugInfoKind > IRGenDebugInfoKind::ASTTypes)
+    if (Opts.DebugInfoKind > IRGenDebugInfoKind::ASTTypes &&
+        !isDefinedInOtherModule(Decl))
       return createEnumType(DbgTy, Decl, MangledName, Scope, File, L.Line,
                             Flags);
     else
@@ -1657,7 +1677,8 @@ llvm::DIType *IRGenDebugInfo::createType(DebugTypeInfo DbgTy,
     auto *Decl = EnumTy->getDecl();
     auto L = getDebugLoc(SM, Decl);
     auto *File = getOrCreateFile(L.Filename);
-    if (Opts.DebugInfoKind > IRGenDebugInfoKind::ASTTypes)
+    if (Opts.DebugInfoKind > IRGenDebugInfoKind::ASTTypes &&
+        !isDefinedInOtherModule(Decl))
       return createEnumType(DbgTy, Decl, MangledName, Scope, File, L.Line,
                             Flags);
     else
@@ -255,6 +255,9 @@ private:
   /// Return the mangled name of any nominal type, including the global
   /// _Tt prefix, which marks the Swift namespace for types in DWARF.
   StringRef getMangledName(DebugTypeInfo DbgTy);
+  /// Is the nominal type declared in another Swift module? The members of
+  /// such types are not described.
+  bool isDefinedInOtherModule(NominalTypeDecl *Decl);
   /// Create the array of function parameters for a function type.
   llvm::DITypeRefArray createParameterTypes(CanSILFunctionType FnTy,
                                             DeclContext *DeclCtx);
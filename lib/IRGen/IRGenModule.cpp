@@ -287,6 +287,11 @@ IRGenModule::IRGenModule(IRGenerator &irgen,
     });
   ProtocolConformanceRecordPtrTy
     = ProtocolConformanceRecordTy->getPointerTo(DefaultAS);
+  ProtocolConformanceIndexEntryTy
+    = createStructType(*this, "swift.protocol_conformance_index_entry", {
+      RelativeAddressTy,
+      Int32Ty
+    });
 
   NominalTypeDescriptorTy
     = llvm::StructType::create(LLVMContext, "swift.type_descriptor");
@@ -649,6 +654,28 @@ llvm::Constant *IRGenModule::getEmptyTupleMetadata() {
   return EmptyTupleMetadata;
 }
 
+/// Returns the address point of the heap metadata of the error boxes
+/// allocated by swift_allocError.
+llvm::Constant *IRGenModule::getErrorBoxMetadata() {
+  if (ErrorBoxMetadata)
+    return ErrorBoxMetadata;
+
+  assert(!ObjCInterop && "error boxes are NSError objects with ObjC interop");
+  auto global = Module.getOrInsertGlobal("_swift_errorBoxMetadata",
+                                         FullHeapMetadataStructTy);
+  if (Triple.isOSBinFormatCOFF())
+    cast<llvm::GlobalVariable>(global)
+        ->setDLLStorageClass(llvm::GlobalValue::DLLImportStorageClass);
+
+  llvm::Constant *indices[] = {
+    llvm::ConstantInt::get(Int32Ty, 0),
+    llvm::ConstantInt::get(Int32Ty, 2)
+  };
+  ErrorBoxMetadata = llvm::ConstantExpr::getInBoundsGetElementPtr(
+      FullHeapMetadataStructTy, global, indices);
+  return ErrorBoxMetadata;
+}
+
 llvm::Constant *IRGenModule::getObjCEmptyCachePtr() {
   if (ObjCEmptyCachePtr)
     return ObjCEmptyCachePtr;
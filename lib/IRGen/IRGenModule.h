@@ -29,8 +29,10 @@
 #include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Allocator.h"
 #include "llvm/IR/CallingConv.h"
 #include "llvm/IR/Constant.h"
 #include "llvm/IR/ValueHandle.h"
@@ -215,6 +217,26 @@ private:
   /// The queue of IRGenModules for multi-threaded compilation.
   SmallVector<IRGenModule *, 8> Queue;
 
+  /// The nominal types which the runtime can encounter, if they were computed
+  /// for -strip-unused-type-records.
+  llvm::DenseSet<const NominalTypeDecl *> DynamicallyUsedTypes;
+  bool ComputedDynamicallyUsedTypes = false;
+
+  void computeDynamicallyUsedTypes();
+
+  /// The mangled names of the types described in the debug info, shared by
+  /// the debug info of all IRGenModules.
+  llvm::DenseMap<std::pair<TypeBase *, DeclContext *>, StringRef>
+    DebugTypeNames;
+  llvm::BumpPtrAllocator DebugTypeNameStorage;
+
+  /// The mangled names of link entities, shared by all IRGenModules.
+  llvm::DenseMap<LinkEntity, StringRef> MangledNames;
+  llvm::BumpPtrAllocator MangledNameStorage;
+
+  /// The buffer entities are mangled into before they are memoized.
+  llvm::SmallString<128> MangleBuffer;
+
   std::atomic<int> QueueIndex;
   
   friend class CurrentIGMPtr;  
@@ -256,6 +278,35 @@ public:
   }
   
   bool hasMultipleIGMs() const { return GenModules.size() >= 2; }
+
+  /// Do we need to emit conformance, type metadata and field metadata records
+  /// for the given type? This is only false for internal types of a
+  /// whole-module compilation with -strip-unused-type-records, whose values
+  /// and metadata can't reach a dynamic cast, reflection or generic code.
+  bool needsTypeRecords(const NominalTypeDecl *decl);
+
+  /// Returns the memoized debugger name of a type in a context, or an empty
+  /// string if it wasn't mangled yet.
+  StringRef lookupDebugTypeName(TypeBase *Ty, DeclContext *DC) const {
+    auto found = DebugTypeNames.find({Ty, DC});
+    if (found == DebugTypeNames.end())
+      return StringRef();
+    return found->second;
+  }
+
+  /// Memoize the debugger name of a type in a context and return the
+  /// memoized copy.
+  StringRef addDebugTypeName(TypeBase *Ty, DeclContext *DC, StringRef Name) {
+    char *Data = DebugTypeNameStorage.Allocate<char>(Name.size());
+    std::copy(Name.begin(), Name.end(), Data);
+    StringRef Copy(Data, Name.size());
+    DebugTypeNames.insert({{Ty, DC}, Copy});
+    return Copy;
+  }
+
+  /// Returns the mangled name of \p entity, which is only mangled the first
+  /// time it is asked for.
+  StringRef getMangledName(const LinkEntity &entity);
   
   llvm::DenseMap<SourceFile *, IRGenModule *>::iterator begin() {
     return GenModules.begin();
@@ -446,6 +497,7 @@ public:
   llvm::PointerType *ObjCBlockPtrTy;   /// %objc_block*
   llvm::StructType *ProtocolConformanceRecordTy;
   llvm::PointerType *ProtocolConformanceRecordPtrTy;
+  llvm::StructType *ProtocolConformanceIndexEntryTy;
   llvm::StructType *NominalTypeDescriptorTy;
   llvm::PointerType *NominalTypeDescriptorPtrTy;
   llvm::StructType *TypeMetadataRecordTy;
@@ -630,6 +682,7 @@ public:
                                 ArrayRef<FieldTypeInfo> fieldTypes,
                                 llvm::Function *fn);
   llvm::Constant *emitProtocolConformances();
+  void emitProtocolConformanceIndex(llvm::GlobalVariable *records);
   llvm::Constant *emitTypeMetadataRecords();
 
   llvm::Constant *getOrCreateHelperFunction(StringRef name,
@@ -714,6 +767,10 @@ private:
   friend struct ::llvm::DenseMapInfo<swift::irgen::IRGenModule::FixedLayoutKey>;
   llvm::DenseMap<FixedLayoutKey, llvm::Constant *> PrivateFixedLayouts;
 
+  /// The statically allocated error boxes, by the case they hold. The entry
+  /// is null if the case can't be boxed statically.
+  llvm::DenseMap<EnumElementDecl *, llvm::Constant *> StaticErrorBoxes;
+
   /// A mapping from order numbers to the LLVM functions which we
   /// created for the SIL functions with those orders.
   SuccessorMap<unsigned, llvm::Function*> EmittedFunctionsByOrder;
@@ -788,6 +845,7 @@ public:
 //--- Runtime ---------------------------------------------------------------
 public:
   llvm::Constant *getEmptyTupleMetadata();
+  llvm::Constant *getErrorBoxMetadata();
   llvm::Constant *getObjCEmptyCachePtr();
   llvm::Constant *getObjCEmptyVTablePtr();
   llvm::Value *getObjCRetainAutoreleasedReturnValueMarker();
@@ -799,6 +857,7 @@ public:
 
 private:
   llvm::Constant *EmptyTupleMetadata = nullptr;
+  llvm::Constant *ErrorBoxMetadata = nullptr;
   llvm::Constant *ObjCEmptyCachePtr = nullptr;
   llvm::Constant *ObjCEmptyVTablePtr = nullptr;
   llvm::Constant *ObjCISAMaskPtr = nullptr;
@@ -951,6 +1010,9 @@ public:
                                            ProtocolDecl *requiredProtocol);
 
   Address getAddrOfObjCISAMask();
+  llvm::Constant *getAddrOfStaticErrorBox(CanType type,
+                                          ProtocolConformanceRef conformance,
+                                          EnumElementDecl *theCase);
 
   StringRef mangleType(CanType type, SmallVectorImpl<char> &buffer);
  
@@ -31,6 +31,7 @@
 #include "swift/Basic/Fallthrough.h"
 #include "swift/Basic/Range.h"
 #include "swift/Basic/STLExtras.h"
+#include "swift/Basic/Trace.h"
 #include "swift/AST/ASTContext.h"
 #include "swift/AST/IRGenOptions.h"
 #include "swift/AST/Pattern.h"
@@ -1319,7 +1320,13 @@ void IRGenModule::emitSILFunction(SILFunction *f) {
     return;
 
   PrettyStackTraceSILFunction stackTrace("emitting IR", f);
+  TraceScope trace("irgen", f->getName());
   IRGenSILFunction(*this, f).emitSILFunction();
+
+  // Keep outlined cold code out of the pages that hot code is loaded from.
+  if (f->hasSemanticsAttr("optimize.cold") &&
+      TargetInfo.OutputObjectFormat == llvm::Triple::ELF)
+    getAddrOfSILFunction(f, NotForDefinition)->setSection(".text.unlikely");
 }
 
 void IRGenSILFunction::emitSILFunction() {
@@ -3134,6 +3141,11 @@ void IRGenSILFunction::visitLoadInst(swift::LoadInst *i) {
 }
 
 void IRGenSILFunction::visitStoreInst(swift::StoreInst *i) {
+  // The store initializes a statically allocated error box, which already
+  // holds the value.
+  if (claimEmissionNote(i))
+    return;
+
   Explosion source = getLoweredExplosion(i->getSrc());
   Address dest = getLoweredAddress(i->getDest());
   auto &type = getTypeInfo(i->getSrc()->getType().getObjectType());
@@ -4447,7 +4459,51 @@ void IRGenSILFunction::visitInitBlockStorageHeaderInst(
   setLoweredExplosion(i, e);
 }
 
+/// Returns the store which initializes the box \p i with a case of an enum
+/// without payloads, if nothing else writes to the value in the box.
+static StoreInst *
+getStoreOfCaseWithoutPayload(AllocExistentialBoxInst *i) {
+  StoreInst *init = nullptr;
+  for (auto *use : i->getUses()) {
+    auto *user = use->getUser();
+    // Only a box from swift_allocError can be deallocated uninitialized.
+    if (isa<DeallocExistentialBoxInst>(user))
+      return nullptr;
+    auto *project = dyn_cast<ProjectExistentialBoxInst>(user);
+    if (!project)
+      continue;
+    for (auto *projectUse : project->getUses()) {
+      auto *projectUser = projectUse->getUser();
+      if (isa<LoadInst>(projectUser) || isa<DebugValueAddrInst>(projectUser))
+        continue;
+      auto *store = dyn_cast<StoreInst>(projectUser);
+      if (!store || store->getDest() != project || init)
+        return nullptr;
+      init = store;
+    }
+  }
+  if (!init || init->getParent() != i->getParent())
+    return nullptr;
+  auto *value = dyn_cast<EnumInst>(init->getSrc());
+  if (!value || value->hasOperand())
+    return nullptr;
+  return init;
+}
+
 void IRGenSILFunction::visitAllocExistentialBoxInst(AllocExistentialBoxInst *i){
+  // Errors without a payload don't need to be allocated.
+  if (auto *init = getStoreOfCaseWithoutPayload(i)) {
+    auto theCase = cast<EnumInst>(init->getSrc())->getElement();
+    if (auto staticBox =
+          emitStaticBoxedExistentialContainer(*this, i->getExistentialType(),
+                                              i->getFormalConcreteType(),
+                                              i->getConformances(), theCase)) {
+      addEmissionNote(init);
+      setLoweredBox(i, *staticBox);
+      return;
+    }
+  }
+
   OwnedAddress boxWithAddr =
     emitBoxedExistentialContainerAllocation(*this, i->getExistentialType(),
                                             i->getFormalConcreteType(),
@@ -646,7 +646,7 @@ public:
 class LinkInfo {
   LinkInfo() = default;
 
-  llvm::SmallString<32> Name;
+  StringRef Name;
   llvm::GlobalValue::LinkageTypes Linkage;
   llvm::GlobalValue::VisibilityTypes Visibility;
   llvm::GlobalValue::DLLStorageClassTypes DLLStorageClass;
@@ -658,7 +658,7 @@ public:
                       ForDefinition_t forDefinition);
 
   StringRef getName() const {
-    return Name.str();
+    return Name;
   }
   llvm::GlobalValue::LinkageTypes getLinkage() const {
     return Linkage;
@@ -54,6 +54,10 @@ static void configureARM64(IRGenModule &IGM, const llvm::Triple &triple,
 
   // arm64 requires ISA-masking.
   target.ObjCUseISAMask = true;
+
+  // swiftcc returns up to four values in x0-x3 and d0-d3.
+  if (IGM.IRGen.Opts.UseSwiftCall)
+    target.MaxScalarsForDirectResult = 4;
 }
 
 /// Configures target-specific information for x86-64 platforms.
@@ -75,6 +79,11 @@ static void configureX86_64(IRGenModule &IGM, const llvm::Triple &triple,
 
   // x86-64 requires ISA-masking.
   target.ObjCUseISAMask = true;
+
+  // swiftcc returns up to four values in rax, rdx, rcx and r8, and in
+  // xmm0-xmm3.
+  if (IGM.IRGen.Opts.UseSwiftCall)
+    target.MaxScalarsForDirectResult = 4;
 }
 
 /// Configures target-specific information for 32-bit x86 platforms.
@@ -134,10 +143,15 @@ SwiftTargetInfo SwiftTargetInfo::get(IRGenModule &IGM) {
   SwiftTargetInfo target(triple.getObjectFormat(), pointerSize);
   
   // On Apple platforms, we implement "once" using dispatch_once, which exposes
-  // -1 as ABI for the "done" value.
-  if (triple.isOSDarwin())
+  // -1 as ABI for the "done" value. On other platforms except Cygwin, the
+  // runtime's own "once" uses the same value, but dispatch_once is the only
+  // one that makes the initialization visible without an acquire.
+  if (triple.isOSDarwin()) {
     target.OnceDonePredicateValue = -1L;
-  // TODO: Do we know this for Linux?
+  } else if (!triple.isWindowsCygwinEnvironment()) {
+    target.OnceDonePredicateValue = -1L;
+    target.OnceDonePredicateNeedsAcquire = true;
+  }
   
   switch (triple.getArch()) {
   case llvm::Triple::x86_64:
@@ -170,6 +184,13 @@ SwiftTargetInfo SwiftTargetInfo::get(IRGenModule &IGM) {
     break;
   }
 
+  // Allow experimenting with the thresholds. This changes the ABI, so all
+  // modules of a program need to be compiled with the same values.
+  if (unsigned max = IGM.IRGen.Opts.MaxScalarsForDirectResult)
+    target.MaxScalarsForDirectResult = max;
+  if (unsigned max = IGM.IRGen.Opts.MaxScalarsForDirectParameter)
+    target.MaxScalarsForDirectParameter = max;
+
   return target;
 }
 
@@ -82,6 +82,10 @@ public:
   /// The maximum number of scalars that we allow to be returned directly.
   unsigned MaxScalarsForDirectResult = 3;
 
+  /// The maximum number of scalars that we allow a single parameter to be
+  /// passed as directly.
+  unsigned MaxScalarsForDirectParameter = 3;
+
   /// Inline assembly to mark a call to objc_retainAutoreleasedReturnValue.
   llvm::StringRef ObjCRetainAutoreleasedReturnValueMarker;
   
@@ -95,6 +99,10 @@ public:
   /// The value stored in a Builtin.once predicate to indicate that an
   /// initialization has already happened, if known.
   Optional<int64_t> OnceDonePredicateValue = None;
+
+  /// Whether the inline check of a Builtin.once predicate needs to be an
+  /// acquire load to see the effects of the initialization.
+  bool OnceDonePredicateNeedsAcquire = false;
 };
 
 }
@@ -26,17 +26,23 @@
 #include "swift/AST/Module.h"
 #include "swift/Basic/LLVM.h"
 #include "swift/Basic/LLVMContext.h"
+#include "swift/Basic/Version.h"
 #include "swift/Frontend/Frontend.h"
 #include "swift/SILOptimizer/PassManager/Passes.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/Bitcode/ReaderWriter.h"
 #include "llvm/Config/config.h"
 #include "llvm/ExecutionEngine/MCJIT.h"
+#include "llvm/ExecutionEngine/ObjectCache.h"
 #include "llvm/IR/DiagnosticPrinter.h"
 #include "llvm/IR/DiagnosticInfo.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/Linker/Linker.h"
 #include "llvm/Transforms/IPO.h"
 #include "llvm/Transforms/IPO/PassManagerBuilder.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 
 #if defined(_MSC_VER)
@@ -290,6 +296,84 @@ bool swift::immediate::IRGenImportedModules(
   return hadError;
 }
 
+namespace {
+/// An MCJIT object cache which keeps the object file generated for a module
+/// in a directory, named by the hash of the module's llvm IR, so that running
+/// an unchanged script again does not need llvm code generation.
+class ImmediateObjectCache : public llvm::ObjectCache {
+  SmallString<128> CachedObjectPath;
+
+public:
+  ImmediateObjectCache(StringRef CachePath, IRGenOptions &Opts,
+                       llvm::Module &Module, StringRef CPU,
+                       ArrayRef<std::string> Features,
+                       version::Version EffectiveLanguageVersion) {
+    SmallString<256> Bitcode;
+    {
+      llvm::raw_svector_ostream BitcodeStream(Bitcode);
+      llvm::WriteBitcodeToFile(&Module, BitcodeStream);
+    }
+
+    // The key includes everything which influences the generated code but is
+    // not reflected in the llvm module itself.
+    llvm::MD5 Hash;
+    Hash.update(Bitcode.str());
+    Hash.update(version::getSwiftFullVersion(EffectiveLanguageVersion));
+    Hash.update(std::to_string(Opts.getLLVMCodeGenOptionsHash()));
+    Hash.update(CPU);
+    for (auto &Feature : Features)
+      Hash.update(Feature);
+    llvm::MD5::MD5Result Result;
+    Hash.final(Result);
+
+    SmallString<32> HashStr;
+    llvm::MD5::stringifyResult(Result, HashStr);
+    CachedObjectPath = CachePath;
+    llvm::sys::path::append(CachedObjectPath, "immediate-" + HashStr + ".o");
+  }
+
+  /// Stores the object file in the cache.
+  ///
+  /// The cache may be shared by concurrent invocations, so the file is
+  /// written under a unique name and then renamed. Failing to update the cache
+  /// is not an error.
+  void notifyObjectCompiled(const llvm::Module *M,
+                            llvm::MemoryBufferRef Obj) override {
+    if (llvm::sys::fs::create_directories(
+            llvm::sys::path::parent_path(CachedObjectPath)))
+      return;
+
+    int FD;
+    SmallString<128> TmpPath;
+    if (llvm::sys::fs::createUniqueFile(CachedObjectPath + "-%%%%%%%%.tmp",
+                                        FD, TmpPath))
+      return;
+
+    bool Failed;
+    {
+      llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+      OS << Obj.getBuffer();
+      OS.close();
+      Failed = OS.has_error();
+      OS.clear_error();
+    }
+    if (Failed || llvm::sys::fs::rename(TmpPath, CachedObjectPath))
+      llvm::sys::fs::remove(TmpPath);
+  }
+
+  /// Returns the cached object file, or null if the module was not compiled
+  /// before.
+  std::unique_ptr<llvm::MemoryBuffer>
+  getObject(const llvm::Module *M) override {
+    auto Buffer = llvm::MemoryBuffer::getFile(CachedObjectPath);
+    if (!Buffer)
+      return nullptr;
+    DEBUG(llvm::dbgs() << "Using cached object " << CachedObjectPath << '\n');
+    return std::move(*Buffer);
+  }
+};
+} // end anonymous namespace
+
 int swift::RunImmediately(CompilerInstance &CI, const ProcessCmdLine &CmdLine,
                           IRGenOptions &IRGenOpts, const SILOptions &SILOpts) {
   ASTContext &Context = CI.getASTContext();
@@ -356,11 +440,20 @@ int swift::RunImmediately(CompilerInstance &CI, const ProcessCmdLine &CmdLine,
   builder.setMAttrs(Features);
   builder.setErrorStr(&ErrorMsg);
   builder.setEngineKind(llvm::EngineKind::JIT);
+
+  // Compute the cache key before the engine takes over the module.
+  Optional<ImmediateObjectCache> ObjectCache;
+  if (!IRGenOpts.LLVMObjectCachePath.empty())
+    ObjectCache.emplace(IRGenOpts.LLVMObjectCachePath, IRGenOpts, *Module, CPU,
+                        Features, Context.LangOpts.EffectiveLanguageVersion);
+
   llvm::ExecutionEngine *EE = builder.create();
   if (!EE) {
     llvm::errs() << "Error loading JIT: " << ErrorMsg;
     return -1;
   }
+  if (ObjectCache)
+    EE->setObjectCache(ObjectCache.getPointer());
 
   DEBUG(llvm::dbgs() << "Module to be executed:\n";
         Module->dump());
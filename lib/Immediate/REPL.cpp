@@ -868,19 +868,15 @@ private:
     if (CI.getASTContext().hadError())
       return false;
 
-    // LineModule will get destroy by the following link process.
+    // LineModule will be stripped and handed to the JIT.
     // Make a copy of it to be able to correct produce DumpModule.
     std::unique_ptr<llvm::Module> SaveLineModule(CloneModule(LineModule.get()));
-    
-    if (!linkLLVMModules(Module, std::move(LineModule))) {
-      return false;
-    }
-
-    std::unique_ptr<llvm::Module> NewModule(CloneModule(Module));
-
-    Module->getFunction("main")->eraseFromParent();
 
-    stripPreviouslyGenerated(*NewModule);
+    // Each line is JITed as a module of its own. Its references to the
+    // definitions of earlier lines are resolved against the modules of those
+    // lines, so the cost of a line does not grow with the length of the
+    // session.
+    stripPreviouslyGenerated(*LineModule);
 
     if (!linkLLVMModules(&DumpModule, std::move(SaveLineModule))) {
       return false;
@@ -888,12 +884,12 @@ private:
     llvm::Function *DumpModuleMain = DumpModule.getFunction("main");
     DumpModuleMain->setName("repl.line");
     
-    if (IRGenImportedModules(CI, *NewModule, ImportedModules, InitFns,
+    if (IRGenImportedModules(CI, *LineModule, ImportedModules, InitFns,
                              IRGenOpts, SILOpts))
       return false;
     
-    llvm::Module *TempModule = NewModule.get();
-    EE->addModule(std::move(NewModule));
+    llvm::Module *TempModule = LineModule.get();
+    EE->addModule(std::move(LineModule));
 
     EE->finalizeObject();
 
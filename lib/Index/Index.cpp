@@ -18,6 +18,7 @@
 #include "swift/Basic/SourceManager.h"
 #include "swift/Basic/StringExtras.h"
 #include "llvm/ADT/APInt.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/FileSystem.h"
 
 using namespace swift;
@@ -324,6 +325,15 @@ private:
 
   // This maps a module to all its imports, recursively.
   llvm::DenseMap<Module *, llvm::SmallVector<Module *, 4>> ImportsMap;
+
+  struct FileReferenceStatus {
+    bool Failed;
+    uint64_t Size;
+    uint64_t ModificationTime;
+  };
+  // This maps a file name to its status, so that a module that is imported by
+  // many others is only stat'ed once while computing their hashes.
+  llvm::StringMap<FileReferenceStatus> FileStatusMap;
 };
 } // anonymous namespace
 
@@ -929,20 +939,31 @@ IndexSwiftASTWalker::hashFileReference(llvm::hash_code code,
 
   // FIXME: FileManager for swift ?
 
-  llvm::sys::fs::file_status Status;
-  if (std::error_code Ret = llvm::sys::fs::status(Filename, Status)) {
+  auto Inserted = FileStatusMap.insert({Filename, FileReferenceStatus()});
+  FileReferenceStatus &Cached = Inserted.first->second;
+  if (Inserted.second) {
+    llvm::sys::fs::file_status Status;
+    if (std::error_code Ret = llvm::sys::fs::status(Filename, Status)) {
+      warn([&](llvm::raw_ostream &OS) {
+        OS << "failed to stat file: " << Filename
+           << " (" << Ret.message() << ')';
+      });
+      Cached = {true, 0, 0};
+    } else {
+      Cached = {false, Status.getSize(),
+                Status.getLastModificationTime().toEpochTime()};
+    }
+  }
+
+  if (Cached.Failed) {
     // Failure to read the file, just use filename to recover.
-    warn([&](llvm::raw_ostream &OS) {
-      OS << "failed to stat file: " << Filename << " (" << Ret.message() << ')';
-    });
     return hash_combine(code, Filename);
   }
 
   // Don't use inode because it can easily change when you update the repository
   // even though the file is supposed to be the same (same size/time).
   code = hash_combine(code, Filename);
-  return hash_combine(code, Status.getSize(),
-                      Status.getLastModificationTime().toEpochTime());
+  return hash_combine(code, Cached.Size, Cached.ModificationTime);
 }
 
 llvm::hash_code IndexSwiftASTWalker::hashModule(llvm::hash_code code,
@@ -15,8 +15,10 @@
 #include "ARCEntryPointBuilder.h"
 #include "LLVMARCOpts.h"
 #include "swift/Basic/Fallthrough.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/TinyPtrVector.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/ValueTracking.h"
 #include "llvm/IR/Verifier.h"
 #include "llvm/Transforms/Utils/SSAUpdater.h"
 
@@ -35,6 +37,11 @@ STATISTIC(NumUnknownRetainReleasesEliminatedByMergingIntoRetainReleaseN,
 STATISTIC(NumBridgeRetainReleasesEliminatedByMergingIntoRetainReleaseN,
           "Number of bridge retain/release eliminated by merging into "
           "bridgeRetain_n/bridgeRelease_n");
+STATISTIC(NumBlocksMergedIntoChain,
+          "Number of basic blocks whose retains/releases were merged with "
+          "those of their single predecessor");
+STATISTIC(NumCallsSkipped,
+          "Number of calls that retain/release merging was performed across");
 
 /// Pimpl implementation of SwiftARCContractPass.
 namespace {
@@ -56,7 +63,8 @@ struct LocalState {
 /// Optimizations include:
 ///
 ///   - Merging together retain and release calls into retain_n, release_n
-///   - calls.
+///   - calls. Merging is done across chains of basic blocks where each block
+///   - is the single successor of its single predecessor.
 ///
 /// Coming into this function, we assume that the code is in canonical form:
 /// none of these calls have any uses of their return values.
@@ -85,8 +93,32 @@ private:
   /// call.
   void
   performRRNOptimization(DenseMap<Value *, LocalState> &PtrToLocalStateMap);
+
+  /// Visit the instructions of \p BB, accumulating retains and releases in
+  /// \p PtrToLocalStateMap.
+  void
+  visitBlock(BasicBlock &BB,
+             DenseMap<Value *, LocalState> &PtrToLocalStateMap);
+
+  /// Returns true if we can merge retains and releases across the call \p CI
+  /// without another thread of execution or the callee being able to observe
+  /// the difference.
+  bool
+  canMergeAcrossCall(CallInst *CI,
+                     DenseMap<Value *, LocalState> &PtrToLocalStateMap);
 };
 
+/// Returns the block that continues the straight-line chain ending in \p BB,
+/// if any. This is the unique successor of \p BB when \p BB is also its
+/// unique predecessor, so that executing one block implies executing the
+/// other.
+static BasicBlock *getChainSuccessor(BasicBlock &BB) {
+  BasicBlock *Succ = BB.getSingleSuccessor();
+  if (!Succ || Succ == &BB || Succ->getSinglePredecessor() != &BB)
+    return nullptr;
+  return Succ;
+}
+
 } // end anonymous namespace
 
 void SwiftARCContractImpl::
@@ -254,120 +286,172 @@ performRRNOptimization(DenseMap<Value *, LocalState> &PtrToLocalStateMap) {
 }
 
 
-bool SwiftARCContractImpl::run() {
-  // intra-BB retain/release merging.
-  DenseMap<Value *, LocalState> PtrToLocalStateMap;
-  for (BasicBlock &BB : F) {
-    for (auto II = BB.begin(), IE = BB.end(); II != IE; ) {
-      // Preincrement iterator to avoid iteration issues in the loop.
-      Instruction &Inst = *II++;
-
-      auto Kind = classifyInstruction(Inst);
-      switch (Kind) {
-      // These instructions should not reach here based on the pass ordering.
-      // i.e. LLVMARCOpt -> LLVMContractOpt.
-      case RT_RetainN:
-      case RT_UnknownRetainN:
-      case RT_BridgeRetainN:
-      case RT_ReleaseN:
-      case RT_UnknownReleaseN:
-      case RT_BridgeReleaseN:
-        llvm_unreachable("These are only created by LLVMARCContract !");
-      // Delete all fix lifetime instructions. After llvm-ir they have no use
-      // and show up as calls in the final binary.
-      case RT_FixLifetime:
-        Inst.eraseFromParent();
-        ++NumNoopDeleted;
-        continue;
-      case RT_Retain: {
-        auto *CI = cast<CallInst>(&Inst);
-        auto *ArgVal = RC->getSwiftRCIdentityRoot(CI->getArgOperand(0));
+bool SwiftARCContractImpl::
+canMergeAcrossCall(CallInst *CI,
+                   DenseMap<Value *, LocalState> &PtrToLocalStateMap) {
+  // A callee that only touches memory through its arguments cannot reach a
+  // reference count, and in particular cannot perform a uniqueness check,
+  // unless it is handed one of the objects we have seen retained or released
+  // in this chain.
+  if (!CI->onlyAccessesArgMemory())
+    return false;
+
+  const DataLayout &DL = F.getParent()->getDataLayout();
+  for (Value *Arg : CI->arg_operands()) {
+    if (!Arg->getType()->isPointerTy())
+      continue;
+    auto *Root = RC->getSwiftRCIdentityRoot(GetUnderlyingObject(Arg, DL));
+    if (PtrToLocalStateMap.count(Root))
+      return false;
+  }
+  return true;
+}
 
-        LocalState &LocalEntry = PtrToLocalStateMap[ArgVal];
-        LocalEntry.RetainList.push_back(CI);
-        continue;
-      }
-      case RT_UnknownRetain: {
-        auto *CI = cast<CallInst>(&Inst);
-        auto *ArgVal = RC->getSwiftRCIdentityRoot(CI->getArgOperand(0));
+void SwiftARCContractImpl::
+visitBlock(BasicBlock &BB,
+           DenseMap<Value *, LocalState> &PtrToLocalStateMap) {
+  for (auto II = BB.begin(), IE = BB.end(); II != IE; ) {
+    // Preincrement iterator to avoid iteration issues in the loop.
+    Instruction &Inst = *II++;
+
+    auto Kind = classifyInstruction(Inst);
+    switch (Kind) {
+    // These instructions should not reach here based on the pass ordering.
+    // i.e. LLVMARCOpt -> LLVMContractOpt.
+    case RT_RetainN:
+    case RT_UnknownRetainN:
+    case RT_BridgeRetainN:
+    case RT_ReleaseN:
+    case RT_UnknownReleaseN:
+    case RT_BridgeReleaseN:
+      llvm_unreachable("These are only created by LLVMARCContract !");
+    // Delete all fix lifetime instructions. After llvm-ir they have no use
+    // and show up as calls in the final binary.
+    case RT_FixLifetime:
+      Inst.eraseFromParent();
+      ++NumNoopDeleted;
+      continue;
+    case RT_Retain: {
+      auto *CI = cast<CallInst>(&Inst);
+      auto *ArgVal = RC->getSwiftRCIdentityRoot(CI->getArgOperand(0));
+
+      LocalState &LocalEntry = PtrToLocalStateMap[ArgVal];
+      LocalEntry.RetainList.push_back(CI);
+      continue;
+    }
+    case RT_UnknownRetain: {
+      auto *CI = cast<CallInst>(&Inst);
+      auto *ArgVal = RC->getSwiftRCIdentityRoot(CI->getArgOperand(0));
 
-        LocalState &LocalEntry = PtrToLocalStateMap[ArgVal];
-        LocalEntry.UnknownRetainList.push_back(CI);
-        continue;
-      }
-      case RT_Release: {
-        // Stash any releases that we see.
-        auto *CI = cast<CallInst>(&Inst);
-        auto *ArgVal = RC->getSwiftRCIdentityRoot(CI->getArgOperand(0));
+      LocalState &LocalEntry = PtrToLocalStateMap[ArgVal];
+      LocalEntry.UnknownRetainList.push_back(CI);
+      continue;
+    }
+    case RT_Release: {
+      // Stash any releases that we see.
+      auto *CI = cast<CallInst>(&Inst);
+      auto *ArgVal = RC->getSwiftRCIdentityRoot(CI->getArgOperand(0));
+
+      LocalState &LocalEntry = PtrToLocalStateMap[ArgVal];
+      LocalEntry.ReleaseList.push_back(CI);
+      continue;
+    }
+    case RT_UnknownRelease: {
+      // Stash any releases that we see.
+      auto *CI = cast<CallInst>(&Inst);
+      auto *ArgVal = RC->getSwiftRCIdentityRoot(CI->getArgOperand(0));
+
+      LocalState &LocalEntry = PtrToLocalStateMap[ArgVal];
+      LocalEntry.UnknownReleaseList.push_back(CI);
+      continue;
+    }
+    case RT_BridgeRetain: {
+      auto *CI = cast<CallInst>(&Inst);
+      auto *ArgVal = RC->getSwiftRCIdentityRoot(CI->getArgOperand(0));
 
-        LocalState &LocalEntry = PtrToLocalStateMap[ArgVal];
-        LocalEntry.ReleaseList.push_back(CI);
-        continue;
-      }
-      case RT_UnknownRelease: {
-        // Stash any releases that we see.
-        auto *CI = cast<CallInst>(&Inst);
-        auto *ArgVal = RC->getSwiftRCIdentityRoot(CI->getArgOperand(0));
+      LocalState &LocalEntry = PtrToLocalStateMap[ArgVal];
+      LocalEntry.BridgeRetainList.push_back(CI);
+      continue;
+    }
+    case RT_BridgeRelease: {
+      auto *CI = cast<CallInst>(&Inst);
+      auto *ArgVal = RC->getSwiftRCIdentityRoot(CI->getArgOperand(0));
 
-        LocalState &LocalEntry = PtrToLocalStateMap[ArgVal];
-        LocalEntry.UnknownReleaseList.push_back(CI);
-        continue;
-      }
-      case RT_BridgeRetain: {
-        auto *CI = cast<CallInst>(&Inst);
-        auto *ArgVal = RC->getSwiftRCIdentityRoot(CI->getArgOperand(0));
+      LocalState &LocalEntry = PtrToLocalStateMap[ArgVal];
+      LocalEntry.BridgeReleaseList.push_back(CI);
+      continue;
+    }
+    case RT_Unknown:
+    case RT_AllocObject:
+    case RT_NoMemoryAccessed:
+    case RT_RetainUnowned:
+    case RT_CheckUnowned:
+    case RT_ObjCRelease:
+    case RT_ObjCRetain:
+      break;
+    }
 
-        LocalState &LocalEntry = PtrToLocalStateMap[ArgVal];
-        LocalEntry.BridgeRetainList.push_back(CI);
-        continue;
-      }
-      case RT_BridgeRelease: {
-        auto *CI = cast<CallInst>(&Inst);
-        auto *ArgVal = RC->getSwiftRCIdentityRoot(CI->getArgOperand(0));
+    if (Kind != RT_Unknown)
+      continue;
 
-        LocalState &LocalEntry = PtrToLocalStateMap[ArgVal];
-        LocalEntry.BridgeReleaseList.push_back(CI);
+    if (auto *CI = dyn_cast<CallInst>(&Inst)) {
+      if (canMergeAcrossCall(CI, PtrToLocalStateMap)) {
+        ++NumCallsSkipped;
         continue;
       }
-      case RT_Unknown:
-      case RT_AllocObject:
-      case RT_NoMemoryAccessed:
-      case RT_RetainUnowned:
-      case RT_CheckUnowned:
-      case RT_ObjCRelease:
-      case RT_ObjCRetain:
-        break;
-      }
+    }
+    
+    // If we have an unknown call, we need to create any retainN calls we
+    // have seen. The reason why is that we do not want to move retains,
+    // releases over isUniquelyReferenced calls. Specifically imagine this:
+    //
+    // retain(x); unknown(x); release(x); isUniquelyReferenced(x); retain(x);
+    //
+    // In this case we would with this optimization merge the last retain
+    // with the first. This would then create an additional copy. The
+    // release side of this is:
+    //
+    // retain(x); unknown(x); release(x); isUniquelyReferenced(x); release(x);
+    //
+    // Again in such a case by merging the first release with the second
+    // release, we would be introducing an additional copy.
+    //
+    // Thus if we see an unknown call we merge together all retains and
+    // releases before. Calls that canMergeAcrossCall proves cannot observe
+    // the reference counts we are merging are skipped above.
+    performRRNOptimization(PtrToLocalStateMap);
+  }
+}
 
-      if (Kind != RT_Unknown)
-        continue;
-      
-      // If we have an unknown call, we need to create any retainN calls we
-      // have seen. The reason why is that we do not want to move retains,
-      // releases over isUniquelyReferenced calls. Specifically imagine this:
-      //
-      // retain(x); unknown(x); release(x); isUniquelyReferenced(x); retain(x);
-      //
-      // In this case we would with this optimization merge the last retain
-      // with the first. This would then create an additional copy. The
-      // release side of this is:
-      //
-      // retain(x); unknown(x); release(x); isUniquelyReferenced(x); release(x);
-      //
-      // Again in such a case by merging the first release with the second
-      // release, we would be introducing an additional copy.
-      //
-      // Thus if we see an unknown call we merge together all retains and
-      // releases before. This could be made more aggressive through
-      // appropriate alias analysis and usage of LLVM's function attributes to
-      // determine that a function does not touch globals.
-      performRRNOptimization(PtrToLocalStateMap);
+bool SwiftARCContractImpl::run() {
+  // Retain/release merging over straight-line chains of blocks. We start a
+  // chain at every block that does not continue another block's chain, then
+  // pick up any blocks that are only reachable around a cycle of chain
+  // continuations.
+  DenseMap<Value *, LocalState> PtrToLocalStateMap;
+  SmallPtrSet<BasicBlock *, 16> Visited;
+  auto visitChain = [&](BasicBlock &Head) {
+    for (BasicBlock *BB = &Head; BB && Visited.insert(BB).second;
+         BB = getChainSuccessor(*BB)) {
+      if (BB != &Head)
+        ++NumBlocksMergedIntoChain;
+      visitBlock(*BB, PtrToLocalStateMap);
     }
 
     // Perform the RRNOptimization.
     performRRNOptimization(PtrToLocalStateMap);
     PtrToLocalStateMap.clear();
+  };
+
+  for (BasicBlock &BB : F) {
+    BasicBlock *Pred = BB.getSinglePredecessor();
+    if (Pred && getChainSuccessor(*Pred) == &BB)
+      continue;
+    visitChain(BB);
   }
+  for (BasicBlock &BB : F)
+    if (!Visited.count(&BB))
+      visitChain(BB);
 
   return Changed;
 }
@@ -1024,7 +1024,9 @@ int FunctionComparator::cmpGEPs(const GEPOperator *GEPL,
   if (int Res = cmpNumbers(GEPL->getNumOperands(), GEPR->getNumOperands()))
     return Res;
 
-  for (unsigned i = 0, e = GEPL->getNumOperands(); i != e; ++i) {
+  // The pointer operand is compared by the caller, which may allow it to
+  // differ between the functions.
+  for (unsigned i = 1, e = GEPL->getNumOperands(); i != e; ++i) {
     if (int Res = cmpValues(GEPL->getOperand(i), GEPR->getOperand(i)))
       return Res;
   }
@@ -1100,12 +1102,30 @@ int FunctionComparator::cmpValues(const Value *L, const Value *R) const {
   return cmpNumbers(LeftSN.first->second, RightSN.first->second);
 }
 
-static bool isEligibleForConstantSharing(const Instruction *I) {
+/// Returns true if the constant operand \p OpIdx of \p I may differ between
+/// merged functions, i.e. may be replaced by a parameter.
+///
+/// Besides loads, stores and calls (including the callee), this covers the
+/// places where specializations commonly reference different metadata or
+/// witness tables: the base of a GEP, and casts, comparisons and selects of
+/// pointers. Differing integer constants in arithmetic are not shared, since
+/// turning them into parameters would pessimize the merged function.
+static bool isEligibleForConstantSharing(const Instruction *I,
+                                         unsigned OpIdx) {
   switch (I->getOpcode()) {
     case Instruction::Load:
     case Instruction::Store:
     case Instruction::Call:
+    case Instruction::Invoke:
       return true;
+    case Instruction::ICmp:
+    case Instruction::Select:
+    case Instruction::BitCast:
+    case Instruction::PtrToInt:
+      return I->getOperand(OpIdx)->getType()->isPointerTy();
+    case Instruction::GetElementPtr:
+      // Struct indices must stay constant.
+      return OpIdx == 0;
     default:
       return false;
   }
@@ -1123,20 +1143,20 @@ int FunctionComparator::cmpOperands(const Instruction *L, const Instruction *R,
   if (!isa<Constant>(OpL) || !isa<Constant>(OpR))
     return Res;
 
-  if (!isEligibleForConstantSharing(L))
+  if (!isEligibleForConstantSharing(L, opIdx))
     return Res;
 
-  if (const CallInst *CL = dyn_cast<CallInst>(L)) {
-    if (CL->isInlineAsm())
+  if (ImmutableCallSite CSL = ImmutableCallSite(L)) {
+    if (CSL.isInlineAsm())
       return Res;
-    if (Function *CalleeL = CL->getCalledFunction()) {
+    if (const Function *CalleeL = CSL.getCalledFunction()) {
       if (CalleeL->isIntrinsic())
         return Res;
     }
-    const CallInst *CR = cast<CallInst>(R);
-    if (CR->isInlineAsm())
+    ImmutableCallSite CSR(R);
+    if (CSR.isInlineAsm())
       return Res;
-    if (Function *CalleeR = CR->getCalledFunction()) {
+    if (const Function *CalleeR = CSR.getCalledFunction()) {
       if (CalleeR->isIntrinsic())
         return Res;
     }
@@ -1167,8 +1187,7 @@ int FunctionComparator::cmpBasicBlocks(const BasicBlock *BBL,
       return -1;
 
     if (GEPL && GEPR) {
-      if (int Res =
-              cmpValues(GEPL->getPointerOperand(), GEPR->getPointerOperand()))
+      if (int Res = cmpOperands(GEPL, GEPR, 0))
         return Res;
       if (int Res = cmpGEPs(GEPL, GEPR))
         return Res;
@@ -1875,10 +1894,9 @@ bool SwiftMergeFunctions::deriveParams(ParamInfos &Params,
 
   // Iterate over all instructions synchronously in all functions.
   do {
-    if (isEligibleForConstantSharing(FirstFI.CurrentInst)) {
-      for (unsigned OpIdx = 0, NumOps = FirstFI.CurrentInst->getNumOperands();
-           OpIdx != NumOps; ++OpIdx) {
-
+    for (unsigned OpIdx = 0, NumOps = FirstFI.CurrentInst->getNumOperands();
+         OpIdx != NumOps; ++OpIdx) {
+      if (isEligibleForConstantSharing(FirstFI.CurrentInst, OpIdx)) {
         if (constsDiffer(FInfos, OpIdx)) {
           // This instruction has operands which differ in at least some
           // functions. So we need to parameterize it.
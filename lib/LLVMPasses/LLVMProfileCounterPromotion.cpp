@@ -0,0 +1,208 @@
+//===--- LLVMProfileCounterPromotion.cpp - Keep counters in registers -----===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// The profile counters of -profile-generate are lowered to a load, an add and
+// a store to a global counter array. Inside of a loop this is a memory update
+// per iteration, on cache lines which are shared by all the threads executing
+// the code, and LICM can't hoist the updates because every call in the loop
+// may read the counters.
+//
+// Only the profiling runtime reads the counters, when the profile is written.
+// So this pass keeps the counts of a loop in registers and adds them to the
+// counters once at each exit of the loop. Inner loops are promoted first, so
+// that the updates they leave in their exits are promoted into the outer loop.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "swift-profile-counter-promotion"
+#include "swift/LLVMPasses/Passes.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/ProfileData/InstrProf.h"
+#include "llvm/Transforms/Utils/SSAUpdater.h"
+
+using namespace llvm;
+using namespace swift;
+
+STATISTIC(NumCountersPromoted,
+          "Number of profile counters promoted out of a loop");
+STATISTIC(NumUpdatesRemoved,
+          "Number of profile counter updates removed from loops");
+
+namespace {
+
+/// A lowered counter update: store (add (load Addr), Step), Addr.
+struct CounterUpdate {
+  LoadInst *Load;
+  BinaryOperator *Add;
+  StoreInst *Store;
+};
+
+class SwiftProfileCounterPromotion : public FunctionPass {
+  /// Loops with more exits are not promoted, because every exit needs an
+  /// update of every promoted counter.
+  enum { MaxExitBlocks = 8 };
+
+  bool promoteCounters(Loop *L);
+
+public:
+  static char ID;
+  SwiftProfileCounterPromotion() : FunctionPass(ID) {}
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.addRequired<LoopInfoWrapperPass>();
+    AU.setPreservesCFG();
+  }
+
+  bool runOnFunction(Function &F) override;
+};
+
+} // end anonymous namespace
+
+/// Returns the counter written by \p SI if it is a lowered counter update.
+static Value *getCounterAddress(StoreInst *SI) {
+  if (SI->isVolatile() || SI->isAtomic())
+    return nullptr;
+  auto *Global =
+    dyn_cast<GlobalVariable>(SI->getPointerOperand()->stripInBoundsOffsets());
+  if (!Global ||
+      !Global->getName().startswith(getInstrProfCountersVarPrefix()))
+    return nullptr;
+  return SI->getPointerOperand();
+}
+
+/// Matches the add and the load feeding the counter update \p SI.
+static bool matchUpdate(StoreInst *SI, CounterUpdate &Update) {
+  auto *Add = dyn_cast<BinaryOperator>(SI->getValueOperand());
+  if (!Add || Add->getOpcode() != Instruction::Add || !Add->hasOneUse() ||
+      Add->getParent() != SI->getParent())
+    return false;
+  auto *Load = dyn_cast<LoadInst>(Add->getOperand(0));
+  if (!Load || Load->getPointerOperand() != SI->getPointerOperand() ||
+      !Load->hasOneUse() || Load->isVolatile() || Load->isAtomic() ||
+      Load->getParent() != SI->getParent())
+    return false;
+  Update = {Load, Add, SI};
+  return true;
+}
+
+bool SwiftProfileCounterPromotion::promoteCounters(Loop *L) {
+  BasicBlock *Preheader = L->getLoopPreheader();
+  if (!Preheader || !L->hasDedicatedExits())
+    return false;
+
+  SmallVector<BasicBlock *, MaxExitBlocks> ExitBlocks;
+  L->getUniqueExitBlocks(ExitBlocks);
+  if (ExitBlocks.size() > MaxExitBlocks)
+    return false;
+  for (BasicBlock *Exit : ExitBlocks)
+    if (Exit->getFirstInsertionPt() == Exit->end())
+      return false;
+
+  // Collect the updates of each counter. A counter which is accessed in any
+  // other way, or updated twice in one block, stays in memory.
+  MapVector<Value *, SmallVector<CounterUpdate, 4>> Updates;
+  SmallPtrSet<Value *, 4> Unpromotable;
+  for (BasicBlock *BB : L->blocks()) {
+    SmallPtrSet<Value *, 4> UpdatedInBlock;
+    for (Instruction &I : *BB) {
+      auto *SI = dyn_cast<StoreInst>(&I);
+      if (!SI)
+        continue;
+      Value *Addr = getCounterAddress(SI);
+      if (!Addr)
+        continue;
+      CounterUpdate Update;
+      if (!matchUpdate(SI, Update) || !UpdatedInBlock.insert(Addr).second) {
+        Unpromotable.insert(Addr);
+        continue;
+      }
+      Updates[Addr].push_back(Update);
+    }
+  }
+
+  bool Changed = false;
+  for (auto &Entry : Updates) {
+    Value *Addr = Entry.first;
+    if (Unpromotable.count(Addr))
+      continue;
+
+    // The count of the loop starts at zero in the preheader, and each update
+    // adds its step to the count instead of the counter.
+    auto &CounterUpdates = Entry.second;
+    Type *CountTy = CounterUpdates.front().Add->getType();
+    SSAUpdater SSA;
+    SSA.Initialize(CountTy, "pgocount.promoted");
+    SSA.AddAvailableValue(Preheader, ConstantInt::get(CountTy, 0));
+    for (auto &Update : CounterUpdates)
+      SSA.AddAvailableValue(Update.Store->getParent(), Update.Add);
+
+    for (auto &Update : CounterUpdates) {
+      Value *Count = SSA.GetValueInMiddleOfBlock(Update.Store->getParent());
+      Update.Add->setOperand(0, Count);
+      Update.Store->eraseFromParent();
+      Update.Load->eraseFromParent();
+      ++NumUpdatesRemoved;
+    }
+
+    // Add the count to the counter at every exit.
+    for (BasicBlock *Exit : ExitBlocks) {
+      Value *Count = SSA.GetValueInMiddleOfBlock(Exit);
+      IRBuilder<> Builder(&*Exit->getFirstInsertionPt());
+      Value *Old = Builder.CreateLoad(Addr, "pgocount");
+      Builder.CreateStore(Builder.CreateAdd(Old, Count), Addr);
+    }
+    ++NumCountersPromoted;
+    Changed = true;
+  }
+  return Changed;
+}
+
+bool SwiftProfileCounterPromotion::runOnFunction(Function &F) {
+  auto &LI = getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
+
+  // Every loop is preceded by its parent in this list, so visiting it in
+  // reverse visits inner loops before their parents.
+  SmallVector<Loop *, 8> Worklist;
+  SmallVector<Loop *, 8> Loops;
+  Worklist.append(LI.begin(), LI.end());
+  while (!Worklist.empty()) {
+    Loop *L = Worklist.pop_back_val();
+    Loops.push_back(L);
+    Worklist.append(L->begin(), L->end());
+  }
+
+  bool Changed = false;
+  for (auto I = Loops.rbegin(), E = Loops.rend(); I != E; ++I)
+    Changed |= promoteCounters(*I);
+  return Changed;
+}
+
+char SwiftProfileCounterPromotion::ID = 0;
+INITIALIZE_PASS_BEGIN(SwiftProfileCounterPromotion,
+                      "swift-profile-counter-promotion",
+                      "Swift profile counter promotion", false, false)
+INITIALIZE_PASS_DEPENDENCY(LoopInfoWrapperPass)
+INITIALIZE_PASS_END(SwiftProfileCounterPromotion,
+                    "swift-profile-counter-promotion",
+                    "Swift profile counter promotion", false, false)
+
+llvm::FunctionPass *swift::createSwiftProfileCounterPromotionPass() {
+  initializeSwiftProfileCounterPromotionPass(
+      *llvm::PassRegistry::getPassRegistry());
+  return new SwiftProfileCounterPromotion();
+}
@@ -28,6 +28,10 @@
 // FIXME: Figure out if this can be migrated to LLVM.
 #include "clang/Basic/CharInfo.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 using namespace swift;
 
 // clang::isIdentifierHead and clang::isIdentifierBody are deliberately not in
@@ -293,6 +297,78 @@ Lexer::State Lexer::getStateForBeginningOfTokenLoc(SourceLoc Loc) const {
 // Lexer Subroutines
 //===----------------------------------------------------------------------===//
 
+// The scanners below skip runs of plain ASCII bytes that the byte-at-a-time
+// loops would only step over, stopping at the first byte those loops need to
+// look at. They never read at or past the end of the buffer, and without SSE2
+// they don't skip anything.
+
+#if defined(__SSE2__)
+/// Returns a bit mask of the bytes in \p Chunk that equal \p C.
+static inline unsigned getMaskOfByte(__m128i Chunk, char C) {
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(Chunk, _mm_set1_epi8(C)));
+}
+
+/// Returns a bit mask of the bytes in \p Chunk that can end a line: newlines
+/// and nuls, plus any byte of a non-ASCII character, which must be validated.
+static inline unsigned getMaskOfLineBreakBytes(__m128i Chunk) {
+  return _mm_movemask_epi8(Chunk) | getMaskOfByte(Chunk, '\n') |
+         getMaskOfByte(Chunk, '\r') | getMaskOfByte(Chunk, 0);
+}
+
+static inline __m128i loadChunk(const char *Ptr) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i *>(Ptr));
+}
+#endif
+
+/// Skips bytes that skipToEndOfLine would pass over.
+static const char *skipLineCommentBytes(const char *Ptr, const char *End) {
+#if defined(__SSE2__)
+  while (End - Ptr >= 16) {
+    if (unsigned Mask = getMaskOfLineBreakBytes(loadChunk(Ptr)))
+      return Ptr + llvm::countTrailingZeros(Mask);
+    Ptr += 16;
+  }
+#endif
+  return Ptr;
+}
+
+/// Skips bytes that skipSlashStarComment would pass over.
+static const char *skipBlockCommentBytes(const char *Ptr, const char *End) {
+#if defined(__SSE2__)
+  while (End - Ptr >= 16) {
+    __m128i Chunk = loadChunk(Ptr);
+    unsigned Mask = getMaskOfLineBreakBytes(Chunk) |
+                    getMaskOfByte(Chunk, '*') | getMaskOfByte(Chunk, '/');
+    if (Mask)
+      return Ptr + llvm::countTrailingZeros(Mask);
+    Ptr += 16;
+  }
+#endif
+  return Ptr;
+}
+
+/// Skips printable ASCII bytes other than quotes and backslashes, which
+/// lexCharacter would return unchanged.
+static const char *skipStringLiteralBytes(const char *Ptr, const char *End) {
+#if defined(__SSE2__)
+  while (End - Ptr >= 16) {
+    __m128i Chunk = loadChunk(Ptr);
+    // Bytes of non-ASCII characters compare as negative, so they fail the
+    // first test.
+    __m128i Printable =
+      _mm_and_si128(_mm_cmpgt_epi8(Chunk, _mm_set1_epi8(0x1F)),
+                    _mm_cmplt_epi8(Chunk, _mm_set1_epi8(0x7F)));
+    unsigned Mask = (~_mm_movemask_epi8(Printable) & 0xFFFF) |
+                    getMaskOfByte(Chunk, '"') | getMaskOfByte(Chunk, '\'') |
+                    getMaskOfByte(Chunk, '\\');
+    if (Mask)
+      return Ptr + llvm::countTrailingZeros(Mask);
+    Ptr += 16;
+  }
+#endif
+  return Ptr;
+}
+
 static void diagnoseEmbeddedNul(DiagnosticEngine *Diags, const char *Ptr) {
   assert(Ptr && "invalid source location");
   assert(*Ptr == '\0' && "not an embedded null");
@@ -308,6 +384,7 @@ static void diagnoseEmbeddedNul(DiagnosticEngine *Diags, const char *Ptr) {
 
 void Lexer::skipToEndOfLine() {
   while (1) {
+    CurPtr = skipLineCommentBytes(CurPtr, BufferEnd);
     switch (*CurPtr++) {
     case '\n':
     case '\r':
@@ -361,6 +438,7 @@ void Lexer::skipSlashStarComment() {
   unsigned Depth = 1;
   
   while (1) {
+    CurPtr = skipBlockCommentBytes(CurPtr, BufferEnd);
     switch (*CurPtr++) {
     case '*':
       // Check for a '*/'
@@ -568,8 +646,14 @@ void Lexer::lexIdentifier() {
   assert(didStart && "Unexpected start");
   (void) didStart;
 
-  // Lex [a-zA-Z_$0-9[[:XID_Continue:]]]*
-  while (advanceIfValidContinuationOfIdentifier(CurPtr, BufferEnd));
+  // Lex [a-zA-Z_$0-9[[:XID_Continue:]]]*, taking ASCII without decoding it.
+  while (true) {
+    while (clang::isIdentifierBody(*CurPtr, /*dollar*/true))
+      ++CurPtr;
+    if ((signed char)*CurPtr >= 0 ||
+        !advanceIfValidContinuationOfIdentifier(CurPtr, BufferEnd))
+      break;
+  }
 
   tok Kind = kindOfIdentifier(StringRef(TokStart, CurPtr-TokStart), InSILMode);
   return formToken(Kind, TokStart);
@@ -1253,6 +1337,8 @@ void Lexer::lexStringLiteral() {
   bool wasErroneous = false;
   
   while (true) {
+    CurPtr = skipStringLiteralBytes(CurPtr, BufferEnd);
+
     if (*CurPtr == '\\' && *(CurPtr + 1) == '(') {
       // Consume tokens until we hit the corresponding ')'.
       CurPtr += 2;
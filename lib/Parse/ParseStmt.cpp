@@ -292,9 +292,14 @@ ParserStatus Parser::parseBraceItems(SmallVectorImpl<ASTNode> &Entries,
     PreviousHadSemi = false;
     if (isStartOfDecl()
         && Tok.isNot(tok::pound_if, tok::pound_sourceLocation)) {
+      // Hash each top-level declaration's interface on its own, so that
+      // dependency tracking can tell which declarations changed.
+      bool HashingDecl = IsTopLevel && SF.beginDeclInterfaceHash();
       ParserStatus Status =
           parseDecl(IsTopLevel ? PD_AllowTopLevel : PD_Default,
                     [&](Decl *D) {TmpDecls.push_back(D);});
+      if (HashingDecl)
+        SF.endDeclInterfaceHash(TmpDecls);
       if (Status.isError()) {
         NeedParseErrorRecovery = true;
         if (Status.hasCodeCompletion() && IsTopLevel &&
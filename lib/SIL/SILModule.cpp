@@ -15,6 +15,7 @@
 #include "swift/AST/GenericEnvironment.h"
 #include "swift/AST/Substitution.h"
 #include "swift/SIL/FormalLinkage.h"
+#include "swift/SIL/Mangle.h"
 #include "swift/SIL/SILDebugScope.h"
 #include "swift/SIL/SILModule.h"
 #include "Linker.h"
@@ -482,6 +483,23 @@ SILFunction *SILModule::lookUpFunction(SILDeclRef fnRef) {
   return lookUpFunction(name);
 }
 
+std::string
+SILModule::getGenericSpecializationName(SILFunction *genericFunc,
+                                        ArrayRef<Substitution> subs,
+                                        IsFragile_t fragile) {
+  auto canonicalSubs = getASTContext().getCanonicalSubstitutions(subs);
+  auto &name = GenericSpecializationNames[genericFunc->getName()]
+                 [{canonicalSubs.data(), unsigned(fragile)}];
+  if (name.empty()) {
+    Mangle::Mangler mangler;
+    GenericSpecializationMangler genericMangler(mangler, genericFunc,
+                                                canonicalSubs, fragile);
+    genericMangler.mangle();
+    name = mangler.finalize();
+  }
+  return name;
+}
+
 bool SILModule::linkFunction(SILFunction *Fun, SILModule::LinkingMode Mode) {
   return SILLinkerVisitor(*this, getSILLoader(), Mode).processFunction(Fun);
 }
@@ -535,6 +535,13 @@ public:
       for (auto Id : PredIDs)
         *this << ' ' << Id;
     }
+    if (auto Count = BB->getExecutionCount()) {
+      if (BB->pred_empty())
+        PrintState.OS.PadToColumn(50);
+      else
+        *this << ' ';
+      PrintState.OS << "// count: " << *Count;
+    }
     *this << '\n';
 
     for (const SILInstruction &I : *BB) {
@@ -28,6 +28,7 @@
 #include "swift/SIL/PrettyStackTrace.h"
 #include "swift/SIL/TypeLowering.h"
 #include "swift/ClangImporter/ClangModule.h"
+#include "swift/Basic/Program.h"
 #include "swift/Basic/Range.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/ADT/DenseSet.h"
@@ -3529,18 +3530,51 @@ void SILGlobalVariable::verify() const {
 }
 
 /// Verify the module.
+#ifndef NDEBUG
+/// Modules with fewer functions per worker are verified in-process.
+static const size_t MinFunctionsPerVerifierWorker = 64;
+#endif
+
 void SILModule::verify() const {
+  verify([](const SILFunction &) { return true; });
+}
+
+void SILModule::verify(
+    llvm::function_ref<bool(const SILFunction &)> ShouldVerify) const {
 #ifndef NDEBUG
   // Uniquing set to catch symbol name collisions.
   llvm::StringSet<> symbolNames;
 
   // Check all functions.
+  SmallVector<const SILFunction *, 64> functions;
   for (const SILFunction &f : *this) {
     if (!symbolNames.insert(f.getName()).second) {
       llvm::errs() << "Symbol redefined: " << f.getName() << "!\n";
       assert(false && "triggering standard assertion failure routine");
     }
-    f.verify(/*SingleFunction=*/ false);
+    if (ShouldVerify(f))
+      functions.push_back(&f);
+  }
+
+  // The functions are verified independently of each other, so they can be
+  // split between worker processes.
+  unsigned numWorkers = std::min<size_t>(
+      getASTContext().LangOpts.VerifierWorkerCount,
+      functions.size() / MinFunctionsPerVerifierWorker);
+  if (numWorkers > 1) {
+    bool verified = runShardsInWorkerProcesses(numWorkers, [&](unsigned i) {
+      size_t begin = functions.size() * i / numWorkers;
+      size_t end = functions.size() * (i + 1) / numWorkers;
+      for (auto *f : makeArrayRef(functions).slice(begin, end - begin))
+        f->verify(/*SingleFunction=*/ false);
+    });
+    if (!verified) {
+      llvm::errs() << "SIL verification failed in a worker process\n";
+      assert(false && "triggering standard assertion failure routine");
+    }
+  } else {
+    for (auto *f : functions)
+      f->verify(/*SingleFunction=*/ false);
   }
 
   // Check all globals.
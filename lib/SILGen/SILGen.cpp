@@ -27,6 +27,7 @@
 #include "swift/SIL/SILArgument.h"
 #include "swift/SIL/SILDebugScope.h"
 #include "swift/Subsystems.h"
+#include "llvm/ProfileData/InstrProfReader.h"
 #include "llvm/Support/Debug.h"
 #include "RValue.h"
 using namespace swift;
@@ -39,6 +40,15 @@ using namespace Lowering;
 SILGenModule::SILGenModule(SILModule &M, Module *SM, bool makeModuleFragile)
   : M(M), Types(M.Types), SwiftModule(SM), TopLevelSGF(nullptr),
     Profiler(nullptr), makeModuleFragile(makeModuleFragile) {
+  const SILOptions &Opts = M.getOptions();
+  if (!Opts.UseProfile.empty()) {
+    auto ReaderOrErr = llvm::IndexedInstrProfReader::create(Opts.UseProfile);
+    if (auto E = ReaderOrErr.takeError())
+      diagnose(SourceLoc(), diag::profile_read_error, Opts.UseProfile,
+               llvm::toString(std::move(E)));
+    else
+      PGOReader = std::move(ReaderOrErr.get());
+  }
 }
 
 SILGenModule::~SILGenModule() {
@@ -535,6 +545,28 @@ void SILGenModule::visitFuncDecl(FuncDecl *fd) {
   emitFunction(fd);
 }
 
+/// Whether a definition written in the source may be emitted only once it is
+/// referenced. When optimizing, a definition that isn't referenced in the
+/// module and can't be used externally is dead, and would only cost SILGen
+/// and mandatory pass time until dead function elimination deletes it.
+static bool mayDelayExplicitDefinition(SILGenModule &SGM,
+                                       SILDeclRef constant) {
+  auto &Opts = SGM.M.getOptions();
+  if (Opts.Optimization < SILOptions::SILOptMode::Optimize ||
+      Opts.GenerateProfile || Opts.EmitProfileCoverageMapping)
+    return false;
+
+  if (!constant.hasDecl())
+    return false;
+
+  // Don't delay definitions that may be referenced by name from outside of
+  // Swift code.
+  auto *decl = constant.getDecl();
+  return !decl->getAttrs().hasAttribute<SILGenNameAttr>() &&
+         !decl->getAttrs().hasAttribute<CDeclAttr>() &&
+         !decl->isObjC() && !decl->isDynamic();
+}
+
 /// Emit a function now, if it's externally usable or has been referenced in
 /// the current TU, or remember how to emit it later if not.
 template<typename /*void (SILFunction*)*/ Fn>
@@ -551,10 +583,12 @@ void emitOrDelayFunction(SILGenModule &SGM,
   // Shared thunks and Clang-imported definitions can always be delayed.
   if (constant.isThunk() || constant.isClangImported()) {
     mayDelay = true;
-  // Implicit decls may be delayed if they can't be used externally.
+  // Implicit decls, and explicit ones when optimizing, may be delayed if they
+  // can't be used externally.
   } else {
     auto linkage = constant.getLinkage(ForDefinition);
-    mayDelay = constant.isImplicit()
+    mayDelay = (constant.isImplicit() ||
+                mayDelayExplicitDefinition(SGM, constant))
       && !isPossiblyUsedExternally(linkage, SGM.M.isWholeModule());
   }
 
@@ -667,6 +701,11 @@ static bool hasSILBody(FuncDecl *fd) {
   if (fd->getAccessorKind() == AccessorKind::IsMaterializeForSet)
     return !isa<ProtocolDecl>(fd->getDeclContext());
 
+  // Functions whose bodies were skipped during type checking get a body
+  // that traps.
+  if (fd->getBodyKind() == AbstractFunctionDecl::BodyKind::Skipped)
+    return true;
+
   return fd->getBody(/*canSynthesize=*/false);
 }
 
@@ -34,7 +34,7 @@ using namespace Lowering;
 //===----------------------------------------------------------------------===//
 
 SILGenFunction::SILGenFunction(SILGenModule &SGM, SILFunction &F)
-  : SGM(SGM), F(F),
+  : SGM(SGM), F(F), Trace("silgen", F.getName()),
     B(*this, createBasicBlock()),
     OpenedArchetypesTracker(F),
     CurrentSILLoc(F.getLocation()),
@@ -474,8 +474,14 @@ void SILGenFunction::emitFunction(FuncDecl *fd) {
   emitProlog(fd, fd->getParameterLists(), resultTy);
   prepareEpilog(resultTy, fd->hasThrows(), CleanupLocation(fd));
 
-  emitProfilerIncrement(fd->getBody());
-  emitStmt(fd->getBody());
+  if (auto *body = fd->getBody()) {
+    emitProfilerIncrement(body);
+    emitStmt(body);
+  } else {
+    // The body was never type-checked. Only declarations are needed from
+    // this module, so it is never run.
+    B.createUnreachable(RegularLocation(fd));
+  }
 
   emitEpilog(fd);
 }
@@ -17,6 +17,7 @@
 #include "JumpDest.h"
 #include "Initialization.h"
 #include "swift/AST/AnyFunctionRef.h"
+#include "swift/Basic/Trace.h"
 #include "swift/SIL/SILBuilder.h"
 #include "llvm/ADT/PointerIntPair.h"
 
@@ -306,6 +307,9 @@ public:
     
   /// The SILFunction being constructed.
   SILFunction &F;
+
+  /// The -trace-output event for the emission of F.
+  TraceScope Trace;
   
   /// The name of the function currently being emitted, as presented to user
   /// code by #function.
@@ -23,6 +23,7 @@
 #include "llvm/ProfileData/Coverage/CoverageMapping.h"
 #include "llvm/ProfileData/Coverage/CoverageMappingWriter.h"
 #include "llvm/ProfileData/InstrProf.h"
+#include "llvm/ProfileData/InstrProfReader.h"
 
 #include <forward_list>
 
@@ -83,10 +84,10 @@ ProfilerRAII::ProfilerRAII(SILGenModule &SGM, Decl *D)
   assert(isa<AbstractFunctionDecl>(D) ||
          isa<TopLevelCodeDecl>(D) && "Cannot create profiler for this decl");
   const auto &Opts = SGM.M.getOptions();
-  if (!Opts.GenerateProfile || isUnmappedDecl(D))
+  if (!(Opts.GenerateProfile || SGM.PGOReader) || isUnmappedDecl(D))
     return;
-  SGM.Profiler =
-      llvm::make_unique<SILGenProfiling>(SGM, Opts.EmitProfileCoverageMapping);
+  SGM.Profiler = llvm::make_unique<SILGenProfiling>(
+      SGM, Opts.GenerateProfile && Opts.EmitProfileCoverageMapping);
   SGM.Profiler->assignRegionCounters(D);
 }
 
@@ -720,6 +721,13 @@ void SILGenProfiling::assignRegionCounters(Decl *Root) {
   // TODO: Mapper needs to calculate a function hash as it goes.
   FunctionHash = 0x0;
 
+  PGOFuncName = llvm::getPGOFuncName(
+      CurrentFuncName, getEquivalentPGOLinkage(CurrentFuncLinkage),
+      CurrentFileName);
+
+  if (SGM.PGOReader)
+    loadRegionCounts();
+
   if (EmitCoverageMapping) {
     CoverageMapping Coverage(SM);
     walkForProfiling(Root, Coverage);
@@ -730,6 +738,25 @@ void SILGenProfiling::assignRegionCounters(Decl *Root) {
   }
 }
 
+void SILGenProfiling::loadRegionCounts() {
+  if (llvm::Error E = SGM.PGOReader->getFunctionCounts(
+          PGOFuncName, FunctionHash, RegionCounts)) {
+    // The function isn't in the profile, or has changed since the profile was
+    // collected. Either way it gets no counts.
+    llvm::consumeError(std::move(E));
+    RegionCounts.clear();
+    return;
+  }
+
+  if (RegionCounts.size() != NumRegionCounters) {
+    RegionCounts.clear();
+    return;
+  }
+
+  for (uint64_t Count : RegionCounts)
+    SGM.M.noteProfileCount(Count);
+}
+
 static SILLocation getLocation(ASTNode Node) {
   if (Expr *E = Node.dyn_cast<Expr *>())
     return E;
@@ -748,13 +775,18 @@ void SILGenProfiling::emitCounterIncrement(SILGenBuilder &Builder,ASTNode Node){
   assert(CounterIt != RegionCounterMap.end() &&
          "cannot increment non-existent counter");
 
+  // The increment runs exactly as often as the block it is emitted into, so
+  // the counter's value is that block's execution count.
+  if (!RegionCounts.empty())
+    if (SILBasicBlock *BB = Builder.getInsertionBB())
+      BB->setExecutionCount(RegionCounts[CounterIt->second]);
+
+  if (!SGM.M.getOptions().GenerateProfile)
+    return;
+
   auto Int32Ty = SGM.Types.getLoweredType(BuiltinIntegerType::get(32, C));
   auto Int64Ty = SGM.Types.getLoweredType(BuiltinIntegerType::get(64, C));
 
-  std::string PGOFuncName = llvm::getPGOFuncName(
-      CurrentFuncName, getEquivalentPGOLinkage(CurrentFuncLinkage),
-      CurrentFileName);
-
   SILLocation Loc = getLocation(Node);
   SILValue Args[] = {
       // The intrinsic must refer to the function profiling name var, which is
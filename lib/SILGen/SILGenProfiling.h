@@ -39,10 +39,15 @@ private:
   std::string CurrentFuncName;
   StringRef CurrentFileName;
   FormalLinkage CurrentFuncLinkage;
+  std::string PGOFuncName;
   unsigned NumRegionCounters;
   uint64_t FunctionHash;
   llvm::DenseMap<ASTNode, unsigned> RegionCounterMap;
 
+  /// The execution count of each counter in the profile passed to
+  /// -profile-use, or empty if the profile has no data for this function.
+  std::vector<uint64_t> RegionCounts;
+
   std::vector<std::tuple<std::string, uint64_t, std::string>> CoverageData;
 
 public:
@@ -52,13 +57,17 @@ public:
 
   bool hasRegionCounters() const { return NumRegionCounters != 0; }
 
-  /// Emit SIL to increment the counter for \c Node.
+  /// Emit SIL to increment the counter for \c Node, and record the profiled
+  /// count of \c Node on the current block.
   void emitCounterIncrement(SILGenBuilder &Builder, ASTNode Node);
 
 private:
   /// Map counters to ASTNodes and set them up for profiling the given function.
   void assignRegionCounters(Decl *Root);
 
+  /// Look up the current function's counts in the profile.
+  void loadRegionCounts();
+
   friend struct ProfilerRAII;
 };
 
@@ -1146,6 +1146,19 @@ bool EscapeAnalysis::buildConnectionGraphForCallees(
 bool EscapeAnalysis::buildConnectionGraphForDestructor(
     SILValue V, SILInstruction *I, FunctionInfo *FInfo,
     FunctionOrder &BottomUpOrder, int RecursionDepth) {
+  // The destructor of a closure context releases the captured values. If their
+  // destructors are known, the context does not capture more than they do.
+  if (auto *PAI = dyn_cast<PartialApplyInst>(V)) {
+    for (const Operand &Op : PAI->getArgumentOperands()) {
+      if (!isPointer(Op.get()))
+        continue;
+      if (!buildConnectionGraphForDestructor(Op.get(), I, FInfo, BottomUpOrder,
+                                             RecursionDepth))
+        return false;
+    }
+    return true;
+  }
+
   // It should be a locally allocated object.
   if (!pointsToLocalObject(V))
     return false;
@@ -0,0 +1,39 @@
+//===--- LSLocationAnalysis.cpp - Memory locations of a function ----------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/SILOptimizer/Analysis/LSLocationAnalysis.h"
+#include "swift/SILOptimizer/Analysis/TypeExpansionAnalysis.h"
+#include "swift/SILOptimizer/PassManager/PassManager.h"
+
+using namespace swift;
+
+LSLocationFunctionInfo::LSLocationFunctionInfo(SILFunction *F,
+                                               TypeExpansionAnalysis *TE) {
+  // Walk over the function and find all the locations accessed by
+  // this function.
+  std::pair<int, int> LSCount = std::make_pair(0, 0);
+  LSLocation::enumerateLSLocations(*F, LocationVault, LocToBitIndex,
+                                   BaseToLocIndex, TE, LSCount);
+  LoadCount = LSCount.first;
+  StoreCount = LSCount.second;
+
+  for (unsigned i = 0, e = LocationVault.size(); i < e; ++i)
+    BaseToBits[LocationVault[i].getBase()].push_back(i);
+}
+
+void LSLocationAnalysis::initialize(SILPassManager *PM) {
+  TE = PM->getAnalysis<TypeExpansionAnalysis>();
+}
+
+SILAnalysis *swift::createLSLocationAnalysis(SILModule *M) {
+  return new LSLocationAnalysis(M);
+}
@@ -13,9 +13,11 @@
 #define DEBUG_TYPE "sil-sea"
 #include "swift/SILOptimizer/Analysis/SideEffectAnalysis.h"
 #include "swift/SILOptimizer/Analysis/BasicCalleeAnalysis.h"
+#include "swift/SILOptimizer/Analysis/ClassHierarchyAnalysis.h"
 #include "swift/SILOptimizer/Analysis/FunctionOrder.h"
 #include "swift/SILOptimizer/PassManager/PassManager.h"
 #include "swift/SIL/SILArgument.h"
+#include "swift/SIL/SILModule.h"
 
 using namespace swift;
 
@@ -81,8 +83,12 @@ bool FunctionEffects::mergeFromApply(
     // Map the callee argument effects to parameters of this function.
     // If there are more callee parameters than arguments it means that the
     // callee is the result of a partial_apply.
-    Effects *E = (Idx < numCallerArgs ? getEffectsOn(FAS ? FAS.getArgument(Idx) : AS->getOperand(Idx)) :
-                  &GlobalEffects);
+    // If AS is a release, the callee is a destructor and its self parameter
+    // is the released value.
+    Effects *E = &GlobalEffects;
+    if (Idx < numCallerArgs)
+      E = FAS ? getEffectsOn(FAS.getArgument(Idx)) :
+                getEffectsOnReleased(AS->getOperand(Idx));
     Changed |= E->mergeFrom(ApplyEffects.ParamEffects[Idx]);
   }
   return Changed;
@@ -153,6 +159,19 @@ Effects *FunctionEffects::getEffectsOn(SILValue Addr) {
   return &GlobalEffects;
 }
 
+Effects *FunctionEffects::getEffectsOnReleased(SILValue V) {
+  if (auto *LI = dyn_cast<LoadInst>(skipValueProjections(V))) {
+    SILValue Base = skipValueProjections(skipAddrProjections(LI->getOperand()));
+    // Only for references: effects on an address parameter are about the
+    // memory it points to and not about the objects which are reachable from
+    // that memory.
+    if (auto *Arg = dyn_cast<SILArgument>(Base))
+      if (Arg->isFunctionArg() && Arg->getType().isObject())
+        return &ParamEffects[Arg->getIndex()];
+  }
+  return getEffectsOn(V);
+}
+
 bool SideEffectAnalysis::getDefinedEffects(FunctionEffects &Effects,
                                            SILFunction *F) {
   if (F->hasSemanticsAttr("arc.programtermination_point")) {
@@ -247,6 +266,121 @@ bool SideEffectAnalysis::getSemanticEffects(FunctionEffects &FE,
   }
 }
 
+/// Returns true if all subclasses of \p CD are known, i.e. are defined in the
+/// module. This is the same condition under which the devirtualizer treats a
+/// class without known subclasses as final.
+static bool areAllSubclassesKnown(ClassDecl *CD, SILModule &M) {
+  if (CD->isFinal())
+    return true;
+
+  const DeclContext *DC = M.getAssociatedContext();
+  if (!DC || !CD->isChildContextOf(DC) || !CD->hasAccessibility())
+    return false;
+
+  switch (CD->getEffectiveAccess()) {
+  case Accessibility::Open:
+    return false;
+  case Accessibility::Public:
+  case Accessibility::Internal:
+    return M.isWholeModule();
+  case Accessibility::FilePrivate:
+  case Accessibility::Private:
+    return true;
+  }
+  llvm_unreachable("Unhandled Accessibility in switch.");
+}
+
+bool SideEffectAnalysis::getDeallocators(
+    SILType Ty, SILModule &M,
+    llvm::SmallSetVector<SILFunction *, 4> &Deallocators, int Depth) {
+  if (Ty.isTrivial(M))
+    return true;
+  if (Depth > MaxRecursionDepth)
+    return false;
+
+  if (SILType PayloadTy = Ty.getAnyOptionalObjectType())
+    return getDeallocators(PayloadTy, M, Deallocators, Depth + 1);
+
+  if (ClassDecl *CD = Ty.getClassOrBoundGenericClass()) {
+    // Objective-C objects are released by the Objective-C runtime.
+    if (CD->checkObjCAncestry() != ObjCClassKind::NonObjC)
+      return false;
+    if (!areAllSubclassesKnown(CD, M))
+      return false;
+
+    llvm::SmallVector<ClassDecl *, 8> Classes;
+    Classes.push_back(CD);
+    if (!CD->isFinal()) {
+      auto &Subclasses = CHA->getIndirectSubClasses(CD);
+      Classes.append(Subclasses.begin(), Subclasses.end());
+    }
+    for (ClassDecl *C : Classes) {
+      if (!C->hasDestructor())
+        return false;
+      SILDeclRef DeallocRef(C->getDestructor(), SILDeclRef::Kind::Deallocator);
+      SILFunction *Dealloc = M.lookUpFunction(DeallocRef);
+      if (!Dealloc || !Dealloc->isDefinition())
+        return false;
+      Deallocators.insert(Dealloc);
+    }
+    return true;
+  }
+
+  if (StructDecl *SD = Ty.getStructOrBoundGenericStruct()) {
+    for (VarDecl *Field : SD->getStoredProperties())
+      if (!getDeallocators(Ty.getFieldType(Field, M), M, Deallocators,
+                           Depth + 1))
+        return false;
+    return true;
+  }
+
+  if (auto TT = Ty.getAs<TupleType>()) {
+    for (unsigned Idx : indices(TT->getElements()))
+      if (!getDeallocators(Ty.getTupleElementType(Idx), M, Deallocators,
+                           Depth + 1))
+        return false;
+    return true;
+  }
+
+  if (EnumDecl *ED = Ty.getEnumOrBoundGenericEnum()) {
+    // The payload of an indirect case is boxed.
+    if (ED->isIndirect())
+      return false;
+    for (EnumElementDecl *Elt : ED->getAllElements()) {
+      if (!Elt->hasArgumentType())
+        continue;
+      if (Elt->isIndirect() ||
+          !getDeallocators(Ty.getEnumElementType(Elt, M), M, Deallocators,
+                           Depth + 1))
+        return false;
+    }
+    return true;
+  }
+
+  // Existentials, closures, boxes, etc.
+  return false;
+}
+
+bool SideEffectAnalysis::analyzeDeallocators(FunctionInfo *FInfo,
+                                             SILInstruction *I,
+                                             FunctionOrder &BottomUpOrder,
+                                             int RecursionDepth) {
+  llvm::SmallSetVector<SILFunction *, 4> Deallocators;
+  if (!getDeallocators(I->getOperand(0)->getType(), I->getModule(),
+                       Deallocators, 0))
+    return false;
+
+  for (SILFunction *Dealloc : Deallocators) {
+    FunctionInfo *DeallocInfo = getFunctionInfo(Dealloc);
+    DeallocInfo->addCaller(FInfo, I);
+    if (!DeallocInfo->isVisited()) {
+      analyzeFunction(DeallocInfo, BottomUpOrder, RecursionDepth + 1);
+      BottomUpOrder.tryToSchedule(DeallocInfo);
+    }
+  }
+  return true;
+}
+
 void SideEffectAnalysis::analyzeFunction(FunctionInfo *FInfo,
                                          FunctionOrder &BottomUpOrder,
                                          int RecursionDepth) {
@@ -343,6 +477,15 @@ void SideEffectAnalysis::analyzeInstruction(FunctionInfo *FInfo,
       return;
     case ValueKind::StrongReleaseInst:
     case ValueKind::ReleaseValueInst:
+      FInfo->FE.getEffectsOnReleased(I->getOperand(0))->Releases = true;
+
+      // The release may call a destructor. If we know all the destructors,
+      // their effects are merged in like the effects of called functions.
+      if (RecursionDepth < MaxRecursionDepth &&
+          analyzeDeallocators(FInfo, I, BottomUpOrder, RecursionDepth))
+        return;
+      FInfo->FE.setWorstEffects();
+      return;
     case ValueKind::UnownedReleaseInst:
       FInfo->FE.getEffectsOn(I->getOperand(0))->Releases = true;
       
@@ -350,6 +493,11 @@ void SideEffectAnalysis::analyzeInstruction(FunctionInfo *FInfo,
       // destructors might be called.
       FInfo->FE.setWorstEffects();
       return;
+    case ValueKind::DeallocRefInst:
+    case ValueKind::DeallocPartialRefInst:
+      // Freeing an object only affects the object itself.
+      FInfo->FE.getEffectsOn(I->getOperand(0))->Writes = true;
+      return;
     case ValueKind::LoadInst:
       FInfo->FE.getEffectsOn(cast<LoadInst>(I)->getOperand())->Reads = true;
       return;
@@ -428,6 +576,7 @@ void SideEffectAnalysis::analyzeInstruction(FunctionInfo *FInfo,
 
 void SideEffectAnalysis::initialize(SILPassManager *PM) {
   BCA = PM->getAnalysis<BasicCalleeAnalysis>();
+  CHA = PM->getAnalysis<ClassHierarchyAnalysis>();
 }
 
 void SideEffectAnalysis::recompute(FunctionInfo *Initial) {
@@ -459,7 +608,10 @@ void SideEffectAnalysis::recompute(FunctionInfo *Initial) {
 
         // Propagate the side-effects to all callers.
         for (const auto &E : FInfo->getCallers()) {
-          assert(E.isValid());
+          // Skip stale entries, which may exist for a function which was
+          // invalidated without its callers.
+          if (!E.isValid())
+            continue;
 
           // Only include callers which we are actually recomputing.
           if (BottomUpOrder.wasRecomputedWithCurrentUpdateID(E.Caller)) {
@@ -516,15 +668,58 @@ void SideEffectAnalysis::getEffects(FunctionEffects &ApplyEffects, FullApplySite
   }
 }
 
+void SideEffectAnalysis::updateDirtyFunctions() {
+  while (!DirtyFunctions.empty()) {
+    FunctionInfo *FInfo = DirtyFunctions.pop_back_val();
+    if (!FInfo->IsDirty)
+      continue;
+    FInfo->IsDirty = false;
+
+    // The function may already be recomputed as a callee of another dirty
+    // function.
+    if (!FInfo->isValid())
+      recompute(FInfo);
+
+    if (FInfo->FE.isSameAs(FInfo->PrevFE)) {
+      DEBUG(llvm::dbgs() << "  unchanged " << FInfo->F->getName() << '\n');
+      continue;
+    }
+    DEBUG(llvm::dbgs() << "  changed " << FInfo->F->getName() <<
+          ", invalidate callers\n");
+    invalidateAllCallers(FInfo);
+  }
+}
+
 void SideEffectAnalysis::invalidate(InvalidationKind K) {
   Function2Info.clear();
+  DirtyFunctions.clear();
   Allocator.DestroyAll();
   DEBUG(llvm::dbgs() << "invalidate all\n");
 }
 
 void SideEffectAnalysis::invalidate(SILFunction *F, InvalidationKind K) {
+  FunctionInfo *FInfo = Function2Info.lookup(F);
+  if (!FInfo || FInfo->IsDirty)
+    return;
+
+  DEBUG(llvm::dbgs() << "  invalidate " << FInfo->F->getName() << '\n');
+  if (!FInfo->isValid()) {
+    invalidateIncludingAllCallers(FInfo);
+    return;
+  }
+  // Defer the invalidation of the callers until we know if the side-effects
+  // of the function really changed. Most transformations don't change them.
+  FInfo->PrevFE = FInfo->FE;
+  invalidateKeepingCallers(FInfo);
+  FInfo->IsDirty = true;
+  DirtyFunctions.push_back(FInfo);
+}
+
+void SideEffectAnalysis::invalidateForDeadFunction(SILFunction *F,
+                                                   InvalidationKind K) {
   if (FunctionInfo *FInfo = Function2Info.lookup(F)) {
-    DEBUG(llvm::dbgs() << "  invalidate " << FInfo->F->getName() << '\n');
+    DEBUG(llvm::dbgs() << "  invalidate dead " << FInfo->F->getName() << '\n');
+    FInfo->IsDirty = false;
     invalidateIncludingAllCallers(FInfo);
   }
 }
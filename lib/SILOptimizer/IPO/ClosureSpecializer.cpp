@@ -63,6 +63,7 @@
 #include "swift/SIL/SILModule.h"
 #include "swift/SILOptimizer/Analysis/BasicCalleeAnalysis.h"
 #include "swift/SILOptimizer/Analysis/CFG.h"
+#include "swift/SILOptimizer/Analysis/DominanceAnalysis.h"
 #include "swift/SILOptimizer/Analysis/FunctionOrder.h"
 #include "swift/SILOptimizer/Analysis/ValueTracking.h"
 #include "swift/SILOptimizer/PassManager/Transforms.h"
@@ -296,8 +297,10 @@ static void rewriteApplyInst(const CallSiteDescriptor &CSDesc,
     if (ArgTy.isTrivial(M))
       continue;
 
-    // TODO: When we support address types, this code path will need to be
-    // updated.
+    // Captured addresses are not owned by the closure, so there is nothing to
+    // balance.
+    if (ArgTy.isAddress())
+      continue;
 
     // We need to balance the consumed argument of the new partial_apply in the
     // specialized callee by a retain. If both the original partial_apply and
@@ -441,10 +444,16 @@ static bool isSupportedClosure(const SILInstruction *Closure) {
     if (PAI->hasSubstitutions())
       return false;
 
-    // If any arguments are not objects, return false. This is a temporary
-    // limitation.
-    for (SILValue Arg : PAI->getArguments())
-      if (!Arg->getType().isObject())
+    // If any arguments are addresses that the closure does not merely borrow
+    // (i.e. anything other than an @inout_aliasable capture of a local
+    // variable), return false. This is a temporary limitation.
+    auto CalleeTy = PAI->getCallee()->getType().castTo<SILFunctionType>();
+    auto CapturedParams = CalleeTy->getParameters().slice(
+        CalleeTy->getParameters().size() - PAI->getNumArguments());
+    for (unsigned i = 0, e = PAI->getNumArguments(); i != e; ++i)
+      if (!PAI->getArgument(i)->getType().isObject() &&
+          CapturedParams[i].getConvention() !=
+              ParameterConvention::Indirect_InoutAliasable)
         return false;
 
     // Ok, it is a closure we support, set Callee.
@@ -507,13 +516,19 @@ ClosureSpecCloner::initCloned(const CallSiteDescriptor &CallSiteDesc,
 
   // Captured parameters are always appended to the function signature. If the
   // type of the captured argument is trivial, pass the argument as
-  // Direct_Unowned. Otherwise pass it as Direct_Owned.
+  // Direct_Unowned. Otherwise pass it as Direct_Owned. Captured addresses keep
+  // their @inout_aliasable convention.
   //
   // We use the type of the closure here since we allow for the closure to be an
   // external declaration.
   unsigned NumTotalParams = ClosedOverFunTy->getParameters().size();
   unsigned NumNotCaptured = NumTotalParams - CallSiteDesc.getNumArguments();
   for (auto &PInfo : ClosedOverFunTy->getParameters().slice(NumNotCaptured)) {
+    if (PInfo.isIndirectMutating()) {
+      NewParameterInfoList.push_back(PInfo);
+      continue;
+    }
+
     if (PInfo.getSILType().isTrivial(M)) {
       SILParameterInfo NewPInfo(PInfo.getType(),
                                 ParameterConvention::Direct_Unowned);
@@ -675,8 +690,11 @@ class ClosureSpecializer {
   std::vector<SILInstruction *> PropagatedClosures;
   bool IsPropagatedClosuresUniqued = false;
 
+  /// The caller's dominator tree if it has profile data, otherwise null.
+  DominanceInfo *DT;
+
 public:
-  ClosureSpecializer() = default;
+  explicit ClosureSpecializer(DominanceInfo *DT) : DT(DT) {}
 
   void gatherCallSites(SILFunction *Caller,
                        llvm::SmallVectorImpl<ClosureInfo*> &ClosureCandidates,
@@ -705,6 +723,18 @@ void ClosureSpecializer::gatherCallSites(
   // make sure that we do not handle call sites with multiple closure arguments.
   llvm::DenseSet<FullApplySite> VisitedAI;
 
+  // Blocks that never ran in the profile. Calls in them are not worth
+  // specializing. Find them up front, since computing closure lifetimes below
+  // can split edges.
+  llvm::SmallPtrSet<SILBasicBlock *, 8> ColdBlocks;
+  if (DT) {
+    for (auto &BB : *Caller) {
+      auto Count = getProfileCount(&BB, DT);
+      if (Count && *Count == 0)
+        ColdBlocks.insert(&BB);
+    }
+  }
+
   // For each basic block BB in Caller...
   for (auto &BB : *Caller) {
 
@@ -725,6 +755,9 @@ void ClosureSpecializer::gatherCallSites(
         if (!AI || AI.hasSubstitutions())
           continue;
 
+        if (ColdBlocks.count(AI.getParent()))
+          continue;
+
         // Check if we have already associated this apply inst with a closure to
         // be specialized. We do not handle applies that take in multiple
         // closures at this time.
@@ -879,7 +912,11 @@ public:
     if (F->isExternalDeclaration())
       return;
 
-    ClosureSpecializer C;
+    DominanceInfo *DT = nullptr;
+    if (F->getEntryCount())
+      DT = getAnalysis<DominanceAnalysis>()->get(F);
+
+    ClosureSpecializer C(DT);
     if (!C.specialize(F, this))
       return;
 
@@ -0,0 +1,293 @@
+//===--- CrossModuleSerializationSetup.cpp - Serialize public bodies ------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Clients of a module can only inline and specialize the functions whose SIL
+// is serialized into the module, which without this pass are the fragile
+// ones. In particular generic library code which is not @_inlineable always
+// runs unspecialized in clients, through value witnesses.
+//
+// With -enable-cross-module-optimization, this pass marks the public generic
+// functions and the small public functions of a whole-module build fragile,
+// so that their optimized bodies are serialized. The SIL linker of a client
+// then deserializes them like any other fragile function, and the inliner and
+// the generic specializer can use them.
+//
+// A function is only made fragile if a client can compile everything its body
+// references. The internal functions it calls are made fragile as well and
+// get public linkage, so that the calls which the client doesn't inline can
+// still be linked. Functions referencing private functions, non-public types,
+// declarations, globals or conformances are left alone.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "cross-module-serialization-setup"
+#include "swift/SILOptimizer/PassManager/Passes.h"
+#include "swift/AST/GenericSignature.h"
+#include "swift/AST/ProtocolConformance.h"
+#include "swift/SIL/SILModule.h"
+#include "swift/SILOptimizer/PassManager/Transforms.h"
+#include "swift/SILOptimizer/Utils/SILInliner.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/Debug.h"
+
+using namespace swift;
+
+STATISTIC(NumFunctionsSerialized,
+          "Number of functions serialized for cross-module optimization");
+STATISTIC(NumFunctionsMadePublic,
+          "Number of internal functions made public to be serialized");
+
+/// Returns true if clients of the module can refer to \p D.
+static bool isPublicDecl(const ValueDecl *D) {
+  return D->hasAccessibility() &&
+         D->getEffectiveAccess() >= Accessibility::Public;
+}
+
+/// Returns true if \p Ty only contains types which clients can refer to.
+static bool isPublicType(Type Ty) {
+  return !Ty.findIf([](Type T) -> bool {
+    if (auto *NTD = T->getAnyNominal())
+      return !isPublicDecl(NTD);
+    return false;
+  });
+}
+
+static bool isPublicConformance(ProtocolConformanceRef C) {
+  if (C.isAbstract())
+    return isPublicDecl(C.getAbstract());
+  return isPublicDecl(C.getConcrete()->getProtocol()) &&
+         isPublicType(C.getConcrete()->getType());
+}
+
+static bool isPublicSubstitution(const Substitution &Sub) {
+  if (!isPublicType(Sub.getReplacement()))
+    return false;
+  for (auto C : Sub.getConformances())
+    if (!isPublicConformance(C))
+      return false;
+  return true;
+}
+
+/// Returns true if \p F can be referenced from a serialized body as it is.
+static bool isReferenceable(SILFunction *F) {
+  return F->hasValidLinkageForFragileRef();
+}
+
+namespace {
+
+class CrossModuleSerializationSetup : public SILModuleTransform {
+  /// Non-generic public functions up to this cost are serialized.
+  enum { MaxSmallFunctionCost = 32 };
+
+  /// The functions which can be serialized, provided that the functions they
+  /// reference can be serialized too.
+  llvm::SmallPtrSet<SILFunction *, 32> Serializable;
+
+  bool canSerializeInstruction(SILInstruction &I,
+                               SmallVectorImpl<SILFunction *> &Callees);
+  bool canSerializeLocally(SILFunction *F,
+                           SmallVectorImpl<SILFunction *> &Callees);
+  void computeSerializable();
+  bool isSmall(SILFunction *F);
+  void serialize(SILFunction *F);
+
+  void run() override {
+    SILModule *M = getModule();
+    if (!M->isWholeModule())
+      return;
+
+    DEBUG(llvm::dbgs() << "** CrossModuleSerializationSetup **\n");
+
+    computeSerializable();
+    for (auto &F : *M) {
+      if (F.getLinkage() != SILLinkage::Public || !Serializable.count(&F))
+        continue;
+      if (F.getLoweredFunctionType()->isPolymorphic() || isSmall(&F))
+        serialize(&F);
+    }
+    Serializable.clear();
+  }
+
+  StringRef getName() override { return "Cross Module Serialization Setup"; }
+};
+
+} // end anonymous namespace
+
+/// Checks the references of \p I, and collects the functions it references
+/// which have to be serialized as well.
+bool CrossModuleSerializationSetup::canSerializeInstruction(
+    SILInstruction &I, SmallVectorImpl<SILFunction *> &Callees) {
+  if (I.hasValue() && !isPublicType(I.getType().getSwiftRValueType()))
+    return false;
+  for (auto &Op : I.getAllOperands())
+    if (!isPublicType(Op.get()->getType().getSwiftRValueType()))
+      return false;
+
+  if (ApplySite AI = ApplySite::isa(&I)) {
+    for (auto &Sub : AI.getSubstitutions())
+      if (!isPublicSubstitution(Sub))
+        return false;
+  }
+
+  if (auto *FRI = dyn_cast<FunctionRefInst>(&I)) {
+    SILFunction *Callee = FRI->getReferencedFunction();
+    if (!isReferenceable(Callee))
+      Callees.push_back(Callee);
+    return true;
+  }
+  if (auto *GAI = dyn_cast<GlobalAddrInst>(&I)) {
+    SILGlobalVariable *G = GAI->getReferencedGlobal();
+    return G->isFragile() || hasPublicVisibility(G->getLinkage());
+  }
+  if (auto *AGI = dyn_cast<AllocGlobalInst>(&I)) {
+    SILGlobalVariable *G = AGI->getReferencedGlobal();
+    return G->isFragile() || hasPublicVisibility(G->getLinkage());
+  }
+  if (auto *MI = dyn_cast<MethodInst>(&I)) {
+    if (!isPublicDecl(MI->getMember().getDecl()))
+      return false;
+    if (auto *WMI = dyn_cast<WitnessMethodInst>(&I))
+      return isPublicConformance(WMI->getConformance());
+    return true;
+  }
+  if (auto *SEI = dyn_cast<StructExtractInst>(&I))
+    return isPublicDecl(SEI->getField());
+  if (auto *SEAI = dyn_cast<StructElementAddrInst>(&I))
+    return isPublicDecl(SEAI->getField());
+  if (auto *REAI = dyn_cast<RefElementAddrInst>(&I))
+    return isPublicDecl(REAI->getField());
+
+  ArrayRef<ProtocolConformanceRef> Conformances;
+  if (auto *IEA = dyn_cast<InitExistentialAddrInst>(&I))
+    Conformances = IEA->getConformances();
+  else if (auto *IER = dyn_cast<InitExistentialRefInst>(&I))
+    Conformances = IER->getConformances();
+  else if (auto *IEM = dyn_cast<InitExistentialMetatypeInst>(&I))
+    Conformances = IEM->getConformances();
+  else if (auto *AEB = dyn_cast<AllocExistentialBoxInst>(&I))
+    Conformances = AEB->getConformances();
+  for (auto C : Conformances)
+    if (!isPublicConformance(C))
+      return false;
+  return true;
+}
+
+/// Checks everything \p F references except for the functions it calls,
+/// which are collected in \p Callees.
+bool CrossModuleSerializationSetup::canSerializeLocally(
+    SILFunction *F, SmallVectorImpl<SILFunction *> &Callees) {
+  // Private functions are mangled with the discriminator of their file, and
+  // the bodies of external functions are not ours to serialize.
+  switch (F->getLinkage()) {
+  case SILLinkage::Public:
+  case SILLinkage::Hidden:
+  case SILLinkage::Shared:
+    break;
+  default:
+    return false;
+  }
+  if (!F->isDefinition() || F->hasSemanticsAttr("stdlib_binary_only"))
+    return false;
+
+  auto FnTy = F->getLoweredFunctionType();
+  if (!isPublicType(FnTy))
+    return false;
+  if (auto Sig = FnTy->getGenericSignature()) {
+    for (auto &Req : Sig->getRequirements())
+      if (Req.getSecondType() && !isPublicType(Req.getSecondType()))
+        return false;
+  }
+
+  for (auto &BB : *F)
+    for (auto &I : BB)
+      if (!canSerializeInstruction(I, Callees))
+        return false;
+  return true;
+}
+
+/// Computes the set of serializable functions: the functions which pass the
+/// local checks, minus the ones which call a function which doesn't, until
+/// nothing changes. This handles recursion without assuming anything about
+/// the functions in a cycle.
+void CrossModuleSerializationSetup::computeSerializable() {
+  llvm::DenseMap<SILFunction *, SmallVector<SILFunction *, 4>> CalleesOf;
+  for (auto &F : *getModule()) {
+    if (F.isFragile())
+      continue;
+    SmallVector<SILFunction *, 4> Callees;
+    if (!canSerializeLocally(&F, Callees))
+      continue;
+    Serializable.insert(&F);
+    CalleesOf[&F] = std::move(Callees);
+  }
+
+  bool Changed = true;
+  while (Changed) {
+    Changed = false;
+    for (auto &Entry : CalleesOf) {
+      if (!Serializable.count(Entry.first))
+        continue;
+      for (SILFunction *Callee : Entry.second) {
+        if (!Serializable.count(Callee)) {
+          Serializable.erase(Entry.first);
+          Changed = true;
+          break;
+        }
+      }
+    }
+  }
+}
+
+bool CrossModuleSerializationSetup::isSmall(SILFunction *F) {
+  int Cost = 0;
+  for (auto &BB : *F) {
+    for (auto &I : BB) {
+      Cost += (int)instructionInlineCost(I);
+      if (Cost > MaxSmallFunctionCost)
+        return false;
+    }
+  }
+  return true;
+}
+
+/// Makes \p F and the functions it calls fragile.
+void CrossModuleSerializationSetup::serialize(SILFunction *F) {
+  SmallVector<SILFunction *, 8> Worklist;
+  Worklist.push_back(F);
+  while (!Worklist.empty()) {
+    SILFunction *Fn = Worklist.pop_back_val();
+    if (Fn->isFragile())
+      continue;
+    assert(Serializable.count(Fn) && "serializing an unserializable function");
+
+    // A client may call the function instead of inlining it.
+    if (Fn->getLinkage() == SILLinkage::Hidden) {
+      Fn->setLinkage(SILLinkage::Public);
+      ++NumFunctionsMadePublic;
+    }
+    Fn->setFragile(IsFragile);
+    ++NumFunctionsSerialized;
+    DEBUG(llvm::dbgs() << "  Serialized: " << Fn->getName() << '\n');
+
+    for (auto &BB : *Fn)
+      for (auto &I : BB)
+        if (auto *FRI = dyn_cast<FunctionRefInst>(&I))
+          if (!isReferenceable(FRI->getReferencedFunction()))
+            Worklist.push_back(FRI->getReferencedFunction());
+  }
+}
+
+SILTransform *swift::createCrossModuleSerializationSetup() {
+  return new CrossModuleSerializationSetup();
+}
@@ -12,9 +12,11 @@
 
 #define DEBUG_TYPE "globalopt"
 #include "swift/Basic/DemangleWrappers.h"
+#include "swift/Basic/Range.h"
 #include "swift/SIL/CFG.h"
 #include "swift/SIL/DebugUtils.h"
 #include "swift/SIL/SILInstruction.h"
+#include "swift/SILOptimizer/Analysis/ArraySemantic.h"
 #include "swift/SILOptimizer/Analysis/ColdBlockInfo.h"
 #include "swift/SILOptimizer/Analysis/DominanceAnalysis.h"
 #include "swift/SILOptimizer/PassManager/Passes.h"
@@ -22,11 +24,16 @@
 #include "swift/SILOptimizer/Utils/Local.h"
 #include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/SCCIterator.h"
+#include "llvm/ADT/SmallBitVector.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "swift/AST/Mangle.h"
 using namespace swift;
 
+static llvm::cl::opt<unsigned> ArrayLiteralOutlineMinCount(
+    "sil-outline-array-literal-min-count", llvm::cl::init(16),
+    llvm::cl::Hidden);
+
 namespace {
 /// Optimize the placement of global initializers.
 ///
@@ -95,8 +102,14 @@ protected:
   // calls.
   void collectOnceCall(BuiltinInst *AI);
   // Set the static initializer and remove "once" from addressor if a global can
-  // be statically initialized.
-  void optimizeInitializer(SILFunction *AddrF, GlobalInitCalls &Calls);
+  // be statically initialized. Returns true if it was.
+  bool optimizeInitializer(SILFunction *AddrF, GlobalInitCalls &Calls);
+  // Initialize the array literals of constant elements in F only once.
+  void outlineConstantArrayLiterals(SILFunction *F);
+  // Replace reads of statically initialized globals in a global initializer by
+  // their values.
+  bool propagateStaticGlobalValues(SILFunction *InitF);
+  void eraseWithDeadAddressComputation(SILInstruction *I);
   void optimizeGlobalAccess(SILGlobalVariable *SILG, StoreInst *SI);
   // Replace loads from a global variable by the known value.
   void replaceLoadsByKnownValue(BuiltinInst *CallToOnce,
@@ -669,13 +682,192 @@ replaceLoadsByKnownValue(BuiltinInst *CallToOnce, SILFunction *AddrF,
   SILG->setInitializer(InitF);
 }
 
+/// Clone the computation of the constant value \p V in front of \p InsertPt.
+/// Returns the clone, or a null value if \p V is not a simple constant.
+static SILValue cloneConstantValue(SILValue V, SILInstruction *InsertPt) {
+  SmallVector<SILInstruction *, 8> ReverseInsns;
+  if (!analyzeStaticInitializer(V, ReverseInsns))
+    return SILValue();
+
+  SmallVector<SILInstruction *, 8> Insns(ReverseInsns.rbegin(),
+                                         ReverseInsns.rend());
+  SILFunction *F = InsertPt->getFunction();
+  SILBasicBlock *TmpBB = F->createBasicBlock();
+  InstructionsCloner Cloner(*F, Insns, TmpBB);
+  Cloner.clone();
+  SILValue Clone = Cloner.AvailVals.back().second;
+  while (!TmpBB->empty())
+    TmpBB->begin()->moveBefore(InsertPt);
+  TmpBB->eraseFromParent();
+  return Clone;
+}
+
+/// If \p Addr is the address of a statically initialized "let" global, either
+/// directly or through a call of its addressor, return the value the global is
+/// initialized with.
+static SILInstruction *getStaticValueOfGlobalAddr(SILValue Addr) {
+  auto *GAI = dyn_cast<GlobalAddrInst>(Addr);
+  if (auto *PTAI = dyn_cast<PointerToAddressInst>(Addr)) {
+    auto *AI = dyn_cast<ApplyInst>(PTAI->getOperand());
+    SILFunction *AddrF = AI ? AI->getReferencedFunction() : nullptr;
+    if (!AddrF || !AddrF->isGlobalInit() || AddrF->size() != 1)
+      return nullptr;
+    auto *RI = dyn_cast<ReturnInst>(AddrF->front().getTerminator());
+    auto *ATPI = RI ? dyn_cast<AddressToPointerInst>(RI->getOperand())
+                    : nullptr;
+    GAI = ATPI ? dyn_cast<GlobalAddrInst>(ATPI->getOperand()) : nullptr;
+  }
+  if (!GAI)
+    return nullptr;
+
+  // The initializer of the global is only set once its "once" call has been
+  // removed, i.e. once it is known to be initialized statically.
+  SILGlobalVariable *SILG = GAI->getReferencedGlobal();
+  if (!SILG->isLet())
+    return nullptr;
+  return SILG->getValueOfStaticInitializer();
+}
+
+/// If \p AI calls a getter that was generated for a statically initialized
+/// global, return the value the getter returns.
+static SILValue getStaticValueOfGetterCall(ApplyInst *AI) {
+  SILFunction *GetterF = AI->getReferencedFunction();
+  if (!GetterF || AI->getNumArguments() != 0 || GetterF->size() != 1)
+    return SILValue();
+
+  auto *RI = dyn_cast<ReturnInst>(GetterF->front().getTerminator());
+  SmallVector<SILInstruction *, 8> Insns;
+  if (!RI || !analyzeStaticInitializer(RI->getOperand(), Insns))
+    return SILValue();
+
+  // The getter must not do anything but compute its result.
+  llvm::SmallPtrSet<SILInstruction *, 8> ValueInsns(Insns.begin(),
+                                                    Insns.end());
+  for (auto &I : GetterF->front())
+    if (&I != RI && !isa<DebugValueInst>(&I) && !ValueInsns.count(&I))
+      return SILValue();
+  return RI->getOperand();
+}
+
+/// Erase \p I, and the address or call it is computed from once that becomes
+/// dead as well.
+void SILGlobalOpt::eraseWithDeadAddressComputation(SILInstruction *I) {
+  while (I && I->use_empty()) {
+    auto *Op = I->getNumOperands() == 1 ?
+      dyn_cast<SILInstruction>(I->getOperand(0)) : nullptr;
+    if (auto *AI = dyn_cast<ApplyInst>(I)) {
+      Op = dyn_cast<SILInstruction>(AI->getCallee());
+      // Don't leave a dangling call behind in the list of the addressor.
+      auto Iter = GlobalInitCallMap.find(AI->getReferencedFunction());
+      if (Iter != GlobalInitCallMap.end()) {
+        auto &Calls = Iter->second;
+        Calls.erase(std::remove(Calls.begin(), Calls.end(), AI), Calls.end());
+      }
+    }
+    I->eraseFromParent();
+    I = Op;
+  }
+}
+
+/// Replace the reads of statically initialized "let" globals in the
+/// single-block initializer \p InitF by the values the globals are initialized
+/// with. This lets globals that are computed from other constant globals be
+/// statically initialized as well, e.g.
+///
+///     let Size = Dimensions(width: 10, height: 20)
+///     let Width = Size.width
+///
+/// Returns true if \p InitF was changed.
+bool SILGlobalOpt::propagateStaticGlobalValues(SILFunction *InitF) {
+  if (InitF->size() != 1)
+    return false;
+
+  bool Changed = false;
+  SILBasicBlock *BB = &InitF->front();
+  for (auto II = BB->begin(), E = BB->end(); II != E;) {
+    SILInstruction *I = &*II++;
+
+    // A read of the global through a getter, as GlobalOpt generates them for
+    // globals with a declaration.
+    if (auto *AI = dyn_cast<ApplyInst>(I)) {
+      SILValue Val = getStaticValueOfGetterCall(AI);
+      if (!Val)
+        continue;
+      SILValue Clone = cloneConstantValue(Val, AI);
+      AI->replaceAllUsesWith(Clone);
+      eraseWithDeadAddressComputation(AI);
+      Changed = true;
+      continue;
+    }
+
+    // A load of (a projection of) the global.
+    auto *LI = dyn_cast<LoadInst>(I);
+    if (!LI)
+      continue;
+    SmallVector<SILInstruction *, 4> Projections;
+    SILValue Addr = LI->getOperand();
+    while (isa<StructElementAddrInst>(Addr) ||
+           isa<TupleElementAddrInst>(Addr)) {
+      Projections.push_back(cast<SILInstruction>(Addr));
+      Addr = Projections.back()->getOperand(0);
+    }
+    SILValue Val = getStaticValueOfGlobalAddr(Addr);
+    while (Val && !Projections.empty()) {
+      SILInstruction *Proj = Projections.pop_back_val();
+      if (auto *SEAI = dyn_cast<StructElementAddrInst>(Proj)) {
+        auto *SI = dyn_cast<StructInst>(Val);
+        Val = SI ? SI->getFieldValue(SEAI->getField()) : SILValue();
+      } else {
+        auto *TI = dyn_cast<TupleInst>(Val);
+        Val = TI ? TI->getElement(cast<TupleElementAddrInst>(Proj)
+                                      ->getFieldNo())
+                 : SILValue();
+      }
+    }
+    if (!Val)
+      continue;
+    SILValue Clone = cloneConstantValue(Val, LI);
+    if (!Clone)
+      continue;
+    LI->replaceAllUsesWith(Clone);
+    eraseWithDeadAddressComputation(LI);
+    Changed = true;
+  }
+  if (!Changed)
+    return false;
+
+  // Fold the extracts from the propagated values, and remove what is left of
+  // them.
+  bool Simplified;
+  do {
+    Simplified = false;
+    for (auto II = BB->begin(), E = BB->end(); II != E;) {
+      SILInstruction *I = &*II++;
+      if (!isa<StructExtractInst>(I) && !isa<TupleExtractInst>(I))
+        continue;
+      if (SILValue S = simplifyInstruction(I)) {
+        I->replaceAllUsesWith(S);
+        I->eraseFromParent();
+        Simplified = true;
+      }
+    }
+  } while (Simplified);
+
+  for (auto II = BB->begin(), E = BB->end(); II != E;) {
+    SILInstruction *I = &*II++;
+    if (isInstructionTriviallyDead(I))
+      I->eraseFromParent();
+  }
+  return true;
+}
+
 /// We analyze the body of globalinit_func to see if it can be statically
 /// initialized. If yes, we set the initial value of the SILGlobalVariable and
 /// remove the "once" call to globalinit_func from the addressor.
-void SILGlobalOpt::optimizeInitializer(SILFunction *AddrF,
+bool SILGlobalOpt::optimizeInitializer(SILFunction *AddrF,
                                        GlobalInitCalls &Calls) {
   if (UnhandledOnceCallee)
-    return;
+    return false;
 
   // Find the initializer and the SILGlobalVariable.
   BuiltinInst *CallToOnce;
@@ -686,12 +878,17 @@ void SILGlobalOpt::optimizeInitializer(SILFunction *AddrF,
   auto *InitF = findInitializer(Module, AddrF, CallToOnce);
   if (!InitF || !InitF->getName().startswith("globalinit_") ||
       InitializerCount[InitF] > 1)
-    return;
+    return false;
+
+  // Reads of other globals that have already been found to be statically
+  // initialized can be replaced by their values.
+  if (propagateStaticGlobalValues(InitF))
+    HasChanged = true;
 
   // If the globalinit_func is trivial, continue; otherwise bail.
   auto *SILG = SILGlobalVariable::getVariableOfStaticInitializer(InitF);
   if (!SILG || !SILG->isDefinition())
-    return;
+    return false;
 
   DEBUG(llvm::dbgs() << "GlobalOpt: use static initializer for " <<
         SILG->getName() << '\n');
@@ -702,11 +899,12 @@ void SILGlobalOpt::optimizeInitializer(SILFunction *AddrF,
     CallToOnce->eraseFromParent();
     SILG->setInitializer(InitF);
     HasChanged = true;
-    return;
+    return true;
   }
 
   replaceLoadsByKnownValue(CallToOnce, AddrF, InitF, SILG, Calls);
   HasChanged = true;
+  return true;
 }
 
 SILGlobalVariable *SILGlobalOpt::getVariableOfGlobalInit(SILFunction *AddrF) {
@@ -877,7 +1075,234 @@ void SILGlobalOpt::optimizeGlobalAccess(SILGlobalVariable *SILG,
 
 }
 
+/// Returns the value of \p V if it is an integer literal, or a struct like Int
+/// that wraps one.
+static Optional<uint64_t> getConstantCount(SILValue V) {
+  if (auto *SI = dyn_cast<StructInst>(V))
+    if (SI->getNumOperands() == 1)
+      V = SI->getOperand(0);
+  auto *IL = dyn_cast<IntegerLiteralInst>(V);
+  if (!IL || IL->getValue().getActiveBits() > 32)
+    return None;
+  return IL->getValue().getZExtValue();
+}
+
+/// Collect the instructions that allocate and initialize the array literal
+/// \p AI if all its elements are trivial constants, and return the array
+/// value. The initialization has the form:
+///
+///   %a = apply %allocate_uninitialized(%count)
+///   %array = tuple_extract %a, 0
+///   %buffer = tuple_extract %a, 1
+///   %ptr = struct_extract %buffer : $UnsafeMutablePointer<T>
+///   %addr = pointer_to_address %ptr
+///   store %c0 to %addr
+///   %addr1 = index_addr %addr, %one
+///   store %c1 to %addr1
+///   ...
+///
+/// \p ToErase is filled with the instructions that are dead once the array
+/// value is computed differently.
+static TupleExtractInst *
+collectConstantArrayLiteral(ApplyInst *AI,
+                            SmallVectorImpl<SILInstruction *> &Insns,
+                            SmallVectorImpl<SILInstruction *> &ToErase) {
+  ArraySemanticsCall Uninitialized(AI, "array.uninitialized");
+  if (!Uninitialized || AI->hasSubstitutions())
+    return nullptr;
+
+  auto *ArrayValue =
+    dyn_cast_or_null<TupleExtractInst>(Uninitialized.getArrayValue());
+  auto *Buffer = dyn_cast_or_null<TupleExtractInst>(
+    Uninitialized.getArrayElementStoragePointer());
+  if (!ArrayValue || !Buffer || ArrayValue->getType().hasArchetype())
+    return nullptr;
+
+  // Let's not blow up the bit vector below.
+  auto Count = getConstantCount(Uninitialized.getInitializationCount());
+  if (!Count || *Count < ArrayLiteralOutlineMinCount || *Count > (1U << 16))
+    return nullptr;
+
+  // The allocation, and its callee and arguments.
+  auto *Callee = dyn_cast<FunctionRefInst>(AI->getCallee());
+  if (!Callee)
+    return nullptr;
+  Insns.push_back(Callee);
+  for (SILValue Arg : AI->getArguments()) {
+    if (auto *MT = dyn_cast<MetatypeInst>(Arg)) {
+      Insns.push_back(MT);
+      continue;
+    }
+    if (!analyzeStaticInitializer(Arg, Insns))
+      return nullptr;
+  }
+  ToErase.push_back(AI);
+  ToErase.push_back(ArrayValue);
+  ToErase.push_back(Buffer);
+
+  // The stores of the elements.
+  auto *Extract =
+    dyn_cast_or_null<StructExtractInst>(getSingleNonDebugUser(Buffer));
+  auto *PTAI = Extract ? dyn_cast_or_null<PointerToAddressInst>(
+                             getSingleNonDebugUser(Extract))
+                       : nullptr;
+  if (!PTAI)
+    return nullptr;
+  ToErase.push_back(Extract);
+  ToErase.push_back(PTAI);
+
+  SILModule &M = AI->getModule();
+  llvm::SmallBitVector Initialized(*Count);
+  for (auto *Op : getNonDebugUses(PTAI)) {
+    SILInstruction *User = Op->getUser();
+    SILValue Dest = PTAI;
+    uint64_t Index = 0;
+    if (auto *IndexAddr = dyn_cast<IndexAddrInst>(User)) {
+      auto *IL = dyn_cast<IntegerLiteralInst>(IndexAddr->getIndex());
+      if (!IL || IL->getValue().getActiveBits() > 32)
+        return nullptr;
+      Index = IL->getValue().getZExtValue();
+      Insns.push_back(IL);
+      ToErase.push_back(IndexAddr);
+      Dest = IndexAddr;
+      User = getSingleNonDebugUser(IndexAddr);
+    }
+
+    auto *SI = dyn_cast_or_null<StoreInst>(User);
+    if (!SI || SI->getDest() != Dest || Index >= *Count ||
+        Initialized[Index] || !SI->getSrc()->getType().isTrivial(M) ||
+        !analyzeStaticInitializer(SI->getSrc(), Insns))
+      return nullptr;
+    Initialized.set(Index);
+    ToErase.push_back(SI);
+  }
+  if (!Initialized.all())
+    return nullptr;
+
+  Insns.append(ToErase.begin(), ToErase.end());
+  return ArrayValue;
+}
+
+/// Replace the array literals of many constant trivial elements in \p F by a
+/// load of a global that is initialized with the literal the first time it is
+/// executed. This way the array buffer is allocated and filled only once
+/// instead of at every execution of the literal, e.g. for lookup tables:
+///
+///   %array = <allocate and initialize an array literal>
+/// =>
+///   builtin "once"(%token, @globalinit_<array>)
+///   %array = load %global
+///   retain_value %array
+void SILGlobalOpt::outlineConstantArrayLiterals(SILFunction *F) {
+  SILModule &M = F->getModule();
+  ASTContext &Ctx = M.getASTContext();
+  unsigned NumOutlined = 0;
+
+  for (auto &BB : *F) {
+    for (auto II = BB.begin(), IE = BB.end(); II != IE;) {
+      auto *AI = dyn_cast<ApplyInst>(&*II++);
+      if (!AI)
+        continue;
+
+      SmallVector<SILInstruction *, 64> Insns;
+      SmallVector<SILInstruction *, 64> ToErase;
+      TupleExtractInst *ArrayValue =
+        collectConstantArrayLiteral(AI, Insns, ToErase);
+      if (!ArrayValue)
+        continue;
+
+      // Clone the instructions in their original order, so that definitions
+      // are cloned before their uses.
+      llvm::SmallPtrSet<SILInstruction *, 64> InsnSet(Insns.begin(),
+                                                      Insns.end());
+      SmallVector<SILInstruction *, 64> OrderedInsns;
+      for (auto &I : BB)
+        if (InsnSet.count(&I))
+          OrderedInsns.push_back(&I);
+      if (OrderedInsns.size() != InsnSet.size())
+        continue;
+
+      std::string Name;
+      do {
+        Name = (F->getName() + "_arrayliteral" + Twine(NumOutlined++)).str();
+      } while (M.lookUpGlobalVariable(Name));
+
+      SILLocation Loc = AI->getLoc();
+      auto *Global = SILGlobalVariable::create(M, SILLinkage::Private,
+                                               /*IsFragile=*/false, Name,
+                                               ArrayValue->getType(), Loc);
+      auto *Token = SILGlobalVariable::create(
+          M, SILLinkage::Private, /*IsFragile=*/false, Name + "_token",
+          SILType::getBuiltinWordType(Ctx), Loc);
+
+      // Create the initializer, which stores the array literal to the global.
+      SILFunctionType::ExtInfo EInfo;
+      EInfo = EInfo.withRepresentation(SILFunctionType::Representation::Thin);
+      auto InitTy = SILFunctionType::get(nullptr, EInfo,
+          ParameterConvention::Direct_Owned, { }, { }, None, Ctx);
+      auto *InitF = M.getOrCreateFunction(Loc, "globalinit_" + Name,
+          SILLinkage::Private, InitTy, IsBare_t::IsBare,
+          IsTransparent_t::IsNotTransparent, IsFragile_t::IsNotFragile);
+      InitF->setDebugScope(F->getDebugScope());
+      auto *EntryBB = InitF->createBasicBlock();
+      InstructionsCloner Cloner(*InitF, OrderedInsns, EntryBB);
+      Cloner.clone();
+      SILValue ClonedArray;
+      for (auto &Avail : Cloner.AvailVals)
+        if (Avail.first == ArrayValue)
+          ClonedArray = Avail.second;
+
+      SILBuilderWithScope InitB(EntryBB, &EntryBB->back());
+      auto *InitAddr = InitB.createGlobalAddr(Loc, Global);
+      InitB.createStore(Loc, ClonedArray, InitAddr);
+      InitB.createReturn(Loc, InitB.createTuple(Loc, { }));
+
+      // Replace the array literal by a load of the global.
+      SILBuilderWithScope B(AI);
+      auto *TokenAddr = B.createGlobalAddr(Loc, Token);
+      auto *TokenPtr = B.createAddressToPointer(
+          Loc, TokenAddr, SILType::getRawPointerType(Ctx));
+      auto *InitRef = B.createFunctionRef(Loc, InitF);
+      SILValue OnceArgs[] = { TokenPtr, InitRef };
+      B.createBuiltin(Loc, Ctx.getIdentifier("once"),
+                      SILType::getPrimitiveObjectType(Ctx.TheEmptyTupleType),
+                      { }, OnceArgs);
+      auto *Array = B.createLoad(Loc, B.createGlobalAddr(Loc, Global));
+      B.createRetainValue(Loc, Array, Atomicity::Atomic);
+      ArrayValue->replaceAllUsesWith(Array);
+
+      // Erase the original allocation and initialization, users first.
+      llvm::SmallPtrSet<SILInstruction *, 64> EraseSet(ToErase.begin(),
+                                                       ToErase.end());
+      for (auto *I : reversed(OrderedInsns)) {
+        if (!EraseSet.count(I))
+          continue;
+        if (II != IE && &*II == I)
+          ++II;
+        deleteAllDebugUses(I);
+        I->eraseFromParent();
+      }
+
+      DEBUG(llvm::dbgs() << "GlobalOpt: initialize array literal once in "
+                         << Name << '\n');
+      HasChanged = true;
+    }
+  }
+}
+
 bool SILGlobalOpt::run() {
+  // Initialize array literals of constant elements only once. Collect the
+  // functions first, as this adds initializer functions to the module.
+  if (ArrayLiteralOutlineMinCount) {
+    SmallVector<SILFunction *, 32> Functions;
+    for (auto &F : *Module)
+      if (!F.isExternalDeclaration() && F.shouldOptimize() &&
+          !F.isFragile() && !F.getName().startswith("globalinit_"))
+        Functions.push_back(&F);
+    for (auto *F : Functions)
+      outlineConstantArrayLiterals(F);
+  }
+
   for (auto &F : *Module) {
 
     // Don't optimize functions that are marked with the opt.never attribute.
@@ -900,11 +1325,19 @@ bool SILGlobalOpt::run() {
     }
   }
 
-  for (auto &InitCalls : GlobalInitCallMap) {
-    // Optimize the addressors if possible.
-    optimizeInitializer(InitCalls.first, InitCalls.second);
+  // Optimize the addressors if possible. Making the initializer of a global
+  // static can make the initializers of the globals computed from it static
+  // as well, so iterate until no more initializers become static.
+  bool MadeInitializerStatic;
+  do {
+    MadeInitializerStatic = false;
+    for (auto &InitCalls : GlobalInitCallMap)
+      if (optimizeInitializer(InitCalls.first, InitCalls.second))
+        MadeInitializerStatic = true;
+  } while (MadeInitializerStatic);
+
+  for (auto &InitCalls : GlobalInitCallMap)
     placeInitializers(InitCalls.first, InitCalls.second);
-  }
 
   for (auto &Init : GlobalVarStore) {
     // Optimize the access to globals if possible.
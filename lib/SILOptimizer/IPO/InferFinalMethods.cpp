@@ -0,0 +1,194 @@
+//===--- InferFinalMethods.cpp - Make methods without overrides final -----===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// In a whole-module compilation, a method of an internal class which is not
+// overridden anywhere in the module always dispatches to the same
+// implementation. The devirtualizer handles the calls it can see, but partial
+// applications and calls it could not rewrite still load the implementation
+// from the vtable, and IRGen still allocates a vtable slot for the method in
+// the class metadata.
+//
+// This pass replaces all remaining class_method and super_method references
+// to such a method with a function_ref of its implementation, marks the
+// method final, and removes it from the vtables. IRGen does not allocate
+// vtable slots for final methods which don't override anything.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "infer-final-methods"
+#include "swift/SILOptimizer/PassManager/Passes.h"
+#include "swift/AST/Attr.h"
+#include "swift/SIL/SILBuilder.h"
+#include "swift/SIL/SILModule.h"
+#include "swift/SIL/SILVTable.h"
+#include "swift/SILOptimizer/PassManager/Transforms.h"
+#include "swift/SILOptimizer/Utils/Local.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/Debug.h"
+
+using namespace swift;
+
+STATISTIC(NumMethodsMadeFinal, "Number of class methods inferred final");
+STATISTIC(NumMethodRefsReplaced,
+          "Number of class method references replaced by function_ref");
+
+/// Returns true if \p Member is a method which can't be overridden outside of
+/// the module, and which no client can call through the vtable.
+static bool mayInferFinal(SILModule &M, SILDeclRef Member) {
+  if (Member.kind != SILDeclRef::Kind::Func || Member.isForeign ||
+      Member.isCurried)
+    return false;
+
+  // Accessors get their vtable slots through their storage decl.
+  auto *FD = dyn_cast<FuncDecl>(Member.getDecl());
+  if (!FD || FD->isAccessor() || FD->isFinal() || FD->isObjC() ||
+      FD->isOverridden() || FD->getOverriddenDecl())
+    return false;
+
+  if (!calleesAreStaticallyKnowable(M, Member))
+    return false;
+
+  // The vtable layout of public classes is visible to clients.
+  auto *CD = dyn_cast<ClassDecl>(FD->getDeclContext());
+  return CD && CD->hasAccessibility() &&
+         CD->getEffectiveAccess() < Accessibility::Public &&
+         FD->getEffectiveAccess() < Accessibility::Public;
+}
+
+namespace {
+
+class InferFinalMethods : public SILModuleTransform {
+  /// The methods without overrides and the implementation each of them
+  /// dispatches to. The implementation is null if the method has to stay in
+  /// the vtable.
+  llvm::MapVector<AbstractFunctionDecl *, SILFunction *> Candidates;
+
+  /// The class_method and super_method instructions referencing candidates.
+  llvm::SmallVector<MethodInst *, 16> MethodRefs;
+
+  void collectCandidates();
+  void collectMethodRefs();
+  void replaceMethodRefs();
+  void removeVTableEntries();
+
+  void run() override {
+    SILModule *M = getModule();
+    if (!M->isWholeModule())
+      return;
+
+    DEBUG(llvm::dbgs() << "** InferFinalMethods **\n");
+
+    collectCandidates();
+    collectMethodRefs();
+    replaceMethodRefs();
+    removeVTableEntries();
+
+    Candidates.clear();
+    MethodRefs.clear();
+  }
+
+  StringRef getName() override { return "Infer Final Methods"; }
+};
+
+} // end anonymous namespace
+
+void InferFinalMethods::collectCandidates() {
+  SILModule &M = *getModule();
+  for (auto &VTable : M.getVTables()) {
+    for (auto &Entry : VTable.getEntries()) {
+      if (!mayInferFinal(M, Entry.first))
+        continue;
+
+      // Without an override, the subclasses inherit the implementation of
+      // the class which declares the method.
+      auto *Method = Entry.first.getAbstractFunctionDecl();
+      auto Inserted = Candidates.insert({Method, Entry.second});
+      if (!Inserted.second && Inserted.first->second != Entry.second)
+        Inserted.first->second = nullptr;
+    }
+  }
+}
+
+void InferFinalMethods::collectMethodRefs() {
+  if (Candidates.empty())
+    return;
+
+  for (auto &F : *getModule()) {
+    for (auto &BB : F) {
+      for (auto &I : BB) {
+        if (!isa<ClassMethodInst>(I) && !isa<SuperMethodInst>(I))
+          continue;
+
+        auto *MI = cast<MethodInst>(&I);
+        auto *Method = MI->getMember().getAbstractFunctionDecl();
+        auto Iter = Candidates.find(Method);
+        if (Iter == Candidates.end() || !Iter->second)
+          continue;
+
+        // A reference which can't be replaced keeps the method in the vtable.
+        if (MI->isVolatile() || MI->getMember().isForeign ||
+            MI->getMember().isCurried ||
+            MI->getType() != Iter->second->getLoweredType()) {
+          Iter->second = nullptr;
+          continue;
+        }
+        MethodRefs.push_back(MI);
+      }
+    }
+  }
+}
+
+void InferFinalMethods::replaceMethodRefs() {
+  for (auto *MI : MethodRefs) {
+    SILFunction *Impl =
+        Candidates.lookup(MI->getMember().getAbstractFunctionDecl());
+    if (!Impl)
+      continue;
+
+    SILFunction *F = MI->getFunction();
+    SILBuilderWithScope Builder(MI);
+    auto *FRI = Builder.createFunctionRef(MI->getLoc(), Impl);
+    MI->replaceAllUsesWith(FRI);
+    recursivelyDeleteTriviallyDeadInstructions(MI, /*Force=*/true);
+    invalidateAnalysis(F, SILAnalysis::InvalidationKind::CallsAndInstructions);
+    ++NumMethodRefsReplaced;
+  }
+}
+
+void InferFinalMethods::removeVTableEntries() {
+  ASTContext &Ctx = getModule()->getASTContext();
+  bool Changed = false;
+  for (auto &Entry : Candidates) {
+    if (!Entry.second)
+      continue;
+    DEBUG(llvm::dbgs() << "  Inferred final: "
+                       << Entry.first->getFullName() << '\n');
+    Entry.first->getAttrs().add(new (Ctx) FinalAttr(/*IsImplicit=*/true));
+    ++NumMethodsMadeFinal;
+    Changed = true;
+  }
+  if (!Changed)
+    return;
+
+  for (auto &VTable : getModule()->getVTables()) {
+    VTable.removeEntries_if([&](SILVTable::Pair &Entry) -> bool {
+      auto *Method = Entry.first.getAbstractFunctionDecl();
+      return Method && Candidates.lookup(Method);
+    });
+  }
+}
+
+SILTransform *swift::createInferFinalMethods() {
+  return new InferFinalMethods();
+}
@@ -598,13 +598,9 @@ static BuiltinValueKind invertCmpID(BuiltinValueKind ID) {
   }
 }
 
-/// Checks if Start to End is the range of 0 to the count of an array.
+/// Checks if End is the count of an array.
 /// Returns the array is this is the case.
-static SILValue getZeroToCountArray(SILValue Start, SILValue End) {
-  auto *IL = dyn_cast<IntegerLiteralInst>(Start);
-  if (!IL || IL->getValue() != 0)
-    return SILValue();
-    
+static SILValue getCountArray(SILValue End) {
   auto *SEI = dyn_cast<StructExtractInst>(End);
   if (!SEI)
     return SILValue();
@@ -616,6 +612,16 @@ static SILValue getZeroToCountArray(SILValue Start, SILValue End) {
   return SemCall.getSelf();
 }
 
+/// Checks if Start to End is the range of 0 to the count of an array.
+/// Returns the array is this is the case.
+static SILValue getZeroToCountArray(SILValue Start, SILValue End) {
+  auto *IL = dyn_cast<IntegerLiteralInst>(Start);
+  if (!IL || IL->getValue() != 0)
+    return SILValue();
+
+  return getCountArray(End);
+}
+
 /// Checks whether the cond_br in the preheader's predecessor ensures that the
 /// loop is only executed if "Start < End".
 static bool isLessThanCheck(SILValue Start, SILValue End,
@@ -925,6 +931,21 @@ public:
     return getZeroToCountArray(Ind->Start, Ind->End) == Array;
   }
 
+  /// Returns true if the loop iterates from a non-negative constant, which is
+  /// checked to be less than the count of \p Array, until the count.
+  bool isWithinZeroToCount(SILValue Array, SILBasicBlock *Preheader,
+                           DominanceInfo *DT) {
+    if (isZeroToCount(Array))
+      return true;
+
+    auto *IL = dyn_cast<IntegerLiteralInst>(Ind->Start);
+    if (!IL || IL->getValue().isNegative())
+      return false;
+    if (getCountArray(Ind->End) != Array)
+      return false;
+    return isRangeChecked(Ind->Start, Ind->End, Preheader, DT);
+  }
+
   /// Hoists the necessary check for beginning and end of the induction
   /// encapsulated by this access function to the header.
   void hoistCheckToPreheader(ArraySemanticsCall CheckToHoist,
@@ -1032,8 +1053,8 @@ static bool hoistChecksInLoop(DominanceInfo *DT, DominanceInfoNode *DTNode,
       continue;
     }
 
-    // Check if the loop iterates from 0 to the count of this array.
-    if (F.isZeroToCount(ArrayVal) &&
+    // Check if the loop iterates within 0 to the count of this array.
+    if (F.isWithinZeroToCount(ArrayVal, Preheader, DT) &&
         // This works only for Arrays but not e.g. for ArraySlice.
         hasArrayType(ArrayVal, Header->getModule())) {
       // We can remove the check. This is even possible if the block does not
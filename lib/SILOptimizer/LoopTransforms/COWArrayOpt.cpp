@@ -1457,6 +1457,12 @@ void COWArrayOpt::hoistMakeMutableAndSelfProjection(
 bool COWArrayOpt::hoistMakeMutable(ArraySemanticsCall MakeMutable) {
   DEBUG(llvm::dbgs() << "    Checking mutable array: " << CurrentArrayAddr);
 
+  // The users and matched releases of arrays checked before don't say
+  // anything about this array. Other arrays of the loop would otherwise be
+  // considered to mutate this one.
+  ArrayUserSet.clear();
+  MatchedReleases.clear();
+
   // We can hoist address projections (even if they are only conditionally
   // executed).
   auto ArrayAddrBase = stripUnaryAddressProjections(CurrentArrayAddr);
@@ -13,11 +13,13 @@
 #define DEBUG_TYPE "sil-licm"
 
 #include "swift/SIL/Dominance.h"
+#include "swift/SILOptimizer/Analysis/ARCAnalysis.h"
 #include "swift/SILOptimizer/Analysis/AliasAnalysis.h"
 #include "swift/SILOptimizer/Analysis/Analysis.h"
 #include "swift/SILOptimizer/Analysis/DominanceAnalysis.h"
 #include "swift/SILOptimizer/Analysis/LoopAnalysis.h"
 #include "swift/SILOptimizer/Analysis/ArraySemantic.h"
+#include "swift/SILOptimizer/Analysis/RCIdentityAnalysis.h"
 #include "swift/SILOptimizer/Analysis/SideEffectAnalysis.h"
 #include "swift/SILOptimizer/PassManager/Passes.h"
 #include "swift/SILOptimizer/PassManager/Transforms.h"
@@ -371,6 +373,135 @@ static bool sinkFixLifetime(SILLoop *Loop, DominanceInfo *DomTree,
   return Changed;
 }
 
+/// Returns true if \p Retain and \p Release are each executed exactly once in
+/// every iteration of \p Loop, with the retain first, and the release before
+/// the loop is left or the next iteration begins.
+static bool isPairedInEveryIteration(SILInstruction *Retain,
+                                     SILInstruction *Release, SILLoop *Loop,
+                                     DominanceInfo *DT) {
+  SILBasicBlock *RetainBB = Retain->getParent();
+  SILBasicBlock *ReleaseBB = Release->getParent();
+
+  // Blocks of sub-loops may be executed several times per iteration.
+  for (auto *SubLoop : *Loop)
+    if (SubLoop->contains(RetainBB) || SubLoop->contains(ReleaseBB))
+      return false;
+
+  if (RetainBB == ReleaseBB) {
+    auto End = RetainBB->end();
+    auto Iter = std::find_if(Retain->getIterator(), End,
+                             [=](SILInstruction &I) { return &I == Release; });
+    if (Iter == End)
+      return false;
+  } else if (!DT->properlyDominates(RetainBB, ReleaseBB)) {
+    return false;
+  }
+
+  // The release must be passed on every way out of the iteration: to the
+  // header through a latch, or out of the loop through an exiting block.
+  SILBasicBlock *Header = Loop->getHeader();
+  for (auto *Pred : Header->getPreds())
+    if (Loop->contains(Pred) && !DT->dominates(ReleaseBB, Pred))
+      return false;
+
+  SmallVector<SILBasicBlock *, 8> ExitingBlocks;
+  Loop->getExitingBlocks(ExitingBlocks);
+  for (auto *ExitingBB : ExitingBlocks)
+    if (!DT->dominates(ReleaseBB, ExitingBB))
+      return false;
+
+  return true;
+}
+
+/// Hoist a retain of a loop invariant value to the preheader and sink the
+/// matching release to the loop exits.
+///
+/// This is done if the loop contains a single retain and a single release of
+/// the value, which are paired in every iteration, e.g. a retain in the header
+/// and a release in the latch, and nothing else in the loop may decrement or
+/// check its reference count. The value is then kept alive over the whole
+/// loop instead of over each iteration.
+static bool hoistRetainReleasePairs(SILLoop *Loop, AliasAnalysis *AA,
+                                    RCIdentityFunctionInfo *RCFI,
+                                    DominanceInfo *DT) {
+  auto *Preheader = Loop->getLoopPreheader();
+  if (!Preheader)
+    return false;
+
+  // The exit blocks must not be reachable from outside the loop, otherwise we
+  // would need to split edges to insert the releases.
+  SmallVector<SILBasicBlock *, 8> ExitBlocks;
+  Loop->getExitBlocks(ExitBlocks);
+  if (ExitBlocks.empty())
+    return false;
+  std::sort(ExitBlocks.begin(), ExitBlocks.end());
+  ExitBlocks.erase(std::unique(ExitBlocks.begin(), ExitBlocks.end()),
+                   ExitBlocks.end());
+  for (auto *ExitBB : ExitBlocks)
+    for (auto *Pred : ExitBB->getPreds())
+      if (!Loop->contains(Pred))
+        return false;
+
+  // Collect the retains and releases in the loop, keyed by RC identity.
+  llvm::SmallMapVector<SILValue, SmallVector<SILInstruction *, 2>, 4> RetainsOf;
+  llvm::DenseMap<SILValue, SmallVector<SILInstruction *, 2>> ReleasesOf;
+  for (auto *BB : Loop->getBlocks()) {
+    for (auto &Inst : *BB) {
+      if (isa<StrongRetainInst>(&Inst) || isa<RetainValueInst>(&Inst)) {
+        SILValue Root = RCFI->getRCIdentityRoot(Inst.getOperand(0));
+        RetainsOf[Root].push_back(&Inst);
+      } else if (isa<StrongReleaseInst>(&Inst) ||
+                 isa<ReleaseValueInst>(&Inst)) {
+        SILValue Root = RCFI->getRCIdentityRoot(Inst.getOperand(0));
+        ReleasesOf[Root].push_back(&Inst);
+      }
+    }
+  }
+
+  bool Changed = false;
+  for (auto &Entry : RetainsOf) {
+    SILValue Root = Entry.first;
+    auto ReleaseIter = ReleasesOf.find(Root);
+    if (Entry.second.size() != 1 || ReleaseIter == ReleasesOf.end() ||
+        ReleaseIter->second.size() != 1)
+      continue;
+
+    SILInstruction *Retain = Entry.second[0];
+    SILInstruction *Release = ReleaseIter->second[0];
+    if (!hasLoopInvariantOperands(Retain, Loop) ||
+        !hasLoopInvariantOperands(Release, Loop) ||
+        !isPairedInEveryIteration(Retain, Release, Loop, DT))
+      continue;
+
+    // Nothing else in the loop may release the value or observe its
+    // reference count.
+    bool IsSafe = true;
+    for (auto *BB : Loop->getBlocks()) {
+      for (auto &Inst : *BB) {
+        if (&Inst == Release)
+          continue;
+        if (mayDecrementRefCount(&Inst, Root, AA) || mayCheckRefCount(&Inst)) {
+          IsSafe = false;
+          break;
+        }
+      }
+      if (!IsSafe)
+        break;
+    }
+    if (!IsSafe)
+      continue;
+
+    DEBUG(llvm::dbgs() << "  hoisting " << *Retain << "  and sinking "
+                       << *Release);
+    Retain->moveBefore(Preheader->getTerminator());
+    for (auto *ExitBB : ExitBlocks)
+      Release->clone(&*ExitBB->begin());
+    Release->eraseFromParent();
+    Changed = true;
+  }
+  return Changed;
+}
+
 namespace {
 /// \brief Summary of may writes occurring in the loop tree rooted at \p
 /// Loop. This includes all writes of the sub loops and the loop itself.
@@ -399,6 +530,7 @@ class LoopTreeOptimization {
   SILLoopInfo *LoopInfo;
   AliasAnalysis *AA;
   SideEffectAnalysis *SEA;
+  RCIdentityFunctionInfo *RCFI;
   DominanceInfo *DomTree;
   bool Changed;
 
@@ -409,9 +541,10 @@ class LoopTreeOptimization {
 public:
   LoopTreeOptimization(SILLoop *TopLevelLoop, SILLoopInfo *LI,
                        AliasAnalysis *AA, SideEffectAnalysis *SEA,
-                       DominanceInfo *DT,
+                       RCIdentityFunctionInfo *RCFI, DominanceInfo *DT,
                        bool RunsOnHighLevelSil)
-      : LoopInfo(LI), AA(AA), SEA(SEA), DomTree(DT), Changed(false),
+      : LoopInfo(LI), AA(AA), SEA(SEA), RCFI(RCFI), DomTree(DT),
+        Changed(false),
         RunsOnHighLevelSil(RunsOnHighLevelSil) {
     // Collect loops for a recursive bottom-up traversal in the loop tree.
     BotUpWorkList.push_back(TopLevelLoop);
@@ -450,6 +583,10 @@ bool LoopTreeOptimization::optimize() {
     auto CurrLoopSummary = llvm::make_unique<LoopNestSummary>(CurrentLoop);
     propagateSummaries(CurrLoopSummary);
 
+    // Move retain/release pairs out of the loop first. Loads are not clobbered
+    // by them anymore.
+    Changed |= hoistRetainReleasePairs(CurrentLoop, AA, RCFI, DomTree);
+
     // Analyse the current loop for reads that can be hoisted.
     ReadSet SafeReads;
     analyzeCurrentLoop(CurrLoopSummary, SafeReads);
@@ -555,6 +692,7 @@ public:
     DominanceAnalysis *DA = PM->getAnalysis<DominanceAnalysis>();
     AliasAnalysis *AA = PM->getAnalysis<AliasAnalysis>();
     SideEffectAnalysis *SEA = PM->getAnalysis<SideEffectAnalysis>();
+    RCIdentityFunctionInfo *RCFI = PM->getAnalysis<RCIdentityAnalysis>()->get(F);
     DominanceInfo *DomTree = nullptr;
 
     DEBUG(llvm::dbgs() << "Processing loops in " << F->getName() << "\n");
@@ -562,7 +700,7 @@ public:
 
     for (auto *TopLevelLoop : *LoopInfo) {
       if (!DomTree) DomTree = DA->get(F);
-      LoopTreeOptimization Opt(TopLevelLoop, LoopInfo, AA, SEA, DomTree,
+      LoopTreeOptimization Opt(TopLevelLoop, LoopInfo, AA, SEA, RCFI, DomTree,
                                RunsOnHighLevelSil);
       Changed |= Opt.optimize();
     }
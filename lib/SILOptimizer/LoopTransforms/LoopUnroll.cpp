@@ -30,6 +30,10 @@ using llvm::MapVector;
 
 static const uint64_t SILLoopUnrollThreshold = 250;
 
+/// The largest number of iterations a loop that is too big to unroll fully is
+/// unrolled into one.
+static const uint64_t SILLoopMaxPartialUnrollFactor = 8;
+
 namespace {
 
 /// Clone the basic blocks in a loop.
@@ -128,7 +132,10 @@ static Optional<uint64_t> getMaxLoopTripCount(SILLoop *Loop,
 
   if (!match(CondBr->getCondition(),
              m_BuiltinInst(BuiltinValueKind::ICMP_EQ, m_SILValue(RecNext),
-                           m_IntegerLiteralInst(End))))
+                           m_IntegerLiteralInst(End))) &&
+      !match(CondBr->getCondition(),
+             m_BuiltinInst(BuiltinValueKind::ICMP_EQ, m_IntegerLiteralInst(End),
+                           m_SILValue(RecNext))))
     return None;
   if (!match(RecNext,
              m_TupleExtractInst(m_ApplyInst(BuiltinValueKind::SAddOver,
@@ -185,11 +192,48 @@ static bool canAndShouldUnrollLoop(SILLoop *Loop, uint64_t TripCount) {
   return true;
 }
 
+/// For a loop that is too big to unroll fully, return the largest number of
+/// iterations that divides the trip count and can be unrolled into one
+/// without exceeding the unroll threshold, or 1 if there is none.
+///
+/// Since the factor divides the trip count, the exit check of the latch can
+/// only succeed in the last copy of the body, and the other copies don't need
+/// one, so no remainder loop is needed.
+static uint64_t getPartialUnrollFactor(SILLoop *Loop, uint64_t TripCount) {
+  assert(Loop->getSubLoops().empty() && "Expect innermost loops");
+  uint64_t Cost = 0;
+  for (auto *BB : Loop->getBlocks()) {
+    for (auto &Inst : *BB) {
+      if (!Loop->canDuplicate(&Inst))
+        return 1;
+      if (instructionInlineCost(Inst) != InlineCost::Free)
+        ++Cost;
+    }
+  }
+
+  for (uint64_t Factor = SILLoopMaxPartialUnrollFactor; Factor > 1; --Factor)
+    if (TripCount % Factor == 0 && Cost * Factor <= SILLoopUnrollThreshold)
+      return Factor;
+  return 1;
+}
+
+/// How the latch of an unrolled copy of the loop body continues.
+enum class LatchKind {
+  /// The loop exits after this copy: replace the exit check by a branch to
+  /// the exit.
+  AlwaysExits,
+  /// Keep the exit check, and continue with the next copy.
+  MayExit,
+  /// The exit check can't succeed in this copy: branch to the next copy
+  /// unconditionally.
+  NeverExits
+};
+
 /// Redirect the terminator of the current loop iteration's latch to the next
 /// iterations header or if this is the last iteration remove the backedge to
 /// the header.
-static void redirectTerminator(SILBasicBlock *Latch, unsigned CurLoopIter,
-                               unsigned LastLoopIter, SILBasicBlock *OrigHeader,
+static void redirectTerminator(SILBasicBlock *Latch, LatchKind Kind,
+                               SILBasicBlock *CurrentHeader,
                                SILBasicBlock *NextIterationsHeader) {
 
   auto *CurrentTerminator = Latch->getTerminator();
@@ -214,18 +258,22 @@ static void redirectTerminator(SILBasicBlock *Latch, unsigned CurLoopIter,
   // Handle the split backedge case.
   if (auto *Br = dyn_cast<BranchInst>(CurrentTerminator)) {
     // On the last iteration change the conditional exit to an unconditional
-    // one.
-    if (CurLoopIter == LastLoopIter) {
+    // one. If the exit can't be taken, unconditionally continue to the
+    // backedge instead.
+    if (Kind != LatchKind::MayExit) {
       auto *CondBr =
           cast<CondBranchInst>(Latch->getSinglePredecessor()->getTerminator());
-      if (CondBr->getTrueBB() != Latch)
+      bool TakeTrueBB = (CondBr->getTrueBB() != Latch) ==
+                        (Kind == LatchKind::AlwaysExits);
+      if (TakeTrueBB)
         SILBuilder(CondBr).createBranch(CondBr->getLoc(), CondBr->getTrueBB(),
                                         CondBr->getTrueArgs());
       else
         SILBuilder(CondBr).createBranch(CondBr->getLoc(), CondBr->getFalseBB(),
                                         CondBr->getFalseArgs());
       CondBr->eraseFromParent();
-      return;
+      if (Kind == LatchKind::AlwaysExits)
+        return;
     }
 
     // Otherwise, branch to the next iteration's header.
@@ -239,8 +287,8 @@ static void redirectTerminator(SILBasicBlock *Latch, unsigned CurLoopIter,
   auto *CondBr = cast<CondBranchInst>(CurrentTerminator);
   // On the last iteration change the conditional exit to an unconditional
   // one.
-  if (CurLoopIter == LastLoopIter) {
-    if (CondBr->getTrueBB() != OrigHeader)
+  if (Kind == LatchKind::AlwaysExits) {
+    if (CondBr->getTrueBB() != CurrentHeader)
       SILBuilder(CondBr).createBranch(CondBr->getLoc(), CondBr->getTrueBB(),
                                       CondBr->getTrueArgs());
     else
@@ -250,8 +298,19 @@ static void redirectTerminator(SILBasicBlock *Latch, unsigned CurLoopIter,
     return;
   }
 
+  // If the exit can't be taken, unconditionally branch to the next
+  // iteration's header.
+  if (Kind == LatchKind::NeverExits) {
+    SILBuilder(CondBr).createBranch(CondBr->getLoc(), NextIterationsHeader,
+                                    CondBr->getTrueBB() == CurrentHeader
+                                        ? CondBr->getTrueArgs()
+                                        : CondBr->getFalseArgs());
+    CondBr->eraseFromParent();
+    return;
+  }
+
   // Otherwise, branch to the next iteration's header.
-  if (CondBr->getTrueBB() == OrigHeader) {
+  if (CondBr->getTrueBB() == CurrentHeader) {
     SILBuilder(CondBr).createCondBranch(
         CondBr->getLoc(), CondBr->getCondition(), NextIterationsHeader,
         CondBr->getTrueArgs(), CondBr->getFalseBB(), CondBr->getFalseArgs());
@@ -325,7 +384,8 @@ updateSSA(SILLoop *Loop,
 }
 
 /// Try to fully unroll the loop if we can determine the trip count and the trip
-/// count lis below a threshold.
+/// count lis below a threshold. Otherwise, try to unroll a number of its
+/// iterations into one.
 static bool tryToUnrollLoop(SILLoop *Loop) {
   assert(Loop->getSubLoops().empty() && "Expecting innermost loops");
 
@@ -344,7 +404,11 @@ static bool tryToUnrollLoop(SILLoop *Loop) {
   if (!MaxTripCount)
     return false;
 
-  if (!canAndShouldUnrollLoop(Loop, MaxTripCount.getValue()))
+  bool FullyUnroll = canAndShouldUnrollLoop(Loop, MaxTripCount.getValue());
+  uint64_t UnrollFactor = FullyUnroll
+                              ? MaxTripCount.getValue()
+                              : getPartialUnrollFactor(Loop, *MaxTripCount);
+  if (!FullyUnroll && UnrollFactor < 2)
     return false;
 
   // TODO: We need to split edges from non-condbr exits for the SSA updater. For
@@ -355,8 +419,9 @@ static bool tryToUnrollLoop(SILLoop *Loop) {
     if (!isa<CondBranchInst>(Exit->getTerminator()))
       return false;
 
-  DEBUG(llvm::dbgs() << "Unrolling loop in " << Header->getParent()->getName()
-                     << " " << *Loop << "\n");
+  DEBUG(llvm::dbgs() << (FullyUnroll ? "Unrolling" : "Partially unrolling")
+                     << " loop in " << Header->getParent()->getName() << " "
+                     << *Loop << "\n");
 
   SmallVector<SILBasicBlock *, 16> Headers;
   Headers.push_back(Header);
@@ -366,8 +431,8 @@ static bool tryToUnrollLoop(SILLoop *Loop) {
 
   DenseMap<SILValue, SmallVector<SILValue, 8>> LoopLiveOutValues;
 
-  // Copy the body MaxTripCount-1 times.
-  for (uint64_t Cnt = 1; Cnt < *MaxTripCount; ++Cnt) {
+  // Copy the body UnrollFactor-1 times.
+  for (uint64_t Cnt = 1; Cnt < UnrollFactor; ++Cnt) {
     // Clone the blocks in the loop.
     LoopCloner Cloner(Loop);
     Cloner.cloneLoop();
@@ -398,17 +463,25 @@ static bool tryToUnrollLoop(SILLoop *Loop) {
   }
 
   // Thread the loop clones by redirecting the loop latches to the successor
-  // iteration's header.
+  // iteration's header. When fully unrolling, the last iteration exits the
+  // loop. Otherwise, it continues with the original loop header, and only
+  // its exit check can succeed.
   for (unsigned Iteration = 0, End = Latches.size(); Iteration != End;
        ++Iteration) {
     auto *CurrentLatch = Latches[Iteration];
     auto LastIteration = End - 1;
-    auto *OriginalHeader = Headers[0];
-    auto *NextIterationsHeader =
-        Iteration == LastIteration ? nullptr : Headers[Iteration + 1];
+    auto *CurrentHeader = Headers[Iteration];
+    SILBasicBlock *NextIterationsHeader;
+    LatchKind Kind;
+    if (Iteration != LastIteration) {
+      NextIterationsHeader = Headers[Iteration + 1];
+      Kind = FullyUnroll ? LatchKind::MayExit : LatchKind::NeverExits;
+    } else {
+      NextIterationsHeader = FullyUnroll ? nullptr : Headers[0];
+      Kind = FullyUnroll ? LatchKind::AlwaysExits : LatchKind::MayExit;
+    }
 
-    redirectTerminator(CurrentLatch, Iteration, LastIteration, OriginalHeader,
-                       NextIterationsHeader);
+    redirectTerminator(CurrentLatch, Kind, CurrentHeader, NextIterationsHeader);
   }
 
   // Fixup SSA form for loop values used outside the loop.
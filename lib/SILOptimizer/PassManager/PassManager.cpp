@@ -14,6 +14,7 @@
 
 #include "swift/SILOptimizer/PassManager/PassManager.h"
 #include "swift/Basic/DemangleWrappers.h"
+#include "swift/Basic/Trace.h"
 #include "swift/SIL/SILFunction.h"
 #include "swift/SIL/SILModule.h"
 #include "swift/SILOptimizer/Analysis/BasicCalleeAnalysis.h"
@@ -25,6 +26,8 @@
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/GraphWriter.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/TimeValue.h"
@@ -45,6 +48,12 @@ llvm::cl::opt<bool> SILPrintPassTime(
     "sil-print-pass-time", llvm::cl::init(false),
     llvm::cl::desc("Print the execution time of each SIL pass"));
 
+llvm::cl::opt<std::string> SILPassProfile(
+    "sil-pass-profile", llvm::cl::init(""),
+    llvm::cl::desc("Write a profile of all SIL passes in the Chrome trace "
+                   "format to the given file"),
+    llvm::cl::value_desc("filename"));
+
 llvm::cl::opt<unsigned> SILNumOptPassesToRun(
     "sil-opt-pass-count", llvm::cl::init(UINT_MAX),
     llvm::cl::desc("Stop optimizing after <N> optimization passes"));
@@ -116,6 +125,120 @@ struct DebugOnlyPassNumberOpt {
 
 }
 
+namespace {
+
+/// The profile of all passes run with -sil-pass-profile, over all pass
+/// managers. It is written in the Chrome trace event format, which can be
+/// loaded into chrome://tracing.
+class PassProfile {
+  struct Event {
+    std::string PassName;
+    /// Empty for module passes.
+    std::string FunctionName;
+    std::string StageName;
+    /// In microseconds, relative to the start of the first pass.
+    uint64_t StartTime;
+    uint64_t Duration;
+    unsigned NumInstsBefore;
+    unsigned NumInstsAfter;
+    /// The bytes allocated with the SILModule's allocator during the pass.
+    size_t AllocatedBytes;
+    unsigned NumInvalidations;
+  };
+
+  std::vector<Event> Events;
+
+  /// The start time of the first recorded pass.
+  llvm::sys::TimeValue ProfileStartTime;
+
+  bool Started = false;
+
+  static void printString(llvm::raw_ostream &OS, StringRef Str) {
+    OS << '"';
+    for (char C : Str) {
+      switch (C) {
+        case '"': OS << "\\\""; break;
+        case '\\': OS << "\\\\"; break;
+        default:
+          if ((unsigned char)C < 0x20)
+            OS << "\\u" << llvm::format_hex_no_prefix((unsigned char)C, 4);
+          else
+            OS << C;
+      }
+    }
+    OS << '"';
+  }
+
+public:
+  /// Records the run of pass \p PassName, which started at \p StartTime and
+  /// ended at \p EndTime.
+  void addEvent(StringRef PassName, StringRef FunctionName,
+                StringRef StageName, llvm::sys::TimeValue StartTime,
+                llvm::sys::TimeValue EndTime, unsigned NumInstsBefore,
+                unsigned NumInstsAfter, size_t AllocatedBytes,
+                unsigned NumInvalidations) {
+    if (!Started) {
+      ProfileStartTime = StartTime;
+      Started = true;
+    }
+    Events.push_back({PassName.str(), FunctionName.str(), StageName.str(),
+                      (StartTime - ProfileStartTime).usec(),
+                      (EndTime - StartTime).usec(), NumInstsBefore,
+                      NumInstsAfter, AllocatedBytes, NumInvalidations});
+  }
+
+  /// Writes all events recorded so far to \p FileName.
+  void write(StringRef FileName) const {
+    std::error_code EC;
+    llvm::raw_fd_ostream OS(FileName, EC, llvm::sys::fs::F_Text);
+    if (EC) {
+      llvm::errs() << "error: cannot write the SIL pass profile to "
+                   << FileName << ": " << EC.message() << '\n';
+      return;
+    }
+    OS << "{\"traceEvents\":[";
+    for (unsigned Idx = 0, End = Events.size(); Idx != End; ++Idx) {
+      const Event &E = Events[Idx];
+      OS << (Idx == 0 ? "\n" : ",\n") << "{\"name\":";
+      printString(OS, E.PassName);
+      OS << ",\"cat\":\"" << (E.FunctionName.empty() ? "module" : "function")
+         << "\",\"ph\":\"X\",\"pid\":1,\"tid\":1"
+         << ",\"ts\":" << E.StartTime << ",\"dur\":" << E.Duration
+         << ",\"args\":{";
+      if (!E.FunctionName.empty()) {
+        OS << "\"function\":";
+        printString(OS, E.FunctionName);
+        OS << ',';
+      }
+      OS << "\"stage\":";
+      printString(OS, E.StageName);
+      OS << ",\"instructions_before\":" << E.NumInstsBefore
+         << ",\"instructions_after\":" << E.NumInstsAfter
+         << ",\"allocated_bytes\":" << E.AllocatedBytes
+         << ",\"invalidations\":" << E.NumInvalidations << "}}";
+    }
+    OS << "\n]}\n";
+  }
+};
+
+} // end anonymous namespace
+
+static llvm::ManagedStatic<PassProfile> ThePassProfile;
+
+static unsigned getNumInstructions(SILFunction *F) {
+  unsigned Count = 0;
+  for (auto &BB : *F)
+    Count += std::distance(BB.begin(), BB.end());
+  return Count;
+}
+
+static unsigned getNumInstructions(SILModule *M) {
+  unsigned Count = 0;
+  for (auto &F : *M)
+    Count += getNumInstructions(&F);
+  return Count;
+}
+
 static DebugOnlyPassNumberOpt DebugOnlyPassNumberOptLoc;
 
 static llvm::cl::opt<DebugOnlyPassNumberOpt, true,
@@ -302,6 +425,7 @@ void SILPassManager::runPassOnFunction(SILFunctionTransform *SFT,
   }
 
   CurrentPassHasInvalidated = false;
+  CurrentPassInvalidatedFunctions.clear();
 
   if (SILPrintPassName)
     llvm::dbgs() << "  #" << NumPassesRun << " Stage: " << StageName
@@ -315,11 +439,24 @@ void SILPassManager::runPassOnFunction(SILFunctionTransform *SFT,
     F->dump(getOptions().EmitVerboseSIL);
   }
 
+  unsigned NumInstsBefore = 0;
+  size_t AllocatedBytesBefore = 0;
+  if (!SILPassProfile.empty()) {
+    NumInstsBefore = getNumInstructions(F);
+    AllocatedBytesBefore = Mod->getAllocatedBytes();
+    NumCurrentPassInvalidations = 0;
+  }
+
   llvm::sys::TimeValue StartTime = llvm::sys::TimeValue::now();
   Mod->registerDeleteNotificationHandler(SFT);
   if (breakBeforeRunning(F->getName(), SFT->getName()))
     LLVM_BUILTIN_DEBUGTRAP;
-  SFT->run();
+  {
+    TraceScope trace("sil-pass", [&] {
+      return (Twine(SFT->getName()) + " (" + F->getName() + ")").str();
+    });
+    SFT->run();
+  }
   assert(analysesUnlocked() && "Expected all analyses to be unlocked!");
   Mod->removeDeleteNotificationHandler(SFT);
 
@@ -330,6 +467,14 @@ void SILPassManager::runPassOnFunction(SILFunctionTransform *SFT,
                  << ")\n";
   }
 
+  if (!SILPassProfile.empty()) {
+    ThePassProfile->addEvent(SFT->getName(), F->getName(), StageName,
+                             StartTime, llvm::sys::TimeValue::now(),
+                             NumInstsBefore, getNumInstructions(F),
+                             Mod->getAllocatedBytes() - AllocatedBytesBefore,
+                             NumCurrentPassInvalidations);
+  }
+
   // If this pass invalidated anything, print and verify.
   if (doPrintAfter(SFT, F, CurrentPassHasInvalidated && SILPrintAll)) {
     llvm::dbgs() << "*** SIL function after " << StageName << " "
@@ -385,6 +530,15 @@ void SILPassManager::runFunctionPasses(PassList FuncTransforms) {
     llvm::dbgs() << "Start function passes at stage: " << StageName << "\n";
 
   // Run all transforms for all functions, starting at the tail of the worklist.
+  //
+  // FIXME: Functions whose callees are already done could be handed to a pool
+  // of workers, but function passes aren't isolated to their function today.
+  // They allocate instructions and types from the shared SILModule and
+  // TypeLowering caches, create functions (specializations, thunks) and push
+  // them onto this worklist, and some read or modify callees' bodies.
+  // Analyses are also invalidated through this pass manager rather than per
+  // function.  All of that must be made thread-safe, and passes marked as
+  // safe to run concurrently, before this loop can be parallelized.
   while (!FunctionWorklist.empty() && continueTransforming()) {
     unsigned TailIdx = FunctionWorklist.size() - 1;
     unsigned PipelineIdx = FunctionWorklist[TailIdx].PipelineIdx;
@@ -427,6 +581,8 @@ void SILPassManager::runModulePass(SILModuleTransform *SMT) {
   SMT->injectModule(Mod);
 
   CurrentPassHasInvalidated = false;
+  CurrentPassHasInvalidatedModule = false;
+  CurrentPassInvalidatedFunctions.clear();
 
   if (SILPrintPassName)
     llvm::dbgs() << "#" << NumPassesRun << " Stage: " << StageName
@@ -439,10 +595,21 @@ void SILPassManager::runModulePass(SILModuleTransform *SMT) {
     printModule(Mod, Options.EmitVerboseSIL);
   }
 
+  unsigned NumInstsBefore = 0;
+  size_t AllocatedBytesBefore = 0;
+  if (!SILPassProfile.empty()) {
+    NumInstsBefore = getNumInstructions(Mod);
+    AllocatedBytesBefore = Mod->getAllocatedBytes();
+    NumCurrentPassInvalidations = 0;
+  }
+
   llvm::sys::TimeValue StartTime = llvm::sys::TimeValue::now();
   assert(analysesUnlocked() && "Expected all analyses to be unlocked!");
   Mod->registerDeleteNotificationHandler(SMT);
-  SMT->run();
+  {
+    TraceScope trace("sil-pass", SMT->getName());
+    SMT->run();
+  }
   Mod->removeDeleteNotificationHandler(SMT);
   assert(analysesUnlocked() && "Expected all analyses to be unlocked!");
 
@@ -452,6 +619,14 @@ void SILPassManager::runModulePass(SILModuleTransform *SMT) {
     llvm::dbgs() << Delta << " (" << SMT->getName() << ",Module)\n";
   }
 
+  if (!SILPassProfile.empty()) {
+    ThePassProfile->addEvent(SMT->getName(), StringRef(), StageName,
+                             StartTime, llvm::sys::TimeValue::now(),
+                             NumInstsBefore, getNumInstructions(Mod),
+                             Mod->getAllocatedBytes() - AllocatedBytesBefore,
+                             NumCurrentPassInvalidations);
+  }
+
   // If this pass invalidated anything, print and verify.
   if (doPrintAfter(SMT, nullptr,
                    CurrentPassHasInvalidated && SILPrintAll)) {
@@ -461,11 +636,27 @@ void SILPassManager::runModulePass(SILModuleTransform *SMT) {
     printModule(Mod, Options.EmitVerboseSIL);
   }
 
-  if (Options.VerifyAll &&
-      (CurrentPassHasInvalidated || !SILVerifyWithoutInvalidation)) {
+  if (!Options.VerifyAll)
+    return;
+
+  if (CurrentPassHasInvalidatedModule || SILVerifyWithoutInvalidation) {
     Mod->verify();
     verifyAnalyses();
+    return;
   }
+
+  // Verifying the whole module after every module pass is quadratic in the
+  // size of the module. Only verify the functions which the pass changed or
+  // created. Deleted functions are not in the module anymore.
+  if (!CurrentPassHasInvalidated)
+    return;
+  Mod->verify([&](const SILFunction &F) {
+    return CurrentPassInvalidatedFunctions.count(const_cast<SILFunction *>(&F));
+  });
+  for (SILFunction &F : *Mod)
+    if (CurrentPassInvalidatedFunctions.count(&F))
+      verifyAnalyses(&F);
+  CurrentPassInvalidatedFunctions.clear();
 }
 
 void SILPassManager::runOneIteration() {
@@ -541,6 +732,11 @@ void SILPassManager::run() {
 
 /// D'tor.
 SILPassManager::~SILPassManager() {
+  // Write the profile of all pass managers which ran so far. The last pass
+  // manager of the compilation writes the complete profile.
+  if (!SILPassProfile.empty())
+    ThePassProfile->write(SILPassProfile);
+
   // Free all transformations.
   for (auto T : Transformations)
     delete T;
@@ -240,6 +240,7 @@ void AddSSAPasses(SILPassManager &PM, OptimizationLevelKind OpLevel) {
 
   PM.addEarlyCodeMotion();
   PM.addReleaseHoisting();
+  PM.addGuaranteedARCOpts();
   PM.addARCSequenceOpts();
 
   PM.addSimplifyCFG();
@@ -325,6 +326,10 @@ void swift::runSILOptimizationPasses(SILModule &Module) {
   PM.addGlobalOpt();
   PM.addLetPropertiesOpt();
 
+  // Call the internal methods without overrides directly, and drop their
+  // vtable slots. This runs after the devirtualizer has seen the calls.
+  PM.addInferFinalMethods();
+
   // Propagate constants into closures and convert to static dispatch.  This
   // should run after specialization and inlining because we don't want to
   // specialize a call that can be inlined. It should run before
@@ -385,6 +390,10 @@ void swift::runSILOptimizationPasses(SILModule &Module) {
   PM.addRedundantOverflowCheckRemoval();
   PM.addMergeCondFails();
 
+  // Move the code that leads to traps out of line.
+  if (Module.getOptions().EnableColdCodeOutlining)
+    PM.addColdCodeOutlining();
+
   // Remove dead code.
   PM.addDCE();
   PM.addSimplifyCFG();
@@ -393,10 +402,20 @@ void swift::runSILOptimizationPasses(SILModule &Module) {
   // after FSO.
   PM.addLateReleaseHoisting();
 
+  // Make reference counting of thread-local objects non-atomic. This must
+  // run after the last pass which creates new retains and releases.
+  if (Module.getOptions().EnableNonAtomicRC)
+    PM.addNonAtomicRC();
+
   PM.runOneIteration();
 
   PM.resetAndRemoveTransformations();
-  
+
+  // Serialize the bodies of generic and small public functions once they are
+  // fully optimized.
+  if (Module.getOptions().EnableCrossModuleOptimization)
+    PM.addCrossModuleSerializationSetup();
+
   // Has only an effect if the -gsil option is specified.
   PM.addSILDebugInfoGenerator();
 
@@ -31,11 +31,21 @@
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/Hashing.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 
 using namespace swift;
 
+/// Stop iterating over a function after this many iterations, even if the
+/// last one still changed it.
+static llvm::cl::opt<unsigned>
+SILCombineMaxIterations("sil-combine-max-iterations", llvm::cl::init(32),
+                        llvm::cl::Hidden);
+
 STATISTIC(NumSimplified, "Number of instructions simplified");
+STATISTIC(NumSimplifySkipped,
+          "Number of unchanged instructions not simplified again");
 STATISTIC(NumCombined, "Number of instructions combined");
 STATISTIC(NumDeadInst, "Number of dead insts eliminated");
 
@@ -105,6 +115,8 @@ void SILCombiner::addReachableCodeToWorklist(SILBasicBlock *BB) {
 //===----------------------------------------------------------------------===//
 
 void SILCombineWorklist::add(SILInstruction *I) {
+  // I or one of its operands changed, so it may simplify now.
+  UnsimplifiableMap.erase(I);
   if (!WorklistMap.insert(std::make_pair(I, Worklist.size())).second)
     return;
 
@@ -142,8 +154,12 @@ bool SILCombiner::doOneIteration(SILFunction &F, unsigned Iteration) {
       continue;
     }
 
-    // Check to see if we can instsimplify the instruction.
-    if (SILValue Result = simplifyInstruction(I)) {
+    // Check to see if we can instsimplify the instruction. Don't try again on
+    // instructions that could not be simplified in an earlier iteration, if
+    // nothing they depend on has changed since.
+    if (Worklist.isKnownUnsimplifiable(I)) {
+      ++NumSimplifySkipped;
+    } else if (SILValue Result = simplifyInstruction(I)) {
       ++NumSimplified;
 
       DEBUG(llvm::dbgs() << "SC: Simplify Old = " << *I << '\n'
@@ -158,6 +174,8 @@ bool SILCombiner::doOneIteration(SILFunction &F, unsigned Iteration) {
       eraseInstFromFunction(*I);
       MadeChange = true;
       continue;
+    } else {
+      Worklist.setUnsimplifiable(I);
     }
 
     // If we have reached this point, all attempts to do simple simplifications
@@ -222,6 +240,14 @@ bool SILCombiner::doOneIteration(SILFunction &F, unsigned Iteration) {
   return MadeChange;
 }
 
+unsigned SILCombineWorklist::hashOperands(SILInstruction *I) {
+  llvm::hash_code Hash = llvm::hash_value(I->getNumOperands());
+  for (const Operand &Op : I->getAllOperands())
+    Hash = llvm::hash_combine(Hash, Op.get().getOpaqueValue());
+  return Hash;
+}
+
+
 void SILCombineWorklist::addInitialGroup(ArrayRef<SILInstruction *> List) {
   assert(Worklist.empty() && "Worklist must be empty to add initial group");
   Worklist.reserve(List.size()+16);
@@ -240,10 +266,15 @@ bool SILCombiner::runOnFunction(SILFunction &F) {
   clear();
 
   bool Changed = false;
-  // Perform iterations until we do not make any changes.
+  // Perform iterations until we do not make any changes, or give up on
+  // functions that keep changing.
   while (doOneIteration(F, Iteration)) {
     Changed = true;
-    Iteration++;
+    if (++Iteration == SILCombineMaxIterations) {
+      DEBUG(llvm::dbgs() << "SC: giving up on " << F.getName() << " after "
+                         << Iteration << " iterations\n");
+      break;
+    }
   }
 
   // Cleanup the builder and return whether or not we made any changes.
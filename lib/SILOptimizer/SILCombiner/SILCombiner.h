@@ -38,6 +38,13 @@ class SILCombineWorklist {
   llvm::SmallVector<SILInstruction *, 256> Worklist;
   llvm::DenseMap<SILInstruction *, unsigned> WorklistMap;
 
+  /// The instructions that simplifyInstruction() failed on, with a hash of
+  /// the operands they had then. An instruction is dropped from this map
+  /// whenever it is added to the worklist for having changed, or removed.
+  llvm::DenseMap<SILInstruction *, unsigned> UnsimplifiableMap;
+
+  static unsigned hashOperands(SILInstruction *I);
+
   void operator=(const SILCombineWorklist &RHS) = delete;
   SILCombineWorklist(const SILCombineWorklist &Worklist) = delete;
 public:
@@ -64,6 +71,7 @@ public:
 
   // If I is in the worklist, remove it.
   void remove(SILInstruction *I) {
+    UnsimplifiableMap.erase(I);
     auto It = WorklistMap.find(I);
     if (It == WorklistMap.end())
       return; // Not in worklist.
@@ -74,6 +82,22 @@ public:
     WorklistMap.erase(It);
   }
 
+  /// Remember that simplifyInstruction() could not simplify \p I.
+  void setUnsimplifiable(SILInstruction *I) {
+    UnsimplifiableMap[I] = hashOperands(I);
+  }
+
+  /// Returns true if simplifyInstruction() failed on \p I before, and
+  /// neither \p I nor its operands have changed since.
+  bool isKnownUnsimplifiable(SILInstruction *I) const {
+    auto It = UnsimplifiableMap.find(I);
+    return It != UnsimplifiableMap.end() && It->second == hashOperands(I);
+  }
+
+  /// Forget everything that is known about the instructions of the
+  /// function.
+  void clearUnsimplifiable() { UnsimplifiableMap.clear(); }
+
   /// Remove the top element from the worklist.
   SILInstruction *removeOne() {
     SILInstruction *I = Worklist.pop_back_val();
@@ -141,6 +165,7 @@ public:
   void clear() {
     Iteration = 0;
     Worklist.zap();
+    Worklist.clearUnsimplifiable();
     MadeChange = false;
   }
 
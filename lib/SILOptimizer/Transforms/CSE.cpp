@@ -26,6 +26,7 @@
 #include "swift/SIL/DebugUtils.h"
 #include "swift/SILOptimizer/Utils/Local.h"
 #include "swift/SILOptimizer/PassManager/Transforms.h"
+#include "swift/SILOptimizer/Analysis/AliasAnalysis.h"
 #include "swift/SILOptimizer/Analysis/ArraySemantic.h"
 #include "swift/SILOptimizer/Analysis/DominanceAnalysis.h"
 #include "swift/SILOptimizer/Analysis/SimplifyInstruction.h"
@@ -275,6 +276,10 @@ public:
     return llvm::hash_combine(X->getKind(), X->getElement(), X->getOperand());
   }
 
+  hash_code visitLoadInst(LoadInst *X) {
+    return llvm::hash_combine(X->getKind(), X->getOperand());
+  }
+
   hash_code visitIndexAddrInst(IndexAddrInst *X) {
     return llvm::hash_combine(X->getKind(), X->getType(), X->getBase(),
                               X->getIndex());
@@ -855,6 +860,12 @@ bool CSE::canHandle(SILInstruction *Inst) {
   if (auto *EMI = dyn_cast<ExistentialMetatypeInst>(Inst)) {
     return !EMI->getOperand()->getType().isAddress();
   }
+  if (auto *LI = dyn_cast<LoadInst>(Inst)) {
+    // A "let" property of a class or a "let" global is initialized once,
+    // before it can be read, so all loads from it produce the same value, no
+    // matter what is executed in between.
+    return isLetPointer(LI->getOperand());
+  }
   switch (Inst->getKind()) {
     case ValueKind::FunctionRefInst:
     case ValueKind::GlobalAddrInst:
@@ -0,0 +1,348 @@
+//===--- ColdCodeOutlining.cpp - Move no-return regions out of line -------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Blocks from which every path ends in an unreachable are never executed in a
+// program that keeps running: they report a failed precondition, an error that
+// can't be handled, or similar, and then trap. They still take up space in the
+// middle of the hot code, often a lot of it, because building the message for
+// the failure is not cheap.
+//
+// This pass moves each such region out of the function into a new function
+// with the "optimize.cold" semantics attribute and replaces the region with a
+// call to it. IRGen marks those functions cold and places them apart from the
+// rest of the code.
+//
+// Only regions with a single entry that never rejoin the rest of the function
+// are outlined. Values that are defined outside the region and used inside it
+// are passed as arguments.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "cold-code-outlining"
+
+#include "swift/SILOptimizer/Analysis/DominanceAnalysis.h"
+#include "swift/SILOptimizer/PassManager/Passes.h"
+#include "swift/SILOptimizer/PassManager/Transforms.h"
+#include "swift/SIL/SILBuilder.h"
+#include "swift/SIL/SILCloner.h"
+#include "swift/SIL/SILInstruction.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include <algorithm>
+
+using namespace swift;
+
+STATISTIC(NumRegionsOutlined, "Number of cold regions outlined");
+
+llvm::cl::opt<unsigned> ColdCodeOutliningThreshold(
+    "cold-code-outlining-threshold", llvm::cl::init(8),
+    llvm::cl::desc("The minimum number of instructions in a region that is "
+                   "moved into a cold function"));
+
+namespace {
+
+/// A single-entry region of blocks that all end in an unreachable.
+struct ColdRegion {
+  SILBasicBlock *Entry;
+  llvm::SmallSetVector<SILBasicBlock *, 8> Blocks;
+
+  /// Values defined outside the region that the region uses. They become
+  /// the arguments of the outlined function, after the entry's arguments.
+  llvm::SmallSetVector<SILValue, 8> Captures;
+
+  /// Literals defined outside the region that the region uses. They are
+  /// recreated in the outlined function instead of being passed in.
+  llvm::SmallSetVector<LiteralInst *, 8> Literals;
+
+  /// Values defined outside the region that are used only by debug
+  /// instructions in it. Those debug instructions are dropped.
+  llvm::SmallPtrSet<ValueBase *, 8> DebugOnly;
+
+  ColdRegion(SILBasicBlock *Entry) : Entry(Entry) {}
+
+  bool contains(SILBasicBlock *BB) const { return Blocks.count(BB); }
+};
+
+class ColdRegionCloner : public SILClonerWithScopes<ColdRegionCloner> {
+  friend class SILVisitor<ColdRegionCloner>;
+  friend class SILCloner<ColdRegionCloner>;
+
+  const ColdRegion &Region;
+
+public:
+  ColdRegionCloner(SILFunction &Outlined, const ColdRegion &Region)
+      : SILClonerWithScopes<ColdRegionCloner>(Outlined), Region(Region) {}
+
+  void populateCloned();
+
+protected:
+  void visitDebugValueInst(DebugValueInst *DVI) {
+    if (Region.DebugOnly.count(DVI->getOperand()))
+      return;
+    SILClonerWithScopes<ColdRegionCloner>::visitDebugValueInst(DVI);
+  }
+
+  void visitDebugValueAddrInst(DebugValueAddrInst *DVAI) {
+    if (Region.DebugOnly.count(DVAI->getOperand()))
+      return;
+    SILClonerWithScopes<ColdRegionCloner>::visitDebugValueAddrInst(DVAI);
+  }
+};
+
+} // end anonymous namespace
+
+void ColdRegionCloner::populateCloned() {
+  SILFunction &Outlined = getBuilder().getFunction();
+  SILBasicBlock *EntryBB = Outlined.createBasicBlock();
+
+  for (SILArgument *Arg : Region.Entry->getBBArgs())
+    ValueMap[Arg] = EntryBB->createBBArg(Arg->getType());
+  for (SILValue Capture : Region.Captures)
+    ValueMap[Capture] = EntryBB->createBBArg(Capture->getType());
+
+  getBuilder().setInsertionPoint(EntryBB);
+  for (LiteralInst *Literal : Region.Literals)
+    visit(Literal);
+
+  BBMap.insert(std::make_pair(Region.Entry, EntryBB));
+  visitSILBasicBlock(Region.Entry);
+
+  for (auto BI = BBMap.begin(), BE = BBMap.end(); BI != BE; ++BI) {
+    getBuilder().setInsertionPoint(BI->second);
+    visit(BI->first->getTerminator());
+  }
+}
+
+/// Returns true if \p V can be passed to the outlined function directly.
+static bool canPassDirectly(SILValue V, SILModule &M) {
+  SILType Ty = V->getType();
+  return Ty.isObject() && Ty.isLoadable(M) && !Ty.hasArchetype();
+}
+
+/// Compute the blocks from which every path ends in an unreachable.
+static void
+findNoReturnBlocks(SILFunction &F,
+                   llvm::SmallPtrSetImpl<SILBasicBlock *> &NoReturn) {
+  llvm::SmallVector<SILBasicBlock *, 16> Worklist;
+  for (auto &BB : F) {
+    if (isa<UnreachableInst>(BB.getTerminator())) {
+      NoReturn.insert(&BB);
+      Worklist.push_back(&BB);
+    }
+  }
+
+  while (!Worklist.empty()) {
+    SILBasicBlock *BB = Worklist.pop_back_val();
+    for (SILBasicBlock *Pred : BB->getPreds()) {
+      if (NoReturn.count(Pred))
+        continue;
+      auto Succs = Pred->getSuccessors();
+      if (std::all_of(Succs.begin(), Succs.end(),
+                      [&](const SILSuccessor &S) {
+                        return NoReturn.count(S.getBB());
+                      })) {
+        NoReturn.insert(Pred);
+        Worklist.push_back(Pred);
+      }
+    }
+  }
+}
+
+/// Collect the region dominated by \p Region.Entry and check that it can be
+/// outlined. Every block dominated by a no-return block is itself no-return.
+static bool buildRegion(ColdRegion &Region, DominanceInfo *DT) {
+  SILModule &M = Region.Entry->getModule();
+
+  llvm::SmallVector<DominanceInfoNode *, 16> Worklist;
+  Worklist.push_back(DT->getNode(Region.Entry));
+  while (!Worklist.empty()) {
+    DominanceInfoNode *Node = Worklist.pop_back_val();
+    Region.Blocks.insert(Node->getBlock());
+    Worklist.append(Node->begin(), Node->end());
+  }
+
+  // The region must only be entered through its entry, and it must not
+  // branch to blocks it doesn't contain, e.g. a trap block it shares with
+  // another region.
+  for (SILBasicBlock *BB : Region.Blocks) {
+    for (SILBasicBlock *Pred : BB->getPreds())
+      if (Region.contains(Pred) == (BB == Region.Entry))
+        return false;
+    for (auto &Succ : BB->getSuccessors())
+      if (!Region.contains(Succ.getBB()))
+        return false;
+  }
+
+  for (SILArgument *Arg : Region.Entry->getBBArgs())
+    if (!canPassDirectly(Arg, M))
+      return false;
+
+  unsigned NumInsts = 0;
+  llvm::SmallPtrSet<ValueBase *, 8> NonDebugUses;
+  for (SILBasicBlock *BB : Region.Blocks) {
+    for (auto &I : *BB) {
+      if (I.hasValue() && I.getType().hasArchetype())
+        return false;
+
+      bool IsDebugInst = isa<DebugValueInst>(&I) ||
+                         isa<DebugValueAddrInst>(&I);
+      if (!IsDebugInst)
+        ++NumInsts;
+
+      for (auto &Op : I.getAllOperands()) {
+        SILValue V = Op.get();
+        if (isa<SILUndef>(V))
+          continue;
+        if (Region.contains(V->getParentBB()))
+          continue;
+        if (auto *Literal = dyn_cast<LiteralInst>(V)) {
+          Region.Literals.insert(Literal);
+          continue;
+        }
+        if (IsDebugInst) {
+          Region.DebugOnly.insert(V);
+          continue;
+        }
+        if (!canPassDirectly(V, M))
+          return false;
+        NonDebugUses.insert(V);
+        Region.Captures.insert(V);
+      }
+    }
+  }
+
+  // Debug instructions can still describe values that are passed in anyway.
+  for (ValueBase *V : NonDebugUses)
+    Region.DebugOnly.erase(V);
+
+  return NumInsts >= ColdCodeOutliningThreshold;
+}
+
+/// Create the outlined function for \p Region and replace the region with a
+/// call to it.
+static void outlineRegion(ColdRegion &Region, SILFunction *F,
+                          unsigned Index) {
+  SILModule &M = F->getModule();
+
+  llvm::SmallVector<SILParameterInfo, 8> Params;
+  llvm::SmallVector<SILValue, 8> Args;
+  for (SILArgument *Arg : Region.Entry->getBBArgs())
+    Args.push_back(Arg);
+  for (SILValue Capture : Region.Captures)
+    Args.push_back(Capture);
+  for (SILValue Arg : Args)
+    Params.push_back(SILParameterInfo(Arg->getType().getSwiftRValueType(),
+                                      ParameterConvention::Direct_Unowned));
+
+  auto ExtInfo = SILFunctionType::ExtInfo(SILFunctionTypeRepresentation::Thin,
+                                          /*pseudogeneric*/ false);
+  auto OutlinedTy = SILFunctionType::get(
+      nullptr, ExtInfo, ParameterConvention::Direct_Unowned, Params, {},
+      None, M.getASTContext());
+
+  std::string Name = (F->getName() + "_cold" + llvm::Twine(Index)).str();
+  while (M.lookUpFunction(Name))
+    Name += "_unique_suffix";
+
+  // The name is local to this function, so the body can stay private.
+  auto *Outlined = M.createFunction(
+      SILLinkage::Private, Name, OutlinedTy, nullptr, F->getLocation(),
+      IsBare, IsNotTransparent, IsNotFragile, IsNotThunk,
+      SILFunction::NotRelevant, NoInline, EffectsKind::Unspecified, nullptr,
+      F->getDebugScope(), F->getDeclContext());
+  Outlined->addSemanticsAttr("optimize.cold");
+
+  ColdRegionCloner(*Outlined, Region).populateCloned();
+
+  // Replace the region with the call.
+  SILInstruction *First = &*Region.Entry->begin();
+  SILLocation Loc = First->getLoc();
+  const SILDebugScope *Scope = First->getDebugScope();
+
+  for (SILBasicBlock *BB : Region.Blocks)
+    BB->dropAllReferences();
+  for (SILBasicBlock *BB : Region.Blocks) {
+    if (BB == Region.Entry)
+      continue;
+    BB->eraseFromParent();
+  }
+  while (!Region.Entry->empty())
+    Region.Entry->back().eraseFromParent();
+
+  SILBuilder B(Region.Entry);
+  B.setCurrentDebugScope(Scope);
+  auto *FRI = B.createFunctionRef(Loc, Outlined);
+  B.createApply(Loc, FRI, Args, /*isNonThrowing*/ false);
+  B.createUnreachable(ArtificialUnreachableLocation());
+
+  DEBUG(llvm::dbgs() << "  outlined " << Region.Blocks.size()
+                     << " blocks into " << Name << '\n');
+  ++NumRegionsOutlined;
+}
+
+namespace {
+
+class ColdCodeOutlining : public SILFunctionTransform {
+  void run() override {
+    SILFunction *F = getFunction();
+
+    // Don't outline out of code that is already cold, out of fragile code
+    // whose body might be serialized, or out of generic code.
+    if (F->hasSemanticsAttr("optimize.cold") ||
+        F->hasSemanticsAttr("optimize.sil.never") ||
+        F->isFragile() || F->getGenericEnvironment())
+      return;
+
+    DEBUG(llvm::dbgs() << "*** Cold code outlining on function: "
+                       << F->getName() << " ***\n");
+
+    llvm::SmallPtrSet<SILBasicBlock *, 16> NoReturn;
+    findNoReturnBlocks(*F, NoReturn);
+    if (NoReturn.empty())
+      return;
+
+    // Outline the largest regions: those whose entry's immediate dominator
+    // still returns.
+    DominanceInfo *DT = getAnalysis<DominanceAnalysis>()->get(F);
+    llvm::SmallVector<ColdRegion, 4> Regions;
+    for (auto &BB : *F) {
+      if (&BB == &*F->begin() || !NoReturn.count(&BB))
+        continue;
+      DominanceInfoNode *Node = DT->getNode(&BB);
+      if (!Node || NoReturn.count(Node->getIDom()->getBlock()))
+        continue;
+
+      ColdRegion Region(&BB);
+      if (buildRegion(Region, DT))
+        Regions.push_back(std::move(Region));
+    }
+    if (Regions.empty())
+      return;
+
+    unsigned Index = 0;
+    for (ColdRegion &Region : Regions)
+      outlineRegion(Region, F, Index++);
+
+    invalidateAnalysis(SILAnalysis::InvalidationKind::FunctionBody);
+  }
+
+  StringRef getName() override { return "Cold Code Outlining"; }
+};
+
+} // end anonymous namespace
+
+SILTransform *swift::createColdCodeOutlining() {
+  return new ColdCodeOutlining();
+}
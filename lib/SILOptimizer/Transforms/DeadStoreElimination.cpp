@@ -57,10 +57,12 @@
 //===----------------------------------------------------------------------===//
 
 #define DEBUG_TYPE "sil-dead-store-elim"
+#include "swift/Basic/ClusteredBitVector.h"
 #include "swift/SIL/Projection.h"
 #include "swift/SIL/SILArgument.h"
 #include "swift/SIL/SILBuilder.h"
 #include "swift/SILOptimizer/Analysis/AliasAnalysis.h"
+#include "swift/SILOptimizer/Analysis/LSLocationAnalysis.h"
 #include "swift/SILOptimizer/Analysis/PostOrderAnalysis.h"
 #include "swift/SILOptimizer/PassManager/Passes.h"
 #include "swift/SILOptimizer/PassManager/Transforms.h"
@@ -202,37 +204,37 @@ public:
   /// A bit vector for which the ith bit represents the ith LSLocation in
   /// LocationVault. If the bit is set, then the location currently has an
   /// upward visible store at the end of the basic block.
-  llvm::SmallBitVector BBWriteSetOut;
+  ClusteredBitVector BBWriteSetOut;
 
   /// A bit vector for which the ith bit represents the ith LSLocation in
   /// LocationVault. If the bit is set, then the location currently has an
   /// upward visible store in middle of the basic block.
-  llvm::SmallBitVector BBWriteSetMid;
+  ClusteredBitVector BBWriteSetMid;
 
   /// A bit vector for which the ith bit represents the ith LSLocation in
   /// LocationVault. If a bit in the vector is set, then the location has an
   /// upward visible store at the beginning of the basic block.
-  llvm::SmallBitVector BBWriteSetIn;
+  ClusteredBitVector BBWriteSetIn;
 
   /// A bit vector for which the ith bit represents the ith LSLocation in
   /// LocationVault. If the bit is set, then the current basic block
   /// generates an upward visible store.
-  llvm::SmallBitVector BBGenSet;
+  ClusteredBitVector BBGenSet;
 
   /// A bit vector for which the ith bit represents the ith LSLocation in
   /// LocationVault. If the bit is set, then the current basic block
   /// kills an upward visible store.
-  llvm::SmallBitVector BBKillSet;
+  ClusteredBitVector BBKillSet;
 
   /// A bit vector to keep the maximum number of stores that can reach a 
   /// certain point of the basic block. If a bit is set, that means there is
   /// potentially an upward visible store to the location at the particular
   /// point of the basic block.
-  llvm::SmallBitVector BBMaxStoreSet;
+  ClusteredBitVector BBMaxStoreSet;
 
   /// If a bit in the vector is set, then the location is dead at the end of
   /// this basic block. 
-  llvm::SmallBitVector BBDeallocateLocation;
+  ClusteredBitVector BBDeallocateLocation;
 
   /// The dead stores in the current basic block.
   llvm::DenseSet<SILInstruction *> DeadStores;
@@ -256,12 +258,12 @@ public:
 
   /// Check whether the BBWriteSetIn has changed. If it does, we need to rerun
   /// the data flow on this block's predecessors to reach fixed point.
-  bool updateBBWriteSetIn(llvm::SmallBitVector &X);
+  bool updateBBWriteSetIn(ClusteredBitVector &X);
 
   /// Functions to manipulate the write set.
-  void startTrackingLocation(llvm::SmallBitVector &BV, unsigned bit);
-  void stopTrackingLocation(llvm::SmallBitVector &BV, unsigned bit);
-  bool isTrackingLocation(llvm::SmallBitVector &BV, unsigned bit);
+  void startTrackingLocation(ClusteredBitVector &BV, unsigned bit);
+  void stopTrackingLocation(ClusteredBitVector &BV, unsigned bit);
+  bool isTrackingLocation(ClusteredBitVector &BV, unsigned bit);
 
   /// Set the store bit for stack slot deallocated in this basic block. 
   void initStoreSetAtEndOfBlock(DSEContext &Ctx);
@@ -269,23 +271,23 @@ public:
 
 } // end anonymous namespace
 
-bool BlockState::updateBBWriteSetIn(llvm::SmallBitVector &X) {
+bool BlockState::updateBBWriteSetIn(ClusteredBitVector &X) {
   if (BBWriteSetIn == X)
     return false;
   BBWriteSetIn = X;
   return true;
 }
 
-void BlockState::startTrackingLocation(llvm::SmallBitVector &BV, unsigned i) {
-  BV.set(i);
+void BlockState::startTrackingLocation(ClusteredBitVector &BV, unsigned i) {
+  BV.setBit(i);
 }
 
-void BlockState::stopTrackingLocation(llvm::SmallBitVector &BV, unsigned i) {
-  BV.reset(i);
+void BlockState::stopTrackingLocation(ClusteredBitVector &BV, unsigned i) {
+  BV.clearBit(i);
 }
 
-bool BlockState::isTrackingLocation(llvm::SmallBitVector &BV, unsigned i) {
-  return BV.test(i);
+bool BlockState::isTrackingLocation(ClusteredBitVector &BV, unsigned i) {
+  return BV[i];
 }
 
 //===----------------------------------------------------------------------===//
@@ -328,10 +330,14 @@ private:
   /// Map every basic block to its location state.
   llvm::SmallDenseMap<SILBasicBlock *, BlockState *> BBToLocState;
 
+  /// The locations accessed by the current function, shared with redundant
+  /// load elimination.
+  LSLocationFunctionInfo *LSI;
+
   /// Keeps all the locations for the current function. The BitVector in each
   /// BlockState is then laid on top of it to keep track of which LSLocation
   /// has an upward visible store.
-  std::vector<LSLocation> LocationVault;
+  std::vector<LSLocation> &LocationVault;
 
   /// Keeps a list of basic blocks that have StoreInsts. If a basic block does
   /// not have StoreInst, we do not actually perform the last iteration where
@@ -343,12 +349,8 @@ private:
   /// walked, i.e. when the we generate the genset and killset.
   llvm::DenseSet<SILBasicBlock *> BBWithStores;
 
-  /// Contains a map between location to their index in the LocationVault.
-  /// used to facilitate fast location to index lookup.
-  LSLocationIndexMap LocToBitIndex;
-
   /// Keeps a map between the accessed SILValue and the location.
-  LSLocationBaseMap BaseToLocIndex;
+  LSLocationBaseMap &BaseToLocIndex;
 
   /// Return the BlockState for the basic block this basic block belongs to.
   BlockState *getBlockState(SILBasicBlock *B) { return BBToLocState[B]; }
@@ -426,9 +428,10 @@ public:
   /// Constructor.
   DSEContext(SILFunction *F, SILModule *M, SILPassManager *PM,
              AliasAnalysis *AA, TypeExpansionAnalysis *TE,
-             EpilogueARCFunctionInfo *EAFI,
-             llvm::SpecificBumpPtrAllocator<BlockState> &BPA) 
-    : Mod(M), F(F), PM(PM), AA(AA), TE(TE), EAFI(EAFI), BPA(BPA) {}
+             EpilogueARCFunctionInfo *EAFI, LSLocationFunctionInfo *LSI,
+             llvm::SpecificBumpPtrAllocator<BlockState> &BPA)
+    : Mod(M), F(F), PM(PM), AA(AA), TE(TE), EAFI(EAFI), BPA(BPA), LSI(LSI),
+      LocationVault(LSI->getLocations()), BaseToLocIndex(LSI->getBaseMap()) {}
 
   /// Entry point for dead store elimination.
   bool run();
@@ -480,19 +483,19 @@ void BlockState::init(unsigned LocationNum, bool Optimistic) {
   // However, by doing so, we can only eliminate the dead stores after the
   // data flow stabilizes.
   //
-  BBWriteSetIn.resize(LocationNum, Optimistic);
-  BBWriteSetOut.resize(LocationNum, false);
-  BBWriteSetMid.resize(LocationNum, false);
+  BBWriteSetIn = ClusteredBitVector::getConstant(LocationNum, Optimistic);
+  BBWriteSetOut = ClusteredBitVector::getConstant(LocationNum, false);
+  BBWriteSetMid = ClusteredBitVector::getConstant(LocationNum, false);
 
   // GenSet and KillSet initially empty.
-  BBGenSet.resize(LocationNum, false);
-  BBKillSet.resize(LocationNum, false);
+  BBGenSet = ClusteredBitVector::getConstant(LocationNum, false);
+  BBKillSet = ClusteredBitVector::getConstant(LocationNum, false);
 
   // MaxStoreSet is optimistically set to true initially.
-  BBMaxStoreSet.resize(LocationNum, true);
+  BBMaxStoreSet = ClusteredBitVector::getConstant(LocationNum, true);
 
   // DeallocateLocation initially empty.
-  BBDeallocateLocation.resize(LocationNum, false);
+  BBDeallocateLocation = ClusteredBitVector::getConstant(LocationNum, false);
 }
 
 unsigned DSEContext::getLocationBit(const LSLocation &Loc) {
@@ -501,9 +504,7 @@ unsigned DSEContext::getLocationBit(const LSLocation &Loc) {
   //
   // We should have the location populated by the enumerateLSLocation at this
   // point.
-  auto Iter = LocToBitIndex.find(Loc);
-  assert(Iter != LocToBitIndex.end() && "LSLocation should have been enum'ed");
-  return Iter->second;
+  return LSI->getLocationBit(Loc);
 }
 
 DSEContext::ProcessKind DSEContext::getProcessFunctionKind(unsigned StoreCount) {
@@ -603,7 +604,7 @@ bool DSEContext::processBasicBlockWithGenKillSet(SILBasicBlock *BB) {
   // Compute the BBWriteSet at the beginning of the basic block.
   BlockState *S = getBlockState(BB);
   S->BBWriteSetMid = S->BBWriteSetOut;
-  S->BBWriteSetMid.reset(S->BBKillSet);
+  S->BBWriteSetMid.subtract(S->BBKillSet);
   S->BBWriteSetMid |= S->BBGenSet;
  
   // If BBWriteSetIn changes, then keep iterating until reached a fixed point.
@@ -693,19 +694,15 @@ void DSEContext::mergeSuccessorLiveIns(SILBasicBlock *BB) {
 }
 
 void DSEContext::invalidateBaseForGenKillSet(SILValue B, BlockState *S) {
-  for (unsigned i = 0; i < S->LocationNum; ++i) {
-    if (LocationVault[i].getBase() != B)
-      continue;
+  for (unsigned i : LSI->getLocationBitsWithBase(B)) {
     S->startTrackingLocation(S->BBKillSet, i);
     S->stopTrackingLocation(S->BBGenSet, i);
   }
 }
 
 void DSEContext::invalidateBaseForDSE(SILValue B, BlockState *S) {
-  for (unsigned i = 0; i < S->LocationNum; ++i) {
-    if (!S->BBWriteSetMid.test(i))
-      continue;
-    if (LocationVault[i].getBase() != B)
+  for (unsigned i : LSI->getLocationBitsWithBase(B)) {
+    if (!S->BBWriteSetMid[i])
       continue;
     S->stopTrackingLocation(S->BBWriteSetMid, i);
   }
@@ -752,7 +749,7 @@ void DSEContext::processReadForGenKillSet(BlockState *S, unsigned bit) {
   // alias analysis to determine whether 2 LSLocations are disjointed.
   LSLocation &R = LocationVault[bit];
   for (unsigned i = 0; i < S->LocationNum; ++i) {
-    if (!S->BBMaxStoreSet.test(i))
+    if (!S->BBMaxStoreSet[i])
       continue;
     // Do nothing if the read location NoAlias with the current location.
     LSLocation &L = LocationVault[i];
@@ -883,7 +880,8 @@ void DSEContext::processWrite(SILInstruction *I, SILValue Val, SILValue Mem,
   bool Dead = true;
   LSLocationList Locs;
   LSLocation::expand(L, Mod, Locs, TE);
-  llvm::SmallBitVector V(Locs.size());
+  ClusteredBitVector V =
+      ClusteredBitVector::getConstant(Locs.size(), false);
 
   // Are we computing max store set.
   if (isComputeMaxStoreSet(Kind)) {
@@ -911,8 +909,8 @@ void DSEContext::processWrite(SILInstruction *I, SILValue Val, SILValue Mem,
     // This is the last iteration, compute BBWriteSetOut and perform the dead
     // store elimination.
     if (processWriteForDSE(S, getLocationBit(E)))
-      V.set(idx);
-    Dead &= V.test(idx);
+      V.setBit(idx);
+    Dead &= V[idx];
     ++idx;
   }
 
@@ -932,7 +930,7 @@ void DSEContext::processWrite(SILInstruction *I, SILValue Val, SILValue Mem,
   if (V.any()) {
     // Take out locations that are dead.
     for (unsigned i = 0; i < V.size(); ++i) {
-      if (V.test(i))
+      if (V[i])
         continue;
       // This location is alive.
       Alives.insert(Locs[i]);
@@ -986,7 +984,7 @@ void DSEContext::processDebugValueAddrInstForGenKillSet(SILInstruction *I) {
   BlockState *S = getBlockState(I);
   SILValue Mem = cast<DebugValueAddrInst>(I)->getOperand();
   for (unsigned i = 0; i < S->LocationNum; ++i) {
-    if (!S->BBMaxStoreSet.test(i))
+    if (!S->BBMaxStoreSet[i])
       continue;
     if (AA->isNoAlias(Mem, LocationVault[i].getBase()))
       continue;
@@ -1026,7 +1024,7 @@ void DSEContext::processDebugValueAddrInst(SILInstruction *I, DSEKind Kind) {
 void DSEContext::processUnknownReadInstForGenKillSet(SILInstruction *I) {
   BlockState *S = getBlockState(I);
   for (unsigned i = 0; i < S->LocationNum; ++i) {
-    if (!S->BBMaxStoreSet.test(i))
+    if (!S->BBMaxStoreSet[i])
       continue;
     if (!AA->mayReadFromMemory(I, LocationVault[i].getBase()))
       continue;
@@ -1127,14 +1125,11 @@ void DSEContext::runIterativeDSE() {
 }
 
 bool DSEContext::run() {
-  std::pair<int, int> LSCount = std::make_pair(0, 0);
-  // Walk over the function and find all the locations accessed by
-  // this function.
-  LSLocation::enumerateLSLocations(*F, LocationVault, LocToBitIndex,
-                                   BaseToLocIndex, TE, LSCount);
-
+  // The locations accessed by this function have already been enumerated by
+  // the LSLocationAnalysis.
+  //
   // Check how to optimize this function.
-  ProcessKind Kind = getProcessFunctionKind(LSCount.second);
+  ProcessKind Kind = getProcessFunctionKind(LSI->getStoreCount());
   
   // We do not optimize this function at all.
   if (Kind == ProcessKind::ProcessNone)
@@ -1226,11 +1221,12 @@ public:
     auto *AA = PM->getAnalysis<AliasAnalysis>();
     auto *TE = PM->getAnalysis<TypeExpansionAnalysis>();
     auto *EAFI = PM->getAnalysis<EpilogueARCAnalysis>()->get(F);
+    auto *LSI = PM->getAnalysis<LSLocationAnalysis>()->get(F);
 
     // The allocator we are using.
     llvm::SpecificBumpPtrAllocator<BlockState> BPA;
 
-    DSEContext DSE(F, &F->getModule(), PM, AA, TE, EAFI, BPA);
+    DSEContext DSE(F, &F->getModule(), PM, AA, TE, EAFI, LSI, BPA);
     if (DSE.run()) {
       invalidateAnalysis(SILAnalysis::InvalidationKind::Instructions);
     }
@@ -104,8 +104,12 @@ bool Devirtualizer::devirtualizeAppliesInFunction(SILFunction &F,
     // everything we reference from the stdlib. After we do that we
     // can move the notification code below back into the main loop
     // above.
-    if (!CalleeFn->isDefinition())
-      F.getModule().linkFunction(CalleeFn, SILModule::LinkingMode::LinkAll);
+    if (!CalleeFn->isDefinition()) {
+      auto Mode = F.getModule().getOptions().LinkOnDemand
+                      ? SILModule::LinkingMode::LinkNormal
+                      : SILModule::LinkingMode::LinkAll;
+      F.getModule().linkFunction(CalleeFn, Mode);
+    }
 
     // We may not have optimized these functions yet, and it could
     // be beneficial to rerun some earlier passes on the current
@@ -24,9 +24,6 @@
 ///
 /// TODO: Optimize function with generic parameters.
 ///
-/// TODO: Improve epilogue release matcher, i.e. do a data flow instead of
-/// only finding releases in the return block. 
-///
 //===----------------------------------------------------------------------===//
 
 #define DEBUG_TYPE "sil-function-signature-opt"
@@ -601,6 +598,65 @@ void FunctionSignatureTransform::DeadArgumentFinalizeOptimizedFunction() {
 /// ----------------------------------------------------------///
 /// Owned to Guaranteed transformation.                       ///
 /// ----------------------------------------------------------///
+
+/// Find the releases of \p Arg if exactly one of them is executed on every
+/// path from the entry to a return or throw. This is the case if the argument
+/// is released before the epilogue, e.g. because its last use is on a path
+/// that returns early. The releases can then be removed and the argument made
+/// @guaranteed, like with releases in the epilogue. Releasing later is always
+/// allowed.
+static bool findReleasesOnAllPaths(SILArgument *Arg, SILFunction *F,
+                                   RCIdentityFunctionInfo *RCFI,
+                                   ReleaseList &Releases) {
+  llvm::SmallDenseMap<SILBasicBlock *, SILInstruction *, 8> ReleaseInBlock;
+  for (auto &BB : *F) {
+    for (auto &I : BB) {
+      if (!isa<StrongReleaseInst>(&I) && !isa<ReleaseValueInst>(&I))
+        continue;
+      if (RCFI->getRCIdentityRoot(I.getOperand(0)) != Arg)
+        continue;
+      // Two releases in the same block are released on the same path.
+      if (!ReleaseInBlock.insert({&BB, &I}).second)
+        return false;
+    }
+  }
+  if (ReleaseInBlock.empty())
+    return false;
+
+  // Propagate whether the argument has been released at block entry. Each
+  // block must be reached with the same state on all paths. This also rules
+  // out releases in loops.
+  llvm::SmallDenseMap<SILBasicBlock *, bool, 16> ReleasedAtEntry;
+  llvm::SmallVector<SILBasicBlock *, 16> Worklist;
+  ReleasedAtEntry[&*F->begin()] = false;
+  Worklist.push_back(&*F->begin());
+  while (!Worklist.empty()) {
+    SILBasicBlock *BB = Worklist.pop_back_val();
+    bool Released = ReleasedAtEntry[BB];
+    if (ReleaseInBlock.count(BB)) {
+      if (Released)
+        return false;
+      Released = true;
+    }
+
+    TermInst *Term = BB->getTerminator();
+    if ((isa<ReturnInst>(Term) || isa<ThrowInst>(Term)) && !Released)
+      return false;
+
+    for (auto &Succ : Term->getSuccessors()) {
+      auto Entry = ReleasedAtEntry.insert({Succ.getBB(), Released});
+      if (Entry.second)
+        Worklist.push_back(Succ.getBB());
+      else if (Entry.first->second != Released)
+        return false;
+    }
+  }
+
+  for (auto &Entry : ReleaseInBlock)
+    Releases.push_back(Entry.second);
+  return true;
+}
+
 bool FunctionSignatureTransform::OwnedToGuaranteedAnalyzeParameters() {
   ArrayRef<SILArgument *> Args = F->begin()->getBBArgs();
   // A map from consumed SILArguments to the release associated with an
@@ -637,6 +693,16 @@ bool FunctionSignatureTransform::OwnedToGuaranteedAnalyzeParameters() {
           SignatureOptimize = true;
         }
       }
+
+      // Otherwise look for releases before the epilogue.
+      ReleaseList ReleasesOnAllPaths;
+      if (!A.OwnedToGuaranteed &&
+          findReleasesOnAllPaths(A.Arg, F, RCIA->get(F), ReleasesOnAllPaths)) {
+        A.CalleeRelease = ReleasesOnAllPaths;
+        A.CalleeReleaseInThrowBlock.clear();
+        A.OwnedToGuaranteed = true;
+        SignatureOptimize = true;
+      }
     }
 
     // Modified self argument.
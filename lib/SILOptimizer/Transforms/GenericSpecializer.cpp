@@ -19,6 +19,7 @@
 
 #include "swift/SIL/SILFunction.h"
 #include "swift/SIL/SILInstruction.h"
+#include "swift/SILOptimizer/Analysis/DominanceAnalysis.h"
 #include "swift/SILOptimizer/Utils/Generics.h"
 #include "swift/SILOptimizer/Utils/Local.h"
 #include "swift/SILOptimizer/PassManager/Transforms.h"
@@ -51,8 +52,23 @@ bool GenericSpecializer::specializeAppliesInFunction(SILFunction &F) {
   DeadInstructionSet DeadApplies;
   llvm::SmallSetVector<SILInstruction *, 8> Applies;
 
+  // Don't specialize calls that never ran in the profile. Find them before
+  // specializing anything, since that can change the CFG.
+  llvm::SmallPtrSet<SILBasicBlock *, 8> ColdBlocks;
+  if (F.getEntryCount()) {
+    DominanceInfo *DT = getAnalysis<DominanceAnalysis>()->get(&F);
+    for (auto &BB : F) {
+      auto Count = getProfileCount(&BB, DT);
+      if (Count && *Count == 0)
+        ColdBlocks.insert(&BB);
+    }
+  }
+
   bool Changed = false;
   for (auto &BB : F) {
+    if (ColdBlocks.count(&BB))
+      continue;
+
     // Collect the applies for this block in reverse order so that we
     // can pop them off the end of our vector and process them in
     // forward order.
@@ -68,6 +84,10 @@ bool GenericSpecializer::specializeAppliesInFunction(SILFunction &F) {
         continue;
 
       auto *Callee = Apply.getReferencedFunction();
+      if (Callee && Callee->isExternalDeclaration() &&
+          F.getModule().getOptions().LinkOnDemand)
+        F.getModule().linkFunction(Callee,
+                                   SILModule::LinkingMode::LinkNormal);
       if (!Callee || !Callee->isDefinition())
         continue;
 
@@ -0,0 +1,128 @@
+//===--- GuaranteedARCOpts.cpp - Remove ARC of guaranteed arguments -------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Remove retain/release pairs of @guaranteed function arguments.
+//
+// SILGen copies a guaranteed argument into each local that is initialized
+// from it, which ends up as a retain/release pair around the local's uses:
+//
+//   bb0(%0 : $Foo):
+//     strong_retain %0 : $Foo
+//     %1 = apply %f(%0) : $@convention(thin) (@guaranteed Foo) -> ()
+//     strong_release %0 : $Foo
+//
+// The caller keeps the argument alive over the whole call of the function,
+// so the borrow scope of the local is nested in the scope of the argument.
+// The retain then can't keep the object alive any longer than it is alive
+// anyway, and the pair can be removed, even if the code in between contains
+// calls which may release the object. Only code which observes the reference
+// count, like a uniqueness check, sees the difference.
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "guaranteed-arc-opts"
+#include "swift/SILOptimizer/PassManager/Passes.h"
+#include "swift/SIL/SILArgument.h"
+#include "swift/SIL/SILFunction.h"
+#include "swift/SIL/SILInstruction.h"
+#include "swift/SILOptimizer/Analysis/ARCAnalysis.h"
+#include "swift/SILOptimizer/Analysis/RCIdentityAnalysis.h"
+#include "swift/SILOptimizer/PassManager/Transforms.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/Debug.h"
+
+using namespace swift;
+
+STATISTIC(NumRetainReleasePairsRemoved,
+          "Number of retain/release pairs of guaranteed arguments removed");
+
+/// Returns true if \p Root is a function argument which the caller keeps alive
+/// over the whole function.
+static bool isGuaranteedArgument(SILValue Root) {
+  auto *Arg = dyn_cast<SILArgument>(Root);
+  return Arg && Arg->isFunctionArg() &&
+         Arg->hasConvention(SILArgumentConvention::Direct_Guaranteed);
+}
+
+static bool removeGuaranteedArgumentPairs(SILBasicBlock &BB,
+                                          RCIdentityFunctionInfo *RCFI) {
+  // The retains of each guaranteed argument which are not paired yet.
+  llvm::SmallDenseMap<SILValue, SmallVector<SILInstruction *, 2>, 4> Retains;
+  bool Changed = false;
+
+  for (auto It = BB.begin(), End = BB.end(); It != End;) {
+    SILInstruction *I = &*It;
+    ++It;
+
+    // Pairs must not be removed across code which observes the reference
+    // count of the argument.
+    if (mayCheckRefCount(I)) {
+      Retains.clear();
+      continue;
+    }
+
+    bool IsRetain = isa<StrongRetainInst>(I) || isa<RetainValueInst>(I);
+    bool IsRelease = isa<StrongReleaseInst>(I) || isa<ReleaseValueInst>(I);
+    if (!IsRetain && !IsRelease)
+      continue;
+
+    SILValue Root = RCFI->getRCIdentityRoot(I->getOperand(0));
+    if (!isGuaranteedArgument(Root))
+      continue;
+
+    if (IsRetain) {
+      Retains[Root].push_back(I);
+      continue;
+    }
+
+    auto Iter = Retains.find(Root);
+    if (Iter == Retains.end() || Iter->second.empty())
+      continue;
+
+    SILInstruction *Retain = Iter->second.pop_back_val();
+    DEBUG(llvm::dbgs() << "  removing " << *Retain << "  and " << *I);
+    Retain->eraseFromParent();
+    I->eraseFromParent();
+    ++NumRetainReleasePairsRemoved;
+    Changed = true;
+  }
+  return Changed;
+}
+
+namespace {
+
+class GuaranteedARCOpts : public SILFunctionTransform {
+
+  void run() override {
+    if (!getOptions().EnableARCOptimizations)
+      return;
+
+    SILFunction *F = getFunction();
+    auto *RCFI = getAnalysis<RCIdentityAnalysis>()->get(F);
+
+    bool Changed = false;
+    for (auto &BB : *F)
+      Changed |= removeGuaranteedArgumentPairs(BB, RCFI);
+
+    if (Changed)
+      invalidateAnalysis(SILAnalysis::InvalidationKind::Instructions);
+  }
+
+  StringRef getName() override { return "Guaranteed ARC Opts"; }
+};
+
+} // end anonymous namespace
+
+SILTransform *swift::createGuaranteedARCOpts() {
+  return new GuaranteedARCOpts();
+}
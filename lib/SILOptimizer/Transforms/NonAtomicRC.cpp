@@ -0,0 +1,129 @@
+//===--- NonAtomicRC.cpp - Use non-atomic RC for thread-local objects -----===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#define DEBUG_TYPE "nonatomic-rc"
+#include "swift/SILOptimizer/PassManager/Passes.h"
+#include "swift/SILOptimizer/PassManager/Transforms.h"
+#include "swift/SILOptimizer/Analysis/EscapeAnalysis.h"
+#include "swift/SIL/InstructionUtils.h"
+#include "swift/SIL/SILInstruction.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Support/Debug.h"
+
+STATISTIC(NumNonAtomicRC, "Number of reference counting instructions made "
+                          "non-atomic");
+
+using namespace swift;
+
+/// Makes reference counting operations on thread-local objects non-atomic.
+///
+/// An object which is allocated in a function and does not escape from it,
+/// neither to memory which other threads can reach (globals, class
+/// properties, escaping closure contexts) nor via the return value or
+/// arguments, can only be referenced from the allocating thread. Its
+/// reference count can therefore be manipulated with the non-atomic runtime
+/// entry points.
+///
+/// This uses the same criterion as StackPromotion, but also applies to
+/// objects whose lifetime StackPromotion cannot bound.
+class NonAtomicRCTransformer {
+  SILFunction *F;
+  EscapeAnalysis::ConnectionGraph *ConGraph;
+  EscapeAnalysis *EA;
+
+  /// Returns true if the object referenced by \p V can only be reached from
+  /// the current thread.
+  bool isThreadLocal(SILValue V);
+
+public:
+  NonAtomicRCTransformer(SILFunction *F,
+                         EscapeAnalysis::ConnectionGraph *ConGraph,
+                         EscapeAnalysis *EA)
+    : F(F), ConGraph(ConGraph), EA(EA) {}
+
+  /// Returns true if any instruction was changed.
+  bool run();
+};
+
+bool NonAtomicRCTransformer::isThreadLocal(SILValue V) {
+  // Only consider objects allocated in this function. Non-aliasing
+  // arguments are local to the function as well, but the caller may have
+  // shared their objects with other threads.
+  if (!isa<AllocRefInst>(getUnderlyingObject(V)))
+    return false;
+
+  auto *Node = ConGraph->getNodeOrNull(V, EA);
+  if (!Node)
+    return false;
+  return !Node->escapes();
+}
+
+bool NonAtomicRCTransformer::run() {
+  bool Changed = false;
+  for (SILBasicBlock &BB : *F) {
+    for (SILInstruction &I : BB) {
+      auto *RCI = dyn_cast<RefCountingInst>(&I);
+      if (!RCI || RCI->isNonAtomic())
+        continue;
+
+      switch (RCI->getKind()) {
+      case ValueKind::StrongRetainInst:
+      case ValueKind::StrongReleaseInst:
+      case ValueKind::RetainValueInst:
+      case ValueKind::ReleaseValueInst:
+        break;
+      default:
+        continue;
+      }
+
+      if (!isThreadLocal(RCI->getOperand(0)))
+        continue;
+
+      DEBUG(llvm::dbgs() << "    make non-atomic: " << *RCI);
+      RCI->setNonAtomic();
+      ++NumNonAtomicRC;
+      Changed = true;
+    }
+  }
+  return Changed;
+}
+
+namespace {
+
+class NonAtomicRC : public SILFunctionTransform {
+
+public:
+  NonAtomicRC() {}
+
+private:
+  /// The entry point to the transformation.
+  void run() override {
+    DEBUG(llvm::dbgs() << "** NonAtomicRC **\n");
+
+    auto *EA = PM->getAnalysis<EscapeAnalysis>();
+
+    SILFunction *F = getFunction();
+    if (auto *ConGraph = EA->getConnectionGraph(F)) {
+      if (NonAtomicRCTransformer(F, ConGraph, EA).run()) {
+        invalidateAnalysis(SILAnalysis::InvalidationKind::Instructions);
+      }
+    }
+  }
+
+  StringRef getName() override { return "NonAtomicRC"; }
+};
+
+} // end anonymous namespace
+
+SILTransform *swift::createNonAtomicRC() {
+  return new NonAtomicRC();
+}
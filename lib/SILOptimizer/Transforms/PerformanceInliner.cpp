@@ -1048,7 +1048,8 @@ class SILPerformanceInliner {
   bool isProfitableToInline(FullApplySite AI,
                             Weight CallerWeight,
                             ConstantTracker &constTracker,
-                            int &NumCallerBlocks);
+                            int &NumCallerBlocks,
+                            bool IsHotCallSite);
 
   bool isProfitableInColdBlock(FullApplySite AI, SILFunction *Callee);
 
@@ -1105,13 +1106,18 @@ SILFunction *SILPerformanceInliner::getEligibleFunction(FullApplySite AI) {
     }
   }
 
-  // We can't inline external declarations.
-  if (Callee->empty() || Callee->isExternalDeclaration()) {
+  // Explicitly disabled inlining.
+  if (Callee->getInlineStrategy() == NoInline) {
     return nullptr;
   }
 
-  // Explicitly disabled inlining.
-  if (Callee->getInlineStrategy() == NoInline) {
+  // If imported bodies are linked on demand, this is where one is needed.
+  SILModule &M = Callee->getModule();
+  if (Callee->isExternalDeclaration() && M.getOptions().LinkOnDemand)
+    M.linkFunction(Callee, SILModule::LinkingMode::LinkNormal);
+
+  // We can't inline external declarations.
+  if (Callee->empty() || Callee->isExternalDeclaration()) {
     return nullptr;
   }
   
@@ -1172,7 +1178,8 @@ SILFunction *SILPerformanceInliner::getEligibleFunction(FullApplySite AI) {
 bool SILPerformanceInliner::isProfitableToInline(FullApplySite AI,
                                               Weight CallerWeight,
                                               ConstantTracker &callerTracker,
-                                              int &NumCallerBlocks) {
+                                              int &NumCallerBlocks,
+                                              bool IsHotCallSite) {
   SILFunction *Callee = AI.getReferencedFunction();
 
   if (Callee->getInlineStrategy() == AlwaysInline)
@@ -1200,6 +1207,10 @@ bool SILPerformanceInliner::isProfitableToInline(FullApplySite AI,
   if (Opts.Optimization == SILOptions::SILOptMode::OptimizeUnchecked)
     BaseBenefit *= 2;
 
+  // Profile data says this call site runs often, so accept a bigger callee.
+  if (IsHotCallSite)
+    BaseBenefit *= 2;
+
   CallerWeight.updateBenefit(Benefit, BaseBenefit);
 
   // Go through all blocks of the function, accumulate the cost and find
@@ -1391,6 +1402,7 @@ void SILPerformanceInliner::collectAppliesToInline(
   while (SILBasicBlock *block = domOrder.getNext()) {
     constTracker.beginBlock();
     Weight BlockWeight;
+    Optional<uint64_t> BlockCount = getProfileCount(block, DT);
 
     for (auto I = block->begin(), E = block->end(); I != E; ++I) {
       constTracker.trackInst(&*I);
@@ -1402,13 +1414,23 @@ void SILPerformanceInliner::collectAppliesToInline(
 
       auto *Callee = getEligibleFunction(AI);
       if (Callee) {
+        // If the profile says this call never ran, treat it like a call in a
+        // cold block.
+        if (BlockCount && *BlockCount == 0) {
+          if (isProfitableInColdBlock(AI, Callee))
+            InitialCandidates.push_back(AI);
+          continue;
+        }
+
         if (!BlockWeight.isValid())
           BlockWeight = SPA->getWeight(block, Weight(0, 0));
 
         // The actual weight including a possible weight correction.
         Weight W(BlockWeight, WeightCorrections.lookup(AI));
 
-        if (isProfitableToInline(AI, W, constTracker, NumCallerBlocks))
+        bool IsHot = BlockCount &&
+                     isHotProfileCount(Caller->getModule(), *BlockCount);
+        if (isProfitableToInline(AI, W, constTracker, NumCallerBlocks, IsHot))
           InitialCandidates.push_back(AI);
       }
     }
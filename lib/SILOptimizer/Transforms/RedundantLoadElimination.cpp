@@ -73,12 +73,14 @@
 //===----------------------------------------------------------------------===//
 
 #define DEBUG_TYPE "sil-redundant-load-elim"
+#include "swift/Basic/ClusteredBitVector.h"
 #include "swift/SIL/Projection.h"
 #include "swift/SIL/SILArgument.h"
 #include "swift/SIL/SILBuilder.h"
 #include "swift/SILOptimizer/Analysis/AliasAnalysis.h"
 #include "swift/SILOptimizer/Analysis/ARCAnalysis.h"
 #include "swift/SILOptimizer/Analysis/DominanceAnalysis.h"
+#include "swift/SILOptimizer/Analysis/LSLocationAnalysis.h"
 #include "swift/SILOptimizer/Analysis/PostOrderAnalysis.h"
 #include "swift/SILOptimizer/Analysis/ValueTracking.h"
 #include "swift/SILOptimizer/PassManager/Passes.h"
@@ -205,27 +207,27 @@ private:
   /// A bit vector for which the ith bit represents the ith LSLocation in
   /// LocationVault. If the bit is set, then the location currently has an
   /// downward visible value at the beginning of the basic block.
-  llvm::SmallBitVector ForwardSetIn;
+  ClusteredBitVector ForwardSetIn;
 
   /// A bit vector for which the ith bit represents the ith LSLocation in
   /// LocationVault. If the bit is set, then the location currently has an
   /// downward visible value at the end of the basic block.
-  llvm::SmallBitVector ForwardSetOut;
+  ClusteredBitVector ForwardSetOut;
 
   /// A bit vector for which the ith bit represents the ith LSLocation in
   /// LocationVault. If we ignore all unknown write, what's the maximum set
   /// of available locations at the current position in the basic block.
-  llvm::SmallBitVector ForwardSetMax;
+  ClusteredBitVector ForwardSetMax;
 
   /// A bit vector for which the ith bit represents the ith LSLocation in
   /// LocationVault. If the bit is set, then the basic block generates a
   /// value for the location.
-  llvm::SmallBitVector BBGenSet;
+  ClusteredBitVector BBGenSet;
 
   /// A bit vector for which the ith bit represents the ith LSLocation in
   /// LocationVault. If the bit is set, then the basic block kills the
   /// value for the location.
-  llvm::SmallBitVector BBKillSet;
+  ClusteredBitVector BBKillSet;
 
   /// This is map between LSLocations and their available values at the
   /// beginning of this basic block.
@@ -273,9 +275,9 @@ private:
                     SILValue Val, RLEKind Kind);
 
   /// BitVector manipulation functions.
-  void startTrackingLocation(llvm::SmallBitVector &BV, unsigned B);
-  void stopTrackingLocation(llvm::SmallBitVector &BV, unsigned B);
-  bool isTrackingLocation(llvm::SmallBitVector &BV, unsigned B);
+  void startTrackingLocation(ClusteredBitVector &BV, unsigned B);
+  void stopTrackingLocation(ClusteredBitVector &BV, unsigned B);
+  bool isTrackingLocation(ClusteredBitVector &BV, unsigned B);
   void startTrackingValue(ValueTableMap &VM, unsigned L, unsigned V);
   void stopTrackingValue(ValueTableMap &VM, unsigned B);
 
@@ -306,15 +308,15 @@ public:
     // unreachable block.
     //
     // we rely on other passes to clean up unreachable block.
-    ForwardSetIn.resize(LocationNum, false);
-    ForwardSetOut.resize(LocationNum, optimistic);
+    ForwardSetIn = ClusteredBitVector::getConstant(LocationNum, false);
+    ForwardSetOut = ClusteredBitVector::getConstant(LocationNum, optimistic);
 
     // If we are running an optimistic data flow, set forward max to true
     // initially.
-    ForwardSetMax.resize(LocationNum, optimistic);
+    ForwardSetMax = ClusteredBitVector::getConstant(LocationNum, optimistic);
 
-    BBGenSet.resize(LocationNum, false);
-    BBKillSet.resize(LocationNum, false);
+    BBGenSet = ClusteredBitVector::getConstant(LocationNum, false);
+    BBKillSet = ClusteredBitVector::getConstant(LocationNum, false);
   }
 
   /// Initialize the AvailSetMax by intersecting this basic block's
@@ -443,17 +445,17 @@ private:
   /// Epilogue release analysis.
   EpilogueARCFunctionInfo *EAFI;
 
+  /// The locations accessed by the current function, shared with dead store
+  /// elimination.
+  LSLocationFunctionInfo *LSI;
+
   /// Keeps all the locations for the current function. The BitVector in each
   /// BlockState is then laid on top of it to keep track of which LSLocation
   /// has a downward available value.
-  std::vector<LSLocation> LocationVault;
-
-  /// Contains a map between LSLocation to their index in the LocationVault.
-  /// Use for fast lookup.
-  LSLocationIndexMap LocToBitIndex;
+  std::vector<LSLocation> &LocationVault;
 
   /// Keeps a map between the accessed SILValue and the location.
-  LSLocationBaseMap BaseToLocIndex;
+  LSLocationBaseMap &BaseToLocIndex;
 
   /// Keeps all the loadstorevalues for the current function. The BitVector in
   /// each g is then laid on top of it to keep track of which LSLocation
@@ -480,7 +482,7 @@ private:
 public:
   RLEContext(SILFunction *F, SILPassManager *PM, AliasAnalysis *AA,
              TypeExpansionAnalysis *TE, PostOrderFunctionInfo *PO,
-             EpilogueARCFunctionInfo *EAFI);
+             EpilogueARCFunctionInfo *EAFI, LSLocationFunctionInfo *LSI);
 
   RLEContext(const RLEContext &) = delete;
   RLEContext(RLEContext &&) = default;
@@ -557,21 +559,21 @@ void BlockState::stopTrackingValue(ValueTableMap &VM, unsigned B) {
   VM.erase(B);
 }
  
-bool BlockState::isTrackingLocation(llvm::SmallBitVector &BV, unsigned B) {
-  return BV.test(B);
+bool BlockState::isTrackingLocation(ClusteredBitVector &BV, unsigned B) {
+  return BV[B];
 }
  
-void BlockState::startTrackingLocation(llvm::SmallBitVector &BV, unsigned B) {
-  BV.set(B);
+void BlockState::startTrackingLocation(ClusteredBitVector &BV, unsigned B) {
+  BV.setBit(B);
 }
  
-void BlockState::stopTrackingLocation(llvm::SmallBitVector &BV, unsigned B) {
-  BV.reset(B);
+void BlockState::stopTrackingLocation(ClusteredBitVector &BV, unsigned B) {
+  BV.clearBit(B);
 }
 
 void BlockState::mergePredecessorsAvailSetMax(RLEContext &Ctx) {
   if (BB->pred_empty()) {
-    ForwardSetMax.reset();
+    ForwardSetMax.clearAll();
     return;
   }
 
@@ -586,7 +588,7 @@ void BlockState::mergePredecessorsAvailSetMax(RLEContext &Ctx) {
 void BlockState::mergePredecessorAvailSet(RLEContext &Ctx) {
   // Clear the state if the basic block has no predecessor.
   if (BB->getPreds().begin() == BB->getPreds().end()) {
-    ForwardSetIn.reset();
+    ForwardSetIn.clearAll();
     return;
   }
 
@@ -601,7 +603,7 @@ void BlockState::mergePredecessorAvailSet(RLEContext &Ctx) {
 void BlockState::mergePredecessorAvailSetAndValue(RLEContext &Ctx) {
   // Clear the state if the basic block has no predecessor.
   if (BB->getPreds().begin() == BB->getPreds().end()) {
-    ForwardSetIn.reset();
+    ForwardSetIn.clearAll();
     ForwardValIn.clear();
     return;
   }
@@ -638,7 +640,7 @@ void BlockState::processBasicBlockWithKind(RLEContext &Ctx, RLEKind Kind) {
 }
 
 bool BlockState::processBasicBlockWithGenKillSet() {
-  ForwardSetIn.reset(BBKillSet);
+  ForwardSetIn.subtract(BBKillSet);
   ForwardSetIn |= BBGenSet;
   return updateForwardSetOut();
 }
@@ -1127,8 +1129,10 @@ getProcessFunctionKind(unsigned LoadCount, unsigned StoreCount) {
 
 RLEContext::RLEContext(SILFunction *F, SILPassManager *PM, AliasAnalysis *AA,
                        TypeExpansionAnalysis *TE, PostOrderFunctionInfo *PO,
-                       EpilogueARCFunctionInfo *EAFI)
-    : Fn(F), PM(PM), AA(AA), TE(TE), PO(PO), EAFI(EAFI) {
+                       EpilogueARCFunctionInfo *EAFI,
+                       LSLocationFunctionInfo *LSI)
+    : Fn(F), PM(PM), AA(AA), TE(TE), PO(PO), EAFI(EAFI), LSI(LSI),
+      LocationVault(LSI->getLocations()), BaseToLocIndex(LSI->getBaseMap()) {
 }
 
 LSLocation &RLEContext::getLocation(const unsigned index) {
@@ -1141,9 +1145,7 @@ unsigned RLEContext::getLocationBit(const LSLocation &Loc) {
   //
   // We should have the location populated by the enumerateLSLocation at this
   // point.
-  auto Iter = LocToBitIndex.find(Loc);
-  assert(Iter != LocToBitIndex.end() && "Location should have been enum'ed");
-  return Iter->second;
+  return LSI->getLocationBit(Loc);
 }
 
 LSValue &RLEContext::getValue(const unsigned index) {
@@ -1444,16 +1446,13 @@ bool RLEContext::run() {
   // Phase 3. we compute the real forwardable value at a given point.
   //
   // Phase 4. we perform the redundant load elimination.
-  // Walk over the function and find all the locations accessed by
-  // this function.
-  std::pair<int, int> LSCount = std::make_pair(0, 0); 
-  LSLocation::enumerateLSLocations(*Fn, LocationVault,
-                                   LocToBitIndex,
-                                   BaseToLocIndex, TE,
-                                   LSCount);
+  //
+  // The locations accessed by this function have already been enumerated by
+  // the LSLocationAnalysis.
 
   // Check how to optimize this function.
-  ProcessKind Kind = getProcessFunctionKind(LSCount.first, LSCount.second);
+  ProcessKind Kind = getProcessFunctionKind(LSI->getLoadCount(),
+                                            LSI->getStoreCount());
   
   // We do not optimize this function at all.
   if (Kind == ProcessKind::ProcessNone)
@@ -1545,8 +1544,9 @@ class RedundantLoadElimination : public SILFunctionTransform {
     auto *TE = PM->getAnalysis<TypeExpansionAnalysis>();
     auto *PO = PM->getAnalysis<PostOrderAnalysis>()->get(F);
     auto *EAFI = PM->getAnalysis<EpilogueARCAnalysis>()->get(F);
+    auto *LSI = PM->getAnalysis<LSLocationAnalysis>()->get(F);
 
-    RLEContext RLE(F, PM, AA, TE, PO, EAFI);
+    RLEContext RLE(F, PM, AA, TE, PO, EAFI, LSI);
     if (RLE.run()) {
       invalidateAnalysis(SILAnalysis::InvalidationKind::Instructions);
     }
@@ -37,6 +37,8 @@ using namespace swift;
 STATISTIC(NumBlocksDeleted, "Number of unreachable blocks removed");
 STATISTIC(NumBlocksMerged, "Number of blocks merged together");
 STATISTIC(NumJumpThreads, "Number of jumps threaded");
+STATISTIC(NumJumpThreadsOverBudget,
+          "Number of jumps not threaded because the function grew too much");
 STATISTIC(NumTermBlockSimplified, "Number of programterm block simplified");
 STATISTIC(NumConstantFolded, "Number of terminators constant folded");
 STATISTIC(NumDeadArguments, "Number of unused arguments removed");
@@ -54,6 +56,20 @@ STATISTIC(NumSROAArguments, "Number of aggregate argument levels split by "
 ///
 static unsigned MaxIterationsOfDominatorBasedSimplify = 10;
 
+/// Jump threading duplicates blocks, and each threaded block can expose more
+/// threading opportunities. To keep that from growing a function without
+/// bound, one run of SimplifyCFG may only duplicate this percentage of the
+/// instructions the function had when the run started...
+static llvm::cl::opt<unsigned>
+JumpThreadingGrowthPercent("sil-jump-threading-growth", llvm::cl::init(100),
+                           llvm::cl::Hidden);
+
+/// ...but at least this many instructions, so that small functions are not
+/// penalized.
+static llvm::cl::opt<unsigned>
+MinJumpThreadingBudget("sil-min-jump-threading-budget", llvm::cl::init(256),
+                       llvm::cl::Hidden);
+
 namespace {
   class SimplifyCFG {
     SILFunction &Fn;
@@ -73,6 +89,10 @@ namespace {
 
     bool ShouldVerify;
     bool EnableJumpThread;
+
+    // The number of instructions jump threading may still duplicate in this
+    // run.
+    unsigned ThreadingBudget = 0;
   public:
     SimplifyCFG(SILFunction &Fn, SILPassManager *PM, bool Verify,
                 bool EnableJumpThread)
@@ -141,6 +161,18 @@ namespace {
         LoopHeaders.erase(BB);
     }
 
+    /// Charge the duplication of \p BB to the threading budget. Returns
+    /// false, without charging anything, if there is not enough left.
+    bool consumeThreadingBudget(SILBasicBlock *BB) {
+      unsigned Size = std::distance(BB->begin(), BB->end());
+      if (Size > ThreadingBudget) {
+        ++NumJumpThreadsOverBudget;
+        return false;
+      }
+      ThreadingBudget -= Size;
+      return true;
+    }
+
     bool simplifyBlocks();
     bool canonicalizeSwitchEnums();
     bool simplifyThreadedTerminators();
@@ -311,6 +343,8 @@ public:
 
   ThreadInfo() = default;
 
+  SILBasicBlock *getDest() const { return Dest; }
+
   void threadEdge() {
     DEBUG(llvm::dbgs() << "thread edge from bb" << Src->getDebugID() <<
           " to bb" << Dest->getDebugID() << '\n');
@@ -588,6 +622,8 @@ bool SimplifyCFG::dominatorBasedSimplifications(SILFunction &Fn,
     return Changed;
 
   for (auto &ThreadInfo : JumpThreadableEdges) {
+    if (!consumeThreadingBudget(ThreadInfo.getDest()))
+      continue;
     ThreadInfo.threadEdge();
     Changed = true;
   }
@@ -662,7 +698,8 @@ bool SimplifyCFG::dominatorBasedSimplify(DominanceAnalysis *DA) {
     // Do dominator based simplification of terminator condition. This does not
     // and MUST NOT change the CFG without updating the dominator tree to
     // reflect such change.
-    if (tryCheckedCastBrJumpThreading(&Fn, DT, BlocksForWorklist)) {
+    if (tryCheckedCastBrJumpThreading(&Fn, DT, BlocksForWorklist,
+                                      ThreadingBudget)) {
       for (auto BB: BlocksForWorklist)
         addToWorklist(BB);
 
@@ -957,6 +994,9 @@ bool SimplifyCFG::tryJumpThreading(BranchInst *BI) {
   if (!isa<SwitchEnumInst>(DestBB->getTerminator()) && DestIsLoopHeader)
     return false;
 
+  if (!consumeThreadingBudget(DestBB))
+    return false;
+
   DEBUG(llvm::dbgs() << "jump thread from bb" << SrcBB->getDebugID() <<
         " to bb" << DestBB->getDebugID() << '\n');
 
@@ -2721,6 +2761,12 @@ bool SimplifyCFG::run() {
   // Find the set of loop headers. We don't want to jump-thread through headers.
   findLoopHeaders();
 
+  unsigned NumInsts = 0;
+  for (auto &BB : Fn)
+    NumInsts += std::distance(BB.begin(), BB.end());
+  ThreadingBudget = std::max(NumInsts / 100 * JumpThreadingGrowthPercent,
+                             unsigned(MinJumpThreadingBudget));
+
   DT = nullptr;
 
   // Perform SROA on BB arguments.
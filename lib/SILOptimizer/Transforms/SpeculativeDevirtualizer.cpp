@@ -44,7 +44,13 @@ using namespace swift;
 // speculative devirtualizer will try to predict.
 static const int MaxNumSpeculativeTargets = 6;
 
+// This is the limit for the number of conforming types that the speculative
+// devirtualizer will try to predict for a call on an existential.
+static const unsigned MaxNumSpeculativeWitnessTargets = 2;
+
 STATISTIC(NumTargetsPredicted, "Number of monomorphic functions predicted");
+STATISTIC(NumWitnessTargetsPredicted,
+          "Number of protocol witnesses predicted");
 
 // A utility function for cloning the apply instruction.
 static FullApplySite CloneApply(FullApplySite AI, SILBuilder &Builder) {
@@ -85,6 +91,35 @@ static FullApplySite CloneApply(FullApplySite AI, SILBuilder &Builder) {
   return NAI;
 }
 
+/// Split the critical edges from the try_apply \p TAI to its normal and
+/// error destinations. Returns the new try_apply instruction.
+static FullApplySite splitTryApplyCriticalEdges(TryApplyInst *TAI) {
+  SILBuilderWithScope Builder(TAI);
+
+  auto *ErrorBB = TAI->getFunction()->createBasicBlock();
+  ErrorBB->createBBArg(TAI->getErrorBB()->getBBArg(0)->getType());
+  Builder.setInsertionPoint(ErrorBB);
+  Builder.createBranch(TAI->getLoc(), TAI->getErrorBB(),
+                       {ErrorBB->getBBArg(0)});
+
+  auto *NormalBB = TAI->getFunction()->createBasicBlock();
+  NormalBB->createBBArg(TAI->getNormalBB()->getBBArg(0)->getType());
+  Builder.setInsertionPoint(NormalBB);
+  Builder.createBranch(TAI->getLoc(), TAI->getNormalBB(),
+                      {NormalBB->getBBArg(0) });
+
+  Builder.setInsertionPoint(TAI);
+  SmallVector<SILValue, 4> Args;
+  for (auto Arg : TAI->getArguments()) {
+    Args.push_back(Arg);
+  }
+  FullApplySite NewTAI = Builder.createTryApply(TAI->getLoc(),
+      TAI->getCallee(), TAI->getSubstCalleeSILType(), TAI->getSubstitutions(),
+      Args, NormalBB, ErrorBB);
+  TAI->eraseFromParent();
+  return NewTAI;
+}
+
 /// Insert monomorphic inline caches for a specific class or metatype
 /// type \p SubClassTy.
 static FullApplySite speculateMonomorphicTarget(FullApplySite AI,
@@ -178,30 +213,8 @@ static FullApplySite speculateMonomorphicTarget(FullApplySite AI,
   replaceDeadApply(IdenAI, NewInstPair.first);
 
   // Split critical edges resulting from VirtAI.
-  if (auto *TAI = dyn_cast<TryApplyInst>(VirtAI)) {
-    auto *ErrorBB = TAI->getFunction()->createBasicBlock();
-    ErrorBB->createBBArg(TAI->getErrorBB()->getBBArg(0)->getType());
-    Builder.setInsertionPoint(ErrorBB);
-    Builder.createBranch(TAI->getLoc(), TAI->getErrorBB(),
-                         {ErrorBB->getBBArg(0)});
-
-    auto *NormalBB = TAI->getFunction()->createBasicBlock();
-    NormalBB->createBBArg(TAI->getNormalBB()->getBBArg(0)->getType());
-    Builder.setInsertionPoint(NormalBB);
-    Builder.createBranch(TAI->getLoc(), TAI->getNormalBB(),
-                        {NormalBB->getBBArg(0) });
-
-    Builder.setInsertionPoint(VirtAI.getInstruction());
-    SmallVector<SILValue, 4> Args;
-    for (auto Arg : VirtAI.getArguments()) {
-      Args.push_back(Arg);
-    }
-    FullApplySite NewVirtAI = Builder.createTryApply(VirtAI.getLoc(), VirtAI.getCallee(),
-        VirtAI.getSubstCalleeSILType(), VirtAI.getSubstitutions(),
-        Args, NormalBB, ErrorBB);
-    VirtAI.getInstruction()->eraseFromParent();
-    VirtAI = NewVirtAI;
-  }
+  if (auto *TAI = dyn_cast<TryApplyInst>(VirtAI))
+    VirtAI = splitTryApplyCriticalEdges(TAI);
 
   return VirtAI;
 }
@@ -528,6 +541,228 @@ static bool tryToSpeculateTarget(FullApplySite AI,
   return Changed;
 }
 
+static SILType getThickMetatypeType(CanType Ty) {
+  auto SwiftTy = CanMetatypeType::get(Ty, MetatypeRepresentation::Thick);
+  return SILType::getPrimitiveObjectType(SwiftTy);
+}
+
+/// Returns the witness which implements the requirement called by \p AI
+/// for the concrete type \p NTD, if the call can be redirected to this
+/// witness by only casting the self argument. Returns null otherwise.
+static SILFunction *getSpeculativeWitness(FullApplySite AI,
+                                          NominalTypeDecl *NTD) {
+  auto *WMI = cast<WitnessMethodInst>(AI.getCallee());
+  auto &M = AI.getModule();
+
+  // We cannot devirtualize unbound generic calls yet.
+  if (NTD->isGenericContext())
+    return nullptr;
+
+  CanType ConcreteTy = NTD->getDeclaredType()->getCanonicalType();
+  auto Conformance = M.getSwiftModule()->lookupConformance(
+      ConcreteTy, WMI->getLookupProtocol(), nullptr);
+  if (!Conformance || !Conformance->isConcrete())
+    return nullptr;
+
+  SILFunction *F;
+  SILWitnessTable *WT;
+  std::tie(F, WT) =
+      M.lookUpFunctionInWitnessTable(*Conformance, WMI->getMember());
+  if (!F || !F->shouldOptimize())
+    return nullptr;
+
+  // function_ref inside fragile function cannot reference a private or
+  // hidden symbol.
+  if (AI.getFunction()->isFragile() && !F->hasValidLinkageForFragileRef())
+    return nullptr;
+
+  // The witness must have the signature of the requirement with Self
+  // replaced by the concrete type. Requirements which mention Self anywhere
+  // else than in the self parameter, e.g. in the result, are not handled.
+  auto WitnessTy = F->getLoweredFunctionType();
+  auto SubstCalleeTy = AI.getSubstCalleeType();
+  if (WitnessTy->isPolymorphic() ||
+      WitnessTy->hasErrorResult() != SubstCalleeTy->hasErrorResult() ||
+      WitnessTy->getSILResult() != SubstCalleeTy->getSILResult())
+    return nullptr;
+
+  unsigned NumArgs = AI.getNumArguments();
+  if (WitnessTy->getNumSILArguments() != NumArgs)
+    return nullptr;
+  for (unsigned ArgN = 0; ArgN + 1 < NumArgs; ++ArgN)
+    if (WitnessTy->getSILArgumentType(ArgN) != AI.getArgument(ArgN)->getType())
+      return nullptr;
+
+  SILType SelfTy = AI.getSelfArgument()->getType();
+  SILType ConcreteSelfTy = SILType::getPrimitiveType(ConcreteTy,
+                                                     SelfTy.getCategory());
+  if (WitnessTy->getSILArgumentType(NumArgs - 1) != ConcreteSelfTy)
+    return nullptr;
+
+  // Reference casts are only possible if self is a class instance.
+  if (SelfTy.isObject() && !ConcreteSelfTy.getClassOrBoundGenericClass())
+    return nullptr;
+
+  return F;
+}
+
+/// Insert a monomorphic inline cache which calls the witness \p F of the
+/// concrete type \p ConcreteTy if the dynamic type of the opened existential
+/// self argument of \p AI is exactly \p ConcreteTy.
+///
+/// Returns the apply instruction of the slow path.
+static FullApplySite speculateWitnessTarget(FullApplySite AI,
+                                            CanType ConcreteTy,
+                                            SILFunction *F) {
+  // Create a diamond shaped control flow. The dynamic type of self is
+  // compared against the concrete type to select between the slow dynamic
+  // dispatch through the witness table and the direct call of the witness:
+  //
+  //   %mt1 = value_metatype $@thick (@opened P).Type, %self
+  //   %mt2 = metatype $@thick Concrete.Type
+  //   builtin "cmp_eq_Word"(%mt1 : $Builtin.Word, %mt2 : $Builtin.Word)
+  //   cond_br %cmp, IdenBB, VirtBB
+  auto It = AI.getInstruction()->getIterator();
+  SILFunction *Fn = AI.getFunction();
+  SILBasicBlock *Entry = AI.getParent();
+  SILLocation Loc = AI.getLoc();
+  SILValue Self = AI.getSelfArgument();
+
+  // Iden is the basic block containing the direct call.
+  SILBasicBlock *Iden = Fn->createBasicBlock();
+  // Virt is the block containing the slow witness_method call.
+  SILBasicBlock *Virt = Fn->createBasicBlock();
+
+  SILBasicBlock *Continue = Entry->splitBasicBlock(It);
+
+  SILBuilderWithScope Builder(Entry, AI.getInstruction());
+  auto &Ctx = Builder.getASTContext();
+  auto WordTy = SILType::getBuiltinWordType(Ctx);
+  auto DynamicMT = Builder.createValueMetatype(
+      Loc, getThickMetatypeType(Self->getType().getSwiftRValueType()), Self);
+  auto ConcreteMT = Builder.createMetatype(Loc,
+                                           getThickMetatypeType(ConcreteTy));
+  auto DynamicMTVal = Builder.createUncheckedBitwiseCast(Loc, DynamicMT,
+                                                         WordTy);
+  auto ConcreteMTVal = Builder.createUncheckedBitwiseCast(Loc, ConcreteMT,
+                                                          WordTy);
+  auto Cmp = Builder.createBuiltinBinaryFunction(
+      Loc, "cmp_eq", WordTy, SILType::getBuiltinIntegerType(1, Ctx),
+      {DynamicMTVal, ConcreteMTVal});
+  Builder.createCondBranch(Loc, Cmp, Iden, Virt);
+
+  SILBuilderWithScope VirtBuilder(Virt, AI.getInstruction());
+  SILBuilderWithScope IdenBuilder(Iden, AI.getInstruction());
+
+  // Call the witness directly with self casted to the concrete type.
+  SILType ConcreteSelfTy =
+      SILType::getPrimitiveType(ConcreteTy, Self->getType().getCategory());
+  SILValue ConcreteSelf;
+  if (ConcreteSelfTy.isAddress())
+    ConcreteSelf = IdenBuilder.createUncheckedAddrCast(Loc, Self,
+                                                       ConcreteSelfTy);
+  else
+    ConcreteSelf = IdenBuilder.createUncheckedRefCast(Loc, Self,
+                                                      ConcreteSelfTy);
+
+  SmallVector<SILValue, 8> Args;
+  for (auto Arg : AI.getArguments())
+    Args.push_back(Arg);
+  Args.back() = ConcreteSelf;
+
+  FunctionRefInst *FRI = IdenBuilder.createFunctionRef(Loc, F);
+  FullApplySite IdenAI;
+  if (auto *A = dyn_cast<ApplyInst>(AI)) {
+    IdenAI = IdenBuilder.createApply(Loc, FRI, F->getLoweredType(),
+                                     AI.getType(), ArrayRef<Substitution>(),
+                                     Args, A->isNonThrowing());
+  } else {
+    auto *TAI = cast<TryApplyInst>(AI);
+    IdenAI = IdenBuilder.createTryApply(Loc, FRI, F->getLoweredType(),
+                                        ArrayRef<Substitution>(), Args,
+                                        TAI->getNormalBB(),
+                                        TAI->getErrorBB());
+  }
+  FullApplySite VirtAI = CloneApply(AI, VirtBuilder);
+
+  // Create a PHInode for returning the return value from both apply
+  // instructions.
+  if (!isa<TryApplyInst>(AI)) {
+    SILArgument *Arg = Continue->createBBArg(AI.getType());
+    IdenBuilder.createBranch(Loc, Continue,
+                             ArrayRef<SILValue>(IdenAI.getInstruction()));
+    VirtBuilder.createBranch(Loc, Continue,
+                             ArrayRef<SILValue>(VirtAI.getInstruction()));
+    AI.getInstruction()->replaceAllUsesWith(Arg);
+    AI.getInstruction()->eraseFromParent();
+  } else {
+    AI.getInstruction()->eraseFromParent();
+    assert(Continue->empty() &&
+           "There should not be an instruction after try_apply");
+    Continue->eraseFromParent();
+
+    // Split critical edges resulting from both try_apply instructions.
+    splitTryApplyCriticalEdges(cast<TryApplyInst>(IdenAI));
+    VirtAI = splitTryApplyCriticalEdges(cast<TryApplyInst>(VirtAI));
+  }
+
+  // Update the stats.
+  NumWitnessTargetsPredicted++;
+
+  return VirtAI;
+}
+
+/// \brief Try to speculate the witness called by \p AI on an opened
+/// existential. If the protocol has just a few implementations in this
+/// module, guarded direct calls of their witnesses are inserted in front
+/// of the dynamic dispatch, so that they can be inlined. This function
+/// returns true if a change was made.
+static bool tryToSpeculateWitnessTarget(FullApplySite AI,
+                                        ClassHierarchyAnalysis *CHA) {
+  auto *WMI = cast<WitnessMethodInst>(AI.getCallee());
+
+  // We cannot devirtualize in cases where dynamic calls are
+  // semantically required.
+  if (WMI->isVolatile())
+    return false;
+
+  // Only handle calls on opened existentials, whose dynamic type is only
+  // known at runtime.
+  auto *Archetype = dyn_cast<ArchetypeType>(WMI->getLookupType());
+  if (!Archetype || !Archetype->getOpenedExistentialType())
+    return false;
+
+  if (!AI.hasSelfArgument() ||
+      AI.getSelfArgument()->getType().getSwiftRValueType() !=
+          WMI->getLookupType())
+    return false;
+
+  ProtocolDecl *Proto = WMI->getLookupProtocol();
+  if (!CHA->hasKnownImplementations(Proto))
+    return false;
+
+  // Speculating on more types than this would just add overhead to the
+  // slow path.
+  auto &Impls = CHA->getProtocolImplementations(Proto);
+  if (Impls.size() > MaxNumSpeculativeWitnessTargets)
+    return false;
+
+  bool Changed = false;
+  for (auto *NTD : Impls) {
+    SILFunction *F = getSpeculativeWitness(AI, NTD);
+    if (!F)
+      continue;
+
+    DEBUG(llvm::dbgs() << "Inserting a speculative call of witness "
+          << F->getName() << " for protocol " << Proto->getName() << "\n");
+
+    AI = speculateWitnessTarget(AI, NTD->getDeclaredType()->getCanonicalType(),
+                                F);
+    Changed = true;
+  }
+  return Changed;
+}
+
 namespace {
   /// Speculate the targets of virtual calls by assuming that the requested
   /// class is at the bottom of the class hierarchy.
@@ -545,14 +780,19 @@ namespace {
       for (auto &BB : *getFunction()) {
         for (auto II = BB.begin(), IE = BB.end(); II != IE; ++II) {
           FullApplySite AI = FullApplySite::isa(&*II);
-          if (AI && isa<ClassMethodInst>(AI.getCallee()))
+          if (AI && (isa<ClassMethodInst>(AI.getCallee()) ||
+                     isa<WitnessMethodInst>(AI.getCallee())))
             ToSpecialize.push_back(AI);
         }
       }
 
       // Go over the collected calls and try to insert speculative calls.
-      for (auto AI : ToSpecialize)
-        Changed |= tryToSpeculateTarget(AI, CHA);
+      for (auto AI : ToSpecialize) {
+        if (isa<WitnessMethodInst>(AI.getCallee()))
+          Changed |= tryToSpeculateWitnessTarget(AI, CHA);
+        else
+          Changed |= tryToSpeculateTarget(AI, CHA);
+      }
 
       if (Changed) {
         invalidateAnalysis(SILAnalysis::InvalidationKind::FunctionBody);
@@ -41,6 +41,10 @@ namespace {
 class SILLinker : public SILModuleTransform {
 
   void run() override {
+    // The inliner and the specializers link what they need themselves.
+    if (getOptions().LinkOnDemand)
+      return;
+
     SILModule &M = *getModule();
     for (auto &Fn : M)
       if (M.linkFunction(&Fn, SILModule::LinkingMode::LinkAll))
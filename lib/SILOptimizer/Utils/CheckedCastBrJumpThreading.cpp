@@ -47,6 +47,9 @@ class CheckedCastBrJumpThreading {
   // after jump-threading is done.
   SmallVectorImpl<SILBasicBlock *> &BlocksForWorklist;
 
+  // The number of instructions that may still be duplicated.
+  unsigned &ThreadingBudget;
+
   // Information for transforming a single checked_cast_br.
   // This is the output of the optimization's analysis phase.
   struct Edit {
@@ -107,8 +110,10 @@ class CheckedCastBrJumpThreading {
 
 public:
   CheckedCastBrJumpThreading(SILFunction *Fn, DominanceInfo *DT,
-                             SmallVectorImpl<SILBasicBlock *> &BlocksForWorklist)
-      : Fn(Fn), DT(DT), BlocksForWorklist(BlocksForWorklist) { }
+                             SmallVectorImpl<SILBasicBlock *> &BlocksForWorklist,
+                             unsigned &ThreadingBudget)
+      : Fn(Fn), DT(DT), BlocksForWorklist(BlocksForWorklist),
+        ThreadingBudget(ThreadingBudget) { }
 
   void optimizeFunction();
 };
@@ -568,6 +573,8 @@ bool CheckedCastBrJumpThreading::trySimplify(CheckedCastBranchInst *CCBI) {
     unsigned TotalPreds =
         SuccessPreds.size() + FailurePreds.size() + numUnknownPreds;
 
+    unsigned CloningCost = 0;
+
     // We only need to clone the BB if not all of its
     // predecessors are in the same group.
     if (TotalPreds != SuccessPreds.size() &&
@@ -575,6 +582,11 @@ bool CheckedCastBrJumpThreading::trySimplify(CheckedCastBranchInst *CCBI) {
       // Check some cloning related constraints.
       if (!checkCloningConstraints())
         return false;
+
+      // Don't let the function grow beyond the budget.
+      CloningCost = std::distance(BB->begin(), BB->end());
+      if (CloningCost > ThreadingBudget)
+        return false;
     }
 
     bool InvertSuccess = false;
@@ -598,6 +610,8 @@ bool CheckedCastBrJumpThreading::trySimplify(CheckedCastBranchInst *CCBI) {
     // We have to generate new dedicated BBs as landing BBs for all
     // FailurePreds and all SuccessPreds.
 
+    ThreadingBudget -= CloningCost;
+
     // Since we are going to change the BB,
     // add its successors and predecessors
     // for re-processing.
@@ -682,8 +696,10 @@ void CheckedCastBrJumpThreading::optimizeFunction() {
 namespace swift {
 
 bool tryCheckedCastBrJumpThreading(SILFunction *Fn, DominanceInfo *DT,
-                        SmallVectorImpl<SILBasicBlock *> &BlocksForWorklist) {
-  CheckedCastBrJumpThreading CCBJumpThreading(Fn, DT, BlocksForWorklist);
+                        SmallVectorImpl<SILBasicBlock *> &BlocksForWorklist,
+                        unsigned &ThreadingBudget) {
+  CheckedCastBrJumpThreading CCBJumpThreading(Fn, DT, BlocksForWorklist,
+                                              ThreadingBudget);
   CCBJumpThreading.optimizeFunction();
   return !BlocksForWorklist.empty();
 }
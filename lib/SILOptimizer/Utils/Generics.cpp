@@ -188,11 +188,7 @@ GenericFuncSpecializer::GenericFuncSpecializer(SILFunction *GenericFunc,
 
   assert(GenericFunc->isDefinition() && "Expected definition to specialize!");
 
-  Mangle::Mangler Mangler;
-  GenericSpecializationMangler GenericMangler(Mangler, GenericFunc,
-                                              ParamSubs, Fragile);
-  GenericMangler.mangle();
-  ClonedName = Mangler.finalize();
+  ClonedName = M.getGenericSpecializationName(GenericFunc, ParamSubs, Fragile);
 
   DEBUG(llvm::dbgs() << "    Specialized function " << ClonedName << '\n');
 }
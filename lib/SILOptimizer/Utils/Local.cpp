@@ -388,6 +388,29 @@ void swift::placeFuncRef(ApplyInst *AI, DominanceInfo *DT) {
     FuncRef->moveBefore(&*DomBB->begin());
 }
 
+Optional<uint64_t> swift::getProfileCount(SILBasicBlock *BB,
+                                          DominanceInfo *DT) {
+  if (!BB->getParent()->getEntryCount())
+    return None;
+
+  // SILGen records counts on the blocks where profiled regions begin. Blocks
+  // created later, e.g. by splitting or inlining, get the count of the region
+  // they were split from.
+  for (auto *Node = DT->getNode(BB); Node; Node = Node->getIDom())
+    if (auto Count = Node->getBlock()->getExecutionCount())
+      return Count;
+
+  // Unreachable blocks aren't in the dominator tree.
+  return None;
+}
+
+bool swift::isHotProfileCount(SILModule &M, uint64_t Count) {
+  // A count is hot if it is within this factor of the module's largest count.
+  const uint64_t HotCountFactor = 100;
+  uint64_t MaxCount = M.getMaxProfileCount();
+  return Count != 0 && Count >= MaxCount / HotCountFactor;
+}
+
 /// \brief Add an argument, \p val, to the branch-edge that is pointing into
 /// block \p Dest. Return a new instruction and do not erase the old
 /// instruction.
@@ -2041,6 +2041,85 @@ namespace {
       return handleStringLiteralExpr(expr);
     }
 
+    /// Build the semantic expression of a string interpolation whose type
+    /// conforms to _ExpressibleByBufferedStringInterpolation:
+    ///
+    /// \code
+    /// T(stringInterpolationBuffer:
+    ///   T._appendStringInterpolationSegment(
+    ///     to: T._appendStringInterpolationSegment(
+    ///       to: T._makeStringInterpolationBuffer(reservingCapacity: N),
+    ///       segment0),
+    ///     segment1))
+    /// \endcode
+    ///
+    /// The buffer is the first argument of each call, so the segments are
+    /// still evaluated in order.
+    Expr *buildBufferedInterpolation(InterpolatedStringLiteralExpr *expr,
+                                     Type type, ProtocolDecl *proto,
+                                     ProtocolConformance *conformance) {
+      auto &tc = cs.getTypeChecker();
+      auto &ctx = tc.Context;
+      auto intDecl = ctx.getIntDecl();
+      if (!intDecl)
+        return nullptr;
+
+      // Estimate the capacity from the lengths of the literal segments, plus
+      // a few code units for each interpolated value.
+      const uint64_t estimatedValueLength = 16;
+      uint64_t capacity = 0;
+      for (auto segment : expr->getSegments()) {
+        if (auto literal = dyn_cast<StringLiteralExpr>(segment))
+          capacity += literal->getValue().size();
+        else
+          capacity += estimatedValueLength;
+      }
+
+      llvm::SmallString<16> capacityText;
+      APInt(64, capacity).toString(capacityText, 10, /*signed*/ false);
+      Expr *capacityExpr =
+        new (ctx) IntegerLiteralExpr(ctx.AllocateCopy(capacityText.str()),
+                                     expr->getStartLoc(), /*Implicit=*/true);
+      bool failed = tc.typeCheckExpression(
+                      capacityExpr, cs.DC,
+                      TypeLoc::withoutLoc(intDecl->getDeclaredType()),
+                      CTP_CannotFail);
+      assert(!failed && "Could not type-check interpolation capacity");
+      (void)failed;
+
+      // FIXME: This location info is bogus.
+      auto makeTypeRef = [&]() -> Expr * {
+        return TypeExpr::createImplicitHack(expr->getStartLoc(), type, ctx);
+      };
+
+      DeclName makeName(ctx, ctx.Id_makeStringInterpolationBuffer,
+                        { ctx.Id_reservingCapacity });
+      Expr *buffer = tc.callWitness(makeTypeRef(), dc, proto, conformance,
+                                    makeName, capacityExpr,
+                                    diag::interpolation_broken_proto);
+      if (!buffer)
+        return nullptr;
+
+      DeclName appendName(ctx, ctx.Id_appendStringInterpolationSegment,
+                          { ctx.Id_to, Identifier() });
+      for (auto segment : expr->getSegments()) {
+        Expr *args[] = { buffer, segment };
+        buffer = tc.callWitness(makeTypeRef(), dc, proto, conformance,
+                                appendName, args,
+                                diag::interpolation_broken_proto);
+        if (!buffer)
+          return nullptr;
+      }
+
+      DeclName initName(ctx, ctx.Id_init, { ctx.Id_stringInterpolationBuffer });
+      Expr *result = tc.callWitness(makeTypeRef(), dc, proto, conformance,
+                                    initName, buffer,
+                                    diag::interpolation_broken_proto);
+      if (result)
+        result->setType(type);
+      return result;
+    }
+
     Expr *
     visitInterpolatedStringLiteralExpr(InterpolatedStringLiteralExpr *expr) {
       // Figure out the string type we're converting to.
@@ -2055,6 +2134,25 @@ namespace {
                          KnownProtocolKind::ExpressibleByStringInterpolation);
       assert(interpolationProto && "Missing string interpolation protocol?");
 
+      // If the type builds its interpolations in a single buffer, append the
+      // segments to that buffer rather than creating an instance for each.
+      if (auto bufferedProto = tc.getProtocol(
+              SourceLoc(),
+              KnownProtocolKind::ExpressibleByBufferedStringInterpolation)) {
+        ProtocolConformance *conformance = nullptr;
+        if (tc.conformsToProtocol(type, bufferedProto, cs.DC,
+                                  ConformanceCheckFlags::InExpression,
+                                  &conformance)) {
+          auto semanticExpr = buildBufferedInterpolation(expr, type,
+                                                         bufferedProto,
+                                                         conformance);
+          if (!semanticExpr)
+            return nullptr;
+          expr->setSemanticExpr(semanticExpr);
+          return expr;
+        }
+      }
+
       DeclName name(tc.Context, tc.Context.Id_init,
                     { tc.Context.Id_stringInterpolation });
       auto member
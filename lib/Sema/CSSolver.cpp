@@ -15,7 +15,9 @@
 //===----------------------------------------------------------------------===//
 #include "ConstraintSystem.h"
 #include "ConstraintGraph.h"
+#include "swift/Basic/Defer.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/SaveAndRestore.h"
 #include <memory>
@@ -30,6 +32,8 @@ using namespace constraints;
 #define JOIN(X,Y) JOIN2(X,Y)
 #define JOIN2(X,Y) X##Y
 STATISTIC(NumSolutionAttempts, "# of solution attempts");
+STATISTIC(NumCandidatesReused,
+          "# of shrink candidates reusing the domains of an identical one");
 
 #define CS_STATISTIC(Name, Description) \
   STATISTIC(JOIN2(Overall,Name), Description);
@@ -207,12 +211,18 @@ Solution ConstraintSystem::finalize(
 }
 
 void ConstraintSystem::applySolution(const Solution &solution) {
+  llvm::SmallPtrSet<TypeVariableType *, 4> 
+    knownTypeVariables(TypeVariables.begin(), TypeVariables.end());
+  applySolution(solution, knownTypeVariables);
+}
+
+void ConstraintSystem::applySolution(
+       const Solution &solution,
+       llvm::SmallPtrSetImpl<TypeVariableType *> &knownTypeVariables) {
   // Update the score.
   CurrentScore += solution.getFixedScore();
 
   // Assign fixed types to the type variables solved by this solution.
-  llvm::SmallPtrSet<TypeVariableType *, 4> 
-    knownTypeVariables(TypeVariables.begin(), TypeVariables.end());
   for (auto binding : solution.typeBindings) {
     // If we haven't seen this type variable before, record it now.
     if (knownTypeVariables.insert(binding.first).second)
@@ -420,6 +430,13 @@ ConstraintSystem::SolverState::~SolverState() {
   #define CS_STATISTIC(Name, Description) JOIN2(Overall,Name) += Name;
   #include "ConstraintSolverStats.def"
 
+  // And to the statistics of the expression, if it is timed. Unlike the
+  // overall statistics, those are also available in release builds.
+  if (CS.Timer) {
+    #define CS_STATISTIC(Name, Description) CS.Timer->Name += Name;
+    #include "ConstraintSolverStats.def"
+  }
+
   // Update the "largest" statistics if this system is larger than the
   // previous one.  
   // FIXME: This is not at all thread-safe.
@@ -433,6 +450,19 @@ ConstraintSystem::SolverState::~SolverState() {
   }
 }
 
+ExpressionTimer::~ExpressionTimer() {
+  if (!ShouldDump)
+    return;
+
+  auto elapsed = getElapsedProcessTime();
+  llvm::errs() << llvm::format("%0.1f", elapsed * 1000) << "ms\t";
+  E->getLoc().print(llvm::errs(), Context.SourceMgr);
+  #define CS_STATISTIC(Name, Description) \
+    llvm::errs() << "\t" #Name "=" << Name;
+  #include "ConstraintSolverStats.def"
+  llvm::errs() << "\n";
+}
+
 ConstraintSystem::SolverScope::SolverScope(ConstraintSystem &cs)
   : cs(cs), CGScope(cs.CG)
 {
@@ -1134,6 +1164,11 @@ static bool tryTypeVariableBindings(
     return true;
   }
 
+  // Likewise, if the solver has spent too much time on this expression.
+  cs.checkSolverTimeThreshold();
+  if (cs.getExpressionTooComplex())
+    return true;
+
   for (unsigned tryCount = 0; !anySolved && !bindings.empty(); ++tryCount) {
     // Try each of the bindings in turn.
     ++cs.solverState->NumTypeVariableBindings;
@@ -1437,6 +1472,116 @@ void ConstraintSystem::Candidate::applySolutions(
   }
 }
 
+bool ConstraintSystem::Candidate::getShape(
+       llvm::FoldingSetNodeID &shape,
+       llvm::SmallVectorImpl<OverloadSetRefExpr *> &OSRs) const {
+  struct ShapeProfiler : public ASTWalker {
+    llvm::FoldingSetNodeID &Shape;
+    llvm::SmallVectorImpl<OverloadSetRefExpr *> &OSRs;
+    bool IsCacheable = true;
+
+    ShapeProfiler(llvm::FoldingSetNodeID &shape,
+                  llvm::SmallVectorImpl<OverloadSetRefExpr *> &OSRs)
+        : Shape(shape), OSRs(OSRs) {}
+
+    std::pair<bool, Expr *> walkToExprPre(Expr *expr) override {
+      if (!IsCacheable)
+        return {false, expr};
+
+      Shape.AddInteger(unsigned(expr->getKind()));
+      switch (expr->getKind()) {
+      case ExprKind::IntegerLiteral:
+      case ExprKind::FloatLiteral:
+        Shape.AddBoolean(cast<NumberLiteralExpr>(expr)->isNegative());
+        break;
+
+      // Whether a string literal can be a Character or a UnicodeScalar
+      // depends on its contents.
+      case ExprKind::StringLiteral:
+        Shape.AddString(cast<StringLiteralExpr>(expr)->getValue());
+        break;
+
+      case ExprKind::DeclRef:
+        Shape.AddPointer(cast<DeclRefExpr>(expr)->getDecl());
+        break;
+
+      case ExprKind::OverloadedDeclRef: {
+        auto OSR = cast<OverloadSetRefExpr>(expr);
+        Shape.AddInteger(OSR->getDecls().size());
+        for (auto decl : OSR->getDecls())
+          Shape.AddPointer(decl);
+        OSRs.push_back(OSR);
+        break;
+      }
+
+      case ExprKind::UnresolvedDot:
+        Shape.AddPointer(
+            cast<UnresolvedDotExpr>(expr)->getName().getOpaqueValue());
+        break;
+
+      case ExprKind::Type: {
+        auto type = cast<TypeExpr>(expr)->getInstanceType();
+        if (!type) {
+          IsCacheable = false;
+          break;
+        }
+        Shape.AddPointer(type.getPointer());
+        break;
+      }
+
+      case ExprKind::Tuple: {
+        auto tuple = cast<TupleExpr>(expr);
+        Shape.AddInteger(tuple->getNumElements());
+        if (tuple->hasElementNames())
+          for (auto name : tuple->getElementNames())
+            Shape.AddPointer(name.get());
+        break;
+      }
+
+      case ExprKind::BooleanLiteral:
+      case ExprKind::NilLiteral:
+      case ExprKind::Paren:
+      case ExprKind::Call:
+      case ExprKind::Binary:
+      case ExprKind::PrefixUnary:
+      case ExprKind::PostfixUnary:
+      case ExprKind::Array:
+      case ExprKind::Dictionary:
+        break;
+
+      // Anything else, closures in particular, might not be solved the same
+      // way in two places of the same shape.
+      default:
+        IsCacheable = false;
+        break;
+      }
+
+      return {IsCacheable, expr};
+    }
+
+    Expr *walkToExprPost(Expr *expr) override {
+      // Mark the end of the children, so that the shape includes the
+      // structure of the tree and not only the pre-order of its nodes.
+      Shape.AddInteger(~0U);
+      return expr;
+    }
+
+    std::pair<bool, Stmt *> walkToStmtPre(Stmt *stmt) override {
+      IsCacheable = false;
+      return {false, stmt};
+    }
+  };
+
+  ShapeProfiler profiler(shape, OSRs);
+  E->walk(profiler);
+  if (!profiler.IsCacheable)
+    return false;
+
+  shape.AddPointer(CT.getPointer());
+  shape.AddInteger(unsigned(CTP));
+  return true;
+}
+
 void ConstraintSystem::shrink(Expr *expr) {
   typedef llvm::SmallDenseMap<Expr *, ArrayRef<ValueDecl *>> DomainMap;
 
@@ -1708,7 +1853,54 @@ void ConstraintSystem::shrink(Expr *expr) {
   // so we can start solving them separately.
   expr->walk(collector);
 
+  // The reduced OSR domains of the candidates solved so far, by the hash of
+  // their shape. Large literal collections and long chains of operators tend
+  // to repeat the same sub-expression over and over again, and there is no
+  // need to solve those again.
+  struct SolvedShape {
+    llvm::FoldingSetNodeID Shape;
+    llvm::SmallVector<ArrayRef<ValueDecl *>, 4> Domains;
+  };
+  llvm::DenseMap<unsigned, llvm::SmallVector<SolvedShape, 1>> solvedShapes;
+
   for (auto &candidate : collector.Candidates) {
+    llvm::FoldingSetNodeID shape;
+    llvm::SmallVector<OverloadSetRefExpr *, 4> OSRs;
+    bool isCacheable = candidate.getShape(shape, OSRs);
+
+    SolvedShape *solved = nullptr;
+    if (isCacheable) {
+      for (auto &entry : solvedShapes[shape.ComputeHash()]) {
+        if (entry.Shape == shape) {
+          solved = &entry;
+          break;
+        }
+      }
+    }
+
+    // We've already solved a candidate of the same shape, so let's just
+    // reduce the domains the same way.
+    if (solved) {
+      assert(solved->Domains.size() == OSRs.size() &&
+             "same shape with different OSRs?");
+      for (unsigned i = 0, e = OSRs.size(); i != e; ++i)
+        OSRs[i]->setDecls(solved->Domains[i]);
+      ++NumCandidatesReused;
+      continue;
+    }
+
+    SWIFT_DEFER {
+      if (!isCacheable)
+        return;
+
+      // Remember how the domains of this candidate ended up.
+      SolvedShape entry;
+      entry.Shape = shape;
+      for (auto OSR : OSRs)
+        entry.Domains.push_back(OSR->getDecls());
+      solvedShapes[shape.ComputeHash()].push_back(std::move(entry));
+    };
+
     // If there are no results, let's forget everything we know about the
     // system so far. This actually is ok, because some of the expressions
     // might require manual salvaging.
@@ -1739,6 +1931,12 @@ ConstraintSystem::solve(Expr *&expr,
                         FreeTypeVariableBinding allowFreeTypeVariables) {
   assert(!solverState && "use solveRec for recursive calls");
 
+  // Time the expression if its solver time is limited or reported.
+  if (TC.getDebugTimeExpressions() ||
+      TC.getLangOpts().SolverExpressionTimeThreshold)
+    Timer.emplace(expr, TC.Context, TC.getDebugTimeExpressions());
+  SWIFT_DEFER { Timer.reset(); };
+
   // Try to shrink the system by reducing disjunction domains. This
   // goes through every sub-expression and generate its own sub-system, to
   // try to reduce the domains of those subexpressions.
@@ -1895,6 +2093,22 @@ bool ConstraintSystem::solveRec(SmallVectorImpl<Solution> &solutions,
       constraintComponent[constraint] = components[i];
   }
 
+  // Sort the type variables into buckets based on component number, keeping
+  // the order in which they were introduced. Type variables that are not
+  // part of any component are already resolved; the components don't need
+  // them, since the solver only ever looks at their fixed types, and the
+  // composed solutions below record their bindings. Leaving them out keeps
+  // the per-component work proportional to the size of the component, rather
+  // than to the size of the whole system, for expressions that split into
+  // many small components such as large collection literals.
+  std::unique_ptr<SmallVector<TypeVariableType *, 4>[]> typeVarBuckets(
+    new SmallVector<TypeVariableType *, 4>[numComponents]);
+  for (auto typeVar : TypeVariables) {
+    auto known = typeVarComponent.find(typeVar);
+    if (known != typeVarComponent.end())
+      typeVarBuckets[known->second].push_back(typeVar);
+  }
+
   // Sort the constraints into buckets based on component number.
   std::unique_ptr<ConstraintList[]> constraintBuckets(
                                       new ConstraintList[numComponents]);
@@ -1927,20 +2141,11 @@ bool ConstraintSystem::solveRec(SmallVectorImpl<Solution> &solutions,
     InactiveConstraints.splice(InactiveConstraints.end(), 
                                constraintBuckets[component]);
 
-    // Collect the type variables that are not part of a different
-    // component; this includes type variables that are part of the
-    // component as well as already-resolved type variables.
-    // FIXME: The latter could be avoided if we had already
-    // substituted all of those other type variables through.
+    // Collect the type variables of this component.
     llvm::SmallVector<TypeVariableType *, 16> allTypeVariables 
       = std::move(TypeVariables);
-    for (auto typeVar : allTypeVariables) {
-      auto known = typeVarComponent.find(typeVar);
-      if (known != typeVarComponent.end() && known->second != component)
-        continue;
-
-      TypeVariables.push_back(typeVar);
-    }
+    TypeVariables.assign(typeVarBuckets[component].begin(),
+                         typeVarBuckets[component].end());
     
     // Solve for this component. If it fails, we're done.
     bool failed;
@@ -2022,8 +2227,10 @@ bool ConstraintSystem::solveRec(SmallVectorImpl<Solution> &solutions,
     // Create a new solver scope in which we apply all of the partial
     // solutions.
     SolverScope scope(*this);
+    llvm::SmallPtrSet<TypeVariableType *, 16>
+      knownTypeVariables(TypeVariables.begin(), TypeVariables.end());
     for (unsigned i = 0; i != numComponents; ++i)
-      applySolution(partialSolutions[i][indices[i]]);
+      applySolution(partialSolutions[i][indices[i]], knownTypeVariables);
 
     // This solution might be worse than the best solution found so far. If so,
     // skip it.
@@ -2245,6 +2452,7 @@ bool ConstraintSystem::solveSimplified(
       break;
     
     // If the expression was deemed "too complex", stop now and salvage.
+    checkSolverTimeThreshold();
     if (getExpressionTooComplex())
       break;
 
@@ -35,6 +35,7 @@
 #include "llvm/ADT/PointerUnion.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cstddef>
 #include <functional>
@@ -880,6 +881,35 @@ struct MemberLookupResult {
 };
   
   
+/// \brief Measures the time spent on solving the constraint system of an
+/// expression, and collects the solver statistics for it.
+///
+/// The timer is used to enforce the solver's time threshold and, with
+/// -debug-time-expression-type-checking, reports the time and statistics of
+/// the expression to llvm::errs() on destruction.
+class ExpressionTimer {
+  Expr *E;
+  ASTContext &Context;
+  llvm::TimeRecord StartTime = llvm::TimeRecord::getCurrentTime();
+  bool ShouldDump;
+
+public:
+  // Statistics of all solver states of the constraint system.
+  #define CS_STATISTIC(Name, Description) unsigned Name = 0;
+  #include "ConstraintSolverStats.def"
+
+  ExpressionTimer(Expr *E, ASTContext &Context, bool ShouldDump)
+    : E(E), Context(Context), ShouldDump(ShouldDump) {}
+
+  ~ExpressionTimer();
+
+  /// Return the elapsed process time, in seconds.
+  double getElapsedProcessTime() const {
+    auto now = llvm::TimeRecord::getCurrentTime(/*Start=*/false);
+    return now.getProcessTime() - StartTime.getProcessTime();
+  }
+};
+
 /// \brief Describes a system of constraints on type variables, the
 /// solution of which assigns concrete types to each of the type variables.
 /// Constraint systems are typically generated given an (untyped) expression.
@@ -920,6 +950,10 @@ private:
   /// threshold.
   bool expressionExceededThreshold = false;
 
+  /// \brief The timer of the expression being solved, if the solver time is
+  /// limited or reported.
+  Optional<ExpressionTimer> Timer;
+
   /// \brief Cached member lookups.
   llvm::DenseMap<std::pair<Type, DeclName>, Optional<LookupResult>>
     MemberLookups;
@@ -1038,6 +1072,19 @@ private:
     /// \brief Return underlying expression.
     Expr *getExpr() const { return E; }
 
+    /// \brief Compute the shape of this candidate: the kinds of all of its
+    /// sub-expressions, the declarations, names and literals they refer to
+    /// and the contextual type. Candidates of the same shape reduce the
+    /// domains of their OSRs in the same way.
+    ///
+    /// \param shape Receives the profile of the shape.
+    /// \param OSRs Receives the OSRs of the candidate, in pre-order.
+    ///
+    /// \returns false if the candidate contains an expression which might be
+    /// solved differently in spite of having the same shape, e.g. a closure.
+    bool getShape(llvm::FoldingSetNodeID &shape,
+                  llvm::SmallVectorImpl<OverloadSetRefExpr *> &OSRs) const;
+
     /// \brief Try to solve this candidate sub-expression
     /// and re-write it's OSR domains afterwards.
     ///
@@ -1227,6 +1274,16 @@ private:
   /// constraint system for further exploration.
   void applySolution(const Solution &solution);
 
+  /// \brief Apply the given solution to the current constraint system,
+  /// given the set of type variables it already knows about.
+  ///
+  /// Type variables the solution introduces are added to
+  /// \p knownTypeVariables, so that several partial solutions can be applied
+  /// without collecting the set again for each of them.
+  void applySolution(const Solution &solution,
+                     llvm::SmallPtrSetImpl<TypeVariableType *>
+                       &knownTypeVariables);
+
   /// Emit the fixes computed as part of the solution, returning true if we were
   /// able to emit an error message, or false if none of the fixits worked out.
   bool applySolutionFixes(Expr *E, const Solution &solution);
@@ -2180,6 +2237,15 @@ public:
     return expressionExceededThreshold;
   }
 
+  /// \brief Mark the expression being solved as "too complex" if the solver
+  /// has spent more time than its time threshold on it.
+  void checkSolverTimeThreshold() {
+    unsigned threshold = TC.getLangOpts().SolverExpressionTimeThreshold;
+    if (Timer && threshold &&
+        Timer->getElapsedProcessTime() > threshold)
+      setExpressionTooComplex(true);
+  }
+
   LLVM_ATTRIBUTE_DEPRECATED(
       void dump() LLVM_ATTRIBUTE_USED,
       "only for use within the debugger");
@@ -19,6 +19,7 @@
 #include "swift/Sema/IterativeTypeChecker.h"
 #include "swift/AST/ASTContext.h"
 #include "swift/AST/Decl.h"
+#include "swift/AST/ProtocolConformance.h"
 #include <tuple>
 using namespace swift;
 
@@ -343,3 +344,58 @@ bool IterativeTypeChecker::breakCycleForResolveTypeDecl(TypeDecl *typeDecl) {
   // FIXME: Generalize this.
   return false;
 }
+
+//===----------------------------------------------------------------------===//
+// Declaration signatures
+//===----------------------------------------------------------------------===//
+bool IterativeTypeChecker::isResolveDeclSignatureSatisfied(ValueDecl *decl) {
+  // The non-iterative type checker may be in the middle of filling in
+  // the rest of the signature.
+  if (decl->isBeingTypeChecked())
+    return false;
+
+  if (!decl->hasType() || !decl->hasAccessibility())
+    return false;
+
+  // Properties can get their types before they are validated.
+  if (auto var = dyn_cast<VarDecl>(decl))
+    return var->didEarlyAttrValidation();
+
+  return true;
+}
+
+void IterativeTypeChecker::processResolveDeclSignature(
+       ValueDecl *decl,
+       UnsatisfiedDependency unsatisfiedDependency) {
+  // FIXME: Recursion into the old type checker.
+  TC.validateDecl(decl, true);
+}
+
+bool IterativeTypeChecker::breakCycleForResolveDeclSignature(
+       ValueDecl *decl) {
+  // validateDecl() breaks its own cycles.
+  return false;
+}
+
+//===----------------------------------------------------------------------===//
+// Conformance checking
+//===----------------------------------------------------------------------===//
+bool IterativeTypeChecker::isTypeCheckConformanceSatisfied(
+       NormalProtocolConformance *conformance) {
+  // Invalid conformances still have delayed diagnostics to emit each time
+  // they are checked.
+  return conformance->isComplete() && !conformance->isInvalid();
+}
+
+void IterativeTypeChecker::processTypeCheckConformance(
+       NormalProtocolConformance *conformance,
+       UnsatisfiedDependency unsatisfiedDependency) {
+  // FIXME: Recursion into the old type checker.
+  TC.checkConformanceImmediately(conformance);
+}
+
+bool IterativeTypeChecker::breakCycleForTypeCheckConformance(
+       NormalProtocolConformance *conformance) {
+  // The conformance checker breaks its own cycles.
+  return false;
+}
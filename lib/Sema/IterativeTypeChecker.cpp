@@ -21,8 +21,14 @@
 #include "swift/AST/Decl.h"
 #include "swift/AST/DiagnosticsSema.h"
 #include "swift/Basic/Defer.h"
+#include "llvm/ADT/Statistic.h"
 using namespace swift;
 
+#define DEBUG_TYPE "Iterative type checker"
+STATISTIC(NumRequestsProcessed, "# of type check requests processed");
+STATISTIC(NumSatisfiedRequestHits,
+          "# of type check requests found in the satisfied cache");
+
 ASTContext &IterativeTypeChecker::getASTContext() const {
   return TC.Context;
 }
@@ -46,13 +52,43 @@ void IterativeTypeChecker::process(
 
 /// Determine whether the given request has already been satisfied.
 bool IterativeTypeChecker::isSatisfied(TypeCheckRequest request) {
+  if (SatisfiedRequests.count(request)) {
+    ++NumSatisfiedRequestHits;
+    return true;
+  }
+
+  bool satisfied;
   switch (request.getKind()) {
 #define TYPE_CHECK_REQUEST(Request,PayloadName)                         \
   case TypeCheckRequest::Request:                                       \
-    return is##Request##Satisfied(request.get##PayloadName##Payload());
+    satisfied = is##Request##Satisfied(request.get##PayloadName##Payload()); \
+    break;
 
 #include "swift/Sema/TypeCheckRequestKinds.def"
   }
+
+  if (satisfied)
+    SatisfiedRequests.insert(request);
+  return satisfied;
+}
+
+bool IterativeTypeChecker::isDelegatedToTypeChecker(
+       TypeCheckRequest::Kind kind) {
+  switch (kind) {
+  case TypeCheckRequest::ResolveDeclSignature:
+  case TypeCheckRequest::TypeCheckConformance:
+    return true;
+
+  case TypeCheckRequest::QualifiedLookupInDeclContext:
+  case TypeCheckRequest::UnqualifiedLookupInDeclContext:
+  case TypeCheckRequest::ResolveInheritedClauseEntry:
+  case TypeCheckRequest::TypeCheckSuperclass:
+  case TypeCheckRequest::TypeCheckRawType:
+  case TypeCheckRequest::InheritedProtocols:
+  case TypeCheckRequest::ResolveTypeRepr:
+  case TypeCheckRequest::ResolveTypeDecl:
+    return false;
+  }
 }
 
 bool IterativeTypeChecker::breakCycle(TypeCheckRequest request) {
@@ -69,16 +105,34 @@ void IterativeTypeChecker::satisfy(TypeCheckRequest request) {
   // If the request has already been satisfied, we're done.
   if (isSatisfied(request)) return;
 
+  // Only look for cycles among the requests made by this call.
+  unsigned savedFirstRequest = FirstRequestOfSatisfy;
+  FirstRequestOfSatisfy = ActiveRequests.size();
+  SWIFT_DEFER { FirstRequestOfSatisfy = savedFirstRequest; };
+
+  satisfyDependency(request);
+}
+
+void IterativeTypeChecker::satisfyDependency(TypeCheckRequest request) {
+  // If the request has already been satisfied, we're done.
+  if (isSatisfied(request)) return;
+
   // Check for circular dependencies in our requests.
   // FIXME: This stack operation is painfully inefficient.
-  auto existingRequest = std::find(ActiveRequests.rbegin(),
-                                   ActiveRequests.rend(),
+  auto activeRequests = llvm::makeArrayRef(ActiveRequests)
+                          .slice(FirstRequestOfSatisfy);
+  auto existingRequest = std::find(activeRequests.rbegin(),
+                                   activeRequests.rend(),
                                    request);
-  if (existingRequest != ActiveRequests.rend()) {
+  if (existingRequest != activeRequests.rend()) {
+    // The non-iterative type checker diagnoses its own cycles.
+    if (isDelegatedToTypeChecker(request.getKind()))
+      return;
+
     auto first = existingRequest.base();
     --first;
     diagnoseCircularReference(llvm::makeArrayRef(&*first,
-                                                 &*ActiveRequests.end()));
+                                                 activeRequests.end()));
     return;
   }
 
@@ -90,6 +144,7 @@ void IterativeTypeChecker::satisfy(TypeCheckRequest request) {
     // Process this requirement, enumerating dependencies if anything else needs
     // to be handled first.
     SmallVector<TypeCheckRequest, 4> unsatisfied;
+    ++NumRequestsProcessed;
     process(request, [&](TypeCheckRequest dependency) -> bool {
       if (isSatisfied(dependency)) return false;
 
@@ -98,16 +153,21 @@ void IterativeTypeChecker::satisfy(TypeCheckRequest request) {
       return true;
     });
 
-    // If there were no unsatisfied dependencies, we're done.
+    // If there were no unsatisfied dependencies, we're done. A request
+    // evaluated by the non-iterative type checker may still be
+    // unsatisfied if that type checker is already working on it; it
+    // will be evaluated again the next time it is requested.
     if (unsatisfied.empty()) {
-      assert(isSatisfied(request));
+      assert((isSatisfied(request) ||
+              isDelegatedToTypeChecker(request.getKind())) &&
+             "request was not satisfied");
       break;
     }
 
     // Recurse to satisfy any unsatisfied dependencies.
     // FIXME: Don't recurse in the iterative type checker, silly!
     for (auto dependency : unsatisfied) {
-      satisfy(dependency);
+      satisfyDependency(dependency);
     }
   }
 }
@@ -228,23 +228,24 @@ static void addImplicitConformances(
 static void validateAttributes(TypeChecker &TC, Decl *D);
 
 void TypeChecker::resolveSuperclass(ClassDecl *classDecl) {
-  IterativeTypeChecker ITC(*this);
-  ITC.satisfy(requestTypeCheckSuperclass(classDecl));
+  getIterativeTypeChecker().satisfy(requestTypeCheckSuperclass(classDecl));
 }
 
 void TypeChecker::resolveRawType(EnumDecl *enumDecl) {
-  IterativeTypeChecker ITC(*this);
-  ITC.satisfy(requestTypeCheckRawType(enumDecl));
+  getIterativeTypeChecker().satisfy(requestTypeCheckRawType(enumDecl));
 }
 
 void TypeChecker::resolveInheritedProtocols(ProtocolDecl *protocol) {
-  IterativeTypeChecker ITC(*this);
-  ITC.satisfy(requestInheritedProtocols(protocol));
+  getIterativeTypeChecker().satisfy(requestInheritedProtocols(protocol));
+}
+
+void TypeChecker::resolveDeclSignature(ValueDecl *VD) {
+  getIterativeTypeChecker().satisfy(requestResolveDeclSignature(VD));
 }
 
 void TypeChecker::resolveInheritanceClause(
        llvm::PointerUnion<TypeDecl *, ExtensionDecl *> decl) {
-  IterativeTypeChecker ITC(*this);
+  auto &ITC = getIterativeTypeChecker();
   unsigned numInherited;
   if (auto ext = decl.dyn_cast<ExtensionDecl *>()) {
     numInherited = ext->getInherited().size();
@@ -3863,8 +3864,7 @@ public:
         options |= TR_KnownNonCascadingDependency;
       
       if (TAD->getDeclContext()->isModuleScopeContext()) {
-        IterativeTypeChecker ITC(TC);
-        ITC.satisfy(requestResolveTypeDecl(TAD));
+        TC.getIterativeTypeChecker().satisfy(requestResolveTypeDecl(TAD));
       } else if (TC.validateType(TAD->getUnderlyingTypeLoc(),
                                  TAD->getDeclContext(), options)) {
         TAD->setInvalid();
@@ -481,13 +481,26 @@ static Type getResultType(TypeChecker &TC, FuncDecl *fn, Type resultType) {
 void TypeChecker::validateGenericFuncSignature(AbstractFunctionDecl *func) {
   bool invalid = false;
 
-  // Create the archetype builder.
-  ArchetypeBuilder builder = createArchetypeBuilder(func->getParentModule());
+  // A function without generic parameters of its own has the generic
+  // signature of its context, so share one archetype builder among all such
+  // members of the context rather than adding the requirements of the context
+  // to a fresh builder for each of them.
+  auto *module = func->getParentModule();
+  auto *parentSig = func->getDeclContext()->getGenericSignatureOfContext();
+  ArchetypeBuilder *sharedBuilder = nullptr;
+  Optional<ArchetypeBuilder> freshBuilder;
+  if (!func->getGenericParams() && parentSig)
+    sharedBuilder = Context.getOrCreateContextArchetypeBuilder(parentSig,
+                                                               module);
+  else
+    freshBuilder.emplace(createArchetypeBuilder(module));
+  ArchetypeBuilder &builder = sharedBuilder ? *sharedBuilder : *freshBuilder;
 
   // Type check the function declaration, treating all generic type
   // parameters as dependent, unresolved.
   DependentGenericTypeResolver dependentResolver(builder);
-  if (checkGenericFuncSignature(*this, &builder, func, dependentResolver))
+  if (checkGenericFuncSignature(*this, sharedBuilder ? nullptr : &builder,
+                                func, dependentResolver))
     invalid = true;
 
   // If this triggered a recursive validation, back out: we're done.
@@ -495,8 +508,17 @@ void TypeChecker::validateGenericFuncSignature(AbstractFunctionDecl *func) {
   if (func->hasType())
     return;
 
-  // Finalize the generic requirements.
-  (void)builder.finalize(func->getLoc());
+  // Finalize the generic requirements. A shared builder doesn't need it unless
+  // the signature named nested types that don't exist; diagnosing those
+  // changes the builder, so stop sharing it.
+  bool finalized = false;
+  if (!sharedBuilder || builder.hasUnresolvedNestedTypes()) {
+    (void)builder.finalize(func->getLoc());
+    finalized = true;
+
+    if (sharedBuilder)
+      Context.retireContextArchetypeBuilder(parentSig, module);
+  }
 
   // The archetype builder now has all of the requirements, although there might
   // still be errors that have not yet been diagnosed. Revert the generic
@@ -515,7 +537,9 @@ void TypeChecker::validateGenericFuncSignature(AbstractFunctionDecl *func) {
                            func->getDeclContext()->getGenericSignatureOfContext(),
                            allGenericParams);
 
-  auto sig = builder.getGenericSignature(allGenericParams);
+  // The shared builder holds nothing beyond the signature of the context.
+  auto sig = finalized ? builder.getGenericSignature(allGenericParams)
+                       : parentSig;
 
   // Debugging of the archetype builder and generic signature generation.
   if (Context.LangOpts.DebugGenericSignatures) {
@@ -30,6 +30,7 @@
 #include "swift/AST/TypeWalker.h"
 #include "swift/Basic/Defer.h"
 #include "swift/Sema/IDETypeChecking.h"
+#include "swift/Sema/IterativeTypeChecker.h"
 #include "llvm/ADT/ScopedHashTable.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Support/SaveAndRestore.h"
@@ -4436,6 +4437,11 @@ void TypeChecker::useBridgedNSErrorConformances(DeclContext *dc, Type type) {
 }
 
 void TypeChecker::checkConformance(NormalProtocolConformance *conformance) {
+  getIterativeTypeChecker().satisfy(requestTypeCheckConformance(conformance));
+}
+
+void TypeChecker::checkConformanceImmediately(
+       NormalProtocolConformance *conformance) {
   checkConformsToProtocol(*this, conformance);
 }
 
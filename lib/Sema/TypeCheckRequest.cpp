@@ -16,6 +16,7 @@
 //===----------------------------------------------------------------------===//
 #include "swift/Sema/TypeCheckRequest.h"
 #include "swift/AST/Decl.h"
+#include "swift/AST/ProtocolConformance.h"
 
 using namespace swift;
 
@@ -46,6 +47,8 @@ SourceLoc TypeCheckRequest::getLoc() const {
     return std::get<0>(getTypeResolutionPayload())->getLoc();
 
   DELEGATE_GET_LOC(TypeDeclResolution)
+  DELEGATE_GET_LOC(Value)
+  DELEGATE_GET_LOC(Conformance)
 
 #undef DELEGATE_GET_LOC
   }
@@ -85,6 +88,16 @@ Decl *TypeCheckRequest::getAnchor() const {
 
   NO_DECL_PAYLOAD(TypeResolution)
   DECL_PAYLOAD(TypeDeclResolution)
+  DECL_PAYLOAD(Value)
+
+  case PayloadKind::Conformance: {
+    auto dc = getConformancePayload()->getDeclContext();
+    if (auto nominal = dyn_cast<NominalTypeDecl>(dc))
+      return nominal;
+    if (auto ext = dyn_cast<ExtensionDecl>(dc))
+      return ext;
+    return nullptr;
+  }
 
 #undef NO_DECL_PAYLOAD
 #undef DECL_PAYLOAD
@@ -103,3 +116,42 @@ bool swift::operator==(const TypeCheckRequest &x, const TypeCheckRequest &y) {
 #include "swift/Sema/TypeCheckRequestPayloads.def"
   }
 }
+
+llvm::hash_code swift::hash_value(const TypeCheckRequest &request) {
+  auto kind = request.getKind();
+  switch (TypeCheckRequest::getPayloadKind(kind)) {
+#define HASH_POINTER_PAYLOAD(PayloadName)                               \
+  case TypeCheckRequest::PayloadKind::PayloadName:                      \
+    return llvm::hash_combine(kind, request.get##PayloadName##Payload());
+
+  HASH_POINTER_PAYLOAD(Class)
+  HASH_POINTER_PAYLOAD(Enum)
+
+  case TypeCheckRequest::PayloadKind::InheritedClauseEntry: {
+    auto payload = request.getInheritedClauseEntryPayload();
+    return llvm::hash_combine(kind, payload.first.getOpaqueValue(),
+                              payload.second);
+  }
+
+  HASH_POINTER_PAYLOAD(Protocol)
+
+  case TypeCheckRequest::PayloadKind::DeclContextLookup: {
+    // The location is not part of the identity of a lookup.
+    auto payload = request.getDeclContextLookupPayload();
+    return llvm::hash_combine(kind, payload.DC,
+                              payload.Name.getOpaqueValue());
+  }
+
+  case TypeCheckRequest::PayloadKind::TypeResolution: {
+    auto payload = request.getTypeResolutionPayload();
+    return llvm::hash_combine(kind, std::get<0>(payload),
+                              std::get<1>(payload), std::get<2>(payload));
+  }
+
+  HASH_POINTER_PAYLOAD(TypeDeclResolution)
+  HASH_POINTER_PAYLOAD(Value)
+  HASH_POINTER_PAYLOAD(Conformance)
+
+#undef HASH_POINTER_PAYLOAD
+  }
+}
@@ -25,6 +25,7 @@
 #include "swift/Basic/Range.h"
 #include "swift/Basic/STLExtras.h"
 #include "swift/Basic/SourceManager.h"
+#include "swift/Basic/Trace.h"
 #include "swift/Parse/Lexer.h"
 #include "swift/Parse/LocalContext.h"
 #include "llvm/ADT/DenseMap.h"
@@ -187,6 +188,20 @@ namespace {
   };
 }
 
+/// Returns the name of the trace event for type-checking the body of \p Fn.
+static std::string getBodyTraceName(AnyFunctionRef Fn) {
+  ASTContext &ctx = Fn.getAsDeclContext()->getASTContext();
+  std::string name;
+  llvm::raw_string_ostream OS(name);
+  if (auto *AFD = Fn.getAbstractFunctionDecl())
+    AFD->print(OS, PrintOptions());
+  else
+    OS << "(closure)";
+  OS << " at ";
+  Fn.getLoc().print(OS, ctx.SourceMgr);
+  return OS.str();
+}
+
 static void setAutoClosureDiscriminators(DeclContext *DC, Stmt *S) {
   S->walk(ContextualizeClosures(DC));
 }
@@ -1247,6 +1262,7 @@ bool TypeChecker::typeCheckAbstractFunctionBody(AbstractFunctionDecl *AFD) {
   if (!AFD->getBody())
     return false;
 
+  TraceScope trace("typecheck", [&] { return getBodyTraceName(AFD); });
   Optional<FunctionBodyTimer> timer;
   if (DebugTimeFunctionBodies || WarnLongFunctionBodies)
     timer.emplace(AFD, DebugTimeFunctionBodies, WarnLongFunctionBodies);
@@ -1494,6 +1510,7 @@ bool TypeChecker::typeCheckDestructorBodyUntil(DestructorDecl *DD,
 void TypeChecker::typeCheckClosureBody(ClosureExpr *closure) {
   BraceStmt *body = closure->getBody();
 
+  TraceScope trace("typecheck", [&] { return getBodyTraceName(closure); });
   Optional<FunctionBodyTimer> timer;
   if (DebugTimeFunctionBodies || WarnLongFunctionBodies)
     timer.emplace(closure, DebugTimeFunctionBodies, WarnLongFunctionBodies);
@@ -28,9 +28,11 @@
 #include "swift/AST/TypeRefinementContext.h"
 #include "swift/Basic/STLExtras.h"
 #include "swift/Basic/Timer.h"
+#include "swift/Basic/Trace.h"
 #include "swift/ClangImporter/ClangImporter.h"
 #include "swift/Parse/Lexer.h"
 #include "swift/Sema/IDETypeChecking.h"
+#include "swift/Sema/IterativeTypeChecker.h"
 #include "swift/Strings.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/PointerUnion.h"
@@ -61,6 +63,12 @@ TypeChecker::~TypeChecker() {
   Context.setLazyResolver(nullptr);
 }
 
+IterativeTypeChecker &TypeChecker::getIterativeTypeChecker() {
+  if (!ITC)
+    ITC.reset(new IterativeTypeChecker(*this));
+  return *ITC;
+}
+
 void TypeChecker::handleExternalDecl(Decl *decl) {
   if (auto SD = dyn_cast<StructDecl>(decl)) {
     addImplicitConstructors(SD);
@@ -394,6 +402,37 @@ void TypeChecker::bindExtension(ExtensionDecl *ext) {
   ::bindExtensionDecl(ext, *this);
 }
 
+/// Determine whether the body of the given function can be left
+/// unchecked because no client of the module can inline it.
+static bool canSkipFunctionBody(TypeChecker &TC, AbstractFunctionDecl *AFD) {
+  if (!TC.getSkipNonInlinableFunctionBodies())
+    return false;
+
+  // Constructors and destructors are emitted from their bodies, and
+  // synthesized bodies are cheap to check.
+  if (!isa<FuncDecl>(AFD) || AFD->isImplicit() ||
+      AFD->getBodyKind() != AbstractFunctionDecl::BodyKind::Parsed)
+    return false;
+
+  // The bodies of transparent and always-inline functions may be
+  // serialized, and are inlined even within this module.
+  if (AFD->isTransparent())
+    return false;
+  if (auto attr = AFD->getAttrs().getAttribute<InlineAttr>())
+    if (attr->getKind() == InlineKind::Always)
+      return false;
+
+  return true;
+}
+
+// FIXME: Bodies from different source files are mostly independent, and in
+// WMO mode this loop is a natural place to fan them out across
+// -num-threads workers.  That isn't safe yet: checking a body can validate
+// declarations in other files, allocate from the ASTContext arena, complete
+// conformances in UsedConformances, append to definedFunctions, and emit
+// diagnostics, none of which is synchronized.  Those would need to be made
+// thread-safe (or sharded per worker and merged in source order, to keep
+// diagnostics deterministic) before this can run in parallel.
 static void typeCheckFunctionsAndExternalDecls(TypeChecker &TC) {
   unsigned currentFunctionIdx = 0;
   unsigned currentExternalDef = TC.Context.LastCheckedExternalDefinition;
@@ -410,6 +449,14 @@ static void typeCheckFunctionsAndExternalDecls(TypeChecker &TC) {
       // but that gets tricky with synthesized function bodies.
       if (AFD->isBodyTypeChecked()) continue;
 
+      // Drop a body nothing will look at. Nothing inside it, including
+      // local types and closures, is type-checked or captured.
+      if (canSkipFunctionBody(TC, AFD)) {
+        AFD->setParsedBodySkipped();
+        AFD->getCaptureInfo().setCaptures({});
+        continue;
+      }
+
       PrettyStackTraceDecl StackEntry("type-checking", AFD);
       TC.typeCheckAbstractFunctionBody(AFD);
 
@@ -538,6 +585,19 @@ void swift::typeCheckExternalDefinitions(SourceFile &SF) {
   typeCheckFunctionsAndExternalDecls(TC);
 }
 
+/// Returns the name of the trace event for type-checking the top-level
+/// declaration \p D.
+static std::string getDeclTraceName(Decl *D) {
+  std::string name;
+  llvm::raw_string_ostream OS(name);
+  OS << Decl::getDescriptiveKindName(D->getDescriptiveKind());
+  if (auto *VD = dyn_cast<ValueDecl>(D))
+    OS << ' ' << VD->getFullName();
+  OS << " at ";
+  D->getLoc().print(OS, D->getASTContext().SourceMgr);
+  return OS.str();
+}
+
 void swift::performTypeChecking(SourceFile &SF, TopLevelContext &TLC,
                                 OptionSet<TypeCheckingFlags> Options,
                                 unsigned StartElem,
@@ -563,8 +623,14 @@ void swift::performTypeChecking(SourceFile &SF, TopLevelContext &TLC,
     if (Options.contains(TypeCheckingFlags::DebugTimeFunctionBodies))
       TC.enableDebugTimeFunctionBodies();
 
+    if (Options.contains(TypeCheckingFlags::DebugTimeExpressions))
+      TC.enableDebugTimeExpressions();
+
     if (Options.contains(TypeCheckingFlags::ForImmediateMode))
       TC.setInImmediateMode(true);
+
+    if (Options.contains(TypeCheckingFlags::SkipNonInlinableFunctionBodies))
+      TC.enableSkipNonInlinableFunctionBodies();
     
     // Lookup the swift module.  This ensures that we record all known
     // protocols in the AST.
@@ -604,6 +670,7 @@ void swift::performTypeChecking(SourceFile &SF, TopLevelContext &TLC,
       if (isa<TopLevelCodeDecl>(D))
         continue;
 
+      TraceScope trace("typecheck", [&] { return getDeclTraceName(D); });
       TC.typeCheckDecl(D, /*isFirstPass*/true);
     }
 
@@ -615,6 +682,7 @@ void swift::performTypeChecking(SourceFile &SF, TopLevelContext &TLC,
 
     bool hasTopLevelCode = false;
     for (auto D : llvm::makeArrayRef(SF.Decls).slice(StartElem)) {
+      TraceScope trace("typecheck", [&] { return getDeclTraceName(D); });
       if (TopLevelCodeDecl *TLCD = dyn_cast<TopLevelCodeDecl>(D)) {
         hasTopLevelCode = true;
         // Immediately perform global name-binding etc.
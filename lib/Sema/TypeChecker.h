@@ -32,11 +32,13 @@
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/TinyPtrVector.h"
 #include <functional>
+#include <memory>
 
 namespace swift {
 
 class ArchetypeBuilder;
 class GenericTypeResolver;
+class IterativeTypeChecker;
 class NominalTypeDecl;
 class NormalProtocolConformance;
 class TopLevelContext;
@@ -549,6 +551,10 @@ public:
   llvm::DenseMap<AnyFunctionRef, std::vector<Expr*>> LocalCFunctionPointers;
 
 private:
+  /// The iterative type checker that evaluates and remembers the
+  /// requests made of this type checker, created on first use.
+  std::unique_ptr<IterativeTypeChecker> ITC;
+
   /// Return statements with functions as return values.
   llvm::DenseMap<AbstractFunctionDecl *, llvm::DenseSet<ReturnStmt *>>
     FunctionAsReturnValue;
@@ -558,6 +564,10 @@ private:
     FunctionAsEscapingArg;
 
 public:
+  /// Retrieve the iterative type checker that evaluates type check
+  /// requests for this type checker.
+  IterativeTypeChecker &getIterativeTypeChecker();
+
   /// Record an occurrence of a function that captures inout values as an
   /// argument.
   ///
@@ -645,11 +655,19 @@ private:
   /// to llvm::errs().
   bool DebugTimeFunctionBodies = false;
 
+  /// If true, the time and the solver statistics of type-checking each
+  /// expression will be dumped to llvm::errs().
+  bool DebugTimeExpressions = false;
+
   /// Indicate that the type checker is checking code that will be
   /// immediately executed. This will suppress certain warnings
   /// when executing scripts.
   bool InImmediateMode = false;
 
+  /// If true, the bodies of functions that can't be inlined into clients
+  /// are not type-checked.
+  bool SkipNonInlinableFunctionBodies = false;
+
   /// A helper to construct and typecheck call to super.init().
   ///
   /// \returns NULL if the constructed expression does not typecheck.
@@ -667,6 +685,16 @@ public:
     DebugTimeFunctionBodies = true;
   }
 
+  /// Dump the time and the solver statistics of type-checking each
+  /// expression to llvm::errs().
+  void enableDebugTimeExpressions() {
+    DebugTimeExpressions = true;
+  }
+
+  bool getDebugTimeExpressions() const {
+    return DebugTimeExpressions;
+  }
+
   /// If \p timeInMS is non-zero, warn when a function body takes longer than
   /// this many milliseconds to type-check.
   ///
@@ -683,6 +711,16 @@ public:
     this->InImmediateMode = InImmediateMode;
   }
 
+  /// Only type-check the bodies of @_transparent and @inline(__always)
+  /// functions, which may be serialized for clients to inline.
+  void enableSkipNonInlinableFunctionBodies() {
+    SkipNonInlinableFunctionBodies = true;
+  }
+
+  bool getSkipNonInlinableFunctionBodies() const {
+    return SkipNonInlinableFunctionBodies;
+  }
+
   template<typename ...ArgTypes>
   InFlightDiagnostic diagnose(ArgTypes &&...Args) {
     return Diags.diagnose(std::forward<ArgTypes>(Args)...);
@@ -982,9 +1020,7 @@ public:
     validateAccessibility(VD);
   }
 
-  virtual void resolveDeclSignature(ValueDecl *VD) override {
-    validateDecl(VD, true);
-  }
+  virtual void resolveDeclSignature(ValueDecl *VD) override;
 
   virtual void bindExtension(ExtensionDecl *ext) override;
 
@@ -1592,6 +1628,10 @@ public:
   /// Completely check the given conformance.
   void checkConformance(NormalProtocolConformance *conformance);
 
+  /// Check the given conformance, even if the iterative type checker
+  /// already knows it to be complete.
+  void checkConformanceImmediately(NormalProtocolConformance *conformance);
+
   /// Check all of the conformances in the given context.
   void checkConformancesInContext(DeclContext *dc,
                                   IterableDeclContext *idc);
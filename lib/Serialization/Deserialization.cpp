@@ -1431,7 +1431,7 @@ Identifier ModuleFile::getIdentifier(IdentifierID IID) {
 
   size_t rawID = IID - NUM_SPECIAL_MODULES;
   assert(rawID < Identifiers.size() && "invalid identifier ID");
-  auto identRecord = Identifiers[rawID];
+  auto &identRecord = Identifiers[rawID];
 
   if (identRecord.Offset == 0)
     return identRecord.Ident;
@@ -1443,7 +1443,10 @@ Identifier ModuleFile::getIdentifier(IdentifierID IID) {
   assert(terminatorOffset != StringRef::npos &&
          "unterminated identifier string data");
 
-  return getContext().getIdentifier(rawStrPtr.slice(0, terminatorOffset));
+  identRecord.Ident =
+    getContext().getIdentifier(rawStrPtr.slice(0, terminatorOffset));
+  identRecord.Offset = 0;
+  return identRecord.Ident;
 }
 
 DeclContext *ModuleFile::getLocalDeclContext(DeclContextID DCID) {
@@ -986,43 +986,52 @@ ModuleFile::ModuleFile(
     return;
   }
 
-  if (!this->ModuleDocInputBuffer)
-    return;
+  // The module documentation file is only read when a client first asks for
+  // a comment or a group name. Until then its buffer is just mapped.
+}
 
+bool ModuleFile::readModuleDocBlocks() {
   llvm::BitstreamCursor docCursor{ModuleDocInputReader};
   if (!checkModuleDocSignature(docCursor) ||
-      !enterTopLevelModuleBlock(docCursor, MODULE_DOC_BLOCK_ID)) {
-    error(Status::MalformedDocumentation);
-    return;
-  }
+      !enterTopLevelModuleBlock(docCursor, MODULE_DOC_BLOCK_ID))
+    return false;
 
-  topLevelEntry = docCursor.advance();
+  auto topLevelEntry = docCursor.advance();
   while (topLevelEntry.Kind == llvm::BitstreamEntry::SubBlock) {
     switch (topLevelEntry.ID) {
     case COMMENT_BLOCK_ID: {
-      if (!hasValidControlBlock || !readCommentBlock(docCursor)) {
-        error(Status::MalformedDocumentation);
-        return;
-      }
+      if (!readCommentBlock(docCursor))
+        return false;
       break;
     }
 
     default:
       // Unknown top-level block, possibly for use by a future version of the
       // module format.
-      if (docCursor.SkipBlock()) {
-        error(Status::MalformedDocumentation);
-        return;
-      }
+      if (docCursor.SkipBlock())
+        return false;
       break;
     }
 
     topLevelEntry = docCursor.advance(AF_DontPopBlockAtEnd);
   }
 
-  if (topLevelEntry.Kind != llvm::BitstreamEntry::EndBlock) {
-    error(Status::MalformedDocumentation);
+  return topLevelEntry.Kind == llvm::BitstreamEntry::EndBlock;
+}
+
+void ModuleFile::readModuleDoc() {
+  assert(!Bits.ReadModuleDoc && "module documentation already read");
+  Bits.ReadModuleDoc = true;
+  if (!ModuleDocInputBuffer)
     return;
+
+  PrettyModuleFileDeserialization stackEntry(*this);
+
+  // By now the module is in use, so a malformed documentation file can't
+  // fail the import any more; it just doesn't provide any comments.
+  if (!readModuleDocBlocks()) {
+    DeclCommentTable.reset();
+    GroupNamesMap.reset();
   }
 }
 
@@ -1554,6 +1563,7 @@ Optional<CommentInfo> ModuleFile::getCommentForDecl(const Decl *D) const {
   assert(D->getDeclContext()->getModuleScopeContext() == FileContext &&
          "Decl is from a different serialized file");
 
+  readModuleDocIfNeeded();
   if (!DeclCommentTable)
     return None;
 
@@ -1589,6 +1599,7 @@ Optional<CommentInfo> ModuleFile::getCommentForDecl(const Decl *D) const {
 const static StringRef Separator = "/";
 
 Optional<StringRef> ModuleFile::getGroupNameById(unsigned Id) const {
+  readModuleDocIfNeeded();
   if (!GroupNamesMap || GroupNamesMap->count(Id) == 0)
     return None;
   auto Original = (*GroupNamesMap)[Id];
@@ -1600,6 +1611,7 @@ Optional<StringRef> ModuleFile::getGroupNameById(unsigned Id) const {
 }
 
 Optional<StringRef> ModuleFile::getSourceFileNameById(unsigned Id) const {
+  readModuleDocIfNeeded();
   if (!GroupNamesMap || GroupNamesMap->count(Id) == 0)
     return None;
   auto Original = (*GroupNamesMap)[Id];
@@ -1640,6 +1652,7 @@ ModuleFile::getSourceOrderForDecl(const Decl *D) const {
 }
 
 void ModuleFile::collectAllGroups(std::vector<StringRef> &Names) const {
+  readModuleDocIfNeeded();
   if (!GroupNamesMap)
     return;
   for (auto It = GroupNamesMap->begin(); It != GroupNamesMap->end(); ++ It) {
@@ -1658,6 +1671,7 @@ void ModuleFile::collectAllGroups(std::vector<StringRef> &Names) const {
 
 Optional<CommentInfo>
 ModuleFile::getCommentForDeclByUSR(StringRef USR) const {
+  readModuleDocIfNeeded();
   if (!DeclCommentTable)
     return None;
 
@@ -3866,6 +3866,18 @@ static void writeObjCMethodTable(const index_block::ObjCMethodTableLayout &out,
   out.emit(scratch, tableOffset, hashTableBlob);
 }
 
+/// Determine whether the given local type is inside the body of a function
+/// that was skipped during type checking, and so has no types.
+static bool isInSkippedFunctionBody(const TypeDecl *TD) {
+  for (auto dc = TD->getDeclContext(); dc->isLocalContext();
+       dc = dc->getParent()) {
+    if (auto AFD = dyn_cast<AbstractFunctionDecl>(dc))
+      if (AFD->getBodyKind() == AbstractFunctionDecl::BodyKind::Skipped)
+        return true;
+  }
+  return false;
+}
+
 /// Add operator methods from the given declaration type.
 ///
 /// Recursively walks the members and derived global decls of any nested
@@ -3991,6 +4003,9 @@ void Serializer::writeAST(ModuleOrSourceFile DC) {
     nextFile->getLocalTypeDecls(localTypeDecls);
 
     for (auto TD : localTypeDecls) {
+      if (isInSkippedFunctionBody(TD))
+        continue;
+
       hasLocalTypes = true;
 
       Mangle::Mangler DebugMangler(false);
@@ -4166,12 +4181,18 @@ void swift::serialize(ModuleOrSourceFile DC,
   if (hadError)
     return;
 
-  if (options.DocOutputPath && options.DocOutputPath[0] != '\0') {
-    (void)withOutputFile(getContext(DC), options.DocOutputPath,
-                         [&](raw_ostream &out) {
-      SharedTimer timer("Serialization (swiftdoc)");
-      Serializer::writeDocToStream(out, DC, options.GroupInfoPath,
-                                   getContext(DC));
-    });
-  }
+  serializeDoc(DC, options);
+}
+
+void swift::serializeDoc(ModuleOrSourceFile DC,
+                         const SerializationOptions &options) {
+  if (!options.DocOutputPath || options.DocOutputPath[0] == '\0')
+    return;
+
+  (void)withOutputFile(getContext(DC), options.DocOutputPath,
+                       [&](raw_ostream &out) {
+    SharedTimer timer("Serialization (swiftdoc)");
+    Serializer::writeDocToStream(out, DC, options.GroupInfoPath,
+                                 getContext(DC));
+  });
 }
@@ -1251,6 +1251,20 @@ const TypeInfo *TypeConverter::getTypeInfo(const TypeRef *TR) {
 const TypeInfo *TypeConverter::getClassInstanceTypeInfo(const TypeRef *TR,
                                                         unsigned start,
                                                         unsigned align) {
+  auto key = std::make_pair(TR, std::make_pair(start, align));
+  auto found = ClassInstanceCache.find(key);
+  if (found != ClassInstanceCache.end())
+    return found->second;
+
+  auto *TI = computeClassInstanceTypeInfo(TR, start, align);
+  ClassInstanceCache[key] = TI;
+  return TI;
+}
+
+const TypeInfo *
+TypeConverter::computeClassInstanceTypeInfo(const TypeRef *TR,
+                                            unsigned start,
+                                            unsigned align) {
   const FieldDescriptor *FD = getBuilder().getFieldTypeInfo(TR);
   if (FD == nullptr) {
     DEBUG(std::cerr << "No field descriptor: "; TR->dump());
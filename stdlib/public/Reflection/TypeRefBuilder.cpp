@@ -28,6 +28,38 @@ using namespace reflection;
 
 TypeRefBuilder::TypeRefBuilder() : TC(*this) {}
 
+void TypeRefBuilder::addReflectionInfo(ReflectionInfo I) {
+  ReflectionInfos.push_back(I);
+
+  // Index the records, so that lookups don't have to scan the sections of
+  // every image.
+  for (auto &FD : I.fieldmd) {
+    if (FD.hasMangledTypeName())
+      FieldDescriptors.insert({FD.getMangledTypeName(), &FD});
+  }
+
+  for (auto &AssocTyDescriptor : I.assocty) {
+    auto ConformingTypeName = AssocTyDescriptor.getMangledConformingTypeName();
+    AssociatedTypeDescriptors[ConformingTypeName].push_back(&AssocTyDescriptor);
+  }
+
+  for (auto &BuiltinTypeDescriptor : I.builtin) {
+    assert(BuiltinTypeDescriptor.Size > 0);
+    assert(BuiltinTypeDescriptor.Alignment > 0);
+    assert(BuiltinTypeDescriptor.Stride > 0);
+    if (BuiltinTypeDescriptor.hasMangledTypeName())
+      BuiltinTypeDescriptors.insert({BuiltinTypeDescriptor.getMangledTypeName(),
+                                     &BuiltinTypeDescriptor});
+  }
+
+  for (auto &CD : I.capture) {
+    auto RemoteAddress = ((uintptr_t) &CD -
+                          I.LocalStartAddress +
+                          I.RemoteStartAddress);
+    CaptureDescriptors.insert({RemoteAddress, &CD});
+  }
+}
+
 const TypeRef * TypeRefBuilder::
 lookupTypeWitness(const std::string &MangledTypeName,
                   const std::string &Member,
@@ -40,32 +72,30 @@ lookupTypeWitness(const std::string &MangledTypeName,
   if (found != AssociatedTypeCache.end())
     return found->second;
 
-  // Cache missed - we need to look through all of the assocty sections
-  // for all images that we've been notified about.
-  for (auto &Info : ReflectionInfos) {
-    for (const auto &AssocTyDescriptor : Info.assocty) {
-      std::string ConformingTypeName(AssocTyDescriptor.ConformingTypeName);
-      if (ConformingTypeName.compare(MangledTypeName) != 0)
-        continue;
+  // Cache missed - we need to look through all of the assocty descriptors
+  // of the conforming type.
+  auto Descriptors = AssociatedTypeDescriptors.find(MangledTypeName);
+  if (Descriptors == AssociatedTypeDescriptors.end())
+    return nullptr;
 
-      std::string ProtocolMangledName(AssocTyDescriptor.ProtocolTypeName);
-      auto DemangledProto = Demangle::demangleTypeAsNode(ProtocolMangledName);
-      auto TR = swift::remote::decodeMangledType(*this, DemangledProto);
+  for (auto *AssocTyDescriptor : Descriptors->second) {
+    std::string ProtocolMangledName(AssocTyDescriptor->ProtocolTypeName);
+    auto DemangledProto = Demangle::demangleTypeAsNode(ProtocolMangledName);
+    auto TR = swift::remote::decodeMangledType(*this, DemangledProto);
 
-      if (Protocol != TR)
-        continue;
+    if (Protocol != TR)
+      continue;
 
-      for (auto &AssocTy : AssocTyDescriptor) {
-        if (Member.compare(AssocTy.getName()) != 0)
-          continue;
+    for (auto &AssocTy : *AssocTyDescriptor) {
+      if (Member.compare(AssocTy.getName()) != 0)
+        continue;
 
-        auto SubstitutedTypeName = AssocTy.getMangledSubstitutedTypeName();
-        auto Demangled = Demangle::demangleTypeAsNode(SubstitutedTypeName);
-        auto *TypeWitness = swift::remote::decodeMangledType(*this, Demangled);
+      auto SubstitutedTypeName = AssocTy.getMangledSubstitutedTypeName();
+      auto Demangled = Demangle::demangleTypeAsNode(SubstitutedTypeName);
+      auto *TypeWitness = swift::remote::decodeMangledType(*this, Demangled);
 
-        AssociatedTypeCache.insert(std::make_pair(key, TypeWitness));
-        return TypeWitness;
-      }
+      AssociatedTypeCache.insert(std::make_pair(key, TypeWitness));
+      return TypeWitness;
     }
   }
   return nullptr;
@@ -108,19 +138,10 @@ TypeRefBuilder::getFieldTypeInfo(const TypeRef *TR) {
   else
     return {};
 
-  std::vector<std::pair<std::string, const TypeRef *>> Fields;
-  for (auto Info : ReflectionInfos) {
-    for (auto &FD : Info.fieldmd) {
-      if (!FD.hasMangledTypeName())
-        continue;
-      auto CandidateMangledName = FD.getMangledTypeName();
-      if (MangledName.compare(CandidateMangledName) != 0)
-        continue;
-      return &FD;
-    }
-  }
-
-  return nullptr;
+  auto found = FieldDescriptors.find(MangledName);
+  if (found == FieldDescriptors.end())
+    return nullptr;
+  return found->second;
 }
 
 std::vector<FieldTypeInfo>
@@ -168,36 +189,18 @@ TypeRefBuilder::getBuiltinTypeInfo(const TypeRef *TR) {
   else
     return nullptr;
 
-  for (auto Info : ReflectionInfos) {
-    for (auto &BuiltinTypeDescriptor : Info.builtin) {
-      assert(BuiltinTypeDescriptor.Size > 0);
-      assert(BuiltinTypeDescriptor.Alignment > 0);
-      assert(BuiltinTypeDescriptor.Stride > 0);
-      if (!BuiltinTypeDescriptor.hasMangledTypeName())
-        continue;
-      auto CandidateMangledName = BuiltinTypeDescriptor.getMangledTypeName();
-      if (MangledName.compare(CandidateMangledName) != 0)
-        continue;
-      return &BuiltinTypeDescriptor;
-    }
-  }
-
-  return nullptr;
+  auto found = BuiltinTypeDescriptors.find(MangledName);
+  if (found == BuiltinTypeDescriptors.end())
+    return nullptr;
+  return found->second;
 }
 
 const CaptureDescriptor *
 TypeRefBuilder::getCaptureDescriptor(uintptr_t RemoteAddress) {
-  for (auto Info : ReflectionInfos) {
-    for (auto &CD : Info.capture) {
-      auto OtherAddr = ((uintptr_t) &CD -
-                        Info.LocalStartAddress +
-                        Info.RemoteStartAddress);
-      if (OtherAddr == RemoteAddress)
-        return &CD;
-    }
-  }
-
-  return nullptr;
+  auto found = CaptureDescriptors.find(RemoteAddress);
+  if (found == CaptureDescriptors.end())
+    return nullptr;
+  return found->second;
 }
 
 /// Get the unsubstituted capture types for a closure context.
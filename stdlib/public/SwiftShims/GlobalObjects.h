@@ -50,6 +50,16 @@ struct _SwiftHashingSecretKey _swift_stdlib_Hashing_secretKey;
 extern SWIFT_RUNTIME_STDLIB_INTERFACE
 __swift_uint64_t _swift_stdlib_HashingDetail_fixedSeedOverride;
 
+/// Nonzero if strings are hashed with a fast hash that is not resistant to
+/// hash flooding, instead of SipHash.
+extern SWIFT_RUNTIME_STDLIB_INTERFACE
+__swift_uint8_t _swift_stdlib_Hashing_usesFastHashing;
+
+/// Storage shared by all strings consisting of a single ASCII character.
+/// Character `c` is at offset `2 * c`, followed by a null terminator.
+extern SWIFT_RUNTIME_STDLIB_INTERFACE
+__swift_uint8_t _swift_stdlib_asciiCharacterStorage[256];
+
 #ifdef __cplusplus
 }} // extern "C", namespace swift
 #endif
@@ -54,21 +54,28 @@ class StrongRefCount {
 
   // The low bit is the pinned marker.
   // The next bit is the deallocating marker.
+  // The next bit is the immortal marker.
   // The remaining bits are the reference count.
   // refCount == RC_ONE means reference count == 1.
+  //
+  // Immortal objects are statically allocated and never deallocated, e.g.
+  // the empty array singleton. Retains and releases of an immortal object
+  // don't write to the reference count at all, which avoids cache line
+  // contention when many threads use the same object.
   enum : uint32_t {
     RC_PINNED_FLAG = 0x1,
     RC_DEALLOCATING_FLAG = 0x2,
+    RC_IMMORTAL_FLAG = 0x4,
 
-    RC_FLAGS_COUNT = 2,
-    RC_FLAGS_MASK = 3,
+    RC_FLAGS_COUNT = 3,
+    RC_FLAGS_MASK = 7,
     RC_COUNT_MASK = ~RC_FLAGS_MASK,
 
     RC_ONE = RC_FLAGS_MASK + 1
   };
 
-  static_assert(RC_ONE == RC_DEALLOCATING_FLAG << 1,
-                "deallocating bit must be adjacent to refcount bits");
+  static_assert(RC_ONE == RC_IMMORTAL_FLAG << 1,
+                "immortal bit must be adjacent to refcount bits");
   static_assert(RC_ONE == 1 << RC_FLAGS_COUNT,
                 "inconsistent refcount flags");
   static_assert(RC_ONE == 1 + RC_FLAGS_MASK,
@@ -76,6 +83,7 @@ class StrongRefCount {
 
  public:
   enum Initialized_t { Initialized };
+  enum Immortal_t { Immortal };
 
   // StrongRefCount must be trivially constructible to avoid ObjC++
   // destruction overhead at runtime. Use StrongRefCount(Initialized) to produce
@@ -86,16 +94,26 @@ class StrongRefCount {
   constexpr StrongRefCount(Initialized_t)
     : refCount(RC_ONE) { }
 
+  // Refcount of a statically allocated object that is never deallocated.
+  // All count bits are set as well, so that the object is never considered
+  // to be uniquely referenced.
+  constexpr StrongRefCount(Immortal_t)
+    : refCount(RC_COUNT_MASK | RC_IMMORTAL_FLAG) { }
+
   void init() {
     refCount = RC_ONE;
   }
 
   // Increment the reference count.
   void increment() {
+    if (isImmortal())
+      return;
     __atomic_fetch_add(&refCount, RC_ONE, __ATOMIC_RELAXED);
   }
 
   void incrementNonAtomic() {
+    if (isImmortal())
+      return;
     uint32_t val = __atomic_load_n(&refCount, __ATOMIC_RELAXED);
     val += RC_ONE;
     __atomic_store_n(&refCount, val, __ATOMIC_RELAXED);
@@ -103,10 +121,14 @@ class StrongRefCount {
 
   // Increment the reference count by n.
   void increment(uint32_t n) {
+    if (isImmortal())
+      return;
     __atomic_fetch_add(&refCount, n << RC_FLAGS_COUNT, __ATOMIC_RELAXED);
   }
 
   void incrementNonAtomic(uint32_t n) {
+    if (isImmortal())
+      return;
     uint32_t val = __atomic_load_n(&refCount, __ATOMIC_RELAXED);
     val += n << RC_FLAGS_COUNT;
     __atomic_store_n(&refCount, val, __ATOMIC_RELAXED);
@@ -120,12 +142,13 @@ class StrongRefCount {
   //
   // Returns true if the flag was set by this operation.
   //
-  // Postcondition: the flag is set.
+  // Postcondition: the flag is set, or the object is immortal.
   bool tryIncrementAndPin() {
     uint32_t oldval = __atomic_load_n(&refCount, __ATOMIC_RELAXED);
     while (true) {
-      // If the flag is already set, just fail.
-      if (oldval & RC_PINNED_FLAG) {
+      // If the flag is already set, just fail. Immortal objects are never
+      // pinned, but they don't need to be: they are never deallocated.
+      if (oldval & (RC_PINNED_FLAG | RC_IMMORTAL_FLAG)) {
         return false;
       }
 
@@ -143,7 +166,7 @@ class StrongRefCount {
   bool tryIncrementAndPinNonAtomic() {
     uint32_t oldval = __atomic_load_n(&refCount, __ATOMIC_RELAXED);
     // If the flag is already set, just fail.
-    if (oldval & RC_PINNED_FLAG) {
+    if (oldval & (RC_PINNED_FLAG | RC_IMMORTAL_FLAG)) {
       return false;
     }
 
@@ -155,6 +178,8 @@ class StrongRefCount {
 
   // Increment the reference count, unless the object is deallocating.
   bool tryIncrement() {
+    if (isImmortal())
+      return true;
     // FIXME: this could be better on LL/SC architectures like arm64
     uint32_t oldval = __atomic_fetch_add(&refCount, RC_ONE, __ATOMIC_RELAXED);
     if (oldval & RC_DEALLOCATING_FLAG) {
@@ -221,9 +246,10 @@ class StrongRefCount {
     auto value = __atomic_load_n(&refCount, __ATOMIC_RELAXED);
     // Rotating right by one sets the sign bit to the pinned bit. After
     // rotation, the dealloc flag is the least significant bit followed by the
-    // reference count. A reference count of two or higher means that our value
-    // is bigger than 3 if the pinned bit is not set. If the pinned bit is set
-    // the value is negative.
+    // immortal flag and the reference count. A reference count of two or
+    // higher means that our value is at least RC_ONE if the pinned bit is not
+    // set. If the pinned bit is set the value is negative. Immortal objects
+    // have all count bits set and are never uniquely referenced.
     // Note: Because we are using the sign bit for testing pinnedness it
     // is important to do a signed comparison below.
     static_assert(RC_PINNED_FLAG == 1,
@@ -237,9 +263,19 @@ class StrongRefCount {
     return __atomic_load_n(&refCount, __ATOMIC_RELAXED) & RC_DEALLOCATING_FLAG;
   }
 
+  // Return true if the object is never deallocated. The flag is only set by
+  // static initialization, so a relaxed load is sufficient.
+  bool isImmortal() const {
+    return __atomic_load_n(&refCount, __ATOMIC_RELAXED) & RC_IMMORTAL_FLAG;
+  }
+
 private:
   template <bool ClearPinnedFlag>
   bool doDecrementShouldDeallocate() {
+    // Immortal objects are never deallocated.
+    if (isImmortal())
+      return false;
+
     // If we're being asked to clear the pinned flag, we can assume
     // it's already set.
     constexpr uint32_t quantum =
@@ -267,7 +303,7 @@ private:
     // with weak retains.
     //
     // This also performs the before-deinit acquire barrier if we set the flag.
-    static_assert(RC_FLAGS_COUNT == 2,
+    static_assert(RC_FLAGS_COUNT == 3,
                   "fix decrementShouldDeallocate() if you add more flags");
     uint32_t oldval = 0;
     newval = RC_DEALLOCATING_FLAG;
@@ -277,6 +313,10 @@ private:
 
   template <bool ClearPinnedFlag>
   bool doDecrementShouldDeallocateNonAtomic() {
+    // Immortal objects are never deallocated.
+    if (isImmortal())
+      return false;
+
     // If we're being asked to clear the pinned flag, we can assume
     // it's already set.
     constexpr uint32_t quantum =
@@ -307,7 +347,7 @@ private:
     // with weak retains.
     //
     // This also performs the before-deinit acquire barrier if we set the flag.
-    static_assert(RC_FLAGS_COUNT == 2,
+    static_assert(RC_FLAGS_COUNT == 3,
                   "fix decrementShouldDeallocate() if you add more flags");
     uint32_t oldval = 0;
     newval = RC_DEALLOCATING_FLAG;
@@ -317,6 +357,10 @@ private:
 
   template <bool ClearPinnedFlag>
   bool doDecrementShouldDeallocateN(uint32_t n) {
+    // Immortal objects are never deallocated.
+    if (isImmortal())
+      return false;
+
     // If we're being asked to clear the pinned flag, we can assume
     // it's already set.
     uint32_t delta = (n << RC_FLAGS_COUNT) + (ClearPinnedFlag ? RC_PINNED_FLAG : 0);
@@ -343,7 +387,7 @@ private:
     // with weak retains.
     //
     // This also performs the before-deinit acquire barrier if we set the flag.
-    static_assert(RC_FLAGS_COUNT == 2,
+    static_assert(RC_FLAGS_COUNT == 3,
                   "fix decrementShouldDeallocate() if you add more flags");
     uint32_t oldval = 0;
     newval = RC_DEALLOCATING_FLAG;
@@ -353,6 +397,10 @@ private:
 
   template <bool ClearPinnedFlag>
   bool doDecrementShouldDeallocateNNonAtomic(uint32_t n) {
+    // Immortal objects are never deallocated.
+    if (isImmortal())
+      return false;
+
     // If we're being asked to clear the pinned flag, we can assume
     // it's already set.
     uint32_t delta = (n << RC_FLAGS_COUNT) + (ClearPinnedFlag ? RC_PINNED_FLAG : 0);
@@ -382,7 +430,7 @@ private:
     // with weak retains.
     //
     // This also performs the before-deinit acquire barrier if we set the flag.
-    static_assert(RC_FLAGS_COUNT == 2,
+    static_assert(RC_FLAGS_COUNT == 3,
                   "fix decrementShouldDeallocate() if you add more flags");
     uint32_t oldval = 0;
     newval = RC_DEALLOCATING_FLAG;
@@ -397,9 +445,11 @@ private:
 class WeakRefCount {
   uint32_t refCount;
 
+  // The low bit is set once a weak reference side table entry has been
+  // created for the object.
+  // The remaining bits are the reference count.
   enum : uint32_t {
-    // There isn't really a flag here.
-    RC_UNUSED_FLAG = 1,
+    RC_SIDE_TABLE_FLAG = 1,
 
     RC_FLAGS_COUNT = 1,
     RC_FLAGS_MASK = 1,
@@ -476,6 +526,18 @@ class WeakRefCount {
   uint32_t getCount() const {
     return __atomic_load_n(&refCount, __ATOMIC_RELAXED) >> RC_FLAGS_COUNT;
   }
+
+  // Return true if a weak reference side table entry has been created for
+  // the object.
+  bool hasSideTable() const {
+    return __atomic_load_n(&refCount, __ATOMIC_RELAXED) & RC_SIDE_TABLE_FLAG;
+  }
+
+  // Record that a weak reference side table entry has been created for the
+  // object. The flag is never cleared.
+  void setHasSideTable() {
+    __atomic_fetch_or(&refCount, RC_SIDE_TABLE_FLAG, __ATOMIC_RELAXED);
+  }
 };
 
 static_assert(swift::IsTriviallyConstructible<StrongRefCount>::value,
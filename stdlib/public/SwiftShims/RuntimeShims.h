@@ -18,6 +18,7 @@
 #ifndef SWIFT_STDLIB_SHIMS_RUNTIMESHIMS_H
 #define SWIFT_STDLIB_SHIMS_RUNTIMESHIMS_H
 
+#include "SwiftStdbool.h"
 #include "SwiftStddef.h"
 #include "SwiftStdint.h"
 #include "Visibility.h"
@@ -56,6 +57,38 @@ int _swift_stdlib_putc_stderr(int C);
 SWIFT_RUNTIME_STDLIB_INTERFACE
 __swift_size_t _swift_stdlib_getHardwareConcurrency();
 
+/// A stored property of a struct or class, as returned by
+/// _swift_getFieldLayout.
+struct _SwiftFieldLayoutEntry {
+  /// The name of the property.
+  const char *name;
+  /// The type metadata of the property.
+  const void *type;
+  /// The offset of the property from the start of the value, or of the
+  /// heap object for classes.
+  __swift_uintptr_t offset;
+  /// Whether the property is a weak reference.
+  __swift_bool isWeak;
+};
+
+/// Return the stored properties of the type with metadata \p type, including
+/// those inherited from superclasses, and set \p outCount to their number.
+/// The result is cached and stays valid for the life of the process.
+/// Return NULL if the layout of the type can't be described this way, for
+/// example because it is not a struct or native Swift class.
+SWIFT_RUNTIME_STDLIB_INTERFACE
+const struct _SwiftFieldLayoutEntry *
+_swift_getFieldLayout(const void *type, __swift_intptr_t *outCount);
+
+/// Call \p body with \p context and each index in [0, \p count), on the
+/// runtime's pool of worker threads, and return when all the calls returned.
+/// The calls run concurrently in no particular order, and \p body may call
+/// _swift_parallelFor itself.
+SWIFT_RUNTIME_STDLIB_INTERFACE
+void _swift_parallelFor(__swift_size_t count,
+                        void (*body)(void *context, __swift_size_t index),
+                        void *context);
+
 #ifdef __cplusplus
 }} // extern "C", namespace swift
 #endif
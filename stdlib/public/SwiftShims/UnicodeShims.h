@@ -99,6 +99,68 @@ void _swift_stdlib_unicodeCollationIterator_delete(
 SWIFT_RUNTIME_STDLIB_INTERFACE
 const __swift_int32_t *_swift_stdlib_unicode_getASCIICollationTable();
 
+/// Returns a table of the collation elements of the UTF-16 code units below
+/// _swift_stdlib_unicode_getStarterCollationTableSize(). The entry of each
+/// character which is in NFC, doesn't combine with the characters before it
+/// and collates as a single collation element is that element, and the
+/// entries of the other ones are zero.
+///
+/// A string of characters with non-zero entries collates as the sequence of
+/// their entries.
+SWIFT_RUNTIME_STDLIB_INTERFACE
+const __swift_int32_t *_swift_stdlib_unicode_getStarterCollationTable();
+
+SWIFT_RUNTIME_STDLIB_INTERFACE
+__attribute__((__const__)) __swift_uint32_t
+_swift_stdlib_unicode_getStarterCollationTableSize();
+
+/// Returns true if none of the \p Length bytes at \p Bytes has its high bit
+/// set.
+SWIFT_RUNTIME_STDLIB_INTERFACE
+__attribute__((__pure__)) __swift_bool
+_swift_stdlib_isASCII(const __swift_uint8_t *Bytes, __swift_intptr_t Length);
+
+/// Returns true if all of the \p Length bytes at \p Bytes are printable
+/// ASCII characters, i.e. in the range 0x20 to 0x7E.
+SWIFT_RUNTIME_STDLIB_INTERFACE
+__attribute__((__pure__)) __swift_bool
+_swift_stdlib_isPrintableASCII(const __swift_uint8_t *Bytes,
+                               __swift_intptr_t Length);
+
+/// Checks that the \p Length bytes at \p Bytes are well-formed UTF-8.
+///
+/// \returns true and sets \p UTF16Count to the number of UTF-16 code units
+///   needed to encode them if they are, or false if they aren't.
+SWIFT_RUNTIME_STDLIB_INTERFACE
+__swift_bool
+_swift_stdlib_measureUTF8AsUTF16(const __swift_uint8_t *Bytes,
+                                 __swift_intptr_t Length,
+                                 __swift_intptr_t *UTF16Count);
+
+/// Transcodes the \p Length bytes of well-formed UTF-8 at \p Bytes to
+/// UTF-16. \p Destination must have room for the number of code units
+/// computed by _swift_stdlib_measureUTF8AsUTF16.
+SWIFT_RUNTIME_STDLIB_INTERFACE
+void _swift_stdlib_transcodeUTF8ToUTF16(const __swift_uint8_t *Bytes,
+                                        __swift_intptr_t Length,
+                                        __swift_uint16_t *Destination);
+
+/// Returns the number of bytes needed to encode the \p Length UTF-16 code
+/// units at \p Units as UTF-8, with each unpaired surrogate replaced by
+/// U+FFFD.
+SWIFT_RUNTIME_STDLIB_INTERFACE
+__attribute__((__pure__)) __swift_intptr_t
+_swift_stdlib_measureUTF16AsUTF8(const __swift_uint16_t *Units,
+                                 __swift_intptr_t Length);
+
+/// Transcodes the \p Length UTF-16 code units at \p Units to UTF-8,
+/// replacing each unpaired surrogate with U+FFFD. \p Destination must have
+/// room for the number of bytes computed by _swift_stdlib_measureUTF16AsUTF8.
+SWIFT_RUNTIME_STDLIB_INTERFACE
+void _swift_stdlib_transcodeUTF16ToUTF8(const __swift_uint16_t *Units,
+                                        __swift_intptr_t Length,
+                                        __swift_uint8_t *Destination);
+
 SWIFT_RUNTIME_STDLIB_INTERFACE
 __swift_int32_t _swift_stdlib_unicode_strToUpper(
   __swift_uint16_t *Destination, __swift_int32_t DestinationCapacity,
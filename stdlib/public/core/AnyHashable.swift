@@ -89,6 +89,18 @@ internal struct _ConcreteHashableBox<Base : Hashable> : _AnyHashableBox {
   }
 }
 
+/// Returns `true` if `T` is `String` or one of the integer types, which are
+/// the most common dictionary keys.
+@inline(__always)
+internal func _isCommonAnyHashableKeyType<T>(_: T.Type) -> Bool {
+  return T.self == String.self ||
+    T.self == Int.self || T.self == UInt.self ||
+    T.self == Int64.self || T.self == UInt64.self ||
+    T.self == Int32.self || T.self == UInt32.self ||
+    T.self == Int16.self || T.self == UInt16.self ||
+    T.self == Int8.self || T.self == UInt8.self
+}
+
 #if _runtime(_ObjC)
 // Retrieve the custom AnyHashable representation of the value after it
 // has been bridged to Objective-C. This mapping to Objective-C and back
@@ -143,6 +155,14 @@ public struct AnyHashable {
   ///
   /// - Parameter base: A hashable value to wrap.
   public init<H : Hashable>(_ base: H) {
+    // The common key types don't have a custom representation, and their
+    // boxes fit in the inline buffer of `_box`, so wrapping them takes
+    // neither a dynamic cast nor an allocation.
+    if _isCommonAnyHashableKeyType(H.self) {
+      self = AnyHashable(_usingDefaultRepresentationOf: base)
+      return
+    }
+
     if let customRepresentation =
       (base as? _HasCustomAnyHashableRepresentation)?._toCustomAnyHashable() {
       self = customRepresentation
@@ -150,6 +170,13 @@ public struct AnyHashable {
       return
     }
 
+    // Only classes need the runtime to find the type that introduces the
+    // `Hashable` conformance; other types are used as they are.
+    if !_isClassOrObjCExistential(H.self) {
+      self = AnyHashable(_usingDefaultRepresentationOf: base)
+      return
+    }
+
     self._box = _ConcreteHashableBox(0 as Int)
     self._usedCustomRepresentation = false
     _stdlib_makeAnyHashableUpcastingToHashableBaseType(
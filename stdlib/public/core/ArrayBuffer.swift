@@ -139,6 +139,14 @@ extension _ArrayBuffer {
     return isUniquelyReferenced()
   }
 
+  internal mutating func _tryReallocateUniqueBuffer(
+    minimumCapacity: Int
+  ) -> Bool {
+    // The storage reference is a bridge object, and reallocating isn't
+    // supported with the Objective-C runtime anyway.
+    return false
+  }
+
   internal mutating func isMutableAndUniquelyReferencedOrPinned() -> Bool {
     return isUniquelyReferencedOrPinned()
   }
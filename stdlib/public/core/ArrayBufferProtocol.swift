@@ -54,6 +54,15 @@ internal protocol _ArrayBufferProtocol
     minimumCapacity: Int
   ) -> _ContiguousArrayBuffer<Element>?
 
+  /// If this buffer is a uniquely-referenced `_ContiguousArrayBuffer` of
+  /// trivial elements, try to grow it to hold `minimumCapacity` elements by
+  /// reallocating its storage, which often extends it in place instead of
+  /// copying the elements.
+  ///
+  /// - Returns: `true` if the buffer was grown; otherwise the buffer is
+  ///   unchanged.
+  mutating func _tryReallocateUniqueBuffer(minimumCapacity: Int) -> Bool
+
   /// Returns `true` iff this buffer is backed by a uniquely-referenced mutable
   /// _ContiguousArrayBuffer.
   ///
@@ -138,6 +147,17 @@ extension _ArrayBufferProtocol where Index == Int {
     elementsOf newValues: C
   ) where C : Collection, C.Iterator.Element == Element {
     _sanityCheck(startIndex == 0, "_SliceBuffer should override this function.")
+    if _isPOD(Element.self) {
+      let replaced: Void? =
+        newValues._withUnsafeContiguousStorageIfAvailable {
+          _sanityCheck($0.count == newCount)
+          self._replaceTrivial(subRange: subRange, with: $0)
+        }
+      if replaced != nil {
+        return
+      }
+    }
+
     let oldCount = self.count
     let eraseCount = subRange.count
 
@@ -207,4 +227,35 @@ extension _ArrayBufferProtocol where Index == Int {
       }
     }
   }
+
+  /// Replace the elements in `subRange` with `newValues`, moving the tail
+  /// and copying the new elements with one `memmove` each.
+  ///
+  /// - Precondition: `Element` is a trivial type.
+  internal mutating func _replaceTrivial(
+    subRange: Range<Int>,
+    with newValues: UnsafeBufferPointer<Element>
+  ) {
+    _sanityCheck(_isPOD(Element.self))
+    let oldCount = self.count
+    let newCount = newValues.count
+    let growth = newCount - subRange.count
+    let stride = MemoryLayout<Element>.stride
+
+    let elements = self.subscriptBaseAddress
+    let tailCount = oldCount - subRange.upperBound
+    if growth != 0 && tailCount > 0 {
+      _memmove(
+        dest: UnsafeMutableRawPointer(elements + subRange.upperBound + growth),
+        src: UnsafeRawPointer(elements + subRange.upperBound),
+        size: UInt(tailCount * stride))
+    }
+    if let source = newValues.baseAddress, newCount > 0 {
+      _memmove(
+        dest: UnsafeMutableRawPointer(elements + subRange.lowerBound),
+        src: UnsafeRawPointer(source),
+        size: UInt(newCount * stride))
+    }
+    self.count = oldCount + growth
+  }
 }
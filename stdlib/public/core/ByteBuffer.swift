@@ -0,0 +1,305 @@
+//===--- ByteBuffer.swift - Owned byte storage with cheap slicing ---------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+/// The storage of `_ByteBuffer`.
+///
+/// The header is the offset just past the last byte that any buffer using
+/// this storage has written. Bytes before it may be visible to several
+/// buffers and are never written again; bytes after it belong to nobody, so
+/// the first buffer that claims them by advancing the header may write them
+/// in place.
+internal final class _ByteBufferStorage : ManagedBuffer<Int, UInt8> {
+  internal static func create(minimumCapacity: Int) -> _ByteBufferStorage {
+    return unsafeDowncast(
+      _ByteBufferStorage.create(minimumCapacity: minimumCapacity) { _ in 0 },
+      to: _ByteBufferStorage.self)
+  }
+
+  internal var _bytes: UnsafeMutablePointer<UInt8> {
+    return firstElementAddress
+  }
+
+  internal var _claimedEndAddress: UnsafeMutablePointer<Int> {
+    return headerAddress
+  }
+}
+
+/// An owned, contiguous buffer of bytes with a read cursor and a write
+/// cursor.
+///
+/// Bytes are appended at the write cursor and consumed at the read cursor.
+/// The bytes between the two cursors are the *readable* bytes.
+///
+/// Slicing a buffer with `readSlice(count:)` does not copy: the slice and
+/// the buffer share storage, which stays alive as long as any of them does.
+/// Writing to a buffer that shares its storage copies the readable bytes
+/// only if another buffer has already written past the same position, so
+/// the usual pattern of appending to one buffer while handing out slices of
+/// it never copies.
+///
+///     var buffer = _ByteBuffer()
+///     buffer.write("GET / HTTP/1.1\r\n")
+///     let method = buffer.readSlice(count: 3)!  // Shares storage.
+///     print(method.readableByteCount)
+///     // Prints "3"
+public struct _ByteBuffer {
+  internal var _storage: _ByteBufferStorage
+
+  /// The number of bytes in `_storage`.
+  internal var _capacity: Int
+
+  /// The offset of the read cursor in `_storage`.
+  internal var _readerOffset: Int
+
+  /// The offset of the write cursor in `_storage`.
+  internal var _writerOffset: Int
+
+  /// Creates an empty buffer with room for at least `minimumCapacity` bytes.
+  public init(minimumCapacity: Int = 0) {
+    self._storage = _ByteBufferStorage.create(minimumCapacity: minimumCapacity)
+    self._capacity = _storage.capacity
+    self._readerOffset = 0
+    self._writerOffset = 0
+  }
+
+  /// Creates a buffer whose readable bytes are `bytes`.
+  public init<S : Sequence>(_ bytes: S) where S.Iterator.Element == UInt8 {
+    self.init(minimumCapacity: bytes.underestimatedCount)
+    write(contentsOf: bytes)
+  }
+
+  internal init(
+    _storage: _ByteBufferStorage, capacity: Int,
+    readerOffset: Int, writerOffset: Int
+  ) {
+    self._storage = _storage
+    self._capacity = capacity
+    self._readerOffset = readerOffset
+    self._writerOffset = writerOffset
+  }
+
+  /// The number of bytes that can be read.
+  public var readableByteCount: Int {
+    return _writerOffset - _readerOffset
+  }
+
+  /// The number of bytes that can be written without growing the storage.
+  public var writableByteCount: Int {
+    return _capacity - _writerOffset
+  }
+
+  //===--- Reading --------------------------------------------------------===//
+
+  /// Calls `body` with a pointer to the readable bytes.
+  ///
+  /// The pointer is only valid for the duration of the call.
+  public func withUnsafeReadableBytes<R>(
+    _ body: (UnsafeRawBufferPointer) throws -> R
+  ) rethrows -> R {
+    defer { _fixLifetime(_storage) }
+    return try body(UnsafeRawBufferPointer(
+      start: _storage._bytes + _readerOffset, count: readableByteCount))
+  }
+
+  /// Moves the read cursor forward past `count` bytes.
+  ///
+  /// - Precondition: `count` is between zero and `readableByteCount`.
+  public mutating func moveReaderIndex(forwardBy count: Int) {
+    _precondition(count >= 0 && count <= readableByteCount,
+      "Can't move the read cursor past the readable bytes")
+    _readerOffset += count
+  }
+
+  /// Reads the next byte, or returns `nil` if there are no readable bytes.
+  public mutating func readByte() -> UInt8? {
+    if _readerOffset == _writerOffset {
+      return nil
+    }
+    defer { _fixLifetime(_storage) }
+    let byte = _storage._bytes[_readerOffset]
+    _readerOffset += 1
+    return byte
+  }
+
+  /// Reads the next `count` bytes as a buffer that shares storage with
+  /// `self`, or returns `nil` if fewer than `count` bytes are readable.
+  ///
+  /// - Complexity: O(1).
+  public mutating func readSlice(count: Int) -> _ByteBuffer? {
+    _precondition(count >= 0, "Can't read a negative number of bytes")
+    if count > readableByteCount {
+      return nil
+    }
+    let slice = _ByteBuffer(
+      _storage: _storage, capacity: _capacity,
+      readerOffset: _readerOffset, writerOffset: _readerOffset + count)
+    _readerOffset += count
+    return slice
+  }
+
+  /// Reads the next `count` bytes as a string, or returns `nil` if fewer
+  /// than `count` bytes are readable or they are not well-formed UTF-8.
+  ///
+  /// The read cursor only moves if a string is returned. ASCII bytes are
+  /// copied into the string as they are.
+  public mutating func readString(count: Int) -> String? {
+    _precondition(count >= 0, "Can't read a negative number of bytes")
+    if count > readableByteCount {
+      return nil
+    }
+    defer { _fixLifetime(_storage) }
+    guard let buffer = _StringBuffer._fromContiguousUTF8(
+      _storage._bytes + _readerOffset, count: count, minimumCapacity: 0)
+    else {
+      return nil
+    }
+    _readerOffset += count
+    return String(_storage: buffer)
+  }
+
+  //===--- Writing --------------------------------------------------------===//
+
+  /// Makes sure that `count` bytes can be written in place at the write
+  /// cursor, copying the readable bytes to new storage if needed.
+  internal mutating func _claimWritableBytes(_ count: Int) {
+    let newWriterOffset = _writerOffset + count
+    if newWriterOffset <= _capacity {
+      if isKnownUniquelyReferenced(&_storage) {
+        // No other buffer can see the bytes past the write cursor.
+        _storage._claimedEndAddress.pointee = newWriterOffset
+        return
+      }
+      // Another buffer may be writing to this storage at the same time.
+      var expected = _writerOffset
+      if _stdlib_atomicCompareExchangeStrongInt(
+        object: _storage._claimedEndAddress,
+        expected: &expected, desired: newWriterOffset) {
+        return
+      }
+    }
+    _copyToNewStorage(
+      minimumCapacity: Swift.max(
+        readableByteCount + count, _growArrayCapacity(readableByteCount)))
+  }
+
+  /// Gives back the last `count` of the bytes claimed by
+  /// `_claimWritableBytes` when they turn out not to be needed.
+  internal mutating func _unclaimWritableBytes(_ count: Int) {
+    let claimedEnd = _writerOffset + count
+    if isKnownUniquelyReferenced(&_storage) {
+      _storage._claimedEndAddress.pointee = _writerOffset
+      return
+    }
+    // Fails harmlessly if an unrelated buffer reclaimed the bytes first;
+    // then this buffer just copies the next time it writes.
+    var expected = claimedEnd
+    _ = _stdlib_atomicCompareExchangeStrongInt(
+      object: _storage._claimedEndAddress,
+      expected: &expected, desired: _writerOffset)
+  }
+
+  internal mutating func _copyToNewStorage(minimumCapacity: Int) {
+    let count = readableByteCount
+    let newStorage = _ByteBufferStorage.create(
+      minimumCapacity: minimumCapacity)
+    newStorage._bytes.initialize(
+      from: _storage._bytes + _readerOffset, count: count)
+    newStorage._claimedEndAddress.pointee = count
+    _fixLifetime(_storage)
+    self = _ByteBuffer(
+      _storage: newStorage, capacity: newStorage.capacity,
+      readerOffset: 0, writerOffset: count)
+  }
+
+  /// Makes sure that at least `minimumWritableBytes` bytes can be written
+  /// without growing the storage.
+  public mutating func reserveCapacity(_ minimumWritableBytes: Int) {
+    if minimumWritableBytes > writableByteCount {
+      _copyToNewStorage(
+        minimumCapacity: readableByteCount + minimumWritableBytes)
+    }
+  }
+
+  /// Calls `body` with a pointer to at least `minimumWritableBytes` bytes at
+  /// the write cursor, and moves the write cursor past the number of bytes
+  /// that `body` returns.
+  ///
+  /// - Returns: The number of bytes written.
+  @discardableResult
+  public mutating func writeWithUnsafeMutableBytes(
+    minimumWritableBytes: Int,
+    _ body: (UnsafeMutableRawBufferPointer) throws -> Int
+  ) rethrows -> Int {
+    _precondition(minimumWritableBytes >= 0,
+      "Can't write a negative number of bytes")
+    _claimWritableBytes(minimumWritableBytes)
+    let start = _storage._bytes + _writerOffset
+    defer { _fixLifetime(_storage) }
+    let written = try body(
+      UnsafeMutableRawBufferPointer(start: start, count: minimumWritableBytes))
+    _precondition(written >= 0 && written <= minimumWritableBytes,
+      "Wrote more bytes than were reserved")
+    _writerOffset += written
+    if written != minimumWritableBytes {
+      _unclaimWritableBytes(minimumWritableBytes - written)
+    }
+    return written
+  }
+
+  /// Writes `byte` at the write cursor.
+  public mutating func write(_ byte: UInt8) {
+    _claimWritableBytes(1)
+    _storage._bytes[_writerOffset] = byte
+    _fixLifetime(_storage)
+    _writerOffset += 1
+  }
+
+  /// Writes `bytes` at the write cursor.
+  public mutating func write(contentsOf bytes: UnsafeRawBufferPointer) {
+    let count = bytes.count
+    if count == 0 {
+      return
+    }
+    _claimWritableBytes(count)
+    _memcpy(
+      dest: _storage._bytes + _writerOffset,
+      src: UnsafeMutableRawPointer(mutating: bytes.baseAddress!),
+      size: UInt(count))
+    _fixLifetime(_storage)
+    _writerOffset += count
+  }
+
+  /// Writes the elements of `bytes` at the write cursor.
+  public mutating func write<S : Sequence>(
+    contentsOf bytes: S
+  ) where S.Iterator.Element == UInt8 {
+    let copied: Void? = bytes._withUnsafeContiguousStorageIfAvailable {
+      write(contentsOf: UnsafeRawBufferPointer($0))
+    }
+    if copied != nil {
+      return
+    }
+    reserveCapacity(bytes.underestimatedCount)
+    for byte in bytes {
+      write(byte)
+    }
+  }
+
+  /// Writes the UTF-8 encoding of `string` at the write cursor.
+  public mutating func write(_ string: String) {
+    if let asciiBuffer = string._core.asciiBuffer {
+      write(contentsOf: UnsafeRawBufferPointer(asciiBuffer))
+      return
+    }
+    write(contentsOf: string.utf8)
+  }
+}
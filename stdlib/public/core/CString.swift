@@ -186,6 +186,20 @@ func _decodeCString<Encoding : UnicodeCodec>(
   repairingInvalidCodeUnits isRepairing: Bool = true)
 -> (result: String, repairsMade: Bool)? {
 
+  if encoding == UTF8.self {
+    let bytes = UnsafeRawPointer(cString).assumingMemoryBound(to: UInt8.self)
+    if _swift_stdlib_isASCII(bytes, length) {
+      // ASCII needs neither validation nor transcoding.
+      let stringBuffer = _StringBuffer(
+        capacity: length, initialSize: length, elementWidth: 1)
+      _memcpy(
+        dest: stringBuffer.start,
+        src: UnsafeMutableRawPointer(mutating: bytes),
+        size: UInt(length))
+      return (result: String(_storage: stringBuffer), repairsMade: false)
+    }
+  }
+
   let buffer = UnsafeBufferPointer<Encoding.CodeUnit>(
     start: cString, count: length)
 
@@ -374,6 +374,12 @@ extension String {
   /// - Parameter c: The character to convert to a string.
   public init(_ c: Character) {
     switch c._representation {
+    case let .small(_63bits)
+      where Bool(Builtin.cmp_uge_Int63(_63bits, _minASCIICharReprBuiltin)):
+      // ASCII characters are stored in the lowest byte.
+      let value = Character._smallValue(_63bits)
+      self = String(_StringCore(
+        _asciiCharacter: UTF8.CodeUnit(truncatingBitPattern: value)))
     case let .small(_63bits):
       let value = Character._smallValue(_63bits)
       let smallUTF8 = Character._SmallUTF8(value)
@@ -652,6 +652,41 @@ public protocol _ExpressibleByStringInterpolation {
   init<T>(stringInterpolationSegment expr: T)
 }
 
+/// A type whose string interpolations are built in a single buffer.
+///
+/// When the type of a string interpolation conforms to this protocol, the
+/// compiler doesn't create an instance for each segment. Instead, it creates
+/// one buffer with a capacity estimated from the length of the literal,
+/// appends each segment to the buffer in order, and then creates the
+/// instance from the buffer. For example, the interpolation
+/// `"\(price) dollars"` is equivalent to the following code:
+///
+///     String(stringInterpolationBuffer:
+///       String._appendStringInterpolationSegment(
+///         to: String._appendStringInterpolationSegment(
+///           to: String._makeStringInterpolationBuffer(reservingCapacity: 24),
+///           price),
+///         " dollars"))
+///
+/// Do not declare new conformances to this protocol; they may not be
+/// supported in future versions of Swift.
+public protocol _ExpressibleByBufferedStringInterpolation
+  : _ExpressibleByStringInterpolation {
+  /// Creates an empty buffer with room for at least `capacity` code units.
+  static func _makeStringInterpolationBuffer(
+    reservingCapacity capacity: Int
+  ) -> _StringInterpolationBuffer
+
+  /// Appends the textual representation of `segment` to `buffer`, and
+  /// returns `buffer`.
+  static func _appendStringInterpolationSegment<T>(
+    to buffer: _StringInterpolationBuffer, _ segment: T
+  ) -> _StringInterpolationBuffer
+
+  /// Creates an instance from the contents of `buffer`.
+  init(stringInterpolationBuffer buffer: _StringInterpolationBuffer)
+}
+
 /// Conforming types can be initialized with color literals (e.g.
 /// `#colorLiteral(red: 1, green: 0, blue: 0, alpha: 1)`).
 public protocol _ExpressibleByColorLiteral {
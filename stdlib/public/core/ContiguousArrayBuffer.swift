@@ -176,6 +176,13 @@ final class _ContiguousArrayStorage<Element> : _ContiguousArrayStorage1 {
   }
 }
 
+@_silgen_name("swift_tryReallocObject")
+internal func _swift_tryReallocObject(
+  _ object: UnsafeMutableRawPointer,
+  _ newSize: Int,
+  _ alignMask: Int
+) -> UnsafeMutableRawPointer?
+
 @_versioned
 @_fixed_layout
 internal struct _ContiguousArrayBuffer<Element> : _ArrayBufferProtocol {
@@ -302,6 +309,54 @@ internal struct _ContiguousArrayBuffer<Element> : _ArrayBufferProtocol {
     return isUniquelyReferenced()
   }
 
+  internal mutating func _tryReallocateUniqueBuffer(
+    minimumCapacity: Int
+  ) -> Bool {
+    _sanityCheck(minimumCapacity > capacity)
+    // Reallocating copies the elements bitwise. The empty array storage is
+    // a global, and must never be reallocated.
+    if !_isPOD(Element.self) || MemoryLayout<Element>.stride == 0 ||
+       capacity == 0 || !isUniquelyReferenced() {
+      return false
+    }
+
+    let oldCount = count
+    let oldStorageAddr =
+      UnsafeMutableRawPointer(Builtin.bridgeToRawPointer(_storage))
+    let headerSize =
+      UnsafeMutableRawPointer(firstElementAddress) - oldStorageAddr
+    let alignMask =
+      Swift.max(MemoryLayout<Element>.alignment,
+                MemoryLayout<_ContiguousArrayStorageBase>.alignment) &- 1
+
+    // The runtime only reallocates the storage if nothing else references
+    // it. The old reference is dangling afterwards, so overwrite its bits
+    // rather than assigning to it, which would release it.
+    let reallocatedStorageAddr: UnsafeMutableRawPointer? =
+      withUnsafeMutablePointer(to: &_storage) {
+        storageReference in
+        guard let newStorageAddr = _swift_tryReallocObject(
+          oldStorageAddr,
+          headerSize + minimumCapacity * MemoryLayout<Element>.stride,
+          alignMask) else {
+          return nil
+        }
+        UnsafeMutableRawPointer(storageReference).storeBytes(
+          of: newStorageAddr, as: UnsafeMutableRawPointer.self)
+        return newStorageAddr
+      }
+    guard let newStorageAddr = reallocatedStorageAddr else {
+      return false
+    }
+
+    // The allocator may have reserved more than we asked for.
+    let endAddr = newStorageAddr + _swift_stdlib_malloc_size(newStorageAddr)
+    let realCapacity =
+      (endAddr - (newStorageAddr + headerSize)) / MemoryLayout<Element>.stride
+    _initStorageHeader(count: oldCount, capacity: realCapacity)
+    return true
+  }
+
   internal mutating func isMutableAndUniquelyReferencedOrPinned() -> Bool {
     return isUniquelyReferencedOrPinned()
   }
@@ -42,6 +42,24 @@ struct _Hashing {
        _swift_stdlib_Hashing_secretKey.key1) = newValue
     }
   }
+
+  /// Whether strings are hashed with `_FastHashContext` instead of SipHash.
+  ///
+  /// The fast hash is much cheaper for long strings, but it doesn't protect
+  /// hashed collections against keys chosen to collide. Only enable it in
+  /// processes whose keys come from trusted sources.
+  ///
+  /// Hash values depend on this setting, so it must be set before any
+  /// value is hashed, typically at the start of `main`.
+  public // SPI
+  static var usesFastHashing: Bool {
+    get {
+      return _swift_stdlib_Hashing_usesFastHashing != 0
+    }
+    set {
+      _swift_stdlib_Hashing_usesFastHashing = newValue ? 1 : 0
+    }
+  }
 }
 
 public // @testable
@@ -175,3 +193,188 @@ func _squeezeHashValue(_ hashValue: Int, _ upperBound: Int) -> Int {
   return mixedHashValue & (upperBound &- 1)
 }
 
+
+/// An incremental hasher that is not resistant to hash flooding, but
+/// processes each 64-bit word with a single multiplication.
+///
+/// It has the same interface as `_SipHash13Context`, so that callers can
+/// combine several fields into one hash without computing a `hashValue`
+/// for each of them.
+public // SPI
+struct _FastHashContext {
+  @_versioned
+  internal var state: UInt64
+
+  @_versioned
+  internal let finalizationKey: UInt64
+
+  @_versioned
+  internal var hashedByteCount: UInt64 = 0
+
+  @_versioned
+  internal var dataTail: UInt64 = 0
+
+  @_versioned
+  internal var dataTailByteCount: Int = 0
+
+  public init(key: (UInt64, UInt64)) {
+    state = key.0
+    finalizationKey = key.1
+  }
+
+  // FIXME(ABI) (UnsafeRawBufferPointer): Use UnsafeRawBufferPointer.
+  public // SPI
+  mutating func append(_ data: UnsafeRawPointer, byteCount: Int) {
+    _append_alwaysInline(data, byteCount: byteCount)
+  }
+
+  @_versioned
+  @inline(__always)
+  internal mutating func _append_alwaysInline(
+    _ data: UnsafeRawPointer,
+    byteCount: Int
+  ) {
+    _sanityCheck((0..<8).contains(dataTailByteCount))
+
+    let dataEnd = data + byteCount
+
+    var data = data
+    var byteCount = byteCount
+    if dataTailByteCount != 0 {
+      let restByteCount = min(
+        MemoryLayout<UInt64>.size - dataTailByteCount,
+        byteCount)
+      let rest = _SipHashDetail._loadPartialUnalignedUInt64LE(
+        from: data,
+        byteCount: restByteCount)
+      dataTail |= rest << UInt64(dataTailByteCount * 8)
+      dataTailByteCount += restByteCount
+      data += restByteCount
+      byteCount -= restByteCount
+    }
+
+    if dataTailByteCount == MemoryLayout<UInt64>.size {
+      _appendDirectly(dataTail)
+      dataTail = 0
+      dataTailByteCount = 0
+    } else if dataTailByteCount != 0 {
+      _sanityCheck(data == dataEnd)
+      return
+    }
+
+    let endOfWords =
+      data + byteCount - (byteCount % MemoryLayout<UInt64>.size)
+    while data != endOfWords {
+      var m: UInt64 = 0
+      _memcpy(
+        dest: UnsafeMutableRawPointer(Builtin.addressof(&m)),
+        src: UnsafeMutableRawPointer(mutating: data),
+        size: 8)
+      _appendDirectly(UInt64(littleEndian: m))
+      data += 8
+    }
+
+    if data != dataEnd {
+      dataTailByteCount = dataEnd - data
+      dataTail = _SipHashDetail._loadPartialUnalignedUInt64LE(
+        from: data,
+        byteCount: dataTailByteCount)
+    }
+  }
+
+  /// Mixes the given word directly into the state, ignoring `dataTail`.
+  @_versioned
+  @inline(__always)
+  internal mutating func _appendDirectly(_ m: UInt64) {
+    // The multiplication only propagates changes towards the high bits; the
+    // rotation feeds them back into the low bits of the next word.
+    state = (_SipHashDetail._rotate(state, leftBy: 5) ^ m) &*
+      0x517c_c1b7_2722_0a95
+    hashedByteCount += 8
+  }
+
+  public // SPI
+  mutating func append(_ data: UInt64) {
+    if dataTailByteCount == 0 {
+      // Appending bytes interprets them as little-endian.
+      _appendDirectly(data.littleEndian)
+      return
+    }
+    var data = data
+    _append_alwaysInline(&data, byteCount: 8)
+  }
+
+  public // SPI
+  mutating func append(_ data: Int64) {
+    append(UInt64(bitPattern: data))
+  }
+
+  public // SPI
+  mutating func append(_ data: UInt) {
+    var data = data
+    _append_alwaysInline(&data, byteCount: MemoryLayout.size(ofValue: data))
+  }
+
+  public // SPI
+  mutating func append(_ data: Int) {
+    append(UInt(bitPattern: data))
+  }
+
+  public // SPI
+  mutating func append(_ data: UInt32) {
+    // Pairs of 32-bit values, like the collation elements of a string, are
+    // common enough to avoid the general path.
+    if dataTailByteCount == 0 {
+      dataTail = UInt64(data.littleEndian)
+      dataTailByteCount = 4
+    } else if dataTailByteCount == 4 {
+      _appendDirectly(dataTail | (UInt64(data.littleEndian) << 32))
+      dataTail = 0
+      dataTailByteCount = 0
+    } else {
+      var data = data
+      _append_alwaysInline(&data, byteCount: 4)
+    }
+  }
+
+  public // SPI
+  mutating func append(_ data: Int32) {
+    append(UInt32(bitPattern: data))
+  }
+
+  /// Returns the hash of the appended data. Unlike `_SipHash13Context`, the
+  /// context can still be appended to afterwards.
+  public // SPI
+  func finalizeAndReturnHash() -> UInt64 {
+    _sanityCheck((0..<8).contains(dataTailByteCount))
+    let byteCount = hashedByteCount + UInt64(dataTailByteCount)
+    var state = self.state
+    if dataTailByteCount != 0 {
+      state = (_SipHashDetail._rotate(state, leftBy: 5) ^ dataTail) &*
+        0x517c_c1b7_2722_0a95
+    }
+    return _HashingDetail.hash16Bytes(
+      state, finalizationKey ^ (byteCount << 56))
+  }
+
+  internal func _finalizeAndReturnIntHash() -> Int {
+    let hash: UInt64 = finalizeAndReturnHash()
+#if arch(i386) || arch(arm)
+    return Int(truncatingBitPattern: hash)
+#elseif arch(x86_64) || arch(arm64) || arch(powerpc64) || arch(powerpc64le) || arch(s390x)
+    return Int(Int64(bitPattern: hash))
+#endif
+  }
+
+  // FIXME(ABI) (UnsafeRawBufferPointer): Use UnsafeRawBufferPointer.
+  public // SPI
+  static func hash(
+    data: UnsafeRawPointer,
+    dataByteCount: Int,
+    key: (UInt64, UInt64)
+  ) -> UInt64 {
+    var context = _FastHashContext(key: key)
+    context._append_alwaysInline(data, byteCount: dataByteCount)
+    return context.finalizeAndReturnHash()
+  }
+}
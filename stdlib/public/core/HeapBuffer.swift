@@ -39,6 +39,9 @@ internal func _swift_bufferAllocate(
 /// construct and---if necessary---destroy Elements there yourself,
 /// either in a derived class, or it can be in some manager object
 /// that owns the _HeapBuffer.
+///
+/// The value and the elements are tail-allocated in the instance, so
+/// subclasses must not have any stored properties.
 public // @testable (test/Prototypes/MutableIndexableDict.swift)
 class _HeapBufferStorage<Value, Element> {
   public init() {}
@@ -70,18 +73,6 @@ struct _HeapBuffer<Value, Element> : Equatable {
     return _storage.map { Builtin.castFromNativeObject($0) }
   }
 
-  internal static func _valueOffset() -> Int {
-    return _roundUp(
-      MemoryLayout<_HeapObject>.size,
-      toAlignment: MemoryLayout<Value>.alignment)
-  }
-
-  internal static func _elementOffset() -> Int {
-    return _roundUp(
-      _valueOffset() + MemoryLayout<Value>.size,
-      toAlignment: MemoryLayout<Element>.alignment)
-  }
-
   internal static func _requiredAlignMask() -> Int {
     // We can't use max here because it can allocate an array.
     let heapAlign = MemoryLayout<_HeapObject>.alignment &- 1
@@ -97,15 +88,23 @@ struct _HeapBuffer<Value, Element> : Equatable {
       Builtin.bridgeToRawPointer(self._nativeObject))
   }
 
+  internal var _storageObject: Storage {
+    return Builtin.castFromNativeObject(_nativeObject)
+  }
+
+  // The value is the first tail-allocated array, with a single element.
+  internal var _valueRawAddr: Builtin.RawPointer {
+    return Builtin.projectTailElems(_storageObject, Value.self)
+  }
+
   internal var _value: UnsafeMutablePointer<Value> {
-    return (_HeapBuffer._valueOffset() + _address).assumingMemoryBound(
-      to: Value.self)
+    return UnsafeMutablePointer(_valueRawAddr)
   }
 
   public // @testable
   var baseAddress: UnsafeMutablePointer<Element> {
-    return (_HeapBuffer._elementOffset() + _address).assumingMemoryBound(
-      to: Element.self)
+    return UnsafeMutablePointer(Builtin.getTailAddr_Word(
+      _valueRawAddr, 1._builtinWordValue, Value.self, Element.self))
   }
 
   internal func _allocatedSize() -> Int {
@@ -122,8 +121,8 @@ struct _HeapBuffer<Value, Element> : Equatable {
 
   /// Returns the actual number of `Elements` we can possibly store.
   internal func _capacity() -> Int {
-    return (_allocatedSize() - _HeapBuffer._elementOffset())
-      / MemoryLayout<Element>.stride
+    let endAddr = _address + _allocatedSize()
+    return endAddr.assumingMemoryBound(to: Element.self) - baseAddress
   }
 
   internal init() {
@@ -155,23 +154,14 @@ struct _HeapBuffer<Value, Element> : Equatable {
   /// `self._capacity() >= capacity`.
   public // @testable
   init(
-    _ storageClass: AnyClass,
+    _ storageClass: _HeapBufferStorage<Value, Element>.Type,
     _ initializer: Value, _ capacity: Int
   ) {
     _sanityCheck(capacity >= 0, "creating a _HeapBuffer with negative capacity")
-    _sanityCheck(
-      _usesNativeSwiftReferenceCounting(storageClass),
-      "HeapBuffer can only create native objects"
-    )
-
-    let totalSize = _HeapBuffer._elementOffset() +
-        capacity * MemoryLayout<Element>.stride
-    let alignMask = _HeapBuffer._requiredAlignMask()
 
-    let object: AnyObject = _swift_bufferAllocate(
-      bufferType: storageClass,
-      size: totalSize,
-      alignmentMask: alignMask)
+    let object = Builtin.allocWithTailElems_2(storageClass,
+      1._builtinWordValue, Value.self,
+      capacity._builtinWordValue, Element.self)
     self._storage = Builtin.castToNativeObject(object)
     self._value.initialize(to: initializer)
   }
@@ -460,6 +460,37 @@ extension Mirror {
   }
 }
 
+//===--- Field Layout -----------------------------------------------------===//
+
+/// Returns the stored properties of `type`, including those inherited from
+/// superclasses, in declaration order; or `nil` if `type` is not a struct or
+/// native Swift class whose properties can be described by their offsets.
+///
+/// Unlike a `Mirror`, this doesn't box the value of each property, and the
+/// layout is computed once per type and cached by the runtime.
+public func _getFieldLayout(
+  _ type: Any.Type
+) -> UnsafeBufferPointer<_SwiftFieldLayoutEntry>? {
+  var count = 0
+  guard let fields = _swift_getFieldLayout(
+    unsafeBitCast(type, to: UnsafeRawPointer.self), &count) else {
+    return nil
+  }
+  return UnsafeBufferPointer(start: fields, count: count)
+}
+
+extension _SwiftFieldLayoutEntry {
+  /// The name of the property.
+  public var _name: String {
+    return String(cString: name)
+  }
+
+  /// The type of the property.
+  public var _type: Any.Type {
+    return unsafeBitCast(type, to: Any.Type.self)
+  }
+}
+
 //===--- Legacy _Mirror Support -------------------------------------------===//
 extension Mirror.DisplayStyle {
   /// Construct from a legacy `_MirrorDisposition`
@@ -0,0 +1,101 @@
+//===----------------------------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Algorithms which run on several threads. The threads are the runtime's
+// pool of worker threads, which _swift_parallelFor divides loops among.
+//
+//===----------------------------------------------------------------------===//
+
+import SwiftShims
+
+/// Calls `body` with each integer in `0..<count`, concurrently on several
+/// threads, and returns when all the calls have returned.
+internal func _parallelFor(_ count: Int, _ body: (Int) -> Void) {
+  typealias EscapingBody = (Int) -> Void
+  var escapableBody = unsafeBitCast(body, to: EscapingBody.self)
+  withUnsafeMutablePointer(to: &escapableBody) {
+    (bodyPointer) -> Void in
+    _swift_parallelFor(count, { (context, index) in
+      context!.assumingMemoryBound(to: EscapingBody.self).pointee(index)
+    }, UnsafeMutableRawPointer(bodyPointer))
+  }
+}
+
+/// Returns the number of chunks to divide `count` elements into for a
+/// parallel algorithm: a few for each hardware thread, of at least
+/// `minimumChunkSize` elements. Returns 1 if the work isn't worth dividing.
+internal func _parallelChunkCount(
+  _ count: Int, minimumChunkSize: Int
+) -> Int {
+  let hardwareConcurrency = _swift_stdlib_getHardwareConcurrency()
+  if hardwareConcurrency < 2 {
+    return 1
+  }
+  return Swift.max(1, Swift.min(count / minimumChunkSize,
+                                4 * hardwareConcurrency))
+}
+
+/// Returns the offset of the chunk `chunk` when `count` elements are divided
+/// into `chunkCount` chunks whose sizes differ by at most one.
+internal func _parallelChunkStart(
+  _ chunk: Int, count: Int, chunkCount: Int
+) -> Int {
+  return chunk * (count / chunkCount) + Swift.min(chunk, count % chunkCount)
+}
+
+extension RandomAccessCollection {
+  /// Returns an array containing the results of mapping the given closure
+  /// over the collection's elements, calling the closure on several threads.
+  ///
+  /// The collection is divided into chunks, which are mapped concurrently
+  /// directly into the storage of the result.
+  ///
+  ///     let numbers = Array(1...1_000_000)
+  ///     let squares = numbers.parallelMap { $0 * $0 }
+  ///     print(squares[999])
+  ///     // Prints "1000000"
+  ///
+  /// Use this method instead of `map(_:)` for large collections, or for
+  /// transforms which take a long time. The parallel version doesn't pay off
+  /// for small amounts of work, and uses `map(_:)` for them.
+  ///
+  /// - Parameter transform: A mapping closure. `transform` accepts an
+  ///   element of this collection as its parameter and returns a transformed
+  ///   value of the same or of a different type. It is called once for each
+  ///   element, concurrently and in no particular order, so it must be safe
+  ///   to call from several threads at the same time.
+  /// - Returns: An array containing the transformed elements of this
+  ///   collection, in the order of the collection.
+  public func parallelMap<T>(
+    _ transform: (Iterator.Element) -> T
+  ) -> [T] {
+    let count: Int = numericCast(self.count)
+    let chunkCount = _parallelChunkCount(count, minimumChunkSize: 1024)
+    if chunkCount < 2 {
+      return map(transform)
+    }
+
+    let (result, storage) = Array<T>._allocateUninitialized(count)
+    _parallelFor(chunkCount) { chunk in
+      let chunkStart =
+        _parallelChunkStart(chunk, count: count, chunkCount: chunkCount)
+      let chunkEnd =
+        _parallelChunkStart(chunk + 1, count: count, chunkCount: chunkCount)
+      var i = self.index(self.startIndex, offsetBy: numericCast(chunkStart))
+      for offset in chunkStart..<chunkEnd {
+        (storage + offset).initialize(to: transform(self[i]))
+        self.formIndex(after: &i)
+      }
+    }
+    return result
+  }
+}
@@ -610,6 +610,14 @@ public protocol Sequence {
   @discardableResult
   func _copyContents(initializing ptr: UnsafeMutablePointer<Iterator.Element>)
     -> UnsafeMutablePointer<Iterator.Element>
+
+  /// If the elements of `self` are stored contiguously, invoke `body` on a
+  /// buffer pointer to them and return its result.  Otherwise, return `nil`.
+  ///
+  /// The buffer pointer is only valid for the duration of the call.
+  func _withUnsafeContiguousStorageIfAvailable<R>(
+    _ body: (UnsafeBufferPointer<Iterator.Element>) throws -> R
+  ) rethrows -> R?
 }
 
 /// A default makeIterator() function for `IteratorProtocol` instances that
@@ -999,6 +1007,12 @@ extension Sequence {
     return nil
   }
 
+  public func _withUnsafeContiguousStorageIfAvailable<R>(
+    _ body: (UnsafeBufferPointer<Iterator.Element>) throws -> R
+  ) rethrows -> R? {
+    return nil
+  }
+
   public func _customContainsEquatableElement(
     _ element: Iterator.Element
   ) -> Bool? {
@@ -92,6 +92,14 @@ extension Sequence
   ) rethrows -> [Base.Iterator.Element] {
     return try _base.filter(isIncluded)
   }
+
+  /// Calls `body` on each element of the sequence in order, letting the
+  /// base sequence run the loop.
+  public func forEach(
+    _ body: (Base.Iterator.Element) throws -> Void
+  ) rethrows {
+    try _base.forEach(body)
+  }
   
   public func _customContainsEquatableElement(
     _ element: Base.Iterator.Element
@@ -123,4 +131,12 @@ extension Sequence
   ) -> UnsafeMutablePointer<Base.Iterator.Element> {
     return _base._copyContents(initializing: ptr)
   }
+
+  /// If the elements of `self` are stored contiguously, invoke `body` on a
+  /// buffer pointer to them and return its result.  Otherwise, return `nil`.
+  public func _withUnsafeContiguousStorageIfAvailable<R>(
+    _ body: (UnsafeBufferPointer<Base.Iterator.Element>) throws -> R
+  ) rethrows -> R? {
+    return try _base._withUnsafeContiguousStorageIfAvailable(body)
+  }
 }
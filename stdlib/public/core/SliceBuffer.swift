@@ -169,6 +169,13 @@ internal struct _SliceBuffer<Element>
     return _hasNativeBuffer && isUniquelyReferenced()
   }
 
+  internal mutating func _tryReallocateUniqueBuffer(
+    minimumCapacity: Int
+  ) -> Bool {
+    // A slice doesn't own the storage header it would need to update.
+    return false
+  }
+
   internal mutating func isMutableAndUniquelyReferencedOrPinned() -> Bool {
     return _hasNativeBuffer && isUniquelyReferencedOrPinned()
   }
@@ -344,6 +344,12 @@ extension String : _ExpressibleByBuiltinUnicodeScalarLiteral {
   @effects(readonly)
   public // @testable
   init(_builtinUnicodeScalarLiteral value: Builtin.Int32) {
+    let scalar = UInt32(value)
+    if scalar <= 0x7f {
+      self = String(_StringCore(
+        _asciiCharacter: UTF8.CodeUnit(truncatingBitPattern: scalar)))
+      return
+    }
     self = String._fromWellFormedCodeUnitSequence(
       UTF32.self, input: CollectionOfOne(UInt32(value)))
   }
@@ -99,6 +99,22 @@ public struct _StringBuffer {
     Input : Collection, // Sequence?
     Encoding : UnicodeCodec,
     Input.Iterator.Element == Encoding.CodeUnit {
+    if Encoding.self == UTF8.self {
+      // Contiguous UTF-8 is validated and transcoded by the runtime.
+      // Ill-formed input takes the general path below, which knows how to
+      // repair it.
+      let transcoded: _StringBuffer?? =
+        input._withUnsafeContiguousStorageIfAvailable {
+          _fromContiguousUTF8(
+            UnsafeRawPointer($0.baseAddress)?
+              .assumingMemoryBound(to: UTF8.CodeUnit.self),
+            count: $0.count, minimumCapacity: minimumCapacity)
+        }
+      if let result = transcoded ?? nil {
+        return (result, false)
+      }
+    }
+
     // Determine how many UTF-16 code units we'll need
     let inputStream = input.makeIterator()
     guard let (utf16Count, isAscii) = UTF16.transcodedLength(
@@ -116,6 +132,14 @@ public struct _StringBuffer {
 
     if isAscii {
       var p = result.start.assumingMemoryBound(to: UTF8.CodeUnit.self)
+      if Encoding.self == UTF8.self {
+        // ASCII is valid UTF-8, so UTF-8 input can be stored as is.
+        for u in input {
+          p.pointee = unsafeBitCast(u, to: UTF8.CodeUnit.self)
+          p += 1
+        }
+        return (result, false)
+      }
       let sink: (UTF32.CodeUnit) -> Void = {
         p.pointee = UTF8.CodeUnit($0)
         p += 1
@@ -143,6 +167,38 @@ public struct _StringBuffer {
     }
   }
 
+  /// Creates a buffer holding the `count` bytes of UTF-8 at `bytes`, or
+  /// returns `nil` if they are ill-formed.
+  static func _fromContiguousUTF8(
+    _ bytes: UnsafePointer<UTF8.CodeUnit>?, count: Int, minimumCapacity: Int
+  ) -> _StringBuffer? {
+    guard let bytes = bytes, count != 0 else {
+      return _StringBuffer(
+        capacity: minimumCapacity, initialSize: 0, elementWidth: 1)
+    }
+    var utf16Count = 0
+    guard _swift_stdlib_measureUTF8AsUTF16(bytes, count, &utf16Count) else {
+      return nil
+    }
+
+    // Every byte of an ASCII string is a code unit of its own.
+    let isASCII = utf16Count == count
+    let result = _StringBuffer(
+      capacity: max(utf16Count, minimumCapacity),
+      initialSize: utf16Count,
+      elementWidth: isASCII ? 1 : 2)
+    if isASCII {
+      _memcpy(
+        dest: result.start,
+        src: UnsafeMutableRawPointer(mutating: bytes),
+        size: UInt(count))
+    } else {
+      _swift_stdlib_transcodeUTF8ToUTF16(
+        bytes, count, result.start.assumingMemoryBound(to: UTF16.CodeUnit.self))
+    }
+    return result
+  }
+
   /// A pointer to the start of this buffer's data area.
   public // @testable
   var start: UnsafeMutableRawPointer {
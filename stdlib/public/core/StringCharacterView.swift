@@ -252,6 +252,20 @@ extension String.CharacterView : BidirectionalCollection {
     }
     
     let startIndexUTF16 = start._position
+
+    // Fast path: there is a boundary between any two ASCII scalars except
+    // CR LF, so the properties of ASCII scalars don't need to be looked up.
+    let u0 = _core[startIndexUTF16]
+    if u0 < 0x80 {
+      if startIndexUTF16 + 1 == end._position {
+        return 1
+      }
+      let u1 = _core[startIndexUTF16 + 1]
+      if u1 < 0x80 {
+        return u0 == 0x0D && u1 == 0x0A ? 2 : 1
+      }
+    }
+
     let graphemeClusterBreakProperty =
       _UnicodeGraphemeClusterBreakPropertyTrie()
     let segmenter = _UnicodeExtendedGraphemeClusterSegmenter()
@@ -294,6 +308,19 @@ extension String.CharacterView : BidirectionalCollection {
     }
     
     let endIndexUTF16 = end._position
+
+    // Fast path: see _measureExtendedGraphemeClusterForward.
+    let u1 = _core[endIndexUTF16 - 1]
+    if u1 < 0x80 {
+      if endIndexUTF16 - 1 == start._position {
+        return 1
+      }
+      let u0 = _core[endIndexUTF16 - 2]
+      if u0 < 0x80 {
+        return u0 == 0x0D && u1 == 0x0A ? 2 : 1
+      }
+    }
+
     let graphemeClusterBreakProperty =
       _UnicodeGraphemeClusterBreakPropertyTrie()
     let segmenter = _UnicodeExtendedGraphemeClusterSegmenter()
@@ -320,6 +347,30 @@ extension String.CharacterView : BidirectionalCollection {
     return endIndexUTF16 - graphemeClusterStartUTF16
   }
   
+  /// The number of characters in the view.
+  ///
+  /// - Complexity: O(*n*), where *n* is the length of the underlying
+  ///   string. Strings stored as ASCII are counted without segmenting them
+  ///   into grapheme clusters.
+  public var count: Int {
+    if _fastPath(_core.isASCII) {
+      // Every ASCII scalar is a character of its own, except that CR LF
+      // forms a single character.
+      let count = _core.count
+      let p = _core.startASCII
+      var crlfCount = 0
+      var i = 1
+      while i < count {
+        if p[i] == 0x0A && p[i - 1] == 0x0D {
+          crlfCount += 1
+        }
+        i += 1
+      }
+      return count - crlfCount
+    }
+    return distance(from: startIndex, to: endIndex)
+  }
+
   /// Accesses the character at the given position.
   ///
   /// The following example searches a string's character view for a capital
@@ -105,8 +105,19 @@ extension String {
 #endif
   }
 
+  /// Returns `true` if `self` and `rhs` are views of the same code units,
+  /// e.g. copies of the same string or single-character ASCII strings.
+  internal func _hasSameStorage(as rhs: String) -> Bool {
+    return _core._baseAddress == rhs._core._baseAddress
+      && _core._countAndFlags == rhs._core._countAndFlags
+      && _core.hasContiguousStorage
+  }
+
   public  // @testable
   func _compareString(_ rhs: String) -> Int {
+    if _hasSameStorage(as: rhs) {
+      return 0
+    }
 #if _runtime(_ObjC)
     // We only want to perform this optimization on objc runtimes. Elsewhere,
     // we will make it follow the unicode collation algorithm even for ASCII.
@@ -121,6 +132,9 @@ extension String {
 
 extension String : Equatable {
   public static func == (lhs: String, rhs: String) -> Bool {
+    if lhs._hasSameStorage(as: rhs) {
+      return true
+    }
 #if _runtime(_ObjC)
     // We only want to perform this optimization on objc runtimes. Elsewhere,
     // we will make it follow the unicode collation algorithm even for ASCII.
@@ -133,6 +147,21 @@ extension String : Equatable {
         lhs._core.startASCII, rhs._core.startASCII,
         rhs._core.count) == 0
     }
+#else
+    if lhs._core.isASCII && rhs._core.isASCII {
+      let count = lhs._core.count
+      if count == rhs._core.count && _swift_stdlib_memcmp(
+          lhs._core.startASCII, rhs._core.startASCII, count) == 0 {
+        return true
+      }
+      // The collation ignores ASCII control characters, so strings with
+      // different bytes can only be equal if they contain some.
+      if _swift_stdlib_isPrintableASCII(lhs._core.startASCII, count)
+        && _swift_stdlib_isPrintableASCII(
+          rhs._core.startASCII, rhs._core.count) {
+        return false
+      }
+    }
 #endif
     return lhs._compareString(rhs) == 0
   }
@@ -171,6 +171,21 @@ public struct _StringCore {
     )
   }
 
+  /// Create a string consisting of the single ASCII code unit `u`.
+  ///
+  /// Such strings point into storage shared by the whole process rather than
+  /// a _StringBuffer, so creating them doesn't allocate.  Like string
+  /// literals, they are copied into a native buffer when they grow.
+  init(_asciiCharacter u: UTF8.CodeUnit) {
+    _sanityCheck(u <= 0x7f)
+    self = _StringCore(
+      baseAddress: _asciiCharacterBase(u),
+      count: 1,
+      elementShift: 0,
+      hasCocoaBuffer: false,
+      owner: nil)
+  }
+
   /// Create the implementation of an empty string.
   ///
   /// - Note: There is no null terminator in an empty string.
@@ -505,6 +520,13 @@ public struct _StringCore {
 
   mutating func append(_ u0: UTF16.CodeUnit, _ u1: UTF16.CodeUnit?) {
     _invariantCheck()
+    // Appending an ASCII code unit to an empty string without a buffer
+    // doesn't need one.
+    if count == 0 && _owner == nil && u1 == nil && u0 <= 0x7f {
+      self = _StringCore(_asciiCharacter: UTF8.CodeUnit(u0))
+      return
+    }
+
     let minBytesPerCodeUnit = u0 <= 0x7f ? 1 : 2
     let utf16Width = u1 == nil ? 1 : 2
 
@@ -738,3 +760,11 @@ var _emptyStringStorage: UInt32 = 0
 var _emptyStringBase: UnsafeMutableRawPointer {
   return UnsafeMutableRawPointer(Builtin.addressof(&_emptyStringStorage))
 }
+
+/// The base address of the shared storage for the single-character string
+/// `u`, which must be ASCII.
+@inline(__always)
+func _asciiCharacterBase(_ u: UTF8.CodeUnit) -> UnsafeMutableRawPointer {
+  return UnsafeMutableRawPointer(
+    Builtin.addressof(&_swift_stdlib_asciiCharacterStorage)) + (Int(u) << 1)
+}
@@ -20,12 +20,32 @@ func _stdlib_NSStringHashValue(_ str: AnyObject, _ isASCII: Bool) -> Int
 func _stdlib_NSStringHashValuePointer(_ str: OpaquePointer, _ isASCII: Bool) -> Int
 #endif
 
+/// A hasher that strings can be hashed with; see `_Hashing.usesFastHashing`.
+internal protocol _StringHasher {
+  init(key: (UInt64, UInt64))
+  mutating func append(_ data: Int32)
+  mutating func _finalizeAndReturnIntHash() -> Int
+}
+
+extension _SipHash13Context : _StringHasher {}
+extension _FastHashContext : _StringHasher {}
+
 extension _Unicode {
   internal static func hashASCII(
     _ string: UnsafeBufferPointer<UInt8>
+  ) -> Int {
+    if _slowPath(_Hashing.usesFastHashing) {
+      return hashASCII(string, using: _FastHashContext.self)
+    }
+    return hashASCII(string, using: _SipHash13Context.self)
+  }
+
+  internal static func hashASCII<Hasher : _StringHasher>(
+    _ string: UnsafeBufferPointer<UInt8>,
+    using _: Hasher.Type
   ) -> Int {
     let collationTable = _swift_stdlib_unicode_getASCIICollationTable()
-    var hasher = _SipHash13Context(key: _Hashing.secretKey)
+    var hasher = Hasher(key: _Hashing.secretKey)
     for c in string {
       _precondition(c <= 127)
       let element = collationTable[Int(c)]
@@ -40,13 +60,46 @@ extension _Unicode {
 
   internal static func hashUTF16(
     _ string: UnsafeBufferPointer<UInt16>
+  ) -> Int {
+    if _slowPath(_Hashing.usesFastHashing) {
+      return hashUTF16(string, using: _FastHashContext.self)
+    }
+    return hashUTF16(string, using: _SipHash13Context.self)
+  }
+
+  internal static func hashUTF16<Hasher : _StringHasher>(
+    _ string: UnsafeBufferPointer<UInt16>,
+    using _: Hasher.Type
+  ) -> Int {
+    // A string of characters which are in the starter collation table
+    // collates as the sequence of their table entries, so it doesn't need a
+    // collation iterator.
+    let starterTable = _swift_stdlib_unicode_getStarterCollationTable()
+    let starterTableSize =
+      UInt16(_swift_stdlib_unicode_getStarterCollationTableSize())
+    var hasher = Hasher(key: _Hashing.secretKey)
+    for u in string {
+      let element = u < starterTableSize ? starterTable[Int(u)] : 0
+      if element == 0 {
+        return hashUTF16WithCollationIterator(string, using: Hasher.self)
+      }
+      hasher.append(element)
+    }
+    return hasher._finalizeAndReturnIntHash()
+  }
+
+  internal static func hashUTF16WithCollationIterator<
+    Hasher : _StringHasher
+  >(
+    _ string: UnsafeBufferPointer<UInt16>,
+    using _: Hasher.Type
   ) -> Int {
     let collationIterator = _swift_stdlib_unicodeCollationIterator_create(
       string.baseAddress!,
       UInt32(string.count))
     defer { _swift_stdlib_unicodeCollationIterator_delete(collationIterator) }
 
-    var hasher = _SipHash13Context(key: _Hashing.secretKey)
+    var hasher = Hasher(key: _Hashing.secretKey)
     while true {
       var hitEnd = false
       let element =
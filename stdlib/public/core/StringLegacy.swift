@@ -88,6 +88,10 @@ extension String {
 
 extension String {
   public init(_ _c: UnicodeScalar) {
+    if _fastPath(_c.isASCII) {
+      self = String(_StringCore(_asciiCharacter: UTF8.CodeUnit(_c.value)))
+      return
+    }
     self = String._fromWellFormedCodeUnitSequence(
       UTF32.self,
       input: repeatElement(_c.value, count: 1))
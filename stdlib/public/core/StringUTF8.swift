@@ -361,6 +361,18 @@ extension String {
       return UTF8View(_core, bounds.lowerBound, bounds.upperBound)
     }
 
+    /// The number of UTF-8 code units in the view.
+    ///
+    /// - Complexity: O(1) if the string is stored as ASCII, where every
+    ///   UTF-8 code unit is an element of the underlying storage; otherwise,
+    ///   O(*n*), where *n* is the length of the view.
+    public var count: Int {
+      if _fastPath(_core.isASCII) {
+        return _endIndex._coreIndex - _startIndex._coreIndex
+      }
+      return distance(from: _startIndex, to: _endIndex)
+    }
+
     public var description: String {
       return String._fromCodeUnitSequenceWithRepair(UTF8.self, input: self).0
     }
@@ -395,6 +407,26 @@ extension String {
   ///     }
   ///     // Prints "6"
   public var utf8CString: ContiguousArray<CChar> {
+    if let asciiBuffer = self._core.asciiBuffer {
+      // ASCII storage is already UTF-8; copy it in one go.
+      let count = asciiBuffer.count
+      var result = ContiguousArray<CChar>(repeating: 0, count: count + 1)
+      result.withUnsafeMutableBufferPointer {
+        _memcpy(
+          dest: $0.baseAddress!,
+          src: asciiBuffer.baseAddress!,
+          size: UInt(count))
+      }
+      return result
+    }
+    if let count = _contiguousUTF16ByteCountAsUTF8 {
+      var result = ContiguousArray<CChar>(repeating: 0, count: count + 1)
+      result.withUnsafeMutableBufferPointer {
+        _transcodeContiguousUTF16AsUTF8(
+          into: UnsafeMutableRawPointer($0.baseAddress!))
+      }
+      return result
+    }
     var result = ContiguousArray<CChar>()
     result.reserveCapacity(utf8.count + 1)
     for c in utf8 {
@@ -404,6 +436,26 @@ extension String {
     return result
   }
 
+  /// The number of UTF-8 code units in the string if it is stored as
+  /// contiguous UTF-16, or `nil` otherwise.
+  internal var _contiguousUTF16ByteCountAsUTF8: Int? {
+    guard _core.hasContiguousStorage && _core.elementWidth == 2 else {
+      return nil
+    }
+    return _swift_stdlib_measureUTF16AsUTF8(_core.startUTF16, _core.count)
+  }
+
+  /// Writes the contiguous UTF-16 storage of the string to `destination` as
+  /// UTF-8, which must have room for `_contiguousUTF16ByteCountAsUTF8`
+  /// bytes.
+  internal func _transcodeContiguousUTF16AsUTF8(
+    into destination: UnsafeMutableRawPointer
+  ) {
+    _swift_stdlib_transcodeUTF16ToUTF8(
+      _core.startUTF16, _core.count,
+      destination.assumingMemoryBound(to: UTF8.CodeUnit.self))
+  }
+
   internal func _withUnsafeBufferPointerToUTF8<R>(
     _ body: (UnsafeBufferPointer<UTF8.CodeUnit>) throws -> R
   ) rethrows -> R {
@@ -412,6 +464,15 @@ extension String {
         start: asciiBuffer.baseAddress,
         count: asciiBuffer.count))
     }
+    if let count = _contiguousUTF16ByteCountAsUTF8 {
+      var nullTerminatedUTF8 =
+        ContiguousArray<UTF8.CodeUnit>(repeating: 0, count: count + 1)
+      nullTerminatedUTF8.withUnsafeMutableBufferPointer {
+        _transcodeContiguousUTF16AsUTF8(
+          into: UnsafeMutableRawPointer($0.baseAddress!))
+      }
+      return try nullTerminatedUTF8.withUnsafeBufferPointer(body)
+    }
     var nullTerminatedUTF8 = ContiguousArray<UTF8.CodeUnit>()
     nullTerminatedUTF8.reserveCapacity(utf8.count + 1)
     nullTerminatedUTF8 += utf8
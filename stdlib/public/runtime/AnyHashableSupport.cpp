@@ -27,6 +27,10 @@ struct HashableConformanceKey {
   /// The lookup key, the metadata of a type that is possibly derived
   /// from a type that conforms to `Hashable`.
   const Metadata *derivedType;
+
+  friend llvm::hash_code hash_value(const HashableConformanceKey &key) {
+    return llvm::hash_value(key.derivedType);
+  }
 };
 
 struct HashableConformanceEntry {
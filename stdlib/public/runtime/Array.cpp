@@ -0,0 +1,133 @@
+//===--- Array.cpp - Swift Language Array ABI -----------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Implementations of the array value witness operations for types whose
+// layout is only known at runtime.
+//
+// IRGen calls these instead of loading the array witnesses of the type, so
+// that the common cases (POD, bitwise-takable, and single references) are
+// handled with one check of the value witness flags and a memcpy or a tight
+// retain/release loop, instead of an indirect call into a witness which
+// loops over the elements.
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Runtime/HeapObject.h"
+#include "swift/Runtime/Metadata.h"
+#include <cstring>
+
+using namespace swift;
+
+/// Is the type a single native Swift reference?
+static bool isNativeObject(const ValueWitnessTable *wtable) {
+  return wtable == &_TWVBo;
+}
+
+/// Is the type a single reference of unknown reference counting?
+static bool isUnknownObject(const ValueWitnessTable *wtable) {
+  return wtable == &_TWVBO;
+}
+
+OpaqueValue *swift::swift_arrayInitWithCopy(OpaqueValue *dest,
+                                            OpaqueValue *src,
+                                            size_t count,
+                                            const Metadata *self) {
+  if (count == 0)
+    return dest;
+
+  auto wtable = self->getValueWitnesses();
+  if (wtable->isPOD()) {
+    memcpy(dest, src, wtable->getStride() * count);
+    return dest;
+  }
+
+  if (isNativeObject(wtable)) {
+    auto destRefs = reinterpret_cast<HeapObject **>(dest);
+    auto srcRefs = reinterpret_cast<HeapObject **>(src);
+    for (size_t i = 0; i < count; ++i) {
+      swift_retain(srcRefs[i]);
+      destRefs[i] = srcRefs[i];
+    }
+    return dest;
+  }
+
+  if (isUnknownObject(wtable)) {
+    auto destRefs = reinterpret_cast<void **>(dest);
+    auto srcRefs = reinterpret_cast<void **>(src);
+    for (size_t i = 0; i < count; ++i) {
+      swift_unknownRetain(srcRefs[i]);
+      destRefs[i] = srcRefs[i];
+    }
+    return dest;
+  }
+
+  return wtable->initializeArrayWithCopy(dest, src, count, self);
+}
+
+OpaqueValue *swift::swift_arrayInitWithTakeFrontToBack(OpaqueValue *dest,
+                                                       OpaqueValue *src,
+                                                       size_t count,
+                                                       const Metadata *self) {
+  if (count == 0)
+    return dest;
+
+  // References are bitwise-takable, so they don't need a case of their own.
+  auto wtable = self->getValueWitnesses();
+  if (wtable->isBitwiseTakable()) {
+    memmove(dest, src, wtable->getStride() * count);
+    return dest;
+  }
+
+  return wtable->initializeArrayWithTakeFrontToBack(dest, src, count, self);
+}
+
+OpaqueValue *swift::swift_arrayInitWithTakeBackToFront(OpaqueValue *dest,
+                                                       OpaqueValue *src,
+                                                       size_t count,
+                                                       const Metadata *self) {
+  if (count == 0)
+    return dest;
+
+  auto wtable = self->getValueWitnesses();
+  if (wtable->isBitwiseTakable()) {
+    memmove(dest, src, wtable->getStride() * count);
+    return dest;
+  }
+
+  return wtable->initializeArrayWithTakeBackToFront(dest, src, count, self);
+}
+
+void swift::swift_arrayDestroy(OpaqueValue *begin, size_t count,
+                               const Metadata *self) {
+  if (count == 0)
+    return;
+
+  auto wtable = self->getValueWitnesses();
+  if (wtable->isPOD())
+    return;
+
+  if (isNativeObject(wtable)) {
+    auto refs = reinterpret_cast<HeapObject **>(begin);
+    for (size_t i = 0; i < count; ++i)
+      swift_release(refs[i]);
+    return;
+  }
+
+  if (isUnknownObject(wtable)) {
+    auto refs = reinterpret_cast<void **>(begin);
+    for (size_t i = 0; i < count; ++i)
+      swift_unknownRelease(refs[i]);
+    return;
+  }
+
+  wtable->destroyArray(begin, count, self);
+}
@@ -18,13 +18,14 @@
 #include "swift/Basic/Demangle.h"
 #include "swift/Basic/Fallthrough.h"
 #include "swift/Basic/Lazy.h"
+#include "swift/Runtime/Concurrent.h"
 #include "swift/Runtime/Config.h"
 #include "swift/Runtime/Enum.h"
 #include "swift/Runtime/HeapObject.h"
 #include "swift/Runtime/Metadata.h"
 #include "swift/Runtime/Mutex.h"
+#include "swift/Runtime/Statistics.h"
 #include "llvm/ADT/DenseMap.h"
-#include "llvm/ADT/PointerIntPair.h"
 #include "swift/Runtime/Debug.h"
 #include "ErrorObject.h"
 #include "ExistentialMetadataImpl.h"
@@ -37,6 +38,7 @@
 #include "SwiftValue.h"
 #endif
 
+#include <algorithm>
 #include <cstring>
 #include <type_traits>
 
@@ -332,53 +334,72 @@ std::string swift::nameForMetadata(const Metadata *type,
   return result;
 }
 
-SWIFT_CC(swift) SWIFT_RUNTIME_EXPORT
-TwoWordPair<const char *, uintptr_t>::Return
-swift::swift_getTypeName(const Metadata *type, bool qualified) {
-  using Pair = TwoWordPair<const char *, uintptr_t>;
-  using Key = llvm::PointerIntPair<const Metadata *, 1, bool>;
+namespace {
+  struct TypeNameCacheKey {
+    const Metadata *Type;
+    bool Qualified;
 
-  static StaticReadWriteLock TypeNameCacheLock;
-  static Lazy<llvm::DenseMap<Key, std::pair<const char *, size_t>>>
-    TypeNameCache;
-  
-  Key key(type, qualified);
-  auto &cache = TypeNameCache.get();
+    friend llvm::hash_code hash_value(const TypeNameCacheKey &key) {
+      return llvm::hash_combine(key.Type, key.Qualified);
+    }
+  };
 
-  // Attempt read-only lookup of cache entry.
-  {
-    StaticScopedReadLock guard(TypeNameCacheLock);
+  /// A type name built by swift_getTypeName. The name is allocated with
+  /// malloc and never freed, since callers may reference it forever.
+  struct TypeNameCacheEntry {
+  private:
+    TypeNameCacheKey Key;
 
-    auto found = cache.find(key);
-    if (found != cache.end()) {
-      auto result = found->second;
-      return Pair{result.first, result.second};
-    }
-  }
+  public:
+    const char *Name;
+    size_t Size;
 
-  // Read-only lookup failed to find item, we may need to create it.
-  {
-    StaticScopedWriteLock guard(TypeNameCacheLock);
+    TypeNameCacheEntry(TypeNameCacheKey key, const char *name, size_t size)
+      : Key(key), Name(name), Size(size) {}
+
+    int compareWithKey(const TypeNameCacheKey &key) const {
+      if (int result = comparePointers(key.Type, Key.Type))
+        return result;
+      if (key.Qualified != Key.Qualified)
+        return key.Qualified ? 1 : -1;
+      return 0;
+    }
 
-    // Do lookup again just to make sure it wasn't created by another
-    // thread before we acquired the write lock.
-    auto found = cache.find(key);
-    if (found != cache.end()) {
-      auto result = found->second;
-      return Pair{result.first, result.second};
+    template <class... Args>
+    static size_t getExtraAllocationSize(Args &&... ignored) {
+      return 0;
     }
+  };
+} // end anonymous namespace
 
-    // Build the metadata name.
-    auto name = nameForMetadata(type, qualified);
-    // Copy it to memory we can reference forever.
-    auto size = name.size();
-    auto result = (char *)malloc(size + 1);
-    memcpy(result, name.data(), size);
-    result[size] = 0;
+static Lazy<ConcurrentMap<TypeNameCacheEntry>> TypeNames;
 
-    cache.insert({key, {result, size}});
-    return Pair{result, size};
-  }
+SWIFT_CC(swift) SWIFT_RUNTIME_EXPORT
+TwoWordPair<const char *, uintptr_t>::Return
+swift::swift_getTypeName(const Metadata *type, bool qualified) {
+  using Pair = TwoWordPair<const char *, uintptr_t>;
+
+  TypeNameCacheKey key{type, qualified};
+  auto &cache = TypeNames.get();
+
+  // Lookups of names we have already built don't take any lock.
+  if (auto found = cache.find(key))
+    return Pair{found->Name, found->Size};
+
+  // Build the metadata name outside of the map's writer lock.
+  auto name = nameForMetadata(type, qualified);
+  // Copy it to memory we can reference forever.
+  auto size = name.size();
+  auto result = (char *)malloc(size + 1);
+  memcpy(result, name.data(), size);
+  result[size] = 0;
+
+  // Another thread may have inserted the name while we were building it;
+  // if so, use theirs so that all callers get the same pointer.
+  auto insertion = cache.getOrInsert(key, result, size);
+  if (!insertion.second)
+    free(result);
+  return Pair{insertion.first->Name, insertion.first->Size};
 }
 
 /// Report a dynamic cast failure.
@@ -651,6 +672,118 @@ static bool _conformsToProtocols(const OpaqueValue *value,
   return true;
 }
 
+namespace {
+  struct ExistentialConformanceCacheKey {
+    const Metadata *Type;
+    const ExistentialTypeMetadata *Existential;
+
+    friend llvm::hash_code
+    hash_value(const ExistentialConformanceCacheKey &key) {
+      return llvm::hash_combine(key.Type, key.Existential);
+    }
+  };
+
+  /// The witness tables with which a type conforms to all of the protocols
+  /// of an existential type. The witness tables are tail-allocated.
+  ///
+  /// Only successful lookups are cached. Conformances are never removed, but
+  /// loading a new image can make a failed lookup succeed;
+  /// swift_conformsToProtocol already caches failures per protocol with the
+  /// necessary invalidation.
+  struct ExistentialConformanceCacheEntry {
+  private:
+    const Metadata *Type;
+    const ExistentialTypeMetadata *Existential;
+    unsigned NumWitnessTables;
+
+  public:
+    ExistentialConformanceCacheEntry(ExistentialConformanceCacheKey key,
+                                     unsigned numWitnessTables,
+                                     const WitnessTable * const *tables)
+      : Type(key.Type), Existential(key.Existential),
+        NumWitnessTables(numWitnessTables) {
+      std::copy(tables, tables + numWitnessTables, getWitnessTables());
+    }
+
+    int compareWithKey(const ExistentialConformanceCacheKey &key) const {
+      if (int result = comparePointers(key.Type, Type))
+        return result;
+      return comparePointers(key.Existential, Existential);
+    }
+
+    static size_t
+    getExtraAllocationSize(const ExistentialConformanceCacheKey &key,
+                           unsigned numWitnessTables,
+                           const WitnessTable * const *tables) {
+      return numWitnessTables * sizeof(const WitnessTable *);
+    }
+
+    size_t getExtraAllocationSize() const {
+      return NumWitnessTables * sizeof(const WitnessTable *);
+    }
+
+    unsigned getNumWitnessTables() const { return NumWitnessTables; }
+
+    const WitnessTable **getWitnessTables() {
+      return reinterpret_cast<const WitnessTable **>(this + 1);
+    }
+    const WitnessTable * const *getWitnessTables() const {
+      return reinterpret_cast<const WitnessTable * const *>(this + 1);
+    }
+  };
+} // end anonymous namespace
+
+static Lazy<ConcurrentMap<ExistentialConformanceCacheEntry>>
+  ExistentialConformances;
+
+/// Returns true if the result of _conformsToProtocols for the protocols of
+/// \p targetType depends only on the dynamic type of the value. This is not
+/// the case for Objective-C protocols, whose conformance is checked on the
+/// object itself.
+static bool isConformanceCacheable(const ExistentialTypeMetadata *targetType) {
+  for (unsigned i = 0, n = targetType->Protocols.NumProtocols; i != n; ++i) {
+    const ProtocolDescriptor *protocol = targetType->Protocols[i];
+    if (!protocol->Flags.needsWitnessTable() &&
+        protocol->Flags.getSpecialProtocol() != SpecialProtocol::AnyObject)
+      return false;
+  }
+  return true;
+}
+
+/// Check whether a type conforms to the protocols of an existential type,
+/// filling in a list of conformances. Successful lookups are cached by
+/// (type, existential type) pair, so that repeated casts between the same
+/// types replace the per-protocol conformance lookups with a single probe.
+static bool
+_conformsToExistentialProtocols(const OpaqueValue *value,
+                                const Metadata *type,
+                                const ExistentialTypeMetadata *targetType,
+                                const WitnessTable **conformances) {
+  if (!isConformanceCacheable(targetType))
+    return _conformsToProtocols(value, type, targetType->Protocols,
+                                conformances);
+
+  ExistentialConformanceCacheKey key{type, targetType};
+  auto &cache = ExistentialConformances.get();
+  if (auto *entry = cache.find(key)) {
+    countRuntimeStatistic(RuntimeStatistic::DynamicCastConformanceCacheHit);
+    std::copy(entry->getWitnessTables(),
+              entry->getWitnessTables() + entry->getNumWitnessTables(),
+              conformances);
+    return true;
+  }
+
+  RuntimeStatisticTimer timer(
+    RuntimeStatistic::DynamicCastConformanceCacheMiss);
+  if (!_conformsToProtocols(nullptr, type, targetType->Protocols,
+                            conformances))
+    return false;
+
+  cache.getOrInsert(key, targetType->Flags.getNumWitnessTables(),
+                    conformances);
+  return true;
+}
+
 static bool shouldDeallocateSource(bool castSucceeded, DynamicCastFlags flags) {
   return (castSucceeded && (flags & DynamicCastFlags::TakeOnSuccess)) ||
         (!castSucceeded && (flags & DynamicCastFlags::DestroyOnFailure));
@@ -1154,9 +1287,10 @@ static bool _dynamicCastToExistential(OpaqueValue *dest,
     // srcDynamicType equals nullptr we have a cast from an existential
     // container with a class instance to AnyObject. In this case no check is
     // necessary.
-    if (srcDynamicType && !_conformsToProtocols(srcDynamicValue, srcDynamicType,
-                              targetType->Protocols,
-                              destExistential->getWitnessTables()))
+    if (srcDynamicType &&
+        !_conformsToExistentialProtocols(srcDynamicValue, srcDynamicType,
+                                         targetType,
+                                         destExistential->getWitnessTables()))
       return fallbackForNonDirectConformance();
 
     auto object = *(reinterpret_cast<HeapObject**>(srcDynamicValue));
@@ -1172,9 +1306,9 @@ static bool _dynamicCastToExistential(OpaqueValue *dest,
       reinterpret_cast<OpaqueExistentialContainer*>(dest);
 
     // Check for protocol conformances and fill in the witness tables.
-    if (!_conformsToProtocols(srcDynamicValue, srcDynamicType,
-                              targetType->Protocols,
-                              destExistential->getWitnessTables()))
+    if (!_conformsToExistentialProtocols(srcDynamicValue, srcDynamicType,
+                                         targetType,
+                                         destExistential->getWitnessTables()))
       return fallbackForNonDirectConformance();
 
     // Fill in the type and value.
@@ -1196,9 +1330,8 @@ static bool _dynamicCastToExistential(OpaqueValue *dest,
     // one we need.
     assert(targetType->Protocols.NumProtocols == 1);
     const WitnessTable *errorWitness;
-    if (!_conformsToProtocols(srcDynamicValue, srcDynamicType,
-                              targetType->Protocols,
-                              &errorWitness))
+    if (!_conformsToExistentialProtocols(srcDynamicValue, srcDynamicType,
+                                         targetType, &errorWitness))
       return fallbackForNonDirectConformance();
 
 #if SWIFT_OBJC_INTEROP
@@ -2616,6 +2749,8 @@ bool swift::swift_dynamicCast(OpaqueValue *dest,
                               const Metadata *targetType,
                               DynamicCastFlags flags)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
+  countRuntimeStatistic(RuntimeStatistic::DynamicCast);
+
   auto unwrapResult = checkDynamicCastFromOptional(dest, src, srcType,
                                                    targetType, flags);
   srcType = unwrapResult.payloadType;
@@ -2931,6 +3066,8 @@ static bool _dynamicCastValueToClassViaObjCBridgeable(
                const Metadata *targetType,
                const _ObjectiveCBridgeableWitnessTable *srcBridgeWitness,
                DynamicCastFlags flags) {
+  RuntimeStatisticTimer timer(RuntimeStatistic::DynamicCastBridging);
+
   // Bridge the source value to an object.
   auto srcBridgedObject =
     srcBridgeWitness->bridgeToObjectiveC(src, srcType, srcBridgeWitness);
@@ -2968,6 +3105,8 @@ static bool _dynamicCastValueToClassExistentialViaObjCBridgeable(
               const ExistentialTypeMetadata *targetType,
               const _ObjectiveCBridgeableWitnessTable *srcBridgeWitness,
               DynamicCastFlags flags) {
+  RuntimeStatisticTimer timer(RuntimeStatistic::DynamicCastBridging);
+
   // Bridge the source value to an object.
   auto srcBridgedObject =
     srcBridgeWitness->bridgeToObjectiveC(src, srcType, srcBridgeWitness);
@@ -3004,6 +3143,8 @@ static bool _dynamicCastClassToValueViaObjCBridgeable(
                const Metadata *targetType,
                const _ObjectiveCBridgeableWitnessTable *targetBridgeWitness,
                DynamicCastFlags flags) {
+  RuntimeStatisticTimer timer(RuntimeStatistic::DynamicCastBridging);
+
   // Determine the class type to which the target value type is bridged.
   auto targetBridgedClass =
     targetBridgeWitness->ObjectiveCType(targetType, targetBridgeWitness);
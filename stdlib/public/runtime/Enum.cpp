@@ -140,6 +140,19 @@ swift::swift_initEnumValueWitnessTableSinglePayload(ValueWitnessTable *vwtable,
   }
 }
 
+/// Is the payload a single reference with the extra inhabitants of a heap
+/// object? Most of these use the standard value witness tables of
+/// NativeObject or UnknownObject, so the common case of an optional class
+/// reference can check and store its tag without calling into the payload's
+/// extra inhabitant witnesses.
+static bool hasHeapObjectExtraInhabitants(const ValueWitnessTable *vwtable) {
+  return vwtable == &_TWVBo
+#if SWIFT_OBJC_INTEROP
+      || vwtable == &_TWVBO
+#endif
+      ;
+}
+
 SWIFT_RT_ENTRY_VISIBILITY
 int
 swift::swift_getEnumCaseSinglePayload(const OpaqueValue *value,
@@ -147,6 +160,14 @@ swift::swift_getEnumCaseSinglePayload(const OpaqueValue *value,
                                       unsigned emptyCases)
   SWIFT_CC(RegisterPreservingCC_IMPL) {
   auto *payloadWitnesses = payload->getValueWitnesses();
+
+  // If the empty cases all fit into the extra inhabitants of a reference,
+  // there are no extra tag bits to check.
+  if (hasHeapObjectExtraInhabitants(payloadWitnesses) &&
+      emptyCases <= swift_getHeapObjectExtraInhabitantCount())
+    return swift_getHeapObjectExtraInhabitantIndex(
+        reinterpret_cast<HeapObject * const *>(value));
+
   auto payloadSize = payloadWitnesses->getSize();
   auto payloadNumExtraInhabitants = payloadWitnesses->getNumExtraInhabitants();
 
@@ -208,6 +229,17 @@ swift::swift_storeEnumTagSinglePayload(OpaqueValue *value,
                                        unsigned emptyCases)
   SWIFT_CC(RegisterPreservingCC_IMPL) {
   auto *payloadWitnesses = payload->getValueWitnesses();
+
+  // If the empty cases all fit into the extra inhabitants of a reference,
+  // there are no extra tag bits to clear.
+  if (hasHeapObjectExtraInhabitants(payloadWitnesses) &&
+      emptyCases <= swift_getHeapObjectExtraInhabitantCount()) {
+    if (whichCase != -1)
+      swift_storeHeapObjectExtraInhabitant(
+          reinterpret_cast<HeapObject **>(value), whichCase);
+    return;
+  }
+
   auto payloadSize = payloadWitnesses->getSize();
   unsigned payloadNumExtraInhabitants
     = payloadWitnesses->getNumExtraInhabitants();
@@ -59,7 +59,12 @@ static void _destroyErrorObject(HeapObject *obj) {
 }
 
 /// Heap metadata for Error boxes.
-static const FullMetadata<HeapMetadata> ErrorMetadata{
+///
+/// The compiler references it from the boxes it allocates statically for
+/// errors without a payload. Those boxes are immortal, so their destructor is
+/// never called.
+SWIFT_RUNTIME_EXPORT
+extern "C" const FullMetadata<HeapMetadata> _swift_errorBoxMetadata{
   HeapMetadataHeader{{_destroyErrorObject}, {&_TWVBo}},
   Metadata{MetadataKind::ErrorObject},
 };
@@ -73,7 +78,7 @@ swift::swift_allocError(const swift::Metadata *type,
                         bool isTake) {
   auto sizeAndAlign = _getErrorAllocatedSizeAndAlignmentMask(type);
   
-  auto allocated = swift_allocObject(&ErrorMetadata,
+  auto allocated = swift_allocObject(&_swift_errorBoxMetadata,
                                      sizeAndAlign.first, sizeAndAlign.second);
   
   auto error = reinterpret_cast<SwiftError*>(allocated);
@@ -95,6 +100,9 @@ swift::swift_allocError(const swift::Metadata *type,
 
 void
 swift::swift_deallocError(SwiftError *error, const Metadata *type) {
+  // Statically allocated boxes are not ours to free.
+  if (error->refCount.isImmortal())
+    return;
   auto sizeAndAlign = _getErrorAllocatedSizeAndAlignmentMask(type);
   swift_deallocObject(error, sizeAndAlign.first, sizeAndAlign.second);
 }
@@ -16,17 +16,308 @@
 
 #include "swift/Runtime/HeapObject.h"
 #include "swift/Runtime/Heap.h"
+#include "swift/Basic/Lazy.h"
+#include "swift/Basic/Malloc.h"
+#include "swift/Runtime/Mutex.h"
 #include "Private.h"
 #include "swift/Runtime/Debug.h"
+#include <atomic>
 #include <stdlib.h>
 
+#if SWIFT_RUNTIME_SIZE_CLASS_ALLOCATOR
+#include <pthread.h>
+#include <sys/mman.h>
+#endif
+
 using namespace swift;
 
+/// The alignment that malloc guarantees without being asked, minus one.
+#if defined(__APPLE__)
+#define MALLOC_ALIGN_MASK 15
+#else
+#define MALLOC_ALIGN_MASK (2 * sizeof(void*) - 1)
+#endif
+
+#if SWIFT_RUNTIME_SIZE_CLASS_ALLOCATOR
+
+/*****************************************************************************/
+/**************************** SIZE-CLASS ALLOCATOR ***************************/
+/*****************************************************************************/
+
+// Small blocks are carved out of a single reserved range of address space,
+// which is divided into fixed-size spans.  Each span holds blocks of one
+// size class, so the class of any block can be recovered from its address
+// alone.  That matters because callers don't always pass the allocated size
+// back to swift_slowDealloc: objects with tail-allocated storage report
+// their instance size, and some callers pass -1.
+//
+// Every thread keeps a free list per size class.  Allocation pops from it,
+// then bumps through the thread's current span for that class, then pulls
+// a batch from the global lists, and only then claims a new span.  Freed
+// blocks go onto the freeing thread's list; when a list grows too long,
+// half of it moves to the global list where any thread can reuse it.
+
+namespace {
+
+/// Size classes are multiples of this, which is also the guaranteed
+/// alignment of every block.
+constexpr size_t SizeClassGranularity = 16;
+static_assert(SizeClassGranularity > MALLOC_ALIGN_MASK,
+              "size-class blocks must be as aligned as malloc blocks");
+
+/// Larger requests go to malloc.
+constexpr size_t MaxSizeClassAllocation = 256;
+
+constexpr unsigned NumSizeClasses =
+  MaxSizeClassAllocation / SizeClassGranularity;
+
+constexpr size_t SpanSize = 64 * 1024;
+
+/// The amount of address space reserved for small blocks.  Pages are only
+/// backed once they are touched.  When it runs out, small allocations fall
+/// back to malloc.
+constexpr size_t RegionSize = size_t(4) << 30;
+
+constexpr size_t NumSpans = RegionSize / SpanSize;
+
+/// The most blocks a thread keeps on one free list before handing half of
+/// them to the global list.
+constexpr unsigned MaxCachedBlocks = 256;
+
+/// How many blocks a thread takes from the global list at once.
+constexpr unsigned RefillBatchSize = 64;
+
+static unsigned getSizeClass(size_t size) {
+  return size == 0 ? 0 : (size - 1) / SizeClassGranularity;
+}
+
+static size_t getSizeClassBlockSize(unsigned sizeClass) {
+  return (sizeClass + 1) * SizeClassGranularity;
+}
+
+struct FreeBlock {
+  FreeBlock *Next;
+};
+
+struct FreeList {
+  FreeBlock *Head;
+  unsigned Count;
+
+  void push(FreeBlock *block) {
+    block->Next = Head;
+    Head = block;
+    ++Count;
+  }
+
+  FreeBlock *pop() {
+    FreeBlock *block = Head;
+    if (block) {
+      Head = block->Next;
+      --Count;
+    }
+    return block;
+  }
+
+  /// Detach the first \p n blocks (n <= Count) as a chain ending in null,
+  /// returning its head and tail.
+  std::pair<FreeBlock *, FreeBlock *> detach(unsigned n) {
+    assert(n > 0 && n <= Count);
+    FreeBlock *first = Head, *last = Head;
+    for (unsigned i = 1; i != n; ++i)
+      last = last->Next;
+    Head = last->Next;
+    last->Next = nullptr;
+    Count -= n;
+    return { first, last };
+  }
+};
+
+struct ThreadCache {
+  FreeList Lists[NumSizeClasses];
+
+  /// The unallocated remainder of the span this thread is carving for
+  /// each class.
+  char *BumpBegin[NumSizeClasses];
+  char *BumpEnd[NumSizeClasses];
+};
+
+struct SizeClassHeap {
+  /// The reserved region, or null if the allocator is disabled.
+  char *Base = nullptr;
+
+  /// The index of the next span that has never been used.
+  std::atomic<size_t> NextSpan{0};
+
+  /// For each span that has been claimed, one plus its size class.  Lazy
+  /// zero-initializes its storage, so unclaimed spans read as 0.
+  std::atomic<uint8_t> SpanSizeClass[NumSpans];
+
+  /// Blocks released by threads, available to all of them.
+  FreeList GlobalLists[NumSizeClasses] = {};
+  StaticMutex GlobalListsLock;
+
+  pthread_key_t CacheKey;
+
+  SizeClassHeap();
+
+  bool contains(const void *ptr) const {
+    auto p = reinterpret_cast<const char *>(ptr);
+    return Base && p >= Base && p < Base + RegionSize;
+  }
+
+  unsigned getSizeClassOf(const void *ptr) const {
+    size_t span = (reinterpret_cast<const char *>(ptr) - Base) / SpanSize;
+    unsigned sizeClassPlusOne =
+      SpanSizeClass[span].load(std::memory_order_relaxed);
+    assert(sizeClassPlusOne != 0 && "pointer into an unclaimed span");
+    return sizeClassPlusOne - 1;
+  }
+
+  ThreadCache *getThreadCache() {
+    auto cache = static_cast<ThreadCache *>(pthread_getspecific(CacheKey));
+    if (LLVM_LIKELY(cache != nullptr))
+      return cache;
+
+    cache = static_cast<ThreadCache *>(calloc(1, sizeof(ThreadCache)));
+    if (!cache)
+      swift::crash("Could not allocate memory.");
+    pthread_setspecific(CacheKey, cache);
+    return cache;
+  }
+
+  void *allocate(unsigned sizeClass);
+  void deallocate(void *ptr);
+
+  static void destroyThreadCache(void *cache);
+};
+
+} // end anonymous namespace
+
+static Lazy<SizeClassHeap> TheSizeClassHeap;
+
+SizeClassHeap::SizeClassHeap() {
+  // Leave small allocations to malloc if the user asked for that, e.g. to
+  // use a malloc debugging tool.
+  if (getenv("SWIFT_DEBUG_DISABLE_SIZE_CLASS_ALLOCATOR"))
+    return;
+
+  if (pthread_key_create(&CacheKey, destroyThreadCache) != 0)
+    return;
+
+  // Reserve the region without committing memory for it.
+  int flags = MAP_PRIVATE | MAP_ANON;
+#if defined(MAP_NORESERVE)
+  flags |= MAP_NORESERVE;
+#endif
+  void *region = mmap(nullptr, RegionSize, PROT_READ | PROT_WRITE, flags,
+                      -1, 0);
+  if (region == MAP_FAILED)
+    return;
+
+  Base = static_cast<char *>(region);
+}
+
+void *SizeClassHeap::allocate(unsigned sizeClass) {
+  ThreadCache *cache = getThreadCache();
+  FreeList &list = cache->Lists[sizeClass];
+
+  if (FreeBlock *block = list.pop())
+    return block;
+
+  size_t blockSize = getSizeClassBlockSize(sizeClass);
+  char *&bump = cache->BumpBegin[sizeClass];
+  if (bump && bump + blockSize <= cache->BumpEnd[sizeClass]) {
+    void *result = bump;
+    bump += blockSize;
+    return result;
+  }
+
+  // Take a batch of blocks other threads have released.
+  GlobalListsLock.withLock([&] {
+    FreeList &global = GlobalLists[sizeClass];
+    if (global.Count == 0)
+      return;
+    unsigned n = std::min(global.Count, RefillBatchSize);
+    auto chain = global.detach(n);
+    chain.second->Next = list.Head;
+    list.Head = chain.first;
+    list.Count += n;
+  });
+  if (FreeBlock *block = list.pop())
+    return block;
+
+  // Claim a fresh span.
+  size_t span = NextSpan.fetch_add(1, std::memory_order_relaxed);
+  if (span >= NumSpans)
+    return nullptr;
+  SpanSizeClass[span].store(sizeClass + 1, std::memory_order_relaxed);
+
+  char *spanBegin = Base + span * SpanSize;
+  bump = spanBegin + blockSize;
+  cache->BumpEnd[sizeClass] = spanBegin + SpanSize;
+  return spanBegin;
+}
+
+void SizeClassHeap::deallocate(void *ptr) {
+  unsigned sizeClass = getSizeClassOf(ptr);
+  ThreadCache *cache = getThreadCache();
+  FreeList &list = cache->Lists[sizeClass];
+  list.push(static_cast<FreeBlock *>(ptr));
+
+  if (list.Count <= MaxCachedBlocks)
+    return;
+
+  auto chain = list.detach(MaxCachedBlocks / 2);
+  GlobalListsLock.withLock([&] {
+    FreeList &global = GlobalLists[sizeClass];
+    chain.second->Next = global.Head;
+    global.Head = chain.first;
+    global.Count += MaxCachedBlocks / 2;
+  });
+}
+
+void SizeClassHeap::destroyThreadCache(void *opaqueCache) {
+  auto cache = static_cast<ThreadCache *>(opaqueCache);
+  auto &heap = TheSizeClassHeap.unsafeGetAlreadyInitialized();
+
+  heap.GlobalListsLock.withLock([&] {
+    for (unsigned sizeClass = 0; sizeClass != NumSizeClasses; ++sizeClass) {
+      FreeList &list = cache->Lists[sizeClass];
+      FreeList &global = heap.GlobalLists[sizeClass];
+      while (FreeBlock *block = list.pop())
+        global.push(block);
+
+      // Don't strand the rest of the span this thread was carving.
+      size_t blockSize = getSizeClassBlockSize(sizeClass);
+      char *bump = cache->BumpBegin[sizeClass];
+      char *end = cache->BumpEnd[sizeClass];
+      for (; bump && bump + blockSize <= end; bump += blockSize)
+        global.push(reinterpret_cast<FreeBlock *>(bump));
+    }
+  });
+
+  free(cache);
+}
+
+#endif // SWIFT_RUNTIME_SIZE_CLASS_ALLOCATOR
+
 SWIFT_RT_ENTRY_VISIBILITY
 void *swift::swift_slowAlloc(size_t size, size_t alignMask)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
-  // FIXME: use posix_memalign if alignMask is larger than the system guarantee.
-  void *p = malloc(size);
+  void *p;
+  if (alignMask <= MALLOC_ALIGN_MASK) {
+#if SWIFT_RUNTIME_SIZE_CLASS_ALLOCATOR
+    if (size <= MaxSizeClassAllocation) {
+      auto &heap = TheSizeClassHeap.get();
+      if (heap.Base)
+        if ((p = heap.allocate(getSizeClass(size))))
+          return p;
+    }
+#endif
+    p = malloc(size);
+  } else {
+    p = AlignedAlloc(size, alignMask + 1);
+  }
   if (!p) swift::crash("Could not allocate memory.");
   return p;
 }
@@ -34,5 +325,39 @@ void *swift::swift_slowAlloc(size_t size, size_t alignMask)
 SWIFT_RT_ENTRY_VISIBILITY
 void swift::swift_slowDealloc(void *ptr, size_t bytes, size_t alignMask)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
-  free(ptr);
+#if SWIFT_RUNTIME_SIZE_CLASS_ALLOCATOR
+  // The heap must already exist if ptr came from it.
+  auto &heap = TheSizeClassHeap.get();
+  if (heap.contains(ptr)) {
+    heap.deallocate(ptr);
+    return;
+  }
+#endif
+  if (alignMask <= MALLOC_ALIGN_MASK) {
+    free(ptr);
+  } else {
+    AlignedFree(ptr);
+  }
+}
+
+void *swift::_swift_slowRealloc(void *ptr, size_t newSize, size_t alignMask) {
+  if (alignMask > MALLOC_ALIGN_MASK)
+    return nullptr;
+#if SWIFT_RUNTIME_SIZE_CLASS_ALLOCATOR
+  // Blocks of a size class can't grow, and moving one would just be a copy,
+  // which the caller can do as well.
+  auto &heap = TheSizeClassHeap.get();
+  if (heap.contains(ptr))
+    return nullptr;
+#endif
+  return realloc(ptr, newSize);
+}
+
+size_t swift::_swift_slowAllocUsableSize(const void *ptr) {
+#if SWIFT_RUNTIME_SIZE_CLASS_ALLOCATOR
+  auto &heap = TheSizeClassHeap.get();
+  if (heap.contains(ptr))
+    return getSizeClassBlockSize(heap.getSizeClassOf(ptr));
+#endif
+  return 0;
 }
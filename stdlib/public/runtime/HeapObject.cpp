@@ -18,12 +18,17 @@
 #include "swift/Runtime/HeapObject.h"
 #include "swift/Runtime/Heap.h"
 #include "swift/Runtime/Metadata.h"
+#include "swift/Runtime/Mutex.h"
+#include "swift/Runtime/SamplingProfiler.h"
+#include "swift/Runtime/Statistics.h"
 #include "swift/ABI/System.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/Support/MathExtras.h"
 #include "MetadataCache.h"
 #include "Private.h"
 #include "swift/Runtime/Debug.h"
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstring>
 #include <cstdio>
@@ -48,6 +53,9 @@ swift::swift_allocObject(HeapMetadata const *metadata,
                          size_t requiredSize,
                          size_t requiredAlignmentMask)
     SWIFT_CC(RegisterPreservingCC_IMPL) {
+  // The first allocation starts the sampling profiler if the environment
+  // asks for it, which replaces the entry points' hooks.
+  checkSamplingProfiler();
   return SWIFT_RT_ENTRY_REF(swift_allocObject)(metadata, requiredSize,
                                                requiredAlignmentMask);
 }
@@ -74,6 +82,33 @@ SWIFT_RT_ENTRY_IMPL(swift_allocObject)(HeapMetadata const *metadata,
   return object;
 }
 
+HeapObject *
+swift::swift_tryReallocObject(HeapObject *object, size_t newSize,
+                              size_t alignMask) {
+#if SWIFT_OBJC_INTEROP || SWIFT_RUNTIME_ENABLE_LEAK_CHECKER
+  // The Objective-C runtime and the leak checker may have recorded the
+  // object's address.
+  return nullptr;
+#else
+#if defined(SWIFT_RT_USE_WRAPPERS)
+  // If allocation is interposed, the object may not have come from
+  // swift_slowAlloc.
+  if (reinterpret_cast<void *>(SWIFT_RT_ENTRY_REF(swift_allocObject)) !=
+      reinterpret_cast<void *>(&SWIFT_RT_ENTRY_IMPL(swift_allocObject)))
+    return nullptr;
+#endif
+  // Stack-promoted objects have an extra weak reference count, so this also
+  // excludes them.
+  if (!object->refCount.isUniquelyReferenced() ||
+      object->weakRefCount.getCount() != 1 ||
+      object->weakRefCount.hasSideTable())
+    return nullptr;
+
+  return static_cast<HeapObject *>(
+      _swift_slowRealloc(object, newSize, alignMask));
+#endif
+}
+
 HeapObject *
 swift::swift_initStackObject(HeapMetadata const *metadata,
                              HeapObject *object) {
@@ -91,7 +126,8 @@ swift::swift_verifyEndOfLifetime(HeapObject *object) {
     swift::fatalError(/* flags = */ 0,
                       "fatal error: stack object escaped\n");
   
-  if (object->weakRefCount.getCount() != 1)
+  if (object->weakRefCount.getCount() != 1 ||
+      object->weakRefCount.hasSideTable())
     swift::fatalError(/* flags = */ 0,
                       "fatal error: weak/unowned reference to stack object\n");
 }
@@ -393,8 +429,9 @@ HeapObject *swift::swift_tryPin(HeapObject *object)
     return object;
   }
 
-  // If setting the flag failed, it's because it was already set.
-  // Return nil so that the object will be deallocated later.
+  // If setting the flag failed, it's because it was already set or the
+  // object is immortal. Return nil so that the object will be deallocated
+  // later.
   return nullptr;
 }
 
@@ -423,8 +460,9 @@ HeapObject *swift::swift_nonatomic_tryPin(HeapObject *object)
     return object;
   }
 
-  // If setting the flag failed, it's because it was already set.
-  // Return nil so that the object will be deallocated later.
+  // If setting the flag failed, it's because it was already set or the
+  // object is immortal. Return nil so that the object will be deallocated
+  // later.
   return nullptr;
 }
 
@@ -617,6 +655,11 @@ void swift::swift_deallocObject(HeapObject *object,
   // If we are tracking leaks, stop tracking this object.
   SWIFT_LEAKS_STOP_TRACKING_OBJECT(object);
 
+  // Weak references to the object now load as nil without touching its
+  // memory.
+  if (object->weakRefCount.hasSideTable())
+    detachWeakSideTableEntry(object);
+
   // Drop the initial weak retain of the object.
   //
   // If the outstanding weak retain count is 1 (i.e. only the initial
@@ -693,142 +736,198 @@ void swift::swift_deallocObject(HeapObject *object,
 
 enum: uintptr_t {
   WR_NATIVE = 1<<(swift::heap_object_abi::ObjCReservedLowBits),
-  WR_READING = 1<<(swift::heap_object_abi::ObjCReservedLowBits+1),
 
   WR_NATIVEMASK = WR_NATIVE | swift::heap_object_abi::ObjCReservedBitsMask,
 };
 
-static_assert(WR_READING < alignof(void*),
-              "weakref lock bit mustn't interfere with real pointer bits");
-
 enum: short {
   WR_SPINLIMIT = 64,
 };
 
+namespace {
+
+/// The side table entry that native weak references point to.
+///
+/// An entry is created the first time a weak reference to an object is
+/// formed and is detached from the object when the object is deallocated.
+/// Weak references therefore don't hold an unowned reference to the object,
+/// and its memory can be freed as soon as it is deinitialized instead of
+/// when the last weak reference is destroyed.
+///
+/// Entries are reference counted: each weak reference holds one reference,
+/// and the object holds one until it is deallocated.
+class WeakSideTableEntry {
+  /// The low bit of Object is a spin lock. It keeps the object from being
+  /// deallocated while a weak load is trying to retain it.
+  enum : uintptr_t { LockBit = 1 };
+
+  /// The referenced object, or null once it has been deallocated.
+  std::atomic<uintptr_t> Object;
+
+  std::atomic<uint32_t> RefCount;
+
+  uintptr_t lock() {
+    auto value = Object.fetch_or(LockBit, std::memory_order_acquire);
+    while (value & LockBit) {
+      short c = 0;
+      while (Object.load(std::memory_order_relaxed) & LockBit) {
+        if (++c == WR_SPINLIMIT) {
+          std::this_thread::yield();
+          c -= 1;
+        }
+      }
+      value = Object.fetch_or(LockBit, std::memory_order_acquire);
+    }
+    return value;
+  }
+
+  void unlock(uintptr_t value) {
+    Object.store(value, std::memory_order_release);
+  }
+
+public:
+  explicit WeakSideTableEntry(HeapObject *object)
+    : Object(reinterpret_cast<uintptr_t>(object)), RefCount(1) {}
+
+  void retain() {
+    RefCount.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void release() {
+    if (RefCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      delete this;
+  }
+
+  /// Return a strong reference to the object, or null if it has been
+  /// deallocated or is being deinitialized.
+  HeapObject *tryRetainObject() {
+    uintptr_t value = lock();
+    HeapObject *result = nullptr;
+    if (auto object = reinterpret_cast<HeapObject *>(value)) {
+      if (!object->refCount.isDeallocating())
+        result = swift_tryRetain(object);
+    }
+    unlock(value);
+    return result;
+  }
+
+  /// Forget the object, which is about to be deallocated.
+  void detach() {
+    lock();
+    unlock(0);
+  }
+};
+
+struct WeakSideTableState {
+  StaticMutex Lock;
+  llvm::DenseMap<HeapObject *, WeakSideTableEntry *> Entries;
+};
+
+} // end anonymous namespace
+
+static Lazy<WeakSideTableState> WeakSideTables;
+
+/// Return the side table entry of \p object, creating it if necessary, with
+/// a new reference held by the caller.
+static WeakSideTableEntry *retainWeakSideTableEntry(HeapObject *object) {
+  auto &state = WeakSideTables.get();
+  StaticScopedLock guard(state.Lock);
+  auto &entry = state.Entries[object];
+  if (!entry) {
+    entry = new WeakSideTableEntry(object);
+    object->weakRefCount.setHasSideTable();
+  }
+  entry->retain();
+  return entry;
+}
+
+/// Detach the side table entry of \p object, which is being deallocated.
+static void detachWeakSideTableEntry(HeapObject *object) {
+  WeakSideTableEntry *entry;
+  {
+    auto &state = WeakSideTables.get();
+    StaticScopedLock guard(state.Lock);
+    auto found = state.Entries.find(object);
+    assert(found != state.Entries.end() && "missing weak side table entry");
+    entry = found->second;
+    state.Entries.erase(found);
+  }
+  entry->detach();
+  entry->release();
+}
+
+static WeakSideTableEntry *getWeakSideTableEntry(WeakReference *ref) {
+  return reinterpret_cast<WeakSideTableEntry *>(ref->Value & ~WR_NATIVE);
+}
+
+static void setWeakSideTableEntry(WeakReference *ref,
+                                  WeakSideTableEntry *entry) {
+  ref->Value = entry ? reinterpret_cast<uintptr_t>(entry) | WR_NATIVE
+                     : (uintptr_t)nullptr;
+}
+
+static void releaseWeakSideTableEntry(WeakReference *ref) {
+  if (auto entry = getWeakSideTableEntry(ref))
+    entry->release();
+}
+
 bool swift::isNativeSwiftWeakReference(WeakReference *ref) {
   return (ref->Value & WR_NATIVEMASK) == WR_NATIVE;
 }
 
 void swift::swift_weakInit(WeakReference *ref, HeapObject *value) {
-  ref->Value = (uintptr_t)value | WR_NATIVE;
-  SWIFT_RT_ENTRY_CALL(swift_unownedRetain)(value);
+  setWeakSideTableEntry(ref, value ? retainWeakSideTableEntry(value)
+                                   : nullptr);
 }
 
 void swift::swift_weakAssign(WeakReference *ref, HeapObject *newValue) {
-  SWIFT_RT_ENTRY_CALL(swift_unownedRetain)(newValue);
-  auto oldValue = (HeapObject*) (ref->Value & ~WR_NATIVE);
-  ref->Value = (uintptr_t)newValue | WR_NATIVE;
-  SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(oldValue);
+  auto newEntry = newValue ? retainWeakSideTableEntry(newValue) : nullptr;
+  releaseWeakSideTableEntry(ref);
+  setWeakSideTableEntry(ref, newEntry);
 }
 
 HeapObject *swift::swift_weakLoadStrong(WeakReference *ref) {
-  if (ref->Value == (uintptr_t)nullptr) {
+  countRuntimeStatistic(RuntimeStatistic::WeakLoadStrong);
+  auto entry = getWeakSideTableEntry(ref);
+  if (!entry)
     return nullptr;
-  }
-
-  // ref might be visible to other threads
-  auto ptr = __atomic_fetch_or(&ref->Value, WR_READING, __ATOMIC_RELAXED);
-  while (ptr & WR_READING) {
-    short c = 0;
-    while (__atomic_load_n(&ref->Value, __ATOMIC_RELAXED) & WR_READING) {
-      if (++c == WR_SPINLIMIT) {
-        std::this_thread::yield();
-        c -= 1;
-      }
-    }
-    ptr = __atomic_fetch_or(&ref->Value, WR_READING, __ATOMIC_RELAXED);
-  }
-
-  auto object = (HeapObject*)(ptr & ~WR_NATIVE);
-  if (object == nullptr) {
-    __atomic_store_n(&ref->Value, (uintptr_t)nullptr, __ATOMIC_RELAXED);
-    return nullptr;
-  }
-  if (object->refCount.isDeallocating()) {
-    __atomic_store_n(&ref->Value, (uintptr_t)nullptr, __ATOMIC_RELAXED);
-    SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(object);
-    return nullptr;
-  }
-  auto result = swift_tryRetain(object);
-  __atomic_store_n(&ref->Value, ptr, __ATOMIC_RELAXED);
-  return result;
+  return entry->tryRetainObject();
 }
 
 HeapObject *swift::swift_weakTakeStrong(WeakReference *ref) {
-  auto object = (HeapObject*) (ref->Value & ~WR_NATIVE);
-  if (object == nullptr) return nullptr;
-  auto result = swift_tryRetain(object);
-  ref->Value = (uintptr_t)nullptr;
-  swift_unownedRelease(object);
+  auto result = swift_weakLoadStrong(ref);
+  swift_weakDestroy(ref);
   return result;
 }
 
 void swift::swift_weakDestroy(WeakReference *ref) {
-  auto tmp = (HeapObject*) (ref->Value & ~WR_NATIVE);
+  releaseWeakSideTableEntry(ref);
   ref->Value = (uintptr_t)nullptr;
-  SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(tmp);
 }
 
 void swift::swift_weakCopyInit(WeakReference *dest, WeakReference *src) {
-  if (src->Value == (uintptr_t)nullptr) {
-    dest->Value = (uintptr_t)nullptr;
-    return;
-  }
-
-  // src might be visible to other threads
-  auto ptr = __atomic_fetch_or(&src->Value, WR_READING, __ATOMIC_RELAXED);
-  while (ptr & WR_READING) {
-    short c = 0;
-    while (__atomic_load_n(&src->Value, __ATOMIC_RELAXED) & WR_READING) {
-      if (++c == WR_SPINLIMIT) {
-        std::this_thread::yield();
-        c -= 1;
-      }
-    }
-    ptr = __atomic_fetch_or(&src->Value, WR_READING, __ATOMIC_RELAXED);
-  }
-
-  auto object = (HeapObject*)(ptr & ~WR_NATIVE);
-  if (object == nullptr) {
-    __atomic_store_n(&src->Value, (uintptr_t)nullptr, __ATOMIC_RELAXED);
-    dest->Value = (uintptr_t)nullptr;
-  } else if (object->refCount.isDeallocating()) {
-    __atomic_store_n(&src->Value, (uintptr_t)nullptr, __ATOMIC_RELAXED);
-    SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(object);
-    dest->Value = (uintptr_t)nullptr;
-  } else {
-    SWIFT_RT_ENTRY_CALL(swift_unownedRetain)(object);
-    __atomic_store_n(&src->Value, ptr, __ATOMIC_RELAXED);
-    dest->Value = (uintptr_t)object | WR_NATIVE;
-  }
+  auto entry = getWeakSideTableEntry(src);
+  if (entry)
+    entry->retain();
+  setWeakSideTableEntry(dest, entry);
 }
 
 void swift::swift_weakTakeInit(WeakReference *dest, WeakReference *src) {
-  auto object = (HeapObject*) (src->Value & ~WR_NATIVE);
-  if (object == nullptr) {
-    dest->Value = (uintptr_t)nullptr;
-  } else if (object->refCount.isDeallocating()) {
-    dest->Value = (uintptr_t)nullptr;
-    SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(object);
-  } else {
-    dest->Value = (uintptr_t)object | WR_NATIVE;
-  }
+  dest->Value = src->Value;
   src->Value = (uintptr_t)nullptr;
 }
 
 void swift::swift_weakCopyAssign(WeakReference *dest, WeakReference *src) {
-  if (dest->Value) {
-    auto object = (HeapObject*) (dest->Value & ~WR_NATIVE);
-    SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(object);
-  }
+  if (dest == src)
+    return;
+  releaseWeakSideTableEntry(dest);
   swift_weakCopyInit(dest, src);
 }
 
 void swift::swift_weakTakeAssign(WeakReference *dest, WeakReference *src) {
-  if (dest->Value) {
-    auto object = (HeapObject*) (dest->Value & ~WR_NATIVE);
-    SWIFT_RT_ENTRY_CALL(swift_unownedRelease)(object);
-  }
+  if (dest == src)
+    return;
+  releaseWeakSideTableEntry(dest);
   swift_weakTakeInit(dest, src);
 }
 
@@ -22,6 +22,7 @@
 #include "swift/Runtime/HeapObject.h"
 #include "swift/Runtime/Metadata.h"
 #include "swift/Runtime/Mutex.h"
+#include "swift/Runtime/Statistics.h"
 #include "swift/Strings.h"
 #include "MetadataCache.h"
 #include <algorithm>
@@ -235,6 +236,9 @@ swift::swift_getGenericMetadata(GenericMetadata *pattern,
 
   auto entry = getCache(pattern).findOrAdd(genericArgs, numGenericArgs,
     [&]() -> GenericCacheEntry* {
+      RuntimeStatisticTimer timer(
+        RuntimeStatistic::GenericMetadataInstantiation);
+
       // Create new metadata to cache.
       auto metadata = pattern->CreateFunction(pattern, arguments);
       auto entry = GenericCacheEntry::getFromMetadata(pattern, metadata);
@@ -245,6 +249,28 @@ swift::swift_getGenericMetadata(GenericMetadata *pattern,
   return entry->Value;
 }
 
+const Metadata *
+swift::swift_getPrespecializedGenericMetadata(GenericMetadata *pattern,
+                                              const void *arguments,
+                                              const Metadata *candidate) {
+  auto genericArgs = (const void * const *) arguments;
+  size_t numGenericArgs = pattern->NumKeyArguments;
+
+  auto &cache = getCache(pattern);
+  auto entry = cache.findOrAdd(genericArgs, numGenericArgs,
+    [&]() -> GenericCacheEntry* {
+      // The compiler already instantiated the metadata, so the entry
+      // doesn't need any payload.
+      auto entry = GenericCacheEntry::allocate(cache.getAllocator(),
+                                               genericArgs, numGenericArgs,
+                                               /*payloadSize*/ 0);
+      entry->Value = candidate;
+      return entry;
+    });
+
+  return entry->Value;
+}
+
 /***************************************************************************/
 /*** Objective-C class wrappers ********************************************/
 /***************************************************************************/
@@ -329,6 +355,13 @@ public:
     const void * const *getArguments() const {
       return &FlagsArgsAndResult[1];
     }
+
+    friend llvm::hash_code hash_value(const Key &key) {
+      auto flags = key.getFlags();
+      return llvm::hash_combine(flags.getIntValue(), key.getResult(),
+                                llvm::hash_combine_range(key.getArguments(),
+                                  key.getArguments() + flags.getNumArguments()));
+    }
   };
 
   FunctionCacheEntry(Key key);
@@ -480,6 +513,14 @@ public:
     size_t NumElements;
     const Metadata * const *Elements;
     const char *Labels;
+
+    friend llvm::hash_code hash_value(const Key &key) {
+      // Labels compare by content, so they must hash by content.
+      return llvm::hash_combine(
+        llvm::hash_combine_range(key.Elements, key.Elements + key.NumElements),
+        key.Labels ? llvm::hash_value(llvm::StringRef(key.Labels))
+                   : llvm::hash_code(0));
+    }
   };
 
   TupleCacheEntry(const Key &key, const ValueWitnessTable *proposedWitnesses);
@@ -1978,6 +2019,11 @@ public:
   struct Key {
     size_t NumProtocols;
     const ProtocolDescriptor * const *Protocols;
+
+    friend llvm::hash_code hash_value(const Key &key) {
+      return llvm::hash_combine_range(key.Protocols,
+                                      key.Protocols + key.NumProtocols);
+    }
   };
 
   ExistentialCacheEntry(Key key);
@@ -2665,16 +2711,26 @@ namespace {
 using GenericWitnessTableCache = MetadataCache<WitnessTableCacheEntry>;
 using LazyGenericWitnessTableCache = Lazy<GenericWitnessTableCache>;
 
-/// Fetch the cache for a generic witness-table structure.
-static GenericWitnessTableCache &getCache(GenericWitnessTable *gen) {
+namespace {
+  /// The runtime's view of the private data of a generic witness table.
+  struct GenericWitnessTablePrivateData {
+    /// The entry most recently returned for this witness table. It's checked
+    /// before the cache, so repeated requests for the same conforming type
+    /// need neither the lazy initialization check nor a hash lookup.
+    std::atomic<const WitnessTableCacheEntry *> MostRecentEntry;
+
+    LazyGenericWitnessTableCache Cache;
+  };
+}
+
+static GenericWitnessTablePrivateData &
+getPrivateData(GenericWitnessTable *gen) {
   // Keep this assert even if you change the representation above.
-  static_assert(sizeof(LazyGenericWitnessTableCache) <=
+  static_assert(sizeof(GenericWitnessTablePrivateData) <=
                 sizeof(GenericWitnessTable::PrivateData),
                 "metadata cache is larger than the allowed space");
 
-  auto lazyCache =
-    reinterpret_cast<LazyGenericWitnessTableCache*>(gen->PrivateData);
-  return lazyCache->get();
+  return *reinterpret_cast<GenericWitnessTablePrivateData*>(gen->PrivateData);
 }
 
 /// If there's no initializer, no private storage, and all requirements
@@ -2770,12 +2826,18 @@ swift::swift_getGenericWitnessTable(GenericWitnessTable *genericTable,
     return genericTable->Pattern;
   }
 
+  // Most call sites ask for the same conforming type over and over.
+  auto &privateData = getPrivateData(genericTable);
+  auto mostRecent = privateData.MostRecentEntry.load(std::memory_order_acquire);
+  if (mostRecent && mostRecent->getArgumentsBuffer()[0] == type)
+    return mostRecent->get(genericTable);
+
   // If type is not nullptr, the witness table depends on the substituted
   // conforming type, so use that are the key.
   constexpr const size_t numGenericArgs = 1;
   const void *args[] = { type };
 
-  auto &cache = getCache(genericTable);
+  auto &cache = privateData.Cache.get();
   auto entry = cache.findOrAdd(args, numGenericArgs,
     [&]() -> WitnessTableCacheEntry* {
       // Allocate the witness table and fill it in.
@@ -2793,7 +2855,125 @@ swift::swift_getGenericWitnessTable(GenericWitnessTable *genericTable,
       return entry;
     });
 
+  privateData.MostRecentEntry.store(entry, std::memory_order_release);
   return entry->get(genericTable);
 }
 
+/***************************************************************************/
+/*** Allocator implementation **********************************************/
+/***************************************************************************/
+
+namespace {
+  /// A slab of memory for small metadata allocations.  The header lives at
+  /// the start of the slab; allocations follow it.
+  struct MetadataSlab {
+    std::atomic<uintptr_t> Next;
+    uintptr_t End;
+  };
+}
+
+/// The size of a metadata slab.  This is a multiple of the page size on
+/// every platform we support.
+static constexpr size_t MetadataSlabSize = 256 * 1024;
+
+/// Allocations larger than this get pages of their own rather than
+/// leaving a large unused tail in the current slab.
+static constexpr size_t MaxSlabAllocationSize = MetadataSlabSize / 4;
+
+/// The slab that small allocations are currently carved from.
+static std::atomic<MetadataSlab *> CurrentMetadataSlab{nullptr};
+
+static std::atomic<size_t> NumMetadataSlabs{0};
+static std::atomic<size_t> MetadataSlabBytesUsed{0};
+static std::atomic<size_t> NumLargeMetadataAllocations{0};
+static std::atomic<size_t> LargeMetadataAllocationBytes{0};
+
+static void *allocateMetadataPages(size_t size) {
+#if defined(_MSC_VER)
+  void *pages = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT,
+                             PAGE_READWRITE);
+  if (!pages)
+    fatalError(/* flags = */ 0, "failed to allocate %zu bytes for "
+               "metadata\n", size);
+#else
+  void *pages = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANON, VM_TAG_FOR_SWIFT_METADATA, 0);
+  if (pages == MAP_FAILED)
+    fatalError(/* flags = */ 0, "failed to allocate %zu bytes for "
+               "metadata\n", size);
+#endif
+  return pages;
+}
+
+static void freeMetadataPages(void *pages, size_t size) {
+#if defined(_MSC_VER)
+  VirtualFree(pages, 0, MEM_RELEASE);
+#else
+  munmap(pages, size);
+#endif
+}
+
+void *MetadataAllocator::Allocate(size_t size, size_t alignment) {
+  assert(llvm::isPowerOf2_64(alignment) && "alignment is not a power of 2");
+
+  // Keep every allocation pointer-aligned, and reserve enough slop to
+  // realign the result if more than that was requested.
+  if (alignment < alignof(void*))
+    alignment = alignof(void*);
+  size = llvm::alignTo(size, alignof(void*));
+  size_t reservedSize = size + (alignment - alignof(void*));
+
+  if (reservedSize > MaxSlabAllocationSize) {
+    NumLargeMetadataAllocations.fetch_add(1, std::memory_order_relaxed);
+    LargeMetadataAllocationBytes.fetch_add(reservedSize,
+                                           std::memory_order_relaxed);
+    // Pages are aligned well beyond anything metadata requires.
+    return allocateMetadataPages(reservedSize);
+  }
+
+  MetadataSlab *slab = CurrentMetadataSlab.load(std::memory_order_acquire);
+  while (true) {
+    if (slab) {
+      // Claim a range of the current slab.  If it doesn't fit, the slab is
+      // exhausted; its tail is simply never used.
+      uintptr_t begin = slab->Next.fetch_add(reservedSize,
+                                             std::memory_order_relaxed);
+      if (begin + reservedSize <= slab->End) {
+        MetadataSlabBytesUsed.fetch_add(reservedSize,
+                                        std::memory_order_relaxed);
+        return reinterpret_cast<void*>(llvm::alignTo(begin, alignment));
+      }
+    }
+
+    // Install a fresh slab.  If another thread beats us to it, use theirs
+    // and give ours back.
+    auto newSlab = new (allocateMetadataPages(MetadataSlabSize)) MetadataSlab;
+    auto slabBegin = reinterpret_cast<uintptr_t>(newSlab);
+    newSlab->Next.store(slabBegin + sizeof(MetadataSlab),
+                        std::memory_order_relaxed);
+    newSlab->End = slabBegin + MetadataSlabSize;
+
+    if (CurrentMetadataSlab.compare_exchange_strong(slab, newSlab,
+                                                   std::memory_order_acq_rel,
+                                                   std::memory_order_acquire)) {
+      NumMetadataSlabs.fetch_add(1, std::memory_order_relaxed);
+      slab = newSlab;
+    } else {
+      freeMetadataPages(newSlab, MetadataSlabSize);
+    }
+  }
+}
+
+void swift::swift_getMetadataAllocationStatistics(
+                                        MetadataAllocationStatistics *stats) {
+  stats->NumSlabs = NumMetadataSlabs.load(std::memory_order_relaxed);
+  stats->SlabBytes = stats->NumSlabs * MetadataSlabSize;
+  stats->SlabBytesUsed =
+    MetadataSlabBytesUsed.load(std::memory_order_relaxed);
+  stats->NumLargeAllocations =
+    NumLargeMetadataAllocations.load(std::memory_order_relaxed);
+  stats->LargeAllocationBytes =
+    LargeMetadataAllocationBytes.load(std::memory_order_relaxed);
+}
+
 uint64_t swift::RelativeDirectPointerNullPtr = 0;
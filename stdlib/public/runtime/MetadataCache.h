@@ -26,11 +26,31 @@
 
 namespace swift {
 
-// For now, use malloc and free as our standard allocator for
-// metadata caches.  It might make sense in the future to take
-// advantage of the fact that we know that most allocations here
-// won't ever be deallocated.
-using MetadataAllocator = llvm::MallocAllocator;
+/// The allocator used for metadata and metadata caches.
+///
+/// Metadata is never deallocated, so this hands out memory by bumping a
+/// pointer through large, page-aligned slabs that are shared by the whole
+/// process.  Allocation is lock-free; racing threads claim disjoint ranges
+/// of the current slab with an atomic add, and the thread that exhausts a
+/// slab installs the next one.  Allocations too large to share a slab get
+/// pages of their own.
+///
+/// The allocator is stateless, so it adds nothing to the size of the
+/// caches that embed it.
+class MetadataAllocator : public llvm::AllocatorBase<MetadataAllocator> {
+public:
+  void Reset() {}
+
+  LLVM_ATTRIBUTE_RETURNS_NONNULL void *Allocate(size_t size, size_t alignment);
+  using AllocatorBase<MetadataAllocator>::Allocate;
+
+  /// Metadata memory is never returned to the system; this only exists to
+  /// satisfy the allocator interface.
+  void Deallocate(const void *ptr, size_t size) {}
+  using AllocatorBase<MetadataAllocator>::Deallocate;
+
+  void PrintStats() const {}
+};
 
 /// A typedef for simple global caches.
 template <class EntryTy>
@@ -176,6 +196,10 @@ template <class ValueTy> class MetadataCache {
     KeyDataRef KeyData;
 
     Key(KeyDataRef data) : Hash(data.hash()), KeyData(data) {}
+
+    friend llvm::hash_code hash_value(const Key &key) {
+      return key.Hash;
+    }
   };
 
   /// The layout of an entry in the concurrent map.
@@ -107,6 +107,14 @@ struct TypeMetadataState {
   std::vector<TypeMetadataSection> SectionsToScan;
   Mutex SectionsToScanLock;
 
+  /// The number of sections in SectionsToScan, which lookups read without
+  /// taking SectionsToScanLock.
+  std::atomic<size_t> NumSections{0};
+
+  /// The records of SectionsToScan by type name, built by the first lookup
+  /// after sections were added.
+  TypeNameIndex RecordsByName;
+
   TypeMetadataState() {
     SectionsToScan.reserve(16);
 #if defined(__APPLE__) && defined(__MACH__)
@@ -128,6 +136,7 @@ _registerTypeMetadataRecords(TypeMetadataState &T,
                              const TypeMetadataRecord *end) {
   ScopedLock guard(T.SectionsToScanLock);
   T.SectionsToScan.push_back(TypeMetadataSection{begin, end});
+  T.NumSections.store(T.SectionsToScan.size(), std::memory_order_release);
 }
 
 static void _addImageTypeMetadataRecordsBlock(const uint8_t *records,
@@ -228,26 +237,16 @@ swift::_matchMetadataByMangledTypeName(const llvm::StringRef typeName,
 
 // returns the type metadata for the type named by typeName
 static const Metadata *
-_searchTypeMetadataRecords(const TypeMetadataState &T,
+_searchTypeMetadataRecords(TypeMetadataState &T,
                            const llvm::StringRef typeName) {
-  unsigned sectionIdx = 0;
-  unsigned endSectionIdx = T.SectionsToScan.size();
-  const Metadata *foundMetadata = nullptr;
-
-  for (; sectionIdx < endSectionIdx; ++sectionIdx) {
-    auto &section = T.SectionsToScan[sectionIdx];
-    for (const auto &record : section) {
-      if (auto metadata = record.getCanonicalTypeMetadata())
-        foundMetadata = _matchMetadataByMangledTypeName(typeName, metadata, nullptr);
-      else if (auto ntd = record.getNominalTypeDescriptor())
-        foundMetadata = _matchMetadataByMangledTypeName(typeName, nullptr, ntd);
-
-      if (foundMetadata != nullptr)
-        return foundMetadata;
-    }
+  // Only index the sections added since the last lookup.
+  if (T.RecordsByName.getNumIndexedSections() !=
+        T.NumSections.load(std::memory_order_acquire)) {
+    ScopedLock guard(T.SectionsToScanLock);
+    T.RecordsByName.addSections(T.SectionsToScan);
   }
 
-  return nullptr;
+  return T.RecordsByName.lookup(typeName);
 }
 
 static const Metadata *
@@ -261,9 +260,7 @@ _typeByMangledName(const llvm::StringRef typeName) {
     return Value->getMetadata();
 
   // Check type metadata records
-  T.SectionsToScanLock.withLock([&] {
-    foundMetadata = _searchTypeMetadataRecords(T, typeName);
-  });
+  foundMetadata = _searchTypeMetadataRecords(T, typeName);
 
   // Check protocol conformances table. Note that this has no support for
   // resolving generic types yet.
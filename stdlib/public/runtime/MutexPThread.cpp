@@ -20,6 +20,7 @@
 
 #include "swift/Runtime/Debug.h"
 #include <errno.h>
+#include <stdint.h>
 #include <stdlib.h>
 
 using namespace swift;
@@ -63,6 +64,15 @@ static const char *errorName(int errorcode) {
   }
 }
 
+/// Tells the processor that the thread is spin-waiting.
+static inline void spinPause() {
+#if defined(__i386__) || defined(__x86_64__)
+  __builtin_ia32_pause();
+#elif defined(__arm__) || defined(__aarch64__)
+  asm volatile("yield");
+#endif
+}
+
 void ConditionPlatformHelper::init(pthread_cond_t &condition) {
   reportError(pthread_cond_init(&condition, nullptr));
 }
@@ -98,6 +108,21 @@ void MutexPlatformHelper::destroy(pthread_mutex_t &mutex) {
 }
 
 void MutexPlatformHelper::lock(pthread_mutex_t &mutex) {
+  // The runtime's critical sections are short, so the owner of a locked
+  // mutex usually releases it within a few hundred cycles. Parking in the
+  // kernel costs a context switch on both sides, so spin for a while first,
+  // backing off exponentially to keep the cache line of the mutex quiet.
+  enum { MaxSpinRounds = 8 };
+  for (unsigned round = 0; round != MaxSpinRounds; ++round) {
+    int errorcode = pthread_mutex_trylock(&mutex);
+    if (errorcode == 0)
+      return;
+    // Let pthread_mutex_lock report any other error.
+    if (errorcode != EBUSY)
+      break;
+    for (unsigned pause = 0; pause != 1u << round; ++pause)
+      spinPause();
+  }
   reportError(pthread_mutex_lock(&mutex));
 }
 
@@ -110,37 +135,120 @@ bool MutexPlatformHelper::try_lock(pthread_mutex_t &mutex) {
                           /* returnFalseOnEBUSY = */ true);
 }
 
-void ReadWriteLockPlatformHelper::init(pthread_rwlock_t &rwlock) {
-  reportError(pthread_rwlock_init(&rwlock, nullptr));
-}
-
-void ReadWriteLockPlatformHelper::destroy(pthread_rwlock_t &rwlock) {
-  reportError(pthread_rwlock_destroy(&rwlock));
-}
-
-void ReadWriteLockPlatformHelper::readLock(pthread_rwlock_t &rwlock) {
-  reportError(pthread_rwlock_rdlock(&rwlock));
-}
-
-bool ReadWriteLockPlatformHelper::try_readLock(pthread_rwlock_t &rwlock) {
-  returnTrueOrReportError(pthread_rwlock_tryrdlock(&rwlock),
-                          /* returnFalseOnEBUSY = */ true);
-}
-
-void ReadWriteLockPlatformHelper::writeLock(pthread_rwlock_t &rwlock) {
-  reportError(pthread_rwlock_wrlock(&rwlock));
+/// Returns the reader indicator of the calling thread. A thread always picks
+/// the same one, so that readUnlock decrements the indicator which readLock
+/// incremented.
+static unsigned &readerIndicator(ReadWriteLockHandle &rwlock) {
+  // Fibonacci hashing: thread descriptors are often a stack size apart, and
+  // the top bits of the product depend on all the bits of the id.
+  uint64_t id = (uint64_t)(uintptr_t)pthread_self();
+  uint64_t hash = id * 0x9E3779B97F4A7C15ull;
+  static_assert(ReadWriteLockHandle::NumReaderIndicators == 16,
+                "the hash is shifted for 16 indicators");
+  return rwlock.Readers[hash >> 60].Value;
+}
+
+static bool isWriterActive(ReadWriteLockHandle &rwlock) {
+  return __atomic_load_n(&rwlock.Writer.Value, __ATOMIC_SEQ_CST) != 0;
+}
+
+static bool hasReaders(ReadWriteLockHandle &rwlock) {
+  for (auto &readers : rwlock.Readers)
+    if (__atomic_load_n(&readers.Value, __ATOMIC_SEQ_CST) != 0)
+      return true;
+  return false;
+}
+
+/// Removes a reader from \p readers, and wakes up the writer if it is
+/// waiting for the readers to drain.
+///
+/// A reader increments its indicator before it checks the writer flag, and a
+/// writer raises the flag before it checks the indicators, all sequentially
+/// consistent. So either the reader sees the writer and backs off, or the
+/// writer sees the reader and waits for it.
+static void removeReader(ReadWriteLockHandle &rwlock, unsigned &readers) {
+  __atomic_fetch_sub(&readers, 1, __ATOMIC_SEQ_CST);
+  if (!isWriterActive(rwlock))
+    return;
+  MutexPlatformHelper::lock(rwlock.Mutex);
+  ConditionPlatformHelper::notifyAll(rwlock.Changed);
+  MutexPlatformHelper::unlock(rwlock.Mutex);
+}
+
+void ReadWriteLockPlatformHelper::init(ReadWriteLockHandle &rwlock) {
+  rwlock.Writer.Value = 0;
+  for (auto &readers : rwlock.Readers)
+    readers.Value = 0;
+  MutexPlatformHelper::init(rwlock.Mutex);
+  ConditionPlatformHelper::init(rwlock.Changed);
+}
+
+void ReadWriteLockPlatformHelper::destroy(ReadWriteLockHandle &rwlock) {
+  ConditionPlatformHelper::destroy(rwlock.Changed);
+  MutexPlatformHelper::destroy(rwlock.Mutex);
+}
+
+void ReadWriteLockPlatformHelper::readLock(ReadWriteLockHandle &rwlock) {
+  unsigned &readers = readerIndicator(rwlock);
+  while (true) {
+    __atomic_fetch_add(&readers, 1, __ATOMIC_SEQ_CST);
+    if (!isWriterActive(rwlock))
+      return;
+
+    // Back off, so that a stream of readers doesn't starve the writer, and
+    // wait for the writer to be done.
+    removeReader(rwlock, readers);
+    MutexPlatformHelper::lock(rwlock.Mutex);
+    while (isWriterActive(rwlock))
+      ConditionPlatformHelper::wait(rwlock.Changed, rwlock.Mutex);
+    MutexPlatformHelper::unlock(rwlock.Mutex);
+  }
 }
 
-bool ReadWriteLockPlatformHelper::try_writeLock(pthread_rwlock_t &rwlock) {
-  returnTrueOrReportError(pthread_rwlock_trywrlock(&rwlock),
-                          /* returnFalseOnEBUSY = */ true);
+bool ReadWriteLockPlatformHelper::try_readLock(ReadWriteLockHandle &rwlock) {
+  unsigned &readers = readerIndicator(rwlock);
+  __atomic_fetch_add(&readers, 1, __ATOMIC_SEQ_CST);
+  if (!isWriterActive(rwlock))
+    return true;
+  removeReader(rwlock, readers);
+  return false;
+}
+
+void ReadWriteLockPlatformHelper::writeLock(ReadWriteLockHandle &rwlock) {
+  MutexPlatformHelper::lock(rwlock.Mutex);
+  while (isWriterActive(rwlock))
+    ConditionPlatformHelper::wait(rwlock.Changed, rwlock.Mutex);
+  __atomic_store_n(&rwlock.Writer.Value, 1, __ATOMIC_SEQ_CST);
+  while (hasReaders(rwlock))
+    ConditionPlatformHelper::wait(rwlock.Changed, rwlock.Mutex);
+  MutexPlatformHelper::unlock(rwlock.Mutex);
+}
+
+bool ReadWriteLockPlatformHelper::try_writeLock(ReadWriteLockHandle &rwlock) {
+  if (!MutexPlatformHelper::try_lock(rwlock.Mutex))
+    return false;
+  bool acquired = false;
+  if (!isWriterActive(rwlock)) {
+    __atomic_store_n(&rwlock.Writer.Value, 1, __ATOMIC_SEQ_CST);
+    acquired = !hasReaders(rwlock);
+    if (!acquired) {
+      // Let in the readers which saw the flag in the meantime.
+      __atomic_store_n(&rwlock.Writer.Value, 0, __ATOMIC_SEQ_CST);
+      ConditionPlatformHelper::notifyAll(rwlock.Changed);
+    }
+  }
+  MutexPlatformHelper::unlock(rwlock.Mutex);
+  return acquired;
 }
 
-void ReadWriteLockPlatformHelper::readUnlock(pthread_rwlock_t &rwlock) {
-  reportError(pthread_rwlock_unlock(&rwlock));
+void ReadWriteLockPlatformHelper::readUnlock(ReadWriteLockHandle &rwlock) {
+  removeReader(rwlock, readerIndicator(rwlock));
 }
 
-void ReadWriteLockPlatformHelper::writeUnlock(pthread_rwlock_t &rwlock) {
-  reportError(pthread_rwlock_unlock(&rwlock));
+void ReadWriteLockPlatformHelper::writeUnlock(ReadWriteLockHandle &rwlock) {
+  MutexPlatformHelper::lock(rwlock.Mutex);
+  __atomic_store_n(&rwlock.Writer.Value, 0, __ATOMIC_SEQ_CST);
+  ConditionPlatformHelper::notifyAll(rwlock.Changed);
+  MutexPlatformHelper::unlock(rwlock.Mutex);
 }
 #endif
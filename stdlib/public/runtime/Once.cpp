@@ -17,6 +17,8 @@
 #include "Private.h"
 #include "swift/Runtime/Once.h"
 #include "swift/Runtime/Debug.h"
+#include "swift/Runtime/Mutex.h"
+#include <atomic>
 #include <type_traits>
 
 using namespace swift;
@@ -35,6 +37,41 @@ static_assert(std::is_same<swift_once_t, dispatch_once_t>::value,
 static_assert(sizeof(swift_once_t) <= sizeof(void*),
               "swift_once_t must be no larger than the platform word");
 
+#if !defined(__APPLE__) && !defined(__CYGWIN__)
+
+static_assert(sizeof(std::atomic<swift_once_t>) == sizeof(swift_once_t),
+              "swift_once_t must be usable as an atomic");
+
+enum : swift_once_t {
+  OnceNotStarted = 0,
+  OnceRunning = 1,
+  OnceDone = ~swift_once_t(0)
+};
+
+// Threads that find an initialization in progress wait for it on a single
+// condition, since contention on a predicate only happens during startup.
+static StaticMutex OnceMutex;
+static StaticConditionVariable OnceCondition;
+
+static void swift_once_slow(std::atomic<swift_once_t> *state,
+                            void (*fn)(void *)) {
+  swift_once_t expected = OnceNotStarted;
+  if (state->compare_exchange_strong(expected, OnceRunning,
+                                     std::memory_order_acquire)) {
+    fn(nullptr);
+    OnceMutex.withLockThenNotifyAll(OnceCondition, [&] {
+      state->store(OnceDone, std::memory_order_release);
+    });
+    return;
+  }
+
+  OnceMutex.withLockOrWait(OnceCondition, [&] {
+    return state->load(std::memory_order_acquire) == OnceDone;
+  });
+}
+
+#endif
+
 /// Runs the given function with the given context argument exactly once.
 /// The predicate argument must point to a global or static variable of static
 /// extent of type swift_once_t.
@@ -44,14 +81,11 @@ void swift::swift_once(swift_once_t *predicate, void (*fn)(void *)) {
 #elif defined(__CYGWIN__)
   _swift_once_f(predicate, nullptr, fn);
 #else
-  // FIXME: We're relying here on the coincidence that libstdc++ uses pthread's
-  // pthread_once, and that on glibc pthread_once follows a compatible init
-  // process (the token is a word that is atomically incremented from 0 to
-  // 1 to 2 during initialization) to work. We should implement our own version
-  // that we can rely on to continue to work that way.
-  // The MSVC port also relies on this, because the std::call_once on MSVC
-  // follows the compatible init process.
-  // For more information, see rdar://problem/18499385
-  std::call_once(*predicate, [fn]() { fn(nullptr); });
+  // The compiler emits this check inline as well, so this usually only runs
+  // before the initialization has finished.
+  auto state = reinterpret_cast<std::atomic<swift_once_t> *>(predicate);
+  if (LLVM_LIKELY(state->load(std::memory_order_acquire) == OnceDone))
+    return;
+  swift_once_slow(state, fn);
 #endif
 }
@@ -18,9 +18,11 @@
 #define SWIFT_RUNTIME_PRIVATE_H
 
 #include "swift/Basic/Demangle.h"
+#include "swift/Runtime/Concurrent.h"
 #include "swift/Runtime/Config.h"
 #include "swift/Runtime/Metadata.h"
 #include "llvm/Support/Compiler.h"
+#include <atomic>
 
 // Opaque ISAs need to use object_getClass which is in runtime.h
 #if SWIFT_HAS_OPAQUE_ISAS
@@ -156,6 +158,80 @@ namespace swift {
   const Metadata *
   _searchConformancesByMangledTypeName(const llvm::StringRef typeName);
 
+  /// An index from the mangled names of nominal types to the first
+  /// registered record which can produce their metadata. Lookups read it
+  /// without taking a lock.
+  class TypeNameIndex {
+    struct Entry {
+      llvm::StringRef Name;
+      const Metadata *TypeMetadata;
+      const NominalTypeDescriptor *Description;
+
+      Entry(llvm::StringRef name, const Metadata *metadata,
+            const NominalTypeDescriptor *description)
+        : Name(name), TypeMetadata(metadata), Description(description) {}
+
+      int compareWithKey(llvm::StringRef name) const {
+        return name.compare(Name);
+      }
+
+      template <class... T>
+      static size_t getExtraAllocationSize(T &&... ignored) {
+        return 0;
+      }
+    };
+
+    ConcurrentMap<Entry> Entries;
+
+    /// The number of sections whose records are in Entries.
+    std::atomic<size_t> NumIndexedSections{0};
+
+    template <class Record>
+    void addRecord(const Record &record) {
+      const Metadata *metadata = record.getCanonicalTypeMetadata();
+      const NominalTypeDescriptor *ntd;
+      if (metadata) {
+        ntd = metadata->getNominalTypeDescriptor();
+      } else {
+        // Without metadata, only the accessor of a non-generic type can
+        // produce it.
+        ntd = record.getNominalTypeDescriptor();
+        if (ntd && (ntd->GenericParams.isGeneric() ||
+                    !ntd->getAccessFunction()))
+          return;
+      }
+      if (ntd)
+        Entries.getOrInsert(llvm::StringRef(ntd->Name.get()), metadata,
+                            metadata ? nullptr : ntd);
+    }
+
+  public:
+    size_t getNumIndexedSections() const {
+      return NumIndexedSections.load(std::memory_order_acquire);
+    }
+
+    /// Indexes the records of the sections which aren't indexed yet. The
+    /// caller must hold the lock guarding \p sections.
+    template <class SectionList>
+    void addSections(const SectionList &sections) {
+      size_t numSections = sections.size();
+      for (size_t i = getNumIndexedSections(); i < numSections; ++i)
+        for (const auto &record : sections[i])
+          addRecord(record);
+      NumIndexedSections.store(numSections, std::memory_order_release);
+    }
+
+    /// Returns the metadata of the type with the given mangled name, or null
+    /// if no indexed record can produce it.
+    const Metadata *lookup(llvm::StringRef typeName) {
+      auto entry = Entries.find(typeName);
+      if (!entry)
+        return nullptr;
+      return _matchMetadataByMangledTypeName(typeName, entry->TypeMetadata,
+                                             entry->Description);
+    }
+  };
+
 #if SWIFT_OBJC_INTEROP
   Demangle::NodePointer _swift_buildDemanglingForMetadata(const Metadata *type);
 #endif
@@ -19,7 +19,9 @@
 #include "swift/Runtime/Concurrent.h"
 #include "swift/Runtime/Metadata.h"
 #include "swift/Runtime/Mutex.h"
+#include "swift/Runtime/Statistics.h"
 #include "Private.h"
+#include <algorithm>
 
 #if defined(__APPLE__) && defined(__MACH__)
 #include <mach-o/dyld.h>
@@ -148,10 +150,14 @@ const {
 
 #if defined(__APPLE__) && defined(__MACH__)
 #define SWIFT_PROTOCOL_CONFORMANCES_SECTION "__swift2_proto"
+#define SWIFT_PROTOCOL_CONFORMANCE_INDEX_SECTION "__swift2_protidx"
 #elif defined(__ELF__)
 #define SWIFT_PROTOCOL_CONFORMANCES_SECTION ".swift2_protocol_conformances_start"
+#define SWIFT_PROTOCOL_CONFORMANCE_INDEX_SECTION \
+  ".swift2_protocol_conformance_index_start"
 #elif defined(__CYGWIN__) || defined(_MSC_VER)
 #define SWIFT_PROTOCOL_CONFORMANCES_SECTION ".sw2prtc"
+#define SWIFT_PROTOCOL_CONFORMANCE_INDEX_SECTION ".sw2prti"
 #endif
 
 namespace {
@@ -172,6 +178,10 @@ namespace {
 
     ConformanceCacheKey(const void *type, const ProtocolDescriptor *proto)
       : Type(type), Proto(proto) {}
+
+    friend llvm::hash_code hash_value(const ConformanceCacheKey &key) {
+      return llvm::hash_combine(key.Type, key.Proto);
+    }
   };
 
   struct ConformanceCacheEntry {
@@ -229,6 +239,42 @@ namespace {
       return FailureGeneration.load(std::memory_order_relaxed);
     }
   };
+
+  /// A run of adjacent conformance records to the same protocol, along with
+  /// the index of the section they were registered in.
+  struct IndexedConformanceRun {
+    const ProtocolConformanceRecord *Begin, *End;
+    size_t SectionIndex;
+
+    const ProtocolConformanceRecord *begin() const {
+      return Begin;
+    }
+    const ProtocolConformanceRecord *end() const {
+      return End;
+    }
+  };
+
+  /// The conformance records for one protocol, across all registered
+  /// sections.  Runs are prepended as sections are registered, so the
+  /// list is ordered newest section first.
+  struct ConformanceIndexEntry {
+  private:
+    const ProtocolDescriptor *Proto;
+
+  public:
+    ConcurrentList<IndexedConformanceRun> Runs;
+
+    ConformanceIndexEntry(const ProtocolDescriptor *proto) : Proto(proto) {}
+
+    int compareWithKey(const ProtocolDescriptor *proto) const {
+      return comparePointers(proto, Proto);
+    }
+
+    template <class... Args>
+    static size_t getExtraAllocationSize(Args &&... ignored) {
+      return 0;
+    }
+  };
 }
 
 // Conformance Cache.
@@ -242,22 +288,42 @@ namespace swift {
 }
 
 static void _addImageProtocolConformancesBlock(const uint8_t *conformances,
-                                               size_t conformancesSize);
+                                               size_t conformancesSize,
+                                               const uint8_t *index,
+                                               size_t indexSize);
+
+static void _initializeCallbacksToInspectDylib(
+  void (*fnAddImageIndexedBlock)(const uint8_t *, size_t,
+                                 const uint8_t *, size_t),
+  const char *sectionName, const char *indexSectionName);
 #endif
 
 struct ConformanceState {
   ConcurrentMap<ConformanceCacheEntry> Cache;
   std::vector<ConformanceSection> SectionsToScan;
   Mutex SectionsToScanLock;
+
+  /// The registered conformance records, grouped by protocol.  Lookups
+  /// read this without taking SectionsToScanLock.
+  ConcurrentMap<ConformanceIndexEntry> RecordsByProtocol;
+
+  /// The number of sections whose records are all in RecordsByProtocol.
+  /// This is the generation number recorded by cached failures.
+  std::atomic<size_t> NumIndexedSections{0};
+
+  /// The records of SectionsToScan by conforming type name, built by the
+  /// first lookup by name after sections were added.
+  TypeNameIndex RecordsByTypeName;
   
   ConformanceState() {
     SectionsToScan.reserve(16);
 #if defined(__APPLE__) && defined(__MACH__)
     _initializeCallbacksToInspectDylib();
 #else
-    _swift_initializeCallbacksToInspectDylib(
+    _initializeCallbacksToInspectDylib(
       _addImageProtocolConformancesBlock,
-      SWIFT_PROTOCOL_CONFORMANCES_SECTION);
+      SWIFT_PROTOCOL_CONFORMANCES_SECTION,
+      SWIFT_PROTOCOL_CONFORMANCE_INDEX_SECTION);
 #endif
   }
 
@@ -272,14 +338,15 @@ struct ConformanceState {
     }
   }
 
-  void cacheFailure(const void *type, const ProtocolDescriptor *proto) {
-    uintptr_t failureGeneration = SectionsToScan.size();
+  void cacheFailure(const void *type, const ProtocolDescriptor *proto,
+                    uintptr_t failureGeneration) {
     auto result = Cache.getOrInsert(ConformanceCacheKey(type, proto),
                                     (const WitnessTable *) nullptr,
                                     failureGeneration);
 
-    // If the entry was already present, we may need to update it.
-    if (!result.second) {
+    // If the entry was already present, we may need to update it, unless
+    // another thread has found a conformance in the meantime.
+    if (!result.second && !result.first->isSuccessful()) {
       result.first->updateFailureGeneration(failureGeneration);
     }
   }
@@ -292,18 +359,76 @@ struct ConformanceState {
 
 static Lazy<ConformanceState> Conformances;
 
+/// Check that a compiler-emitted conformance index describes exactly the
+/// records in [begin, end), one protocol per run.  An image may mix objects
+/// that do and don't have an index, in which case we can't use it.
+static bool
+isValidConformanceIndex(const ProtocolConformanceRecord *begin,
+                        const ProtocolConformanceRecord *end,
+                        const ProtocolConformanceIndexEntry *indexBegin,
+                        const ProtocolConformanceIndexEntry *indexEnd) {
+  size_t numIndexedRecords = 0;
+  for (auto entry = indexBegin; entry != indexEnd; ++entry) {
+    if (entry->size() == 0 || entry->begin() < begin || entry->end() > end)
+      return false;
+    numIndexedRecords += entry->size();
+  }
+  return numIndexedRecords == size_t(end - begin);
+}
+
 static void
 _registerProtocolConformances(ConformanceState &C,
                               const ProtocolConformanceRecord *begin,
-                              const ProtocolConformanceRecord *end) {
+                              const ProtocolConformanceRecord *end,
+                              const ProtocolConformanceIndexEntry *indexBegin
+                                = nullptr,
+                              const ProtocolConformanceIndexEntry *indexEnd
+                                = nullptr) {
   ScopedLock guard(C.SectionsToScanLock);
+  size_t sectionIndex = C.SectionsToScan.size();
   C.SectionsToScan.push_back(ConformanceSection{begin, end});
+
+  // Index the new records by protocol.  This only reads the records, so it
+  // is safe to do from an image-load callback.
+  auto addRun = [&](const ProtocolConformanceRecord *runBegin,
+                    const ProtocolConformanceRecord *runEnd) {
+    auto entry =
+      C.RecordsByProtocol.getOrInsert(runBegin->getProtocol()).first;
+    entry->Runs.push_front(
+      IndexedConformanceRun{runBegin, runEnd, sectionIndex});
+  };
+
+  if (indexBegin != indexEnd &&
+      isValidConformanceIndex(begin, end, indexBegin, indexEnd)) {
+    // The compiler already grouped the records by protocol, so we only
+    // need to visit the first record of each group.
+    for (auto entry = indexBegin; entry != indexEnd; ++entry)
+      addRun(entry->begin(), entry->end());
+  } else {
+    // Group adjacent records to the same protocol ourselves.
+    auto runBegin = begin;
+    for (auto record = begin; record != end; ++record) {
+      if (record->getProtocol() != runBegin->getProtocol()) {
+        addRun(runBegin, record);
+        runBegin = record;
+      }
+    }
+    if (runBegin != end)
+      addRun(runBegin, end);
+  }
+
+  // Publish the section to lookups.
+  C.NumIndexedSections.store(sectionIndex + 1, std::memory_order_release);
 }
 
 static void _addImageProtocolConformancesBlock(const uint8_t *conformances,
-                                               size_t conformancesSize) {
+                                               size_t conformancesSize,
+                                               const uint8_t *index,
+                                               size_t indexSize) {
   assert(conformancesSize % sizeof(ProtocolConformanceRecord) == 0
          && "weird-sized conformances section?!");
+  assert(indexSize % sizeof(ProtocolConformanceIndexEntry) == 0
+         && "weird-sized conformance index section?!");
 
   // If we have a section, enqueue the conformances for lookup.
   auto recordsBegin
@@ -311,10 +436,16 @@ static void _addImageProtocolConformancesBlock(const uint8_t *conformances,
   auto recordsEnd
     = reinterpret_cast<const ProtocolConformanceRecord*>
                                             (conformances + conformancesSize);
+  auto indexBegin
+    = reinterpret_cast<const ProtocolConformanceIndexEntry*>(index);
+  auto indexEnd
+    = reinterpret_cast<const ProtocolConformanceIndexEntry*>
+                                            (index + indexSize);
   
   // Conformance cache should always be sufficiently initialized by this point.
   _registerProtocolConformances(Conformances.unsafeGetAlreadyInitialized(),
-                                recordsBegin, recordsEnd);
+                                recordsBegin, recordsEnd,
+                                indexBegin, indexEnd);
 }
 
 #if !defined(__APPLE__) || !defined(__MACH__)
@@ -322,6 +453,20 @@ static void _addImageProtocolConformancesBlock(const uint8_t *conformances,
 struct InspectArgs {
   void (*fnAddImageBlock)(const uint8_t *, size_t);
   const char *sectionName;
+
+  /// If set, called instead of fnAddImageBlock with the contents of
+  /// indexSectionName as well, or null if the image doesn't have it.
+  void (*fnAddImageIndexedBlock)(const uint8_t *, size_t,
+                                 const uint8_t *, size_t);
+  const char *indexSectionName;
+
+  void addImageBlock(const uint8_t *block, size_t blockSize,
+                     const uint8_t *index, size_t indexSize) const {
+    if (fnAddImageIndexedBlock)
+      fnAddImageIndexedBlock(block, blockSize, index, indexSize);
+    else
+      fnAddImageBlock(block, blockSize);
+  }
 };
 #endif
 
@@ -344,8 +489,16 @@ static void _addImageProtocolConformances(const mach_header *mh,
   
   if (!conformances)
     return;
+
+  // Look for the index the compiler emitted alongside it.
+  unsigned long indexSize = 0;
+  const uint8_t *index =
+    getsectiondata(reinterpret_cast<const mach_header_platform *>(mh),
+                   SEG_TEXT, SWIFT_PROTOCOL_CONFORMANCE_INDEX_SECTION,
+                   &indexSize);
   
-  _addImageProtocolConformancesBlock(conformances, conformancesSize);
+  _addImageProtocolConformancesBlock(conformances, conformancesSize,
+                                     index, indexSize);
 }
 
 static void _initializeCallbacksToInspectDylib() {
@@ -385,22 +538,30 @@ static int _addImageProtocolConformances(struct dl_phdr_info *info,
   auto conformancesSize = *reinterpret_cast<const uint64_t*>(conformances);
   conformances += sizeof(conformancesSize);
 
-  inspectArgs->fnAddImageBlock(conformances, conformancesSize);
+  const uint8_t *index = nullptr;
+  uint64_t indexSize = 0;
+  if (inspectArgs->indexSectionName) {
+    index = reinterpret_cast<const uint8_t*>(
+        dlsym(handle, inspectArgs->indexSectionName));
+    if (index) {
+      indexSize = *reinterpret_cast<const uint64_t*>(index);
+      index += sizeof(indexSize);
+    }
+  }
+
+  inspectArgs->addImageBlock(conformances, conformancesSize,
+                             index, indexSize);
 
   dlclose(handle);
   return 0;
 }
 
-void swift::_swift_initializeCallbacksToInspectDylib(
-    void (*fnAddImageBlock)(const uint8_t *, size_t),
-    const char *sectionName) {
-  InspectArgs inspectArgs = {fnAddImageBlock, sectionName};
-
+static void _inspectLoadedImages(InspectArgs *inspectArgs) {
   // Search the loaded dls. Unlike the above, this only searches the already
   // loaded ones.
   // FIXME: Find a way to have this continue to happen after.
   // rdar://problem/19045112
-  dl_iterate_phdr(_addImageProtocolConformances, &inspectArgs);
+  dl_iterate_phdr(_addImageProtocolConformances, inspectArgs);
 }
 #elif defined(__CYGWIN__) || defined(_MSC_VER)
 static int _addImageProtocolConformances(struct dl_phdr_info *info,
@@ -427,8 +588,15 @@ static int _addImageProtocolConformances(struct dl_phdr_info *info,
     _swift_getSectionDataPE(handle, inspectArgs->sectionName,
                            &conformancesSize);
 
-  if (conformances)
-    inspectArgs->fnAddImageBlock(conformances, conformancesSize);
+  if (conformances) {
+    unsigned long indexSize = 0;
+    const uint8_t *index = nullptr;
+    if (inspectArgs->indexSectionName)
+      index = _swift_getSectionDataPE(handle, inspectArgs->indexSectionName,
+                                      &indexSize);
+    inspectArgs->addImageBlock(conformances, conformancesSize,
+                               index, indexSize);
+  }
 
 #if defined(_MSC_VER)
   FreeLibrary(handle);
@@ -438,21 +606,31 @@ static int _addImageProtocolConformances(struct dl_phdr_info *info,
   return 0;
 }
 
+static void _inspectLoadedImages(InspectArgs *inspectArgs) {
+  _swift_dl_iterate_phdr(_addImageProtocolConformances, inspectArgs);
+}
+#else
+# error No known mechanism to inspect dynamic libraries on this platform.
+#endif
+
+#if !defined(__APPLE__) || !defined(__MACH__)
 void swift::_swift_initializeCallbacksToInspectDylib(
     void (*fnAddImageBlock)(const uint8_t *, size_t),
     const char *sectionName) {
-  InspectArgs inspectArgs = {fnAddImageBlock, sectionName};
+  InspectArgs inspectArgs = {fnAddImageBlock, sectionName, nullptr, nullptr};
+  _inspectLoadedImages(&inspectArgs);
+}
 
-  _swift_dl_iterate_phdr(_addImageProtocolConformances, &inspectArgs);
+static void _initializeCallbacksToInspectDylib(
+    void (*fnAddImageIndexedBlock)(const uint8_t *, size_t,
+                                   const uint8_t *, size_t),
+    const char *sectionName, const char *indexSectionName) {
+  InspectArgs inspectArgs = {nullptr, sectionName,
+                             fnAddImageIndexedBlock, indexSectionName};
+  _inspectLoadedImages(&inspectArgs);
 }
-#else
-# error No known mechanism to inspect dynamic libraries on this platform.
 #endif
 
-// This variable is used to signal when a cache was generated and
-// it is correct to avoid a new scan.
-static unsigned ConformanceCacheGeneration = 0;
-
 void
 swift::swift_registerProtocolConformances(const ProtocolConformanceRecord *begin,
                                           const ProtocolConformanceRecord *end){
@@ -490,7 +668,8 @@ recur_inside_cache_lock:
         foundEntry = Value;
 
       // If we got a cached negative response, check the generation number.
-      if (Value->getFailureGeneration() == C.SectionsToScan.size()) {
+      if (Value->getFailureGeneration()
+            == C.NumIndexedSections.load(std::memory_order_acquire)) {
         // We found an entry with a negative value.
         return std::make_pair(nullptr, true);
       }
@@ -561,71 +740,39 @@ bool isRelatedType(const Metadata *type, const void *candidate,
   return false;
 }
 
-const WitnessTable *
-swift::swift_conformsToProtocol(const Metadata *type,
-                                const ProtocolDescriptor *protocol) {
-  auto &C = Conformances.get();
-  auto origType = type;
-  unsigned numSections = 0;
-  ConformanceCacheEntry *foundEntry;
-
-recur:
-  // See if we have a cached conformance. The ConcurrentMap data structure
-  // allows us to insert and search the map concurrently without locking.
-  // We do lock the slow path because the SectionsToScan data structure is not
-  // concurrent.
-  auto FoundConformance = searchInConformanceCache(type, protocol, foundEntry);
-  // The negative answer does not always mean that there is no conformance,
-  // unless it is an exact match on the type. If it is not an exact match,
-  // it may mean that all of the superclasses do not have this conformance,
-  // but the actual type may still have this conformance.
-  if (FoundConformance.second) {
-    if (FoundConformance.first || foundEntry)
-      return FoundConformance.first;
-  }
-
-  // If we didn't have an up-to-date cache entry, scan the conformance records.
-  C.SectionsToScanLock.lock();
-  unsigned failedGeneration = ConformanceCacheGeneration;
-
-  // If we have no new information to pull in (and nobody else pulled in
-  // new information while we waited on the lock), we're done.
-  if (C.SectionsToScan.size() == numSections) {
-    if (failedGeneration != ConformanceCacheGeneration) {
-      // Someone else pulled in new conformances while we were waiting.
-      // Start over with our newly-populated cache.
-      C.SectionsToScanLock.unlock();
-      type = origType;
-      goto recur;
-    }
-
-
-    // Save the failure for this type-protocol pair in the cache.
-    C.cacheFailure(type, protocol);
+/// Pull the conformances to \p protocol from sections
+/// [firstSectionIdx, endSectionIdx) that are relevant to \p type into the
+/// cache.
+///
+/// This does not take SectionsToScanLock; it only reads the per-protocol
+/// index, which supports concurrent registration.  Records from sections
+/// registered while we scan may or may not be seen, which is fine because
+/// the caller only trusts sections below endSectionIdx.
+static void scanConformanceIndex(ConformanceState &C, const Metadata *type,
+                                 const ProtocolDescriptor *protocol,
+                                 size_t firstSectionIdx,
+                                 size_t endSectionIdx) {
+  auto indexEntry = C.RecordsByProtocol.find(protocol);
+  if (!indexEntry)
+    return;
 
-    C.SectionsToScanLock.unlock();
-    return nullptr;
-  }
+  uint64_t numScanned = 0;
 
-  // Update the last known number of sections to scan.
-  numSections = C.SectionsToScan.size();
+  for (const auto &run : indexEntry->Runs) {
+    // The list is ordered newest section first, so once we reach a section
+    // that was already scanned, everything after it was too.
+    if (run.SectionIndex < firstSectionIdx)
+      break;
+    if (run.SectionIndex >= endSectionIdx)
+      continue;
 
-  // Scan only sections that were not scanned yet.
-  unsigned sectionIdx = foundEntry ? foundEntry->getFailureGeneration() : 0;
-  unsigned endSectionIdx = C.SectionsToScan.size();
+    for (const auto &record : run) {
+      auto P = record.getProtocol();
+      assert(P == protocol && "record indexed under the wrong protocol");
+      ++numScanned;
 
-  for (; sectionIdx < endSectionIdx; ++sectionIdx) {
-    auto &section = C.SectionsToScan[sectionIdx];
-    // Eagerly pull records for nondependent witnesses into our cache.
-    for (const auto &record : section) {
       // If the record applies to a specific type, cache it.
       if (auto metadata = record.getCanonicalTypeMetadata()) {
-        auto P = record.getProtocol();
-
-        // Look for an exact match.
-        if (protocol != P)
-          continue;
-
         if (!isRelatedType(type, metadata, /*isMetadata=*/true))
           continue;
 
@@ -634,21 +781,16 @@ recur:
         if (witness) {
           C.cacheSuccess(metadata, P, witness);
         } else {
-          C.cacheFailure(metadata, P);
+          C.cacheFailure(metadata, P, endSectionIdx);
         }
 
       // TODO: "Nondependent witness table" probably deserves its own flag.
-      // An accessor function might still be necessary even if the witness table
-      // can be shared.
+      // An accessor function might still be necessary even if the witness
+      // table can be shared.
       } else if (record.getTypeKind()
                    == TypeMetadataRecordKind::UniqueNominalTypeDescriptor) {
 
         auto R = record.getNominalTypeDescriptor();
-        auto P = record.getProtocol();
-
-        // Look for an exact match.
-        if (protocol != P)
-          continue;
 
         if (!isRelatedType(type, R, /*isMetadata=*/false))
           continue;
@@ -671,38 +813,174 @@ recur:
       }
     }
   }
-  ++ConformanceCacheGeneration;
 
-  C.SectionsToScanLock.unlock();
+  countRuntimeStatistic(RuntimeStatistic::ConformanceRecordScanned,
+                        numScanned);
+}
+
+const WitnessTable *
+swift::swift_conformsToProtocol(const Metadata *type,
+                                const ProtocolDescriptor *protocol) {
+  auto &C = Conformances.get();
+  auto origType = type;
+  // The number of sections whose records we have pulled into the cache, or
+  // ~0 if we haven't scanned yet.
+  size_t scannedSections = ~size_t(0);
+  ConformanceCacheEntry *foundEntry;
+
+recur:
+  // See if we have a cached conformance. The ConcurrentMap data structure
+  // allows us to insert and search the map concurrently without locking.
+  auto FoundConformance = searchInConformanceCache(type, protocol, foundEntry);
+  // The negative answer does not always mean that there is no conformance,
+  // unless it is an exact match on the type. If it is not an exact match,
+  // it may mean that all of the superclasses do not have this conformance,
+  // but the actual type may still have this conformance.
+  if (FoundConformance.second) {
+    if (FoundConformance.first || foundEntry)
+      return FoundConformance.first;
+  }
+
+  // If we didn't have an up-to-date cache entry, consult the index of
+  // registered conformance records.  Anything in a section below
+  // numSections is guaranteed to be indexed.
+  size_t numSections = C.NumIndexedSections.load(std::memory_order_acquire);
+
+  // If we have no new information to pull in, we're done.
+  if (numSections == scannedSections) {
+    // Save the failure for this type-protocol pair in the cache.
+    C.cacheFailure(type, protocol, numSections);
+    return nullptr;
+  }
+
+  // Scan only sections that were not scanned yet.
+  size_t firstSectionIdx = foundEntry ? foundEntry->getFailureGeneration() : 0;
+  {
+    RuntimeStatisticTimer timer(RuntimeStatistic::ConformanceCacheMiss);
+    scanConformanceIndex(C, origType, protocol, firstSectionIdx, numSections);
+  }
+  scannedSections = numSections;
+
   // Start over with our newly-populated cache.
   type = origType;
   goto recur;
 }
 
-const Metadata *
-swift::_searchConformancesByMangledTypeName(const llvm::StringRef typeName) {
-  auto &C = Conformances.get();
-  const Metadata *foundMetadata = nullptr;
+namespace {
+  struct ProtocolCompositionCacheKey {
+    const Metadata *Type;
+    const ProtocolDescriptor * const *Protocols;
+    size_t NumProtocols;
+
+    friend llvm::hash_code
+    hash_value(const ProtocolCompositionCacheKey &key) {
+      return llvm::hash_combine(key.Type,
+                                llvm::hash_combine_range(key.Protocols,
+                                      key.Protocols + key.NumProtocols));
+    }
+  };
 
-  ScopedLock guard(C.SectionsToScanLock);
+  /// The witness tables with which a type conforms to all of the protocols
+  /// of a composition. The protocols and witness tables are tail-allocated.
+  ///
+  /// The composition is compared by its protocols rather than by the
+  /// address of the list, so that lists which are built on the stack by
+  /// the caller share an entry.
+  ///
+  /// Only successful lookups are cached; failures are cached per protocol
+  /// by swift_conformsToProtocol, which knows when to invalidate them.
+  struct ProtocolCompositionCacheEntry {
+  private:
+    const Metadata *Type;
+    size_t NumProtocols;
+
+  public:
+    ProtocolCompositionCacheEntry(ProtocolCompositionCacheKey key,
+                                  const WitnessTable * const *tables)
+      : Type(key.Type), NumProtocols(key.NumProtocols) {
+      std::copy(key.Protocols, key.Protocols + NumProtocols, getProtocols());
+      std::copy(tables, tables + NumProtocols, getWitnessTables());
+    }
+
+    int compareWithKey(const ProtocolCompositionCacheKey &key) const {
+      if (int result = comparePointers(key.Type, Type))
+        return result;
+      if (key.NumProtocols != NumProtocols)
+        return key.NumProtocols < NumProtocols ? -1 : 1;
+      for (size_t i = 0; i != NumProtocols; ++i)
+        if (int result = comparePointers(key.Protocols[i], getProtocols()[i]))
+          return result;
+      return 0;
+    }
 
-  unsigned sectionIdx = 0;
-  unsigned endSectionIdx = C.SectionsToScan.size();
+    static size_t
+    getExtraAllocationSize(const ProtocolCompositionCacheKey &key,
+                           const WitnessTable * const *tables) {
+      return key.NumProtocols *
+        (sizeof(const ProtocolDescriptor *) + sizeof(const WitnessTable *));
+    }
 
-  for (; sectionIdx < endSectionIdx; ++sectionIdx) {
-    auto &section = C.SectionsToScan[sectionIdx];
-    for (const auto &record : section) {
-      if (auto metadata = record.getCanonicalTypeMetadata())
-        foundMetadata = _matchMetadataByMangledTypeName(typeName, metadata, nullptr);
-      else if (auto ntd = record.getNominalTypeDescriptor())
-        foundMetadata = _matchMetadataByMangledTypeName(typeName, nullptr, ntd);
+    size_t getExtraAllocationSize() const {
+      return NumProtocols *
+        (sizeof(const ProtocolDescriptor *) + sizeof(const WitnessTable *));
+    }
 
-      if (foundMetadata != nullptr)
-        break;
+    const ProtocolDescriptor **getProtocols() {
+      return reinterpret_cast<const ProtocolDescriptor **>(this + 1);
     }
-    if (foundMetadata != nullptr)
-      break;
+    const ProtocolDescriptor * const *getProtocols() const {
+      return reinterpret_cast<const ProtocolDescriptor * const *>(this + 1);
+    }
+
+    const WitnessTable **getWitnessTables() {
+      return reinterpret_cast<const WitnessTable **>(
+                                             getProtocols() + NumProtocols);
+    }
+    const WitnessTable * const *getWitnessTables() const {
+      return reinterpret_cast<const WitnessTable * const *>(
+                                             getProtocols() + NumProtocols);
+    }
+  };
+} // end anonymous namespace
+
+static Lazy<ConcurrentMap<ProtocolCompositionCacheEntry>> Compositions;
+
+bool
+swift::swift_conformsToProtocols(const Metadata *type,
+                                 const ProtocolDescriptor * const *protocols,
+                                 size_t numProtocols,
+                                 const WitnessTable **conformances) {
+  ProtocolCompositionCacheKey key{type, protocols, numProtocols};
+  auto &cache = Compositions.get();
+  if (auto *entry = cache.find(key)) {
+    std::copy(entry->getWitnessTables(),
+              entry->getWitnessTables() + numProtocols,
+              conformances);
+    return true;
+  }
+
+  for (size_t i = 0; i != numProtocols; ++i) {
+    assert(protocols[i]->Flags.needsWitnessTable() &&
+           "protocol without witness tables in composition lookup");
+    conformances[i] = swift_conformsToProtocol(type, protocols[i]);
+    if (!conformances[i])
+      return false;
+  }
+
+  cache.getOrInsert(key, conformances);
+  return true;
+}
+
+const Metadata *
+swift::_searchConformancesByMangledTypeName(const llvm::StringRef typeName) {
+  auto &C = Conformances.get();
+
+  // Only index the sections added since the last lookup.
+  if (C.RecordsByTypeName.getNumIndexedSections() !=
+        C.NumIndexedSections.load(std::memory_order_acquire)) {
+    ScopedLock guard(C.SectionsToScanLock);
+    C.RecordsByTypeName.addSections(C.SectionsToScan);
   }
 
-  return foundMetadata;
+  return C.RecordsByTypeName.lookup(typeName);
 }
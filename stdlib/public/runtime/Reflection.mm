@@ -11,21 +11,26 @@
 //===----------------------------------------------------------------------===//
 
 #include "swift/Basic/Fallthrough.h"
+#include "swift/Basic/Lazy.h"
 #include "swift/Runtime/Reflection.h"
 #include "swift/Runtime/Config.h"
 #include "swift/Runtime/HeapObject.h"
 #include "swift/Runtime/Metadata.h"
 #include "swift/Runtime/Enum.h"
+#include "swift/Runtime/Concurrent.h"
 #include "swift/Basic/Demangle.h"
 #include "swift/Runtime/Debug.h"
 #include "swift/Runtime/Portability.h"
 #include "Private.h"
+#include "../SwiftShims/RuntimeShims.h"
+#include <algorithm>
 #include <cassert>
 #include <cstdio>
 #include <cstring>
 #include <new>
 #include <string>
 #include <tuple>
+#include <vector>
 
 #if SWIFT_OBJC_INTEROP
 #include "swift/Runtime/ObjCBridge.h"
@@ -755,6 +760,131 @@ void swift_ClassMirror_subscript(String *outString,
   new (outMirror) Mirror(reflect(owner, fieldData, fieldType.getType()));
 }
   
+// -- Bulk field layout.
+
+namespace {
+  /// The stored properties of a type, as returned by _swift_getFieldLayout.
+  /// The entries are tail-allocated. Types whose layout can't be described
+  /// are cached as well, so that callers can fall back to a mirror cheaply.
+  struct FieldLayoutCacheEntry {
+  private:
+    const Metadata *Type;
+    size_t NumFields;
+    bool IsValid;
+
+  public:
+    FieldLayoutCacheEntry(const Metadata *type, bool isValid,
+                          const std::vector<_SwiftFieldLayoutEntry> &fields)
+      : Type(type), NumFields(fields.size()), IsValid(isValid) {
+      std::copy(fields.begin(), fields.end(), getFields());
+    }
+
+    int compareWithKey(const Metadata *type) const {
+      return comparePointers(type, Type);
+    }
+
+    static size_t
+    getExtraAllocationSize(const Metadata *type, bool isValid,
+                           const std::vector<_SwiftFieldLayoutEntry> &fields) {
+      return fields.size() * sizeof(_SwiftFieldLayoutEntry);
+    }
+
+    size_t getExtraAllocationSize() const {
+      return NumFields * sizeof(_SwiftFieldLayoutEntry);
+    }
+
+    bool isValid() const { return IsValid; }
+    size_t getNumFields() const { return NumFields; }
+
+    _SwiftFieldLayoutEntry *getFields() {
+      return reinterpret_cast<_SwiftFieldLayoutEntry *>(this + 1);
+    }
+    const _SwiftFieldLayoutEntry *getFields() const {
+      return reinterpret_cast<const _SwiftFieldLayoutEntry *>(this + 1);
+    }
+  };
+} // end anonymous namespace
+
+static Lazy<ConcurrentMap<FieldLayoutCacheEntry>> FieldLayouts;
+
+/// Append the stored properties of a struct or class to \p fields, in the
+/// order in which the mirror reports them. Returns false if the layout of
+/// the type can't be described by offsets from the field metadata.
+static bool appendFieldLayout(const Metadata *type,
+                              std::vector<_SwiftFieldLayoutEntry> &fields) {
+  switch (type->getKind()) {
+  case MetadataKind::Struct: {
+    auto Struct = static_cast<const StructMetadata *>(type);
+    auto &description = Struct->Description->Struct;
+    if (description.NumFields == 0)
+      return true;
+
+    auto fieldTypes = Struct->getFieldTypes();
+    auto fieldOffsets = Struct->getFieldOffsets();
+    for (size_t i = 0; i != description.NumFields; ++i) {
+      if (fieldTypes[i].isIndirect())
+        return false;
+      fields.push_back({getFieldName(description.FieldNames, i),
+                        fieldTypes[i].getType(), fieldOffsets[i],
+                        fieldTypes[i].isWeak()});
+    }
+    return true;
+  }
+
+  case MetadataKind::Class: {
+    auto Clas = static_cast<const ClassMetadata *>(type);
+    // The field offsets of classes with Objective-C heritage aren't updated
+    // for resilient base classes; see swift_ClassMirror_subscript.
+    if (!Clas->isTypeMetadata() || !usesNativeSwiftReferenceCounting(Clas))
+      return false;
+
+    // Inherited properties come first, as they do in memory.
+    if (classHasSuperclass(Clas) &&
+        !appendFieldLayout(Clas->SuperClass, fields))
+      return false;
+
+    auto &description = Clas->getDescription()->Class;
+    if (description.NumFields == 0)
+      return true;
+
+    auto fieldTypes = Clas->getFieldTypes();
+    auto fieldOffsets = Clas->getFieldOffsets();
+    for (size_t i = 0; i != description.NumFields; ++i) {
+      if (fieldTypes[i].isIndirect())
+        return false;
+      fields.push_back({getFieldName(description.FieldNames, i),
+                        fieldTypes[i].getType(), fieldOffsets[i],
+                        fieldTypes[i].isWeak()});
+    }
+    return true;
+  }
+
+  default:
+    return false;
+  }
+}
+
+const _SwiftFieldLayoutEntry *
+swift::_swift_getFieldLayout(const void *opaqueType,
+                             __swift_intptr_t *outCount) {
+  auto type = static_cast<const Metadata *>(opaqueType);
+  auto &cache = FieldLayouts.get();
+
+  auto entry = cache.find(type);
+  if (!entry) {
+    std::vector<_SwiftFieldLayoutEntry> fields;
+    bool isValid = appendFieldLayout(type, fields);
+    if (!isValid)
+      fields.clear();
+    entry = cache.getOrInsert(type, isValid, fields).first;
+  }
+
+  if (!entry->isValid())
+    return nullptr;
+  *outCount = entry->getNumFields();
+  return entry->getFields();
+}
+
 // -- Mirror witnesses for ObjC classes.
 
 #if SWIFT_OBJC_INTEROP  
@@ -0,0 +1,591 @@
+//===--- SamplingProfiler.cpp - Swift runtime sampling profiler -----------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Sampling of allocations, retains and releases by backtrace.
+//
+// Each thread counts down to its next sample of each entry point in its own
+// block, so that unsampled calls don't touch shared memory. Sampled
+// backtraces are aggregated in an open-addressing table whose slots are
+// claimed with a compare-and-swap, and whose counts are bumped with relaxed
+// atomic adds; neither takes a lock.
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Runtime/SamplingProfiler.h"
+#include "swift/Basic/Demangle.h"
+#include "swift/Runtime/Debug.h"
+#include "swift/Runtime/HeapObject.h"
+#include "swift/Runtime/Mutex.h"
+#include <chrono>
+#include <map>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__CYGWIN__) || defined(__ANDROID__) || defined(_WIN32)
+#  define SWIFT_SUPPORTS_SAMPLING_PROFILER 0
+#else
+#  define SWIFT_SUPPORTS_SAMPLING_PROFILER 1
+#endif
+
+#if SWIFT_SUPPORTS_SAMPLING_PROFILER
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+using namespace swift;
+
+std::atomic<SamplingProfilerState>
+swift::_swift_samplingProfilerState{SamplingProfilerState::Unknown};
+
+#if SWIFT_SUPPORTS_SAMPLING_PROFILER
+
+namespace {
+
+enum SampleKind : unsigned {
+  AllocSample,
+  RetainSample,
+  ReleaseSample,
+  NumSampleKinds
+};
+
+/// The deepest backtrace that is recorded, not counting the profiler's own
+/// frames.
+constexpr unsigned MaxDepth = 32;
+
+/// The frames of recordSample and the hook that calls it.
+constexpr unsigned SkippedFrames = 2;
+
+constexpr size_t TableSize = 1 << 13;
+
+/// How many slots are probed before a sample is dropped.
+constexpr unsigned MaxProbes = 64;
+
+/// The Key of a slot no backtrace has claimed.
+constexpr uint64_t EmptyKey = 0;
+
+/// The Key of a slot whose backtrace is being written.
+constexpr uint64_t BusyKey = 1;
+
+/// The aggregated samples of one backtrace.
+struct SampleSlot {
+  /// The hash of the backtrace once it has been written.
+  std::atomic<uint64_t> Key;
+  uint32_t Depth;
+  void *Frames[MaxDepth];
+  std::atomic<uint64_t> Counts[NumSampleKinds];
+  std::atomic<uint64_t> AllocatedBytes;
+};
+
+/// The number of calls of each entry point a thread has left until its next
+/// sample.
+struct Countdowns {
+  uint32_t Remaining[NumSampleKinds];
+};
+
+uint32_t Period;
+SampleSlot *Slots;
+std::atomic<uint64_t> DroppedSamples{0};
+std::atomic<bool> DumpRequested{false};
+std::atomic<unsigned> NumDumps{0};
+pthread_key_t CountdownsKey;
+std::string OutputPath;
+uint64_t StartNanos;
+
+/// The hooks that were installed when the profiler started.
+decltype(_swift_allocObject) NextAllocObject;
+decltype(_swift_retain) NextRetain;
+decltype(_swift_retain_n) NextRetainN;
+decltype(_swift_release) NextRelease;
+decltype(_swift_release_n) NextReleaseN;
+
+} // end anonymous namespace
+
+static uint64_t getNanoseconds() {
+  using namespace std::chrono;
+  return duration_cast<nanoseconds>(
+             system_clock::now().time_since_epoch()).count();
+}
+
+static uint64_t hashFrames(void * const *frames, unsigned depth) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (unsigned i = 0; i != depth; ++i) {
+    hash ^= reinterpret_cast<uintptr_t>(frames[i]);
+    hash *= 1099511628211ULL;
+  }
+  return hash > BusyKey ? hash : hash + BusyKey + 1;
+}
+
+static void writeRequestedProfile();
+
+static LLVM_ATTRIBUTE_NOINLINE
+void recordSample(SampleKind kind, uint64_t count, uint64_t bytes) {
+  void *frames[MaxDepth + SkippedFrames];
+  int captured = backtrace(frames, MaxDepth + SkippedFrames);
+  unsigned depth = captured > int(SkippedFrames) ? captured - SkippedFrames
+                                                 : 0;
+  void * const *stack = frames + (captured - depth);
+  uint64_t key = hashFrames(stack, depth);
+
+  for (unsigned probe = 0; probe != MaxProbes; ++probe) {
+    auto &slot = Slots[(key + probe) & (TableSize - 1)];
+    uint64_t slotKey = slot.Key.load(std::memory_order_acquire);
+    if (slotKey == EmptyKey) {
+      if (slot.Key.compare_exchange_strong(slotKey, BusyKey,
+                                           std::memory_order_acquire)) {
+        slot.Depth = depth;
+        memcpy(slot.Frames, stack, depth * sizeof(void *));
+        slot.Key.store(key, std::memory_order_release);
+        slotKey = key;
+      }
+    }
+    // Another thread is writing the backtrace of this slot.
+    while (slotKey == BusyKey)
+      slotKey = slot.Key.load(std::memory_order_acquire);
+    if (slotKey != key || slot.Depth != depth ||
+        memcmp(slot.Frames, stack, depth * sizeof(void *)) != 0)
+      continue;
+
+    slot.Counts[kind].fetch_add(count, std::memory_order_relaxed);
+    if (bytes)
+      slot.AllocatedBytes.fetch_add(bytes, std::memory_order_relaxed);
+    if (LLVM_UNLIKELY(DumpRequested.load(std::memory_order_relaxed)))
+      writeRequestedProfile();
+    return;
+  }
+  DroppedSamples.fetch_add(1, std::memory_order_relaxed);
+}
+
+static void freeCountdowns(void *countdowns) {
+  free(countdowns);
+}
+
+/// Counts down to the calling thread's next sample of \p kind.
+static inline bool shouldSample(SampleKind kind) {
+  auto countdowns =
+    static_cast<Countdowns *>(pthread_getspecific(CountdownsKey));
+  if (LLVM_UNLIKELY(!countdowns)) {
+    countdowns = static_cast<Countdowns *>(malloc(sizeof(Countdowns)));
+    if (!countdowns)
+      return false;
+    for (auto &remaining : countdowns->Remaining)
+      remaining = Period;
+    pthread_setspecific(CountdownsKey, countdowns);
+  }
+  if (LLVM_LIKELY(--countdowns->Remaining[kind] != 0))
+    return false;
+  countdowns->Remaining[kind] = Period;
+  return true;
+}
+
+static HeapObject *sampledAllocObject(HeapMetadata const *metadata,
+                                      size_t requiredSize,
+                                      size_t requiredAlignmentMask)
+    SWIFT_CC(RegisterPreservingCC_IMPL) {
+  if (LLVM_UNLIKELY(shouldSample(AllocSample)))
+    recordSample(AllocSample, 1, requiredSize);
+  return NextAllocObject(metadata, requiredSize, requiredAlignmentMask);
+}
+
+static void sampledRetain(HeapObject *object)
+    SWIFT_CC(RegisterPreservingCC_IMPL) {
+  if (LLVM_UNLIKELY(shouldSample(RetainSample)))
+    recordSample(RetainSample, 1, 0);
+  NextRetain(object);
+}
+
+static void sampledRetainN(HeapObject *object, uint32_t n)
+    SWIFT_CC(RegisterPreservingCC_IMPL) {
+  if (LLVM_UNLIKELY(shouldSample(RetainSample)))
+    recordSample(RetainSample, n, 0);
+  NextRetainN(object, n);
+}
+
+static void sampledRelease(HeapObject *object)
+    SWIFT_CC(RegisterPreservingCC_IMPL) {
+  if (LLVM_UNLIKELY(shouldSample(ReleaseSample)))
+    recordSample(ReleaseSample, 1, 0);
+  NextRelease(object);
+}
+
+static void sampledReleaseN(HeapObject *object, uint32_t n)
+    SWIFT_CC(RegisterPreservingCC_IMPL) {
+  if (LLVM_UNLIKELY(shouldSample(ReleaseSample)))
+    recordSample(ReleaseSample, n, 0);
+  NextReleaseN(object, n);
+}
+
+//===----------------------------------------------------------------------===//
+// Writing profiles
+//===----------------------------------------------------------------------===//
+
+namespace {
+
+/// Encodes the subset of the protocol buffer wire format that
+/// profile.proto needs.
+class ProtoWriter {
+  std::string Buffer;
+
+public:
+  void writeVarint(uint64_t value) {
+    while (value >= 0x80) {
+      Buffer += char((value & 0x7f) | 0x80);
+      value >>= 7;
+    }
+    Buffer += char(value);
+  }
+
+  /// Writes a varint field, omitting it if it has the default value 0.
+  void writeUInt(unsigned field, uint64_t value) {
+    if (!value)
+      return;
+    writeVarint(field << 3);
+    writeVarint(value);
+  }
+
+  void writeBytes(unsigned field, const std::string &bytes) {
+    writeVarint(field << 3 | 2);
+    writeVarint(bytes.size());
+    Buffer += bytes;
+  }
+
+  void writeMessage(unsigned field, const ProtoWriter &message) {
+    writeBytes(field, message.Buffer);
+  }
+
+  void writePacked(unsigned field, const std::vector<uint64_t> &values) {
+    ProtoWriter packed;
+    for (auto value : values)
+      packed.writeVarint(value);
+    writeMessage(field, packed);
+  }
+
+  const std::string &getBuffer() const { return Buffer; }
+};
+
+/// Field numbers of profile.proto.
+enum : unsigned {
+  Profile_SampleType = 1,
+  Profile_Sample = 2,
+  Profile_Mapping = 3,
+  Profile_Location = 4,
+  Profile_Function = 5,
+  Profile_StringTable = 6,
+  Profile_TimeNanos = 9,
+  Profile_DurationNanos = 10,
+  Profile_PeriodType = 11,
+  Profile_Period = 12,
+
+  ValueType_Type = 1,
+  ValueType_Unit = 2,
+
+  Sample_LocationId = 1,
+  Sample_Value = 2,
+
+  Mapping_Id = 1,
+  Mapping_MemoryStart = 2,
+  Mapping_MemoryLimit = 3,
+  Mapping_Filename = 5,
+  Mapping_HasFunctions = 7,
+
+  Location_Id = 1,
+  Location_MappingId = 2,
+  Location_Address = 3,
+  Location_Line = 4,
+
+  Line_FunctionId = 1,
+
+  Function_Id = 1,
+  Function_Name = 2,
+  Function_SystemName = 3,
+};
+
+class ProfileBuilder {
+  ProtoWriter Profile;
+  std::vector<std::string> Strings;
+  std::unordered_map<std::string, uint64_t> StringIndices;
+  std::unordered_map<uintptr_t, uint64_t> LocationIds;
+  std::unordered_map<std::string, uint64_t> FunctionIds;
+
+  struct Image {
+    uint64_t Id;
+    std::string Name;
+    uintptr_t Limit;
+  };
+  std::map<uintptr_t, Image> Images;
+
+  uint64_t intern(const std::string &string) {
+    auto found = StringIndices.find(string);
+    if (found != StringIndices.end())
+      return found->second;
+    uint64_t index = Strings.size();
+    Strings.push_back(string);
+    StringIndices[string] = index;
+    return index;
+  }
+
+  ProtoWriter valueType(const char *type, const char *unit) {
+    ProtoWriter message;
+    message.writeUInt(ValueType_Type, intern(type));
+    message.writeUInt(ValueType_Unit, intern(unit));
+    return message;
+  }
+
+  uint64_t getFunctionId(const char *symbol) {
+    auto found = FunctionIds.find(symbol);
+    if (found != FunctionIds.end())
+      return found->second;
+    uint64_t id = FunctionIds.size() + 1;
+    FunctionIds[symbol] = id;
+
+    std::string name = symbol;
+    if (strncmp(symbol, "_T", 2) == 0)
+      name = Demangle::demangleSymbolAsString(symbol, strlen(symbol));
+    ProtoWriter function;
+    function.writeUInt(Function_Id, id);
+    function.writeUInt(Function_Name, intern(name));
+    function.writeUInt(Function_SystemName, intern(symbol));
+    Profile.writeMessage(Profile_Function, function);
+    return id;
+  }
+
+  uint64_t getLocationId(uintptr_t address) {
+    auto found = LocationIds.find(address);
+    if (found != LocationIds.end())
+      return found->second;
+    uint64_t id = LocationIds.size() + 1;
+    LocationIds[address] = id;
+
+    ProtoWriter location;
+    location.writeUInt(Location_Id, id);
+    location.writeUInt(Location_Address, address);
+    Dl_info info;
+    if (dladdr(reinterpret_cast<void *>(address), &info) && info.dli_fbase) {
+      auto base = reinterpret_cast<uintptr_t>(info.dli_fbase);
+      auto &image = Images[base];
+      if (!image.Id) {
+        image.Id = Images.size();
+        image.Name = info.dli_fname ? info.dli_fname : "";
+      }
+      if (address >= image.Limit)
+        image.Limit = address + 1;
+      location.writeUInt(Location_MappingId, image.Id);
+      if (info.dli_sname) {
+        ProtoWriter line;
+        line.writeUInt(Line_FunctionId, getFunctionId(info.dli_sname));
+        location.writeMessage(Location_Line, line);
+      }
+    }
+    Profile.writeMessage(Profile_Location, location);
+    return id;
+  }
+
+public:
+  ProfileBuilder() {
+    intern("");
+    Profile.writeMessage(Profile_SampleType,
+                         valueType("alloc_objects", "count"));
+    Profile.writeMessage(Profile_SampleType,
+                         valueType("alloc_space", "bytes"));
+    Profile.writeMessage(Profile_SampleType, valueType("retains", "count"));
+    Profile.writeMessage(Profile_SampleType, valueType("releases", "count"));
+  }
+
+  void addSlot(const SampleSlot &slot) {
+    std::vector<uint64_t> locations;
+    for (unsigned i = 0; i != slot.Depth; ++i) {
+      auto address = reinterpret_cast<uintptr_t>(slot.Frames[i]);
+      // All frames but the first are return addresses; point into the call
+      // instruction instead, so that it symbolizes to the call site.
+      if (i != 0 && address)
+        --address;
+      locations.push_back(getLocationId(address));
+    }
+
+    std::vector<uint64_t> values = {
+      slot.Counts[AllocSample].load(std::memory_order_relaxed) * Period,
+      slot.AllocatedBytes.load(std::memory_order_relaxed) * Period,
+      slot.Counts[RetainSample].load(std::memory_order_relaxed) * Period,
+      slot.Counts[ReleaseSample].load(std::memory_order_relaxed) * Period,
+    };
+
+    ProtoWriter sample;
+    sample.writePacked(Sample_LocationId, locations);
+    sample.writePacked(Sample_Value, values);
+    Profile.writeMessage(Profile_Sample, sample);
+  }
+
+  std::string finish() {
+    for (auto &entry : Images) {
+      ProtoWriter mapping;
+      mapping.writeUInt(Mapping_Id, entry.second.Id);
+      mapping.writeUInt(Mapping_MemoryStart, entry.first);
+      mapping.writeUInt(Mapping_MemoryLimit, entry.second.Limit);
+      mapping.writeUInt(Mapping_Filename, intern(entry.second.Name));
+      mapping.writeUInt(Mapping_HasFunctions, 1);
+      Profile.writeMessage(Profile_Mapping, mapping);
+    }
+
+    uint64_t now = getNanoseconds();
+    Profile.writeUInt(Profile_TimeNanos, StartNanos);
+    Profile.writeUInt(Profile_DurationNanos, now - StartNanos);
+    Profile.writeMessage(Profile_PeriodType, valueType("calls", "count"));
+    Profile.writeUInt(Profile_Period, Period);
+
+    // The string table goes last, because the other messages intern their
+    // strings as they are written.
+    for (auto &string : Strings)
+      Profile.writeBytes(Profile_StringTable, string);
+    return Profile.getBuffer();
+  }
+};
+
+} // end anonymous namespace
+
+static bool writeProfile(const char *path) {
+  ProfileBuilder builder;
+  for (size_t i = 0; i != TableSize; ++i) {
+    auto &slot = Slots[i];
+    if (slot.Key.load(std::memory_order_acquire) > BusyKey)
+      builder.addSlot(slot);
+  }
+  auto profile = builder.finish();
+
+  FILE *file = fopen(path, "wb");
+  if (!file)
+    return false;
+  bool written = fwrite(profile.data(), 1, profile.size(), file) ==
+                   profile.size();
+  written = fclose(file) == 0 && written;
+
+  if (auto dropped = DroppedSamples.load(std::memory_order_relaxed))
+    fprintf(stderr, "Swift runtime sampling profiler: dropped %llu samples "
+                    "because the table was full\n", (unsigned long long)dropped);
+  return written;
+}
+
+static void writeRequestedProfile() {
+  if (!DumpRequested.exchange(false))
+    return;
+  auto path = OutputPath + "." + std::to_string(++NumDumps);
+  if (!writeProfile(path.c_str()))
+    fprintf(stderr, "Swift runtime sampling profiler: could not write %s\n",
+            path.c_str());
+}
+
+static void writeProfileAtExit() {
+  if (!writeProfile(OutputPath.c_str()))
+    fprintf(stderr, "Swift runtime sampling profiler: could not write %s\n",
+            OutputPath.c_str());
+}
+
+/// Only sets a flag, because writing a profile isn't async-signal-safe. The
+/// next sample writes the profile.
+static void requestProfile(int) {
+  DumpRequested.store(true, std::memory_order_relaxed);
+}
+
+/// Protects starting the profiler.
+static StaticMutex StartLock;
+
+/// Start the profiler. Must be called with StartLock held.
+static bool startSamplingProfilerLocked(uint32_t period) {
+  if (_swift_samplingProfilerState.load(std::memory_order_acquire) ==
+        SamplingProfilerState::Enabled)
+    return true;
+
+  if (period == 0 || pthread_key_create(&CountdownsKey, freeCountdowns) != 0)
+    return false;
+  Slots = static_cast<SampleSlot *>(calloc(TableSize, sizeof(SampleSlot)));
+  if (!Slots)
+    swift::crash("Could not allocate memory.");
+  Period = period;
+  StartNanos = getNanoseconds();
+
+  // Load whatever backtrace() loads lazily now, rather than while sampling.
+  void *frame;
+  backtrace(&frame, 1);
+
+  // Chain to the current hooks, which may themselves be interposed.
+  NextAllocObject = _swift_allocObject;
+  NextRetain = _swift_retain;
+  NextRetainN = _swift_retain_n;
+  NextRelease = _swift_release;
+  NextReleaseN = _swift_release_n;
+  _swift_allocObject = sampledAllocObject;
+  _swift_retain = sampledRetain;
+  _swift_retain_n = sampledRetainN;
+  _swift_release = sampledRelease;
+  _swift_release_n = sampledReleaseN;
+
+  _swift_samplingProfilerState.store(SamplingProfilerState::Enabled,
+                                     std::memory_order_release);
+  return true;
+}
+
+bool swift::_swift_startSamplingProfiler(uint32_t period) {
+  StaticScopedLock guard(StartLock);
+  return startSamplingProfilerLocked(period);
+}
+
+void swift::_swift_initSamplingProfiler() {
+  const char *setting = getenv("SWIFT_RUNTIME_SAMPLE_PERIOD");
+  uint32_t period = setting ? strtoul(setting, nullptr, 10) : 0;
+
+  StaticScopedLock guard(StartLock);
+  if (_swift_samplingProfilerState.load(std::memory_order_acquire) !=
+        SamplingProfilerState::Unknown)
+    return;
+
+  if (const char *output = getenv("SWIFT_RUNTIME_SAMPLE_OUTPUT"))
+    OutputPath = output;
+  else
+    OutputPath = "swift-runtime-" + std::to_string(getpid()) + ".pb";
+
+  if (!startSamplingProfilerLocked(period)) {
+    _swift_samplingProfilerState.store(SamplingProfilerState::Disabled,
+                                       std::memory_order_release);
+    return;
+  }
+  atexit(writeProfileAtExit);
+  signal(SIGUSR2, requestProfile);
+}
+
+bool swift::swift_runtime_writeSamplingProfile(const char *path) {
+  if (_swift_samplingProfilerState.load(std::memory_order_acquire) !=
+        SamplingProfilerState::Enabled)
+    return false;
+  return writeProfile(path);
+}
+
+#else
+
+bool swift::_swift_startSamplingProfiler(uint32_t period) {
+  return false;
+}
+
+void swift::_swift_initSamplingProfiler() {
+  _swift_samplingProfilerState.store(SamplingProfilerState::Disabled,
+                                     std::memory_order_relaxed);
+}
+
+bool swift::swift_runtime_writeSamplingProfile(const char *path) {
+  return false;
+}
+
+#endif
@@ -0,0 +1,235 @@
+//===--- Statistics.cpp - Swift runtime statistics ------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Collection and reporting of runtime statistics.
+//
+// Every thread counts into its own block, so that counting doesn't need
+// atomic read-modify-write operations or contend on shared cache lines.
+// The blocks of live threads are linked into a list; when a thread exits,
+// its counts are added to a block of retired counts.
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Runtime/Statistics.h"
+#include "swift/Basic/Lazy.h"
+#include "swift/Runtime/Debug.h"
+#include "swift/Runtime/Mutex.h"
+#include <chrono>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(_WIN32)
+#include <pthread.h>
+#endif
+
+using namespace swift;
+
+std::atomic<RuntimeStatisticsState>
+swift::_swift_runtimeStatisticsState{RuntimeStatisticsState::Unknown};
+
+namespace {
+
+const char * const StatisticDescriptions[] = {
+#define RUNTIME_STATISTIC(Id, Description) Description,
+#include "swift/Runtime/RuntimeStatistics.def"
+};
+
+constexpr size_t NumStatistics =
+  sizeof(StatisticDescriptions) / sizeof(StatisticDescriptions[0]);
+
+/// The counts of one thread.
+///
+/// Only the owning thread writes its counters, so it updates them with a
+/// relaxed load and store. Other threads read them while reporting and may
+/// see a slightly stale value.
+struct StatisticsBlock {
+  std::atomic<uint64_t> Counts[NumStatistics];
+  std::atomic<uint64_t> Nanoseconds[NumStatistics];
+  StatisticsBlock *Previous;
+  StatisticsBlock *Next;
+
+  void add(RuntimeStatistic statistic, uint64_t count, uint64_t nanoseconds) {
+    auto index = static_cast<unsigned>(statistic);
+    Counts[index].store(Counts[index].load(std::memory_order_relaxed) + count,
+                        std::memory_order_relaxed);
+    if (nanoseconds)
+      Nanoseconds[index].store(
+          Nanoseconds[index].load(std::memory_order_relaxed) + nanoseconds,
+          std::memory_order_relaxed);
+  }
+
+  void addTo(RuntimeStatisticValue *values, size_t count) const {
+    for (size_t i = 0; i != count; ++i) {
+      values[i].Count += Counts[i].load(std::memory_order_relaxed);
+      values[i].Nanoseconds += Nanoseconds[i].load(std::memory_order_relaxed);
+    }
+  }
+};
+
+class RuntimeStatistics {
+  /// Protects the list of thread blocks and the retired counts.
+  Mutex Lock;
+
+  /// The most recently created block of a live thread.
+  StatisticsBlock *Last = nullptr;
+
+  /// The counts of threads that have exited.
+  StatisticsBlock Retired = {};
+
+#if !defined(_WIN32)
+  pthread_key_t BlockKey;
+  bool HaveBlockKey = false;
+
+  static void retireBlock(void *block);
+#endif
+
+public:
+  RuntimeStatistics();
+
+  void record(RuntimeStatistic statistic, uint64_t count,
+              uint64_t nanoseconds);
+  void sum(RuntimeStatisticValue *values, size_t count);
+};
+
+} // end anonymous namespace
+
+static Lazy<RuntimeStatistics> Statistics;
+
+RuntimeStatistics::RuntimeStatistics() {
+#if !defined(_WIN32)
+  HaveBlockKey = pthread_key_create(&BlockKey, retireBlock) == 0;
+#endif
+}
+
+void RuntimeStatistics::record(RuntimeStatistic statistic, uint64_t count,
+                               uint64_t nanoseconds) {
+#if !defined(_WIN32)
+  if (HaveBlockKey) {
+    auto block = static_cast<StatisticsBlock *>(pthread_getspecific(BlockKey));
+    if (LLVM_UNLIKELY(!block)) {
+      block = static_cast<StatisticsBlock *>(calloc(1, sizeof(*block)));
+      if (!block)
+        swift::crash("Could not allocate memory.");
+      {
+        ScopedLock guard(Lock);
+        block->Previous = Last;
+        if (Last)
+          Last->Next = block;
+        Last = block;
+      }
+      pthread_setspecific(BlockKey, block);
+    }
+    block->add(statistic, count, nanoseconds);
+    return;
+  }
+#endif
+
+  // Without per-thread blocks, count into the retired block under the lock.
+  ScopedLock guard(Lock);
+  Retired.add(statistic, count, nanoseconds);
+}
+
+#if !defined(_WIN32)
+void RuntimeStatistics::retireBlock(void *opaqueBlock) {
+  auto block = static_cast<StatisticsBlock *>(opaqueBlock);
+  auto &stats = Statistics.get();
+  {
+    ScopedLock guard(stats.Lock);
+    for (size_t i = 0; i != NumStatistics; ++i) {
+      stats.Retired.Counts[i].store(
+          stats.Retired.Counts[i].load(std::memory_order_relaxed) +
+            block->Counts[i].load(std::memory_order_relaxed),
+          std::memory_order_relaxed);
+      stats.Retired.Nanoseconds[i].store(
+          stats.Retired.Nanoseconds[i].load(std::memory_order_relaxed) +
+            block->Nanoseconds[i].load(std::memory_order_relaxed),
+          std::memory_order_relaxed);
+    }
+
+    if (block->Previous)
+      block->Previous->Next = block->Next;
+    if (block->Next)
+      block->Next->Previous = block->Previous;
+    else
+      stats.Last = block->Previous;
+  }
+  free(block);
+}
+#endif
+
+void RuntimeStatistics::sum(RuntimeStatisticValue *values, size_t count) {
+  for (size_t i = 0; i != count; ++i) {
+    values[i].Description = StatisticDescriptions[i];
+    values[i].Count = 0;
+    values[i].Nanoseconds = 0;
+  }
+
+  ScopedLock guard(Lock);
+  Retired.addTo(values, count);
+  for (auto block = Last; block; block = block->Previous)
+    block->addTo(values, count);
+}
+
+static void dumpRuntimeStatistics() {
+  RuntimeStatisticValue values[NumStatistics];
+  Statistics.get().sum(values, NumStatistics);
+
+  fprintf(stderr, "Swift runtime statistics:\n");
+  for (auto &value : values) {
+    if (value.Nanoseconds)
+      fprintf(stderr, "%12" PRIu64 " %12.3f ms  %s\n", value.Count,
+              value.Nanoseconds / 1e6, value.Description);
+    else
+      fprintf(stderr, "%12" PRIu64 " %15s  %s\n", value.Count, "",
+              value.Description);
+  }
+}
+
+bool swift::_swift_initRuntimeStatistics() {
+  const char *setting = getenv("SWIFT_RUNTIME_STATS");
+  bool enabled = setting && setting[0] && strcmp(setting, "0") != 0;
+
+  // Set up the thread blocks before any thread can see the enabled state.
+  if (enabled)
+    Statistics.get();
+
+  auto expected = RuntimeStatisticsState::Unknown;
+  if (_swift_runtimeStatisticsState.compare_exchange_strong(expected,
+        enabled ? RuntimeStatisticsState::Enabled
+                : RuntimeStatisticsState::Disabled,
+        std::memory_order_acq_rel) &&
+      enabled)
+    atexit(dumpRuntimeStatistics);
+
+  return enabled;
+}
+
+void swift::_swift_recordRuntimeStatistic(RuntimeStatistic statistic,
+                                          uint64_t count,
+                                          uint64_t nanoseconds) {
+  Statistics.get().record(statistic, count, nanoseconds);
+}
+
+uint64_t swift::_swift_getRuntimeStatisticsTime() {
+  using namespace std::chrono;
+  return duration_cast<nanoseconds>(
+             steady_clock::now().time_since_epoch()).count();
+}
+
+size_t swift::swift_runtime_getStatistics(RuntimeStatisticValue *values,
+                                          size_t capacity) {
+  Statistics.get().sum(values, capacity < NumStatistics ? capacity
+                                                        : NumStatistics);
+  return NumStatistics;
+}
@@ -0,0 +1,235 @@
+//===--- ThreadPool.cpp - Work-stealing pool for parallel loops -----------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// The parallel algorithms of the standard library run their loops with
+// _swift_parallelFor on a pool of worker threads, one for each hardware
+// thread but the calling one. The pool is created by the first parallel loop
+// of the process, and doesn't depend on libdispatch.
+//
+// The tasks of a loop are ranges of its iterations. A thread which takes a
+// task of more than one iteration pushes the upper half back to its queue and
+// keeps the lower half, until it is left with a single iteration. Threads
+// take tasks from the back of their own queue and steal them from the front
+// of the others, so a loop is divided about as finely as it takes to keep all
+// threads busy, and stolen tasks are the largest ones.
+//
+// The thread which runs a loop runs tasks as well until the loop is finished,
+// including tasks of other loops. So a loop may run another one in its body.
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Basic/Lazy.h"
+#include "swift/Runtime/Mutex.h"
+#include "../SwiftShims/RuntimeShims.h"
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace swift;
+
+namespace {
+
+/// A loop run by _swift_parallelFor.
+struct Loop {
+  void (*Body)(void *context, size_t index);
+  void *Context;
+
+  /// The number of iterations which have not finished yet.
+  std::atomic<size_t> Remaining;
+};
+
+/// The iterations [Begin, End) of a loop.
+struct Task {
+  Loop *TheLoop;
+  size_t Begin, End;
+};
+
+/// The tasks pushed by one thread, or by all the threads which are not in
+/// the pool.
+struct TaskQueue {
+  Mutex Lock;
+  std::deque<Task> Tasks;
+};
+
+class ThreadPool {
+  /// The queue of the threads which are not in the pool, followed by one
+  /// queue for each worker.
+  std::vector<std::unique_ptr<TaskQueue>> Queues;
+
+  /// The number of tasks in all the queues.
+  std::atomic<size_t> QueuedTasks{0};
+
+  /// The number of threads waiting for Changed.
+  std::atomic<size_t> SleepingThreads{0};
+
+  /// Signalled when a task is queued, and when a loop is finished.
+  Mutex SleepLock;
+  ConditionVariable Changed;
+
+  /// The index of the queue of the calling thread.
+  static thread_local size_t CurrentQueue;
+
+  void wakeSleepingThreads();
+  void push(const Task &task);
+  bool pop(Task &task);
+  void run(Task task);
+  void runWorker(size_t queue);
+
+public:
+  ThreadPool();
+
+  size_t getNumWorkers() const { return Queues.size() - 1; }
+
+  void parallelFor(size_t count, void (*body)(void *, size_t), void *context);
+};
+
+} // end anonymous namespace
+
+thread_local size_t ThreadPool::CurrentQueue = 0;
+
+static Lazy<ThreadPool> Pool;
+
+ThreadPool::ThreadPool() {
+  size_t numThreads = std::thread::hardware_concurrency();
+  if (numThreads == 0)
+    numThreads = 1;
+  for (size_t i = 0; i != numThreads; ++i)
+    Queues.emplace_back(new TaskQueue());
+
+  // The workers live as long as the process.
+  for (size_t i = 1; i != numThreads; ++i)
+    std::thread([this, i] { runWorker(i); }).detach();
+}
+
+void ThreadPool::wakeSleepingThreads() {
+  // Sleeping threads count themselves before they check for tasks, so either
+  // they see the new task, or this sees them.
+  if (SleepingThreads.load(std::memory_order_seq_cst) != 0)
+    SleepLock.withLockThenNotifyAll(Changed, [] {});
+}
+
+void ThreadPool::push(const Task &task) {
+  // Count the task first, so that the count is never less than the number of
+  // queued tasks.
+  QueuedTasks.fetch_add(1, std::memory_order_seq_cst);
+  auto &queue = *Queues[CurrentQueue];
+  queue.Lock.withLock([&] { queue.Tasks.push_back(task); });
+  wakeSleepingThreads();
+}
+
+/// Take the newest task of the calling thread's queue, or else steal the
+/// oldest task of another queue.
+bool ThreadPool::pop(Task &task) {
+  if (QueuedTasks.load(std::memory_order_relaxed) == 0)
+    return false;
+
+  size_t numQueues = Queues.size();
+  for (size_t i = 0; i != numQueues; ++i) {
+    auto &queue = *Queues[(CurrentQueue + i) % numQueues];
+    bool found = false;
+    queue.Lock.withLock([&] {
+      if (queue.Tasks.empty())
+        return;
+      if (i == 0) {
+        task = queue.Tasks.back();
+        queue.Tasks.pop_back();
+      } else {
+        task = queue.Tasks.front();
+        queue.Tasks.pop_front();
+      }
+      found = true;
+    });
+    if (found) {
+      QueuedTasks.fetch_sub(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+  return false;
+}
+
+void ThreadPool::run(Task task) {
+  while (task.End - task.Begin > 1) {
+    size_t middle = task.Begin + (task.End - task.Begin) / 2;
+    push({task.TheLoop, middle, task.End});
+    task.End = middle;
+  }
+
+  Loop *loop = task.TheLoop;
+  loop->Body(loop->Context, task.Begin);
+
+  // The thread running the loop may be waiting for the last iteration.
+  if (loop->Remaining.fetch_sub(1, std::memory_order_seq_cst) == 1)
+    wakeSleepingThreads();
+}
+
+void ThreadPool::runWorker(size_t queue) {
+  CurrentQueue = queue;
+  while (true) {
+    Task task;
+    if (pop(task)) {
+      run(task);
+      continue;
+    }
+
+    SleepLock.withLock([&] {
+      SleepingThreads.fetch_add(1, std::memory_order_seq_cst);
+      while (QueuedTasks.load(std::memory_order_seq_cst) == 0)
+        SleepLock.wait(Changed);
+      SleepingThreads.fetch_sub(1, std::memory_order_relaxed);
+    });
+  }
+}
+
+void ThreadPool::parallelFor(size_t count, void (*body)(void *, size_t),
+                             void *context) {
+  Loop loop;
+  loop.Body = body;
+  loop.Context = context;
+  loop.Remaining.store(count, std::memory_order_relaxed);
+  run({&loop, 0, count});
+
+  // Help with any task until the loop is finished. The loop doesn't outlive
+  // this frame, so wait for the iterations other threads are running too.
+  while (loop.Remaining.load(std::memory_order_acquire) != 0) {
+    Task task;
+    if (pop(task)) {
+      run(task);
+      continue;
+    }
+
+    SleepLock.withLock([&] {
+      SleepingThreads.fetch_add(1, std::memory_order_seq_cst);
+      while (loop.Remaining.load(std::memory_order_seq_cst) != 0 &&
+             QueuedTasks.load(std::memory_order_seq_cst) == 0)
+        SleepLock.wait(Changed);
+      SleepingThreads.fetch_sub(1, std::memory_order_relaxed);
+    });
+  }
+}
+
+void swift::_swift_parallelFor(__swift_size_t count,
+                               void (*body)(void *context,
+                                            __swift_size_t index),
+                               void *context) {
+  if (count == 0)
+    return;
+
+  // Don't start the pool for a loop which can't run in parallel.
+  if (count == 1 || Pool.get().getNumWorkers() == 0) {
+    for (size_t i = 0; i != count; ++i)
+      body(context, i);
+    return;
+  }
+  Pool.get().parallelFor(count, body, context);
+}
@@ -32,6 +32,7 @@ swift::_SwiftEmptyArrayStorage swift::_swiftEmptyArrayStorage = {
   // HeapObject header;
   {
     &_TMCs18_EmptyArrayStorage, // isa pointer
+    StrongRefCount::Immortal    // shared by all empty arrays, never freed
   },
   
   // _SwiftArrayBodyStorage body;
@@ -69,6 +70,30 @@ SWIFT_ALLOWED_RUNTIME_GLOBAL_CTOR_END
 
 __swift_uint64_t swift::_swift_stdlib_HashingDetail_fixedSeedOverride = 0;
 
+__swift_uint8_t swift::_swift_stdlib_Hashing_usesFastHashing = 0;
+
+#define ASCII_CHARACTERS_1(c) c, 0
+#define ASCII_CHARACTERS_2(c) ASCII_CHARACTERS_1(c), ASCII_CHARACTERS_1(c + 1)
+#define ASCII_CHARACTERS_4(c) ASCII_CHARACTERS_2(c), ASCII_CHARACTERS_2(c + 2)
+#define ASCII_CHARACTERS_8(c) ASCII_CHARACTERS_4(c), ASCII_CHARACTERS_4(c + 4)
+#define ASCII_CHARACTERS_16(c) ASCII_CHARACTERS_8(c), ASCII_CHARACTERS_8(c + 8)
+#define ASCII_CHARACTERS_32(c) \
+  ASCII_CHARACTERS_16(c), ASCII_CHARACTERS_16(c + 16)
+#define ASCII_CHARACTERS_64(c) \
+  ASCII_CHARACTERS_32(c), ASCII_CHARACTERS_32(c + 32)
+
+__swift_uint8_t swift::_swift_stdlib_asciiCharacterStorage[256] = {
+  ASCII_CHARACTERS_64(0), ASCII_CHARACTERS_64(64)
+};
+
+#undef ASCII_CHARACTERS_64
+#undef ASCII_CHARACTERS_32
+#undef ASCII_CHARACTERS_16
+#undef ASCII_CHARACTERS_8
+#undef ASCII_CHARACTERS_4
+#undef ASCII_CHARACTERS_2
+#undef ASCII_CHARACTERS_1
+
 namespace llvm { namespace hashing { namespace detail {
   // An extern variable expected by LLVM's hashing templates. We don't link any
   // LLVM libs into the runtime, so define this here.
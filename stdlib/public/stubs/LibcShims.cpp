@@ -22,6 +22,7 @@
 #include <stdio.h>
 #include <string.h>
 #include "swift/Basic/Lazy.h"
+#include "swift/Runtime/Heap.h"
 #include "../SwiftShims/LibcShims.h"
 #include "llvm/Support/DataTypes.h"
 
@@ -85,28 +86,38 @@ int swift::_swift_stdlib_close(int fd) {
 
 #if defined(__APPLE__)
 #include <malloc/malloc.h>
-size_t swift::_swift_stdlib_malloc_size(const void *ptr) {
+static size_t mallocSize(const void *ptr) {
   return malloc_size(ptr);
 }
 #elif defined(__GNU_LIBRARY__) || defined(__CYGWIN__) || defined(__ANDROID__)
 #include <malloc.h>
-size_t swift::_swift_stdlib_malloc_size(const void *ptr) {
+static size_t mallocSize(const void *ptr) {
   return malloc_usable_size(const_cast<void *>(ptr));
 }
 #elif defined(_MSC_VER)
 #include <malloc.h>
-size_t swift::_swift_stdlib_malloc_size(const void *ptr) {
+static size_t mallocSize(const void *ptr) {
   return _msize(const_cast<void *>(ptr));
 }
 #elif defined(__FreeBSD__)
 #include <malloc_np.h>
-size_t swift::_swift_stdlib_malloc_size(const void *ptr) {
+static size_t mallocSize(const void *ptr) {
   return malloc_usable_size(const_cast<void *>(ptr));
 }
 #else
 #error No malloc_size analog known for this platform/libc.
 #endif
 
+size_t swift::_swift_stdlib_malloc_size(const void *ptr) {
+#if SWIFT_RUNTIME_SIZE_CLASS_ALLOCATOR
+  // Small heap objects may come from the runtime's size-class allocator
+  // rather than malloc.
+  if (size_t size = _swift_slowAllocUsableSize(ptr))
+    return size;
+#endif
+  return mallocSize(ptr);
+}
+
 static Lazy<std::mt19937> theGlobalMT19937;
 
 static std::mt19937 &getGlobalMT19937() {
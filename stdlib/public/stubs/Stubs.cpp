@@ -30,7 +30,9 @@
 #include <sys/errno.h>
 #include <unistd.h>
 #endif
+#include <cfloat>
 #include <climits>
+#include <cmath>
 #include <cstdarg>
 #include <cstdint>
 #include <cstdio>
@@ -38,7 +40,6 @@
 #include <cstring>
 #if defined(__CYGWIN__) || defined(_MSC_VER)
 #include <sstream>
-#include <cmath>
 #define fmodl(lhs, rhs) std::fmod(lhs, rhs)
 #elif defined(__ANDROID__)
 // Android's libc implementation Bionic currently only supports the "C" locale
@@ -70,6 +71,33 @@ static long double swift_strtold_l(const char *nptr,
 
 #include "../SwiftShims/RuntimeShims.h"
 #include "../SwiftShims/RuntimeStubs.h"
+#include "../SwiftShims/UnicodeShims.h"
+
+/// The decimal digits of 0 through 99, two characters each.
+static const char DigitPairs[] =
+  "00010203040506070809"
+  "10111213141516171819"
+  "20212223242526272829"
+  "30313233343536373839"
+  "40414243444546474849"
+  "50515253545556575859"
+  "60616263646566676869"
+  "70717273747576777879"
+  "80818283848586878889"
+  "90919293949596979899";
+
+/// The number of decimal digits of \p Value, which must not be 0.
+static unsigned countDecimalDigits(uint64_t Value) {
+  unsigned Count = 1;
+  for (;;) {
+    if (Value < 10) return Count;
+    if (Value < 100) return Count + 1;
+    if (Value < 1000) return Count + 2;
+    if (Value < 10000) return Count + 3;
+    Value /= 10000;
+    Count += 4;
+  }
+}
 
 static uint64_t uint64ToStringImpl(char *Buffer, uint64_t Value,
                                    int64_t Radix, bool Uppercase,
@@ -79,17 +107,35 @@ static uint64_t uint64ToStringImpl(char *Buffer, uint64_t Value,
 
   if (Y == 0) {
     *P++ = '0';
-  } else if (Radix == 10) {
-    while (Y) {
-      *P++ = '0' + char(Y % 10);
-      Y /= 10;
+    return size_t(P - Buffer);
+  }
+
+  if (Radix == 10) {
+    // Write the digits backwards from the end of the number, two at a time,
+    // so that no reversal is needed.
+    if (Negative)
+      *P++ = '-';
+    P += countDecimalDigits(Y);
+    char *End = P;
+    while (Y >= 100) {
+      unsigned Pair = unsigned(Y % 100) * 2;
+      Y /= 100;
+      *--P = DigitPairs[Pair + 1];
+      *--P = DigitPairs[Pair];
     }
-  } else {
-    unsigned Radix32 = Radix;
-    while (Y) {
-      *P++ = llvm::hexdigit(Y % Radix32, !Uppercase);
-      Y /= Radix32;
+    if (Y >= 10) {
+      *--P = DigitPairs[Y * 2 + 1];
+      *--P = DigitPairs[Y * 2];
+    } else {
+      *--P = char('0' + Y);
     }
+    return size_t(End - Buffer);
+  }
+
+  unsigned Radix32 = Radix;
+  while (Y) {
+    *P++ = llvm::hexdigit(Y % Radix32, !Uppercase);
+    Y /= Radix32;
   }
 
   if (Negative)
@@ -102,7 +148,7 @@ SWIFT_CC(swift) SWIFT_RUNTIME_STDLIB_INTERFACE
 extern "C" uint64_t swift_int64ToString(char *Buffer, size_t BufferLength,
                                         int64_t Value, int64_t Radix,
                                         bool Uppercase) {
-  if ((Radix >= 10 && BufferLength < 32) || (Radix < 10 && BufferLength < 65))
+  if ((Radix >= 10 && BufferLength < 20) || (Radix < 10 && BufferLength < 65))
     swift::crash("swift_int64ToString: insufficient buffer size");
 
   if (Radix == 0 || Radix > 36)
@@ -126,7 +172,7 @@ SWIFT_CC(swift) SWIFT_RUNTIME_STDLIB_INTERFACE
 extern "C" uint64_t swift_uint64ToString(char *Buffer, intptr_t BufferLength,
                                          uint64_t Value, int64_t Radix,
                                          bool Uppercase) {
-  if ((Radix >= 10 && BufferLength < 32) || (Radix < 10 && BufferLength < 64))
+  if ((Radix >= 10 && BufferLength < 20) || (Radix < 10 && BufferLength < 64))
     swift::crash("swift_int64ToString: insufficient buffer size");
 
   if (Radix == 0 || Radix > 36)
@@ -181,6 +227,417 @@ static int swift_snprintf_l(char *Str, size_t StrSize, locale_t Locale,
 }
 #endif
 
+//===----------------------------------------------------------------------===//
+// Locale-independent formatting and parsing of Float and Double
+//===----------------------------------------------------------------------===//
+
+namespace {
+
+/// A floating-point number F * 2^E with a 64-bit significand, as used by the
+/// Grisu digit generation algorithms.
+struct DiyFp {
+  uint64_t F;
+  int E;
+};
+
+/// A rounded, normalized approximation of a power of ten.
+struct CachedPower {
+  uint64_t Significand;
+  int16_t BinaryExponent;
+  int16_t DecimalExponent;
+};
+
+/// 10^k for every eighth k from -348 to 340, rounded to 64 bits.
+const CachedPower CachedPowers[] = {
+  {0xfa8fd5a0081c0288, -1220, -348},
+  {0xbaaee17fa23ebf76, -1193, -340},
+  {0x8b16fb203055ac76, -1166, -332},
+  {0xcf42894a5dce35ea, -1140, -324},
+  {0x9a6bb0aa55653b2d, -1113, -316},
+  {0xe61acf033d1a45df, -1087, -308},
+  {0xab70fe17c79ac6ca, -1060, -300},
+  {0xff77b1fcbebcdc4f, -1034, -292},
+  {0xbe5691ef416bd60c, -1007, -284},
+  {0x8dd01fad907ffc3c, -980, -276},
+  {0xd3515c2831559a83, -954, -268},
+  {0x9d71ac8fada6c9b5, -927, -260},
+  {0xea9c227723ee8bcb, -901, -252},
+  {0xaecc49914078536d, -874, -244},
+  {0x823c12795db6ce57, -847, -236},
+  {0xc21094364dfb5637, -821, -228},
+  {0x9096ea6f3848984f, -794, -220},
+  {0xd77485cb25823ac7, -768, -212},
+  {0xa086cfcd97bf97f4, -741, -204},
+  {0xef340a98172aace5, -715, -196},
+  {0xb23867fb2a35b28e, -688, -188},
+  {0x84c8d4dfd2c63f3b, -661, -180},
+  {0xc5dd44271ad3cdba, -635, -172},
+  {0x936b9fcebb25c996, -608, -164},
+  {0xdbac6c247d62a584, -582, -156},
+  {0xa3ab66580d5fdaf6, -555, -148},
+  {0xf3e2f893dec3f126, -529, -140},
+  {0xb5b5ada8aaff80b8, -502, -132},
+  {0x87625f056c7c4a8b, -475, -124},
+  {0xc9bcff6034c13053, -449, -116},
+  {0x964e858c91ba2655, -422, -108},
+  {0xdff9772470297ebd, -396, -100},
+  {0xa6dfbd9fb8e5b88f, -369, -92},
+  {0xf8a95fcf88747d94, -343, -84},
+  {0xb94470938fa89bcf, -316, -76},
+  {0x8a08f0f8bf0f156b, -289, -68},
+  {0xcdb02555653131b6, -263, -60},
+  {0x993fe2c6d07b7fac, -236, -52},
+  {0xe45c10c42a2b3b06, -210, -44},
+  {0xaa242499697392d3, -183, -36},
+  {0xfd87b5f28300ca0e, -157, -28},
+  {0xbce5086492111aeb, -130, -20},
+  {0x8cbccc096f5088cc, -103, -12},
+  {0xd1b71758e219652c, -77, -4},
+  {0x9c40000000000000, -50, 4},
+  {0xe8d4a51000000000, -24, 12},
+  {0xad78ebc5ac620000, 3, 20},
+  {0x813f3978f8940984, 30, 28},
+  {0xc097ce7bc90715b3, 56, 36},
+  {0x8f7e32ce7bea5c70, 83, 44},
+  {0xd5d238a4abe98068, 109, 52},
+  {0x9f4f2726179a2245, 136, 60},
+  {0xed63a231d4c4fb27, 162, 68},
+  {0xb0de65388cc8ada8, 189, 76},
+  {0x83c7088e1aab65db, 216, 84},
+  {0xc45d1df942711d9a, 242, 92},
+  {0x924d692ca61be758, 269, 100},
+  {0xda01ee641a708dea, 295, 108},
+  {0xa26da3999aef774a, 322, 116},
+  {0xf209787bb47d6b85, 348, 124},
+  {0xb454e4a179dd1877, 375, 132},
+  {0x865b86925b9bc5c2, 402, 140},
+  {0xc83553c5c8965d3d, 428, 148},
+  {0x952ab45cfa97a0b3, 455, 156},
+  {0xde469fbd99a05fe3, 481, 164},
+  {0xa59bc234db398c25, 508, 172},
+  {0xf6c69a72a3989f5c, 534, 180},
+  {0xb7dcbf5354e9bece, 561, 188},
+  {0x88fcf317f22241e2, 588, 196},
+  {0xcc20ce9bd35c78a5, 614, 204},
+  {0x98165af37b2153df, 641, 212},
+  {0xe2a0b5dc971f303a, 667, 220},
+  {0xa8d9d1535ce3b396, 694, 228},
+  {0xfb9b7cd9a4a7443c, 720, 236},
+  {0xbb764c4ca7a44410, 747, 244},
+  {0x8bab8eefb6409c1a, 774, 252},
+  {0xd01fef10a657842c, 800, 260},
+  {0x9b10a4e5e9913129, 827, 268},
+  {0xe7109bfba19c0c9d, 853, 276},
+  {0xac2820d9623bf429, 880, 284},
+  {0x80444b5e7aa7cf85, 907, 292},
+  {0xbf21e44003acdd2d, 933, 300},
+  {0x8e679c2f5e44ff8f, 960, 308},
+  {0xd433179d9c8cb841, 986, 316},
+  {0x9e19db92b4e31ba9, 1013, 324},
+  {0xeb96bf6ebadf77d9, 1039, 332},
+  {0xaf87023b9bf0ee6b, 1066, 340},
+};
+
+const int CachedPowersOffset = 348;
+const int CachedPowersDecimalDistance = 8;
+
+/// The binary exponent range of the scaled value that DigitGen expects.
+const int MinimalTargetExponent = -60;
+const int MaximalTargetExponent = -32;
+
+} // end anonymous namespace
+
+/// Multiply two DiyFps, rounding the 128-bit product to 64 bits.
+static DiyFp multiply(DiyFp X, DiyFp Y) {
+  const uint64_t M32 = 0xFFFFFFFFu;
+  uint64_t A = X.F >> 32, B = X.F & M32;
+  uint64_t C = Y.F >> 32, D = Y.F & M32;
+  uint64_t AC = A * C, BC = B * C, AD = A * D, BD = B * D;
+  uint64_t Middle = (BD >> 32) + (AD & M32) + (BC & M32) + (1u << 31);
+  return {AC + (AD >> 32) + (BC >> 32) + (Middle >> 32), X.E + Y.E + 64};
+}
+
+/// Return a cached power of ten 10^k such that multiplying a DiyFp with
+/// exponent \p E by it gives an exponent in the target range.
+static const CachedPower &getCachedPower(int E, int &K) {
+  double Estimate = std::ceil((MinimalTargetExponent - E - 1) *
+                              0.30102999566398114);
+  int Index = (CachedPowersOffset + static_cast<int>(Estimate) - 1) /
+                CachedPowersDecimalDistance + 1;
+  const CachedPower &Power = CachedPowers[Index];
+  K = Power.DecimalExponent;
+  return Power;
+}
+
+/// Round the digits generated so far given the remainder \p Rest of the
+/// scaled value below the last digit, whose weight is \p TenKappa, and the
+/// error bound \p Unit of the scaled value.
+///
+/// \returns false if the error bound doesn't allow to decide the direction.
+static bool roundWeedCounted(char *Digits, int Length, uint64_t Rest,
+                             uint64_t TenKappa, uint64_t Unit, int &Kappa) {
+  if (Unit >= TenKappa || TenKappa - Unit <= Unit)
+    return false;
+  // If 2 * (Rest + Unit) <= 10^Kappa we can safely round down.
+  if (TenKappa - Rest > Rest && TenKappa - 2 * Rest >= 2 * Unit)
+    return true;
+  // If 2 * (Rest - Unit) >= 10^Kappa we can safely round up.
+  if (Rest > Unit && TenKappa - (Rest - Unit) <= Rest - Unit) {
+    ++Digits[Length - 1];
+    for (int i = Length - 1; i > 0 && Digits[i] == '0' + 10; --i) {
+      Digits[i] = '0';
+      ++Digits[i - 1];
+    }
+    if (Digits[0] == '0' + 10) {
+      Digits[0] = '1';
+      ++Kappa;
+    }
+    return true;
+  }
+  return false;
+}
+
+/// Compute the first \p Precision decimal digits of the positive, finite
+/// \p Value, correctly rounded, with the Grisu "counted" algorithm. The
+/// result is Digits * 10^DecimalExponent.
+///
+/// \returns false for the rare values where 64 bits of precision are not
+/// enough to decide how to round.
+static bool getDecimalDigits(double Value, int Precision, char *Digits,
+                             int &DecimalExponent) {
+  uint64_t Bits;
+  memcpy(&Bits, &Value, sizeof(Bits));
+  const uint64_t HiddenBit = uint64_t(1) << 52;
+  int BiasedExponent = int(Bits >> 52) & 0x7FF;
+  DiyFp W;
+  if (BiasedExponent == 0) {
+    W = {Bits & (HiddenBit - 1), -1074};
+  } else {
+    W = {(Bits & (HiddenBit - 1)) | HiddenBit, BiasedExponent - 1075};
+  }
+  while (!(W.F & (uint64_t(1) << 63))) {
+    W.F <<= 1;
+    --W.E;
+  }
+
+  int MK;
+  const CachedPower &Power = getCachedPower(W.E, MK);
+  W = multiply(W, {Power.Significand, Power.BinaryExponent});
+
+  // The scaled value is off by less than one unit in the last place.
+  uint64_t Error = 1;
+  int OneShift = -W.E;
+  uint64_t OneMask = (uint64_t(1) << OneShift) - 1;
+  uint32_t Integrals = uint32_t(W.F >> OneShift);
+  uint64_t Fractionals = W.F & OneMask;
+
+  uint32_t Divisor = 1;
+  int Kappa = 1;
+  while (Kappa < 10 && Integrals / Divisor >= 10) {
+    Divisor *= 10;
+    ++Kappa;
+  }
+  if (Integrals == 0)
+    Kappa = 0;
+
+  int Length = 0;
+  while (Kappa > 0) {
+    Digits[Length++] = char('0' + Integrals / Divisor);
+    Integrals %= Divisor;
+    --Kappa;
+    if (Length == Precision) {
+      uint64_t Rest = (uint64_t(Integrals) << OneShift) + Fractionals;
+      bool Result = roundWeedCounted(Digits, Length, Rest,
+                                     uint64_t(Divisor) << OneShift, Error,
+                                     Kappa);
+      DecimalExponent = Kappa - MK;
+      return Result;
+    }
+    Divisor /= 10;
+  }
+
+  while (Length < Precision && Fractionals > Error) {
+    Fractionals *= 10;
+    Error *= 10;
+    Digits[Length++] = char('0' + (Fractionals >> OneShift));
+    Fractionals &= OneMask;
+    --Kappa;
+  }
+  if (Length != Precision)
+    return false;
+  bool Result = roundWeedCounted(Digits, Length, Fractionals, OneMask + 1,
+                                 Error, Kappa);
+  DecimalExponent = Kappa - MK;
+  return Result;
+}
+
+/// Format \p Value like printf's "%.*g" in the C locale.
+///
+/// \returns the length of the result, or -1 if \p Value can't be formatted
+///   without falling back to printf.
+static int formatFloatingPoint(char *Buffer, double Value, int Precision) {
+  if (!std::isfinite(Value))
+    return -1;
+
+  char *P = Buffer;
+  if (std::signbit(Value)) {
+    *P++ = '-';
+    Value = -Value;
+  }
+  if (Value == 0) {
+    *P++ = '0';
+    *P = '\0';
+    return int(P - Buffer);
+  }
+
+  char Digits[20];
+  int DecimalExponent;
+  if (!getDecimalDigits(Value, Precision, Digits, DecimalExponent))
+    return -1;
+
+  // Trailing zeros are dropped, like "%g" does.
+  int Length = Precision;
+  while (Length > 1 && Digits[Length - 1] == '0')
+    --Length;
+
+  int Exponent = DecimalExponent + Precision - 1;
+  if (Exponent < -4 || Exponent >= Precision) {
+    *P++ = Digits[0];
+    if (Length > 1) {
+      *P++ = '.';
+      memcpy(P, Digits + 1, Length - 1);
+      P += Length - 1;
+    }
+    *P++ = 'e';
+    *P++ = Exponent < 0 ? '-' : '+';
+    unsigned AbsExponent = Exponent < 0 ? -Exponent : Exponent;
+    if (AbsExponent >= 100)
+      *P++ = char('0' + AbsExponent / 100);
+    *P++ = char('0' + AbsExponent / 10 % 10);
+    *P++ = char('0' + AbsExponent % 10);
+  } else if (Exponent < 0) {
+    *P++ = '0';
+    *P++ = '.';
+    for (int i = -1; i != Exponent; --i)
+      *P++ = '0';
+    memcpy(P, Digits, Length);
+    P += Length;
+  } else {
+    for (int i = 0; i <= Exponent; ++i)
+      *P++ = i < Length ? Digits[i] : '0';
+    if (Length > Exponent + 1) {
+      *P++ = '.';
+      memcpy(P, Digits + Exponent + 1, Length - Exponent - 1);
+      P += Length - Exponent - 1;
+    }
+  }
+  *P = '\0';
+  return int(P - Buffer);
+}
+
+static int formatFloatingPoint(char *Buffer, long double Value,
+                               int Precision) {
+  // Float80 has too many significand bits for 64-bit digit generation.
+  return -1;
+}
+
+/// Parse a plain decimal number, [+-]digits[.digits][e[+-]digits], that
+/// makes up all of \p Str, into the significant digits and a power of ten.
+///
+/// \returns false if the text has any other form, or too many digits to
+///   fit \p Significand.
+static bool parseDecimal(const char *Str, const char *&End, bool &Negative,
+                         uint64_t &Significand, int &Exponent) {
+  const char *P = Str;
+  Negative = *P == '-';
+  if (*P == '-' || *P == '+')
+    ++P;
+
+  Significand = 0;
+  Exponent = 0;
+  int SignificantDigits = 0;
+  bool HaveDigits = false;
+  for (; *P >= '0' && *P <= '9'; ++P) {
+    HaveDigits = true;
+    if (Significand == 0 && *P == '0')
+      continue;
+    if (++SignificantDigits > 19)
+      return false;
+    Significand = Significand * 10 + (*P - '0');
+  }
+  if (*P == '.') {
+    for (++P; *P >= '0' && *P <= '9'; ++P) {
+      HaveDigits = true;
+      --Exponent;
+      if (Significand == 0 && *P == '0')
+        continue;
+      if (++SignificantDigits > 19)
+        return false;
+      Significand = Significand * 10 + (*P - '0');
+    }
+  }
+  if (!HaveDigits)
+    return false;
+
+  if (*P == 'e' || *P == 'E') {
+    ++P;
+    bool NegativeExponent = *P == '-';
+    if (*P == '-' || *P == '+')
+      ++P;
+    int ExplicitExponent = 0;
+    int ExponentDigits = 0;
+    for (; *P >= '0' && *P <= '9'; ++P) {
+      if (++ExponentDigits > 4)
+        return false;
+      ExplicitExponent = ExplicitExponent * 10 + (*P - '0');
+    }
+    if (ExponentDigits == 0)
+      return false;
+    Exponent += NegativeExponent ? -ExplicitExponent : ExplicitExponent;
+  }
+
+  End = P;
+  return *P == '\0';
+}
+
+/// Parse \p Str exactly, without strtod, if its significand and power of
+/// ten are both exactly representable in \p T (Clinger's fast path): one
+/// multiplication or division then rounds correctly.
+template <typename T>
+static bool parseFloatingPointFast(const char *Str, const char *&End,
+                                   T *OutResult) {
+  static_assert(std::numeric_limits<T>::digits < 64,
+                "the significand must fit in 64 bits");
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+  static const T PowersOfTen[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+  };
+  const int MaxExactPowerOfTen = std::numeric_limits<T>::digits > 24 ? 22 : 10;
+  const uint64_t MaxExactSignificand =
+    uint64_t(1) << std::numeric_limits<T>::digits;
+
+  bool Negative;
+  uint64_t Significand;
+  int Exponent;
+  if (!parseDecimal(Str, End, Negative, Significand, Exponent) ||
+      Significand > MaxExactSignificand ||
+      Exponent < -MaxExactPowerOfTen || Exponent > MaxExactPowerOfTen)
+    return false;
+
+  T Result = T(Significand);
+  if (Exponent < 0)
+    Result /= PowersOfTen[-Exponent];
+  else
+    Result *= PowersOfTen[Exponent];
+  *OutResult = Negative ? -Result : Result;
+  return true;
+#else
+  // With excess intermediate precision, the computation would round twice.
+  return false;
+#endif
+}
+
 template <typename T>
 static uint64_t swift_floatingPointToString(char *Buffer, size_t BufferLength,
                                             T Value, const char *Format, 
@@ -193,34 +650,39 @@ static uint64_t swift_floatingPointToString(char *Buffer, size_t BufferLength,
     Precision = std::numeric_limits<T>::max_digits10;
   }
 
+  // Most values are formatted without going through the locale-aware
+  // printf machinery.
+  int i = formatFloatingPoint(Buffer, Value, Precision);
+  if (i < 0) {
 #if defined(__CYGWIN__) || defined(_MSC_VER)
-  // Cygwin does not support uselocale(), but we can use the locale feature 
-  // in stringstream object.
-  std::ostringstream ValueStream;
-  ValueStream.width(0);
-  ValueStream.precision(Precision);
-  ValueStream.imbue(std::locale::classic());
-  ValueStream << Value;
-  std::string ValueString(ValueStream.str());
-  size_t i = ValueString.length();
+    // Cygwin does not support uselocale(), but we can use the locale feature 
+    // in stringstream object.
+    std::ostringstream ValueStream;
+    ValueStream.width(0);
+    ValueStream.precision(Precision);
+    ValueStream.imbue(std::locale::classic());
+    ValueStream << Value;
+    std::string ValueString(ValueStream.str());
+    i = ValueString.length();
 
-  if (i < BufferLength) {
-    std::copy(ValueString.begin(), ValueString.end(), Buffer);
-    Buffer[i] = '\0';
-  } else {
-    swift::crash("swift_floatingPointToString: insufficient buffer size");
-  }
+    if (size_t(i) < BufferLength) {
+      std::copy(ValueString.begin(), ValueString.end(), Buffer);
+      Buffer[i] = '\0';
+    } else {
+      swift::crash("swift_floatingPointToString: insufficient buffer size");
+    }
 #else
-  // Pass a null locale to use the C locale.
-  int i = swift_snprintf_l(Buffer, BufferLength, /*locale=*/nullptr, Format,
-                           Precision, Value);
-
-  if (i < 0)
-    swift::crash(
-        "swift_floatingPointToString: unexpected return value from sprintf");
-  if (size_t(i) >= BufferLength)
-    swift::crash("swift_floatingPointToString: insufficient buffer size");
+    // Pass a null locale to use the C locale.
+    i = swift_snprintf_l(Buffer, BufferLength, /*locale=*/nullptr, Format,
+                         Precision, Value);
+
+    if (i < 0)
+      swift::crash(
+          "swift_floatingPointToString: unexpected return value from sprintf");
+    if (size_t(i) >= BufferLength)
+      swift::crash("swift_floatingPointToString: insufficient buffer size");
 #endif
+  }
 
   // Add ".0" to a float that (a) is not in scientific notation, (b) does not
   // already have a fractional part, (c) is not infinite, and (d) is not a NaN
@@ -465,11 +927,17 @@ const char *swift::_swift_stdlib_strtold_clocale(
 
 const char *swift::_swift_stdlib_strtod_clocale(
     const char * nptr, double *outResult) {
+  const char *EndPtr;
+  if (parseFloatingPointFast(nptr, EndPtr, outResult))
+    return EndPtr;
   return _swift_stdlib_strtoX_clocale_impl(nptr, outResult);
 }
 
 const char *swift::_swift_stdlib_strtof_clocale(
     const char * nptr, float *outResult) {
+  const char *EndPtr;
+  if (parseFloatingPointFast(nptr, EndPtr, outResult))
+    return EndPtr;
   return _swift_stdlib_strtoX_clocale_impl(nptr, outResult);
 }
 #else
@@ -500,12 +968,18 @@ const char *swift::_swift_stdlib_strtold_clocale(
 
 const char *swift::_swift_stdlib_strtod_clocale(
     const char * nptr, double *outResult) {
+  const char *EndPtr;
+  if (parseFloatingPointFast(nptr, EndPtr, outResult))
+    return EndPtr;
   return _swift_stdlib_strtoX_clocale_impl(
     nptr, outResult, HUGE_VAL, strtod_l);
 }
 
 const char *swift::_swift_stdlib_strtof_clocale(
     const char * nptr, float *outResult) {
+  const char *EndPtr;
+  if (parseFloatingPointFast(nptr, EndPtr, outResult))
+    return EndPtr;
   return _swift_stdlib_strtoX_clocale_impl(
     nptr, outResult, HUGE_VALF, strtof_l);
 }
@@ -540,3 +1014,234 @@ size_t swift::_swift_stdlib_getHardwareConcurrency() {
   return sysconf(_SC_NPROCESSORS_ONLN);
 #endif
 }
+
+// The ASCII checks below work on a word at a time, which compilers also
+// turn into vector code. Unaligned words are read with memcpy.
+
+static const uint64_t ASCIIHighBits = 0x8080808080808080ULL;
+static const uint64_t ASCIIOnes = 0x0101010101010101ULL;
+
+static inline uint64_t loadASCIIWord(const uint8_t *Bytes) {
+  uint64_t Word;
+  memcpy(&Word, Bytes, sizeof(Word));
+  return Word;
+}
+
+bool swift::_swift_stdlib_isASCII(const uint8_t *Bytes, intptr_t Length) {
+  uint64_t Bits = 0;
+  intptr_t i = 0;
+  for (; i + 8 <= Length; i += 8)
+    Bits |= loadASCIIWord(Bytes + i);
+  for (; i != Length; ++i)
+    Bits |= Bytes[i];
+  return (Bits & ASCIIHighBits) == 0;
+}
+
+bool swift::_swift_stdlib_isPrintableASCII(const uint8_t *Bytes,
+                                           intptr_t Length) {
+  // A byte is printable if it is ASCII, at least 0x20 and not 0x7F. For
+  // ASCII bytes, subtracting 0x20 sets the high bit exactly for control
+  // characters, and adding 1 sets it exactly for 0x7F.
+  uint64_t Bits = 0;
+  intptr_t i = 0;
+  for (; i + 8 <= Length; i += 8) {
+    uint64_t Word = loadASCIIWord(Bytes + i);
+    uint64_t Controls =
+        ((Word | ASCIIHighBits) - 0x20 * ASCIIOnes) ^ ASCIIHighBits;
+    Bits |= Word | Controls | (Word + ASCIIOnes);
+  }
+  for (; i != Length; ++i) {
+    uint8_t Byte = Bytes[i];
+    if (Byte < 0x20 || Byte >= 0x7F)
+      return false;
+  }
+  return (Bits & ASCIIHighBits) == 0;
+}
+
+// UTF-8 <-> UTF-16 transcoding of contiguous buffers. Runs of ASCII are
+// checked and converted a word at a time; other scalars are decoded one at
+// a time without going through a generic iterator.
+
+static inline bool isUTF8Continuation(uint8_t Byte) {
+  return (Byte & 0xC0) == 0x80;
+}
+
+/// Returns the length of the well-formed UTF-8 sequence that starts at
+/// \p Bytes, or 0 if it is ill-formed. \p Remaining is at least 1.
+static inline intptr_t wellFormedUTF8SequenceLength(const uint8_t *Bytes,
+                                                    intptr_t Remaining) {
+  // See table 3-7 of the Unicode standard.
+  uint8_t Lead = Bytes[0];
+  if (Lead < 0x80)
+    return 1;
+  if (Lead < 0xC2)
+    return 0;
+  if (Lead < 0xE0)
+    return Remaining >= 2 && isUTF8Continuation(Bytes[1]) ? 2 : 0;
+  if (Lead < 0xF0) {
+    if (Remaining < 3)
+      return 0;
+    uint8_t Low = Lead == 0xE0 ? 0xA0 : 0x80;
+    uint8_t High = Lead == 0xED ? 0x9F : 0xBF;
+    return Bytes[1] >= Low && Bytes[1] <= High &&
+           isUTF8Continuation(Bytes[2]) ? 3 : 0;
+  }
+  if (Lead < 0xF5) {
+    if (Remaining < 4)
+      return 0;
+    uint8_t Low = Lead == 0xF0 ? 0x90 : 0x80;
+    uint8_t High = Lead == 0xF4 ? 0x8F : 0xBF;
+    return Bytes[1] >= Low && Bytes[1] <= High &&
+           isUTF8Continuation(Bytes[2]) &&
+           isUTF8Continuation(Bytes[3]) ? 4 : 0;
+  }
+  return 0;
+}
+
+bool swift::_swift_stdlib_measureUTF8AsUTF16(const uint8_t *Bytes,
+                                             intptr_t Length,
+                                             intptr_t *UTF16Count) {
+  intptr_t Count = 0;
+  intptr_t i = 0;
+  while (i != Length) {
+    if (i + 8 <= Length && (loadASCIIWord(Bytes + i) & ASCIIHighBits) == 0) {
+      Count += 8;
+      i += 8;
+      continue;
+    }
+    intptr_t SequenceLength = wellFormedUTF8SequenceLength(Bytes + i,
+                                                           Length - i);
+    if (SequenceLength == 0)
+      return false;
+    // Only scalars outside the BMP need a surrogate pair.
+    Count += SequenceLength == 4 ? 2 : 1;
+    i += SequenceLength;
+  }
+  *UTF16Count = Count;
+  return true;
+}
+
+void swift::_swift_stdlib_transcodeUTF8ToUTF16(const uint8_t *Bytes,
+                                               intptr_t Length,
+                                               uint16_t *Destination) {
+  intptr_t i = 0;
+  while (i != Length) {
+    if (i + 8 <= Length) {
+      uint64_t Word = loadASCIIWord(Bytes + i);
+      if ((Word & ASCIIHighBits) == 0) {
+        for (unsigned j = 0; j != 8; ++j)
+          Destination[j] = Bytes[i + j];
+        Destination += 8;
+        i += 8;
+        continue;
+      }
+    }
+    uint32_t Lead = Bytes[i];
+    if (Lead < 0x80) {
+      *Destination++ = Lead;
+      i += 1;
+    } else if (Lead < 0xE0) {
+      *Destination++ = ((Lead & 0x1F) << 6) | (Bytes[i + 1] & 0x3F);
+      i += 2;
+    } else if (Lead < 0xF0) {
+      *Destination++ = ((Lead & 0x0F) << 12) |
+                       ((Bytes[i + 1] & 0x3F) << 6) | (Bytes[i + 2] & 0x3F);
+      i += 3;
+    } else {
+      uint32_t Scalar = ((Lead & 0x07) << 18) |
+                        ((Bytes[i + 1] & 0x3F) << 12) |
+                        ((Bytes[i + 2] & 0x3F) << 6) | (Bytes[i + 3] & 0x3F);
+      Scalar -= 0x10000;
+      *Destination++ = 0xD800 | (Scalar >> 10);
+      *Destination++ = 0xDC00 | (Scalar & 0x3FF);
+      i += 4;
+    }
+  }
+}
+
+static const uint64_t UTF16ASCIIHighBits = 0xFF80FF80FF80FF80ULL;
+
+static inline uint64_t loadUTF16Word(const uint16_t *Units) {
+  uint64_t Word;
+  memcpy(&Word, Units, sizeof(Word));
+  return Word;
+}
+
+static inline bool isHighSurrogate(uint16_t Unit) {
+  return (Unit & 0xFC00) == 0xD800;
+}
+
+static inline bool isLowSurrogate(uint16_t Unit) {
+  return (Unit & 0xFC00) == 0xDC00;
+}
+
+intptr_t swift::_swift_stdlib_measureUTF16AsUTF8(const uint16_t *Units,
+                                                 intptr_t Length) {
+  intptr_t Count = 0;
+  intptr_t i = 0;
+  while (i != Length) {
+    if (i + 4 <= Length &&
+        (loadUTF16Word(Units + i) & UTF16ASCIIHighBits) == 0) {
+      Count += 4;
+      i += 4;
+      continue;
+    }
+    uint16_t Unit = Units[i];
+    if (Unit < 0x80) {
+      Count += 1;
+    } else if (Unit < 0x800) {
+      Count += 2;
+    } else if (isHighSurrogate(Unit) && i + 1 != Length &&
+               isLowSurrogate(Units[i + 1])) {
+      Count += 4;
+      i += 1;
+    } else {
+      // Unpaired surrogates are replaced with U+FFFD, which also takes three
+      // bytes.
+      Count += 3;
+    }
+    i += 1;
+  }
+  return Count;
+}
+
+void swift::_swift_stdlib_transcodeUTF16ToUTF8(const uint16_t *Units,
+                                               intptr_t Length,
+                                               uint8_t *Destination) {
+  intptr_t i = 0;
+  while (i != Length) {
+    if (i + 4 <= Length &&
+        (loadUTF16Word(Units + i) & UTF16ASCIIHighBits) == 0) {
+      for (unsigned j = 0; j != 4; ++j)
+        Destination[j] = Units[i + j];
+      Destination += 4;
+      i += 4;
+      continue;
+    }
+    uint32_t Scalar = Units[i];
+    i += 1;
+    if (Scalar < 0x80) {
+      *Destination++ = Scalar;
+      continue;
+    }
+    if (Scalar < 0x800) {
+      *Destination++ = 0xC0 | (Scalar >> 6);
+      *Destination++ = 0x80 | (Scalar & 0x3F);
+      continue;
+    }
+    if (isHighSurrogate(Scalar) && i != Length && isLowSurrogate(Units[i])) {
+      Scalar = 0x10000 + (((Scalar & 0x3FF) << 10) | (Units[i] & 0x3FF));
+      i += 1;
+      *Destination++ = 0xF0 | (Scalar >> 18);
+      *Destination++ = 0x80 | ((Scalar >> 12) & 0x3F);
+      *Destination++ = 0x80 | ((Scalar >> 6) & 0x3F);
+      *Destination++ = 0x80 | (Scalar & 0x3F);
+      continue;
+    }
+    if ((Scalar & 0xF800) == 0xD800)
+      Scalar = 0xFFFD;
+    *Destination++ = 0xE0 | (Scalar >> 12);
+    *Destination++ = 0x80 | ((Scalar >> 6) & 0x3F);
+    *Destination++ = 0x80 | (Scalar & 0x3F);
+  }
+}
@@ -19,13 +19,18 @@
 #include "swift/Runtime/Debug.h"
 
 #include <algorithm>
+#include <bitset>
 #include <mutex>
 #include <assert.h>
+#include <string.h>
 
 #include <unicode/ustring.h>
 #include <unicode/ucol.h>
 #include <unicode/ucoleitr.h>
 #include <unicode/uiter.h>
+#include <unicode/unorm2.h>
+#include <unicode/uset.h>
+#include <unicode/utf16.h>
 
 #include "../SwiftShims/UnicodeShims.h"
 
@@ -111,6 +116,182 @@ private:
   ASCIICollation(const ASCIICollation &) = delete;
 };
 
+/// This class caches the collation elements of the characters below Size
+/// which collate as one collation element with a non-zero primary weight,
+/// whatever characters surround them.
+///
+/// Such a character is in NFC and has a normalization boundary before it, so
+/// that normalization never combines or reorders it with the characters
+/// before it, and it doesn't continue a contraction. The table entries of
+/// the other characters are zero. A character which starts a contraction
+/// only collates alone if the next character is in the table too.
+class StarterCollation {
+public:
+  friend class swift::Lazy<StarterCollation>;
+
+  static swift::Lazy<StarterCollation> theTable;
+  static const StarterCollation *getTable() {
+    return &theTable.get();
+  }
+
+  /// The table covers the scripts of the BMP up to the end of Katakana.
+  enum : uint32_t { Size = 0x3100 };
+
+  int32_t CollationTable[Size];
+  std::bitset<Size> StartsContraction;
+
+  int32_t map(uint16_t c) const {
+    return c < Size ? CollationTable[c] : 0;
+  }
+
+  /// The bytes of the non-ASCII characters of UTF-8 strings are not in the
+  /// table.
+  int32_t map(unsigned char c) const {
+    return c < 0x80 ? CollationTable[c] : 0;
+  }
+
+  /// Returns true if the character at \p Index, which is in the table,
+  /// collates as its table entry.
+  template <typename Unit>
+  bool collatesAlone(const Unit *String, int32_t Length,
+                     int32_t Index) const {
+    return !StartsContraction[String[Index]] || Index + 1 == Length ||
+           map(String[Index + 1]) != 0;
+  }
+
+private:
+  /// Construct the starter collation table.
+  StarterCollation() {
+    const UCollator *Collator = GetRootCollator();
+    UErrorCode ErrorCode = U_ZERO_ERROR;
+    const UNormalizer2 *NFC = unorm2_getNFCInstance(&ErrorCode);
+    USet *Contractions = uset_openEmpty();
+    ucol_getContractionsAndExpansions(Collator, Contractions, nullptr,
+                                      /*addPrefixes=*/true, &ErrorCode);
+    if (U_FAILURE(ErrorCode)) {
+      swift::crash("Error setting up the starter collation table");
+    }
+
+    // The characters after the first one of a contraction (or after the
+    // prefix of a context-sensitive mapping) change the collation elements
+    // of the characters before them. Contractions which start outside of the
+    // table can't start with a character which passed the checks.
+    USet *Continuations = uset_openEmpty();
+    for (int32_t i = 0, e = uset_getItemCount(Contractions); i != e; ++i) {
+      UChar32 Start, End;
+      UChar Buffer[32];
+      UErrorCode ItemErrorCode = U_ZERO_ERROR;
+      int32_t Length = uset_getItem(Contractions, i, &Start, &End, Buffer,
+                                    sizeof(Buffer) / sizeof(Buffer[0]),
+                                    &ItemErrorCode);
+      if (Length == 0)
+        continue;
+      if (U_FAILURE(ItemErrorCode)) {
+        swift::crash("Error setting up the starter collation table");
+      }
+      int32_t Offset = 0;
+      UChar32 First;
+      U16_NEXT(Buffer, Offset, Length, First);
+      if (First >= (UChar32)Size)
+        continue;
+      StartsContraction[First] = true;
+      while (Offset < Length) {
+        UChar32 Next;
+        U16_NEXT(Buffer, Offset, Length, Next);
+        uset_add(Continuations, Next);
+      }
+    }
+    uset_close(Contractions);
+
+    for (uint32_t c = 0; c < Size; ++c) {
+      CollationTable[c] = 0;
+      UChar Buffer[1] = {(UChar)c};
+      UErrorCode CharErrorCode = U_ZERO_ERROR;
+      if (U16_IS_SURROGATE(c) || uset_contains(Continuations, c) ||
+          !unorm2_hasBoundaryBefore(NFC, c) ||
+          !unorm2_isNormalized(NFC, Buffer, 1, &CharErrorCode))
+        continue;
+
+      UCollationElements *CollationIterator =
+          ucol_openElements(Collator, Buffer, 1, &CharErrorCode);
+      int32_t First = ucol_next(CollationIterator, &CharErrorCode);
+      int32_t Second = ucol_next(CollationIterator, &CharErrorCode);
+      ucol_closeElements(CollationIterator);
+      if (U_FAILURE(CharErrorCode)) {
+        swift::crash("Error setting up the starter collation table");
+      }
+      if (First == UCOL_NULLORDER || Second != UCOL_NULLORDER ||
+          ucol_primaryOrder(First) == 0)
+        continue;
+      CollationTable[c] = First;
+    }
+    uset_close(Continuations);
+  }
+
+  StarterCollation &operator=(const StarterCollation &) = delete;
+  StarterCollation(const StarterCollation &) = delete;
+};
+
+/// Compares the strings by the primary weights of their characters, as long
+/// as they are in the starter collation table.
+///
+/// The collator compares the primary weights of the whole strings first. So
+/// the order of the strings is decided by the first pair of characters with
+/// different primary weights, if all the characters up to them collate alone.
+///
+/// \returns true and sets \p Result if the order is decided that way, or
+///   false if the strings have to be compared by the collator.
+template <typename LeftUnit, typename RightUnit>
+static bool compareByPrimaryWeights(const LeftUnit *LeftString,
+                                    int32_t LeftLength,
+                                    const RightUnit *RightString,
+                                    int32_t RightLength, int32_t &Result) {
+  const StarterCollation *Table = StarterCollation::getTable();
+  int32_t Length = std::min(LeftLength, RightLength);
+  bool Identical = true;
+  for (int32_t i = 0; i < Length; ++i) {
+    int32_t Left = Table->map(LeftString[i]);
+    int32_t Right = Table->map(RightString[i]);
+    if (Left == 0 || Right == 0)
+      return false;
+    if (LeftString[i] == RightString[i])
+      continue;
+    Identical = false;
+    int32_t LeftPrimary = ucol_primaryOrder(Left);
+    int32_t RightPrimary = ucol_primaryOrder(Right);
+    if (LeftPrimary == RightPrimary)
+      continue;
+    if (!Table->collatesAlone(LeftString, LeftLength, i) ||
+        !Table->collatesAlone(RightString, RightLength, i))
+      return false;
+    Result = LeftPrimary < RightPrimary ? -1 : 1;
+    return true;
+  }
+
+  // Strings with the same primary weights are ordered by their secondary and
+  // tertiary weights.
+  if (LeftLength == RightLength) {
+    if (!Identical)
+      return false;
+    Result = 0;
+    return true;
+  }
+
+  // The longer string is greater unless the rest of it is ignorable.
+  if (LeftLength > RightLength) {
+    if (Table->map(LeftString[Length]) == 0 ||
+        !Table->collatesAlone(LeftString, LeftLength, Length))
+      return false;
+    Result = 1;
+    return true;
+  }
+  if (Table->map(RightString[Length]) == 0 ||
+      !Table->collatesAlone(RightString, RightLength, Length))
+    return false;
+  Result = -1;
+  return true;
+}
+
 /// Compares the strings via the Unicode Collation Algorithm on the root locale.
 /// Results are the usual string comparison results:
 ///  <0 the left string is less than the right string.
@@ -121,6 +302,14 @@ swift::_swift_stdlib_unicode_compare_utf16_utf16(const uint16_t *LeftString,
                                                  int32_t LeftLength,
                                                  const uint16_t *RightString,
                                                  int32_t RightLength) {
+  if (LeftLength == RightLength &&
+      memcmp(LeftString, RightString, LeftLength * sizeof(uint16_t)) == 0)
+    return 0;
+  int32_t Result;
+  if (compareByPrimaryWeights(LeftString, LeftLength, RightString,
+                              RightLength, Result))
+    return Result;
+
 #if defined(__CYGWIN__) || defined(_MSC_VER)
   // ICU UChar type is platform dependent. In Cygwin, it is defined
   // as wchar_t which size is 2. It seems that the underlying binary
@@ -145,6 +334,11 @@ swift::_swift_stdlib_unicode_compare_utf8_utf16(const unsigned char *LeftString,
                                                 int32_t LeftLength,
                                                 const uint16_t *RightString,
                                                 int32_t RightLength) {
+  int32_t Result;
+  if (compareByPrimaryWeights(LeftString, LeftLength, RightString,
+                              RightLength, Result))
+    return Result;
+
   UCharIterator LeftIterator;
   UCharIterator RightIterator;
   UErrorCode ErrorCode = U_ZERO_ERROR;
@@ -175,6 +369,14 @@ swift::_swift_stdlib_unicode_compare_utf8_utf8(const unsigned char *LeftString,
                                                int32_t LeftLength,
                                                const unsigned char *RightString,
                                                int32_t RightLength) {
+  if (LeftLength == RightLength &&
+      memcmp(LeftString, RightString, LeftLength) == 0)
+    return 0;
+  int32_t Result;
+  if (compareByPrimaryWeights(LeftString, LeftLength, RightString,
+                              RightLength, Result))
+    return Result;
+
   UCharIterator LeftIterator;
   UCharIterator RightIterator;
   UErrorCode ErrorCode = U_ZERO_ERROR;
@@ -228,6 +430,15 @@ const __swift_int32_t *swift::_swift_stdlib_unicode_getASCIICollationTable() {
   return ASCIICollation::getTable()->CollationTable;
 }
 
+const __swift_int32_t *
+swift::_swift_stdlib_unicode_getStarterCollationTable() {
+  return StarterCollation::getTable()->CollationTable;
+}
+
+__swift_uint32_t swift::_swift_stdlib_unicode_getStarterCollationTableSize() {
+  return StarterCollation::Size;
+}
+
 /// Convert the unicode string to uppercase. This function will return the
 /// required buffer length as a result. If this length does not match the
 /// 'DestinationCapacity' this function must be called again with a buffer of
@@ -283,3 +494,4 @@ swift::_swift_stdlib_unicode_strToLower(uint16_t *Destination,
 }
 
 swift::Lazy<ASCIICollation> ASCIICollation::theTable;
+swift::Lazy<StarterCollation> StarterCollation::theTable;
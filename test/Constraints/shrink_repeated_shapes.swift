@@ -0,0 +1,22 @@
+// RUN: %target-parse-verify-swift
+
+// Elements of the same shape share the domains reduced for the first one.
+
+struct P {
+  init(x: Int, y: Int) {}
+  init(x: Double, y: Double) {}
+  init(x: String, y: String) {}
+}
+
+let points: [P] = [
+  P(x: 1 + 2, y: 3 * 4),
+  P(x: 1 + 2, y: 3 * 4),
+  P(x: 1.5 + 2, y: 3 * 4),
+  P(x: "a" + "b", y: "c"),
+  P(x: 1 + 2, y: 3 * 4),
+]
+
+// The contents of string literals are part of the shape, because they decide
+// whether the literal can be a Character.
+let characters: [(Character, Int)] = [("a", 1 + 1), ("b", 2 + 2)]
+let strings: [(String, Int)] = [("a", 1 + 1), ("bb", 2 + 2)]
@@ -0,0 +1,22 @@
+// RUN: %target-swift-frontend -primary-file %s -emit-ir -gdwarf-types -o - | %FileCheck %s
+
+// Types of other Swift modules are only described by their mangled name,
+// the members are only described for the types of the current module.
+
+struct Point {
+  var x: Int64
+  var y: Int64
+}
+
+// CHECK: !DIGlobalVariable(name: "p",{{.*}} type: ![[POINT:[0-9]+]]
+// CHECK: ![[POINT]] = !DICompositeType(tag: DW_TAG_structure_type,
+// CHECK-SAME:         name: "Point",{{.*}} elements: ![[ELTS:[0-9]+]],
+// CHECK-SAME:         identifier: "_TtV14external_types5Point")
+// CHECK: ![[ELTS]] = !{![[X:[0-9]+]], ![[Y:[0-9]+]]}
+// CHECK: ![[X]] = !DIDerivedType(tag: DW_TAG_member, name: "x",
+// CHECK-SAME:     baseType: ![[INT64:[0-9]+]]
+// CHECK: ![[INT64]] = !DICompositeType(tag: DW_TAG_structure_type,
+// CHECK-SAME:         name: "Int64",{{.*}} elements: ![[EMPTY:[0-9]+]],
+// CHECK-SAME:         identifier: "_TtVs5Int64")
+// CHECK: ![[EMPTY]] = !{}
+var p = Point(x: 1, y: 2)
@@ -0,0 +1,4 @@
+# Dependencies after compilation:
+provides-top-level: [a, b]
+interface-hash: "after"
+interface-hash-top-level: [[a, "same"], [b, "after"]]
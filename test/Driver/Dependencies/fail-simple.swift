@@ -21,3 +21,4 @@
 // CHECK-RECORD-DAG: "./bad.swift": !dirty [
 // CHECK-RECORD-DAG: "./main.swift": !dirty [
 // CHECK-RECORD-DAG: "./other.swift": !private [
+// CHECK-RECORD-DAG: "./bad.swift": { wall_time_ms: {{[0-9]+}}, peak_rss_kb: {{[0-9]+}}, exit_status: 1 }
@@ -0,0 +1,31 @@
+/// main ==> uses-a, main ==> uses-b
+/// Only the hash of "b" changes when main is rebuilt.
+
+// RUN: rm -rf %t && cp -r %S/Inputs/fine-grained-interface-hash/ %t
+// RUN: touch -t 201401240005 %t/*
+
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental ./main.swift ./uses-a.swift ./uses-b.swift -module-name main -j1 -v 2>&1 | %FileCheck -check-prefix=CHECK-FIRST %s
+
+// CHECK-FIRST-NOT: warning
+// CHECK-FIRST: Handled main.swift
+// CHECK-FIRST: Handled uses-a.swift
+// CHECK-FIRST: Handled uses-b.swift
+
+// RUN: cp -r %S/Inputs/fine-grained-interface-hash/*.swiftdeps %t
+// RUN: touch -t 201401240006 %t/main.swift
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental -enable-fine-grained-dependencies ./main.swift ./uses-a.swift ./uses-b.swift -module-name main -j1 -v 2>&1 | %FileCheck -check-prefix=CHECK-FINE %s
+
+// CHECK-FINE-NOT: Handled uses-a.swift
+// CHECK-FINE: Handled main.swift
+// CHECK-FINE-NOT: Handled uses-a.swift
+// CHECK-FINE: Handled uses-b.swift
+// CHECK-FINE-NOT: Handled uses-a.swift
+
+// Without fine-grained dependencies, every dependent is rebuilt.
+// RUN: cp -r %S/Inputs/fine-grained-interface-hash/*.swiftdeps %t
+// RUN: touch -t 201401240007 %t/main.swift
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental ./main.swift ./uses-a.swift ./uses-b.swift -module-name main -j1 -v 2>&1 | %FileCheck -check-prefix=CHECK-COARSE %s
+
+// CHECK-COARSE: Handled main.swift
+// CHECK-COARSE-DAG: Handled uses-a.swift
+// CHECK-COARSE-DAG: Handled uses-b.swift
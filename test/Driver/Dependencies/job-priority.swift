@@ -0,0 +1,28 @@
+// main | other
+
+// RUN: rm -rf %t && cp -r %S/Inputs/independent/ %t
+// RUN: touch -t 201401240005 %t/*
+
+// Without timings from a previous build, jobs run in input order.
+
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental ./main.swift ./other.swift -module-name main -j1 -v 2>&1 | %FileCheck -check-prefix=CHECK-IN-ORDER %s
+
+// CHECK-IN-ORDER-NOT: warning
+// CHECK-IN-ORDER: Handled main.swift
+// CHECK-IN-ORDER: Handled other.swift
+
+// RUN: %FileCheck -check-prefix=CHECK-RECORD %s < %t/main~buildrecord.swiftdeps
+
+// CHECK-RECORD: job_statistics:
+// CHECK-RECORD-DAG: "./main.swift": { wall_time_ms: {{[0-9]+}}, peak_rss_kb: {{[0-9]+}}, exit_status: 0 }
+// CHECK-RECORD-DAG: "./other.swift": { wall_time_ms: {{[0-9]+}}, peak_rss_kb: {{[0-9]+}}, exit_status: 0 }
+
+// The job that took longest last time starts first.
+
+// RUN: echo '{job_statistics: {"./main.swift": {wall_time_ms: 10}, "./other.swift": {wall_time_ms: 5000}}}' > %t/main~buildrecord.swiftdeps
+// RUN: cd %t && %swiftc_driver -c -driver-use-frontend-path %S/Inputs/update-dependencies.py -output-file-map %t/output.json -incremental ./main.swift ./other.swift -module-name main -j1 -v 2>&1 | %FileCheck -check-prefix=CHECK-SLOWEST-FIRST %s
+
+// CHECK-SLOWEST-FIRST-NOT: warning
+// CHECK-SLOWEST-FIRST: Handled other.swift
+// CHECK-SLOWEST-FIRST: Handled main.swift
+
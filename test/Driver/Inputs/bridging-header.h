@@ -0,0 +1,2 @@
+@interface Bridged
+@end
@@ -0,0 +1,21 @@
+// RUN: %swiftc_driver -driver-print-actions -import-objc-header %S/Inputs/bridging-header.h -pch-output-dir %t/pch %s 2>&1 | %FileCheck %s -check-prefix=YESPCHACT
+// YESPCHACT: 0: input, "{{.*}}bridging-pch.swift", swift
+// YESPCHACT: 1: input, "{{.*}}Inputs/bridging-header.h", objc-header
+// YESPCHACT: 2: generate-pch, {1}, pch
+// YESPCHACT: 3: compile, {0, 2}, object
+// YESPCHACT: 4: link, {3}, image
+
+// RUN: %swiftc_driver -driver-print-actions -import-objc-header %S/Inputs/bridging-header.h %s 2>&1 | %FileCheck %s -check-prefix=NOPCHACT
+// NOPCHACT-NOT: generate-pch
+// NOPCHACT: 0: input, "{{.*}}bridging-pch.swift", swift
+// NOPCHACT: 1: compile, {0}, object
+
+// RUN: %swiftc_driver -driver-print-jobs -import-objc-header %S/Inputs/bridging-header.h -pch-output-dir %t/pch %s %S/Inputs/main.swift 2>&1 | %FileCheck %s -check-prefix=YESPCHJOB
+// YESPCHJOB: {{.*}}swift -frontend -emit-pch {{.*}}Inputs/bridging-header.h{{.*}} -o {{.*}}pch{{/|\\\\}}bridging-header-{{[0-9a-f]+}}.pch
+// YESPCHJOB: {{.*}}swift -frontend {{.*}}-import-objc-header {{.*}}Inputs/bridging-header.h{{.*}} -bridging-header-pch {{.*}}bridging-header-{{[0-9a-f]+}}.pch
+// YESPCHJOB: {{.*}}swift -frontend {{.*}}-import-objc-header {{.*}}Inputs/bridging-header.h{{.*}} -bridging-header-pch {{.*}}bridging-header-{{[0-9a-f]+}}.pch
+// YESPCHJOB-NOT: -emit-pch
+
+// RUN: %swiftc_driver -driver-print-jobs -import-objc-header %S/Inputs/bridging-header.h -pch-output-dir %t/pch -whole-module-optimization %s %S/Inputs/main.swift 2>&1 | %FileCheck %s -check-prefix=WMOJOB
+// WMOJOB: {{.*}}swift -frontend -emit-pch
+// WMOJOB: {{.*}}swift -frontend -c {{.*}}-bridging-header-pch {{.*}}.pch
@@ -0,0 +1,38 @@
+// RUN: %swiftc_driver_plain -emit-executable %s %S/Inputs/lib.swift -o %t.out -compact-parseable-output -driver-skip-execution 2>&1 | %FileCheck %s
+
+// XFAIL: freebsd, linux
+
+// CHECK: {{[1-9][0-9]*}}
+// CHECK-NEXT: {
+// CHECK-NEXT:   "kind": "inputs",
+// CHECK-NEXT:   "name": "compilation",
+// CHECK-NEXT:   "inputs": [
+// CHECK-NEXT:     "{{.*}}/compact_parseable_output.swift",
+// CHECK-NEXT:     "{{.*}}/Inputs/lib.swift"
+// CHECK-NEXT:   ],
+// CHECK-NEXT:   "filelist": "{{.*}}/sources{{[^"]*}}"
+// CHECK-NEXT: }
+
+// CHECK: "kind": "began",
+// CHECK-NEXT:   "name": "compile",
+// CHECK-NEXT:   "command": "{{.*}}/swift{{c?}} -frontend -c -filelist {{[^ ]*}}/sources{{[^ ]*}} -primary-file {{.*}}/compact_parseable_output.swift {{.*}}",
+// CHECK-NEXT:   "input-indices": [
+// CHECK-NEXT:     0
+// CHECK-NEXT:   ],
+// CHECK-NEXT:   "outputs": [
+
+// CHECK: "kind": "began",
+// CHECK-NEXT:   "name": "compile",
+// CHECK-NEXT:   "command": "{{.*}}/swift{{c?}} -frontend -c -filelist {{[^ ]*}}/sources{{[^ ]*}} -primary-file {{.*}}/Inputs/lib.swift {{.*}}",
+// CHECK-NEXT:   "input-indices": [
+// CHECK-NEXT:     1
+// CHECK-NEXT:   ],
+// CHECK-NEXT:   "outputs": [
+
+// CHECK: "kind": "began",
+// CHECK-NEXT:   "name": "link",
+// CHECK-NEXT:   "command": "{{.*}}",
+// CHECK-NEXT:   "inputs": [
+// CHECK-NEXT:     "{{.*}}/compact_parseable_output-{{.*}}.o",
+// CHECK-NEXT:     "{{.*}}/lib-{{.*}}.o"
+// CHECK-NEXT:   ],
@@ -73,6 +73,7 @@
 // COMPLEX-DAG: -F /path/to/frameworks -F /path/to/more/frameworks
 // COMPLEX-DAG: -I /path/to/headers -I path/to/more/headers
 // COMPLEX-DAG: -module-cache-path /tmp/modules
+// COMPLEX-DAG: -clang-build-session-timestamp {{[0-9]+}}
 // COMPLEX-DAG: -emit-reference-dependencies-path {{(.*/)?driver-compile[^ /]+}}.swiftdeps
 // COMPLEX: -o {{.+}}.o
 
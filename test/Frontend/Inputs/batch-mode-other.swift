@@ -0,0 +1,3 @@
+func batchOther() -> Int {
+  return batchMain() + 1
+}
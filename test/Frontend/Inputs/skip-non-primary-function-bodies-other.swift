@@ -0,0 +1,9 @@
+struct Helper {
+  var value: Int
+}
+
+func makeHelper() -> Helper {
+  // This body is only valid if it is never parsed.
+  let x = = 1
+  return Helper(value: x)
+}
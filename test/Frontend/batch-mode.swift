@@ -0,0 +1,37 @@
+// RUN: rm -rf %t && mkdir -p %t
+
+// RUN: %target-swift-frontend -emit-ir -primary-file %s -primary-file %S/Inputs/batch-mode-other.swift -module-name main -o %t/batch-mode.ll -o %t/batch-mode-other.ll
+// RUN: %FileCheck -check-prefix=CHECK-MAIN %s < %t/batch-mode.ll
+// RUN: %FileCheck -check-prefix=CHECK-OTHER %s < %t/batch-mode-other.ll
+
+// CHECK-MAIN: define{{.*}} @_TF4main9batchMainFT_Si(
+// CHECK-MAIN-NOT: define{{.*}} @_TF4main10batchOtherFT_Si(
+// CHECK-OTHER: define{{.*}} @_TF4main10batchOtherFT_Si(
+// CHECK-OTHER-NOT: define{{.*}} @_TF4main9batchMainFT_Si(
+
+// RUN: %target-swift-frontend -parse -primary-file %s -primary-file %S/Inputs/batch-mode-other.swift -module-name main -emit-reference-dependencies-path %t/batch-mode.swiftdeps -emit-reference-dependencies-path %t/batch-mode-other.swiftdeps
+// RUN: %FileCheck -check-prefix=CHECK-MAIN-DEPS %s < %t/batch-mode.swiftdeps
+// RUN: %FileCheck -check-prefix=CHECK-OTHER-DEPS %s < %t/batch-mode-other.swiftdeps
+
+// CHECK-MAIN-DEPS-LABEL: provides-top-level:
+// CHECK-MAIN-DEPS-NEXT: - "batchMain"
+// CHECK-OTHER-DEPS-LABEL: provides-top-level:
+// CHECK-OTHER-DEPS-NEXT: - "batchOther"
+// CHECK-OTHER-DEPS-LABEL: depends-top-level:
+// CHECK-OTHER-DEPS: - "batchMain"
+
+// RUN: not %target-swift-frontend -emit-ir -primary-file %s -primary-file %S/Inputs/batch-mode-other.swift -o %t/batch-mode.ll 2>&1 | %FileCheck -check-prefix=CHECK-OUTPUT-COUNT %s
+// CHECK-OUTPUT-COUNT: error: expected one '-o' for each of the 2 primary files, but got 1
+
+// RUN: not %target-swift-frontend -parse -primary-file %s -primary-file %S/Inputs/batch-mode-other.swift -emit-reference-dependencies-path %t/batch-mode.swiftdeps 2>&1 | %FileCheck -check-prefix=CHECK-DEPS-COUNT %s
+// CHECK-DEPS-COUNT: error: expected one '-emit-reference-dependencies-path' for each of the 2 primary files, but got 1
+
+// RUN: not %target-swift-frontend -dump-ast -primary-file %s -primary-file %S/Inputs/batch-mode-other.swift 2>&1 | %FileCheck -check-prefix=CHECK-ACTION %s
+// CHECK-ACTION: error: this mode does not support more than one -primary-file
+
+// RUN: not %target-swift-frontend -emit-object -primary-file %s -primary-file %S/Inputs/batch-mode-other.swift -o %t/batch-mode.o -o %t/batch-mode-other.o -emit-dependencies-path %t/batch-mode.d 2>&1 | %FileCheck -check-prefix=CHECK-UNSUPPORTED-OUTPUT %s
+// CHECK-UNSUPPORTED-OUTPUT: error: '-emit-dependencies' is not supported with more than one -primary-file
+
+func batchMain() -> Int {
+  return 0
+}
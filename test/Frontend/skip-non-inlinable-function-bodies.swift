@@ -0,0 +1,49 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend -parse -experimental-skip-non-inlinable-function-bodies %s
+// RUN: %target-swift-frontend -emit-module -experimental-skip-non-inlinable-function-bodies -module-name Skip -o %t/Skip.swiftmodule %s
+// RUN: not %target-swift-frontend -parse %s 2>&1 | %FileCheck -check-prefix=CHECKED %s
+
+// The bodies of transparent and always-inline functions are still checked.
+// RUN: not %target-swift-frontend -parse -experimental-skip-non-inlinable-function-bodies -D BAD_INLINABLE_BODIES %s 2>&1 | %FileCheck -check-prefix=INLINABLE %s
+
+// Modes that need every body can't skip any.
+// RUN: not %target-swift-frontend -emit-sil -experimental-skip-non-inlinable-function-bodies %s 2>&1 | %FileCheck -check-prefix=UNSUPPORTED %s
+
+// CHECKED: skip-non-inlinable-function-bodies.swift:[[@LINE+7]]:{{[0-9]+}}: error:
+// UNSUPPORTED: error: this mode does not support skipping function bodies
+
+public struct Value {
+  public var number: Int
+
+  public func describe() -> String {
+    let text: Int = "this body is only valid if it is never type-checked"
+    struct Local {
+      var closure = { (x: Int) -> Int in x }
+    }
+    return String(text) + String(Local().closure(number))
+  }
+
+  @_transparent
+  public var doubled: Int {
+#if BAD_INLINABLE_BODIES
+    // INLINABLE: skip-non-inlinable-function-bodies.swift:[[@LINE+1]]:{{[0-9]+}}: error:
+    return "not an integer"
+#else
+    return number * 2
+#endif
+  }
+
+  @inline(__always)
+  public func tripled() -> Int {
+#if BAD_INLINABLE_BODIES
+    // INLINABLE: skip-non-inlinable-function-bodies.swift:[[@LINE+1]]:{{[0-9]+}}: error:
+    return "not an integer"
+#else
+    return number * 3
+#endif
+  }
+
+  public init(number: Int) {
+    self.number = number
+  }
+}
@@ -0,0 +1,11 @@
+// RUN: %target-swift-frontend -parse -primary-file %s %S/Inputs/skip-non-primary-function-bodies-other.swift -skip-non-primary-function-bodies
+// RUN: not %target-swift-frontend -parse -primary-file %s %S/Inputs/skip-non-primary-function-bodies-other.swift 2>&1 | %FileCheck %s
+
+// The bodies of the primary file are still parsed and type-checked.
+// RUN: not %target-swift-frontend -parse -primary-file %S/Inputs/skip-non-primary-function-bodies-other.swift %s -skip-non-primary-function-bodies 2>&1 | %FileCheck %s
+
+// CHECK: skip-non-primary-function-bodies-other.swift:{{[0-9]+}}:{{[0-9]+}}: error:
+
+func useHelper() -> Int {
+  return makeHelper().value
+}
@@ -0,0 +1,20 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend -emit-ir %s -o /dev/null -trace-output=%t/trace.json
+// RUN: %FileCheck %s < %t/trace.json
+// RUN: not %target-swift-frontend -parse %s -trace-output %t/missing/trace.json 2>&1 | %FileCheck -check-prefix=CHECK-ERROR %s
+
+// CHECK: {"traceEvents":[
+// CHECK-DAG: {"name":"Parsing","cat":"phase","ph":"X","ts":{{[0-9]+}},"dur":{{[0-9]+}},"pid":1,"tid":1}
+// CHECK-DAG: {"name":"Type checking / Semantic analysis","cat":"phase",
+// CHECK-DAG: {"name":"func twice{{.*}} at {{.*}}trace-output.swift:18:6","cat":"typecheck",
+// CHECK-DAG: {"name":"_TF4main5twiceFSiSi","cat":"silgen",
+// CHECK-DAG: {"name":"_TF4main5twiceFSiSi","cat":"irgen",
+// CHECK-DAG: {"name":"SILGen","cat":"phase",
+// CHECK-DAG: {"name":"IRGen","cat":"phase",
+// CHECK: ],"displayTimeUnit":"ms"}
+
+// CHECK-ERROR: error: error opening '{{.*}}trace.json' for output
+
+func twice(_ x: Int) -> Int {
+  return x + x
+}
@@ -0,0 +1,21 @@
+// RUN: %target-swift-frontend -emit-sil -sil-verify-all -verifier-workers 4 %s -o /dev/null
+// RUN: not %target-swift-frontend -parse -verifier-workers 0 %s 2>&1 | %FileCheck %s
+
+// CHECK: error: invalid value '0' in '-verifier-workers 0'
+
+public struct Point {
+  public var x: Int
+  public var y: Int
+}
+
+public func add(_ a: Point, _ b: Point) -> Point {
+  return Point(x: a.x + b.x, y: a.y + b.y)
+}
+
+public func scale(_ p: Point, by factor: Int) -> Point {
+  return Point(x: p.x * factor, y: p.y * factor)
+}
+
+public func sum(_ points: [Point]) -> Point {
+  return points.reduce(Point(x: 0, y: 0), add)
+}
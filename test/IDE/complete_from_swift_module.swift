@@ -36,6 +36,9 @@
 // rdar://15305873 Code completion: implement proper shadowing of declarations represented by cached results
 // FIXME: %FileCheck %s -check-prefix=TOP_LEVEL_1_NEGATIVE < %t.compl.txt
 
+// RUN: %target-swift-ide-test -code-completion -source-filename %s -I %t -code-completion-token=CACHED_TYPE_RELATION_1 | %FileCheck %s -check-prefix=CACHED_TYPE_RELATION_1
+// RUN: %target-swift-ide-test -code-completion -source-filename %s -I %S/Inputs -enable-source-import -code-completion-token=CACHED_TYPE_RELATION_1 | %FileCheck %s -check-prefix=CACHED_TYPE_RELATION_1
+
 // ERROR_COMMON: found code completion token
 // ERROR_COMMON-NOT: Begin completions
 
@@ -98,3 +101,12 @@ func testPostfixOperator1(x: Int) {
 // TOP_LEVEL_1-DAG: Decl[GlobalVar]/Local:     hiddenImport[#Int#]{{; name=.+$}}
 // TOP_LEVEL_1-DAG: Decl[GlobalVar]/OtherModule[foo_swift_module]:     globalVar[#Int#]{{; name=.+$}}
 // TOP_LEVEL_1: End completions
+
+// Cached results from other modules are ranked against the expected type.
+func testCachedTypeRelation1() {
+  let _: Int = #^CACHED_TYPE_RELATION_1^#
+}
+// CACHED_TYPE_RELATION_1: Begin completions
+// CACHED_TYPE_RELATION_1-DAG: Decl[GlobalVar]/OtherModule[foo_swift_module]/TypeRelation[Identical]: globalVar[#Int#]{{; name=.+$}}
+// CACHED_TYPE_RELATION_1-DAG: Decl[FreeFunction]/OtherModule[foo_swift_module]: visibleImport()[#Void#]{{; name=.+$}}
+// CACHED_TYPE_RELATION_1: End completions
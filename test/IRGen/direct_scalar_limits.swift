@@ -0,0 +1,18 @@
+// RUN: %target-swift-frontend -primary-file %s -emit-ir | %FileCheck %s --check-prefix=DEFAULT
+// RUN: %target-swift-frontend -primary-file %s -emit-ir -max-direct-result-scalars 4 -max-direct-parameter-scalars 4 | %FileCheck %s --check-prefix=FOUR
+
+// REQUIRES: CPU=x86_64
+
+struct Quad {
+  var a, b, c, d: Int
+}
+
+// DEFAULT-LABEL: define hidden void @_TF20direct_scalar_limits8makeQuadFT_VS_4Quad(%V20direct_scalar_limits4Quad* noalias nocapture sret)
+// FOUR-LABEL: define hidden { i64, i64, i64, i64 } @_TF20direct_scalar_limits8makeQuadFT_VS_4Quad()
+func makeQuad() -> Quad {
+  return Quad(a: 1, b: 2, c: 3, d: 4)
+}
+
+// DEFAULT-LABEL: define hidden void @_TF20direct_scalar_limits8takeQuadFVS_4QuadT_(%V20direct_scalar_limits4Quad*
+// FOUR-LABEL: define hidden void @_TF20direct_scalar_limits8takeQuadFVS_4QuadT_(i64, i64, i64, i64)
+func takeQuad(_ q: Quad) {}
@@ -0,0 +1,15 @@
+// RUN: %target-swift-frontend -emit-ir %s -o /dev/null -print-stats 2>&1 | %FileCheck %s
+// RUN: %target-swift-frontend -emit-ir %s -o /dev/null -wmo -num-threads 2 -print-stats 2>&1 | %FileCheck %s
+// REQUIRES: asserts
+
+// The SIL function bodies are dropped once the module is lowered to IR.
+// CHECK: {{[1-9][0-9]*}} irgen{{ *}}- Number of SIL function bodies freed after IRGen
+// CHECK: {{[1-9][0-9]*}} irgen{{ *}}- Number of SIL instructions freed after IRGen
+
+func twice(_ x: Int) -> Int {
+  return x + x
+}
+
+public func quadruple(_ x: Int) -> Int {
+  return twice(twice(x))
+}
@@ -0,0 +1,52 @@
+// RUN: %target-swift-frontend -enable-generic-metadata-prespecialization -emit-ir -parse-stdlib -primary-file %s | %FileCheck %s
+
+struct Foo {}
+class Bar {}
+
+protocol P {}
+extension Foo : P {}
+
+// The layout of these structs does not depend on their generic arguments.
+struct Ref<T> {
+  var address: Builtin.RawPointer
+}
+
+struct ConstrainedRef<T : P> {
+  var address: Builtin.RawPointer
+}
+
+// The layout of this struct depends on its generic argument.
+struct Inline<T> {
+  var value: T
+}
+
+// CHECK: @prespecialized_metadata_Ref = private global
+// CHECK: @prespecialized_arguments_Ref = private constant [1 x i8*] [i8* bitcast ({{.*}}@_TMfV{{.*}}3Foo{{.*}} to i8*)]
+// CHECK: @prespecialized_metadata_ConstrainedRef = private global
+// CHECK: @prespecialized_arguments_ConstrainedRef = private constant [2 x i8*] [i8* bitcast ({{.*}}@_TMfV{{.*}}3Foo{{.*}} to i8*), i8* bitcast ({{.*}}@_TWPV{{.*}}3Foo{{.*}}1P{{.*}} to i8*)]
+
+func use<T>(_: T.Type) {}
+
+func makeMetatypes() {
+  use(Ref<Foo>.self)
+  use(Inline<Foo>.self)
+  use(Ref<Bar>.self)
+  use(ConstrainedRef<Foo>.self)
+}
+
+// CHECK-LABEL: define linkonce_odr hidden %swift.type* @_TMaGV{{.*}}3RefV{{.*}}3Foo_()
+// CHECK:   call %swift.type* @swift_getPrespecializedGenericMetadata(%swift.type_pattern* {{.*}}@_TMPV{{.*}}3Ref{{.*}}, i8* bitcast ([1 x i8*]* @prespecialized_arguments_Ref to i8*), %swift.type* bitcast ({{.*}}@prespecialized_metadata_Ref{{.*}} to %swift.type*))
+
+// Metadata with a dependent layout is still instantiated at runtime.
+// CHECK-LABEL: define linkonce_odr hidden %swift.type* @_TMaGV{{.*}}6InlineV{{.*}}3Foo_()
+// CHECK-NOT:   swift_getPrespecializedGenericMetadata
+// CHECK:   call %swift.type* @_TMaV{{.*}}6Inline(
+
+// Class metadata needs to be initialized at runtime, so it can't be used
+// in a constant.
+// CHECK-LABEL: define linkonce_odr hidden %swift.type* @_TMaGV{{.*}}3RefC{{.*}}3Bar_()
+// CHECK-NOT:   swift_getPrespecializedGenericMetadata
+// CHECK:   call %swift.type* @_TMaV{{.*}}3Ref(
+
+// CHECK-LABEL: define linkonce_odr hidden %swift.type* @_TMaGV{{.*}}14ConstrainedRefV{{.*}}3Foo_()
+// CHECK:   call %swift.type* @swift_getPrespecializedGenericMetadata(%swift.type_pattern* {{.*}}@_TMPV{{.*}}14ConstrainedRef{{.*}}, i8* bitcast ([2 x i8*]* @prespecialized_arguments_ConstrainedRef to i8*), %swift.type* bitcast ({{.*}}@prespecialized_metadata_ConstrainedRef{{.*}} to %swift.type*))
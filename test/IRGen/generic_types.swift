@@ -11,7 +11,7 @@ import Swift
 // CHECK: [[D:%C13generic_types1D]] = type
 
 // CHECK-LABEL: @_TMPC13generic_types1A = hidden global
-// CHECK:   %swift.type* (%swift.type_pattern*, i8**)* @create_generic_metadata_A,
+// CHECK:   i{{32|64}} sub (i{{32|64}} ptrtoint (%swift.type* (%swift.type_pattern*, i8**)* @create_generic_metadata_A to i{{32|64}}), i{{32|64}} ptrtoint ({{.*}} @_TMPC13generic_types1A to i{{32|64}})),
 // CHECK-native-SAME: i32 160,
 // CHECK-objc-SAME:   i32 344,
 // CHECK-SAME:   i16 1,
@@ -37,7 +37,7 @@ import Swift
 // CHECK-SAME:   %C13generic_types1A* (i64, %C13generic_types1A*)* @_TFC13generic_types1AcfT1ySi_GS0_x_
 // CHECK-SAME: }
 // CHECK-LABEL: @_TMPC13generic_types1B = hidden global
-// CHECK-SAME:   %swift.type* (%swift.type_pattern*, i8**)* @create_generic_metadata_B,
+// CHECK-SAME:   i{{32|64}} sub (i{{32|64}} ptrtoint (%swift.type* (%swift.type_pattern*, i8**)* @create_generic_metadata_B to i{{32|64}}), i{{32|64}} ptrtoint ({{.*}} @_TMPC13generic_types1B to i{{32|64}})),
 // CHECK-native-SAME: i32 152,
 // CHECK-objc-SAME:   i32 336,
 // CHECK-SAME:   i16 1,
@@ -0,0 +1,16 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend -c %s -o %t/first.o -module-name test -llvm-object-cache-path %t/cache
+// RUN: ls %t/cache | %FileCheck %s
+
+// A compilation of the same IR to a different output file copies the cached
+// object file.
+// RUN: %target-swift-frontend -c %s -o %t/second.o -module-name test -llvm-object-cache-path %t/cache
+// RUN: cmp %t/first.o %t/second.o
+// RUN: ls %t/cache | %FileCheck %s
+
+// CHECK: {{^[0-9a-f]+}}.o
+// CHECK-NOT: .o
+
+public func foo() -> Int {
+  return 27
+}
@@ -0,0 +1,22 @@
+// RUN: %target-swift-frontend -primary-file %s -emit-ir -O -num-threads 4 -module-name test | %FileCheck %s
+
+// Outside of whole-module compilation the single LLVM module is split into
+// partitions which are optimized in parallel and linked back together.
+
+// CHECK-DAG: define{{.*}} @_TF4test6publicFSiSi(
+public func public(_ x: Int) -> Int {
+  return privateAdd(x) &* 3
+}
+
+// CHECK-DAG: define{{.*}} @_TF4test7public2FSiSi(
+public func public2(_ x: Int) -> Int {
+  return privateAdd(x) &+ public(x)
+}
+
+@inline(never)
+private func privateAdd(_ x: Int) -> Int {
+  return x &+ 27
+}
+
+// CHECK-DAG: @_TF4test12publicGlobalSi
+public var publicGlobal = 42
@@ -0,0 +1,45 @@
+// RUN: %target-swift-frontend -primary-file %s -emit-ir | %FileCheck %s
+
+protocol Runcible {
+  func runce()
+}
+
+protocol Spoon {
+  func stir()
+}
+
+// Records are grouped by protocol, in the order in which the protocols are
+// first conformed to.
+
+// CHECK-LABEL: @"\01l_protocol_conformances" = private constant [4 x %swift.protocol_conformance] [
+// CHECK:         %swift.protocol_conformance {
+// CHECK-SAME:      @_TMp24protocol_conformance_index8Runcible
+// CHECK-SAME:      @_TWPV24protocol_conformance_index1AS_8Runcible
+// CHECK:         %swift.protocol_conformance {
+// CHECK-SAME:      @_TMp24protocol_conformance_index8Runcible
+// CHECK-SAME:      @_TWPV24protocol_conformance_index1BS_8Runcible
+// CHECK:         %swift.protocol_conformance {
+// CHECK-SAME:      @_TMp24protocol_conformance_index5Spoon
+// CHECK-SAME:      @_TWPV24protocol_conformance_index1AS_5Spoon
+// CHECK:         %swift.protocol_conformance {
+// CHECK-SAME:      @_TMp24protocol_conformance_index5Spoon
+// CHECK-SAME:      @_TWPV24protocol_conformance_index1BS_5Spoon
+// CHECK:       ]
+
+// The index has one entry per protocol, giving the first record and the
+// number of records.
+
+// CHECK-LABEL: @"\01l_protocol_conformance_index" = private constant [2 x %swift.protocol_conformance_index_entry] [
+// CHECK-SAME:    %swift.protocol_conformance_index_entry { i32 {{.*}}@"\01l_protocol_conformances"{{.*}}, i32 2 }
+// CHECK-SAME:    %swift.protocol_conformance_index_entry { i32 {{.*}}@"\01l_protocol_conformances", i32 0, i32 2{{.*}}, i32 2 }
+// CHECK-SAME:  ], section "{{[^"]*(__swift2_protidx|.swift2_protocol_conformance_index|.sw2prti)[^"]*}}"
+
+struct A: Runcible, Spoon {
+  func runce() {}
+  func stir() {}
+}
+
+struct B: Runcible, Spoon {
+  func runce() {}
+  func stir() {}
+}
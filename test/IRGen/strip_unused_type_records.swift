@@ -0,0 +1,38 @@
+// RUN: %target-swift-frontend %s -emit-ir -strip-unused-type-records | %FileCheck %s
+// RUN: %target-swift-frontend %s -emit-ir | %FileCheck %s --check-prefix=ALL
+
+// Internal types which the runtime can't encounter don't get conformance,
+// type metadata and field metadata records. Their metadata is still emitted,
+// and can be dead-stripped by the linker.
+
+protocol Runcible {
+  func runce()
+}
+
+// CHECK-LABEL: @"\01l_protocol_conformances" = private constant [
+// CHECK-NOT:     _TMfV25strip_unused_type_records6Unused
+// CHECK:         @_TWPV25strip_unused_type_records5BoxedS_8Runcible
+// CHECK-NOT:     _TMfV25strip_unused_type_records6Unused
+// CHECK:         @_TWPV25strip_unused_type_records10PublicTypeS_8Runcible
+// CHECK-NOT:     _TMfV25strip_unused_type_records6Unused
+// CHECK:       ]
+
+// ALL-LABEL:   @"\01l_protocol_conformances" = private constant [
+// ALL:           @_TWPV25strip_unused_type_records6UnusedS_8Runcible
+// ALL:         ]
+
+struct Unused : Runcible {
+  func runce() {}
+}
+
+struct Boxed : Runcible {
+  func runce() {}
+}
+
+public struct PublicType : Runcible {
+  func runce() {}
+}
+
+func makeRuncible() -> Runcible {
+  return Boxed()
+}
@@ -0,0 +1,20 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-jit-run -llvm-object-cache-path %t/cache %s | %FileCheck %s
+// RUN: ls %t/cache | %FileCheck -check-prefix=CACHE %s
+
+// An unchanged script runs from the cached object file.
+// RUN: %target-jit-run -llvm-object-cache-path %t/cache %s | %FileCheck %s
+// RUN: ls %t/cache | %FileCheck -check-prefix=CACHE %s
+
+// REQUIRES: executable_test
+// REQUIRES: swift_interpreter
+
+// CACHE: {{^immediate-[0-9a-f]+}}.o
+// CACHE-NOT: .o
+
+func fib(_ n: Int) -> Int {
+  return n < 2 ? n : fib(n - 1) + fib(n - 2)
+}
+
+// CHECK: 55
+print(fib(10))
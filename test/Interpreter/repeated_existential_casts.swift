@@ -0,0 +1,75 @@
+// RUN: %target-run-simple-swift | %FileCheck %s
+// REQUIRES: executable_test
+
+// Casts between the same pair of types are answered from a cache after the
+// first lookup. Make sure repeated casts keep producing the right witness
+// tables, and that failed casts are not cached as successes.
+
+protocol Named {
+  var name: String { get }
+}
+
+protocol Counted {
+  var count: Int { get }
+}
+
+struct Apple : Named, Counted {
+  var name: String { return "apple" }
+  var count: Int { return 3 }
+}
+
+struct Pear : Named {
+  var name: String { return "pear" }
+}
+
+class Basket : Named {
+  var name: String { return "basket" }
+}
+
+class BigBasket : Basket, Counted {
+  override var name: String { return "big basket" }
+  var count: Int { return 12 }
+}
+
+func describe(_ x: Any) -> String {
+  if let nc = x as? Named & Counted {
+    return "\(nc.name) x\(nc.count)"
+  }
+  if let n = x as? Named {
+    return n.name
+  }
+  return "unknown"
+}
+
+for _ in 0..<3 {
+  // CHECK: apple x3
+  // CHECK-NEXT: pear
+  // CHECK-NEXT: basket
+  // CHECK-NEXT: big basket x12
+  // CHECK-NEXT: unknown
+  print(describe(Apple()))
+  print(describe(Pear()))
+  print(describe(Basket()))
+  print(describe(BigBasket()))
+  print(describe(42))
+}
+
+// CHECK: class existential: big basket x12
+// CHECK-NEXT: class existential: big basket x12
+let object: AnyObject = BigBasket()
+for _ in 0..<2 {
+  if let nc = object as? AnyObject & Named & Counted {
+    print("class existential: \(nc.name) x\(nc.count)")
+  }
+}
+
+// CHECK: class existential: basket is not counted
+// CHECK-NEXT: class existential: basket is not counted
+let partial: AnyObject = Basket()
+for _ in 0..<2 {
+  if partial is AnyObject & Named & Counted {
+    print("class existential: basket is counted")
+  } else {
+    print("class existential: basket is not counted")
+  }
+}
@@ -0,0 +1,43 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-build-swift %s -o %t/main
+// RUN: env SWIFT_RUNTIME_STATS=1 %target-run %t/main 2>&1 | %FileCheck %s
+// RUN: env SWIFT_RUNTIME_STATS=0 %target-run %t/main 2>&1 | %FileCheck %s -check-prefix=DISABLED
+// REQUIRES: executable_test
+
+protocol Named {
+  var name: String { get }
+}
+
+class Box<T> : Named {
+  var name: String { return "box" }
+}
+
+weak var weakBox: Box<Int>?
+let box = Box<Int>()
+weakBox = box
+
+var loads = 0
+for _ in 0..<3 {
+  if weakBox != nil {
+    loads += 1
+  }
+}
+
+let any: Any = box
+if let named = any as? Named {
+  // CHECK: box
+  // DISABLED: box
+  print(named.name)
+}
+
+// CHECK:      Swift runtime statistics:
+// CHECK-NEXT: {{[1-9][0-9]*}} {{.*}}  generic metadata instantiations
+// CHECK-NEXT: {{[0-9]+}} {{.*}}  conformance cache misses
+// CHECK-NEXT: {{[0-9]+}} {{.*}}  conformance records scanned
+// CHECK-NEXT: {{[1-9][0-9]*}} {{.*}}  dynamic casts
+// CHECK-NEXT: {{[0-9]+}} {{.*}}  dynamic cast conformance cache hits
+// CHECK-NEXT: {{[1-9][0-9]*}} {{.*}}  dynamic cast conformance cache misses
+// CHECK-NEXT: {{[0-9]+}} {{.*}}  dynamic casts through Objective-C bridging
+// CHECK-NEXT: {{[3-9]|[1-9][0-9]+}} {{.*}}  weak reference loads
+
+// DISABLED-NOT: Swift runtime statistics
@@ -19,6 +19,8 @@ declare void @noread_user(%swift.refcounted*) readnone
 declare void @user(%swift.refcounted*)
 declare void @noread_user_bridged(%swift.bridge*) readnone
 declare void @user_bridged(%swift.bridge*)
+declare void @argmem_user(i8*) argmemonly
+declare void @argmem_user_ref(%swift.refcounted*) argmemonly
 
 ; CHECK-LABEL: define{{( protected)?}} void @fixlifetime_removal(i8*) {
 ; CHECK-NOT: call void swift_fixLifetime
@@ -572,6 +574,67 @@ bb3:
   ret %swift.bridge* %A
 }
 
+; Retains and releases are merged across a straight-line chain of blocks.
+; CHECK-LABEL: define{{( protected)?}} void @swift_contractRetainReleaseNAcrossBlocks(%swift.refcounted* %A) {
+; CHECK: entry:
+; CHECK-NEXT: tail call void @rt_swift_retain_n(%swift.refcounted* %A, i32 2)
+; CHECK-NEXT: br label %bb1
+; CHECK: bb1:
+; CHECK-NEXT: br label %bb2
+; CHECK: bb2:
+; CHECK-NEXT: tail call void @rt_swift_release_n(%swift.refcounted* %A, i32 2)
+; CHECK-NEXT: ret void
+define void @swift_contractRetainReleaseNAcrossBlocks(%swift.refcounted* %A) {
+entry:
+  tail call void @rt_swift_retain(%swift.refcounted* %A)
+  br label %bb1
+
+bb1:
+  tail call void @rt_swift_retain(%swift.refcounted* %A)
+  tail call void @rt_swift_release(%swift.refcounted* %A)
+  br label %bb2
+
+bb2:
+  tail call void @rt_swift_release(%swift.refcounted* %A)
+  ret void
+}
+
+; A block with more than one predecessor starts a new chain.
+; CHECK-LABEL: define{{( protected)?}} void @swift_contractRetainNNotAcrossMerge(%swift.refcounted* %A) {
+; CHECK-NOT: @rt_swift_retain_n
+; CHECK: ret void
+define void @swift_contractRetainNNotAcrossMerge(%swift.refcounted* %A) {
+entry:
+  tail call void @rt_swift_retain(%swift.refcounted* %A)
+  br label %bb1
+
+bb1:
+  tail call void @rt_swift_retain(%swift.refcounted* %A)
+  br i1 undef, label %bb1, label %bb2
+
+bb2:
+  ret void
+}
+
+; Calls that can only touch memory through arguments unrelated to the merged
+; object do not stop merging, but passing the object itself does.
+; CHECK-LABEL: define{{( protected)?}} void @swift_contractRetainNAcrossArgMemCalls(%swift.refcounted* %A, i8* %B) {
+; CHECK: entry:
+; CHECK-NEXT: tail call void @rt_swift_retain_n(%swift.refcounted* %A, i32 2)
+; CHECK-NEXT: call void @argmem_user(i8* %B)
+; CHECK-NEXT: call void @argmem_user_ref(%swift.refcounted* %A)
+; CHECK-NEXT: tail call void @rt_swift_retain(%swift.refcounted* %A)
+; CHECK-NEXT: ret void
+define void @swift_contractRetainNAcrossArgMemCalls(%swift.refcounted* %A, i8* %B) {
+entry:
+  tail call void @rt_swift_retain(%swift.refcounted* %A)
+  call void @argmem_user(i8* %B)
+  tail call void @rt_swift_retain(%swift.refcounted* %A)
+  call void @argmem_user_ref(%swift.refcounted* %A)
+  tail call void @rt_swift_retain(%swift.refcounted* %A)
+  ret void
+}
+
 !llvm.dbg.cu = !{!1}
 !llvm.module.flags = !{!4}
 
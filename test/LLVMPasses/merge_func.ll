@@ -323,3 +323,38 @@ done:
 ; CHECK: ret i1
   ret i1 %result
 }
+
+; Merge functions which reference different metadata through GEPs and pointer
+; comparisons.
+
+@metadata1 = external global [2 x i8*]
+@metadata2 = external global [2 x i8*]
+
+; CHECK-LABEL: define i1 @metadata_func1(i8** %x)
+; CHECK: %1 = tail call i1 @metadata_func1_merged(i8** %x, [2 x i8*]* @metadata1, i8** getelementptr inbounds ([2 x i8*], [2 x i8*]* @metadata1, i32 0, i32 0))
+; CHECK: ret i1 %1
+define i1 @metadata_func1(i8** %x) {
+  %p = getelementptr inbounds [2 x i8*], [2 x i8*]* @metadata1, i32 0, i32 1
+  %v = load i8*, i8** %p, align 8
+  %n = icmp ne i8* %v, null
+  %c = icmp eq i8** %x, getelementptr inbounds ([2 x i8*], [2 x i8*]* @metadata1, i32 0, i32 0)
+  %r = and i1 %n, %c
+  ret i1 %r
+}
+
+; CHECK-LABEL: define i1 @metadata_func2(i8** %x)
+; CHECK: %1 = tail call i1 @metadata_func1_merged(i8** %x, [2 x i8*]* @metadata2, i8** getelementptr inbounds ([2 x i8*], [2 x i8*]* @metadata2, i32 0, i32 0))
+; CHECK: ret i1 %1
+define i1 @metadata_func2(i8** %x) {
+  %p = getelementptr inbounds [2 x i8*], [2 x i8*]* @metadata2, i32 0, i32 1
+  %v = load i8*, i8** %p, align 8
+  %n = icmp ne i8* %v, null
+  %c = icmp eq i8** %x, getelementptr inbounds ([2 x i8*], [2 x i8*]* @metadata2, i32 0, i32 0)
+  %r = and i1 %n, %c
+  ret i1 %r
+}
+
+; CHECK-LABEL: define internal i1 @metadata_func1_merged(i8**, [2 x i8*]*, i8**)
+; CHECK: %p = getelementptr inbounds [2 x i8*], [2 x i8*]* %1, i32 0, i32 1
+; CHECK: %c = icmp eq i8** %0, %2
+; CHECK: ret i1
@@ -0,0 +1,102 @@
+; RUN: %swift-llvm-opt -swift-profile-counter-promotion %s | %FileCheck %s
+
+target datalayout = "e-p:64:64:64-S128-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f16:16:16-f32:32:32-f64:64:64-f128:128:128-v64:64:64-v128:128:128-a0:0:64-s0:64:64-f80:128:128-n8:16:32:64"
+target triple = "x86_64-apple-macosx10.9"
+
+@__profc_loop = private global [2 x i64] zeroinitializer
+@__profc_nested = private global [2 x i64] zeroinitializer
+@__profc_volatile = private global [1 x i64] zeroinitializer
+
+declare void @unknown()
+
+; The counter of the loop body is updated once at the exit.
+
+; CHECK-LABEL: define void @loop(i64 %n)
+; CHECK: loop:
+; CHECK-NEXT: [[COUNT:%[0-9a-z.]+]] = phi i64 [ 0, %entry ], [ [[NEXT:%[0-9a-z.]+]], %loop ]
+; CHECK-NOT: store
+; CHECK: [[NEXT]] = add i64 [[COUNT]], 1
+; CHECK-NOT: store
+; CHECK: exit:
+; CHECK-NEXT: [[OLD:%.*]] = load i64, i64* getelementptr inbounds ([2 x i64], [2 x i64]* @__profc_loop, i64 0, i64 1)
+; CHECK-NEXT: [[NEW:%.*]] = add i64 [[OLD]], [[NEXT]]
+; CHECK-NEXT: store i64 [[NEW]], i64* getelementptr inbounds ([2 x i64], [2 x i64]* @__profc_loop, i64 0, i64 1)
+; CHECK-NEXT: ret void
+define void @loop(i64 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop ]
+  %pgocount = load i64, i64* getelementptr inbounds ([2 x i64], [2 x i64]* @__profc_loop, i64 0, i64 1)
+  %0 = add i64 %pgocount, 1
+  store i64 %0, i64* getelementptr inbounds ([2 x i64], [2 x i64]* @__profc_loop, i64 0, i64 1)
+  call void @unknown()
+  %i.next = add i64 %i, 1
+  %cond = icmp eq i64 %i.next, %n
+  br i1 %cond, label %exit, label %loop
+
+exit:
+  ret void
+}
+
+; The update that the inner loop leaves in its exit is promoted into the
+; outer loop.
+
+; CHECK-LABEL: define void @nested(i64 %n)
+; CHECK: outer:
+; CHECK-NOT: store
+; CHECK: exit:
+; CHECK-NEXT: load i64, i64* getelementptr inbounds ([2 x i64], [2 x i64]* @__profc_nested, i64 0, i64 1)
+; CHECK-NEXT: add i64
+; CHECK-NEXT: store i64 {{.*}} @__profc_nested
+; CHECK-NEXT: ret void
+define void @nested(i64 %n) {
+entry:
+  br label %outer
+
+outer:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %outer.latch ]
+  br label %inner
+
+inner:
+  %j = phi i64 [ 0, %outer ], [ %j.next, %inner ]
+  %pgocount = load i64, i64* getelementptr inbounds ([2 x i64], [2 x i64]* @__profc_nested, i64 0, i64 1)
+  %0 = add i64 %pgocount, 1
+  store i64 %0, i64* getelementptr inbounds ([2 x i64], [2 x i64]* @__profc_nested, i64 0, i64 1)
+  %j.next = add i64 %j, 1
+  %inner.cond = icmp eq i64 %j.next, %n
+  br i1 %inner.cond, label %outer.latch, label %inner
+
+outer.latch:
+  %i.next = add i64 %i, 1
+  %outer.cond = icmp eq i64 %i.next, %n
+  br i1 %outer.cond, label %exit, label %outer
+
+exit:
+  ret void
+}
+
+; Volatile counter updates stay in the loop.
+
+; CHECK-LABEL: define void @volatile_update(i64 %n)
+; CHECK: loop:
+; CHECK: store volatile i64
+; CHECK: exit:
+; CHECK-NEXT: ret void
+define void @volatile_update(i64 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop ]
+  %pgocount = load volatile i64, i64* getelementptr inbounds ([1 x i64], [1 x i64]* @__profc_volatile, i64 0, i64 0)
+  %0 = add i64 %pgocount, 1
+  store volatile i64 %0, i64* getelementptr inbounds ([1 x i64], [1 x i64]* @__profc_volatile, i64 0, i64 0)
+  %i.next = add i64 %i, 1
+  %cond = icmp eq i64 %i.next, %n
+  br i1 %cond, label %exit, label %loop
+
+exit:
+  ret void
+}
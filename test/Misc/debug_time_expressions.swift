@@ -0,0 +1,4 @@
+// RUN: %target-swift-frontend -parse -debug-time-expression-type-checking %s 2>&1 | %FileCheck %s
+
+// CHECK: {{[0-9]+}}.{{[0-9]}}ms{{.*}}debug_time_expressions.swift:[[@LINE+1]]:{{[0-9]+}}{{.*}}NumStatesExplored=
+var x = 1 + 2.5
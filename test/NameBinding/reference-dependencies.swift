@@ -497,4 +497,12 @@ struct Sentinel2 {}
 // NEGATIVE-NOT: "OtherFileSecretTypeWrapper"
 // NEGATIVE-NOT: "V4main26OtherFileSecretTypeWrapper"
 
+// CHECK-LABEL: {{^interface-hash-top-level:$}}
+// CHECK-DAG: - ["IntWrapper", "{{[0-9a-f]+}}"]
+// CHECK-DAG: - ["overloadedOnProto", "{{[0-9a-f]+}}"]
+// CHECK-DAG: - ["someGlobal", "{{[0-9a-f]+}}"]
+// CHECK-LABEL: {{^interface-hash-nominal:$}}
+// CHECK-DAG: - ["V4main10IntWrapper", "{{[0-9a-f]+}}"]
+// CHECK-DAG: - ["{{.*[0-9]}}FourTildeImpl", "{{[0-9a-f]+}}"]
+
 let eof: () = ()
@@ -96,6 +96,25 @@ func localComputedProperties() {
   { print(localProperty) }()
 }
 
+// Repeated lookups of the same names through long chains of locals, some of
+// which shadow each other.
+func manyLocals(x: Int) -> Int {
+  let a = x
+  let b = a + x
+  let c = b + a + x
+  let x = "shadowed"
+  let d = c + b + a
+  func helper() -> Int { return d + c }
+  if let e = Optional(d) {
+    let x = e + helper()
+    let f = x + e + d + c + b + a
+    _ = f
+  }
+  let g: String = x
+  _ = g
+  return d + helper()
+}
+
 // Top-level code.
 func topLevel() { }
 
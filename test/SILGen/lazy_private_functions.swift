@@ -0,0 +1,29 @@
+// RUN: %target-swift-frontend -emit-silgen -O %s | %FileCheck %s
+// RUN: %target-swift-frontend -emit-silgen -O %s | %FileCheck -check-prefix=NEGATIVE %s
+// RUN: %target-swift-frontend -emit-silgen %s | %FileCheck -check-prefix=ONONE %s
+
+// When optimizing, private definitions are only emitted once they are
+// referenced.
+
+// CHECK-LABEL: sil private @_TF22lazy_private_functionsP33_{{.*}}10usedHelperFT_Si
+private func usedHelper() -> Int {
+  return 1
+}
+
+// NEGATIVE-NOT: unusedHelper
+// ONONE-LABEL: sil private @_TF22lazy_private_functionsP33_{{.*}}12unusedHelperFT_Si
+private func unusedHelper() -> Int {
+  return 2
+}
+
+// CHECK-LABEL: sil private @unused_silgen_name_helper
+@_silgen_name("unused_silgen_name_helper")
+private func unusedSILGenNameHelper() -> Int {
+  return 3
+}
+
+// CHECK-LABEL: sil @_TF22lazy_private_functions6callerFT_Si
+// CHECK: function_ref @_TF22lazy_private_functionsP33_{{.*}}10usedHelperFT_Si
+public func caller() -> Int {
+  return usedHelper()
+}
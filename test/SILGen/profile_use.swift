@@ -0,0 +1,39 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %llvm-profdata merge %S/Inputs/profile_use.proftext -o %t/profile_use.profdata
+// RUN: %target-swift-frontend -parse-as-library -emit-silgen -module-name pgo -profile-use=%t/profile_use.profdata %s | %FileCheck %s
+// RUN: not %target-swift-frontend -parse-as-library -emit-silgen -module-name pgo -profile-use=%t/missing.profdata %s 2>&1 | %FileCheck -check-prefix=MISSING %s
+
+// MISSING: error: failed to load profile data '{{.*}}missing.profdata'
+
+// Reading a profile doesn't instrument the code.
+// CHECK-NOT: int_instrprof_increment
+
+// CHECK-LABEL: sil @_TF3pgo6pgo_ifFSbSi
+// CHECK: bb0(%0 : $Bool):{{.*}}// count: 100
+// CHECK: {{^bb[0-9]+}}:{{.*}}// count: 3
+// CHECK: {{^}$}}
+public func pgo_if(_ b: Bool) -> Int {
+  if b {
+    return 1
+  }
+  return 0
+}
+
+// CHECK-LABEL: sil @_TF3pgo8pgo_loopFSiSi
+// CHECK: bb0(%0 : $Int):{{.*}}// count: 5
+// CHECK: // count: 5000
+// CHECK: {{^}$}}
+public func pgo_loop(_ n: Int) -> Int {
+  var sum = 0
+  for i in 0..<n {
+    sum += i
+  }
+  return sum
+}
+
+// Functions that aren't in the profile get no counts.
+// CHECK-LABEL: sil @_TF3pgo14pgo_unprofiledFT_T_
+// CHECK-NOT: // count:
+// CHECK: {{^}$}}
+public func pgo_unprofiled() {
+}
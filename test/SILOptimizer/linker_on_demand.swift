@@ -0,0 +1,16 @@
+// RUN: rm -rf %t
+// RUN: mkdir -p %t
+// RUN: %target-swift-frontend -emit-module %S/Inputs/linker_pass_input.swift -o %t/Swift.swiftmodule -parse-stdlib -parse-as-library -module-name Swift -sil-serialize-all -module-link-name swiftCore
+// RUN: %target-swift-frontend %s -O -I %t -sil-link-on-demand -sil-debug-serialization -o %t/linker_on_demand.sil -emit-sil
+// RUN: %FileCheck %s < %t/linker_on_demand.sil
+// RUN: %FileCheck -check-prefix=NOBODY %s < %t/linker_on_demand.sil
+
+// doSomething is inlined, so its body has to be deserialized.
+// CHECK-LABEL: sil @main
+// CHECK-NOT: function_ref @_TFs11doSomethingFT_T_
+// CHECK: function_ref @unknown
+doSomething()
+
+// callDoSomething3 is never inlined, so its body is never read.
+// NOBODY: sil {{.*}}[noinline] @{{.*}}callDoSomething3{{.*}} : $@convention(thin) () -> (){{$}}
+callDoSomething3()
@@ -0,0 +1,16 @@
+public protocol Base {}
+public protocol Refined : Base {}
+public protocol MoreRefined : Refined {}
+
+public struct ConformsInDecl : MoreRefined {
+  public init() {}
+}
+
+public struct ConformsInExtension {
+  public init() {}
+}
+extension ConformsInExtension : Refined {}
+
+open class ConformingClass : MoreRefined {
+  public init() {}
+}
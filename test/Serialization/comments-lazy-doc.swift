@@ -0,0 +1,19 @@
+// The module documentation file is only read when a comment is requested.
+//
+// RUN: rm -rf %t
+// RUN: mkdir -p %t
+// RUN: %target-swift-frontend -module-name comments_lazy -emit-module -emit-module-path %t/comments_lazy.swiftmodule -emit-module-doc -emit-module-doc-path %t/comments_lazy.swiftdoc %s
+// RUN: %target-swift-ide-test -print-module-comments -module-to-print=comments_lazy -source-filename %s -I %t | %FileCheck %s
+
+// A malformed documentation file doesn't keep the module from being used, it
+// just provides no comments.
+// RUN: echo -n 'abcde' > %t/comments_lazy.swiftdoc
+// RUN: echo 'import comments_lazy; _ = documented()' > %t/main.swift
+// RUN: %target-swift-frontend -parse -I %t %t/main.swift
+// RUN: %target-swift-ide-test -print-module-comments -module-to-print=comments_lazy -source-filename %s -I %t | %FileCheck %s -check-prefix=MALFORMED
+
+/// A documented function.
+public func documented() -> Int { return 0 }
+
+// CHECK: Func/documented RawComment=[/// A documented function.\n]
+// MALFORMED: Func/documented RawComment=none
@@ -0,0 +1,25 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %target-swift-frontend -emit-module -o %t -module-name Lib %S/Inputs/implied-conformance-lib.swift
+// RUN: %target-swift-frontend -parse -verify -I %t %s
+
+// Conformances that are only implied by the declarations in Lib are read
+// from the module rather than re-derived.
+
+import Lib
+
+func useBase<T : Base>(_: T) {}
+func useRefined<T : Refined>(_: T) {}
+
+useBase(ConformsInDecl())
+useRefined(ConformsInDecl())
+useBase(ConformsInExtension())
+
+class Subclass : ConformingClass {}
+useBase(Subclass())
+useRefined(Subclass())
+
+protocol Local : Refined {}
+extension ConformsInExtension : Local {}
+useRefined(ConformsInExtension())
+
+extension ConformsInDecl : Base {} // expected-error{{redundant conformance of 'ConformsInDecl' to protocol 'Base'}}
@@ -0,0 +1,14 @@
+// RUN: %sourcekitd-test -req=version == -req=statistics | %FileCheck %s
+
+// CHECK: key.histograms: [
+// CHECK:      key.name: "source.request.protocol_version",
+// CHECK-NEXT: key.count: 1,
+// CHECK-NEXT: key.total_usec:
+// CHECK-NEXT: key.p50_usec:
+// CHECK-NEXT: key.p90_usec:
+// CHECK-NEXT: key.p99_usec:
+// CHECK: key.counters: [
+// CHECK:      key.name: "swift.completion-cache.hits",
+// CHECK-NEXT: key.value: 0
+// CHECK:      key.name: "swift.completion-cache.misses",
+// CHECK-NEXT: key.value: 0
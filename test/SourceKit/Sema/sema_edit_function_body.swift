@@ -0,0 +1,30 @@
+struct S {
+  func foo(_ x: Int) -> Int {
+    return x
+  }
+}
+
+func bar(_ s: S) {
+  _ = s.foo(1)
+}
+
+// Editing the body of bar() only re-annotates bar(); the annotations of S
+// are carried over.
+// RUN: %sourcekitd-test -req=open %s -- %s == \
+// RUN:    -req=edit -pos=8:7 -replace="s.foo(0) + " -length=0 %s == \
+// RUN:    -req=print-annotations %s | %FileCheck %s
+
+// CHECK:      key.kind: source.lang.swift.ref.struct,
+// CHECK-NEXT: key.offset: 27,
+// CHECK:      key.kind: source.lang.swift.ref.struct,
+// CHECK-NEXT: key.offset: 35,
+// CHECK:      key.offset: 52,
+// CHECK:      key.kind: source.lang.swift.ref.struct,
+// CHECK-NEXT: key.offset: 75,
+// CHECK:      key.offset: 86,
+// CHECK:      key.kind: source.lang.swift.ref.function.method.instance,
+// CHECK-NEXT: key.offset: 88,
+// CHECK:      key.offset: 97,
+// CHECK:      key.kind: source.lang.swift.ref.function.method.instance,
+// CHECK-NEXT: key.offset: 99,
+// CHECK-NOT:  key.offset:
@@ -0,0 +1,29 @@
+class Base {
+  var value: Int = 0
+  func compute() -> Int { return value }
+}
+
+protocol Provider {
+  associatedtype Provided
+  func get() -> Provided
+}
+
+protocol Refined : Provider {
+  func refine() -> Provided
+}
+
+class Derived : Base, Provider {
+  func get() -> Int { return compute() }
+}
+
+class MoreDerived : Derived {
+  override var value: Int {
+    get { return 1 }
+    set { }
+  }
+}
+
+struct ValueProvider : Provider {
+  var text: String
+  func get() -> String { return text }
+}
@@ -0,0 +1,39 @@
+// RUN: %target-swift-frontend -parse -verify -primary-file %s %S/Inputs/request_evaluator_multi_file_other.swift
+// RUN: %target-swift-frontend -parse -verify %s -primary-file %S/Inputs/request_evaluator_multi_file_other.swift
+
+// Declarations in the other file are used many times here, so their
+// superclasses, signatures and conformances are requested over and over.
+
+func useBase(_ b: Base) -> Int {
+  return b.value + b.compute()
+}
+
+func useDerived(_ d: Derived) -> Int {
+  return useBase(d) + d.compute() + d.value + d.get()
+}
+
+func useProvider<T : Provider>(_ t: T) -> T.Provided {
+  return t.get()
+}
+
+let fromDerived: Int = useProvider(Derived())
+let fromValue: String = useProvider(ValueProvider(text: "x"))
+let fromMore: Int = useProvider(MoreDerived())
+
+class Local : MoreDerived {
+  override func compute() -> Int {
+    return super.compute() + useDerived(self)
+  }
+}
+
+extension ValueProvider : Refined {
+  func refine() -> String {
+    return get() + get()
+  }
+}
+
+func useRefined<T : Refined>(_ t: T) -> String where T.Provided == String {
+  return t.refine()
+}
+
+let refined = useRefined(ValueProvider(text: "y"))
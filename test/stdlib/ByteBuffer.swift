@@ -0,0 +1,103 @@
+// RUN: %target-run-simple-swift
+// REQUIRES: executable_test
+
+import StdlibUnittest
+
+var ByteBufferTests = TestSuite("ByteBuffer")
+
+func readableBytes(_ buffer: _ByteBuffer) -> [UInt8] {
+  return buffer.withUnsafeReadableBytes { Array($0) }
+}
+
+func readableAddress(_ buffer: _ByteBuffer) -> UnsafeRawPointer? {
+  return buffer.withUnsafeReadableBytes { $0.baseAddress }
+}
+
+ByteBufferTests.test("write and read") {
+  var buffer = _ByteBuffer()
+  expectEqual(0, buffer.readableByteCount)
+  expectNil(buffer.readByte())
+
+  buffer.write(1)
+  buffer.write(contentsOf: [2, 3, 4] as [UInt8])
+  buffer.write(contentsOf: (5...8).lazy.map { UInt8($0) })
+  expectEqual([1, 2, 3, 4, 5, 6, 7, 8], readableBytes(buffer))
+
+  expectEqual(1, buffer.readByte())
+  buffer.moveReaderIndex(forwardBy: 2)
+  expectEqual([4, 5, 6, 7, 8], readableBytes(buffer))
+
+  // Growing keeps the readable bytes.
+  let many = (0..<1000).map { UInt8(truncatingBitPattern: $0) }
+  buffer.write(contentsOf: many)
+  expectEqual([4, 5, 6, 7, 8] + many, readableBytes(buffer))
+  expectEqual(_ByteBuffer(many).readableByteCount, many.count)
+}
+
+ByteBufferTests.test("writeWithUnsafeMutableBytes") {
+  var buffer = _ByteBuffer([1, 2])
+  let written = buffer.writeWithUnsafeMutableBytes(minimumWritableBytes: 4) {
+    $0[0] = 3
+    $0[1] = 4
+    return 2
+  }
+  expectEqual(2, written)
+  buffer.write(5)
+  expectEqual([1, 2, 3, 4, 5], readableBytes(buffer))
+}
+
+ByteBufferTests.test("readSlice shares storage") {
+  var buffer = _ByteBuffer(minimumCapacity: 64)
+  buffer.write("GET /index.html")
+  let start = readableAddress(buffer)!
+  let method = buffer.readSlice(count: 3)!
+  expectEqual(start, readableAddress(method))
+  expectEqual(start + 3, readableAddress(buffer))
+  expectEqual(Array("GET".utf8), readableBytes(method))
+  expectNil(buffer.readSlice(count: 100))
+
+  // Appending to the buffer doesn't disturb the slice, and doesn't copy
+  // while the capacity lasts.
+  buffer.write(" HTTP/1.1")
+  expectEqual(start + 3, readableAddress(buffer))
+  expectEqual(Array("GET".utf8), readableBytes(method))
+  expectEqual(Array(" /index.html HTTP/1.1".utf8), readableBytes(buffer))
+
+  // Writing to the slice can't overwrite the buffer's bytes.
+  var slice = method
+  slice.write("X")
+  expectNotEqual(start, readableAddress(slice))
+  expectEqual(Array("GETX".utf8), readableBytes(slice))
+  expectEqual(Array("GET".utf8), readableBytes(method))
+  expectEqual(Array(" /index.html HTTP/1.1".utf8), readableBytes(buffer))
+}
+
+ByteBufferTests.test("copies have value semantics") {
+  var a = _ByteBuffer(minimumCapacity: 64)
+  a.write("abc")
+  var b = a
+  b.write("d")
+  a.write("e")
+  expectEqual(Array("abce".utf8), readableBytes(a))
+  expectEqual(Array("abcd".utf8), readableBytes(b))
+
+  var c = a
+  expectEqual(UInt8(ascii: "a"), c.readByte())
+  expectEqual(Array("abce".utf8), readableBytes(a))
+  expectEqual(Array("bce".utf8), readableBytes(c))
+}
+
+ByteBufferTests.test("readString") {
+  var buffer = _ByteBuffer()
+  buffer.write("hello, w\u{f6}rld \u{1F600}")
+  expectNil(buffer.readString(count: 100))
+  expectEqual("hello", buffer.readString(count: 5))
+  buffer.moveReaderIndex(forwardBy: 2)
+  // Stopping in the middle of a scalar is ill-formed.
+  expectNil(buffer.readString(count: 2))
+  expectEqual("w\u{f6}rld \u{1F600}", buffer.readString(count: 11))
+  expectEqual(0, buffer.readableByteCount)
+  expectEqual("", buffer.readString(count: 0))
+}
+
+runAllTests()
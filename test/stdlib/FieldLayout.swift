@@ -0,0 +1,88 @@
+// RUN: %target-run-simple-swift
+// REQUIRES: executable_test
+
+import StdlibUnittest
+
+var FieldLayoutTests = TestSuite("FieldLayout")
+
+struct Point {
+  var x: Int
+  var y: Double
+}
+
+struct Pair<T, U> {
+  var first: T
+  var second: U
+}
+
+class Base {
+  var id: Int = 0
+}
+
+class Derived : Base {
+  var label: String = ""
+  weak var parent: Base?
+}
+
+enum Direction {
+  case up, down
+}
+
+func fieldNames(_ type: Any.Type) -> [String]? {
+  return _getFieldLayout(type).map { $0.map { $0._name } }
+}
+
+FieldLayoutTests.test("struct") {
+  let fields = _getFieldLayout(Point.self)!
+  expectEqual(["x", "y"], fieldNames(Point.self)!)
+  expectTrue(fields[0]._type == Int.self)
+  expectTrue(fields[1]._type == Double.self)
+  expectEqual(0, fields[0].offset)
+  expectEqual(UInt(MemoryLayout<Int>.size), fields[1].offset)
+  expectFalse(fields[0].isWeak)
+}
+
+FieldLayoutTests.test("generic struct") {
+  let fields = _getFieldLayout(Pair<UInt8, Int>.self)!
+  expectEqual(["first", "second"], fieldNames(Pair<UInt8, Int>.self)!)
+  expectTrue(fields[0]._type == UInt8.self)
+  expectTrue(fields[1]._type == Int.self)
+  expectEqual(UInt(MemoryLayout<Int>.alignment), fields[1].offset)
+
+  // Each instantiation has its own layout.
+  let other = _getFieldLayout(Pair<String, Point>.self)!
+  expectTrue(other[0]._type == String.self)
+  expectTrue(other[1]._type == Point.self)
+}
+
+FieldLayoutTests.test("class") {
+  let fields = _getFieldLayout(Derived.self)!
+  expectEqual(["id", "label", "parent"], fieldNames(Derived.self)!)
+  expectTrue(fields[0]._type == Int.self)
+  expectTrue(fields[1]._type == String.self)
+  expectFalse(fields[1].isWeak)
+  expectTrue(fields[2].isWeak)
+  expectLT(fields[0].offset, fields[1].offset)
+  expectLT(fields[1].offset, fields[2].offset)
+
+  // The names agree with the ones a mirror reports.
+  let mirror = Mirror(reflecting: Derived())
+  expectEqual(["label", "parent"], mirror.children.map { $0.label! })
+  expectEqual(["id"], mirror.superclassMirror!.children.map { $0.label! })
+}
+
+FieldLayoutTests.test("cached") {
+  let first = _getFieldLayout(Point.self)!
+  let second = _getFieldLayout(Point.self)!
+  expectEqual(first.baseAddress, second.baseAddress)
+}
+
+FieldLayoutTests.test("unsupported") {
+  expectNil(_getFieldLayout(Direction.self))
+  expectNil(_getFieldLayout(Int.Type.self))
+  expectNil(_getFieldLayout((Int, Int).self))
+  // Failures are cached too.
+  expectNil(_getFieldLayout(Direction.self))
+}
+
+runAllTests()
@@ -60,4 +60,49 @@ FilterTests.test("filtering sequences") {
   expectEqualSequence([7, 14, 21, 28], f1)
 }
 
+/// A sequence that only supports internal iteration, to check that lazy
+/// adaptors implement `forEach` in terms of their base's `forEach`.
+struct InternalIterationOnly : Sequence {
+  let elements: [Int]
+
+  func makeIterator() -> IndexingIterator<[Int]> {
+    expectUnreachable("makeIterator() should not be called")
+    return elements.makeIterator()
+  }
+
+  func forEach(_ body: (Int) throws -> Void) rethrows {
+    try elements.forEach(body)
+  }
+}
+
+FilterTests.test("forEach and reduce run in the base sequence") {
+  let base = InternalIterationOnly(elements: Array(0..<30))
+  let chain = base.lazy.filter { $0 % 2 == 0 }.map { $0 * 3 }
+    .filter { $0 % 4 == 0 }
+  var visited: [Int] = []
+  chain.forEach { visited.append($0) }
+  expectEqual([0, 12, 24, 36, 48, 60, 72], visited)
+  expectEqual(252, chain.reduce(0, +))
+  expectEqual(252, AnySequence(chain).reduce(0, +))
+
+  let nested = InternalIterationOnly(elements: [1, 2, 3]).lazy.map {
+    InternalIterationOnly(elements: Array(0..<$0))
+  }
+  expectEqual([0, 0, 1, 0, 1, 2], nested.joined().reduce([Int]()) { $0 + [$1] })
+
+  // A throwing body stops the loop.
+  struct Stop : Error {}
+  var count = 0
+  do {
+    try chain.forEach {
+      count += 1
+      if $0 == 24 { throw Stop() }
+    }
+    expectUnreachable()
+  } catch {
+    expectTrue(error is Stop)
+  }
+  expectEqual(3, count)
+}
+
 runAllTests()
@@ -0,0 +1,81 @@
+// RUN: %target-run-simple-swift
+// REQUIRES: executable_test
+
+import StdlibUnittest
+
+var ParallelTests = TestSuite("Parallel")
+
+// Small counts are sorted and mapped on one thread, large ones are divided
+// into chunks.
+let counts = [0, 1, 2, 100, 4095, 3 * 4096 + 17, 100_000]
+
+func pseudoRandomArray(count: Int, modulus: Int = 1 << 30) -> [Int] {
+  var state = 12345
+  var result: [Int] = []
+  for _ in 0..<count {
+    state = (state &* 1103515245 &+ 12345) & 0x7fff_ffff
+    result.append(state % modulus)
+  }
+  return result
+}
+
+ParallelTests.test("parallelSort") {
+  for count in counts {
+    var elements = pseudoRandomArray(count: count)
+    let expected = elements.sorted()
+    elements.parallelSort()
+    expectEqual(expected, elements, "count: \(count)")
+  }
+}
+
+ParallelTests.test("parallelSort/Duplicates") {
+  for count in counts {
+    var elements = pseudoRandomArray(count: count, modulus: 7)
+    let expected = elements.sorted()
+    elements.parallelSort()
+    expectEqual(expected, elements, "count: \(count)")
+  }
+}
+
+ParallelTests.test("parallelSort/Sorted") {
+  var ascending = Array(0..<100_000)
+  ascending.parallelSort()
+  expectEqual(Array(0..<100_000), ascending)
+
+  var descending = Array((0..<100_000).reversed())
+  descending.parallelSort()
+  expectEqual(Array(0..<100_000), descending)
+}
+
+ParallelTests.test("parallelSort(by:)") {
+  for count in counts {
+    var elements = pseudoRandomArray(count: count).map { String($0) }
+    let expected = elements.sorted(by: >)
+    elements.parallelSort(by: >)
+    expectEqual(expected, elements, "count: \(count)")
+  }
+}
+
+ParallelTests.test("parallelSort/ArraySlice") {
+  var elements = pseudoRandomArray(count: 100_000)
+  var expected = elements
+  expected[10..<99_990].sort()
+  elements[10..<99_990].parallelSort()
+  expectEqual(expected, elements)
+}
+
+ParallelTests.test("parallelMap") {
+  for count in counts {
+    let elements = pseudoRandomArray(count: count)
+    let expected = elements.map { String($0) }
+    expectEqual(expected, elements.parallelMap { String($0) },
+      "count: \(count)")
+  }
+}
+
+ParallelTests.test("parallelMap/CountableRange") {
+  expectEqual((0..<100_000).map { $0 * 2 },
+    (0..<100_000).parallelMap { $0 * 2 })
+}
+
+runAllTests()
@@ -267,4 +267,37 @@ PrintTests.test("Printable") {
 #endif
 }
 
+PrintTests.test("Printable/Rounding") {
+  func asFloat32(_ f: Float32) -> Float32 { return f }
+  func asFloat64(_ f: Float64) -> Float64 { return f }
+
+  expectPrinted("0.333333", asFloat32(1.0 / 3.0))
+  expectPrinted("1.67772e+07", asFloat32(16777216.0))
+  expectPrinted("3.40282e+38", Float.greatestFiniteMagnitude)
+  expectPrinted("1.4013e-45", Float.leastNonzeroMagnitude)
+  expectDebugPrinted("0.333333343", asFloat32(1.0 / 3.0))
+  expectDebugPrinted("16777216.0", asFloat32(16777216.0))
+  expectDebugPrinted("3.40282347e+38", Float.greatestFiniteMagnitude)
+  expectDebugPrinted("1.40129846e-45", Float.leastNonzeroMagnitude)
+  expectDebugPrinted("0.100000001", asFloat32(0.1))
+
+  expectPrinted("0.3", asFloat64(0.1) + asFloat64(0.2))
+  expectPrinted("1e+15", asFloat64(999999999999999.9))
+  expectPrinted("0.333333333333333", asFloat64(1.0 / 3.0))
+  expectPrinted("0.666666666666667", asFloat64(2.0 / 3.0))
+  expectPrinted("123456.789", asFloat64(123456.789))
+  expectPrinted("1.79769313486232e+308", Double.greatestFiniteMagnitude)
+  expectPrinted("2.2250738585072e-308", Double.leastNormalMagnitude)
+  expectPrinted("4.94065645841247e-324", Double.leastNonzeroMagnitude)
+  expectDebugPrinted("0.30000000000000004", asFloat64(0.1) + asFloat64(0.2))
+  expectDebugPrinted("999999999999999.88", asFloat64(999999999999999.9))
+  expectDebugPrinted("0.10000000000000001", asFloat64(0.1))
+  expectDebugPrinted("0.33333333333333331", asFloat64(1.0 / 3.0))
+  expectDebugPrinted("0.66666666666666663", asFloat64(2.0 / 3.0))
+  expectDebugPrinted("1.7976931348623157e+308", Double.greatestFiniteMagnitude)
+  expectDebugPrinted("2.2250738585072014e-308", Double.leastNormalMagnitude)
+  expectDebugPrinted("4.9406564584124654e-324", Double.leastNonzeroMagnitude)
+  expectDebugPrinted("-0.0", -asFloat64(0.0))
+}
+
 runAllTests()
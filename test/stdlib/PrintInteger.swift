@@ -146,4 +146,43 @@ PrintTests.test("Printable") {
   expectPrinted("*", CChar32(42)!)
 }
 
+PrintTests.test("Decimal") {
+  var power: UInt64 = 1
+  var digits = "1"
+  while true {
+    expectPrinted(digits, power)
+    if power > 1 {
+      let nines = String(repeating: "9", count: digits.utf16.count - 1)
+      expectPrinted(nines, power - 1)
+    }
+    if power <= UInt64(Int64.max) {
+      expectPrinted("-" + digits, -Int64(power))
+    }
+    let (next, overflow) = UInt64.multiplyWithOverflow(power, 10)
+    if overflow {
+      break
+    }
+    power = next
+    digits += "0"
+  }
+
+  expectPrinted("0", Int64(0))
+  expectPrinted("-1", Int64(-1))
+  expectPrinted("-9223372036854775808", Int64.min)
+  expectPrinted("9223372036854775807", Int64.max)
+  expectPrinted("18446744073709551615", UInt64.max)
+  expectPrinted("-128", Int8.min)
+  expectPrinted("65535", UInt16.max)
+}
+
+PrintTests.test("Interpolation") {
+  let i = -42
+  let u: UInt8 = 255
+  expectEqual("-42", "\(i)")
+  expectEqual("i = -42, u = 255.", "i = \(i), u = \(u).")
+  expectEqual("-42255-42", "\(i)\(u)\(i)")
+  expectEqual("\u{e9}: 255", "\u{e9}: \(u)")
+  expectEqual("", "\("")")
+}
+
 runAllTests()
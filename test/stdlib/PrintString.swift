@@ -45,4 +45,32 @@ PrintTests.test("CustomStringInterpolation") {
   expectEqual("<segment aaa><segment 1><segment bbb>", s)
 }
 
+PrintTests.test("StringInterpolation") {
+  let i = -42
+  let u: UInt64 = .max
+  let ch: Character = "\u{e9}"
+  let o: Int? = 7
+  let any: Any = Int8.min
+  let anyOptional: Any = o as Any
+  expectEqual("i = -42, u = 18446744073709551615.", "i = \(i), u = \(u).")
+  expectEqual("\u{e9} \u{3042} -42", "\(ch) \u{3042} \(i)")
+  expectEqual("Optional(7) Optional(7) -128", "\(o) \(anyOptional) \(any)")
+  expectEqual("[1, 2] (3, \"x\")", "\([1, 2]) \((3, "x"))")
+
+  // Segments are evaluated in order.
+  var log: [Int] = []
+  func record(_ x: Int) -> Int {
+    log.append(x)
+    return x
+  }
+  expectEqual("123", "\(record(1))\(record(2))\(record(3))")
+  expectEqual([1, 2, 3], log)
+
+  // The result outgrows the estimated capacity.
+  let long = String(repeating: "x", count: 100)
+  let many = "\(i)\(i)\(i)\(i)\(i)\(i)\(i)\(i)\(i)\(i)\(i)\(i)"
+  expectEqual(String(repeating: "-42", count: 12), many)
+  expectEqual("<\(long)\(long)>\(i)", "<" + long + long + ">-42")
+}
+
 runAllTests()
@@ -345,6 +345,32 @@ StringTests.test("SameTypeComparisons") {
   expectFalse(xs != xs)
 }
 
+StringTests.test("SameTypeComparisons/NonASCII") {
+  // Strings in NFC are mostly ordered by their primary weights without the
+  // collator. Strings which need normalization, or differ only after the
+  // first level, still go through it.
+  expectTrue("\u{43f}\u{440}\u{438}" < "\u{43f}\u{440}\u{43e}")
+  expectTrue("\u{3b1}\u{3b2}" < "\u{3b1}\u{3b2}\u{3b3}")
+  expectTrue("caf\u{e9}" == "cafe\u{301}")
+  expectTrue("cafe\u{301}" == "caf\u{e9}")
+  expectTrue("cafe" < "caf\u{e9}")
+  expectTrue("l\u{b7}a" != "la")
+  expectTrue("\u{30ab}\u{30ca}" != "\u{304b}\u{306a}")
+
+  let words = ["\u{43c}\u{438}\u{440}", "\u{41c}\u{438}\u{440}",
+               "\u{3ba}\u{3b1}\u{3bb}\u{3ae}", "\u{5e9}\u{5dc}\u{5d5}",
+               "\u{3053}\u{3093}\u{306b}\u{3061}\u{306f}"]
+  for word in words {
+    // Build the strings at runtime so that they don't share storage.
+    let copy = String(word.characters)
+    expectEqual(word, copy)
+    expectEqual(word.hashValue, copy.hashValue)
+    expectEqual(word + "na\u{ef}ve", copy + "nai\u{308}ve")
+    expectEqual((word + "na\u{ef}ve").hashValue,
+      (copy + "nai\u{308}ve").hashValue)
+  }
+}
+
 StringTests.test("CompareStringsWithUnpairedSurrogates")
   .xfail(
     .always("<rdar://problem/18029104> Strings referring to underlying " +
@@ -361,6 +387,26 @@ StringTests.test("CompareStringsWithUnpairedSurrogates")
   )
 }
 
+StringTests.test("CharacterView/ASCII") {
+  let ascii = "ab\r\ncd\r\r\n\n"
+  expectEqual(8, ascii.characters.count)
+  expectEqual(["a", "b", "\r\n", "c", "d", "\r", "\r\n", "\n"],
+    Array(ascii.characters))
+  expectEqual(["\n", "\r\n", "\r", "d", "c", "\r\n", "b", "a"],
+    Array(ascii.characters.reversed()))
+  expectEqual(0, "".characters.count)
+  expectEqual(1, "\r\n".characters.count)
+
+  // ASCII scalars followed by combining marks still form a single
+  // character, in UTF-16 storage.
+  let mixed = "e\u{301}\r\nx\u{1F1FA}\u{1F1F8}y"
+  expectEqual(5, mixed.characters.count)
+  expectEqual(["e\u{301}", "\r\n", "x", "\u{1F1FA}\u{1F1F8}", "y"],
+    Array(mixed.characters))
+  expectEqual(["y", "\u{1F1FA}\u{1F1F8}", "x", "\r\n", "e\u{301}"],
+    Array(mixed.characters.reversed()))
+}
+
 var CStringTests = TestSuite("CStringTests")
 
 func getNullUTF8() -> UnsafeMutablePointer<UInt8>? {
@@ -539,6 +585,95 @@ CStringTests.test("String.utf8CString") {
     expectEqualCString(cstr, str.utf8CString)
     dealloc()
   }
+  do {
+    // A slice of an ASCII string is terminated at its own end.
+    let str = "abcdef"
+    let slice = str[str.index(after: str.startIndex)..<str.index(before: str.endIndex)]
+    expectEqual([98, 99, 100, 101, 0], Array(slice.utf8CString))
+    expectEqual([0], Array("".utf8CString))
+  }
+}
+
+CStringTests.test("String(cString:)/ASCII") {
+  let (cstr, dealloc) = getASCIIUTF8()
+  let str = String(cString: cstr)
+  expectTrue(str._core.isASCII)
+  expectEqualCString(cstr, str.utf8CString)
+  dealloc()
+
+  let long = String(repeating: "0123456789abcdef", count: 5) + "xyz"
+  let copy = long.withCString { String(cString: $0) }
+  expectTrue(copy._core.isASCII)
+  expectEqual(long, copy)
+}
+
+CStringTests.test("String.==/ASCII") {
+  let words = ["", "a", "b", "ab", "ba", "abc", "ABC", "a b", "a-b",
+               "0123456789abcdefg", "0123456789abcdefh"]
+  for lhs in words {
+    for rhs in words {
+      // Build the strings at runtime so that they don't share storage.
+      let l = String(lhs.characters)
+      let r = String(rhs.characters)
+      expectEqual(lhs.utf8.elementsEqual(rhs.utf8), l == r,
+        "\(lhs.debugDescription) == \(rhs.debugDescription)")
+    }
+  }
+}
+
+CStringTests.test("String.UTF8View.count") {
+  let ascii = "abcdef"
+  expectEqual(6, ascii.utf8.count)
+  let i = ascii.utf8.index(ascii.utf8.startIndex, offsetBy: 2)
+  expectEqual(4, ascii.utf8[i..<ascii.utf8.endIndex].count)
+  expectEqual(0, "".utf8.count)
+
+  let nonASCII = "a\u{e9}\u{1F600}"
+  expectEqual(7, nonASCII.utf8.count)
+  expectEqual(Array(nonASCII.utf8).count, nonASCII.utf8.count)
+
+  // UTF-8 input that happens to be ASCII round-trips unchanged.
+  let bytes: [UInt8] = [104, 105, 0x7f]
+  let fromUTF8 = String._fromWellFormedCodeUnitSequence(UTF8.self, input: bytes)
+  expectTrue(fromUTF8._core.isASCII)
+  expectEqual(bytes, Array(fromUTF8.utf8))
+}
+
+CStringTests.test("String.UTF8View/transcoding") {
+  let ascii = String(repeating: "0123456789", count: 3)
+  let samples = [
+    "\u{e9}", "a\u{e9}b", "\u{3042}\u{1F600}", "\u{7ff}\u{800}\u{ffff}",
+    "\u{10000}\u{10ffff}", ascii + "\u{e9}" + ascii,
+    "\u{1F600}" + ascii + "\u{3042}" + ascii + "\u{1F600}"]
+  for sample in samples {
+    let bytes = Array(sample.utf8)
+
+    // UTF-8 to UTF-16.
+    let fromUTF8 = String._fromCodeUnitSequence(UTF8.self, input: bytes)!
+    expectFalse(fromUTF8._core.isASCII)
+    expectEqual(Array(sample.utf16), Array(fromUTF8.utf16))
+    expectEqual(sample, fromUTF8)
+
+    // UTF-16 back to UTF-8.
+    expectEqual(bytes.map { CChar(bitPattern: $0) } + [0],
+      Array(fromUTF8.utf8CString))
+    fromUTF8.withCString {
+      expectEqual(sample, String(validatingUTF8: $0))
+    }
+  }
+
+  // Ill-formed input is still rejected or repaired.
+  let illFormed: [[UInt8]] = [
+    [0x80], [0xc0, 0x80], [0xc2], [0xe0, 0x80, 0x80], [0xed, 0xa0, 0x80],
+    [0xf0, 0x80, 0x80, 0x80], [0xf4, 0x90, 0x80, 0x80], [0xf5, 0x80],
+    Array(ascii.utf8) + [0xe3, 0x81]]
+  for bytes in illFormed {
+    expectNil(String._fromCodeUnitSequence(UTF8.self, input: bytes))
+    let (repaired, hadError) =
+      String._fromCodeUnitSequenceWithRepair(UTF8.self, input: bytes)
+    expectTrue(hadError)
+    expectTrue(repaired.unicodeScalars.contains("\u{fffd}"))
+  }
 }
 
 runAllTests()
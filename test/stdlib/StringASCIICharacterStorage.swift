@@ -0,0 +1,78 @@
+// RUN: %target-run-simple-swift
+// REQUIRES: executable_test
+
+import StdlibUnittest
+
+var ASCIICharacterStorage = TestSuite("ASCIICharacterStorage")
+
+func hasSharedStorage(_ s: String) -> Bool {
+  return s._core._owner == nil && s._core.count == 1 && s._core.isASCII
+}
+
+ASCIICharacterStorage.test("initializers") {
+  let fromCharacter = String(Character("a"))
+  let fromScalar = String(UnicodeScalar(UInt8(ascii: "a")))
+  expectTrue(hasSharedStorage(fromCharacter))
+  expectTrue(hasSharedStorage(fromScalar))
+  expectEqual(fromCharacter._core._baseAddress, fromScalar._core._baseAddress)
+  expectEqual("a", fromCharacter)
+  expectEqual("a", fromScalar)
+
+  // Non-ASCII characters still get a buffer.
+  expectFalse(hasSharedStorage(String(Character("é"))))
+  expectEqual("é", String(Character("é")))
+  expectEqual("\u{7f}", String(UnicodeScalar(0x7f as UInt8)))
+  expectEqual("\0", String(UnicodeScalar(0 as UInt8)))
+}
+
+ASCIICharacterStorage.test("append") {
+  var s = ""
+  s.append("x" as Character)
+  expectTrue(hasSharedStorage(s))
+  expectEqual("x", s)
+
+  // Growing the string copies it into a native buffer and leaves the shared
+  // storage alone.
+  let other = String(Character("x"))
+  s.append("yz")
+  expectEqual("xyz", s)
+  expectNotNil(s._core.nativeBuffer)
+  expectEqual("x", other)
+
+  s.unicodeScalars.append(UnicodeScalar(UInt8(ascii: "!")))
+  expectEqual("xyz!", s)
+
+  // An empty string with a buffer keeps using it.
+  var reserved = ""
+  reserved.reserveCapacity(16)
+  reserved.append("a" as Character)
+  expectNotNil(reserved._core.nativeBuffer)
+  expectEqual("a", reserved)
+}
+
+ASCIICharacterStorage.test("mutation") {
+  var s = String(Character("m"))
+  s.replaceSubrange(s.startIndex..<s.endIndex, with: "n")
+  expectEqual("n", s)
+  expectEqual("m", String(Character("m")))
+  s.removeAll()
+  expectEqual("", s)
+}
+
+ASCIICharacterStorage.test("comparison and hashing") {
+  let a = String(Character("a"))
+  let b = String(Character("b"))
+  expectEqual(a, "a")
+  expectNotEqual(a, b)
+  expectLT(a, b)
+  expectEqual("a".hashValue, a.hashValue)
+
+  var counts: [String: Int] = [:]
+  for c in "abracadabra".characters {
+    counts[String(c)] = (counts[String(c)] ?? 0) + 1
+  }
+  expectEqual(5, counts["a"])
+  expectEqual(2, counts["b"])
+}
+
+runAllTests()
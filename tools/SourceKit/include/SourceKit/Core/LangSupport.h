@@ -477,6 +477,11 @@ public:
                           StringRef ModuleName,
                           ArrayRef<const char *> Args,
                           DocInfoConsumer &Consumer) = 0;
+
+  /// Reports the counters that only the language support can see, such as
+  /// the hit counts of its code completion cache.
+  virtual void getStatistics(
+      std::function<void(StringRef Name, uint64_t Value)> Receiver) = 0;
 };
 
 } // namespace SourceKit
@@ -14,12 +14,18 @@
 #define LLVM_SOURCEKIT_CORE_NOTIFICATIONCENTER_H
 
 #include "SourceKit/Core/LLVM.h"
+#include "llvm/ADT/Optional.h"
 #include <functional>
 #include <vector>
 
 namespace SourceKit {
 
-typedef std::function<void(StringRef DocumentName)>
+/// The range, as (offset, length), of a document whose semantic annotations
+/// changed; the annotations outside of it are the same as before.
+typedef std::pair<unsigned, unsigned> AnnotationsRange;
+
+typedef std::function<void(StringRef DocumentName,
+                           Optional<AnnotationsRange> ChangedRange)>
     DocumentUpdateNotificationReceiver;
 
 class NotificationCenter {
@@ -29,7 +35,13 @@ public:
   void addDocumentUpdateNotificationReceiver(
       DocumentUpdateNotificationReceiver Receiver);
 
-  void postDocumentUpdateNotification(StringRef DocumentName) const;
+  /// Tells the receivers that \p DocumentName has new semantic information.
+  ///
+  /// If only the annotations in \p ChangedRange changed, it is passed along
+  /// so that editors can limit how much they refresh.
+  void postDocumentUpdateNotification(
+      StringRef DocumentName,
+      Optional<AnnotationsRange> ChangedRange = None) const;
 };
 
 } // namespace SourceKit
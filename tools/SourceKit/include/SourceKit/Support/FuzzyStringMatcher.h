@@ -27,11 +27,17 @@ namespace SourceKit {
 /// unicode-correct in that no normalization or non-ASCII upper/lower casing is
 /// supported.  Non-ASCII bytes in the input are treated as opaque.
 class FuzzyStringMatcher {
+public:
+  /// A summary of the characters in a string; see \c getCharacterMask.
+  typedef uint64_t CharacterMask;
+
+private:
   std::string pattern;
   std::string lowercasePattern;
   double maxScore; ///< The maximum possible raw score for this pattern.
   /// If (and only if) c is in pattern, charactersInPattern[c] == 1
   llvm::BitVector charactersInPattern;
+  CharacterMask patternMask;
 
 public:
   bool normalize = false; ///< Whether to normalize scores to [0, 1].
@@ -39,6 +45,23 @@ public:
 public:
   FuzzyStringMatcher(StringRef pattern);
 
+  /// Returns a mask with a bit set for each kind of character in \p str.
+  ///
+  /// ASCII letters are folded to lowercase and each have their own bit, as do
+  /// digits; other bytes share the remaining bits. Candidates that are matched
+  /// against many patterns should compute this once and keep it.
+  static CharacterMask getCharacterMask(StringRef str);
+
+  /// Whether a candidate whose character mask is \p candidateMask contains
+  /// every character of the pattern.
+  ///
+  /// If this returns false, neither \c matchesCandidate nor a case-insensitive
+  /// prefix match can succeed, so the candidate can be rejected without looking
+  /// at it.
+  bool mayMatchCandidate(CharacterMask candidateMask) const {
+    return (patternMask & ~candidateMask) == 0;
+  }
+
   /// Whether \p candidate matches the pattern.
   ///
   /// This operation is much simpler/faster than calculating
@@ -27,6 +27,10 @@ namespace llvm {
   class SourceMgr;
 }
 
+namespace clang {
+  class RewriteRope;
+}
+
 namespace SourceKit {
 
 class ImmutableTextUpdate;
@@ -158,8 +162,16 @@ class EditableTextBuffer : public ThreadSafeRefCountedBase<EditableTextBuffer> {
   ImmutableTextUpdateRef CurrUpd;
   std::string Filename;
 
+  /// Guards \c Rope and \c RopeEnd.
+  llvm::sys::Mutex RopeMtx;
+  /// The text as of \c RopeEnd, kept from the last time a snapshot buffer was
+  /// materialized so that the next one only has to apply the newer updates.
+  std::unique_ptr<clang::RewriteRope> Rope;
+  ImmutableTextUpdateRef RopeEnd;
+
 public:
   explicit EditableTextBuffer(StringRef Filename, StringRef Text = StringRef());
+  ~EditableTextBuffer();
 
   StringRef getFilename() const { return Filename; }
 
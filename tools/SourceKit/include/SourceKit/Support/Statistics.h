@@ -0,0 +1,88 @@
+//===--- Statistics.h - Always-on Performance Statistics --------*- C++ -*-===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_SOURCEKIT_SUPPORT_STATISTICS_H
+#define LLVM_SOURCEKIT_SUPPORT_STATISTICS_H
+
+#include "SourceKit/Core/LLVM.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringRef.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace SourceKit {
+namespace stats {
+
+/// A histogram of durations with one bucket per power of two microseconds.
+///
+/// Recording is lock-free, so it is cheap enough to leave on for every
+/// request.
+class LatencyHistogram {
+public:
+  static const unsigned NumBuckets = 32;
+
+private:
+  std::atomic<uint64_t> Count{0};
+  std::atomic<uint64_t> TotalMicroseconds{0};
+  std::atomic<uint64_t> Buckets[NumBuckets];
+
+public:
+  LatencyHistogram();
+  LatencyHistogram(const LatencyHistogram &) = delete;
+  LatencyHistogram &operator=(const LatencyHistogram &) = delete;
+
+  void record(std::chrono::steady_clock::duration Duration);
+
+  uint64_t getCount() const { return Count; }
+  uint64_t getTotalMicroseconds() const { return TotalMicroseconds; }
+
+  /// Returns an upper bound, in microseconds, on the shortest duration that
+  /// the fraction \p Quantile of the recorded durations don't exceed.
+  uint64_t getQuantileMicroseconds(double Quantile) const;
+};
+
+/// Returns the histogram called \p Name, creating it if needed.
+///
+/// Histograms live until the process exits, so the result can be kept in a
+/// static local on hot paths.
+LatencyHistogram &getHistogram(StringRef Name);
+
+/// Returns the counter called \p Name, creating it if needed.
+std::atomic<uint64_t> &getCounter(StringRef Name);
+
+/// Calls \p Fn for every histogram, in order of name.
+void forEachHistogram(
+    llvm::function_ref<void(StringRef, const LatencyHistogram &)> Fn);
+
+/// Calls \p Fn for every counter, in order of name.
+void forEachCounter(llvm::function_ref<void(StringRef, uint64_t)> Fn);
+
+/// Records the time between its construction and its destruction.
+class ScopedLatency {
+  LatencyHistogram &Histogram;
+  std::chrono::steady_clock::time_point Start;
+
+public:
+  explicit ScopedLatency(LatencyHistogram &Histogram)
+    : Histogram(Histogram), Start(std::chrono::steady_clock::now()) {}
+  explicit ScopedLatency(StringRef Name) : ScopedLatency(getHistogram(Name)) {}
+  ~ScopedLatency() {
+    Histogram.record(std::chrono::steady_clock::now() - Start);
+  }
+};
+
+} // namespace stats
+} // namespace SourceKit
+
+#endif
@@ -24,11 +24,11 @@ void NotificationCenter::addDocumentUpdateNotificationReceiver(
 }
 
 void NotificationCenter::postDocumentUpdateNotification(
-    StringRef DocumentName) const {
+    StringRef DocumentName, Optional<AnnotationsRange> ChangedRange) const {
   
   std::string DocName = DocumentName;
-  WorkQueue::dispatchOnMain([this, DocName]{
+  WorkQueue::dispatchOnMain([this, DocName, ChangedRange]{
     for (auto &Fn : DocUpdReceivers)
-      Fn(DocName);
+      Fn(DocName, ChangedRange);
   });
 }
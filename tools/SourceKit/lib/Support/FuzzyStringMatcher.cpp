@@ -33,6 +33,7 @@ FuzzyStringMatcher::FuzzyStringMatcher(StringRef pattern_)
     charactersInPattern.set(static_cast<unsigned char>(toUppercase(c)));
   }
   assert(pattern.size() == lowercasePattern.size());
+  patternMask = getCharacterMask(pattern);
 
   // FIXME: pull out the magic constants.
   // This depends on the inner details of the matching algorithm and will need
@@ -50,6 +51,25 @@ FuzzyStringMatcher::FuzzyStringMatcher(StringRef pattern_)
   }
 }
 
+FuzzyStringMatcher::CharacterMask
+FuzzyStringMatcher::getCharacterMask(StringRef str) {
+  // Bits 0-25 are the letters, bits 26-35 the digits, and the other 28 bits
+  // are shared by everything else.
+  CharacterMask mask = 0;
+  for (char c : str) {
+    unsigned char lower = static_cast<unsigned char>(toLowercase(c));
+    unsigned bit;
+    if (lower >= 'a' && lower <= 'z')
+      bit = lower - 'a';
+    else if (lower >= '0' && lower <= '9')
+      bit = 26 + (lower - '0');
+    else
+      bit = 36 + lower % 28;
+    mask |= CharacterMask(1) << bit;
+  }
+  return mask;
+}
+
 bool FuzzyStringMatcher::matchesCandidate(StringRef candidate) const {
   unsigned patternLength = pattern.size();
   unsigned candidateLength = candidate.size();
@@ -125,6 +125,8 @@ EditableTextBuffer::EditableTextBuffer(StringRef Filename, StringRef Text) {
   CurrUpd = Root;
 }
 
+EditableTextBuffer::~EditableTextBuffer() {}
+
 ImmutableTextSnapshotRef EditableTextBuffer::getSnapshot() const {
   return new ImmutableTextSnapshot(const_cast<EditableTextBuffer*>(this), Root,
                                    CurrUpd);
@@ -198,33 +200,60 @@ ImmutableTextBufferRef EditableTextBuffer::getBufferForSnapshot(
     if (auto Buf = dyn_cast<ImmutableTextBuffer>(Next))
       return Buf;
 
-  // Check if a buffer was created in the middle of the snapshot updates.
-  ImmutableTextBufferRef StartBuf = Snap.BufferStart;
-  ImmutableTextUpdateRef Upd = StartBuf;  
-  while (Upd != Snap.DiffEnd) {
-    Upd = Upd->Next;
-    if (auto Buf = dyn_cast<ImmutableTextBuffer>(Upd))
-      StartBuf = Buf;
-  }
-  StringRef StartText = StartBuf->getText();
-
-  RewriteRope Rope;
-  auto applyUpdate = [&](const ImmutableTextUpdateRef &Upd) {
-    if (auto ReplaceUpd = dyn_cast<ReplaceImmutableTextUpdate>(Upd)) {
-      Rope.erase(ReplaceUpd->getByteOffset(), ReplaceUpd->getLength());
-      StringRef Text = ReplaceUpd->getText();
-      Rope.insert(ReplaceUpd->getByteOffset(), Text.begin(), Text.end());
+  auto applyUpdates = [&Snap](RewriteRope &Rope, ImmutableTextUpdateRef Upd) {
+    while (Upd != Snap.DiffEnd) {
+      Upd = Upd->Next;
+      if (auto ReplaceUpd = dyn_cast<ReplaceImmutableTextUpdate>(Upd)) {
+        Rope.erase(ReplaceUpd->getByteOffset(), ReplaceUpd->getLength());
+        StringRef Text = ReplaceUpd->getText();
+        Rope.insert(ReplaceUpd->getByteOffset(), Text.begin(), Text.end());
+      }
     }
   };
 
-  Rope.assign(StartText.begin(), StartText.end());
-  Upd = StartBuf;
-  while (Upd != Snap.DiffEnd) {
-    Upd = Upd->Next;
-    applyUpdate(Upd);
+  std::unique_ptr<llvm::MemoryBuffer> MemBuf;
+  {
+    // Snapshots are usually requested in order, so the rope of the previous
+    // one only needs the updates since then, instead of a copy of the whole
+    // text with all the updates replayed on top.
+    llvm::sys::ScopedLock L(RopeMtx);
+    bool RopeIsBeforeSnapshot = false;
+    for (ImmutableTextUpdateRef Upd = RopeEnd; Upd; Upd = Upd->Next) {
+      if (Upd == Snap.DiffEnd) {
+        RopeIsBeforeSnapshot = true;
+        break;
+      }
+    }
+    if (RopeIsBeforeSnapshot) {
+      applyUpdates(*Rope, RopeEnd);
+      RopeEnd = Snap.DiffEnd;
+      MemBuf = getMemBufferFromRope(getFilename(), *Rope);
+    }
+  }
+
+  if (!MemBuf) {
+    // Check if a buffer was created in the middle of the snapshot updates.
+    ImmutableTextBufferRef StartBuf = Snap.BufferStart;
+    ImmutableTextUpdateRef Upd = StartBuf;
+    while (Upd != Snap.DiffEnd) {
+      Upd = Upd->Next;
+      if (auto Buf = dyn_cast<ImmutableTextBuffer>(Upd))
+        StartBuf = Buf;
+    }
+    StringRef StartText = StartBuf->getText();
+
+    std::unique_ptr<RewriteRope> NewRope(new RewriteRope);
+    NewRope->assign(StartText.begin(), StartText.end());
+    applyUpdates(*NewRope, StartBuf);
+    MemBuf = getMemBufferFromRope(getFilename(), *NewRope);
+
+    llvm::sys::ScopedLock L(RopeMtx);
+    if (!Rope) {
+      Rope = std::move(NewRope);
+      RopeEnd = Snap.DiffEnd;
+    }
   }
 
-  auto MemBuf = getMemBufferFromRope(getFilename(), Rope);
   ImmutableTextBufferRef ImmBuf = new ImmutableTextBuffer(std::move(MemBuf),
                                                           Snap.getStamp());
 
@@ -0,0 +1,130 @@
+//===--- Statistics.cpp ---------------------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "SourceKit/Support/Statistics.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/MathExtras.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace SourceKit;
+using namespace SourceKit::stats;
+
+//===----------------------------------------------------------------------===//
+// LatencyHistogram
+//===----------------------------------------------------------------------===//
+
+LatencyHistogram::LatencyHistogram() {
+  for (auto &Bucket : Buckets)
+    Bucket = 0;
+}
+
+void LatencyHistogram::record(std::chrono::steady_clock::duration Duration) {
+  uint64_t Micros =
+    std::chrono::duration_cast<std::chrono::microseconds>(Duration).count();
+  // Bucket N holds the durations that need N bits, i.e. [2^(N-1), 2^N).
+  unsigned Bucket = Micros ? 64 - llvm::countLeadingZeros(Micros) : 0;
+  Bucket = std::min(Bucket, NumBuckets - 1);
+  Buckets[Bucket].fetch_add(1, std::memory_order_relaxed);
+  TotalMicroseconds.fetch_add(Micros, std::memory_order_relaxed);
+  Count.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::getQuantileMicroseconds(double Quantile) const {
+  uint64_t Rank = std::max<uint64_t>(1, std::ceil(Quantile * getCount()));
+  uint64_t Seen = 0;
+  for (unsigned I = 0; I != NumBuckets; ++I) {
+    Seen += Buckets[I].load(std::memory_order_relaxed);
+    if (Seen >= Rank)
+      return (uint64_t(1) << I) - 1;
+  }
+  return 0;
+}
+
+//===----------------------------------------------------------------------===//
+// Registry
+//===----------------------------------------------------------------------===//
+
+namespace {
+struct Registry {
+  std::mutex Mtx;
+  llvm::StringMap<std::unique_ptr<LatencyHistogram>> Histograms;
+  llvm::StringMap<std::unique_ptr<std::atomic<uint64_t>>> Counters;
+
+  static Registry &get() {
+    // Intentionally leaked, so that statistics can be recorded while static
+    // destructors run.
+    static Registry *TheRegistry = new Registry();
+    return *TheRegistry;
+  }
+};
+} // end anonymous namespace
+
+LatencyHistogram &stats::getHistogram(StringRef Name) {
+  Registry &R = Registry::get();
+  std::lock_guard<std::mutex> Lock(R.Mtx);
+  auto &Histogram = R.Histograms[Name];
+  if (!Histogram)
+    Histogram.reset(new LatencyHistogram());
+  return *Histogram;
+}
+
+std::atomic<uint64_t> &stats::getCounter(StringRef Name) {
+  Registry &R = Registry::get();
+  std::lock_guard<std::mutex> Lock(R.Mtx);
+  auto &Counter = R.Counters[Name];
+  if (!Counter)
+    Counter.reset(new std::atomic<uint64_t>(0));
+  return *Counter;
+}
+
+template <typename T>
+static std::vector<std::pair<StringRef, T *>>
+getSortedEntries(llvm::StringMap<std::unique_ptr<T>> &Map) {
+  std::vector<std::pair<StringRef, T *>> Entries;
+  for (auto &Entry : Map)
+    Entries.push_back({ Entry.getKey(), Entry.getValue().get() });
+  std::sort(Entries.begin(), Entries.end(),
+            [](const std::pair<StringRef, T *> &LHS,
+               const std::pair<StringRef, T *> &RHS) {
+    return LHS.first < RHS.first;
+  });
+  return Entries;
+}
+
+void stats::forEachHistogram(
+    llvm::function_ref<void(StringRef, const LatencyHistogram &)> Fn) {
+  Registry &R = Registry::get();
+  std::vector<std::pair<StringRef, LatencyHistogram *>> Entries;
+  {
+    std::lock_guard<std::mutex> Lock(R.Mtx);
+    Entries = getSortedEntries(R.Histograms);
+  }
+  // Entries are never removed, so their names and values stay valid.
+  for (auto &Entry : Entries)
+    Fn(Entry.first, *Entry.second);
+}
+
+void stats::forEachCounter(llvm::function_ref<void(StringRef, uint64_t)> Fn) {
+  Registry &R = Registry::get();
+  std::vector<std::pair<StringRef, std::atomic<uint64_t>*>> Entries;
+  {
+    std::lock_guard<std::mutex> Lock(R.Mtx);
+    Entries = getSortedEntries(R.Counters);
+  }
+  for (auto &Entry : Entries)
+    Fn(Entry.first, Entry.second->load());
+}
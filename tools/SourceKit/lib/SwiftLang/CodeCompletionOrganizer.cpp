@@ -11,6 +11,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "CodeCompletionOrganizer.h"
+#include "SourceKit/Support/Concurrency.h"
 #include "SourceKit/Support/FuzzyStringMatcher.h"
 #include "swift/AST/ASTContext.h"
 #include "swift/AST/Module.h"
@@ -21,6 +22,7 @@
 #include "llvm/ADT/ilist.h"
 #include "llvm/ADT/ilist_node.h"
 #include <deque>
+#include <thread>
 
 using namespace SourceKit;
 using namespace CodeCompletion;
@@ -506,6 +508,41 @@ bool FilterRules::hideCompletion(SwiftResult *completion, StringRef name, void *
   return hideAll;
 }
 
+/// Sets the match score of each of \p results.
+///
+/// Scoring is much slower than matching, so when there are a lot of results
+/// they are scored in chunks on the concurrent queues.
+static void scoreMatches(const FuzzyStringMatcher &pattern,
+                         ArrayRef<Result *> results) {
+  auto scoreRange = [&pattern](ArrayRef<Result *> range) {
+    for (Result *result : range)
+      result->matchScore = pattern.scoreCandidate(result->value->getName());
+  };
+
+  static constexpr size_t minChunkSize = 2048;
+  size_t numChunks = std::min<size_t>(std::thread::hardware_concurrency(),
+                                      results.size() / minChunkSize);
+  if (numChunks <= 1) {
+    scoreRange(results);
+    return;
+  }
+
+  size_t chunkSize = (results.size() + numChunks - 1) / numChunks;
+  Semaphore done(0);
+  for (size_t i = 1; i < numChunks; ++i) {
+    size_t start = i * chunkSize;
+    auto chunk = results.slice(
+        start, std::min(chunkSize, results.size() - start));
+    WorkQueue::dispatchConcurrent([&scoreRange, &done, chunk] {
+      scoreRange(chunk);
+      done.signal();
+    }, WorkQueue::Priority::High);
+  }
+  scoreRange(results.slice(0, chunkSize));
+  for (size_t i = 1; i < numChunks; ++i)
+    done.wait();
+}
+
 void CodeCompletionOrganizer::Impl::addCompletionsWithFilter(
     ArrayRef<Completion *> completions, StringRef filterText, Options options,
     const FilterRules &rules, Completion *&exactMatch) {
@@ -575,7 +612,12 @@ void CodeCompletionOrganizer::Impl::addCompletionsWithFilter(
 
   FuzzyStringMatcher pattern(filterText);
   pattern.normalize = true;
+  std::vector<Result *> toScore;
   for (Completion *completion : completions) {
+    // Most candidates are missing some character of the filter text.
+    if (!pattern.mayMatchCandidate(completion->getNameMask()))
+      continue;
+
     if (rules.hideCompletion(completion))
       continue;
 
@@ -618,14 +660,15 @@ void CodeCompletionOrganizer::Impl::addCompletionsWithFilter(
     // Build wrapper and add to results.
     if (match) {
       auto wrapper = make_result(completion);
-      if (options.fuzzyMatching) {
-        wrapper->matchScore = pattern.scoreCandidate(completion->getName());
-      }
+      if (options.fuzzyMatching)
+        toScore.push_back(wrapper.get());
       wrapper->isExactMatch = isExactMatch;
 
       contents.push_back(std::move(wrapper));
     }
   }
+
+  scoreMatches(pattern, toScore);
 }
 
 static double getSemanticContextScore(bool useImportDepth,
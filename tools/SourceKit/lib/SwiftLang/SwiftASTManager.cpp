@@ -18,6 +18,7 @@
 #include "SourceKit/Support/Concurrency.h"
 #include "SourceKit/Support/ImmutableTextBuffer.h"
 #include "SourceKit/Support/Logging.h"
+#include "SourceKit/Support/Statistics.h"
 #include "SourceKit/Support/Tracing.h"
 
 #include "swift/Basic/Cache.h"
@@ -29,7 +30,9 @@
 // This is included only for createLazyResolver(). Move to different header ?
 #include "swift/Sema/IDETypeChecking.h"
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/FoldingSet.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
@@ -232,12 +235,30 @@ struct FileContent {
       Stamp(Stamp) {}
 };
 
+/// The state of a file that an AST was built from.
+struct FileStamp {
+  BufferStamp Stamp;
+  /// A hash of the contents, if they were read from disk rather than from an
+  /// editor document. It tells whether a file that was merely touched, like a
+  /// module that a build emitted again, really has to be processed again.
+  Optional<llvm::hash_code> ContentHash;
+
+  explicit FileStamp(const FileContent &Content) : Stamp(Content.Stamp) {
+    if (!Content.Snapshot && Content.Buffer)
+      ContentHash = llvm::hash_value(Content.Buffer->getBuffer());
+  }
+};
+
 class ASTProducer : public ThreadSafeRefCountedBase<ASTProducer> {
   SwiftInvocationRef InvokRef;
-  SmallVector<BufferStamp, 8> Stamps;
+  SmallVector<FileStamp, 8> Stamps;
   ThreadSafeRefCntPtr<ASTUnit> AST;
-  SmallVector<std::pair<std::string, BufferStamp>, 8> DependencyStamps;
+  SmallVector<std::pair<std::string, FileStamp>, 8> DependencyStamps;
   std::vector<std::pair<SwiftASTConsumerRef, const void*>> QueuedConsumers;
+  /// The most recent consumer for each once-per-AST token, which may be
+  /// handling an AST already.
+  llvm::DenseMap<const void *, std::weak_ptr<SwiftASTConsumer>>
+      LatestConsumers;
   llvm::sys::Mutex Mtx;
 
 public:
@@ -257,6 +278,8 @@ public:
                      ArrayRef<ImmutableTextSnapshotRef> Snapshots);
 
   void enqueueConsumer(SwiftASTConsumerRef Consumer, const void *OncePerASTToken);
+  void supersedeConsumer(const SwiftASTConsumerRef &Consumer,
+                         const void *OncePerASTToken);
   std::vector<SwiftASTConsumerRef> popQueuedConsumers();
 
   size_t getMemoryCost() const {
@@ -474,6 +497,8 @@ void SwiftASTManager::processASTAsync(SwiftInvocationRef InvokRef,
                                       const void *OncePerASTToken,
                                  ArrayRef<ImmutableTextSnapshotRef> Snapshots) {
   ASTProducerRef Producer = Impl.getASTProducer(InvokRef);
+  if (OncePerASTToken)
+    Producer->supersedeConsumer(ASTConsumer, OncePerASTToken);
 
   if (ASTUnitRef Unit = Producer->getExistingAST()) {
     if (ASTConsumer->canUseASTWithSnapshots(Unit->getSnapshots())) {
@@ -592,7 +617,16 @@ ASTUnitRef ASTProducer::getASTUnitImpl(SwiftASTManager::Implementation &MgrImpl,
       Log->getOS() << Opts.Invok.getModuleName() << '/' << Opts.PrimaryFile;
     }
 
-    auto NewAST = createASTUnit(MgrImpl, Snapshots, Error);
+    static auto &NumBuilt = stats::getCounter("swift.ast.built");
+    static auto &NumRebuilt = stats::getCounter("swift.ast.rebuilt");
+    ++(IsRebuild ? NumRebuilt : NumBuilt);
+
+    ASTUnitRef NewAST;
+    {
+      static auto &BuildTime = stats::getHistogram("swift.ast.build");
+      stats::ScopedLatency Timer(BuildTime);
+      NewAST = createASTUnit(MgrImpl, Snapshots, Error);
+    }
     {
       // FIXME: ThreadSafeRefCntPtr is racy.
       llvm::sys::ScopedLock L(Mtx);
@@ -605,6 +639,9 @@ ASTUnitRef ASTProducer::getASTUnitImpl(SwiftASTManager::Implementation &MgrImpl,
       ASTProducerRef ThisProducer = this;
       MgrImpl.ASTCache.set(InvokRef->Impl.Key, ThisProducer);
     }
+  } else {
+    static auto &NumReused = stats::getCounter("swift.ast.reused");
+    ++NumReused;
   }
 
   return AST;
@@ -626,6 +663,15 @@ void ASTProducer::enqueueConsumer(SwiftASTConsumerRef Consumer,
   QueuedConsumers.push_back({ std::move(Consumer), OncePerASTToken });
 }
 
+void ASTProducer::supersedeConsumer(const SwiftASTConsumerRef &Consumer,
+                                    const void *OncePerASTToken) {
+  llvm::sys::ScopedLock L(Mtx);
+  auto &Latest = LatestConsumers[OncePerASTToken];
+  if (SwiftASTConsumerRef Previous = Latest.lock())
+    Previous->requestCancellation();
+  Latest = Consumer;
+}
+
 std::vector<SwiftASTConsumerRef> ASTProducer::popQueuedConsumers() {
   llvm::sys::ScopedLock L(Mtx);
   std::vector<SwiftASTConsumerRef> Consumers;
@@ -636,31 +682,50 @@ std::vector<SwiftASTConsumerRef> ASTProducer::popQueuedConsumers() {
   return Consumers;
 }
 
+/// Whether the file at \p Filename is still the one that \p Stamp describes.
+///
+/// A file whose stamp changed but whose contents are the same as before is
+/// unchanged; \p Stamp is updated so that its contents aren't compared again.
+static bool isUnchanged(SwiftASTManager::Implementation &MgrImpl,
+                        StringRef Filename, FileStamp &Stamp) {
+  if (MgrImpl.getBufferStamp(Filename) == Stamp.Stamp)
+    return true;
+  if (!Stamp.ContentHash)
+    return false;
+
+  std::string Error;
+  FileStamp Current(MgrImpl.getFileContent(Filename, Error));
+  if (!Current.ContentHash || *Current.ContentHash != *Stamp.ContentHash)
+    return false;
+  Stamp.Stamp = Current.Stamp;
+  return true;
+}
+
 bool ASTProducer::shouldRebuild(SwiftASTManager::Implementation &MgrImpl,
                                 ArrayRef<ImmutableTextSnapshotRef> Snapshots) {
   const SwiftInvocation::Implementation &Invok = InvokRef->Impl;
 
   // Check if the inputs changed.
-  SmallVector<BufferStamp, 8> InputStamps;
-  InputStamps.reserve(Invok.Opts.Invok.getInputFilenames().size());
-  for (auto &File : Invok.Opts.Invok.getInputFilenames()) {
+  ArrayRef<std::string> InputFiles = Invok.Opts.Invok.getInputFilenames();
+  if (Stamps.size() != InputFiles.size())
+    return true;
+  for (unsigned i = 0, e = InputFiles.size(); i != e; ++i) {
+    auto &File = InputFiles[i];
     bool FoundSnapshot = false;
     for (auto &Snap : Snapshots) {
       if (Snap->getFilename() == File) {
         FoundSnapshot = true;
-        InputStamps.push_back(Snap->getStamp());
+        if (Snap->getStamp() != Stamps[i].Stamp)
+          return true;
         break;
       }
     }
-    if (!FoundSnapshot)
-      InputStamps.push_back(MgrImpl.getBufferStamp(File));
+    if (!FoundSnapshot && !isUnchanged(MgrImpl, File, Stamps[i]))
+      return true;
   }
-  assert(InputStamps.size() == Invok.Opts.Invok.getInputFilenames().size());
-  if (Stamps != InputStamps)
-    return true;
 
   for (auto &Dependency : DependencyStamps) {
-    if (Dependency.second != MgrImpl.getBufferStamp(Dependency.first))
+    if (!isUnchanged(MgrImpl, Dependency.first, Dependency.second))
       return true;
   }
 
@@ -750,7 +815,7 @@ ASTUnitRef ASTProducer::createASTUnit(SwiftASTManager::Implementation &MgrImpl,
   assert(Contents.size() == Opts.Invok.getInputFilenames().size());
 
   for (auto &Content : Contents)
-    Stamps.push_back(Content.Stamp);
+    Stamps.push_back(FileStamp(Content));
 
   trace::SwiftInvocation TraceInfo;
 
@@ -797,7 +862,11 @@ ASTUnitRef ASTProducer::createASTUnit(SwiftASTManager::Implementation &MgrImpl,
   CloseClangModuleFiles scopedCloseFiles(
       *CompIns.getASTContext().getClangModuleLoader());
   Consumer.setInputBufferIDs(ASTRef->getCompilerInstance().getInputBufferIDs());
-  CompIns.performSema();
+  {
+    static auto &SemaTime = stats::getHistogram("swift.ast.sema");
+    stats::ScopedLatency Timer(SemaTime);
+    CompIns.performSema();
+  }
 
   llvm::SmallPtrSet<Module *, 16> Visited;
   SmallVector<std::string, 8> Filenames;
@@ -805,8 +874,9 @@ ASTUnitRef ASTProducer::createASTUnit(SwiftASTManager::Implementation &MgrImpl,
   // FIXME: There exists a small window where the module file may have been
   // modified after compilation finished and before we get its stamp.
   for (auto &Filename : Filenames) {
-    DependencyStamps.push_back(std::make_pair(Filename,
-                                              MgrImpl.getBufferStamp(Filename)));
+    std::string Error;
+    FileStamp Stamp(MgrImpl.getFileContent(Filename, Error));
+    DependencyStamps.push_back(std::make_pair(Filename, std::move(Stamp)));
   }
 
   // Since we only typecheck the primary file (plus referenced constructs
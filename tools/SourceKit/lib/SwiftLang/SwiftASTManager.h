@@ -17,6 +17,7 @@
 #include "SourceKit/Core/LLVM.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/StringRef.h"
+#include <atomic>
 #include <functional>
 #include <string>
 
@@ -65,9 +66,21 @@ public:
 typedef IntrusiveRefCntPtr<ASTUnit> ASTUnitRef;
 
 class SwiftASTConsumer {
+  std::atomic<bool> CancellationRequested{false};
+
 public:
   virtual ~SwiftASTConsumer() { }
   virtual void cancelled() {}
+
+  /// Asks the consumer to stop early, because a newer request has made its
+  /// results obsolete.
+  ///
+  /// Cancellation is cooperative: a consumer that is already handling an AST
+  /// should check \c isCancellationRequested() in its loops and return
+  /// without reporting anything once it is set.
+  void requestCancellation() { CancellationRequested = true; }
+  bool isCancellationRequested() const { return CancellationRequested; }
+
   /// If there is an existing AST, this is called before trying to update it.
   /// Consumers may choose to still accept it even though it may have stale parts.
   ///
@@ -17,6 +17,7 @@
 #include "SourceKit/Core/NotificationCenter.h"
 #include "SourceKit/Support/ImmutableTextBuffer.h"
 #include "SourceKit/Support/Logging.h"
+#include "SourceKit/Support/Statistics.h"
 #include "SourceKit/Support/Tracing.h"
 #include "SourceKit/Support/UIdent.h"
 
@@ -399,6 +400,12 @@ class SwiftDocumentSemanticInfo :
   ImmutableTextSnapshotRef TokSnapshot;
   std::vector<SwiftSemanticToken> SemaToks;
 
+  /// All the tokens of the last annotated AST, in the coordinates of
+  /// \c AnnotatedSnapshot. Unlike \c SemaToks these are never handed out, so
+  /// that the next AST can reuse the tokens of the decls that didn't change.
+  ImmutableTextSnapshotRef AnnotatedSnapshot;
+  std::vector<SwiftSemanticToken> AnnotatedToks;
+
   ImmutableTextSnapshotRef DiagSnapshot;
   std::vector<DiagnosticEntryInfo> SemaDiags;
 
@@ -427,10 +434,16 @@ public:
 
   void processLatestSnapshotAsync(EditableTextBufferRef EditableBuffer);
 
+  void getAnnotatedTokens(ImmutableTextSnapshotRef &Snapshot,
+                          std::vector<SwiftSemanticToken> &Tokens) const;
+
+  /// \param ChangedRange If only the tokens in this range of \p Snapshot
+  /// differ from the previous ones, the range to tell the editor about.
   void updateSemanticInfo(std::vector<SwiftSemanticToken> Toks,
                           std::vector<DiagnosticEntryInfo> Diags,
                           ImmutableTextSnapshotRef Snapshot,
-                          uint64_t ASTGeneration);
+                          uint64_t ASTGeneration,
+                          Optional<SwiftEditorCharRange> ChangedRange);
   void removeCachedAST() {
     if (InvokRef)
       ASTMgr.removeCachedAST(InvokRef);
@@ -541,22 +554,41 @@ void SwiftDocumentSemanticInfo::readSemanticInfo(
   Diags = getSemanticDiagnostics(NewSnapshot, ParserDiags);
 }
 
-std::vector<SwiftSemanticToken>
-SwiftDocumentSemanticInfo::takeSemanticTokens(
-    ImmutableTextSnapshotRef NewSnapshot) {
-
-  llvm::sys::ScopedLock L(Mtx);
+/// Moves \p Toks from the coordinates of \p From to those of \p To, dropping
+/// the tokens that the edits in between touched.
+///
+/// \returns the range of \p To that covers all of the edits, or None if there
+/// weren't any.
+static Optional<SwiftEditorCharRange>
+adjustSemanticTokens(std::vector<SwiftSemanticToken> &Toks,
+                     ImmutableTextSnapshotRef From,
+                     ImmutableTextSnapshotRef To) {
+  Optional<std::pair<unsigned, unsigned>> Edited; // [begin, end)
+
+  From->foreachReplaceUntil(To,
+    [&](ReplaceImmutableTextUpdateRef Upd) -> bool {
+      unsigned InsertLen = Upd->getText().size();
+      int Delta = InsertLen - Upd->getLength();
 
-  if (SemaToks.empty())
-    return {};
+      // Grow the edited range to cover this edit, in the new coordinates.
+      unsigned RemoveEnd = Upd->getByteOffset() + Upd->getLength();
+      unsigned InsertEnd = Upd->getByteOffset() + InsertLen;
+      if (!Edited) {
+        Edited = std::make_pair(Upd->getByteOffset(), InsertEnd);
+      } else {
+        unsigned End = Edited->second;
+        if (End >= RemoveEnd)
+          End += Delta;
+        else if (End > Upd->getByteOffset())
+          End = InsertEnd;
+        Edited->first = std::min(Edited->first, Upd->getByteOffset());
+        Edited->second = std::max(End, InsertEnd);
+      }
 
-  // Adjust the position of the tokens.
-  TokSnapshot->foreachReplaceUntil(NewSnapshot,
-    [&](ReplaceImmutableTextUpdateRef Upd) -> bool {
-      if (SemaToks.empty())
-        return false;
+      if (Toks.empty())
+        return true;
 
-      auto ReplaceBegin = std::lower_bound(SemaToks.begin(), SemaToks.end(),
+      auto ReplaceBegin = std::lower_bound(Toks.begin(), Toks.end(),
           Upd->getByteOffset(),
           [&](const SwiftSemanticToken &Tok, unsigned StartOffset) -> bool {
             return Tok.ByteOffset+Tok.Length < StartOffset;
@@ -566,27 +598,49 @@ SwiftDocumentSemanticInfo::takeSemanticTokens(
       if (Upd->getLength() == 0) {
         ReplaceEnd = ReplaceBegin;
       } else {
-        ReplaceEnd = std::upper_bound(ReplaceBegin, SemaToks.end(),
-            Upd->getByteOffset() + Upd->getLength(),
+        ReplaceEnd = std::upper_bound(ReplaceBegin, Toks.end(), RemoveEnd,
             [&](unsigned EndOffset, const SwiftSemanticToken &Tok) -> bool {
               return EndOffset < Tok.ByteOffset;
             });
       }
 
-      unsigned InsertLen = Upd->getText().size();
-      int Delta = InsertLen - Upd->getLength();
       if (Delta != 0) {
         for (std::vector<SwiftSemanticToken>::iterator
-               I = ReplaceEnd, E = SemaToks.end(); I != E; ++I)
+               I = ReplaceEnd, E = Toks.end(); I != E; ++I)
           I->ByteOffset += Delta;
       }
-      SemaToks.erase(ReplaceBegin, ReplaceEnd);
+      Toks.erase(ReplaceBegin, ReplaceEnd);
       return true;
     });
 
+  if (!Edited)
+    return None;
+  return SwiftEditorCharRange(Edited->first, Edited->second - Edited->first);
+}
+
+std::vector<SwiftSemanticToken>
+SwiftDocumentSemanticInfo::takeSemanticTokens(
+    ImmutableTextSnapshotRef NewSnapshot) {
+
+  llvm::sys::ScopedLock L(Mtx);
+
+  if (SemaToks.empty())
+    return {};
+
+  // Adjust the position of the tokens.
+  adjustSemanticTokens(SemaToks, TokSnapshot, NewSnapshot);
+
   return std::move(SemaToks);
 }
 
+void SwiftDocumentSemanticInfo::getAnnotatedTokens(
+    ImmutableTextSnapshotRef &Snapshot,
+    std::vector<SwiftSemanticToken> &Tokens) const {
+  llvm::sys::ScopedLock L(Mtx);
+  Snapshot = AnnotatedSnapshot;
+  Tokens = AnnotatedToks;
+}
+
 static bool
 adjustDiagnosticRanges(SmallVectorImpl<std::pair<unsigned, unsigned>> &Ranges,
                        unsigned ByteOffset, unsigned RemoveLen, int Delta) {
@@ -742,20 +796,26 @@ void SwiftDocumentSemanticInfo::updateSemanticInfo(
     std::vector<SwiftSemanticToken> Toks,
     std::vector<DiagnosticEntryInfo> Diags,
     ImmutableTextSnapshotRef Snapshot,
-    uint64_t ASTGeneration) {
+    uint64_t ASTGeneration,
+    Optional<SwiftEditorCharRange> ChangedRange) {
 
   {
     llvm::sys::ScopedLock L(Mtx);
     if (ASTGeneration > this->ASTGeneration) {
+      AnnotatedToks = Toks;
       SemaToks = std::move(Toks);
       SemaDiags = std::move(Diags);
+      AnnotatedSnapshot = Snapshot;
       TokSnapshot = DiagSnapshot = std::move(Snapshot);
       this->ASTGeneration = ASTGeneration;
+    } else {
+      // A newer AST got here first; the range is relative to older tokens.
+      ChangedRange = None;
     }
   }
 
   LOG_INFO_FUNC(High, "posted document update notification for: " << Filename);
-  NotificationCtr.postDocumentUpdateNotification(Filename);
+  NotificationCtr.postDocumentUpdateNotification(Filename, ChangedRange);
 }
 
 namespace {
@@ -763,15 +823,21 @@ namespace {
 class SemanticAnnotator : public SourceEntityWalker {
   SourceManager &SM;
   unsigned BufferID;
+  const SwiftASTConsumer &Consumer;
 public:
 
   std::vector<SwiftSemanticToken> SemaToks;
 
-  SemanticAnnotator(SourceManager &SM, unsigned BufferID)
-    : SM(SM), BufferID(BufferID) {}
+  SemanticAnnotator(SourceManager &SM, unsigned BufferID,
+                    const SwiftASTConsumer &Consumer)
+    : SM(SM), BufferID(BufferID), Consumer(Consumer) {}
 
   bool visitDeclReference(ValueDecl *D, CharSourceRange Range,
                           TypeDecl *CtorTyRef, Type T) override {
+    // Stop walking if a newer request for the document came in.
+    if (Consumer.isCancellationRequested())
+      return false;
+
     if (isa<VarDecl>(D) && D->hasName() && D->getName().str() == "self")
       return true;
 
@@ -802,6 +868,99 @@ public:
 
 } // anonymous namespace
 
+/// Returns true if [Begin, End) is inside the braces of the body of \p D, or
+/// of one of its members.
+static bool isInsideFunctionBody(Decl *D, unsigned Begin, unsigned End,
+                                 SourceManager &SM, unsigned BufferID) {
+  auto isInsideMemberBody = [&](DeclRange Members) -> bool {
+    for (Decl *Member : Members) {
+      if (isInsideFunctionBody(Member, Begin, End, SM, BufferID))
+        return true;
+    }
+    return false;
+  };
+
+  if (auto *AFD = dyn_cast<AbstractFunctionDecl>(D)) {
+    SourceRange Body = AFD->getBodySourceRange();
+    if (Body.isInvalid())
+      return false;
+    unsigned LBrace = SM.getLocOffsetInBuffer(Body.Start, BufferID);
+    unsigned RBrace = SM.getLocOffsetInBuffer(Body.End, BufferID);
+    return LBrace < Begin && End <= RBrace;
+  }
+  if (auto *NTD = dyn_cast<NominalTypeDecl>(D))
+    return isInsideMemberBody(NTD->getMembers());
+  if (auto *ED = dyn_cast<ExtensionDecl>(D))
+    return isInsideMemberBody(ED->getMembers());
+  return false;
+}
+
+/// Annotates only the top-level decl of \p SF that contains the edits made
+/// since \p PrevSnapshot, and reuses \p PrevToks for the rest of the file.
+///
+/// This is only done when the edits are all inside one function body, since
+/// nothing outside of a body can depend on what is in it.
+///
+/// \returns the range of \p Snapshot whose tokens were replaced, or None,
+/// without annotating anything, if the whole file needs to be annotated.
+static Optional<SwiftEditorCharRange>
+annotateIncrementally(SemanticAnnotator &Annotator, SourceFile &SF,
+                      SourceManager &SM, unsigned BufferID,
+                      ImmutableTextSnapshotRef PrevSnapshot,
+                      std::vector<SwiftSemanticToken> PrevToks,
+                      ImmutableTextSnapshotRef Snapshot) {
+  if (!PrevSnapshot || !PrevSnapshot->isFromSameBuffer(Snapshot) ||
+      !PrevSnapshot->precedesOrSame(Snapshot))
+    return None;
+
+  // Without edits, the AST was rebuilt because a dependency changed, which
+  // can affect any decl.
+  Optional<SwiftEditorCharRange> Edited =
+      adjustSemanticTokens(PrevToks, PrevSnapshot, Snapshot);
+  if (!Edited)
+    return None;
+  unsigned EditBegin = Edited->first;
+  unsigned EditEnd = Edited->first + Edited->second;
+
+  for (Decl *D : SF.Decls) {
+    CharSourceRange Range =
+        Lexer::getCharSourceRangeFromSourceRange(SM, D->getSourceRange());
+    if (Range.isInvalid())
+      continue;
+    unsigned Begin = SM.getLocOffsetInBuffer(Range.getStart(), BufferID);
+    unsigned End = Begin + Range.getByteLength();
+    if (EditBegin < Begin || EditEnd > End)
+      continue;
+    if (!isInsideFunctionBody(D, EditBegin, EditEnd, SM, BufferID))
+      return None;
+
+    Annotator.walk(D);
+    std::vector<SwiftSemanticToken> DeclToks = std::move(Annotator.SemaToks);
+    if (!DeclToks.empty()) {
+      // Attributes may be outside of the decl's range.
+      Begin = std::min(Begin, DeclToks.front().ByteOffset);
+      End = std::max(End, DeclToks.back().ByteOffset + DeclToks.back().Length);
+    }
+
+    auto precedes = [](const SwiftSemanticToken &Tok, unsigned Offset) {
+      return Tok.ByteOffset < Offset;
+    };
+    auto DeclBegin = std::lower_bound(PrevToks.begin(), PrevToks.end(), Begin,
+                                      precedes);
+    auto DeclEnd = std::lower_bound(DeclBegin, PrevToks.end(), End, precedes);
+
+    std::vector<SwiftSemanticToken> &Toks = Annotator.SemaToks;
+    Toks.clear();
+    Toks.reserve(PrevToks.size() - (DeclEnd - DeclBegin) + DeclToks.size());
+    Toks.insert(Toks.end(), PrevToks.begin(), DeclBegin);
+    Toks.insert(Toks.end(), DeclToks.begin(), DeclToks.end());
+    Toks.insert(Toks.end(), DeclEnd, PrevToks.end());
+    return SwiftEditorCharRange(Begin, End - Begin);
+  }
+
+  return None;
+}
+
 namespace {
 
 class AnnotAndDiagASTConsumer : public SwiftASTConsumer {
@@ -870,8 +1029,32 @@ public:
       TracedOp.start(trace::OperationKind::AnnotAndDiag, SwiftArgs);
     }
 
-    SemanticAnnotator Annotator(CompIns.getSourceMgr(), BufferID);
-    Annotator.walk(AstUnit->getPrimarySourceFile());
+    ImmutableTextSnapshotRef PrevSnapshot;
+    std::vector<SwiftSemanticToken> PrevToks;
+    SemaInfoRef->getAnnotatedTokens(PrevSnapshot, PrevToks);
+
+    SemanticAnnotator Annotator(CompIns.getSourceMgr(), BufferID, *this);
+    Optional<SwiftEditorCharRange> ChangedRange;
+    {
+      static auto &AnnotateTime = stats::getHistogram("swift.sema-annotations");
+      stats::ScopedLatency Timer(AnnotateTime);
+      SourceFile &SF = AstUnit->getPrimarySourceFile();
+      ChangedRange = annotateIncrementally(
+          Annotator, SF, CompIns.getSourceMgr(), BufferID,
+          std::move(PrevSnapshot), std::move(PrevToks), DocSnapshot);
+      if (ChangedRange) {
+        static auto &NumIncremental =
+            stats::getCounter("swift.sema-annotations.incremental");
+        ++NumIncremental;
+      } else {
+        Annotator.walk(SF);
+      }
+    }
+    if (isCancellationRequested()) {
+      // The newer request will update the semantic info instead.
+      LOG_INFO_FUNC(High, "sema annotations cancelled");
+      return;
+    }
     SemaToks = std::move(Annotator.SemaToks);
 
     TracedOp.finish();
@@ -880,7 +1063,8 @@ public:
       updateSemanticInfo(std::move(SemaToks),
                      std::move(Consumer.getDiagnosticsForBuffer(BufferID)),
                          DocSnapshot,
-                         Generation);
+                         Generation,
+                         ChangedRange);
 
     if (DocSnapshot->getStamp() != EditableBuffer->getSnapshot()->getStamp()) {
       // Handle edits that occurred after we processed the AST.
@@ -1215,6 +1399,8 @@ public:
 class SwiftEditorSyntaxWalker: public ide::SyntaxModelWalker {
   SwiftSyntaxMap &SyntaxMap;
   LineRange EditedLineRange;
+  /// The byte offset of the first line of EditedLineRange.
+  unsigned EditedLinesOffset = 0;
   SwiftEditorCharRange &AffectedRange;
   SourceManager &SrcManager;
   EditorConsumer &Consumer;
@@ -1231,7 +1417,13 @@ public:
     : SyntaxMap(SyntaxMap), EditedLineRange(EditedLineRange),
       AffectedRange(AffectedRange), SrcManager(SrcManager), Consumer(Consumer),
       BufferID(BufferID),
-      DocStructureWalker(SrcManager, BufferID, Consumer) { }
+      DocStructureWalker(SrcManager, BufferID, Consumer) {
+    if (EditedLineRange.isValid()) {
+      if (auto Offset = SrcManager.resolveFromLineCol(
+              BufferID, EditedLineRange.startLine(), 1))
+        EditedLinesOffset = *Offset;
+    }
+  }
 
   bool walkToNodePre(SyntaxNode Node) override {
     if (Node.Kind == SyntaxNodeKind::CommentMarker)
@@ -1239,15 +1431,27 @@ public:
 
     ++NestingLevel;
     SourceLoc StartLoc = Node.Range.getStart();
+    unsigned Offset = SrcManager.getByteDistance(
+                           SrcManager.getLocForBufferStart(BufferID), StartLoc);
+    // Note that the length can span multiple lines.
+    unsigned Length = Node.Range.getByteLength();
+
+    // Most nodes of a large file are outside the edited range. Recognize the
+    // ones that end before the edited lines or start after the synced-up
+    // affected range by their offsets, so that we don't have to look up
+    // their lines and columns, which costs much more.
+    if (EditedLineRange.isValid()) {
+      if (Offset + Length <= EditedLinesOffset)
+        return true;
+      if (Offset > AffectedRange.first + AffectedRange.second)
+        return true;
+    }
+
     auto StartLineAndColumn = SrcManager.getLineAndColumn(StartLoc);
     auto EndLineAndColumn = SrcManager.getLineAndColumn(Node.Range.getEnd());
     unsigned StartLine = StartLineAndColumn.first;
     unsigned EndLine = EndLineAndColumn.second > 1 ? EndLineAndColumn.first
                                                    : EndLineAndColumn.first - 1;
-    unsigned Offset = SrcManager.getByteDistance(
-                           SrcManager.getLocForBufferStart(BufferID), StartLoc);
-    // Note that the length can span multiple lines.
-    unsigned Length = Node.Range.getByteLength();
 
     SwiftSyntaxToken Token(StartLineAndColumn.second, Length,
                            Node.Kind);
@@ -1264,6 +1468,7 @@ public:
         unsigned AdjLineCount = EditedLineRange.startLine() - StartLine;
         EditedLineRange.setRange(StartLine, AdjLineCount
                                             + EditedLineRange.lineCount());
+        EditedLinesOffset = Offset - (StartLineAndColumn.second - 1);
         SyntaxMap.clearLineRange(StartLine, AdjLineCount);
 
         // Also adjust the affected char range accordingly.
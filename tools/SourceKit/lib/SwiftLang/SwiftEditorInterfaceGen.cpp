@@ -72,6 +72,10 @@ public:
   std::string DocumentName;
   bool IsModule = false;
   std::string ModuleOrHeaderName;
+  // The arguments that the module interface was printed with.
+  Optional<std::string> Group;
+  bool SynthesizedExtensions = false;
+  Optional<std::string> InterestedUSR;
   CompilerInvocation Invocation;
   PrintingDiagnosticConsumer DiagConsumer;
   CompilerInstance Instance;
@@ -391,6 +395,11 @@ SwiftInterfaceGenContext::create(StringRef DocumentName,
   IFaceGenCtx->Impl.DocumentName = DocumentName;
   IFaceGenCtx->Impl.IsModule = IsModule;
   IFaceGenCtx->Impl.ModuleOrHeaderName = ModuleOrHeaderName;
+  if (Group)
+    IFaceGenCtx->Impl.Group = Group->str();
+  IFaceGenCtx->Impl.SynthesizedExtensions = SynthesizedExtensions;
+  if (InterestedUSR)
+    IFaceGenCtx->Impl.InterestedUSR = InterestedUSR->str();
   IFaceGenCtx->Impl.Invocation = Invocation;
   CompilerInstance &CI = IFaceGenCtx->Impl.Instance;
 
@@ -541,6 +550,32 @@ bool SwiftInterfaceGenContext::matches(StringRef ModuleName,
   return true;
 }
 
+static bool equalOptionalStrings(const Optional<std::string> &LHS,
+                                 Optional<StringRef> RHS) {
+  if (LHS.hasValue() != RHS.hasValue())
+    return false;
+  return !LHS || *LHS == *RHS;
+}
+
+bool SwiftInterfaceGenContext::isReusableFor(
+    StringRef ModuleName, Optional<StringRef> Group,
+    const swift::CompilerInvocation &Invok, bool SynthesizedExtensions,
+    Optional<StringRef> InterestedUSR) {
+  // Only the interfaces of system modules and the stdlib are known not to
+  // change while the SDK stays the same.
+  if (!Impl.Mod || !Impl.Mod->isSystemModule())
+    return false;
+  if (!matches(ModuleName, Invok))
+    return false;
+  if (Invok.getClangImporterOptions().ExtraArgs !=
+      Impl.Invocation.getClangImporterOptions().ExtraArgs)
+    return false;
+
+  return equalOptionalStrings(Impl.Group, Group) &&
+         Impl.SynthesizedExtensions == SynthesizedExtensions &&
+         equalOptionalStrings(Impl.InterestedUSR, InterestedUSR);
+}
+
 void SwiftInterfaceGenContext::reportEditorInfo(EditorConsumer &Consumer) const {
   Consumer.handleSourceText(Impl.Info.Text);
   reportSyntacticAnnotations(Impl.TextCI, Consumer);
@@ -712,6 +747,21 @@ void SwiftLangSupport::editorOpenInterface(EditorConsumer &Consumer,
 
   Invocation.getClangImporterOptions().ImportForwardDeclarations = true;
 
+  // Opening the same SDK module's interface again, or jumping to one of its
+  // declarations, doesn't need the whole module imported and printed again.
+  if (auto Existing = IFaceGenContexts.get(Name)) {
+    if (Existing->isReusableFor(ModuleName, Group, Invocation,
+                                SynthesizedExtensions, InterestedUSR)) {
+      Semaphore Done(0);
+      Existing->accessASTAsync([&] {
+        Existing->reportEditorInfo(Consumer);
+        Done.signal();
+      });
+      Done.wait();
+      return;
+    }
+  }
+
   std::string ErrMsg;
   auto IFaceGenRef = SwiftInterfaceGenContext::create(Name,
                                                       /*IsModule=*/true,
@@ -60,6 +60,13 @@ public:
 
   bool matches(StringRef ModuleName, const swift::CompilerInvocation &Invok);
 
+  /// Whether this context is the interface of a system module that \c create
+  /// would generate again, identically, for the given arguments.
+  bool isReusableFor(StringRef ModuleName, Optional<StringRef> Group,
+                     const swift::CompilerInvocation &Invok,
+                     bool SynthesizedExtensions,
+                     Optional<StringRef> InterestedUSR);
+
   /// Note: requires exclusive access to the underlying AST.
   void reportEditorInfo(EditorConsumer &Consumer) const;
 
@@ -281,6 +281,15 @@ SwiftLangSupport::SwiftLangSupport(SourceKit::Context &SKCtx)
 SwiftLangSupport::~SwiftLangSupport() {
 }
 
+void SwiftLangSupport::getStatistics(
+    std::function<void(StringRef Name, uint64_t Value)> Receiver) {
+  ide::CodeCompletionCache::Statistics Stats =
+      getCodeCompletionCache()->getCache().getStatistics();
+  Receiver("swift.completion-cache.hits", Stats.Hits);
+  Receiver("swift.completion-cache.disk-hits", Stats.DiskHits);
+  Receiver("swift.completion-cache.misses", Stats.Misses);
+}
+
 UIdent SwiftLangSupport::getUIDForDecl(const Decl *D, bool IsRef) {
   return UIdentVisitor(IsRef).visit(const_cast<Decl*>(D));
 }
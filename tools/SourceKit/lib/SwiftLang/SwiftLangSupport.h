@@ -398,6 +398,9 @@ public:
 
   void findModuleGroups(StringRef ModuleName, ArrayRef<const char *> Args,
                std::function<void(ArrayRef<StringRef>, StringRef Error)> Receiver) override;
+
+  void getStatistics(
+      std::function<void(StringRef Name, uint64_t Value)> Receiver) override;
 };
 
 namespace trace {
@@ -152,6 +152,7 @@ static sourcekitd_uid_t RequestEditorFindUSR;
 static sourcekitd_uid_t RequestEditorFindInterfaceDoc;
 static sourcekitd_uid_t RequestDocInfo;
 static sourcekitd_uid_t RequestModuleGroups;
+static sourcekitd_uid_t RequestStatistics;
 
 static sourcekitd_uid_t SemaDiagnosticStage;
 
@@ -269,6 +270,7 @@ static int skt_main(int argc, const char **argv) {
   RequestEditorFindInterfaceDoc = sourcekitd_uid_get_from_cstr("source.request.editor.find_interface_doc");
   RequestDocInfo = sourcekitd_uid_get_from_cstr("source.request.docinfo");
   RequestModuleGroups = sourcekitd_uid_get_from_cstr("source.request.module.groups");
+  RequestStatistics = sourcekitd_uid_get_from_cstr("source.request.statistics");
 
   // A test invocation may initialize the options to be used for subsequent
   // invocations.
@@ -672,6 +674,10 @@ static int handleTestInvocation(ArrayRef<const char *> Args,
     }
     sourcekitd_request_dictionary_set_uid(Req, KeyRequest, RequestModuleGroups);
     break;
+
+  case SourceKitRequest::Statistics:
+    sourcekitd_request_dictionary_set_uid(Req, KeyRequest, RequestStatistics);
+    break;
   }
 
   if (!SourceFile.empty()) {
@@ -790,6 +796,7 @@ static bool handleResponse(sourcekitd_response_t Resp, const TestOptions &Opts,
     case SourceKitRequest::CodeCompleteUpdate:
     case SourceKitRequest::CodeCompleteCacheOnDisk:
     case SourceKitRequest::CodeCompleteSetPopularAPI:
+    case SourceKitRequest::Statistics:
       sourcekitd_response_description_dump_filedesc(Resp, STDOUT_FILENO);
       break;
 
@@ -120,6 +120,14 @@ extern SourceKit::UIdent KeyTypeInterface;
 extern SourceKit::UIdent KeyTypeUsr;
 extern SourceKit::UIdent KeyContainerTypeUsr;
 extern SourceKit::UIdent KeyModuleGroups;
+extern SourceKit::UIdent KeyHistograms;
+extern SourceKit::UIdent KeyCounters;
+extern SourceKit::UIdent KeyCount;
+extern SourceKit::UIdent KeyValue;
+extern SourceKit::UIdent KeyTotalUsec;
+extern SourceKit::UIdent KeyP50Usec;
+extern SourceKit::UIdent KeyP90Usec;
+extern SourceKit::UIdent KeyP99Usec;
 
 /// \brief Used for determining the printing order of dictionary keys.
 bool compareDictKeys(SourceKit::UIdent LHS, SourceKit::UIdent RHS);
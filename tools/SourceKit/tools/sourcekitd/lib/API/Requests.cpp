@@ -20,6 +20,7 @@
 #include "SourceKit/Core/NotificationCenter.h"
 #include "SourceKit/Support/Concurrency.h"
 #include "SourceKit/Support/Logging.h"
+#include "SourceKit/Support/Statistics.h"
 #include "SourceKit/Support/UIdent.h"
 #include "SourceKit/SwiftLang/Factory.h"
 
@@ -63,6 +64,8 @@ static LazySKDUID RequestProtocolVersion("source.request.protocol_version");
 
 static LazySKDUID RequestCrashWithExit("source.request.crash_exit");
 
+static LazySKDUID RequestStatistics("source.request.statistics");
+
 static LazySKDUID RequestDemangle("source.request.demangle");
 static LazySKDUID RequestMangleSimpleClass("source.request.mangle_simple_class");
 
@@ -120,7 +123,9 @@ static UIdent DiagKindNote("source.diagnostic.severity.note");
 static UIdent DiagKindWarning("source.diagnostic.severity.warning");
 static UIdent DiagKindError("source.diagnostic.severity.error");
 
-static void onDocumentUpdateNotification(StringRef DocumentName) {
+static void
+onDocumentUpdateNotification(StringRef DocumentName,
+                             Optional<AnnotationsRange> ChangedRange) {
   static UIdent DocumentUpdateNotificationUID(
       "source.notification.editor.documentupdate");
 
@@ -128,6 +133,10 @@ static void onDocumentUpdateNotification(StringRef DocumentName) {
   auto Dict = RespBuilder.getDictionary();
   Dict.set(KeyNotification, DocumentUpdateNotificationUID);
   Dict.set(KeyName, DocumentName);
+  if (ChangedRange) {
+    Dict.set(KeyOffset, ChangedRange->first);
+    Dict.set(KeyLength, ChangedRange->second);
+  }
   
   sourcekitd::postNotification(RespBuilder.createResponse());
 }
@@ -156,6 +165,8 @@ static sourcekitd_response_t demangleNames(ArrayRef<const char *> MangledNames,
 static sourcekitd_response_t
 mangleSimpleClassNames(ArrayRef<std::pair<StringRef, StringRef>> ModuleClassPairs);
 
+static sourcekitd_response_t reportStatistics();
+
 static sourcekitd_response_t indexSource(StringRef Filename,
                                          ArrayRef<const char *> Args,
                                          StringRef KnownHash);
@@ -307,12 +318,29 @@ handleSemanticRequest(RequestDict Req,
                       Optional<StringRef> SourceText,
                       ArrayRef<const char *> Args);
 
+static WorkQueue &getSemanticRequestQueue(sourcekitd_uid_t ReqUID);
+
+/// Wraps \p Rec so that the time until the response is ready, including any
+/// time spent waiting in a queue, is recorded under the name of \p ReqUID.
+static ResponseReceiver recordLatency(sourcekitd_uid_t ReqUID,
+                                      ResponseReceiver Rec) {
+  stats::LatencyHistogram &Histogram =
+      stats::getHistogram(UIdentFromSKDUID(ReqUID).getName());
+  auto Start = std::chrono::steady_clock::now();
+  return [&Histogram, Start, Rec](sourcekitd_response_t Resp) {
+    Histogram.record(std::chrono::steady_clock::now() - Start);
+    Rec(Resp);
+  };
+}
+
 void handleRequestImpl(sourcekitd_object_t ReqObj, ResponseReceiver Rec) {
   RequestDict Req(ReqObj);
   sourcekitd_uid_t ReqUID = Req.getUID(KeyRequest);
   if (!ReqUID)
     return Rec(createErrorRequestInvalid("missing 'key.request' with UID value"));
 
+  Rec = recordLatency(ReqUID, std::move(Rec));
+
   if (ReqUID == RequestProtocolVersion) {
     ResponseBuilder RB;
     auto dict = RB.getDictionary();
@@ -326,6 +354,10 @@ void handleRequestImpl(sourcekitd_object_t ReqObj, ResponseReceiver Rec) {
     ::exit(1);
   }
 
+  if (ReqUID == RequestStatistics) {
+    return Rec(reportStatistics());
+  }
+
   if (ReqUID == RequestDemangle) {
     SmallVector<const char *, 8> MangledNames;
     bool Failed = Req.getStringArray(KeyNames, MangledNames, /*isOptional=*/true);
@@ -645,11 +677,13 @@ void handleRequestImpl(sourcekitd_object_t ReqObj, ResponseReceiver Rec) {
   // Typechecking arrays can blow up the stack currently.
   // Run them under a malloc'ed stack.
 
-  static WorkQueue SemaQueue{ WorkQueue::Dequeuing::Concurrent,
-                              "sourcekit.request.semantic" };
   sourcekitd_request_retain(ReqObj);
-  SemaQueue.dispatch(
-    [ReqObj, Rec, ReqUID, SourceFile, SourceText, Args] {
+  WorkQueue &Queue = getSemanticRequestQueue(ReqUID);
+  stats::LatencyHistogram &QueueWait = stats::getHistogram(Queue.getLabel());
+  auto Enqueued = std::chrono::steady_clock::now();
+  Queue.dispatch(
+    [ReqObj, Rec, ReqUID, SourceFile, SourceText, Args, &QueueWait, Enqueued] {
+      QueueWait.record(std::chrono::steady_clock::now() - Enqueued);
       RequestDict Req(ReqObj);
       handleSemanticRequest(Req, Rec, ReqUID, SourceFile, SourceText, Args);
       sourcekitd_request_release(ReqObj);
@@ -657,6 +691,28 @@ void handleRequestImpl(sourcekitd_object_t ReqObj, ResponseReceiver Rec) {
     /*isStackDeep=*/true);
 }
 
+/// Returns the queue that the semantic request \p ReqUID runs on.
+///
+/// Code completion is what the user is waiting on while typing, so it runs
+/// ahead of everything else, and indexing runs behind everything else.
+static WorkQueue &getSemanticRequestQueue(sourcekitd_uid_t ReqUID) {
+  static WorkQueue HighPrioQueue{ WorkQueue::Dequeuing::Concurrent,
+                                  "sourcekit.request.semantic.high",
+                                  WorkQueue::Priority::High };
+  static WorkQueue SemaQueue{ WorkQueue::Dequeuing::Concurrent,
+                              "sourcekit.request.semantic" };
+  static WorkQueue BackgroundQueue{ WorkQueue::Dequeuing::Concurrent,
+                                    "sourcekit.request.semantic.background",
+                                    WorkQueue::Priority::Background };
+
+  if (ReqUID == RequestCodeComplete || ReqUID == RequestCodeCompleteOpen ||
+      ReqUID == RequestCodeCompleteUpdate)
+    return HighPrioQueue;
+  if (ReqUID == RequestIndex)
+    return BackgroundQueue;
+  return SemaQueue;
+}
+
 static void
 handleSemanticRequest(RequestDict Req,
                       ResponseReceiver Rec,
@@ -750,6 +806,39 @@ handleSemanticRequest(RequestDict Req,
   return Rec(createErrorRequestInvalid(ErrBuf.c_str()));
 }
 
+//===----------------------------------------------------------------------===//
+// Statistics
+//===----------------------------------------------------------------------===//
+
+static sourcekitd_response_t reportStatistics() {
+  ResponseBuilder RespBuilder;
+  auto Dict = RespBuilder.getDictionary();
+
+  auto Histograms = Dict.setArray(KeyHistograms);
+  stats::forEachHistogram([&](StringRef Name,
+                              const stats::LatencyHistogram &Histogram) {
+    auto Elem = Histograms.appendDictionary();
+    Elem.set(KeyName, Name);
+    Elem.set(KeyCount, int64_t(Histogram.getCount()));
+    Elem.set(KeyTotalUsec, int64_t(Histogram.getTotalMicroseconds()));
+    Elem.set(KeyP50Usec, int64_t(Histogram.getQuantileMicroseconds(0.5)));
+    Elem.set(KeyP90Usec, int64_t(Histogram.getQuantileMicroseconds(0.9)));
+    Elem.set(KeyP99Usec, int64_t(Histogram.getQuantileMicroseconds(0.99)));
+  });
+
+  auto Counters = Dict.setArray(KeyCounters);
+  auto addCounter = [&](StringRef Name, uint64_t Value) {
+    auto Elem = Counters.appendDictionary();
+    Elem.set(KeyName, Name);
+    Elem.set(KeyValue, int64_t(Value));
+  };
+  stats::forEachCounter(addCounter);
+  LangSupport &Lang = getGlobalContext().getSwiftLangSupport();
+  Lang.getStatistics(addCounter);
+
+  return RespBuilder.createResponse();
+}
+
 //===----------------------------------------------------------------------===//
 // Index
 //===----------------------------------------------------------------------===//
@@ -134,6 +134,14 @@ UIdent sourcekitd::KeyTypeInterface("key.typeinterface");
 UIdent sourcekitd::KeyTypeUsr("key.typeusr");
 UIdent sourcekitd::KeyContainerTypeUsr("key.containertypeusr");
 UIdent sourcekitd::KeyModuleGroups("key.modulegroups");
+UIdent sourcekitd::KeyHistograms("key.histograms");
+UIdent sourcekitd::KeyCounters("key.counters");
+UIdent sourcekitd::KeyCount("key.count");
+UIdent sourcekitd::KeyValue("key.value");
+UIdent sourcekitd::KeyTotalUsec("key.total_usec");
+UIdent sourcekitd::KeyP50Usec("key.p50_usec");
+UIdent sourcekitd::KeyP90Usec("key.p90_usec");
+UIdent sourcekitd::KeyP99Usec("key.p99_usec");
 
 /// \brief Order for the keys to use when emitting the debug description of
 /// dictionaries.
@@ -222,7 +230,16 @@ static UIdent *OrderedKeys[] = {
   &KeyIntroduced,
   &KeyDeprecated,
   &KeyObsoleted,
-  &KeyRemoveCache
+  &KeyRemoveCache,
+
+  &KeyHistograms,
+  &KeyCounters,
+  &KeyCount,
+  &KeyValue,
+  &KeyTotalUsec,
+  &KeyP50Usec,
+  &KeyP90Usec,
+  &KeyP99Usec
 };
 
 static unsigned findPrintOrderForDictKey(UIdent Key) {
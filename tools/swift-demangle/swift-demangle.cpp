@@ -25,6 +25,8 @@
 
 #include <cstdlib>
 #include <string>
+#include <thread>
+#include <vector>
 #if !defined(_MSC_VER) && !defined(__MINGW32__)
 #include <unistd.h>
 #else
@@ -55,6 +57,11 @@ static llvm::cl::opt<bool>
 Simplified("simplified",
            llvm::cl::desc("Don't display module names or implicit self types"));
 
+static llvm::cl::opt<unsigned>
+NumThreads("num-threads",
+           llvm::cl::desc("Demangle standard input on this many threads"),
+           llvm::cl::init(1));
+
 static llvm::cl::list<std::string>
 InputNames(llvm::cl::Positional, llvm::cl::desc("[mangled name...]"),
                llvm::cl::ZeroOrMore);
@@ -79,32 +86,121 @@ static void demangle(llvm::raw_ostream &os, llvm::StringRef name,
   swift::Demangle::NodePointer pointer =
       swift::demangle_wrappers::demangleSymbolAsNode(name);
   if (ExpandMode || TreeOnly) {
-    llvm::outs() << "Demangling for " << name << '\n';
-    swift::demangle_wrappers::NodeDumper(pointer).print(llvm::outs());
+    os << "Demangling for " << name << '\n';
+    swift::demangle_wrappers::NodeDumper(pointer).print(os);
   }
   if (RemangleMode) {
-    if (hadLeadingUnderscore) llvm::outs() << '_';
+    if (hadLeadingUnderscore) os << '_';
     // Just reprint the original mangled name if it didn't demangle.
     // This makes it easier to share the same database between the
     // mangling and demangling tests.
     if (!pointer) {
-      llvm::outs() << name;
+      os << name;
     } else {
-      llvm::outs() << swift::Demangle::mangleNode(pointer);
+      os << swift::Demangle::mangleNode(pointer);
     }
     return;
   }
   if (!TreeOnly) {
     std::string string = swift::Demangle::nodeToString(pointer, options);
     if (!CompactMode)
-      llvm::outs() << name << " ---> ";
-    llvm::outs() << (string.empty() ? name : llvm::StringRef(string));
+      os << name << " ---> ";
+    os << (string.empty() ? name : llvm::StringRef(string));
+  }
+}
+
+/// Matches things that look like mangled names in arbitrary text.
+///
+/// This doesn't handle Unicode symbols, but maybe that's okay.
+static const char MaybeSymbolPattern[] = "_T[_a-zA-Z0-9$]+";
+
+/// Copy \p inputContents to \p os, demangling any symbols in it.
+static void demangleText(llvm::raw_ostream &os, llvm::StringRef inputContents,
+                         llvm::Regex &maybeSymbol,
+                         const swift::Demangle::DemangleOptions &options) {
+  llvm::SmallVector<llvm::StringRef, 1> matches;
+  while (maybeSymbol.match(inputContents, &matches)) {
+    os << substrBefore(inputContents, matches.front());
+    demangle(os, matches.front(), options);
+    inputContents = substrAfter(inputContents, matches.front());
+  }
+  os << inputContents;
+}
+
+/// Read up to \p maxLines lines from stdin, appending them to \p lines.
+///
+/// \returns false on a read error.
+static bool readLines(std::vector<std::string> &lines, size_t maxLines) {
+  char *inputLine = nullptr;
+  size_t size = 0;
+  for (size_t i = 0; i != maxLines; ++i) {
+    errno = 0;
+    ssize_t length = getline(&inputLine, &size, stdin);
+    if (length == -1) {
+      free(inputLine);
+      return errno == 0;
+    }
+    lines.emplace_back(inputLine, length);
+  }
+  free(inputLine);
+  return true;
+}
+
+/// Demangle stdin on several threads.
+///
+/// Input is read in batches of lines. Each thread demangles a contiguous
+/// slice of the batch into its own buffer, and the buffers are written out
+/// in order, so the output is the same as a single-threaded run.
+static int demangleSTDINInParallel(
+    const swift::Demangle::DemangleOptions &options) {
+  // Enough lines per thread that starting threads is noise.
+  const size_t LinesPerThread = 4096;
+  const size_t BatchSize = LinesPerThread * NumThreads;
+
+  std::vector<std::string> lines;
+  std::vector<std::string> outputs(NumThreads);
+  std::vector<std::thread> threads;
+  lines.reserve(BatchSize);
+
+  auto demangleSlice = [&](unsigned index) {
+    llvm::Regex maybeSymbol(MaybeSymbolPattern);
+    std::string &output = outputs[index];
+    output.clear();
+    llvm::raw_string_ostream os(output);
+    size_t sliceSize = (lines.size() + NumThreads - 1) / NumThreads;
+    size_t begin = std::min(lines.size(), index * sliceSize);
+    size_t end = std::min(lines.size(), begin + sliceSize);
+    for (size_t i = begin; i != end; ++i)
+      demangleText(os, lines[i], maybeSymbol, options);
+    os.flush();
+  };
+
+  while (true) {
+    lines.clear();
+    bool readOK = readLines(lines, BatchSize);
+
+    threads.clear();
+    for (unsigned i = 1; i < NumThreads; ++i)
+      threads.push_back(std::thread(demangleSlice, i));
+    demangleSlice(0);
+    for (std::thread &thread : threads)
+      thread.join();
+
+    for (const std::string &output : outputs)
+      llvm::outs() << output;
+
+    if (!readOK)
+      return EXIT_FAILURE;
+    if (lines.size() < BatchSize)
+      return EXIT_SUCCESS;
   }
 }
 
 static int demangleSTDIN(const swift::Demangle::DemangleOptions &options) {
-  // This doesn't handle Unicode symbols, but maybe that's okay.
-  llvm::Regex maybeSymbol("_T[_a-zA-Z0-9$]+");
+  if (NumThreads > 1)
+    return demangleSTDINInParallel(options);
+
+  llvm::Regex maybeSymbol(MaybeSymbolPattern);
 
   while (true) {
     char *inputLine = NULL;
@@ -117,15 +213,7 @@ static int demangleSTDIN(const swift::Demangle::DemangleOptions &options) {
       return EXIT_FAILURE;
     }
 
-    llvm::StringRef inputContents(inputLine);
-    llvm::SmallVector<llvm::StringRef, 1> matches;
-    while (maybeSymbol.match(inputContents, &matches)) {
-      llvm::outs() << substrBefore(inputContents, matches.front());
-      demangle(llvm::outs(), matches.front(), options);
-      inputContents = substrAfter(inputContents, matches.front());
-    }
-
-    llvm::outs() << inputContents;
+    demangleText(llvm::outs(), inputLine, maybeSymbol, options);
     free(inputLine);
   }
 
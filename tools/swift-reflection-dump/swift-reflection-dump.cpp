@@ -16,19 +16,29 @@
 #include "swift/ABI/MetadataValues.h"
 #include "swift/Basic/Demangle.h"
 #include "swift/Basic/LLVMInitialize.h"
+#include "swift/Reflection/ReflectionContext.h"
 #include "swift/Reflection/TypeRef.h"
 #include "swift/Reflection/TypeRefBuilder.h"
+#include "swift/Remote/MemoryReader.h"
 #include "llvm/Object/Archive.h"
 #include "llvm/Object/MachO.h"
 #include "llvm/Object/MachOUniversal.h"
 #include "llvm/Object/ELF.h"
+#include "llvm/Object/ELFObjectFile.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/MathExtras.h"
 
 #include <unistd.h>
 
 #include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iomanip>
 #include <iostream>
 #include <csignal>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 
 using llvm::dyn_cast;
 using llvm::StringRef;
@@ -42,7 +52,8 @@ using namespace Demangle;
 
 enum class ActionType {
   DumpReflectionSections,
-  DumpTypeLowering
+  DumpTypeLowering,
+  DumpHeap
 };
 
 namespace options {
@@ -55,6 +66,10 @@ Action(llvm::cl::desc("Mode:"),
          clEnumValN(ActionType::DumpTypeLowering,
                     "dump-type-lowering",
                     "Dump the field layout for typeref strings read from stdin"),
+         clEnumValN(ActionType::DumpHeap,
+                    "dump-heap",
+                    "Dump the instance count and size of each class in the "
+                    "heap ranges of a core file"),
          clEnumValEnd),
        llvm::cl::init(ActionType::DumpReflectionSections));
 
@@ -65,6 +80,21 @@ BinaryFilename("binary-filename", llvm::cl::desc("Filenames of the binary files"
 static llvm::cl::opt<std::string>
 Architecture("arch", llvm::cl::desc("Architecture to inspect in the binary"),
              llvm::cl::Required);
+
+static llvm::cl::opt<std::string>
+CoreFilename("core-file",
+             llvm::cl::desc("Core file whose heap is dumped by -dump-heap"));
+
+static llvm::cl::list<std::string>
+HeapRange("heap-range",
+          llvm::cl::desc("Address range <start>-<end>, in hex, which is "
+                         "scanned for objects by -dump-heap"),
+          llvm::cl::ZeroOrMore);
+
+static llvm::cl::opt<unsigned>
+Threads("j", llvm::cl::desc("Number of threads used by -dump-heap "
+                            "(default: one per core)"),
+        llvm::cl::init(0));
 } // end namespace options
 
 template<typename T>
@@ -132,6 +162,353 @@ static ReflectionInfo findReflectionInfo(const ObjectFile *objectFile) {
   };
 }
 
+namespace {
+/// A MemoryReader for the address space saved in a core file.
+///
+/// Reads only touch the immutable contents of the file, so a reader can be
+/// shared by several threads.
+class CoreFileMemoryReader final : public MemoryReader {
+  struct Segment {
+    uint64_t Address;
+    StringRef Contents;
+  };
+
+  /// The segments of the core file, sorted by address.
+  std::vector<Segment> Segments;
+  uint8_t PointerSize;
+
+  template <typename ELFT>
+  void addELFSegments(const ELFObjectFile<ELFT> *objectFile) {
+    auto data = objectFile->getData();
+    for (auto &header : objectFile->getELFFile()->program_headers()) {
+      if (header.p_type != llvm::ELF::PT_LOAD || header.p_filesz == 0)
+        continue;
+      Segments.push_back({header.p_vaddr,
+                          data.substr(header.p_offset, header.p_filesz)});
+    }
+  }
+
+  void addMachOSegments(const MachOObjectFile *objectFile) {
+    auto data = objectFile->getData();
+    for (auto &load : objectFile->load_commands()) {
+      if (load.C.cmd == llvm::MachO::LC_SEGMENT_64) {
+        auto segment = objectFile->getSegment64LoadCommand(load);
+        if (segment.filesize != 0)
+          Segments.push_back({segment.vmaddr,
+                              data.substr(segment.fileoff, segment.filesize)});
+      } else if (load.C.cmd == llvm::MachO::LC_SEGMENT) {
+        auto segment = objectFile->getSegmentLoadCommand(load);
+        if (segment.filesize != 0)
+          Segments.push_back({segment.vmaddr,
+                              data.substr(segment.fileoff, segment.filesize)});
+      }
+    }
+  }
+
+  /// Returns the segment containing the given address, or null.
+  const Segment *findSegment(uint64_t address) const {
+    auto found = std::upper_bound(Segments.begin(), Segments.end(), address,
+                                  [](uint64_t address, const Segment &S) {
+      return address < S.Address;
+    });
+    if (found == Segments.begin())
+      return nullptr;
+    --found;
+    if (address - found->Address >= found->Contents.size())
+      return nullptr;
+    return &*found;
+  }
+
+public:
+  explicit CoreFileMemoryReader(const ObjectFile *objectFile)
+    : PointerSize(objectFile->getBytesInAddress()) {
+    if (auto o = dyn_cast<ELF32LEObjectFile>(objectFile))
+      addELFSegments(o);
+    else if (auto o = dyn_cast<ELF64LEObjectFile>(objectFile))
+      addELFSegments(o);
+    else if (auto o = dyn_cast<ELF32BEObjectFile>(objectFile))
+      addELFSegments(o);
+    else if (auto o = dyn_cast<ELF64BEObjectFile>(objectFile))
+      addELFSegments(o);
+    else if (auto o = dyn_cast<MachOObjectFile>(objectFile))
+      addMachOSegments(o);
+
+    std::sort(Segments.begin(), Segments.end(),
+              [](const Segment &a, const Segment &b) {
+      return a.Address < b.Address;
+    });
+  }
+
+  bool empty() const { return Segments.empty(); }
+
+  uint8_t getPointerSize() override { return PointerSize; }
+
+  uint8_t getSizeSize() override { return PointerSize; }
+
+  RemoteAddress getSymbolAddress(const std::string &name) override {
+    // Core files have no symbol table.
+    return RemoteAddress((uint64_t) 0);
+  }
+
+  bool readBytes(RemoteAddress address, uint8_t *dest,
+                 uint64_t size) override {
+    auto *segment = findSegment(address.getAddressData());
+    if (!segment)
+      return false;
+    auto offset = address.getAddressData() - segment->Address;
+    if (segment->Contents.size() - offset < size)
+      return false;
+    std::memcpy(dest, segment->Contents.data() + offset, size);
+    return true;
+  }
+
+  bool readString(RemoteAddress address, std::string &dest) override {
+    auto *segment = findSegment(address.getAddressData());
+    if (!segment)
+      return false;
+    auto rest = segment->Contents.drop_front(address.getAddressData() -
+                                             segment->Address);
+    auto end = rest.find('\0');
+    if (end == StringRef::npos)
+      return false;
+    dest = rest.substr(0, end).str();
+    return true;
+  }
+};
+
+/// The instances of one class found in the heap.
+struct HeapTypeStats {
+  std::string Name;
+  uint64_t Count = 0;
+  uint64_t Size = 0;
+};
+
+/// Maps the address of class metadata to the stats of its instances.
+using HeapStatsMap = std::unordered_map<uint64_t, HeapTypeStats>;
+
+/// Scans address ranges for objects whose isa pointer is class metadata, and
+/// counts them by class.
+///
+/// Each thread walks with its own walker, because the caches of a
+/// ReflectionContext are not thread-safe.
+template <typename Runtime>
+class HeapWalker {
+  using StoredPointer = typename Runtime::StoredPointer;
+
+  /// Objects are malloc'ed, so they are 16-byte aligned on all supported
+  /// platforms.
+  static const uint64_t ObjectAlignment = 16;
+
+  ReflectionContext<Runtime> Context;
+
+  /// The known class metadata, with the instance size of the class.
+  std::unordered_map<StoredPointer, unsigned> ClassMetadata;
+
+  /// Addresses which are known not to be class metadata.
+  std::unordered_set<StoredPointer> NotClassMetadata;
+
+  HeapStatsMap Stats;
+
+  static std::string getTypeName(const TypeRef *TR) {
+    if (auto N = dyn_cast<NominalTypeRef>(TR))
+      return Demangle::demangleTypeAsString(N->getMangledName());
+    if (auto BG = dyn_cast<BoundGenericTypeRef>(TR))
+      return Demangle::demangleTypeAsString(BG->getMangledName());
+    if (auto ObjC = dyn_cast<ObjCClassTypeRef>(TR))
+      return ObjC->getName();
+    return "<unknown>";
+  }
+
+  /// Returns the instance size of the class with the given metadata, or zero
+  /// if the address is not class metadata.
+  unsigned getInstanceSize(StoredPointer metadata) {
+    auto known = ClassMetadata.find(metadata);
+    if (known != ClassMetadata.end())
+      return known->second;
+    if (metadata == 0 || metadata % sizeof(StoredPointer) != 0 ||
+        NotClassMetadata.count(metadata))
+      return 0;
+
+    auto kind = Context.readKindFromMetadata(metadata);
+    bool valid = false;
+    unsigned size = 0, align = 0;
+    const TypeRef *TR = nullptr;
+    if (kind.first && kind.second == MetadataKind::Class) {
+      std::tie(valid, size, align) =
+          Context.readInstanceSizeAndAlignmentFromClassMetadata(metadata);
+      if (valid && size >= 2 * sizeof(StoredPointer))
+        TR = Context.readTypeFromMetadata(metadata);
+    }
+
+    if (TR == nullptr) {
+      NotClassMetadata.insert(metadata);
+      return 0;
+    }
+
+    ClassMetadata[metadata] = size;
+    Stats[metadata].Name = getTypeName(TR);
+    return size;
+  }
+
+public:
+  HeapWalker(std::shared_ptr<MemoryReader> reader,
+             ArrayRef<ReflectionInfo> infos)
+    : Context(std::move(reader)) {
+    for (auto &info : infos)
+      Context.addReflectionInfo(info);
+  }
+
+  /// Walk the objects which start in [start, end).
+  void walk(uint64_t start, uint64_t end) {
+    auto &reader = Context.getReader();
+    uint64_t address = llvm::alignTo(start, ObjectAlignment);
+    while (address < end) {
+      StoredPointer isa;
+      unsigned size = 0;
+      if (reader.readInteger(RemoteAddress(address), &isa))
+        size = getInstanceSize(isa);
+
+      if (size == 0) {
+        address += ObjectAlignment;
+        continue;
+      }
+
+      auto &stats = Stats[isa];
+      ++stats.Count;
+      stats.Size += size;
+      address += llvm::alignTo(size, ObjectAlignment);
+    }
+  }
+
+  HeapStatsMap &getStats() { return Stats; }
+};
+} // end anonymous namespace
+
+/// Parse a heap range of the form <start>-<end>, in hex.
+static bool parseHeapRange(StringRef range,
+                           std::pair<uint64_t, uint64_t> &result) {
+  auto bounds = range.split('-');
+  return !bounds.first.getAsInteger(16, result.first) &&
+         !bounds.second.getAsInteger(16, result.second) &&
+         result.first < result.second;
+}
+
+template <typename Runtime>
+static int doDumpHeap(std::shared_ptr<MemoryReader> reader,
+                      ArrayRef<ReflectionInfo> infos,
+                      ArrayRef<std::pair<uint64_t, uint64_t>> ranges,
+                      unsigned numThreads,
+                      std::ostream &OS) {
+  // Split the ranges into chunks, which the threads take one at a time.
+  const uint64_t ChunkSize = 1 << 20;
+  std::vector<std::pair<uint64_t, uint64_t>> chunks;
+  for (auto &range : ranges) {
+    for (uint64_t start = range.first; start < range.second;
+         start += std::min(ChunkSize, range.second - start))
+      chunks.push_back({start, std::min(start + ChunkSize, range.second)});
+  }
+
+  std::atomic<size_t> nextChunk(0);
+  std::vector<std::unique_ptr<HeapWalker<Runtime>>> walkers;
+  for (unsigned i = 0; i < numThreads; ++i)
+    walkers.emplace_back(new HeapWalker<Runtime>(reader, infos));
+
+  std::vector<std::thread> threads;
+  for (auto &walker : walkers) {
+    threads.emplace_back([&chunks, &nextChunk, &walker] {
+      for (size_t i = nextChunk++; i < chunks.size(); i = nextChunk++)
+        walker->walk(chunks[i].first, chunks[i].second);
+    });
+  }
+  for (auto &thread : threads)
+    thread.join();
+
+  // Merge the stats of the threads.
+  HeapStatsMap stats;
+  for (auto &walker : walkers) {
+    for (auto &entry : walker->getStats()) {
+      auto &merged = stats[entry.first];
+      merged.Name = entry.second.Name;
+      merged.Count += entry.second.Count;
+      merged.Size += entry.second.Size;
+    }
+  }
+
+  std::vector<const HeapTypeStats *> sorted;
+  for (auto &entry : stats) {
+    if (entry.second.Count != 0)
+      sorted.push_back(&entry.second);
+  }
+  std::sort(sorted.begin(), sorted.end(),
+            [](const HeapTypeStats *a, const HeapTypeStats *b) {
+    if (a->Size != b->Size)
+      return a->Size > b->Size;
+    return a->Name < b->Name;
+  });
+
+  uint64_t totalCount = 0, totalSize = 0;
+  OS << std::setw(12) << "count" << std::setw(16) << "size" << "  type\n";
+  for (auto *entry : sorted) {
+    OS << std::setw(12) << entry->Count << std::setw(16) << entry->Size
+       << "  " << entry->Name << '\n';
+    totalCount += entry->Count;
+    totalSize += entry->Size;
+  }
+  OS << std::setw(12) << totalCount << std::setw(16) << totalSize
+     << "  total\n";
+
+  return EXIT_SUCCESS;
+}
+
+static int doDumpHeap(ArrayRef<ReflectionInfo> infos,
+                      StringRef coreFilename,
+                      ArrayRef<std::string> heapRanges,
+                      unsigned numThreads,
+                      std::ostream &OS) {
+  if (coreFilename.empty()) {
+    std::cerr << "swift-reflection-dump error: -dump-heap needs -core-file\n";
+    return EXIT_FAILURE;
+  }
+
+  std::vector<std::pair<uint64_t, uint64_t>> ranges;
+  for (auto &range : heapRanges) {
+    ranges.emplace_back();
+    if (!parseHeapRange(range, ranges.back())) {
+      std::cerr << "swift-reflection-dump error: invalid heap range "
+                << range << "\n";
+      return EXIT_FAILURE;
+    }
+  }
+  if (ranges.empty()) {
+    std::cerr << "swift-reflection-dump error: -dump-heap needs -heap-range\n";
+    return EXIT_FAILURE;
+  }
+
+  auto coreOwner = unwrap(createBinary(coreFilename));
+  auto coreFile = dyn_cast<ObjectFile>(coreOwner.getBinary());
+  if (!coreFile) {
+    std::cerr << "swift-reflection-dump error: " << coreFilename.str()
+              << " is not a core file\n";
+    return EXIT_FAILURE;
+  }
+
+  auto reader = std::make_shared<CoreFileMemoryReader>(coreFile);
+  if (reader->empty()) {
+    std::cerr << "swift-reflection-dump error: " << coreFilename.str()
+              << " has no memory segments\n";
+    return EXIT_FAILURE;
+  }
+
+  if (numThreads == 0)
+    numThreads = std::max(1U, std::thread::hardware_concurrency());
+
+  if (reader->getPointerSize() == 4)
+    return doDumpHeap<External<RuntimeTarget<4>>>(reader, infos, ranges,
+                                                  numThreads, OS);
+  return doDumpHeap<External<RuntimeTarget<8>>>(reader, infos, ranges,
+                                                numThreads, OS);
+}
+
 static int doDumpReflectionSections(ArrayRef<std::string> binaryFilenames,
                                     StringRef arch,
                                     ActionType action,
@@ -143,6 +520,7 @@ static int doDumpReflectionSections(ArrayRef<std::string> binaryFilenames,
 
   // Construct the TypeRefBuilder
   TypeRefBuilder builder;
+  std::vector<ReflectionInfo> infos;
 
   for (auto binaryFilename : binaryFilenames) {
     auto binaryOwner = unwrap(createBinary(binaryFilename));
@@ -161,7 +539,8 @@ static int doDumpReflectionSections(ArrayRef<std::string> binaryFilenames,
       objectFile = objectOwner.get();
     }
 
-    builder.addReflectionInfo(findReflectionInfo(objectFile));
+    infos.push_back(findReflectionInfo(objectFile));
+    builder.addReflectionInfo(infos.back());
 
     // Retain the objects that own section memory
     binaryOwners.push_back(std::move(binaryOwner));
@@ -198,6 +577,9 @@ static int doDumpReflectionSections(ArrayRef<std::string> binaryFilenames,
     }
     break;
   }
+  case ActionType::DumpHeap:
+    return doDumpHeap(infos, options::CoreFilename, options::HeapRange,
+                      options::Threads, OS);
   }
 
   return EXIT_SUCCESS;
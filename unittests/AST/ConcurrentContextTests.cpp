@@ -0,0 +1,72 @@
+//===--- ConcurrentContextTests.cpp - Sharing an ASTContext ---------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "TestContext.h"
+#include "swift/AST/ASTContext.h"
+#include "swift/AST/Types.h"
+#include "gtest/gtest.h"
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace swift;
+using namespace swift::unittest;
+
+namespace {
+/// The types and identifiers one thread uniqued.
+struct Uniqued {
+  std::vector<const void *> Identifiers;
+  std::vector<TypeBase *> Types;
+};
+} // end anonymous namespace
+
+static void uniqueEverything(ASTContext &ctx, Uniqued &result) {
+  ASTContextThreadRAII threadRAII(ctx);
+  for (unsigned i = 0; i != 256; ++i) {
+    Identifier name = ctx.getIdentifier("name" + std::to_string(i % 32));
+    result.Identifiers.push_back(name.get());
+
+    Type element = BuiltinIntegerType::get(1 + i % 64, ctx);
+    Type tuple = TupleType::get({ TupleTypeElt(element, name),
+                                  TupleTypeElt(ctx.TheRawPointerType) },
+                                ctx);
+    Type fn = FunctionType::get(tuple, element);
+    result.Types.push_back(tuple.getPointer());
+    result.Types.push_back(fn.getPointer());
+    result.Types.push_back(MetatypeType::get(fn, ctx));
+    result.Types.push_back(InOutType::get(tuple));
+  }
+}
+
+TEST(ConcurrentContext, ThreadsAgreeOnUniquedTypes) {
+  TestContext C;
+  C.Ctx.enableConcurrentAccess();
+  EXPECT_TRUE(C.Ctx.isConcurrentAccessEnabled());
+
+  const unsigned NumThreads = 8;
+  std::vector<Uniqued> results(NumThreads);
+  std::vector<std::thread> threads;
+  for (unsigned i = 0; i != NumThreads; ++i)
+    threads.push_back(std::thread([&, i] {
+      uniqueEverything(C.Ctx, results[i]);
+    }));
+  for (auto &thread : threads)
+    thread.join();
+
+  // Everything a thread created is visible to the main thread afterwards.
+  Uniqued mainThread;
+  uniqueEverything(C.Ctx, mainThread);
+  for (auto &result : results) {
+    EXPECT_EQ(mainThread.Identifiers, result.Identifiers);
+    EXPECT_EQ(mainThread.Types, result.Types);
+  }
+}
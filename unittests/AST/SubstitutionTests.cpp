@@ -0,0 +1,50 @@
+//===--- SubstitutionTests.cpp - Tests for uniqued substitutions ----------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "TestContext.h"
+#include "swift/AST/ASTContext.h"
+#include "swift/AST/Substitution.h"
+#include "swift/AST/Types.h"
+#include "gtest/gtest.h"
+
+using namespace swift;
+using namespace swift::unittest;
+
+TEST(Substitution, CanonicalListsAreUniqued) {
+  TestContext C;
+
+  Type intTy = BuiltinIntegerType::get(64, C.Ctx);
+  Type sugaredIntTy = ParenType::get(C.Ctx, intTy);
+  Type ptrTy = C.Ctx.TheRawPointerType;
+
+  Substitution plain[] = { Substitution(intTy, {}), Substitution(ptrTy, {}) };
+  Substitution sugared[] = { Substitution(sugaredIntTy, {}),
+                             Substitution(ptrTy, {}) };
+  Substitution swapped[] = { Substitution(ptrTy, {}),
+                             Substitution(intTy, {}) };
+
+  auto canonicalPlain = C.Ctx.getCanonicalSubstitutions(plain);
+  auto canonicalSugared = C.Ctx.getCanonicalSubstitutions(sugared);
+  auto canonicalSwapped = C.Ctx.getCanonicalSubstitutions(swapped);
+
+  // Lists that differ only in sugar share one canonical list.
+  EXPECT_EQ(canonicalPlain.data(), canonicalSugared.data());
+  EXPECT_NE(canonicalPlain.data(), canonicalSwapped.data());
+
+  ASSERT_EQ(2u, canonicalSugared.size());
+  EXPECT_TRUE(canonicalSugared[0].getReplacement()->isCanonical());
+  EXPECT_TRUE(canonicalSugared[0] == sugared[0]);
+
+  // Canonical lists are their own canonical form.
+  EXPECT_EQ(canonicalSwapped.data(),
+            C.Ctx.getCanonicalSubstitutions(canonicalSwapped).data());
+}
@@ -0,0 +1,76 @@
+#include "swift/Basic/Cache.h"
+#include "llvm/ADT/IntrusiveRefCntPtr.h"
+#include "gtest/gtest.h"
+
+using swift::sys::Cache;
+using llvm::IntrusiveRefCntPtr;
+
+namespace {
+struct TestValue : llvm::ThreadSafeRefCountedBase<TestValue> {
+  bool &Destroyed;
+  TestValue(bool &Destroyed) : Destroyed(Destroyed) {}
+  ~TestValue() { Destroyed = true; }
+};
+} // end anonymous namespace
+
+TEST(Cache, SetGetRemove) {
+  Cache<int, int> C("swift.test.Cache");
+  C.set(1, 10);
+  C.set(2, 20);
+
+  auto Value = C.get(1);
+  ASSERT_TRUE(Value.hasValue());
+  EXPECT_EQ(10, *Value);
+  EXPECT_FALSE(C.get(3).hasValue());
+
+  EXPECT_TRUE(C.remove(1));
+  EXPECT_FALSE(C.get(1).hasValue());
+  EXPECT_FALSE(C.remove(1));
+  EXPECT_TRUE(C.get(2).hasValue());
+
+  C.clear();
+  EXPECT_FALSE(C.get(2).hasValue());
+}
+
+TEST(Cache, ReplaceReleasesOldValue) {
+  bool FirstDestroyed = false;
+  bool SecondDestroyed = false;
+  {
+    Cache<int, IntrusiveRefCntPtr<TestValue>> C("swift.test.Cache");
+    C.set(1, new TestValue(FirstDestroyed));
+    C.set(1, new TestValue(SecondDestroyed));
+    EXPECT_TRUE(FirstDestroyed);
+    EXPECT_FALSE(SecondDestroyed);
+  }
+  EXPECT_TRUE(SecondDestroyed);
+}
+
+// libcache only treats the cost limit as a hint.
+#if !defined(__APPLE__)
+TEST(Cache, CostLimitEvictsValues) {
+  Cache<int, int> C("swift.test.Cache");
+  C.setCostLimit(2 * sizeof(int));
+  C.set(1, 10);
+  C.set(2, 20);
+  C.set(3, 30);
+
+  unsigned NumCached = 0;
+  for (int Key : {1, 2, 3})
+    NumCached += C.get(Key).hasValue();
+  EXPECT_EQ(2u, NumCached);
+
+  // The value which was just set is never the one evicted.
+  EXPECT_TRUE(C.get(3).hasValue());
+}
+
+TEST(Cache, PurgeForMemoryPressure) {
+  bool Destroyed = false;
+  Cache<int, IntrusiveRefCntPtr<TestValue>> C("swift.test.Cache");
+  C.set(1, new TestValue(Destroyed));
+  ASSERT_TRUE(C.get(1).hasValue());
+
+  swift::sys::purgeCachesForMemoryPressure();
+  EXPECT_TRUE(Destroyed);
+  EXPECT_FALSE(C.get(1).hasValue());
+}
+#endif
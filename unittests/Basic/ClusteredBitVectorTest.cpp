@@ -208,3 +208,36 @@ TEST(ClusteredBitVector, FlipAllBig) {
   EXPECT_EQ(true, vec[7]);
   EXPECT_EQ(1u, vec.count());
 }
+
+TEST(ClusteredBitVector, Subtract) {
+  ClusteredBitVector vec = ClusteredBitVector::getConstant(163, true);
+  ClusteredBitVector mask = ClusteredBitVector::getConstant(163, false);
+  vec.subtract(mask);
+  EXPECT_EQ(163u, vec.count());
+  mask.setBit(3);
+  mask.setBit(100);
+  vec.subtract(mask);
+  EXPECT_EQ(161u, vec.count());
+  EXPECT_EQ(false, vec[3]);
+  EXPECT_EQ(false, vec[100]);
+  EXPECT_EQ(true, vec[101]);
+
+  ClusteredBitVector empty = ClusteredBitVector::getConstant(163, false);
+  empty.subtract(mask);
+  EXPECT_EQ(0u, empty.count());
+}
+
+TEST(ClusteredBitVector, ClearAll) {
+  ClusteredBitVector small = ClusteredBitVector::getConstant(48, true);
+  small.clearAll();
+  EXPECT_EQ(48u, small.size());
+  EXPECT_EQ(0u, small.count());
+
+  ClusteredBitVector big = ClusteredBitVector::getConstant(163, true);
+  big.clearAll();
+  EXPECT_EQ(163u, big.size());
+  EXPECT_EQ(0u, big.count());
+  EXPECT_TRUE(big == ClusteredBitVector::getConstant(163, false));
+  big.setBit(162);
+  EXPECT_EQ(1u, big.count());
+}
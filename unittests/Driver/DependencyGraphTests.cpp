@@ -790,3 +790,124 @@ TEST(DependencyGraph, ChainedExternalPreMarked) {
   EXPECT_TRUE(graph.isMarked(0));
   EXPECT_FALSE(graph.isMarked(1));
 }
+
+TEST(DependencyGraph, FineGrainedOnlyChangedDecls) {
+  DependencyGraph<uintptr_t> graph;
+  graph.setEnableFineGrainedDependencies();
+
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "provides-top-level: [a, b]\n"
+                                 "interface-hash: \"h0\"\n"
+                                 "interface-hash-top-level: "
+                                 "[[a, ha], [b, hb]]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(1, "depends-top-level: [a]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(2, "depends-top-level: [b]"),
+            LoadResult::UpToDate);
+
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "provides-top-level: [a, b]\n"
+                                 "interface-hash: \"h1\"\n"
+                                 "interface-hash-top-level: "
+                                 "[[a, ha], [b, hb2]]"),
+            LoadResult::AffectsDownstream);
+
+  SmallVector<uintptr_t, 4> marked;
+  graph.markTransitive(marked, 0);
+  EXPECT_EQ(1u, marked.size());
+  EXPECT_EQ(2u, marked.front());
+  EXPECT_FALSE(graph.isMarked(1));
+  EXPECT_TRUE(graph.isMarked(2));
+}
+
+TEST(DependencyGraph, FineGrainedNominalMembers) {
+  DependencyGraph<uintptr_t> graph;
+  graph.setEnableFineGrainedDependencies();
+
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "provides-nominal: [x, y]\n"
+                                 "provides-member: [[x, m]]\n"
+                                 "interface-hash: \"h0\"\n"
+                                 "interface-hash-nominal: [[x, hx], [y, hy]]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(1, "depends-member: [[x, m]]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(2, "depends-nominal: [y]"),
+            LoadResult::UpToDate);
+
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "provides-nominal: [x, y]\n"
+                                 "provides-member: [[x, m]]\n"
+                                 "interface-hash: \"h1\"\n"
+                                 "interface-hash-nominal: [[x, hx2], [y, hy]]"),
+            LoadResult::AffectsDownstream);
+
+  SmallVector<uintptr_t, 4> marked;
+  graph.markTransitive(marked, 0);
+  EXPECT_EQ(1u, marked.size());
+  EXPECT_EQ(1u, marked.front());
+  EXPECT_TRUE(graph.isMarked(1));
+  EXPECT_FALSE(graph.isMarked(2));
+}
+
+TEST(DependencyGraph, FineGrainedUnhashedNames) {
+  DependencyGraph<uintptr_t> graph;
+  graph.setEnableFineGrainedDependencies();
+
+  // "b" has no hash, so it has to be assumed to change with the file. "c" was
+  // removed, which also counts as a change.
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "provides-top-level: [a, b, c]\n"
+                                 "interface-hash: \"h0\"\n"
+                                 "interface-hash-top-level: "
+                                 "[[a, ha], [c, hc]]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(1, "depends-top-level: [a]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(2, "depends-top-level: [b]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(3, "depends-top-level: [c]"),
+            LoadResult::UpToDate);
+
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "provides-top-level: [a, b]\n"
+                                 "interface-hash: \"h1\"\n"
+                                 "interface-hash-top-level: [[a, ha]]"),
+            LoadResult::AffectsDownstream);
+
+  SmallVector<uintptr_t, 4> marked;
+  graph.markTransitive(marked, 0);
+  EXPECT_EQ(2u, marked.size());
+  EXPECT_FALSE(graph.isMarked(1));
+  EXPECT_TRUE(graph.isMarked(2));
+  EXPECT_TRUE(graph.isMarked(3));
+}
+
+TEST(DependencyGraph, FineGrainedDisabled) {
+  DependencyGraph<uintptr_t> graph;
+
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "provides-top-level: [a, b]\n"
+                                 "interface-hash: \"h0\"\n"
+                                 "interface-hash-top-level: "
+                                 "[[a, ha], [b, hb]]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(1, "depends-top-level: [a]"),
+            LoadResult::UpToDate);
+  EXPECT_EQ(graph.loadFromString(2, "depends-top-level: [b]"),
+            LoadResult::UpToDate);
+
+  EXPECT_EQ(graph.loadFromString(0,
+                                 "provides-top-level: [a, b]\n"
+                                 "interface-hash: \"h1\"\n"
+                                 "interface-hash-top-level: "
+                                 "[[a, ha], [b, hb2]]"),
+            LoadResult::AffectsDownstream);
+
+  SmallVector<uintptr_t, 4> marked;
+  graph.markTransitive(marked, 0);
+  EXPECT_EQ(2u, marked.size());
+  EXPECT_TRUE(graph.isMarked(1));
+  EXPECT_TRUE(graph.isMarked(2));
+}
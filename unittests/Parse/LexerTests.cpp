@@ -111,6 +111,29 @@ TEST_F(LexerTest, StringLiteralWithNUL1) {
   EXPECT_EQ(Toks[1].getLength(), 0U);
 }
 
+TEST_F(LexerTest, LongCommentsAndStrings) {
+  // Longer than the chunks the lexer scans at a time, with the interesting
+  // characters at varying offsets.
+  const char *Source =
+      "// A line comment that is a good deal longer than sixteen bytes\n"
+      "/* A block comment /* with a nested comment inside of it */ and\n"
+      "   a second line ending in a star **/\n"
+      "\"a string literal with an escaped \\\" quote and \\(x) in it\"\n"
+      "anIdentifierThatIsLongerThanSixteenBytes\u00e9xtended";
+  std::vector<tok> ExpectedTokens{
+    tok::comment, tok::comment, tok::string_literal, tok::identifier
+  };
+  std::vector<Token> Toks = checkLex(Source, ExpectedTokens,
+                                     /*KeepComments=*/true);
+  EXPECT_EQ(Toks[0].getLength(), 63U);
+  EXPECT_EQ(Toks[1].getLength(), 101U);
+  EXPECT_TRUE(Toks[2].isAtStartOfLine());
+  EXPECT_EQ(Toks[2].getLength(), 58U);
+  EXPECT_TRUE(Toks[3].isAtStartOfLine());
+  EXPECT_EQ(Toks[3].getText(),
+            "anIdentifierThatIsLongerThanSixteenBytes\u00e9xtended");
+}
+
 TEST_F(LexerTest, RestoreBasic) {
   const char *Source = "aaa \t\0 bbb ccc";
 
@@ -316,3 +316,23 @@ TEST(FuzzyStringMatcher, ShortUnconnectedMatches) {
   EXPECT_GT(m.scoreCandidate("xaxbxcdxxxxxx"), m.scoreCandidate("xaxbxcxd"));
   EXPECT_GT(m.scoreCandidate("xaxbxc_d"), m.scoreCandidate("xaxbxcxd"));
 }
+
+TEST(FuzzyStringMatcher, CharacterMask) {
+  auto mayMatch = [](llvm::StringRef pattern, llvm::StringRef candidate) {
+    return FuzzyStringMatcher(pattern).mayMatchCandidate(
+        FuzzyStringMatcher::getCharacterMask(candidate));
+  };
+  EXPECT_TRUE(mayMatch("", ""));
+  EXPECT_TRUE(mayMatch("", "abc"));
+  EXPECT_TRUE(mayMatch("ASDF", "a_s_d_f"));
+  EXPECT_TRUE(mayMatch("asDf", "FDSA"));
+  EXPECT_TRUE(mayMatch("a1_", "_1A"));
+  EXPECT_FALSE(mayMatch("asdf", "asd"));
+  EXPECT_FALSE(mayMatch("a1", "a2"));
+  EXPECT_FALSE(mayMatch("a_", "a"));
+  EXPECT_FALSE(mayMatch("a", ""));
+
+  // Anything that matches also passes the mask check.
+  for (llvm::StringRef candidate : {"ASDF", "xASDF", "a_s_d_f", "asdfX"})
+    EXPECT_TRUE(mayMatch("asDf", candidate));
+}
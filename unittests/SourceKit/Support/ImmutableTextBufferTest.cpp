@@ -43,3 +43,22 @@ TEST(EditableTextBuffer, Updates) {
 
   EXPECT_EQ(Buf->getFilename(), "/a/test");
 }
+
+TEST(EditableTextBuffer, OutOfOrderSnapshots) {
+  EditableTextBufferManager BufMgr;
+  EditableTextBufferRef EdBuf = BufMgr.getOrCreateBuffer("/a/test", "abc");
+
+  ImmutableTextSnapshotRef Snap1 = EdBuf->insert(3, "d");
+  ImmutableTextSnapshotRef Snap2 = EdBuf->insert(4, "e");
+  ImmutableTextSnapshotRef Snap3 = EdBuf->erase(0, 1);
+
+  EXPECT_EQ(Snap2->getBuffer()->getText(), "abcde");
+  EXPECT_EQ(Snap1->getBuffer()->getText(), "abcd");
+  EXPECT_EQ(Snap3->getBuffer()->getText(), "bcde");
+
+  ImmutableTextSnapshotRef Snap4 = EdBuf->replace(1, 2, "xyz");
+  ImmutableTextSnapshotRef Snap5 = EdBuf->insert(0, "_");
+  EXPECT_EQ(Snap5->getBuffer()->getText(), "_bxyze");
+  EXPECT_EQ(Snap4->getBuffer()->getText(), "bxyze");
+  EXPECT_EQ(Snap2->getBuffer()->getText(), "abcde");
+}
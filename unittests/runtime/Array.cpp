@@ -0,0 +1,94 @@
+//===--- Array.cpp - Array value witness entry point tests ----------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Runtime/HeapObject.h"
+#include "swift/Runtime/Metadata.h"
+#include "gtest/gtest.h"
+
+using namespace swift;
+
+struct ArrayTestObject : HeapObject {
+  size_t *Addr;
+  size_t Value;
+};
+
+static void destroyArrayTestObject(HeapObject *_object) {
+  auto object = static_cast<ArrayTestObject*>(_object);
+  *object->Addr = object->Value;
+  swift_deallocObject(object, sizeof(ArrayTestObject),
+                      alignof(ArrayTestObject) - 1);
+}
+
+static const FullMetadata<ClassMetadata> ArrayTestClassMetadata = {
+  { { &destroyArrayTestObject }, { &_TWVBo } },
+  { { { MetadataKind::Class } }, 0, /*rodata*/ 1,
+  ClassFlags::UsesSwift1Refcounting, nullptr, 0, 0, 0, 0, 0 }
+};
+
+static ArrayTestObject *allocArrayTestObject(size_t *addr, size_t value) {
+  auto result =
+    static_cast<ArrayTestObject *>(swift_allocObject(&ArrayTestClassMetadata,
+                                                sizeof(ArrayTestObject),
+                                                alignof(ArrayTestObject) - 1));
+  result->Addr = addr;
+  result->Value = value;
+  return result;
+}
+
+TEST(ArrayTest, copy_pod) {
+  uint64_t src[] = { 1, 2, 3, 4 };
+  uint64_t dest[] = { 0, 0, 0, 0 };
+  swift_arrayInitWithCopy(reinterpret_cast<OpaqueValue *>(dest),
+                          reinterpret_cast<OpaqueValue *>(src), 3,
+                          &_TMBi64_);
+  EXPECT_EQ(1u, dest[0]);
+  EXPECT_EQ(2u, dest[1]);
+  EXPECT_EQ(3u, dest[2]);
+  EXPECT_EQ(0u, dest[3]);
+}
+
+TEST(ArrayTest, take_pod_overlapping) {
+  uint64_t values[] = { 1, 2, 3, 4 };
+  auto base = reinterpret_cast<OpaqueValue *>(values);
+  auto next = reinterpret_cast<OpaqueValue *>(values + 1);
+  swift_arrayInitWithTakeBackToFront(next, base, 3, &_TMBi64_);
+  EXPECT_EQ(1u, values[1]);
+  EXPECT_EQ(2u, values[2]);
+  EXPECT_EQ(3u, values[3]);
+  swift_arrayInitWithTakeFrontToBack(base, next, 3, &_TMBi64_);
+  EXPECT_EQ(1u, values[0]);
+  EXPECT_EQ(2u, values[1]);
+  EXPECT_EQ(3u, values[2]);
+}
+
+TEST(ArrayTest, copy_destroy_native_objects) {
+  size_t values[] = { 0, 0 };
+  HeapObject *src[] = { allocArrayTestObject(&values[0], 1),
+                        allocArrayTestObject(&values[1], 2) };
+  HeapObject *dest[] = { nullptr, nullptr };
+
+  swift_arrayInitWithCopy(reinterpret_cast<OpaqueValue *>(dest),
+                          reinterpret_cast<OpaqueValue *>(src), 2, &_TMBo);
+  EXPECT_EQ(src[0], dest[0]);
+  EXPECT_EQ(src[1], dest[1]);
+  EXPECT_EQ(2u, swift_retainCount(src[0]));
+  EXPECT_EQ(2u, swift_retainCount(src[1]));
+
+  swift_arrayDestroy(reinterpret_cast<OpaqueValue *>(dest), 2, &_TMBo);
+  EXPECT_EQ(0u, values[0]);
+  EXPECT_EQ(0u, values[1]);
+  EXPECT_EQ(1u, swift_retainCount(src[0]));
+
+  swift_arrayDestroy(reinterpret_cast<OpaqueValue *>(src), 2, &_TMBo);
+  EXPECT_EQ(1u, values[0]);
+  EXPECT_EQ(2u, values[1]);
+}
@@ -0,0 +1,365 @@
+//===--- RuntimeBenchmarks.cpp - Runtime entry point micro-benchmarks -----===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+//
+// Micro-benchmarks that call the runtime entry points directly, so that a
+// runtime change can be measured without going through the compiler. Each
+// test repeats its operation for at least SWIFT_RUNTIME_BENCHMARK_MIN_MS
+// milliseconds (default: 200) and prints the mean time of one operation.
+// Run a subset with --gtest_filter, e.g.
+//
+//   SwiftRuntimeBenchmarks --gtest_filter='RuntimeBenchmark.Retain*'
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Basic/Demangle.h"
+#include "swift/Runtime/HeapObject.h"
+#include "swift/Runtime/Metadata.h"
+#include "llvm/ADT/STLExtras.h"
+#include "gtest/gtest.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace swift;
+
+static std::chrono::nanoseconds getMinimumTime() {
+  if (const char *value = getenv("SWIFT_RUNTIME_BENCHMARK_MIN_MS"))
+    return std::chrono::milliseconds(atoi(value));
+  return std::chrono::milliseconds(200);
+}
+
+using Clock = std::chrono::steady_clock;
+
+static void report(const char *name, uint64_t operations,
+                   Clock::duration elapsed) {
+  auto nanoseconds =
+    std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+  printf("[ BENCH    ] %-36s %10.2f ns/op %12llu ops\n", name,
+         double(nanoseconds) / operations, (unsigned long long)operations);
+}
+
+/// Calls \p body, which performs \p batch operations, until the minimum time
+/// has passed, and prints the mean time of one operation.
+template <typename Fn>
+static void measure(const char *name, unsigned batch, Fn body) {
+  auto minimum = getMinimumTime();
+  uint64_t operations = 0;
+  Clock::duration elapsed(0);
+  do {
+    auto start = Clock::now();
+    body();
+    elapsed += Clock::now() - start;
+    operations += batch;
+  } while (elapsed < minimum);
+  report(name, operations, elapsed);
+}
+
+/// Calls \p body once and prints the mean time of the \p operations it
+/// performs, for operations that can't be repeated indefinitely.
+template <typename Fn>
+static void measureOnce(const char *name, unsigned operations, Fn body) {
+  auto start = Clock::now();
+  body();
+  report(name, operations, Clock::now() - start);
+}
+
+static const unsigned Batch = 1000;
+
+//===----------------------------------------------------------------------===//
+// Heap objects
+//===----------------------------------------------------------------------===//
+
+/// An object that records its allocation size, so that variable-sized objects
+/// can share one metadata.
+struct SizedObject : HeapObject {
+  size_t Size;
+};
+
+static void destroySizedObject(HeapObject *_object) {
+  auto object = static_cast<SizedObject *>(_object);
+  swift_deallocObject(object, object->Size, alignof(SizedObject) - 1);
+}
+
+static const FullMetadata<ClassMetadata> SizedObjectMetadata = {
+  { { &destroySizedObject }, { &_TWVBo } },
+  { { { MetadataKind::Class } }, 0, /*rodata*/ 1,
+  ClassFlags::UsesSwift1Refcounting, nullptr, 0, 0, 0, 0, 0 }
+};
+
+/// A second class, unrelated to the first, for failing class casts.
+static const FullMetadata<ClassMetadata> OtherClassMetadata = {
+  { { &destroySizedObject }, { &_TWVBo } },
+  { { { MetadataKind::Class } }, 0, /*rodata*/ 1,
+  ClassFlags::UsesSwift1Refcounting, nullptr, 0, 0, 0, 0, 0 }
+};
+
+static SizedObject *allocSizedObject(size_t size) {
+  auto object =
+    static_cast<SizedObject *>(swift_allocObject(&SizedObjectMetadata, size,
+                                                 alignof(SizedObject) - 1));
+  object->Size = size;
+  return object;
+}
+
+TEST(RuntimeBenchmark, RetainRelease) {
+  auto object = allocSizedObject(sizeof(SizedObject));
+  measure("RetainRelease", Batch, [&] {
+    for (unsigned i = 0; i != Batch; ++i) {
+      swift_retain(object);
+      swift_release(object);
+    }
+  });
+  swift_release(object);
+}
+
+TEST(RuntimeBenchmark, RetainNReleaseN) {
+  auto object = allocSizedObject(sizeof(SizedObject));
+  measure("RetainNReleaseN(8)", Batch, [&] {
+    for (unsigned i = 0; i != Batch; ++i) {
+      swift_retain_n(object, 8);
+      swift_release_n(object, 8);
+    }
+  });
+  swift_release(object);
+}
+
+TEST(RuntimeBenchmark, AllocObject) {
+  for (size_t size : { 32, 64, 128, 256, 1024, 4096 }) {
+    char name[64];
+    snprintf(name, sizeof(name), "AllocObject(%zu)", size);
+    measure(name, Batch, [&] {
+      for (unsigned i = 0; i != Batch; ++i)
+        swift_release(allocSizedObject(size));
+    });
+  }
+}
+
+TEST(RuntimeBenchmark, WeakReferences) {
+  auto object = allocSizedObject(sizeof(SizedObject));
+  auto other = allocSizedObject(sizeof(SizedObject));
+
+  measure("WeakInitDestroy", Batch, [&] {
+    for (unsigned i = 0; i != Batch; ++i) {
+      WeakReference ref;
+      swift_weakInit(&ref, object);
+      swift_weakDestroy(&ref);
+    }
+  });
+
+  WeakReference ref;
+  swift_weakInit(&ref, object);
+  measure("WeakLoadStrong", Batch, [&] {
+    for (unsigned i = 0; i != Batch; ++i)
+      swift_release(swift_weakLoadStrong(&ref));
+  });
+  measure("WeakAssign", Batch, [&] {
+    for (unsigned i = 0; i != Batch; ++i)
+      swift_weakAssign(&ref, (i & 1) ? object : other);
+  });
+  measure("WeakCopyInit", Batch, [&] {
+    for (unsigned i = 0; i != Batch; ++i) {
+      WeakReference copy;
+      swift_weakCopyInit(&copy, &ref);
+      swift_weakDestroy(&copy);
+    }
+  });
+  swift_weakDestroy(&ref);
+
+  swift_release(object);
+  swift_release(other);
+}
+
+//===----------------------------------------------------------------------===//
+// Metadata
+//===----------------------------------------------------------------------===//
+
+static uint32_t DescriptorGlobal = 0;
+
+/// The general structure of a generic metadata.
+template <typename Instance>
+struct GenericMetadataBenchmark {
+  GenericMetadata Header;
+  Instance Template;
+};
+
+/// A generic struct with one argument, stored in its third word.
+static GenericMetadataBenchmark<StructMetadata> GenericStruct = {
+  // Header
+  {
+    // allocation function
+    [](GenericMetadata *pattern, const void *args) -> Metadata * {
+      auto metadata = swift_allocateGenericValueMetadata(pattern, args);
+      auto metadataWords = reinterpret_cast<const void**>(metadata);
+      auto argsWords = reinterpret_cast<const void* const*>(args);
+      metadataWords[2] = argsWords[0];
+      return metadata;
+    },
+    3 * sizeof(void*), // metadata size
+    1, // num arguments
+    0, // address point
+    {} // private data
+  },
+
+  // Fields
+  {
+    MetadataKind::Struct,
+    reinterpret_cast<const NominalTypeDescriptor*>(&DescriptorGlobal),
+    nullptr
+  }
+};
+
+/// Distinct arguments for instantiations that miss the metadata cache. Each
+/// is used once per process.
+static std::vector<uint32_t> &getUniqueArguments() {
+  static std::vector<uint32_t> arguments(1 << 20);
+  return arguments;
+}
+
+static unsigned NextUniqueArgument = 0;
+
+static const Metadata *instantiateUniqueMetadata() {
+  auto &arguments = getUniqueArguments();
+  assert(NextUniqueArgument < arguments.size() && "out of unique arguments");
+  void *args[] = { &arguments[NextUniqueArgument++] };
+  return swift_getGenericMetadata(&GenericStruct.Header, args);
+}
+
+TEST(RuntimeBenchmark, GenericMetadata) {
+  static uint32_t argument = 0;
+  void *args[] = { &argument };
+  swift_getGenericMetadata(&GenericStruct.Header, args);
+  measure("GenericMetadataHit", Batch, [&] {
+    for (unsigned i = 0; i != Batch; ++i)
+      swift_getGenericMetadata(&GenericStruct.Header, args);
+  });
+
+  // Misses allocate metadata that is never freed, so they run for a fixed
+  // number of operations rather than for the minimum time.
+  const unsigned misses = 100000;
+  measureOnce("GenericMetadataMiss", misses, [&] {
+    for (unsigned i = 0; i != misses; ++i)
+      instantiateUniqueMetadata();
+  });
+}
+
+static ProtocolDescriptor BenchmarkProtocol{
+  "_TMp16RuntimeBenchmark9Benchmark",
+  nullptr,
+  ProtocolDescriptorFlags()
+    .withSwift(true)
+    .withClassConstraint(ProtocolClassConstraint::Any)
+    .withDispatchStrategy(ProtocolDispatchStrategy::Swift)
+};
+
+TEST(RuntimeBenchmark, ConformsToProtocol) {
+  // No conformances are registered for these types, so every lookup fails.
+  // Only the first lookup of a type scans the conformance records; later
+  // ones hit the failure cache.
+  swift_conformsToProtocol(&_TMBi32_.base, &BenchmarkProtocol);
+  measure("ConformsToProtocolCachedMiss", Batch, [&] {
+    for (unsigned i = 0; i != Batch; ++i)
+      swift_conformsToProtocol(&_TMBi32_.base, &BenchmarkProtocol);
+  });
+
+  const unsigned lookups = 10000;
+  std::vector<const Metadata *> types;
+  for (unsigned i = 0; i != lookups; ++i)
+    types.push_back(instantiateUniqueMetadata());
+  measureOnce("ConformsToProtocolUncachedMiss", lookups, [&] {
+    for (auto type : types)
+      swift_conformsToProtocol(type, &BenchmarkProtocol);
+  });
+}
+
+//===----------------------------------------------------------------------===//
+// Casts
+//===----------------------------------------------------------------------===//
+
+TEST(RuntimeBenchmark, DynamicCast) {
+  auto int32 = &_TMBi32_.base;
+  auto any = swift_getExistentialTypeMetadata(0, nullptr);
+
+  measure("DynamicCastValueToSameType", Batch, [&] {
+    for (unsigned i = 0; i != Batch; ++i) {
+      uint32_t src = i, dest;
+      swift_dynamicCast(reinterpret_cast<OpaqueValue *>(&dest),
+                        reinterpret_cast<OpaqueValue *>(&src),
+                        int32, int32, DynamicCastFlags::Default);
+    }
+  });
+
+  measure("DynamicCastValueToAny", Batch, [&] {
+    for (unsigned i = 0; i != Batch; ++i) {
+      uint32_t src = i;
+      OpaqueExistentialContainer dest;
+      swift_dynamicCast(reinterpret_cast<OpaqueValue *>(&dest),
+                        reinterpret_cast<OpaqueValue *>(&src),
+                        int32, any, DynamicCastFlags::Default);
+    }
+  });
+
+  OpaqueExistentialContainer boxed;
+  uint32_t value = 42;
+  swift_dynamicCast(reinterpret_cast<OpaqueValue *>(&boxed),
+                    reinterpret_cast<OpaqueValue *>(&value),
+                    int32, any, DynamicCastFlags::Default);
+  measure("DynamicCastAnyToValue", Batch, [&] {
+    for (unsigned i = 0; i != Batch; ++i) {
+      uint32_t dest;
+      swift_dynamicCast(reinterpret_cast<OpaqueValue *>(&dest),
+                        reinterpret_cast<OpaqueValue *>(&boxed),
+                        any, int32, DynamicCastFlags::Default);
+    }
+  });
+
+  auto object = allocSizedObject(sizeof(SizedObject));
+  measure("DynamicCastClassSuccess", Batch, [&] {
+    for (unsigned i = 0; i != Batch; ++i)
+      swift_dynamicCastClass(object, &SizedObjectMetadata);
+  });
+  measure("DynamicCastClassFailure", Batch, [&] {
+    for (unsigned i = 0; i != Batch; ++i)
+      swift_dynamicCastClass(object, &OtherClassMetadata);
+  });
+  swift_release(object);
+}
+
+//===----------------------------------------------------------------------===//
+// Demangler
+//===----------------------------------------------------------------------===//
+
+TEST(RuntimeBenchmark, Demangle) {
+  static const char * const symbols[] = {
+    "_TF4main3fooFT_T_",
+    "_TFC4main8MyObjectcfT1xSi1ySS_S0_",
+    "_TTSg5Si___TFSa6appendfxT_",
+    "_TFGV4main6WidgetSS_18shouldRecalculatefT4sizeGSqV10CoreGraphics7CGFloat_"
+      "_Sb",
+    "_TMaGV4main4PairSiGSaSS__",
+  };
+
+  measure("DemangleSymbolAsNode", Batch, [&] {
+    for (unsigned i = 0; i != Batch; ++i) {
+      auto symbol = symbols[i % llvm::array_lengthof(symbols)];
+      Demangle::demangleSymbolAsNode(symbol, strlen(symbol));
+    }
+  });
+
+  measure("DemangleSymbolAsString", Batch, [&] {
+    for (unsigned i = 0; i != Batch; ++i) {
+      auto symbol = symbols[i % llvm::array_lengthof(symbols)];
+      Demangle::demangleSymbolAsString(symbol, strlen(symbol));
+    }
+  });
+}
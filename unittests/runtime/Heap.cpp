@@ -0,0 +1,85 @@
+//===--- Heap.cpp - swift_slowAlloc tests ---------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Runtime/HeapObject.h"
+#include "swift/Runtime/Heap.h"
+#include "gtest/gtest.h"
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace swift;
+
+TEST(HeapTest, slowAllocHonorsAlignMask) {
+  for (size_t alignMask : {size_t(0), size_t(7), size_t(15), size_t(31),
+                           size_t(63), size_t(4095)}) {
+    for (size_t size : {size_t(1), size_t(24), size_t(200), size_t(5000)}) {
+      void *ptr = swift_slowAlloc(size, alignMask);
+      EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(ptr) & alignMask);
+      memset(ptr, 0xAB, size);
+      swift_slowDealloc(ptr, size, alignMask);
+    }
+  }
+}
+
+TEST(HeapTest, slowDeallocWithUnknownSize) {
+  // Callers are allowed to pass -1 when they don't know the size.
+  std::vector<void *> ptrs;
+  for (size_t size = 0; size <= 512; ++size)
+    ptrs.push_back(swift_slowAlloc(size, 7));
+  for (void *ptr : ptrs)
+    swift_slowDealloc(ptr, -1, 7);
+}
+
+#if SWIFT_RUNTIME_SIZE_CLASS_ALLOCATOR
+TEST(HeapTest, sizeClassUsableSize) {
+  for (size_t size = 1; size <= 256; ++size) {
+    void *ptr = swift_slowAlloc(size, 15);
+    size_t usable = _swift_slowAllocUsableSize(ptr);
+    EXPECT_GE(usable, size);
+    EXPECT_LT(usable, size + 16);
+    swift_slowDealloc(ptr, size, 15);
+  }
+
+  // Large blocks come from malloc.
+  void *ptr = swift_slowAlloc(4096, 15);
+  EXPECT_EQ(0u, _swift_slowAllocUsableSize(ptr));
+  swift_slowDealloc(ptr, 4096, 15);
+}
+#endif
+
+TEST(HeapTest, slowAllocCrossThreadDealloc) {
+  const unsigned numThreads = 8;
+  const unsigned numAllocations = 10000;
+
+  // Each thread allocates blocks that the next thread frees, so that blocks
+  // migrate between threads' caches.
+  std::vector<std::vector<void *>> blocks(numThreads);
+  for (unsigned i = 0; i < numThreads; ++i)
+    for (unsigned j = 0; j < numAllocations; ++j)
+      blocks[i].push_back(swift_slowAlloc(16 + (j % 240), 7));
+
+  std::vector<std::thread> threads;
+  for (unsigned i = 0; i < numThreads; ++i) {
+    threads.push_back(std::thread([&, i] {
+      for (void *ptr : blocks[(i + 1) % numThreads])
+        swift_slowDealloc(ptr, -1, 7);
+      for (unsigned j = 0; j < numAllocations; ++j) {
+        void *ptr = swift_slowAlloc(16 + (j % 240), 7);
+        memset(ptr, int(i), 16);
+        swift_slowDealloc(ptr, 16 + (j % 240), 7);
+      }
+    }));
+  }
+  for (auto &thread : threads)
+    thread.join();
+}
@@ -12,6 +12,7 @@
 
 #include "swift/Runtime/Metadata.h"
 #include "swift/Runtime/Concurrent.h"
+#include "swift/Runtime/HeapObject.h"
 #include "gtest/gtest.h"
 #include <iterator>
 #include <functional>
@@ -249,6 +250,44 @@ TEST(Concurrent, ConcurrentMap) {
   }
 }
 
+TEST(Concurrent, ConcurrentMapGrowth) {
+  const size_t numElem = 10000;
+
+  struct Entry {
+    size_t Key;
+    Entry(size_t key) : Key(key) {}
+    int compareWithKey(size_t key) const {
+      return (key == Key ? 0 : (key < Key ? -1 : 1));
+    }
+    static size_t getExtraAllocationSize(size_t key) { return 0; }
+    size_t getExtraAllocationSize() const { return 0; }
+  };
+
+  ConcurrentMap<Entry> Map;
+
+  // Insert enough keys to force the index to be replaced several times
+  // while other threads are still probing it.
+  std::atomic<size_t> numInserted(0);
+  RaceTest<int*>(
+    [&]() -> int* {
+      for (size_t i = 0; i < numElem; i++) {
+        if (Map.getOrInsert(i * 2).second)
+          ++numInserted;
+        EXPECT_TRUE(Map.find(i * 2));
+      }
+      return nullptr;
+    }
+  );
+
+  // Each key must have been inserted by exactly one thread.
+  EXPECT_EQ(numElem, numInserted.load());
+
+  for (size_t i = 0; i < numElem; i++) {
+    EXPECT_EQ(i * 2, Map.find(i * 2)->Key);
+    EXPECT_FALSE(Map.find(i * 2 + 1));
+  }
+}
+
 
 TEST(MetadataTest, getGenericMetadata) {
   auto metadataTemplate = (GenericMetadata*) &MetadataTest1;
@@ -290,12 +329,48 @@ TEST(MetadataTest, getGenericMetadata) {
     });
 }
 
+TEST(MetadataTest, getMetadataAllocationStatistics) {
+  auto metadataTemplate = (GenericMetadata*) &MetadataTest1;
+
+  MetadataAllocationStatistics before;
+  swift_getMetadataAllocationStatistics(&before);
+
+  // Instantiate the template with an argument no other test uses.
+  static uint32_t UniqueArgument = 0;
+  void *args[] = { &UniqueArgument };
+  swift_getGenericMetadata(metadataTemplate, args);
+
+  MetadataAllocationStatistics after;
+  swift_getMetadataAllocationStatistics(&after);
+
+  EXPECT_GE(after.NumSlabs, 1u);
+  EXPECT_LE(after.SlabBytesUsed, after.SlabBytes);
+  EXPECT_GE(after.SlabBytesUsed,
+            before.SlabBytesUsed + metadataTemplate->MetadataSize);
+}
+
 FullMetadata<ClassMetadata> MetadataTest2 = {
   { { nullptr }, { &_TWVBo } },
   { { { MetadataKind::Class } }, nullptr, /*rodata*/ 1,
     ClassFlags(), nullptr, 0, 0, 0, 0, 0 }
 };
 
+TEST(MetadataTest, getTypeName) {
+  using Pair = TwoWordPair<const char *, uintptr_t>;
+
+  // Every thread must get the same cached string, whichever built it.
+  auto name = RaceTest_ExpectEqual<const char *>(
+    [&]() -> const char * {
+      Pair result = swift_getTypeName(&_TMT_, /*qualified*/ true);
+      EXPECT_EQ(2u, result.second);
+      return result.first;
+    });
+  EXPECT_STREQ("()", name);
+
+  Pair again = swift_getTypeName(&_TMT_, /*qualified*/ true);
+  EXPECT_EQ(name, again.first);
+}
+
 TEST(MetadataTest, getMetatypeMetadata) {
   auto inst1 = RaceTest_ExpectEqual<const MetatypeMetadata *>(
     [&]() -> const MetatypeMetadata * {
@@ -850,6 +925,7 @@ GenericWitnessTableStorage tableStorage1;
 GenericWitnessTableStorage tableStorage2;
 GenericWitnessTableStorage tableStorage3;
 GenericWitnessTableStorage tableStorage4;
+GenericWitnessTableStorage tableStorage5;
 
 const void *witnesses[] = {
   (void *) 123,
@@ -982,3 +1058,44 @@ TEST(WitnessTableTest, getGenericWitnessTable) {
       });
   }
 }
+
+static void typeRecordingInstantiator(WitnessTable *instantiatedTable,
+                                      const Metadata *type,
+                                      void * const *instantiationArgs) {
+  ((void **) instantiatedTable)[2] = (void *) type;
+}
+
+TEST(WitnessTableTest, getGenericWitnessTableForSeveralTypes) {
+  tableStorage5.WitnessTableSizeInWords = 5;
+  tableStorage5.WitnessTablePrivateSizeInWords = 0;
+  initializeRelativePointer(&tableStorage5.Protocol, &testProtocol.descriptor);
+  initializeRelativePointer(&tableStorage5.Pattern, witnesses);
+  initializeRelativePointer(&tableStorage5.Instantiator,
+                            (const void *) typeRecordingInstantiator);
+
+  GenericWitnessTable *table = reinterpret_cast<GenericWitnessTable *>(
+      &tableStorage5);
+
+  // Alternate between conforming types, so that each request misses the
+  // most recently used entry.
+  RaceTest_ExpectEqual<const WitnessTable *>(
+    [&]() -> const WitnessTable * {
+      const WitnessTable *intTable =
+          swift_getGenericWitnessTable(table, &_TMBi64_, nullptr);
+      const WitnessTable *objectTable =
+          swift_getGenericWitnessTable(table, &_TMBo, nullptr);
+
+      EXPECT_NE(intTable, objectTable);
+      EXPECT_EQ(((void **) intTable)[2], (void *) &_TMBi64_);
+      EXPECT_EQ(((void **) objectTable)[2], (void *) &_TMBo);
+
+      EXPECT_EQ(intTable,
+                swift_getGenericWitnessTable(table, &_TMBi64_, nullptr));
+      EXPECT_EQ(intTable,
+                swift_getGenericWitnessTable(table, &_TMBi64_, nullptr));
+      EXPECT_EQ(objectTable,
+                swift_getGenericWitnessTable(table, &_TMBo, nullptr));
+
+      return intTable;
+    });
+}
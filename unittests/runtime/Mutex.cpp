@@ -944,3 +944,45 @@ TEST(StaticReadWriteLockTest, ReadWriteLockCacheExampleThreaded) {
   static StaticReadWriteLock lock;
   readWriteLockCacheExampleThreaded(lock);
 }
+
+template <typename RW> void readersExcludeWritersThreaded(RW &lock) {
+  const int threadCount = 16;
+
+  // Readers and writers of all threads spread over all the reader indicators
+  // of the lock, so this checks that a writer waits for every one of them.
+  std::atomic<int> readers(0);
+  std::atomic<int> writers(0);
+  std::atomic<bool> excluded(true);
+  threadedExecute(threadCount,
+                  [&](int index) {
+                    for (int i = 0; i < 2000; ++i) {
+                      if (i % 10 == index % 10) {
+                        lock.withWriteLock([&] {
+                          if (writers++ != 0 || readers != 0)
+                            excluded = false;
+                          writers--;
+                        });
+                      } else {
+                        lock.withReadLock([&] {
+                          readers++;
+                          if (writers != 0)
+                            excluded = false;
+                          readers--;
+                        });
+                      }
+                    }
+                  },
+                  [] {});
+
+  ASSERT_TRUE(excluded);
+}
+
+TEST(ReadWriteLockTest, ReadersExcludeWritersThreaded) {
+  ReadWriteLock lock;
+  readersExcludeWritersThreaded(lock);
+}
+
+TEST(StaticReadWriteLockTest, ReadersExcludeWritersThreaded) {
+  static StaticReadWriteLock lock;
+  readersExcludeWritersThreaded(lock);
+}
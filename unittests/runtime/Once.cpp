@@ -0,0 +1,55 @@
+//===--- Once.cpp - swift_once tests --------------------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Runtime/Once.h"
+#include "gtest/gtest.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace swift;
+
+static std::atomic<unsigned> InitCount;
+static std::atomic<bool> InitFinished;
+
+static void slowInit(void *) {
+  ++InitCount;
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  InitFinished = true;
+}
+
+TEST(OnceTest, once_runs_once_and_waits) {
+  static swift_once_t predicate;
+
+  std::vector<std::thread> threads;
+  std::atomic<unsigned> sawUnfinished(0);
+  for (unsigned i = 0; i != 8; ++i) {
+    threads.emplace_back([&] {
+      swift_once(&predicate, slowInit);
+      if (!InitFinished)
+        ++sawUnfinished;
+    });
+  }
+  for (auto &thread : threads)
+    thread.join();
+
+  EXPECT_EQ(1u, InitCount);
+  EXPECT_EQ(0u, sawUnfinished);
+
+  // Once done, the predicate holds the value the compiler checks inline.
+  swift_once(&predicate, slowInit);
+  EXPECT_EQ(1u, InitCount);
+#if !defined(__CYGWIN__)
+  EXPECT_EQ(~swift_once_t(0), predicate);
+#endif
+}
@@ -0,0 +1,69 @@
+//===--- SamplingProfiler.cpp - Runtime sampling profiler tests -----------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Runtime/SamplingProfiler.h"
+#include "swift/Runtime/HeapObject.h"
+#include "swift/Runtime/Metadata.h"
+#include "gtest/gtest.h"
+#include <fstream>
+#include <iterator>
+#include <stdlib.h>
+#include <string>
+#include <unistd.h>
+
+using namespace swift;
+
+static void destroyObject(HeapObject *object) {
+  swift_deallocObject(object, sizeof(HeapObject), alignof(HeapObject) - 1);
+}
+
+static const FullMetadata<ClassMetadata> ObjectMetadata = {
+  { { &destroyObject }, { &_TWVBo } },
+  { { { MetadataKind::Class } }, 0, /*rodata*/ 1,
+  ClassFlags::UsesSwift1Refcounting, nullptr, 0, 0, 0, 0, 0 }
+};
+
+TEST(SamplingProfilerTest, writes_profile) {
+#if defined(__CYGWIN__) || defined(__ANDROID__) || defined(_WIN32)
+  EXPECT_FALSE(_swift_startSamplingProfiler(1));
+#else
+  // Sample every call, so that the calls below are certainly sampled. The
+  // profiler stays on for the rest of the process.
+  ASSERT_TRUE(_swift_startSamplingProfiler(1));
+
+  auto object = swift_allocObject(&ObjectMetadata, sizeof(HeapObject),
+                                  alignof(HeapObject) - 1);
+  for (unsigned i = 0; i != 100; ++i) {
+    swift_retain(object);
+    swift_release(object);
+  }
+  swift_release(object);
+
+  char path[] = "/tmp/swift-sampling-profile-XXXXXX";
+  int fd = mkstemp(path);
+  ASSERT_NE(-1, fd);
+  close(fd);
+  EXPECT_TRUE(swift_runtime_writeSamplingProfile(path));
+
+  std::ifstream file(path, std::ios::binary);
+  std::string profile((std::istreambuf_iterator<char>(file)),
+                      std::istreambuf_iterator<char>());
+  unlink(path);
+
+  // The profile starts with its first sample type, and names every sample
+  // type in its string table.
+  ASSERT_FALSE(profile.empty());
+  EXPECT_EQ('\x0a', profile[0]);
+  for (auto type : { "alloc_objects", "alloc_space", "retains", "releases" })
+    EXPECT_NE(std::string::npos, profile.find(type)) << type;
+#endif
+}
@@ -0,0 +1,65 @@
+//===--- Statistics.cpp - Runtime statistics tests ------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "swift/Runtime/Statistics.h"
+#include "gtest/gtest.h"
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace swift;
+
+static RuntimeStatisticValue getWeakLoadStatistic() {
+  std::vector<RuntimeStatisticValue> values(1);
+  size_t count = swift_runtime_getStatistics(values.data(), values.size());
+  values.resize(count);
+  swift_runtime_getStatistics(values.data(), values.size());
+
+  auto index = static_cast<unsigned>(RuntimeStatistic::WeakLoadStrong);
+  EXPECT_LT(index, count);
+  return values[index];
+}
+
+TEST(RuntimeStatisticsTest, descriptions) {
+  std::vector<RuntimeStatisticValue> values(64);
+  size_t count = swift_runtime_getStatistics(values.data(), values.size());
+  ASSERT_GT(count, 0u);
+  ASSERT_LE(count, values.size());
+  for (size_t i = 0; i != count; ++i) {
+    ASSERT_NE(values[i].Description, nullptr);
+    EXPECT_NE(strlen(values[i].Description), 0u);
+  }
+}
+
+TEST(RuntimeStatisticsTest, counts_survive_thread_exit) {
+  // Collect statistics regardless of the environment.
+  _swift_runtimeStatisticsState.store(RuntimeStatisticsState::Enabled);
+
+  auto before = getWeakLoadStatistic().Count;
+
+  std::vector<std::thread> threads;
+  for (unsigned i = 0; i != 4; ++i) {
+    threads.emplace_back([] {
+      for (unsigned j = 0; j != 100; ++j)
+        countRuntimeStatistic(RuntimeStatistic::WeakLoadStrong);
+    });
+  }
+  for (auto &thread : threads)
+    thread.join();
+
+  countRuntimeStatistic(RuntimeStatistic::WeakLoadStrong, 10);
+
+  auto value = getWeakLoadStatistic();
+  EXPECT_STREQ("weak reference loads", value.Description);
+  EXPECT_EQ(before + 410, value.Count);
+  EXPECT_EQ(0u, value.Nanoseconds);
+}
@@ -0,0 +1,80 @@
+//===--- ThreadPool.cpp - Parallel loop tests -----------------------------===//
+//
+// This source file is part of the Swift.org open source project
+//
+// Copyright (c) 2014 - 2016 Apple Inc. and the Swift project authors
+// Licensed under Apache License v2.0 with Runtime Library Exception
+//
+// See http://swift.org/LICENSE.txt for license information
+// See http://swift.org/CONTRIBUTORS.txt for the list of Swift project authors
+//
+//===----------------------------------------------------------------------===//
+
+#include "../../stdlib/public/SwiftShims/RuntimeShims.h"
+#include "gtest/gtest.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace swift;
+
+static void countCalls(void *context, size_t index) {
+  auto &calls = *static_cast<std::vector<std::atomic<unsigned>> *>(context);
+  calls[index].fetch_add(1, std::memory_order_relaxed);
+}
+
+static void expectEachCalledOnce(
+    const std::vector<std::atomic<unsigned>> &calls) {
+  for (size_t i = 0; i != calls.size(); ++i)
+    EXPECT_EQ(1u, calls[i].load()) << "index " << i;
+}
+
+TEST(ThreadPoolTest, parallelFor) {
+  for (size_t count : {0, 1, 2, 3, 100, 10000}) {
+    std::vector<std::atomic<unsigned>> calls(count);
+    _swift_parallelFor(count, countCalls, &calls);
+    expectEachCalledOnce(calls);
+  }
+}
+
+struct NestedLoop {
+  size_t InnerCount;
+  std::vector<std::atomic<unsigned>> Calls;
+};
+
+static void runInnerLoop(void *context, size_t index) {
+  auto &loop = *static_cast<NestedLoop *>(context);
+  struct Inner {
+    NestedLoop *Outer;
+    size_t Index;
+  } inner = {&loop, index};
+  _swift_parallelFor(loop.InnerCount, [](void *context, size_t index) {
+    auto &inner = *static_cast<Inner *>(context);
+    auto &outer = *inner.Outer;
+    outer.Calls[inner.Index * outer.InnerCount + index].fetch_add(1);
+  }, &inner);
+}
+
+TEST(ThreadPoolTest, nestedParallelFor) {
+  NestedLoop loop{50, std::vector<std::atomic<unsigned>>(50 * 50)};
+  _swift_parallelFor(50, runInnerLoop, &loop);
+  expectEachCalledOnce(loop.Calls);
+}
+
+TEST(ThreadPoolTest, concurrentParallelFor) {
+  std::vector<std::vector<std::atomic<unsigned>>> calls;
+  for (unsigned i = 0; i != 4; ++i)
+    calls.emplace_back(1000);
+
+  std::vector<std::thread> threads;
+  for (auto &threadCalls : calls) {
+    threads.emplace_back([&threadCalls] {
+      _swift_parallelFor(threadCalls.size(), countCalls, &threadCalls);
+    });
+  }
+  for (auto &thread : threads)
+    thread.join();
+
+  for (auto &threadCalls : calls)
+    expectEachCalledOnce(threadCalls);
+}
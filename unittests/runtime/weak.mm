@@ -94,6 +94,42 @@ TEST(WeakTest, simple_swift) {
   swift_weakDestroy(&ref1);
 }
 
+TEST(WeakTest, swift_weak_does_not_keep_memory) {
+  HeapObject *o1 = make_swift_object();
+  ASSERT_NE(o1, nullptr);
+
+  // Weak references point to a side table entry instead of holding an
+  // unowned reference to the object.
+  WeakReference ref1;
+  swift_weakInit(&ref1, o1);
+  ASSERT_EQ(0U, getUnownedRetainCount(o1));
+
+  WeakReference ref2;
+  swift_weakCopyInit(&ref2, &ref1);
+  ASSERT_EQ(0U, getUnownedRetainCount(o1));
+
+  WeakReference ref3;
+  swift_weakTakeInit(&ref3, &ref2);
+  HeapObject *tmp = swift_weakLoadStrong(&ref3);
+  ASSERT_EQ(o1, tmp);
+  swift_release(tmp);
+
+  tmp = swift_weakLoadStrong(&ref2);
+  ASSERT_EQ(nullptr, tmp);
+
+  // The object's memory is freed here; the references only see the
+  // detached side table entry.
+  swift_release(o1);
+
+  tmp = swift_weakLoadStrong(&ref1);
+  ASSERT_EQ(nullptr, tmp);
+  tmp = swift_weakTakeStrong(&ref3);
+  ASSERT_EQ(nullptr, tmp);
+
+  swift_weakDestroy(&ref1);
+  swift_weakDestroy(&ref2);
+}
+
 TEST(WeakTest, simple_objc) {
   void *o1 = make_objc_object();
   void *o2 = make_objc_object();
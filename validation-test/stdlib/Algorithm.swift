@@ -220,6 +220,50 @@ Algorithm.test("sorted/complexity") {
   expectTrue(comparisons_1000/comparisons_100 < 20)
 }
 
+Algorithm.test("sorted/patterns") {
+  // Sorted, reversed and duplicate-heavy input should take a linear number
+  // of comparisons.
+  let count = 10_000
+  let patterns: [(String, [Int])] = [
+    ("ascending", Array(0..<count)),
+    ("descending", Array((0..<count).reversed())),
+    ("equal", [Int](repeating: 7, count: count)),
+    ("fewDistinct", (0..<count).map { $0 % 4 }),
+    ("organPipe", (0..<count).map { Swift.min($0, count - $0) }),
+  ]
+  for (name, input) in patterns {
+    var comparisons = 0
+    var ary = input
+    ary.sort { comparisons += 1; return $0 < $1 }
+    expectEqual(input.sorted(), ary, name)
+    if name != "organPipe" {
+      expectLT(comparisons, 4 * count, name)
+    }
+  }
+
+  var nearlySorted = Array(0..<count)
+  for i in stride(from: 17, to: count - 1, by: 1000) {
+    swap(&nearlySorted[i], &nearlySorted[i + 1])
+  }
+  var comparisons = 0
+  nearlySorted.sort { comparisons += 1; return $0 < $1 }
+  expectEqual(Array(0..<count), nearlySorted)
+  expectLT(comparisons, 4 * count)
+}
+
+Algorithm.test("_stableSorted") {
+  for count in [ 0, 1, 19, 20, 21, 100, 1000 ] {
+    let input = (0..<count).map { (key: Int(rand32(exclusiveUpperBound: 10)), index: $0) }
+    let sorted = input._stableSorted { $0.key < $1.key }
+    expectEqual(count, sorted.count)
+    for i in sorted.indices.dropFirst() {
+      let (a, b) = (sorted[i - 1], sorted[i])
+      expectTrue(a.key < b.key || (a.key == b.key && a.index < b.index))
+    }
+    expectEqual(input.map { $0.key }.sorted(), input.map { $0.key }._stableSorted())
+  }
+}
+
 Algorithm.test("sorted/return type") {
   let x: Array = ([5, 4, 3, 2, 1] as ArraySlice).sorted()
 }
@@ -1165,6 +1165,29 @@ DictionaryTestSuite.test("init(dictionaryLiteral:)") {
   }
 }
 
+DictionaryTestSuite.test("init(uniqueKeysWithValues:)") {
+  do {
+    let d = Dictionary(uniqueKeysWithValues: [(10, 1010), (20, 1020)])
+    expectEqual(2, d.count)
+    expectEqual(1010, d[10])
+    expectEqual(1020, d[20])
+    expectNil(d[1111])
+  }
+  do {
+    // A sequence which is not an array, with more pairs than the initial
+    // capacity of a dictionary.
+    let d = Dictionary(uniqueKeysWithValues: zip(0..<1000, 1000..<2000))
+    expectEqual(1000, d.count)
+    for i in 0..<1000 {
+      expectEqual(1000 + i, d[i])
+    }
+  }
+  do {
+    let d = Dictionary(uniqueKeysWithValues: [(Int, Int)]())
+    expectTrue(d.isEmpty)
+  }
+}
+
 #if _runtime(_ObjC)
 //===---
 // NSDictionary -> Dictionary bridging tests.
@@ -2890,6 +2913,32 @@ DictionaryTestSuite.test("BridgedToObjC.Value_ValueTypeCustomBridged") {
   expectAutoreleasedKeysAndValues(unopt: (3, 3))
 }
 
+DictionaryTestSuite.test("BridgedToObjC.Value_ValueTypeCustomBridged.BridgesOnAccess") {
+  let d = getBridgedNSDictionaryOfValue_ValueTypeCustomBridged()
+  let key = TestObjCKeyTy(20)
+
+  // Only the values that are accessed are bridged, once each.
+  TestBridgedValueTy.bridgeOperations = 0
+  let value1: AnyObject = d.object(forKey: key)! as AnyObject
+  expectEqual(1020, (value1 as! TestObjCValueTy).value)
+  expectEqual(1, TestBridgedValueTy.bridgeOperations)
+
+  let value2: AnyObject = d.object(forKey: key)! as AnyObject
+  expectTrue(value1 === value2)
+  expectEqual(1, TestBridgedValueTy.bridgeOperations)
+
+  expectNil(d.object(forKey: TestObjCKeyTy(40)))
+  expectEqual(1, TestBridgedValueTy.bridgeOperations)
+
+  // Enumerating all the values bridges the remaining ones.
+  var values: [Int] = []
+  for value in d.allValues {
+    values.append((value as! TestObjCValueTy).value)
+  }
+  expectTrue(equalsUnordered(values, [ 1010, 1020, 1030 ]))
+  expectEqual(3, TestBridgedValueTy.bridgeOperations)
+}
+
 
 //===---
 // NSDictionary -> Dictionary -> NSDictionary bridging tests.
@@ -3946,6 +3995,68 @@ DictionaryTestSuite.test("removeAt") {
   }
 }
 
+DictionaryTestSuite.test("Lookup/ControlByteCollisions") {
+  // Keys with equal hashes share a control byte, and keys with hashes that
+  // differ only in their high bits share an ideal bucket. Lookups and
+  // removals must still find the right entries, including in chains that
+  // wrap around the end of the storage.
+  for capacity in [ 2, 8, 16, 64 ] {
+    var d = Dictionary<TestKeyTy, TestValueTy>(minimumCapacity: capacity)
+    let count = d._variantStorage.asNative.capacity * 3 / 4
+    for i in 0..<count {
+      let hashValue = i % 3 == 0 ? 42 : i << 10
+      d[TestKeyTy(value: i, hashValue: hashValue)] = TestValueTy(i)
+    }
+    expectEqual(count, d.count)
+    for i in 0..<count {
+      let hashValue = i % 3 == 0 ? 42 : i << 10
+      let key = TestKeyTy(value: i, hashValue: hashValue)
+      expectEqual(i, d[key]?.value)
+      expectNil(d[TestKeyTy(value: i + count, hashValue: hashValue)])
+    }
+    for i in stride(from: 0, to: count, by: 2) {
+      let hashValue = i % 3 == 0 ? 42 : i << 10
+      expectEqual(i,
+        d.removeValue(forKey: TestKeyTy(value: i, hashValue: hashValue))?.value)
+    }
+    for i in 0..<count {
+      let hashValue = i % 3 == 0 ? 42 : i << 10
+      let key = TestKeyTy(value: i, hashValue: hashValue)
+      expectEqual(i % 2 == 0 ? nil : i, d[key]?.value)
+    }
+  }
+}
+
+var hashValueCallCount = 0
+
+struct CountingHashKey : Hashable {
+  var name: String
+
+  var hashValue: Int {
+    hashValueCallCount += 1
+    return name.hashValue
+  }
+
+  static func == (lhs: CountingHashKey, rhs: CountingHashKey) -> Bool {
+    return lhs.name == rhs.name
+  }
+}
+
+DictionaryTestSuite.test("Resize/DoesNotRehashNonTrivialKeys") {
+  // Keys of non-trivial types have their hashes stored, so growing the
+  // storage doesn't call hashValue again.
+  hashValueCallCount = 0
+  var d = [CountingHashKey: Int]()
+  for i in 0..<1000 {
+    d[CountingHashKey(name: "key \(i)")] = i
+  }
+  expectEqual(1000, hashValueCallCount)
+  for i in 0..<1000 {
+    expectEqual(i, d[CountingHashKey(name: "key \(i)")])
+  }
+  expectEqual(2000, hashValueCallCount)
+}
+
 DictionaryTestSuite.setUp {
   resetLeaksOfDictionaryKeysValues()
 #if _runtime(_ObjC)
@@ -0,0 +1,88 @@
+// RUN: %target-run-simple-swift
+// REQUIRES: executable_test
+
+import Swift
+
+// Hash values depend on the hashing mode, so it has to be chosen before
+// anything is hashed.
+_Hashing.usesFastHashing = true
+
+import StdlibUnittest
+
+let FastHashingTests = TestSuite("FastHashing")
+
+let bytes: [UInt8] = (0..<100).map { UInt8(truncatingBitPattern: $0 &* 37) }
+
+FastHashingTests.test("_FastHashContext/ChunkingDoesNotMatter") {
+  let key: (UInt64, UInt64) = (0x0123_4567_89ab_cdef, 0xfedc_ba98_7654_3210)
+  let expected = _FastHashContext.hash(
+    data: bytes, dataByteCount: bytes.count, key: key)
+
+  for chunkSize in [ 1, 3, 4, 7, 8, 9, 16, 33 ] {
+    var context = _FastHashContext(key: key)
+    var startIndex = 0
+    while startIndex != bytes.count {
+      let count = min(chunkSize, bytes.count - startIndex)
+      context.append(
+        Array(bytes[startIndex..<(startIndex + count)]), byteCount: count)
+      startIndex += count
+    }
+    expectEqual(expected, context.finalizeAndReturnHash())
+  }
+}
+
+FastHashingTests.test("_FastHashContext/append(UInt32)") {
+  let key: (UInt64, UInt64) = (1, 2)
+  let words: [UInt32] = [ 0, 1, 0xdead_beef, 42, 7 ]
+
+  var bytewise = _FastHashContext(key: key)
+  var wordwise = _FastHashContext(key: key)
+  var three: UInt8 = 3
+  bytewise.append(&three, byteCount: 1)
+  wordwise.append(&three, byteCount: 1)
+  for word in words {
+    var littleEndian = word.littleEndian
+    bytewise.append(&littleEndian, byteCount: 4)
+    wordwise.append(word)
+  }
+  expectEqual(bytewise.finalizeAndReturnHash(), wordwise.finalizeAndReturnHash())
+}
+
+FastHashingTests.test("_FastHashContext/DistinguishesInputs") {
+  let key: (UInt64, UInt64) = (1, 2)
+  var hashes = Set<UInt64>()
+  for count in 0...bytes.count {
+    hashes.insert(
+      _FastHashContext.hash(data: bytes, dataByteCount: count, key: key))
+  }
+  // Appending zero bytes must change the hash, too.
+  let zeros = [UInt8](repeating: 0, count: 16)
+  for count in 1...zeros.count {
+    hashes.insert(
+      _FastHashContext.hash(data: zeros, dataByteCount: count, key: key))
+  }
+  expectEqual(bytes.count + 1 + zeros.count, hashes.count)
+}
+
+FastHashingTests.test("String/EqualStringsHaveEqualHashes") {
+  expectTrue(_Hashing.usesFastHashing)
+
+  let ascii = "the quick brown fox jumps over the lazy dog"
+  var utf16 = "the quick brown fox jumps over the lazy dog\u{1F600}"
+  utf16.unicodeScalars.removeLast()
+  expectEqual(ascii, utf16)
+  expectEqual(ascii.hashValue, utf16.hashValue)
+
+  expectEqual("caf\u{E9}", "cafe\u{301}")
+  expectEqual("caf\u{E9}".hashValue, "cafe\u{301}".hashValue)
+
+  var d = [String: Int]()
+  for i in 0..<1000 {
+    d["key \(i)"] = i
+  }
+  for i in 0..<1000 {
+    expectEqual(i, d["key \(i)"])
+  }
+}
+
+runAllTests()
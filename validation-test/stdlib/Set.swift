@@ -2712,6 +2712,15 @@ SetTestSuite.test("init(Sequence:)") {
     2020, 2020, 2020, 3030, 3030, 3030
   ])
   expectEqual(s1, s3)
+
+  // A sequence which is not an array.
+  let s4 = Set((0..<3000).lazy.map { 1010 * ($0 % 3 + 1) })
+  expectEqual(s1, s4)
+  let s5 = Set(0..<1000)
+  expectEqual(1000, s5.count)
+  for i in 0..<1000 {
+    expectTrue(s5.contains(i))
+  }
 }
 
 SetTestSuite.test("init(arrayLiteral:)") {